@@ -5,6 +5,10 @@
 
 include(CMake/thirdparty/SetupHwloc.cmake)
 include(CMake/thirdparty/SetupJansson.cmake)
+
+set(THREADS_PREFER_PTHREAD_FLAG ON)
+find_package(Threads REQUIRED)
+
 if(VARIORUM_WITH_AMD_CPU)
 include(CMake/thirdparty/Setupesmi.cmake)
 endif()
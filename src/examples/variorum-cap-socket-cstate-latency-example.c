@@ -0,0 +1,81 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <variorum.h>
+
+int main(int argc, char **argv)
+{
+    int ret = 0;
+    int socket_id = 0;
+    int max_latency_us = 0;
+    char *s = NULL;
+
+    const char *usage = "Usage: %s [-h] [-v] -i socket -l usec\n";
+    int opt;
+    while ((opt = getopt(argc, argv, "hvi:l:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                printf(usage, argv[0]);
+                return 0;
+            case 'v':
+                printf("%s\n", variorum_get_current_version());
+                return 0;
+            case 'i':
+                socket_id = atoi(optarg);
+                break;
+            case 'l':
+                max_latency_us = atoi(optarg);
+                break;
+            default:
+                printf(usage, argv[0]);
+                return -1;
+        }
+    }
+    if (optind == 1)
+    {
+        printf(usage, argv[0]);
+        return -1;
+    }
+
+    ret = variorum_save_cstate_limits();
+    if (ret != 0)
+    {
+        printf("Save C-state limits failed!\n");
+        return ret;
+    }
+
+    printf("Limiting socket %d to C-states with exit latency up to %d us.\n",
+           socket_id, max_latency_us);
+    ret = variorum_cap_socket_cstate_latency(socket_id, max_latency_us);
+    if (ret != 0)
+    {
+        printf("Cap socket C-state latency failed!\n");
+    }
+
+    /* Residency over one second under the limit. */
+    variorum_get_cstate_residency_json(&s);
+    free(s);
+    sleep(1);
+    ret = variorum_get_cstate_residency_json(&s);
+    if (ret == 0)
+    {
+        puts(s);
+    }
+    free(s);
+
+    ret = variorum_restore_cstate_limits();
+    if (ret != 0)
+    {
+        printf("Restore C-state limits failed!\n");
+    }
+    return ret;
+}
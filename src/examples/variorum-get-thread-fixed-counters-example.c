@@ -0,0 +1,76 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <variorum.h>
+
+static inline double do_work(int input)
+{
+    int i;
+    double result = (double)input;
+
+    for (i = 0; i < 100000; i++)
+    {
+        result += i * result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    int ret;
+    int i;
+    uint64_t start[3], end[3];
+    volatile double x = 0.0;
+
+    const char *usage = "Usage: %s [-h] [-v]\n";
+    int opt;
+    while ((opt = getopt(argc, argv, "hv")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                printf(usage, argv[0]);
+                return 0;
+            case 'v':
+                printf("%s\n", variorum_get_current_version());
+                return 0;
+            default:
+                fprintf(stderr, usage, argv[0]);
+                return -1;
+        }
+    }
+
+    ret = variorum_get_thread_fixed_counters(start);
+    if (ret != 0)
+    {
+        printf("Get thread fixed counters failed!\n");
+        return ret;
+    }
+    for (i = 0; i < 1000; i++)
+    {
+        x += do_work(i);
+    }
+    ret = variorum_get_thread_fixed_counters(end);
+    if (ret != 0)
+    {
+        printf("Get thread fixed counters failed!\n");
+        return ret;
+    }
+
+    printf("Final result: %f\n", x);
+    printf("Instructions retired: %" PRIu64 "\n", end[0] - start[0]);
+    printf("Core cycles: %" PRIu64 "\n", end[1] - start[1]);
+    printf("Reference cycles: %" PRIu64 "\n", end[2] - start[2]);
+    if (end[1] != start[1])
+    {
+        printf("IPC: %.3f\n", (double)(end[0] - start[0]) / (end[1] - start[1]));
+    }
+    return ret;
+}
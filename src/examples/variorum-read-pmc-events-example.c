@@ -0,0 +1,117 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <variorum.h>
+
+static inline double do_work(int input)
+{
+    int i;
+    double result = (double)input;
+
+    for (i = 0; i < 100000; i++)
+    {
+        result += i * result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    int ret;
+    int size = 1E3;
+    int i;
+    size_t j, k;
+    volatile double x = 0.0;
+    double total;
+    const char *events = "INSTRUCTION_RETIRED,UNHALTED_CORE_CYCLES,"
+                         "UNHALTED_REFERENCE_CYCLES,LLC_REFERENCE,LLC_MISSES,"
+                         "BRANCH_INSTRUCTION_RETIRED,BRANCH_MISSES_RETIRED";
+    struct variorum_metric_vector metrics;
+
+    const char *usage = "Usage: %s [-h] [-v] [-e event,...]\n";
+    int opt;
+    while ((opt = getopt(argc, argv, "hve:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                printf(usage, argv[0]);
+                return 0;
+            case 'v':
+                printf("%s\n", variorum_get_current_version());
+                return 0;
+            case 'e':
+                events = optarg;
+                break;
+            default:
+                fprintf(stderr, usage, argv[0]);
+                return -1;
+        }
+    }
+
+    ret = variorum_start_pmc_events(events);
+    if (ret != 0)
+    {
+        printf("Start PMC events failed!\n");
+        return ret;
+    }
+
+    // Read periodically so that event groups rotate when there are more
+    // events than counters.
+    variorum_metric_vector_init(&metrics);
+    for (i = 0; i < size; i++)
+    {
+        x += do_work(i);
+        if (i % 10 == 0)
+        {
+            variorum_metric_vector_clear(&metrics);
+            ret = variorum_read_pmc_events(&metrics);
+            if (ret != 0)
+            {
+                printf("Read PMC events failed!\n");
+                break;
+            }
+        }
+    }
+    printf("Final result: %f\n", x);
+
+    // Print node-wide totals of the last read.
+    for (j = 0; j < metrics.count; j++)
+    {
+        for (k = 0; k < j; k++)
+        {
+            if (strcmp(metrics.metrics[k].name, metrics.metrics[j].name) == 0)
+            {
+                break;
+            }
+        }
+        if (k < j)
+        {
+            continue;
+        }
+        total = 0.0;
+        for (k = j; k < metrics.count; k++)
+        {
+            if (strcmp(metrics.metrics[k].name, metrics.metrics[j].name) == 0)
+            {
+                total += metrics.metrics[k].value;
+            }
+        }
+        printf("%s %.0f\n", metrics.metrics[j].name, total);
+    }
+    variorum_metric_vector_free(&metrics);
+
+    ret = variorum_stop_pmc_events();
+    if (ret != 0)
+    {
+        printf("Stop PMC events failed!\n");
+    }
+    return ret;
+}
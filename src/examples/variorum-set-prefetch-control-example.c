@@ -0,0 +1,75 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <variorum.h>
+#include <variorum_topology.h>
+
+static void print_prefetch_control(int *bits, int ncores)
+{
+    int i;
+
+    if (variorum_get_prefetch_control(bits) != 0)
+    {
+        printf("Get prefetch control failed!\n");
+        return;
+    }
+    for (i = 0; i < ncores; i++)
+    {
+        printf("Core %d: prefetcher disable bits 0x%x\n", i, bits[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int ret = 0;
+    int i;
+    int ncores;
+    int *bits;
+
+    const char *usage = "Usage: %s [-h] [-v]\n";
+    int opt;
+    while ((opt = getopt(argc, argv, "hv")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                printf(usage, argv[0]);
+                return 0;
+            case 'v':
+                printf("%s\n", variorum_get_current_version());
+                return 0;
+            default:
+                fprintf(stderr, usage, argv[0]);
+                return -1;
+        }
+    }
+
+    ncores = variorum_get_num_cores();
+    bits = (int *) malloc(ncores * sizeof(int));
+
+    print_prefetch_control(bits, ncores);
+
+    /* Disable both L2 prefetchers on every core for the enclosed block. */
+    {
+        for (i = 0; i < ncores; i++)
+        {
+            bits[i] = VARIORUM_PREFETCH_L2_STREAMER_DISABLE |
+                      VARIORUM_PREFETCH_L2_ADJACENT_DISABLE;
+        }
+        VARIORUM_PREFETCH_SCOPE(bits);
+        printf("\nInside scope:\n");
+        print_prefetch_control(bits, ncores);
+    }
+
+    printf("\nAfter scope:\n");
+    print_prefetch_control(bits, ncores);
+
+    free(bits);
+    return ret;
+}
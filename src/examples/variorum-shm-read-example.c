@@ -0,0 +1,77 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <variorum.h>
+#include <variorum_shm.h>
+
+int main(int argc, char **argv)
+{
+    int ret;
+    uint32_t i;
+    char *name = NULL;
+    struct variorum_shm *shm;
+    struct variorum_shm_sample *sample;
+
+    const char *usage = "Usage: %s [-h] [-v] [-n name]\n";
+    int opt;
+    while ((opt = getopt(argc, argv, "hvn:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                printf(usage, argv[0]);
+                return 0;
+            case 'v':
+                printf("%s\n", variorum_get_current_version());
+                return 0;
+            case 'n':
+                name = optarg;
+                break;
+            default:
+                fprintf(stderr, usage, argv[0]);
+                return -1;
+        }
+    }
+
+    /* The samples are published by variorum_publisher, or by a process that
+     * called variorum_shm_publish(). Reading does not open any MSR.
+     */
+    ret = variorum_shm_attach(name, &shm);
+    if (ret != 0)
+    {
+        printf("No telemetry published on this node, start variorum_publisher.\n");
+        return ret;
+    }
+    sample = (struct variorum_shm_sample *) malloc(sizeof(struct
+             variorum_shm_sample));
+    if (sample == NULL)
+    {
+        variorum_shm_detach(shm);
+        return -1;
+    }
+    ret = variorum_shm_read(shm, sample);
+    if (ret != 0)
+    {
+        printf("Read shared-memory telemetry failed!\n");
+    }
+    else
+    {
+        printf("Sample %" PRIu64 " of publisher %d\n", sample->sequence,
+               variorum_shm_writer_pid(shm));
+        for (i = 0; i < sample->count; i++)
+        {
+            printf("%s %d %lf\n", sample->metrics[i].name,
+                   sample->metrics[i].index, sample->metrics[i].value);
+        }
+    }
+    free(sample);
+    variorum_shm_detach(shm);
+    return ret;
+}
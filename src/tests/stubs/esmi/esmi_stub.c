@@ -0,0 +1,206 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <e_smi/e_smi.h>
+#include <esmi_stub.h>
+
+#define STUB_MAX_CORES 1024
+#define STUB_MAX_THREADS 256
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t g_ncores = 0;
+static int g_fail[STUB_MAX_CORES];
+static uint32_t g_boostlimit[STUB_MAX_CORES];
+static unsigned g_delay_us = 0;
+static int g_set_calls = 0;
+static pthread_t g_threads[STUB_MAX_THREADS];
+static int g_nthreads = 0;
+
+void esmi_stub_reset(uint32_t ncores)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&g_lock);
+    g_ncores = ncores < STUB_MAX_CORES ? ncores : STUB_MAX_CORES;
+    memset(g_fail, 0, sizeof(g_fail));
+    for (i = 0; i < STUB_MAX_CORES; i++)
+    {
+        g_boostlimit[i] = 3000;
+    }
+    g_delay_us = 0;
+    g_set_calls = 0;
+    g_nthreads = 0;
+    pthread_mutex_unlock(&g_lock);
+}
+
+void esmi_stub_fail_core(uint32_t core, int status)
+{
+    if (core < STUB_MAX_CORES)
+    {
+        g_fail[core] = status;
+    }
+}
+
+void esmi_stub_set_delay_us(unsigned delay_us)
+{
+    g_delay_us = delay_us;
+}
+
+int esmi_stub_boostlimit_set_calls(void)
+{
+    return g_set_calls;
+}
+
+int esmi_stub_num_threads(void)
+{
+    return g_nthreads;
+}
+
+uint32_t esmi_stub_boostlimit(uint32_t core)
+{
+    return core < STUB_MAX_CORES ? g_boostlimit[core] : 0;
+}
+
+/* Validate a core index, record the calling thread and apply the delay. */
+static esmi_status_t enter_core(uint32_t core)
+{
+    pthread_t self = pthread_self();
+    int i;
+
+    if (core >= g_ncores)
+    {
+        return ESMI_INVALID_INPUT;
+    }
+    pthread_mutex_lock(&g_lock);
+    for (i = 0; i < g_nthreads; i++)
+    {
+        if (pthread_equal(g_threads[i], self))
+        {
+            break;
+        }
+    }
+    if (i == g_nthreads && g_nthreads < STUB_MAX_THREADS)
+    {
+        g_threads[g_nthreads++] = self;
+    }
+    pthread_mutex_unlock(&g_lock);
+    if (g_delay_us)
+    {
+        usleep(g_delay_us);
+    }
+    return (esmi_status_t)g_fail[core];
+}
+
+esmi_status_t esmi_init(void)
+{
+    return ESMI_SUCCESS;
+}
+
+void esmi_exit(void)
+{
+}
+
+char *esmi_get_err_msg(esmi_status_t esmi_err)
+{
+    switch (esmi_err)
+    {
+        case ESMI_SUCCESS:
+            return (char *)"Success";
+        case ESMI_PERMISSION:
+            return (char *)"Permission denied";
+        case ESMI_INVALID_INPUT:
+            return (char *)"Invalid input";
+        default:
+            return (char *)"Stub error";
+    }
+}
+
+/* Core i has consumed (i + 1) * 1000000 uJ. */
+esmi_status_t esmi_core_energy_get(uint32_t core_ind, uint64_t *penergy)
+{
+    esmi_status_t ret = enter_core(core_ind);
+    if (ret == ESMI_SUCCESS)
+    {
+        *penergy = ((uint64_t)core_ind + 1) * 1000000;
+    }
+    return ret;
+}
+
+esmi_status_t esmi_core_boostlimit_get(uint32_t cpu_ind,
+                                       uint32_t *pboostlimit)
+{
+    esmi_status_t ret = enter_core(cpu_ind);
+    if (ret == ESMI_SUCCESS)
+    {
+        *pboostlimit = g_boostlimit[cpu_ind];
+    }
+    return ret;
+}
+
+esmi_status_t esmi_core_boostlimit_set(uint32_t cpu_ind, uint32_t boostlimit)
+{
+    esmi_status_t ret = enter_core(cpu_ind);
+
+    pthread_mutex_lock(&g_lock);
+    g_set_calls++;
+    pthread_mutex_unlock(&g_lock);
+    if (ret == ESMI_SUCCESS)
+    {
+        g_boostlimit[cpu_ind] = boostlimit;
+    }
+    return ret;
+}
+
+esmi_status_t esmi_socket_energy_get(uint32_t socket_idx, uint64_t *penergy)
+{
+    (void)socket_idx;
+    *penergy = 0;
+    return ESMI_SUCCESS;
+}
+
+esmi_status_t esmi_socket_power_get(uint32_t socket_idx, uint32_t *ppower)
+{
+    (void)socket_idx;
+    *ppower = 200000;
+    return ESMI_SUCCESS;
+}
+
+esmi_status_t esmi_socket_power_cap_get(uint32_t socket_idx, uint32_t *pcap)
+{
+    (void)socket_idx;
+    *pcap = 280000;
+    return ESMI_SUCCESS;
+}
+
+esmi_status_t esmi_socket_power_cap_max_get(uint32_t socket_idx,
+        uint32_t *pmax)
+{
+    (void)socket_idx;
+    *pmax = 400000;
+    return ESMI_SUCCESS;
+}
+
+esmi_status_t esmi_socket_power_cap_set(uint32_t socket_idx, uint32_t pcap)
+{
+    (void)socket_idx;
+    (void)pcap;
+    return ESMI_SUCCESS;
+}
+
+esmi_status_t esmi_socket_boostlimit_set(uint32_t socket_idx,
+        uint32_t boostlimit)
+{
+    uint32_t i;
+    (void)socket_idx;
+    for (i = 0; i < g_ncores; i++)
+    {
+        g_boostlimit[i] = boostlimit;
+    }
+    return ESMI_SUCCESS;
+}
@@ -0,0 +1,38 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef ESMI_STUB_H_INCLUDE
+#define ESMI_STUB_H_INCLUDE
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Set the number of simulated cores and reset all state.
+void esmi_stub_reset(uint32_t ncores);
+
+/// @brief Make every operation on a core return the given status.
+void esmi_stub_fail_core(uint32_t core, int status);
+
+/// @brief Delay each per-core call by the given number of microseconds.
+void esmi_stub_set_delay_us(unsigned delay_us);
+
+/// @brief Number of esmi_core_boostlimit_set() calls since the last reset.
+int esmi_stub_boostlimit_set_calls(void);
+
+/// @brief Number of distinct threads that issued per-core calls since the
+/// last reset.
+int esmi_stub_num_threads(void);
+
+/// @brief Boost limit currently held by a core, in MHz.
+uint32_t esmi_stub_boostlimit(uint32_t core);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef ESMI_STUB_E_SMI_H_INCLUDE
+#define ESMI_STUB_E_SMI_H_INCLUDE
+
+// Minimal subset of the AMD E-SMI API used by variorum, for building and
+// testing the AMD CPU backend without EPYC hardware or the HSMP and energy
+// drivers.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    ESMI_SUCCESS = 0,
+    ESMI_INITIALIZED = 0,
+    ESMI_NO_ENERGY_DRV,
+    ESMI_NO_MSR_DRV,
+    ESMI_NO_HSMP_DRV,
+    ESMI_NO_HSMP_SUP,
+    ESMI_NO_DRV,
+    ESMI_FILE_NOT_FOUND,
+    ESMI_DEV_BUSY,
+    ESMI_PERMISSION,
+    ESMI_NOT_SUPPORTED,
+    ESMI_FILE_ERROR,
+    ESMI_INTERRUPTED,
+    ESMI_IO_ERROR,
+    ESMI_UNEXPECTED_SIZE,
+    ESMI_UNKNOWN_ERROR,
+    ESMI_ARG_PTR_NULL,
+    ESMI_NO_MEMORY,
+    ESMI_NOT_INITIALIZED,
+    ESMI_INVALID_INPUT,
+} esmi_status_t;
+
+esmi_status_t esmi_init(void);
+void esmi_exit(void);
+char *esmi_get_err_msg(esmi_status_t esmi_err);
+
+esmi_status_t esmi_core_energy_get(uint32_t core_ind, uint64_t *penergy);
+esmi_status_t esmi_socket_energy_get(uint32_t socket_idx, uint64_t *penergy);
+esmi_status_t esmi_socket_power_get(uint32_t socket_idx, uint32_t *ppower);
+esmi_status_t esmi_socket_power_cap_get(uint32_t socket_idx, uint32_t *pcap);
+esmi_status_t esmi_socket_power_cap_max_get(uint32_t socket_idx,
+        uint32_t *pmax);
+esmi_status_t esmi_socket_power_cap_set(uint32_t socket_idx, uint32_t pcap);
+esmi_status_t esmi_core_boostlimit_get(uint32_t cpu_ind,
+                                       uint32_t *pboostlimit);
+esmi_status_t esmi_core_boostlimit_set(uint32_t cpu_ind, uint32_t boostlimit);
+esmi_status_t esmi_socket_boostlimit_set(uint32_t socket_idx,
+        uint32_t boostlimit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,221 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+#include <string.h>
+
+#include <nvml.h>
+#include <nvml_stub.h>
+
+#define STUB_MAX_DEVICES 64
+
+/* Device handles are opaque pointers into this array. */
+static char g_devices[STUB_MAX_DEVICES];
+static unsigned int g_num_devices = 0;
+static int g_power_fields = 1;
+static unsigned long long g_energy_mj[STUB_MAX_DEVICES];
+static int g_field_value_calls = 0;
+static int g_energy_calls = 0;
+static int g_legacy_power_calls = 0;
+
+void nvml_stub_reset(unsigned int num_devices, int power_fields)
+{
+    g_num_devices = num_devices < STUB_MAX_DEVICES ? num_devices : STUB_MAX_DEVICES;
+    g_power_fields = power_fields;
+    memset(g_energy_mj, 0, sizeof(g_energy_mj));
+    g_field_value_calls = 0;
+    g_energy_calls = 0;
+    g_legacy_power_calls = 0;
+}
+
+void nvml_stub_set_energy(unsigned int index, unsigned long long energy_mj)
+{
+    if (index < STUB_MAX_DEVICES)
+    {
+        g_energy_mj[index] = energy_mj;
+    }
+}
+
+int nvml_stub_field_value_calls(void)
+{
+    return g_field_value_calls;
+}
+
+int nvml_stub_energy_calls(void)
+{
+    return g_energy_calls;
+}
+
+int nvml_stub_legacy_power_calls(void)
+{
+    return g_legacy_power_calls;
+}
+
+static int device_index(nvmlDevice_t device)
+{
+    intptr_t idx = (char *)device - g_devices;
+    if (idx < 0 || idx >= (intptr_t)g_num_devices)
+    {
+        return -1;
+    }
+    return (int)idx;
+}
+
+nvmlReturn_t nvmlInit(void)
+{
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlShutdown(void)
+{
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetCount(unsigned int *deviceCount)
+{
+    *deviceCount = g_num_devices;
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetHandleByIndex(unsigned int index,
+                                        nvmlDevice_t *device)
+{
+    if (index >= g_num_devices)
+    {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    *device = (nvmlDevice_t)&g_devices[index];
+    return NVML_SUCCESS;
+}
+
+/* Device i draws (200 + i) W under a (300 + i) W limit, runs at (60 + i) C
+ * with (70 + i) C memory, 1500 MHz SM and 877 MHz memory clocks, and (50 + i)
+ * % SM and (20 + i) % memory utilization. */
+nvmlReturn_t nvmlDeviceGetPowerUsage(nvmlDevice_t device, unsigned int *power)
+{
+    int i = device_index(device);
+    if (i < 0)
+    {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    g_legacy_power_calls++;
+    *power = (200 + i) * 1000;
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetEnforcedPowerLimit(nvmlDevice_t device,
+        unsigned int *limit)
+{
+    int i = device_index(device);
+    if (i < 0)
+    {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    g_legacy_power_calls++;
+    *limit = (300 + i) * 1000;
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceSetPowerManagementLimit(nvmlDevice_t device,
+        unsigned int limit)
+{
+    (void)limit;
+    return device_index(device) < 0 ? NVML_ERROR_INVALID_ARGUMENT : NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetTemperature(nvmlDevice_t device,
+                                      nvmlTemperatureSensors_t sensorType, unsigned int *temp)
+{
+    int i = device_index(device);
+    (void)sensorType;
+    if (i < 0)
+    {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    *temp = 60 + i;
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetClock(nvmlDevice_t device, nvmlClockType_t clockType,
+                                nvmlClockId_t clockId, unsigned int *clockMHz)
+{
+    (void)clockId;
+    if (device_index(device) < 0)
+    {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    *clockMHz = (clockType == NVML_CLOCK_MEM) ? 877 : 1500;
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetUtilizationRates(nvmlDevice_t device,
+        nvmlUtilization_t *utilization)
+{
+    int i = device_index(device);
+    if (i < 0)
+    {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    utilization->gpu = 50 + i;
+    utilization->memory = 20 + i;
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetTotalEnergyConsumption(nvmlDevice_t device,
+        unsigned long long *energy)
+{
+    int i = device_index(device);
+    if (i < 0)
+    {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    g_energy_calls++;
+    *energy = g_energy_mj[i];
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetFieldValues(nvmlDevice_t device, int valuesCount,
+                                      nvmlFieldValue_t *values)
+{
+    int i = device_index(device);
+    int v;
+
+    if (i < 0)
+    {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    g_field_value_calls++;
+    for (v = 0; v < valuesCount; v++)
+    {
+        values[v].nvmlReturn = NVML_SUCCESS;
+        values[v].timestamp = 0;
+        values[v].latencyUsec = 0;
+        switch (values[v].fieldId)
+        {
+            case NVML_FI_DEV_MEMORY_TEMP:
+                values[v].valueType = NVML_VALUE_TYPE_UNSIGNED_INT;
+                values[v].value.uiVal = 70 + i;
+                break;
+            case NVML_FI_DEV_TOTAL_ENERGY_CONSUMPTION:
+                values[v].valueType = NVML_VALUE_TYPE_UNSIGNED_LONG_LONG;
+                values[v].value.ullVal = g_energy_mj[i];
+                break;
+            case NVML_FI_DEV_POWER_INSTANT:
+                values[v].valueType = NVML_VALUE_TYPE_UNSIGNED_INT;
+                values[v].value.uiVal = (200 + i) * 1000;
+                values[v].nvmlReturn = g_power_fields ? NVML_SUCCESS : NVML_ERROR_NOT_SUPPORTED;
+                break;
+            case NVML_FI_DEV_POWER_CURRENT_LIMIT:
+                values[v].valueType = NVML_VALUE_TYPE_UNSIGNED_INT;
+                values[v].value.uiVal = (300 + i) * 1000;
+                values[v].nvmlReturn = g_power_fields ? NVML_SUCCESS : NVML_ERROR_NOT_SUPPORTED;
+                break;
+            default:
+                values[v].nvmlReturn = NVML_ERROR_NOT_SUPPORTED;
+                break;
+        }
+    }
+    return NVML_SUCCESS;
+}
@@ -0,0 +1,38 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef NVML_STUB_H_INCLUDE
+#define NVML_STUB_H_INCLUDE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Set the number of simulated devices and reset all counters.
+///
+/// @param [in] num_devices Number of devices reported by nvmlDeviceGetCount.
+/// @param [in] power_fields Nonzero if the POWER_INSTANT and
+///        POWER_CURRENT_LIMIT field values are supported (newer drivers).
+void nvml_stub_reset(unsigned int num_devices, int power_fields);
+
+/// @brief Set the total energy counter of a device, in millijoules.
+void nvml_stub_set_energy(unsigned int index, unsigned long long energy_mj);
+
+/// @brief Number of nvmlDeviceGetFieldValues() calls since the last reset.
+int nvml_stub_field_value_calls(void);
+
+/// @brief Number of nvmlDeviceGetTotalEnergyConsumption() calls since the
+/// last reset.
+int nvml_stub_energy_calls(void);
+
+/// @brief Number of legacy per-metric power queries (GetPowerUsage and
+/// GetEnforcedPowerLimit) since the last reset.
+int nvml_stub_legacy_power_calls(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
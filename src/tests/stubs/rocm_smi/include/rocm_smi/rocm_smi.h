@@ -0,0 +1,92 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef ROCM_SMI_STUB_ROCM_SMI_H_INCLUDE
+#define ROCM_SMI_STUB_ROCM_SMI_H_INCLUDE
+
+// Minimal subset of the ROCm SMI API used by variorum, for building and
+// testing the AMD GPU backend without GPUs or a ROCm installation.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RSMI_MAX_NUM_FREQUENCIES 33
+
+typedef enum
+{
+    RSMI_STATUS_SUCCESS = 0x0,
+    RSMI_STATUS_INVALID_ARGS,
+    RSMI_STATUS_NOT_SUPPORTED,
+    RSMI_STATUS_FILE_ERROR,
+    RSMI_STATUS_PERMISSION,
+    RSMI_STATUS_OUT_OF_RESOURCES,
+    RSMI_STATUS_INTERNAL_EXCEPTION,
+    RSMI_STATUS_INPUT_OUT_OF_BOUNDS,
+    RSMI_STATUS_INIT_ERROR,
+} rsmi_status_t;
+
+typedef enum
+{
+    RSMI_CURRENT_POWER = 0,
+    RSMI_AVERAGE_POWER,
+    RSMI_INVALID_POWER = 0xFFFFFFFF
+} RSMI_POWER_TYPE;
+
+typedef enum
+{
+    RSMI_TEMP_TYPE_EDGE = 0,
+    RSMI_TEMP_TYPE_JUNCTION,
+    RSMI_TEMP_TYPE_MEMORY,
+} rsmi_temperature_type_t;
+
+typedef enum
+{
+    RSMI_TEMP_CURRENT = 0x0,
+} rsmi_temperature_metric_t;
+
+typedef enum
+{
+    RSMI_CLK_TYPE_SYS = 0x0,
+    RSMI_CLK_TYPE_DF,
+    RSMI_CLK_TYPE_DCEF,
+    RSMI_CLK_TYPE_SOC,
+    RSMI_CLK_TYPE_MEM,
+} rsmi_clk_type_t;
+
+typedef struct
+{
+    bool has_deep_sleep;
+    uint32_t num_supported;
+    uint32_t current;
+    uint64_t frequency[RSMI_MAX_NUM_FREQUENCIES];
+} rsmi_frequencies_t;
+
+rsmi_status_t rsmi_init(uint64_t init_flags);
+rsmi_status_t rsmi_shut_down(void);
+rsmi_status_t rsmi_num_monitor_devices(uint32_t *num_devices);
+rsmi_status_t rsmi_dev_power_get(uint32_t dv_ind, uint64_t *power,
+                                 RSMI_POWER_TYPE *type);
+rsmi_status_t rsmi_dev_power_cap_get(uint32_t dv_ind, uint32_t sensor_ind,
+                                     uint64_t *cap);
+rsmi_status_t rsmi_dev_power_cap_range_get(uint32_t dv_ind,
+        uint32_t sensor_ind, uint64_t *max, uint64_t *min);
+rsmi_status_t rsmi_dev_power_cap_set(uint32_t dv_ind, uint32_t sensor_ind,
+                                     uint64_t cap);
+rsmi_status_t rsmi_dev_temp_metric_get(uint32_t dv_ind, uint32_t sensor_type,
+                                       rsmi_temperature_metric_t metric, int64_t *temperature);
+rsmi_status_t rsmi_dev_gpu_clk_freq_get(uint32_t dv_ind,
+                                        rsmi_clk_type_t clk_type, rsmi_frequencies_t *f);
+rsmi_status_t rsmi_dev_busy_percent_get(uint32_t dv_ind,
+                                        uint32_t *busy_percent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <string.h>
+
+#include <rocm_smi/rocm_smi.h>
+#include <rocm_smi_stub.h>
+
+#define STUB_MAX_DEVICES 64
+
+static uint32_t g_num_devices = 0;
+static int g_initialized = 0;
+static int g_init_count = 0;
+static int g_shutdown_count = 0;
+static int g_query_count = 0;
+static uint64_t g_power_cap[STUB_MAX_DEVICES];
+
+void rsmi_stub_reset(uint32_t num_devices)
+{
+    g_num_devices = num_devices < STUB_MAX_DEVICES ? num_devices : STUB_MAX_DEVICES;
+    g_initialized = 0;
+    g_init_count = 0;
+    g_shutdown_count = 0;
+    g_query_count = 0;
+    memset(g_power_cap, 0, sizeof(g_power_cap));
+}
+
+int rsmi_stub_init_count(void)
+{
+    return g_init_count;
+}
+
+int rsmi_stub_shutdown_count(void)
+{
+    return g_shutdown_count;
+}
+
+int rsmi_stub_query_count(void)
+{
+    return g_query_count;
+}
+
+uint64_t rsmi_stub_power_cap(uint32_t dv_ind)
+{
+    return dv_ind < STUB_MAX_DEVICES ? g_power_cap[dv_ind] : 0;
+}
+
+static rsmi_status_t check_device(uint32_t dv_ind)
+{
+    if (!g_initialized)
+    {
+        return RSMI_STATUS_INIT_ERROR;
+    }
+    if (dv_ind >= g_num_devices)
+    {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    g_query_count++;
+    return RSMI_STATUS_SUCCESS;
+}
+
+rsmi_status_t rsmi_init(uint64_t init_flags)
+{
+    (void)init_flags;
+    g_initialized = 1;
+    g_init_count++;
+    return RSMI_STATUS_SUCCESS;
+}
+
+rsmi_status_t rsmi_shut_down(void)
+{
+    g_initialized = 0;
+    g_shutdown_count++;
+    return RSMI_STATUS_SUCCESS;
+}
+
+rsmi_status_t rsmi_num_monitor_devices(uint32_t *num_devices)
+{
+    if (!g_initialized)
+    {
+        return RSMI_STATUS_INIT_ERROR;
+    }
+    *num_devices = g_num_devices;
+    return RSMI_STATUS_SUCCESS;
+}
+
+/* Device i reports (100 + i) W, (40 + i) C, (1000 + i) MHz system clock,
+ * 1600 MHz memory clock and (10 * i) % busy. */
+rsmi_status_t rsmi_dev_power_get(uint32_t dv_ind, uint64_t *power,
+                                 RSMI_POWER_TYPE *type)
+{
+    rsmi_status_t ret = check_device(dv_ind);
+    if (ret == RSMI_STATUS_SUCCESS)
+    {
+        *power = (100 + (uint64_t)dv_ind) * 1000 * 1000;
+        *type = RSMI_AVERAGE_POWER;
+    }
+    return ret;
+}
+
+rsmi_status_t rsmi_dev_power_cap_get(uint32_t dv_ind, uint32_t sensor_ind,
+                                     uint64_t *cap)
+{
+    rsmi_status_t ret = check_device(dv_ind);
+    (void)sensor_ind;
+    if (ret == RSMI_STATUS_SUCCESS)
+    {
+        *cap = g_power_cap[dv_ind] ? g_power_cap[dv_ind] : 300ULL * 1000 * 1000;
+    }
+    return ret;
+}
+
+rsmi_status_t rsmi_dev_power_cap_range_get(uint32_t dv_ind,
+        uint32_t sensor_ind, uint64_t *max, uint64_t *min)
+{
+    rsmi_status_t ret = check_device(dv_ind);
+    (void)sensor_ind;
+    if (ret == RSMI_STATUS_SUCCESS)
+    {
+        *max = 500ULL * 1000 * 1000;
+        *min = 100ULL * 1000 * 1000;
+    }
+    return ret;
+}
+
+rsmi_status_t rsmi_dev_power_cap_set(uint32_t dv_ind, uint32_t sensor_ind,
+                                     uint64_t cap)
+{
+    rsmi_status_t ret = check_device(dv_ind);
+    (void)sensor_ind;
+    if (ret == RSMI_STATUS_SUCCESS)
+    {
+        g_power_cap[dv_ind] = cap;
+    }
+    return ret;
+}
+
+rsmi_status_t rsmi_dev_temp_metric_get(uint32_t dv_ind, uint32_t sensor_type,
+                                       rsmi_temperature_metric_t metric, int64_t *temperature)
+{
+    rsmi_status_t ret = check_device(dv_ind);
+    (void)sensor_type;
+    (void)metric;
+    if (ret == RSMI_STATUS_SUCCESS)
+    {
+        *temperature = (40 + (int64_t)dv_ind) * 1000;
+    }
+    return ret;
+}
+
+rsmi_status_t rsmi_dev_gpu_clk_freq_get(uint32_t dv_ind,
+                                        rsmi_clk_type_t clk_type, rsmi_frequencies_t *f)
+{
+    rsmi_status_t ret = check_device(dv_ind);
+    if (ret == RSMI_STATUS_SUCCESS)
+    {
+        memset(f, 0, sizeof(rsmi_frequencies_t));
+        f->num_supported = 2;
+        f->current = 1;
+        f->frequency[0] = 500ULL * 1000 * 1000;
+        f->frequency[1] = (clk_type == RSMI_CLK_TYPE_MEM) ? 1600ULL * 1000 * 1000 :
+                          (1000 + (uint64_t)dv_ind) * 1000 * 1000;
+    }
+    return ret;
+}
+
+rsmi_status_t rsmi_dev_busy_percent_get(uint32_t dv_ind,
+                                        uint32_t *busy_percent)
+{
+    rsmi_status_t ret = check_device(dv_ind);
+    if (ret == RSMI_STATUS_SUCCESS)
+    {
+        *busy_percent = 10 * dv_ind;
+    }
+    return ret;
+}
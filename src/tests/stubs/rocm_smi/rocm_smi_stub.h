@@ -0,0 +1,34 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef ROCM_SMI_STUB_H_INCLUDE
+#define ROCM_SMI_STUB_H_INCLUDE
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Set the number of simulated devices and reset all counters.
+void rsmi_stub_reset(uint32_t num_devices);
+
+/// @brief Number of rsmi_init() calls since the last reset.
+int rsmi_stub_init_count(void);
+
+/// @brief Number of rsmi_shut_down() calls since the last reset.
+int rsmi_stub_shutdown_count(void);
+
+/// @brief Number of per-device query calls since the last reset.
+int rsmi_stub_query_count(void);
+
+/// @brief Last power cap set on a device, in microwatts.
+uint64_t rsmi_stub_power_cap(uint32_t dv_ind);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,249 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <variorum_agg.h>
+#include <variorum_error.h>
+}
+
+#define INTERVAL_MS 100
+
+static uint64_t now_bucket(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return variorum_agg_bucket(tv.tv_sec * (uint64_t)1000 + tv.tv_usec / 1000,
+                               INTERVAL_MS);
+}
+
+static void collect(const struct variorum_agg_summary *summary, void *arg)
+{
+    ((std::vector<struct variorum_agg_summary> *)arg)->push_back(*summary);
+}
+
+// A root with two inner aggregators, each with three nodes, run in one thread.
+class agg : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char addr[64];
+
+            snprintf(addr, sizeof(addr), "unix:/tmp/t_agg.%d.root", getpid());
+            ASSERT_EQ(0, variorum_agg_create(addr, NULL, INTERVAL_MS, 0, &root));
+            variorum_agg_set_callback(root, collect, &out);
+            for (int m = 0; m < 2; m++)
+            {
+                // The inner aggregators talk TCP to show both transports work
+                // in one tree.
+                ASSERT_EQ(0, variorum_agg_create("tcp:127.0.0.1:0", addr,
+                                                 INTERVAL_MS, 0, &mid[m]));
+                for (int n = 0; n < 3; n++)
+                {
+                    nodes[3 * m + n] = variorum_agg_connect(variorum_agg_address(mid[m]));
+                    ASSERT_GE(nodes[3 * m + n], 0);
+                }
+            }
+            run_until(3, 3);
+        }
+
+        void TearDown() override
+        {
+            for (int n = 0; n < 6; n++)
+            {
+                close(nodes[n]);
+            }
+            variorum_agg_destroy(mid[0]);
+            variorum_agg_destroy(mid[1]);
+            variorum_agg_destroy(root);
+        }
+
+        // Step all aggregators until the inner ones have the given number of
+        // nodes and the root emitted count buckets, or 5 seconds passed.
+        void run_until(uint32_t mid0_children, uint32_t mid1_children,
+                       size_t count = 0)
+        {
+            struct variorum_agg_stats r;
+            struct variorum_agg_stats m0;
+            struct variorum_agg_stats m1;
+
+            for (int i = 0; i < 1000; i++)
+            {
+                variorum_agg_run(mid[0], 1);
+                variorum_agg_run(mid[1], 1);
+                variorum_agg_run(root, 1);
+                variorum_agg_get_stats(root, &r);
+                variorum_agg_get_stats(mid[0], &m0);
+                variorum_agg_get_stats(mid[1], &m1);
+                if (r.children == 2 && m0.children == mid0_children &&
+                    m1.children == mid1_children && out.size() >= count)
+                {
+                    return;
+                }
+                usleep(4000);
+            }
+        }
+
+        struct variorum_agg *root;
+        struct variorum_agg *mid[2];
+        int nodes[6];
+        std::vector<struct variorum_agg_summary> out;
+};
+
+TEST(agg_summary, test_merge_and_percentiles)
+{
+    struct variorum_agg_summary all;
+    struct variorum_agg_summary low;
+    struct variorum_agg_summary high;
+    double p;
+
+    variorum_agg_summary_init(&all, 7);
+    variorum_agg_summary_init(&low, 7);
+    variorum_agg_summary_init(&high, 7);
+    EXPECT_EQ(0.0, variorum_agg_summary_percentile(&all, 50));
+    for (int v = 1; v <= 1000; v++)
+    {
+        variorum_agg_summary_add(&all, v);
+        variorum_agg_summary_add(v <= 500 ? &low : &high, v);
+    }
+    variorum_agg_summary_merge(&low, &high);
+    EXPECT_EQ(0, memcmp(&all, &low, sizeof(all)));
+    EXPECT_EQ(7u, all.bucket);
+    EXPECT_EQ(1000u, all.nodes);
+    EXPECT_EQ(500500.0, all.sum);
+    EXPECT_EQ(1.0, all.min);
+    EXPECT_EQ(1000.0, all.max);
+
+    // Within one bin of the exact percentile, which is 9% wide.
+    const double percents[] = {1, 10, 50, 90, 99};
+    for (double pct : percents)
+    {
+        p = variorum_agg_summary_percentile(&all, pct);
+        EXPECT_NEAR(pct * 10, p, pct * 10 * 0.1) << pct;
+    }
+    EXPECT_EQ(1.0, variorum_agg_summary_percentile(&all, 0));
+    EXPECT_EQ(1000.0, variorum_agg_summary_percentile(&all, 100));
+}
+
+TEST(agg_summary, test_bad_address)
+{
+    struct variorum_agg *a;
+
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_agg_connect("udp:localhost:1"));
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_agg_connect("tcp:localhost"));
+    EXPECT_EQ(VARIORUM_ERROR_INVAL,
+              variorum_agg_create("unix:", NULL, INTERVAL_MS, 0, &a));
+    EXPECT_EQ(NULL, a);
+}
+
+TEST_F(agg, test_tree)
+{
+    uint64_t b0 = now_bucket();
+
+    for (uint64_t b = b0; b < b0 + 5; b++)
+    {
+        for (int n = 0; n < 6; n++)
+        {
+            ASSERT_EQ(0, variorum_agg_send_sample(nodes[n], b, 100.0 * (n + 1) +
+                                                  (b - b0)));
+        }
+    }
+    // Every node sent the last bucket, so it completes without waiting for
+    // its lateness.
+    run_until(3, 3, 5);
+    ASSERT_EQ(5u, out.size());
+    for (uint64_t i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(b0 + i, out[i].bucket);
+        EXPECT_EQ(6u, out[i].nodes);
+        EXPECT_EQ(6u, out[i].expected);
+        EXPECT_EQ(2100.0 + 6 * i, out[i].sum);
+        EXPECT_EQ(100.0 + i, out[i].min);
+        EXPECT_EQ(600.0 + i, out[i].max);
+    }
+
+    struct variorum_agg_stats stats;
+    variorum_agg_get_stats(root, &stats);
+    EXPECT_EQ(10u, stats.messages);
+    EXPECT_EQ(0u, stats.partial);
+
+    // A completed bucket does not take more values.
+    ASSERT_EQ(0, variorum_agg_send_sample(nodes[0], b0, 1.0));
+    for (int i = 0; i < 1000 && stats.late == 0; i++)
+    {
+        variorum_agg_run(mid[0], 5);
+        variorum_agg_get_stats(mid[0], &stats);
+    }
+    EXPECT_EQ(1u, stats.late);
+    run_until(3, 3, 5);
+    EXPECT_EQ(5u, out.size());
+}
+
+TEST_F(agg, test_missing_and_lost_nodes)
+{
+    uint64_t b0 = now_bucket();
+
+    // Node 5 stays silent: the bucket completes after its lateness without
+    // it.
+    for (int n = 0; n < 5; n++)
+    {
+        ASSERT_EQ(0, variorum_agg_send_sample(nodes[n], b0, 10.0));
+    }
+    run_until(3, 3, 1);
+    ASSERT_EQ(1u, out.size());
+    EXPECT_EQ(5u, out[0].nodes);
+    EXPECT_EQ(6u, out[0].expected);
+    EXPECT_EQ(50.0, out[0].sum);
+
+    // Node 0 goes away and is no longer expected.
+    close(nodes[0]);
+    nodes[0] = -1;
+    run_until(2, 3);
+    for (int n = 1; n < 6; n++)
+    {
+        ASSERT_EQ(0, variorum_agg_send_sample(nodes[n], b0 + 1, 10.0));
+    }
+    run_until(2, 3, 2);
+    ASSERT_EQ(2u, out.size());
+    EXPECT_EQ(5u, out[1].nodes);
+    EXPECT_EQ(5u, out[1].expected);
+}
+
+TEST_F(agg, test_far_ahead_bucket)
+{
+    struct variorum_agg_stats stats;
+    uint64_t b0 = now_bucket();
+
+    for (int n = 0; n < 6; n++)
+    {
+        ASSERT_EQ(0, variorum_agg_send_sample(nodes[n], b0, 10.0));
+    }
+    // A node with a clock far ahead is dropped and does not move the window.
+    ASSERT_EQ(0, variorum_agg_send_sample(nodes[0], b0 + ((uint64_t)1 << 40),
+                                          10.0));
+    for (int n = 0; n < 6; n++)
+    {
+        ASSERT_EQ(0, variorum_agg_send_sample(nodes[n], b0 + 1, 20.0));
+    }
+    run_until(3, 3, 2);
+    ASSERT_EQ(2u, out.size());
+    EXPECT_EQ(b0, out[0].bucket);
+    EXPECT_EQ(6u, out[0].nodes);
+    EXPECT_EQ(b0 + 1, out[1].bucket);
+    EXPECT_EQ(6u, out[1].nodes);
+    variorum_agg_get_stats(mid[0], &stats);
+    EXPECT_EQ(1u, stats.ahead);
+    EXPECT_EQ(0u, stats.late);
+}
@@ -0,0 +1,124 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <amd_power_features.h>
+#include <variorum_metrics.h>
+}
+
+// Two sockets of five cores each, so CCDs of four cores leave one core in the
+// last CCD of each socket.
+#define NSOCKETS 2
+#define NCORES 10
+#define CPC 4
+
+class amd_cpu_core_power : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            memset(&cps, 0, sizeof(cps));
+            for (int i = 0; i < NCORES; i++)
+            {
+                acc[i] = i + 1;
+                watts[i] = i;
+            }
+            cps.ncores = NCORES;
+            cps.acc = acc;
+            cps.watts = watts;
+            cps.energy_unit = 0.5;
+            cps.now_us = 1000;
+            cps.nsamples = 2;
+            variorum_metric_vector_init(&metrics);
+        }
+
+        void TearDown() override
+        {
+            variorum_metric_vector_free(&metrics);
+        }
+
+        // Value of a metric, or -1 if it was not appended.
+        double value(const char *name, int domain, int index)
+        {
+            for (size_t i = 0; i < metrics.count; i++)
+            {
+                const struct variorum_metric *m = &metrics.metrics[i];
+                if (strcmp(m->name, name) == 0 && m->domain == domain &&
+                    m->index == index)
+                {
+                    return m->value;
+                }
+            }
+            return -1.0;
+        }
+
+        size_t count(int domain)
+        {
+            size_t n = 0;
+
+            for (size_t i = 0; i < metrics.count; i++)
+            {
+                n += (metrics.metrics[i].domain == domain);
+            }
+            return n;
+        }
+
+        struct core_power_sampler cps;
+        uint64_t acc[NCORES];
+        double watts[NCORES];
+        struct variorum_metric_vector metrics;
+};
+
+TEST_F(amd_cpu_core_power, test_per_core)
+{
+    append_core_power_metrics(&metrics, &cps, NSOCKETS, CPC);
+    EXPECT_EQ(2u * NCORES, count(VARIORUM_DOMAIN_CORE));
+    EXPECT_DOUBLE_EQ(0.5, value("energy_cpu_joules", VARIORUM_DOMAIN_CORE, 0));
+    EXPECT_DOUBLE_EQ(5.0, value("energy_cpu_joules", VARIORUM_DOMAIN_CORE, 9));
+    EXPECT_DOUBLE_EQ(0.0, value("power_cpu_watts", VARIORUM_DOMAIN_CORE, 0));
+    EXPECT_DOUBLE_EQ(9.0, value("power_cpu_watts", VARIORUM_DOMAIN_CORE, 9));
+    EXPECT_EQ(1000u, metrics.metrics[0].timestamp_us);
+}
+
+TEST_F(amd_cpu_core_power, test_ccds_within_sockets)
+{
+    append_core_power_metrics(&metrics, &cps, NSOCKETS, CPC);
+    ASSERT_EQ(2u * 4, count(VARIORUM_DOMAIN_CCD));
+    // Socket 0: cores 0-3 and core 4.
+    EXPECT_DOUBLE_EQ(5.0, value("energy_cpu_joules", VARIORUM_DOMAIN_CCD, 0));
+    EXPECT_DOUBLE_EQ(6.0, value("power_cpu_watts", VARIORUM_DOMAIN_CCD, 0));
+    EXPECT_DOUBLE_EQ(2.5, value("energy_cpu_joules", VARIORUM_DOMAIN_CCD, 1));
+    EXPECT_DOUBLE_EQ(4.0, value("power_cpu_watts", VARIORUM_DOMAIN_CCD, 1));
+    // Socket 1: cores 5-8 and core 9.
+    EXPECT_DOUBLE_EQ(15.0, value("energy_cpu_joules", VARIORUM_DOMAIN_CCD, 2));
+    EXPECT_DOUBLE_EQ(26.0, value("power_cpu_watts", VARIORUM_DOMAIN_CCD, 2));
+    EXPECT_DOUBLE_EQ(5.0, value("energy_cpu_joules", VARIORUM_DOMAIN_CCD, 3));
+    EXPECT_DOUBLE_EQ(9.0, value("power_cpu_watts", VARIORUM_DOMAIN_CCD, 3));
+}
+
+TEST_F(amd_cpu_core_power, test_unknown_socket_count)
+{
+    // Without a topology all cores are on one socket: cores 0-3, 4-7, 8-9.
+    append_core_power_metrics(&metrics, &cps, 0, CPC);
+    ASSERT_EQ(2u * 3, count(VARIORUM_DOMAIN_CCD));
+    EXPECT_DOUBLE_EQ(13.0, value("energy_cpu_joules", VARIORUM_DOMAIN_CCD, 1));
+    EXPECT_DOUBLE_EQ(9.5, value("energy_cpu_joules", VARIORUM_DOMAIN_CCD, 2));
+    EXPECT_DOUBLE_EQ(17.0, value("power_cpu_watts", VARIORUM_DOMAIN_CCD, 2));
+}
+
+TEST_F(amd_cpu_core_power, test_no_power_on_first_sample)
+{
+    cps.nsamples = 1;
+    append_core_power_metrics(&metrics, &cps, NSOCKETS, CPC);
+    EXPECT_EQ((size_t)NCORES, count(VARIORUM_DOMAIN_CORE));
+    EXPECT_EQ(4u, count(VARIORUM_DOMAIN_CCD));
+    EXPECT_EQ(-1.0, value("power_cpu_watts", VARIORUM_DOMAIN_CORE, 0));
+    EXPECT_EQ(-1.0, value("power_cpu_watts", VARIORUM_DOMAIN_CCD, 0));
+}
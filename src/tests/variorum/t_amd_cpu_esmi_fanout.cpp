@@ -0,0 +1,116 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdlib.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <amd_esmi_fanout.h>
+#include <e_smi/e_smi.h>
+#include <esmi_stub.h>
+}
+
+static const int NCORES = 96;
+
+class amd_cpu_esmi_fanout : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            esmi_stub_reset(NCORES);
+            esmi_boostlimit_cache_invalidate();
+            results.assign(NCORES, esmi_core_result());
+        }
+
+        std::vector<struct esmi_core_result> results;
+};
+
+TEST_F(amd_cpu_esmi_fanout, test_energy_spread_across_workers)
+{
+    esmi_stub_set_delay_us(100);
+    EXPECT_EQ(0, esmi_core_fanout(ESMI_CORE_ENERGY_GET, NCORES, 4, 0,
+                                  results.data()));
+    EXPECT_EQ(4, esmi_stub_num_threads());
+    for (int i = 0; i < NCORES; i++)
+    {
+        EXPECT_EQ(0, results[i].status);
+        EXPECT_EQ((uint64_t)(i + 1) * 1000000, results[i].value);
+    }
+}
+
+TEST_F(amd_cpu_esmi_fanout, test_single_worker_runs_inline)
+{
+    EXPECT_EQ(0, esmi_core_fanout(ESMI_CORE_BOOSTLIMIT_GET, NCORES, 1, 0,
+                                  results.data()));
+    EXPECT_EQ(1, esmi_stub_num_threads());
+    EXPECT_EQ(3000u, results[NCORES - 1].value);
+}
+
+TEST_F(amd_cpu_esmi_fanout, test_writes_are_deduplicated)
+{
+    EXPECT_EQ(0, esmi_core_fanout(ESMI_CORE_BOOSTLIMIT_SET, NCORES, 2, 2000,
+                                  results.data()));
+    EXPECT_EQ(NCORES, esmi_stub_boostlimit_set_calls());
+    EXPECT_EQ(2000u, esmi_stub_boostlimit(NCORES / 2));
+
+    EXPECT_EQ(0, esmi_core_fanout(ESMI_CORE_BOOSTLIMIT_SET, NCORES, 2, 2000,
+                                  results.data()));
+    EXPECT_EQ(NCORES, esmi_stub_boostlimit_set_calls());
+    for (int i = 0; i < NCORES; i++)
+    {
+        EXPECT_EQ(1, results[i].skipped);
+    }
+
+    EXPECT_EQ(0, esmi_core_fanout(ESMI_CORE_BOOSTLIMIT_SET, NCORES, 2, 2100,
+                                  results.data()));
+    EXPECT_EQ(2 * NCORES, esmi_stub_boostlimit_set_calls());
+
+    esmi_boostlimit_cache_invalidate();
+    EXPECT_EQ(0, esmi_core_fanout(ESMI_CORE_BOOSTLIMIT_SET, NCORES, 2, 2100,
+                                  results.data()));
+    EXPECT_EQ(3 * NCORES, esmi_stub_boostlimit_set_calls());
+}
+
+TEST_F(amd_cpu_esmi_fanout, test_failures_reported_per_core)
+{
+    esmi_stub_fail_core(5, ESMI_PERMISSION);
+    esmi_stub_fail_core(70, ESMI_DEV_BUSY);
+
+    EXPECT_EQ(2, esmi_core_fanout(ESMI_CORE_BOOSTLIMIT_SET, NCORES, 3, 2500,
+                                  results.data()));
+    EXPECT_EQ(ESMI_PERMISSION, results[5].status);
+    EXPECT_EQ(ESMI_DEV_BUSY, results[70].status);
+    EXPECT_EQ(0, results[6].status);
+
+    /* Only the failed cores are retried. */
+    esmi_stub_fail_core(5, ESMI_SUCCESS);
+    esmi_stub_fail_core(70, ESMI_SUCCESS);
+    EXPECT_EQ(0, esmi_core_fanout(ESMI_CORE_BOOSTLIMIT_SET, NCORES, 3, 2500,
+                                  results.data()));
+    EXPECT_EQ(NCORES + 2, esmi_stub_boostlimit_set_calls());
+    EXPECT_EQ(0, results[5].skipped);
+    EXPECT_EQ(1, results[6].skipped);
+}
+
+TEST_F(amd_cpu_esmi_fanout, test_num_workers)
+{
+    unsetenv("VARIORUM_ESMI_WORKERS");
+    EXPECT_EQ(2, esmi_fanout_num_workers(2, NCORES));
+    setenv("VARIORUM_ESMI_WORKERS", "24", 1);
+    EXPECT_EQ(24, esmi_fanout_num_workers(2, NCORES));
+    EXPECT_EQ(8, esmi_fanout_num_workers(2, 8));
+    setenv("VARIORUM_ESMI_WORKERS", "0", 1);
+    EXPECT_EQ(2, esmi_fanout_num_workers(2, NCORES));
+    unsetenv("VARIORUM_ESMI_WORKERS");
+    EXPECT_EQ(1, esmi_fanout_num_workers(0, NCORES));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
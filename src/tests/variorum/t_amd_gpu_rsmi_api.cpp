@@ -0,0 +1,89 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <rocm_smi_stub.h>
+#include <variorum.h>
+}
+
+// The RSMI session is process-wide, so every test runs in a child that
+// starts without one and reports through its exit status.
+static int run_child(void (*body)(void))
+{
+    int status;
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+        if (freopen("/dev/null", "w", stdout) == NULL)
+        {
+            _exit(2);
+        }
+        rsmi_stub_reset(2);
+        body();
+        exit(0);
+    }
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+    {
+        return -1;
+    }
+    return WEXITSTATUS(status);
+}
+
+static void several_queries(void)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        if (variorum_print_power() != 0 || variorum_print_thermals() != 0)
+        {
+            _exit(3);
+        }
+    }
+    if (rsmi_stub_init_count() != 1 || rsmi_stub_shutdown_count() != 0)
+    {
+        _exit(4);
+    }
+}
+
+// Registered before the session is started, so it runs after the session's
+// own exit handler.
+static void check_shut_down(void)
+{
+    _exit(rsmi_stub_shutdown_count() == 1 ? 0 : 5);
+}
+
+static void queries_then_exit(void)
+{
+    atexit(check_shut_down);
+    if (variorum_print_power() != 0)
+    {
+        _exit(3);
+    }
+}
+
+TEST(amd_gpu_rsmi_api, test_session_persists_across_calls)
+{
+    EXPECT_EQ(0, run_child(several_queries));
+}
+
+TEST(amd_gpu_rsmi_api, test_session_shut_down_at_exit)
+{
+    EXPECT_EQ(0, run_child(queries_then_exit));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,79 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <amd_gpu_power_features.h>
+#include <rocm_smi_stub.h>
+}
+
+class amd_gpu_rsmi_session : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            shutdownRSMI();
+            rsmi_stub_reset(4);
+        }
+
+        void TearDown() override
+        {
+            shutdownRSMI();
+        }
+};
+
+TEST_F(amd_gpu_rsmi_session, test_init_once_across_queries)
+{
+    FILE *out = fopen("/dev/null", "w");
+    ASSERT_NE(nullptr, out);
+
+    get_power_data(0, 1, 0, out);
+    get_thermals_data(0, 1, 0, out);
+    get_clocks_data(0, 1, 0, out);
+    get_gpu_utilization_data(0, 1, 0, out);
+    fclose(out);
+
+    EXPECT_EQ(1, rsmi_stub_init_count());
+    EXPECT_EQ(0, rsmi_stub_shutdown_count());
+    EXPECT_EQ(4u, m_num_devices);
+}
+
+TEST_F(amd_gpu_rsmi_session, test_sample_all_gpu_data)
+{
+    struct amd_gpu_sample *samples = NULL;
+
+    ASSERT_EQ(0, sample_all_gpu_data(&samples));
+    ASSERT_NE(nullptr, samples);
+    for (uint32_t i = 0; i < m_num_devices; i++)
+    {
+        EXPECT_DOUBLE_EQ(100.0 + i, samples[i].power_watts);
+        EXPECT_DOUBLE_EQ(40.0 + i, samples[i].temp_celsius);
+        EXPECT_EQ(1000u + i, samples[i].sys_clock_mhz);
+        EXPECT_EQ(1600u, samples[i].mem_clock_mhz);
+        EXPECT_EQ(10u * i, samples[i].util_percent);
+    }
+    /* Five queries per device in a single pass. */
+    EXPECT_EQ(5 * 4, rsmi_stub_query_count());
+    EXPECT_EQ(1, rsmi_stub_init_count());
+}
+
+TEST_F(amd_gpu_rsmi_session, test_shutdown_once)
+{
+    EXPECT_EQ(0, initRSMI());
+    EXPECT_EQ(0, initRSMI());
+    shutdownRSMI();
+    shutdownRSMI();
+
+    EXPECT_EQ(1, rsmi_stub_init_count());
+    EXPECT_EQ(1, rsmi_stub_shutdown_count());
+    EXPECT_EQ(0u, m_num_devices);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,205 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <variorum_error.h>
+#include <variorum_flight.h>
+}
+
+// Samples every millisecond of one socket drawing 100 W, in mJ counts that
+// start just below the 32-bit wrap.
+class flight : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            memset(&cfg, 0, sizeof(cfg));
+            cfg.before = 100;
+            cfg.after = 50;
+            cfg.power_window = 10;
+            cfg.therm_mask = VARIORUM_FLIGHT_THERM_MASK;
+            cfg.cap_changes = 1;
+
+            memset(&snap, 0, sizeof(snap));
+            snap.nsockets = 1;
+            snap.energy_unit_joules = 0.001;
+            snap.dram_energy_unit_joules = 0.001;
+            snap.power_unit_watts = 0.125;
+            snap.pkg_energy[0] = 0xFFFFF000u;
+            snap.pkg_power_limit[0] = 0x8000 | 1200;
+            f = NULL;
+        }
+
+        void TearDown() override
+        {
+            variorum_flight_destroy(f);
+        }
+
+        // Record the next sample, drawing watts on the package.
+        int next(unsigned watts, struct variorum_flight_event *ev)
+        {
+            snap.timestamp_ns += 1000000;
+            snap.pkg_energy[0] += watts;
+            snap.dram_energy[0] += 10;
+            return variorum_flight_record(f, &snap, ev);
+        }
+
+        struct variorum_flight_config cfg;
+        struct variorum_snapshot snap;
+        struct variorum_flight *f;
+};
+
+TEST_F(flight, triggers_once_on_power)
+{
+    struct variorum_flight_event ev;
+    int done = 0;
+    int i;
+
+    cfg.power_watts = 200.0;
+    ASSERT_EQ(0, variorum_flight_create(&cfg, &f));
+    for (i = 0; i < 500; i++)
+    {
+        ASSERT_EQ(0, next(100, &ev));
+    }
+    // Averaged over 10 samples, power reaches 220 W at the 6th sample at
+    // 300 W.
+    for (i = 500; i < 1000; i++)
+    {
+        if (next(300, &ev))
+        {
+            ASSERT_EQ(555, i);
+            done++;
+        }
+    }
+    ASSERT_EQ(1, done);
+    EXPECT_EQ((uint32_t)VARIORUM_FLIGHT_POWER, ev.reasons);
+    EXPECT_EQ(505u, ev.trigger);
+    EXPECT_EQ(405u, ev.first);
+    EXPECT_EQ(555u, ev.last);
+    EXPECT_EQ(506u * 1000000, ev.trigger_ns);
+}
+
+TEST_F(flight, merges_triggers_and_dumps_the_window)
+{
+    struct variorum_flight_event ev;
+    char line[512];
+    int done = 0;
+    int rows = 0;
+    int i;
+    FILE *out;
+
+    ASSERT_EQ(0, variorum_flight_create(&cfg, &f));
+    for (i = 0; i < 300; i++)
+    {
+        // PROCHOT stays asserted from sample 200 on, and the power limit
+        // changes 10 samples later.
+        if (i == 200)
+        {
+            snap.pkg_therm_status[0] = 0x4;
+        }
+        if (i == 210)
+        {
+            snap.pkg_power_limit[0] = 0x8000 | 800;
+        }
+        done += next(100, &ev);
+    }
+    ASSERT_EQ(1, done);
+    EXPECT_EQ((uint32_t)(VARIORUM_FLIGHT_THERMAL | VARIORUM_FLIGHT_CAP),
+              ev.reasons);
+    EXPECT_EQ(200u, ev.trigger);
+
+    out = tmpfile();
+    ASSERT_NE((FILE *)NULL, out);
+    ASSERT_EQ(0, variorum_flight_dump(f, &ev, out));
+    rewind(out);
+    ASSERT_NE((char *)NULL, fgets(line, sizeof(line), out));
+    EXPECT_STREQ("Timestamp (ns),Offset (us),Trigger,Socket_0 Power (W),"
+                 "Mem_0 Power (W),Socket_0 Power Limit (W),"
+                 "Socket_0 Thermal Status\n", line);
+    while (fgets(line, sizeof(line), out) != NULL)
+    {
+        if (rows == 0)
+        {
+            EXPECT_STREQ("101000000,-100000,,100.00,10.00,150.00,0x0\n", line);
+        }
+        if (rows == 100)
+        {
+            EXPECT_STREQ("201000000,0,thermal|cap,100.00,10.00,150.00,0x4\n",
+                         line);
+        }
+        if (rows == 150)
+        {
+            EXPECT_STREQ("251000000,50000,,100.00,10.00,100.00,0x4\n", line);
+        }
+        rows++;
+    }
+    EXPECT_EQ(151, rows);
+    fclose(out);
+}
+
+TEST_F(flight, user_trigger_and_finish)
+{
+    struct variorum_flight_event ev;
+    struct variorum_snapshot copy;
+    int i;
+
+    ASSERT_EQ(0, variorum_flight_create(&cfg, &f));
+    for (i = 0; i < 20; i++)
+    {
+        ASSERT_EQ(0, next(100, &ev));
+    }
+    EXPECT_EQ(0, variorum_flight_finish(f, &ev));
+    variorum_flight_trigger(f);
+    for (i = 20; i < 30; i++)
+    {
+        ASSERT_EQ(0, next(100, &ev));
+    }
+    ASSERT_EQ(1, variorum_flight_finish(f, &ev));
+    EXPECT_EQ((uint32_t)VARIORUM_FLIGHT_USER, ev.reasons);
+    EXPECT_EQ(20u, ev.trigger);
+    EXPECT_EQ(0u, ev.first);
+    EXPECT_EQ(29u, ev.last);
+    EXPECT_EQ(0, variorum_flight_finish(f, &ev));
+
+    ASSERT_EQ(0, variorum_flight_get(f, 29, &copy));
+    EXPECT_EQ(snap.timestamp_ns, copy.timestamp_ns);
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_flight_get(f, 30, &copy));
+}
+
+TEST_F(flight, forgets_old_samples)
+{
+    struct variorum_flight_event ev;
+    struct variorum_snapshot copy;
+    int i;
+
+    ASSERT_EQ(0, variorum_flight_create(&cfg, &f));
+    // The ring holds two windows and the power window.
+    for (i = 0; i < 2 * 151 + 10 + 1; i++)
+    {
+        next(100, &ev);
+    }
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_flight_get(f, 0, &copy));
+    EXPECT_EQ(0, variorum_flight_get(f, 1, &copy));
+
+    ev.first = 0;
+    ev.last = 10;
+    ev.trigger = 5;
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_flight_dump(f, &ev, stdout));
+}
+
+TEST_F(flight, rejects_bad_config)
+{
+    cfg.power_window = 0;
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_flight_create(&cfg, &f));
+    cfg.power_window = 1;
+    cfg.power_watts = -1.0;
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_flight_create(&cfg, &f));
+}
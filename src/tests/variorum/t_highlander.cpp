@@ -0,0 +1,183 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "highlander.h"
+}
+
+// Long enough for a blocked process to have returned if it was not blocked.
+#define BLOCKED_MS 200
+#define REPLY_MS 5000
+
+// A monitor of the node in a child process, as the election state lives in
+// statics. It runs highlander() at once, replies with the result, then runs
+// highlander_wait() on 'w' and highlander_leave() on 'l', replying after each.
+struct monitor
+{
+    pid_t pid;
+    int cmd;
+    int reply;
+};
+
+static void monitor_main(int cmd, int reply)
+{
+    char c = '0' + highlander();
+
+    if (write(reply, &c, 1) != 1)
+    {
+        _exit(1);
+    }
+    while (read(cmd, &c, 1) == 1)
+    {
+        if (c == 'w')
+        {
+            highlander_wait();
+        }
+        else if (c == 'l')
+        {
+            highlander_leave();
+        }
+        if (write(reply, &c, 1) != 1)
+        {
+            _exit(1);
+        }
+    }
+    _exit(0);
+}
+
+static void monitor_start(struct monitor *m)
+{
+    int to[2];
+    int from[2];
+
+    ASSERT_EQ(0, pipe(to));
+    ASSERT_EQ(0, pipe(from));
+    m->pid = fork();
+    ASSERT_GE(m->pid, 0);
+    if (m->pid == 0)
+    {
+        close(to[1]);
+        close(from[0]);
+        monitor_main(to[0], from[1]);
+    }
+    close(to[0]);
+    close(from[1]);
+    m->cmd = to[1];
+    m->reply = from[0];
+}
+
+static void monitor_send(struct monitor *m, char c)
+{
+    ASSERT_EQ(1, write(m->cmd, &c, 1));
+}
+
+// The next reply of a monitor, or 0 if none came within timeout_ms.
+static char monitor_reply(struct monitor *m, int timeout_ms)
+{
+    struct pollfd pfd = { m->reply, POLLIN, 0 };
+    char c = 0;
+
+    if (poll(&pfd, 1, timeout_ms) != 1 || read(m->reply, &c, 1) != 1)
+    {
+        return 0;
+    }
+    return c;
+}
+
+// Exits normally on close, or is killed to model a crash.
+static void monitor_stop(struct monitor *m, bool crash)
+{
+    int status;
+
+    if (crash)
+    {
+        kill(m->pid, SIGKILL);
+    }
+    close(m->cmd);
+    close(m->reply);
+    waitpid(m->pid, &status, 0);
+}
+
+TEST(highlander, test_one_highlander_per_node)
+{
+    struct monitor a, b, c;
+
+    monitor_start(&a);
+    ASSERT_EQ('1', monitor_reply(&a, REPLY_MS));
+    monitor_start(&b);
+    EXPECT_EQ('0', monitor_reply(&b, REPLY_MS));
+    monitor_start(&c);
+    EXPECT_EQ('0', monitor_reply(&c, REPLY_MS));
+    monitor_stop(&c, false);
+    monitor_stop(&b, false);
+    monitor_stop(&a, false);
+}
+
+TEST(highlander, test_handover_after_crash)
+{
+    struct monitor a, b;
+
+    monitor_start(&a);
+    ASSERT_EQ('1', monitor_reply(&a, REPLY_MS));
+    monitor_stop(&a, true);
+
+    // The kernel released the locks of the crashed highlander.
+    monitor_start(&b);
+    EXPECT_EQ('1', monitor_reply(&b, REPLY_MS));
+    monitor_stop(&b, false);
+}
+
+TEST(highlander, test_wait_for_foes)
+{
+    struct monitor a, b, c;
+
+    monitor_start(&a);
+    ASSERT_EQ('1', monitor_reply(&a, REPLY_MS));
+    monitor_start(&b);
+    ASSERT_EQ('0', monitor_reply(&b, REPLY_MS));
+    monitor_start(&c);
+    ASSERT_EQ('0', monitor_reply(&c, REPLY_MS));
+
+    monitor_send(&a, 'w');
+    EXPECT_EQ(0, monitor_reply(&a, BLOCKED_MS));
+    // One foe leaves through highlander_wait(), the other by crashing.
+    monitor_send(&b, 'w');
+    EXPECT_EQ('w', monitor_reply(&b, REPLY_MS));
+    EXPECT_EQ(0, monitor_reply(&a, BLOCKED_MS));
+    monitor_stop(&c, true);
+    EXPECT_EQ('w', monitor_reply(&a, REPLY_MS));
+
+    monitor_stop(&b, false);
+    monitor_stop(&a, false);
+}
+
+TEST(highlander, test_handover_after_leave)
+{
+    struct monitor a, b;
+
+    monitor_start(&a);
+    ASSERT_EQ('1', monitor_reply(&a, REPLY_MS));
+    monitor_send(&a, 'w');
+    ASSERT_EQ('w', monitor_reply(&a, REPLY_MS));
+
+    // A process arriving while the highlander takes its last sample waits
+    // for it to leave, then wins the election.
+    monitor_start(&b);
+    EXPECT_EQ(0, monitor_reply(&b, BLOCKED_MS));
+    monitor_send(&a, 'l');
+    EXPECT_EQ('l', monitor_reply(&a, REPLY_MS));
+    EXPECT_EQ('1', monitor_reply(&b, REPLY_MS));
+
+    monitor_stop(&b, false);
+    monitor_stop(&a, false);
+}
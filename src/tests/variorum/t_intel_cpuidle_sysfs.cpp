@@ -0,0 +1,179 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <cstate_features.h>
+}
+
+#define NCPUS 2
+
+// Exit latencies of POLL, C1, C1E and C6 as reported by intel_idle.
+static const char *latencies[] = {"0\n", "2\n", "10\n", "133\n"};
+
+class intel_cpuidle_sysfs : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char tmpl[] = "/tmp/variorum_cpuidle_XXXXXX";
+            ASSERT_NE((char *)NULL, mkdtemp(tmpl));
+            root = tmpl;
+            for (int c = 0; c < NCPUS; c++)
+            {
+                for (int k = 0; k < 4; k++)
+                {
+                    write_file(state(c, k) + "/latency", latencies[k]);
+                    write_file(state(c, k) + "/disable", "0\n");
+                }
+            }
+        }
+
+        void TearDown() override
+        {
+            std::string cmd = "rm -rf " + root;
+            ASSERT_EQ(0, system(cmd.c_str()));
+        }
+
+        std::string state(int cpu, int k)
+        {
+            return "cpu" + std::to_string(cpu) + "/cpuidle/state" + std::to_string(k);
+        }
+
+        void write_file(const std::string &rel, const char *contents)
+        {
+            std::string path = root + "/" + rel;
+            size_t pos = 0;
+            while ((pos = path.find('/', pos + 1)) != std::string::npos)
+            {
+                mkdir(path.substr(0, pos).c_str(), 0755);
+            }
+            FILE *fp = fopen(path.c_str(), "w");
+            ASSERT_NE((FILE *)NULL, fp);
+            fputs(contents, fp);
+            fclose(fp);
+        }
+
+        int read_disable(int cpu, int k)
+        {
+            std::string path = root + "/" + state(cpu, k) + "/disable";
+            int val = -1;
+            FILE *fp = fopen(path.c_str(), "r");
+            if (fp != NULL)
+            {
+                if (fscanf(fp, "%d", &val) != 1)
+                {
+                    val = -1;
+                }
+                fclose(fp);
+            }
+            return val;
+        }
+
+        std::string root;
+};
+
+TEST_F(intel_cpuidle_sysfs, test_scan)
+{
+    struct cpuidle_table t;
+
+    ASSERT_EQ(0, cpuidle_scan(root.c_str(), NCPUS, &t));
+    EXPECT_EQ(4u, t.nstates[0]);
+    EXPECT_EQ(4u, t.nstates[1]);
+    EXPECT_EQ(133u, t.latency[3]);
+    EXPECT_EQ(10u, t.latency[CPUIDLE_STATE_MAX + 2]);
+    cpuidle_free(&t);
+}
+
+TEST_F(intel_cpuidle_sysfs, test_scan_without_cpuidle)
+{
+    struct cpuidle_table t;
+    std::string empty = root + "/none";
+
+    EXPECT_EQ(-1, cpuidle_scan(empty.c_str(), NCPUS, &t));
+    cpuidle_free(&t);
+}
+
+TEST_F(intel_cpuidle_sysfs, test_limit_latency)
+{
+    struct cpuidle_table t;
+
+    ASSERT_EQ(0, cpuidle_scan(root.c_str(), NCPUS, &t));
+
+    // Only states with an exit latency up to 10 us stay enabled on CPU 1.
+    ASSERT_EQ(0, cpuidle_limit_latency(root.c_str(), &t, 1, 10));
+    EXPECT_EQ(0, read_disable(1, 0));
+    EXPECT_EQ(0, read_disable(1, 1));
+    EXPECT_EQ(0, read_disable(1, 2));
+    EXPECT_EQ(1, read_disable(1, 3));
+    EXPECT_EQ(0, read_disable(0, 3));
+
+    // Polling stays enabled even if the limit is below its latency.
+    write_file(state(0, 0) + "/latency", "1\n");
+    cpuidle_free(&t);
+    ASSERT_EQ(0, cpuidle_scan(root.c_str(), NCPUS, &t));
+    ASSERT_EQ(0, cpuidle_limit_latency(root.c_str(), &t, 0, 0));
+    EXPECT_EQ(0, read_disable(0, 0));
+    EXPECT_EQ(1, read_disable(0, 1));
+    EXPECT_EQ(1, read_disable(0, 3));
+
+    // A negative limit allows all states again.
+    ASSERT_EQ(0, cpuidle_limit_latency(root.c_str(), &t, 0, -1));
+    EXPECT_EQ(0, read_disable(0, 1));
+    EXPECT_EQ(0, read_disable(0, 3));
+    cpuidle_free(&t);
+}
+
+TEST_F(intel_cpuidle_sysfs, test_limit_after_external_change)
+{
+    struct cpuidle_table t;
+
+    ASSERT_EQ(0, cpuidle_scan(root.c_str(), NCPUS, &t));
+    ASSERT_EQ(0, cpuidle_limit_latency(root.c_str(), &t, 0, 10));
+    EXPECT_EQ(1, read_disable(0, 3));
+
+    // Another tool re-enables the state, so the same limit writes it again.
+    write_file(state(0, 3) + "/disable", "0\n");
+    ASSERT_EQ(0, cpuidle_limit_latency(root.c_str(), &t, 0, 10));
+    EXPECT_EQ(1, read_disable(0, 3));
+    cpuidle_free(&t);
+}
+
+TEST_F(intel_cpuidle_sysfs, test_save_restore)
+{
+    struct cpuidle_table t;
+    FILE *fp = tmpfile();
+
+    ASSERT_NE((FILE *)NULL, fp);
+    write_file(state(0, 2) + "/disable", "1\n");
+    ASSERT_EQ(0, cpuidle_scan(root.c_str(), NCPUS, &t));
+    ASSERT_EQ(0, cpuidle_save(root.c_str(), &t, fp));
+    cpuidle_free(&t);
+
+    ASSERT_EQ(0, cpuidle_scan(root.c_str(), NCPUS, &t));
+    ASSERT_EQ(0, cpuidle_limit_latency(root.c_str(), &t, 0, 2));
+    ASSERT_EQ(0, cpuidle_limit_latency(root.c_str(), &t, 1, 2));
+    EXPECT_EQ(1, read_disable(0, 3));
+    EXPECT_EQ(1, read_disable(1, 2));
+    write_file(state(0, 1) + "/disable", "1\n");
+    cpuidle_free(&t);
+
+    // The restore needs only the file, as it may run in another process, and
+    // also reverts knobs changed by someone else.
+    rewind(fp);
+    ASSERT_EQ(0, cpuidle_restore(root.c_str(), fp));
+    EXPECT_EQ(0, read_disable(0, 1));
+    EXPECT_EQ(1, read_disable(0, 2));
+    EXPECT_EQ(0, read_disable(0, 3));
+    EXPECT_EQ(0, read_disable(1, 2));
+    EXPECT_EQ(0, read_disable(1, 3));
+    fclose(fp);
+}
@@ -0,0 +1,73 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <cstate_features.h>
+}
+
+// Two C-state rows and a TSC row for three sockets or cores.
+#define NSTATES 2
+#define N 3
+
+TEST(intel_cstate_residency, test_percent_of_tsc)
+{
+    uint64_t old[(NSTATES + 1) * N] =
+    {
+        100, 200, 300,
+        10, 20, 30,
+        1000, 2000, 3000,
+    };
+    uint64_t now[(NSTATES + 1) * N] =
+    {
+        100 + 500, 200 + 250, 300 + 0,
+        10 + 100, 20 + 1000, 30 + 2000,
+        1000 + 1000, 2000 + 1000, 3000 + 2000,
+    };
+    double percent[NSTATES * N];
+
+    cstate_residency_percent(NSTATES, N, now, old, percent);
+    EXPECT_DOUBLE_EQ(50.0, percent[0]);
+    EXPECT_DOUBLE_EQ(25.0, percent[1]);
+    EXPECT_DOUBLE_EQ(0.0, percent[2]);
+    EXPECT_DOUBLE_EQ(10.0, percent[3]);
+    EXPECT_DOUBLE_EQ(100.0, percent[4]);
+    EXPECT_DOUBLE_EQ(100.0, percent[5]);
+}
+
+TEST(intel_cstate_residency, test_counter_wraparound)
+{
+    uint64_t old[2] = {UINT64_MAX - 9, UINT64_MAX - 99};
+    uint64_t now[2] = {30, 100};
+    double percent[1];
+
+    // 40 residency ticks over 200 TSC ticks, both across the 64-bit boundary.
+    cstate_residency_percent(1, 1, now, old, percent);
+    EXPECT_DOUBLE_EQ(20.0, percent[0]);
+}
+
+TEST(intel_cstate_residency, test_no_tsc_delta)
+{
+    uint64_t old[2] = {100, 5000};
+    uint64_t now[2] = {200, 5000};
+    double percent[1] = {-1.0};
+
+    cstate_residency_percent(1, 1, now, old, percent);
+    EXPECT_DOUBLE_EQ(0.0, percent[0]);
+}
+
+TEST(intel_cstate_residency, test_since_reset)
+{
+    uint64_t old[2] = {0, 0};
+    uint64_t now[2] = {300, 1200};
+    double percent[1];
+
+    // The first sample is taken against zero, i.e., the counters at reset.
+    cstate_residency_percent(1, 1, now, old, percent);
+    EXPECT_DOUBLE_EQ(25.0, percent[0]);
+}
@@ -0,0 +1,206 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <derived_features.h>
+}
+
+// Two sockets with two cores each and two threads per core. Thread t belongs
+// to core t % 4.
+#define NSOCKETS 2
+#define NCORES 4
+#define NTHREADS 8
+
+class intel_derived_metrics : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            ASSERT_EQ(0, derived_metrics_init(&dm, NSOCKETS, NCORES, NTHREADS, 2000,
+                                              48));
+        }
+
+        void TearDown() override
+        {
+            derived_metrics_free(&dm);
+        }
+
+        // Fill in the next snapshot with the same counts on every thread and
+        // the accumulated package energy, and commit it.
+        void take(uint64_t inst, uint64_t cycles, uint64_t aperf, uint64_t mperf,
+                  uint64_t tsc, double joules, uint64_t time_us)
+        {
+            struct derived_snapshot *snap = derived_metrics_next(&dm);
+            for (unsigned i = 0; i < NTHREADS; i++)
+            {
+                snap->inst[i] = inst;
+                snap->core_cycles[i] = cycles;
+                snap->aperf[i] = aperf;
+                snap->mperf[i] = mperf;
+                snap->tsc[i] = tsc;
+            }
+            for (unsigned i = 0; i < NSOCKETS; i++)
+            {
+                snap->pkg_joules[i] = joules * (i + 1);
+            }
+            snap->time_us = time_us;
+            derived_metrics_compute(&dm);
+        }
+
+        struct derived_metrics dm;
+};
+
+TEST_F(intel_derived_metrics, test_invalid_topology)
+{
+    struct derived_metrics bad;
+    EXPECT_EQ(-1, derived_metrics_init(&bad, 0, 4, 8, 2000, 48));
+    EXPECT_EQ(-1, derived_metrics_init(&bad, 2, 3, 6, 2000, 48));
+    EXPECT_EQ(-1, derived_metrics_init(&bad, 2, 4, 2, 2000, 48));
+}
+
+TEST_F(intel_derived_metrics, test_all_domains)
+{
+    const unsigned core0 = NTHREADS;
+    const unsigned socket0 = NTHREADS + NCORES;
+
+    take(0, 0, 0, 0, 0, 0.0, 0);
+    take(1000, 500, 1500, 1000, 4000, 10.0, 1000000);
+
+    EXPECT_EQ(2u, dm.nsamples);
+    EXPECT_DOUBLE_EQ(1.0, dm.elapsed);
+    for (unsigned i = 0; i < NTHREADS + NCORES + NSOCKETS; i++)
+    {
+        EXPECT_DOUBLE_EQ(2.0, dm.ipc[i]);
+        EXPECT_DOUBLE_EQ(3.0, dm.busy_ghz[i]);
+        EXPECT_DOUBLE_EQ(0.75, dm.effective_ghz[i]);
+        EXPECT_DOUBLE_EQ(25.0, dm.util_percent[i]);
+    }
+    // Threads are summed into cores and cores into sockets.
+    EXPECT_DOUBLE_EQ(2000.0, dm.d_inst[core0]);
+    EXPECT_DOUBLE_EQ(16000.0, dm.d_tsc[socket0]);
+    EXPECT_DOUBLE_EQ(10.0, dm.socket_watts[0]);
+    EXPECT_DOUBLE_EQ(20.0, dm.socket_watts[1]);
+    EXPECT_DOUBLE_EQ(400.0, dm.inst_per_joule[0]);
+    EXPECT_DOUBLE_EQ(200.0, dm.inst_per_joule[1]);
+    EXPECT_DOUBLE_EQ(5.0, dm.core_watts[0]);
+    EXPECT_DOUBLE_EQ(10.0, dm.core_watts[3]);
+}
+
+TEST_F(intel_derived_metrics, test_base_frequency_in_mhz)
+{
+    struct derived_metrics base;
+
+    // A max non-turbo ratio of 24 is reported as 2400 MHz.
+    ASSERT_EQ(0, derived_metrics_init(&base, 1, 1, 1, 2400, 48));
+    EXPECT_DOUBLE_EQ(2.4, base.base_ghz);
+    derived_metrics_free(&base);
+
+    take(0, 0, 0, 0, 0, 0.0, 0);
+    take(1000, 1000, 1100, 1000, 2000, 1.0, 1000000);
+    EXPECT_DOUBLE_EQ(2.2, dm.busy_ghz[0]);
+    EXPECT_DOUBLE_EQ(1.1, dm.effective_ghz[0]);
+}
+
+TEST_F(intel_derived_metrics, test_energy_of_own_interval)
+{
+    // Energy is accumulated, and other readers advancing it in between do not
+    // change the interval of the derived metrics.
+    take(0, 0, 0, 0, 0, 100.0, 0);
+    take(1000, 500, 1000, 1000, 1000, 130.0, 1000000);
+    EXPECT_DOUBLE_EQ(30.0, dm.socket_watts[0]);
+    EXPECT_DOUBLE_EQ(60.0, dm.socket_watts[1]);
+    take(2000, 1000, 2000, 2000, 2000, 150.0, 3000000);
+    EXPECT_DOUBLE_EQ(10.0, dm.socket_watts[0]);
+    EXPECT_DOUBLE_EQ(20.0, dm.socket_watts[1]);
+    EXPECT_DOUBLE_EQ(200.0, dm.inst_per_joule[0]);
+}
+
+TEST_F(intel_derived_metrics, test_core_watts_by_mperf_share)
+{
+    struct derived_snapshot *snap;
+
+    take(0, 0, 0, 0, 0, 0.0, 0);
+    snap = derived_metrics_next(&dm);
+    for (unsigned i = 0; i < NTHREADS; i++)
+    {
+        snap->inst[i] = snap->core_cycles[i] = 1000;
+        snap->aperf[i] = snap->mperf[i] = 1000;
+        snap->tsc[i] = 4000;
+    }
+    snap->aperf[0] = snap->mperf[0] = 3000;
+    snap->pkg_joules[0] = 12.0;
+    snap->pkg_joules[1] = 0.0;
+    snap->time_us = 2000000;
+    derived_metrics_compute(&dm);
+
+    EXPECT_DOUBLE_EQ(6.0, dm.socket_watts[0]);
+    EXPECT_DOUBLE_EQ(75.0, dm.util_percent[0]);
+    EXPECT_DOUBLE_EQ(25.0, dm.util_percent[4]);
+    // Core 0 ran 4000 of the 6000 unhalted reference cycles of socket 0.
+    EXPECT_DOUBLE_EQ(4.0, dm.core_watts[0]);
+    EXPECT_DOUBLE_EQ(2.0, dm.core_watts[1]);
+    EXPECT_DOUBLE_EQ(0.0, dm.core_watts[2]);
+    EXPECT_DOUBLE_EQ(0.0, dm.inst_per_joule[1]);
+}
+
+TEST_F(intel_derived_metrics, test_any_thread)
+{
+    dm.any_thread = 1;
+    take(0, 0, 0, 0, 0, 0.0, 0);
+    take(1000, 500, 1000, 1000, 1000, 1.0, 1000000);
+
+    // Both threads of a core report the core total.
+    EXPECT_DOUBLE_EQ(1000.0, dm.d_inst[NTHREADS]);
+    EXPECT_DOUBLE_EQ(2.0, dm.ipc[NTHREADS]);
+    EXPECT_DOUBLE_EQ(2000.0, dm.d_mperf[NTHREADS]);
+    EXPECT_DOUBLE_EQ(2000.0, dm.inst_per_joule[0]);
+}
+
+TEST_F(intel_derived_metrics, test_fixed_counter_wraparound)
+{
+    const uint64_t top = 1ULL << 48;
+
+    take(top - 100, top - 50, 0, 0, 0, 0.0, 0);
+    take(50, 25, 100, 100, 100, 1.0, 1000000);
+
+    EXPECT_DOUBLE_EQ(150.0, dm.d_inst[0]);
+    EXPECT_DOUBLE_EQ(75.0, dm.d_core_cycles[0]);
+    EXPECT_DOUBLE_EQ(2.0, dm.ipc[0]);
+}
+
+TEST_F(intel_derived_metrics, test_append)
+{
+    struct variorum_metric_vector vec;
+    struct variorum_metric *m;
+
+    variorum_metric_vector_init(&vec);
+    take(0, 0, 0, 0, 0, 0.0, 0);
+    derived_metrics_append(&dm, &vec);
+    EXPECT_EQ(0u, vec.count);
+
+    take(1000, 500, 1500, 1000, 4000, 10.0, 1000000);
+    derived_metrics_append(&dm, &vec);
+    // Four metrics per thread, core and socket, watts per core and socket, and
+    // instructions per Joule per socket.
+    EXPECT_EQ(4u * (NTHREADS + NCORES + NSOCKETS) + NCORES + 2 * NSOCKETS,
+              vec.count);
+
+    m = variorum_metric_vector_find(&vec, "ipc_cpu", VARIORUM_DOMAIN_THREAD, 7);
+    ASSERT_NE((struct variorum_metric *)NULL, m);
+    EXPECT_DOUBLE_EQ(2.0, m->value);
+    m = variorum_metric_vector_find(&vec, "inst_cpu_per_joule",
+                                    VARIORUM_DOMAIN_SOCKET, 1);
+    ASSERT_NE((struct variorum_metric *)NULL, m);
+    EXPECT_DOUBLE_EQ(200.0, m->value);
+    m = variorum_metric_vector_find(&vec, "power_cpu_watts", VARIORUM_DOMAIN_CORE,
+                                    2);
+    ASSERT_NE((struct variorum_metric *)NULL, m);
+    EXPECT_DOUBLE_EQ(10.0, m->value);
+    variorum_metric_vector_free(&vec);
+}
@@ -0,0 +1,133 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <perf_rapl_features.h>
+}
+
+class intel_perf_rapl_sysfs : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char tmpl[] = "/tmp/variorum_perf_rapl_XXXXXX";
+            ASSERT_NE((char *)NULL, mkdtemp(tmpl));
+            root = tmpl;
+        }
+
+        void TearDown() override
+        {
+            std::string cmd = "rm -rf " + root;
+            ASSERT_EQ(0, system(cmd.c_str()));
+        }
+
+        void write_file(const std::string &rel, const char *contents)
+        {
+            std::string path = root + "/" + rel;
+            size_t pos = 0;
+            while ((pos = path.find('/', pos + 1)) != std::string::npos)
+            {
+                mkdir(path.substr(0, pos).c_str(), 0755);
+            }
+            FILE *fp = fopen(path.c_str(), "w");
+            ASSERT_NE((FILE *)NULL, fp);
+            fputs(contents, fp);
+            fclose(fp);
+        }
+
+        // The power PMU of a two-socket server without psys.
+        void add_pmu(void)
+        {
+            write_file("type", "23\n");
+            write_file("cpumask", "0,28\n");
+            write_file("events/energy-pkg", "event=0x02\n");
+            write_file("events/energy-pkg.scale", "2.3283064365386962890625e-10\n");
+            write_file("events/energy-pkg.unit", "Joules\n");
+            write_file("events/energy-ram", "event=0x03\n");
+            write_file("events/energy-ram.scale", "6.103515625e-05\n");
+        }
+
+        std::string root;
+};
+
+TEST_F(intel_perf_rapl_sysfs, test_parse_pmu)
+{
+    struct perf_rapl_data data;
+
+    add_pmu();
+    ASSERT_EQ(0, perf_rapl_parse_pmu(root.c_str(), &data));
+    EXPECT_EQ(23, data.pmu_type);
+    ASSERT_EQ(2u, data.nsockets);
+    EXPECT_EQ(0, data.cpu[0]);
+    EXPECT_EQ(28, data.cpu[1]);
+
+    EXPECT_EQ(1, data.events[PERF_RAPL_PKG].present);
+    EXPECT_EQ(0x02u, data.events[PERF_RAPL_PKG].config);
+    EXPECT_DOUBLE_EQ(2.3283064365386962890625e-10,
+                     data.events[PERF_RAPL_PKG].scale);
+    EXPECT_STREQ("Joules", data.events[PERF_RAPL_PKG].unit);
+
+    // Without a unit file the unit defaults to Joules.
+    EXPECT_EQ(1, data.events[PERF_RAPL_RAM].present);
+    EXPECT_EQ(0x03u, data.events[PERF_RAPL_RAM].config);
+    EXPECT_DOUBLE_EQ(6.103515625e-05, data.events[PERF_RAPL_RAM].scale);
+    EXPECT_STREQ("Joules", data.events[PERF_RAPL_RAM].unit);
+
+    EXPECT_EQ(0, data.events[PERF_RAPL_PSYS].present);
+    EXPECT_EQ(-1, data.events[PERF_RAPL_PSYS].slot);
+    perf_rapl_close(&data);
+    EXPECT_EQ((int *)NULL, data.cpu);
+}
+
+TEST_F(intel_perf_rapl_sysfs, test_parse_pmu_missing)
+{
+    struct perf_rapl_data data;
+
+    // No PMU.
+    EXPECT_EQ(-1, perf_rapl_parse_pmu(root.c_str(), &data));
+
+    // No package event.
+    write_file("type", "23\n");
+    write_file("cpumask", "0\n");
+    write_file("events/energy-ram", "event=0x03\n");
+    write_file("events/energy-ram.scale", "6.103515625e-05\n");
+    EXPECT_EQ(-1, perf_rapl_parse_pmu(root.c_str(), &data));
+
+    // A package event without a scale is not usable.
+    write_file("events/energy-pkg", "event=0x02\n");
+    EXPECT_EQ(-1, perf_rapl_parse_pmu(root.c_str(), &data));
+
+    // No CPUs to open the events on.
+    write_file("events/energy-pkg.scale", "2.3283064365386962890625e-10\n");
+    write_file("cpumask", "\n");
+    EXPECT_EQ(-1, perf_rapl_parse_pmu(root.c_str(), &data));
+    EXPECT_EQ((int *)NULL, data.cpu);
+}
+
+TEST_F(intel_perf_rapl_sysfs, test_parse_cpumask)
+{
+    int *cpus = NULL;
+
+    ASSERT_EQ(6u, perf_sysfs_parse_cpumask("0-2,8,10-11", &cpus));
+    EXPECT_EQ(0, cpus[0]);
+    EXPECT_EQ(1, cpus[1]);
+    EXPECT_EQ(2, cpus[2]);
+    EXPECT_EQ(8, cpus[3]);
+    EXPECT_EQ(10, cpus[4]);
+    EXPECT_EQ(11, cpus[5]);
+    free(cpus);
+
+    // Grows past the initial capacity.
+    ASSERT_EQ(20u, perf_sysfs_parse_cpumask("0-19", &cpus));
+    EXPECT_EQ(19, cpus[19]);
+    free(cpus);
+}
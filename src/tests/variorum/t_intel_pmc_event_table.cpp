@@ -0,0 +1,119 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <pmc_event_table.h>
+}
+
+static const struct pmc_event_table *tables[] =
+{
+    &pmc_events_architectural,
+    &pmc_events_sandybridge,
+    &pmc_events_ivybridge,
+    &pmc_events_haswell,
+    &pmc_events_broadwell,
+    &pmc_events_skylakex,
+    &pmc_events_kabylake,
+};
+
+TEST(intel_pmc_event_table, test_every_event_found)
+{
+    for (const struct pmc_event_table *t : tables)
+    {
+        uint32_t found = 0;
+
+        ASSERT_EQ(0u, t->nslots & (t->nslots - 1)) << t->uarch;
+        for (uint32_t i = 0; i < t->nslots; i++)
+        {
+            const struct pmc_event_def *def = &t->slots[i];
+            if (def->name == NULL)
+            {
+                continue;
+            }
+            found++;
+            EXPECT_EQ(def, pmc_event_lookup(t, def->name))
+                    << t->uarch << " " << def->name;
+
+            std::string lower(def->name);
+            for (char &c : lower)
+            {
+                c = tolower((unsigned char)c);
+            }
+            EXPECT_EQ(def, pmc_event_lookup(t, lower.c_str()))
+                    << t->uarch << " " << lower;
+            EXPECT_NE(0, def->counters) << t->uarch << " " << def->name;
+        }
+        EXPECT_EQ(t->nevents, found) << t->uarch;
+    }
+}
+
+TEST(intel_pmc_event_table, test_unknown_event_not_found)
+{
+    for (const struct pmc_event_table *t : tables)
+    {
+        EXPECT_EQ(NULL, pmc_event_lookup(t, "NOT_AN_EVENT"));
+        EXPECT_EQ(NULL, pmc_event_lookup(t, ""));
+        EXPECT_EQ(NULL, pmc_event_lookup(t, NULL));
+    }
+    EXPECT_EQ(NULL, pmc_event_lookup(NULL, "INST_RETIRED.ANY_P"));
+}
+
+TEST(intel_pmc_event_table, test_model_specific_encoding)
+{
+    const struct pmc_event_def *def;
+
+    def = pmc_event_lookup(&pmc_events_skylakex, "MACHINE_CLEARS.COUNT");
+    ASSERT_NE((const struct pmc_event_def *)NULL, def);
+    EXPECT_EQ(0xC3, def->eventsel);
+    EXPECT_EQ(0x01, def->umask);
+    EXPECT_EQ(NULL, pmc_event_lookup(&pmc_events_sandybridge,
+                                     "MACHINE_CLEARS.COUNT"));
+}
+
+#ifdef GEN_PMC_EVENTS
+static std::string read_file(const std::string &path)
+{
+    std::ifstream in(path.c_str());
+    std::stringstream ss;
+
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// The checked-in tables must match their definitions.
+TEST(intel_pmc_event_table, test_tables_up_to_date)
+{
+    char tmpl[] = "/tmp/t_intel_pmc_event_table.XXXXXX";
+    int fd = mkstemp(tmpl);
+
+    ASSERT_GE(fd, 0);
+    close(fd);
+    for (const struct pmc_event_table *t : tables)
+    {
+        std::string dir = PMC_EVENTS_DIR;
+        std::string table = dir + "/pmc_events_" + t->uarch + ".c";
+        std::string cmd = std::string(GEN_PMC_EVENTS) + " " + t->uarch + " " +
+                          dir + "/" + t->uarch + ".def " + tmpl;
+
+        ASSERT_EQ(0, system(cmd.c_str())) << t->uarch;
+        std::string expected = read_file(tmpl);
+        EXPECT_FALSE(expected.empty()) << t->uarch;
+        EXPECT_EQ(expected, read_file(table)) << table << " is out of date, "
+                                                 "build pmc_events_tables";
+    }
+    unlink(tmpl);
+}
+#endif
@@ -0,0 +1,68 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <counters_features.h>
+}
+
+TEST(intel_pmc_groups, test_encode_architectural_event)
+{
+    uint64_t evtsel = 0;
+    uint8_t counters = 0;
+
+    // Enable, OS and user flags added to event 0x2E, unit mask 0x41.
+    ASSERT_EQ(0, pmc_event_encode("LLC_MISSES", &evtsel, &counters));
+    EXPECT_EQ(0x43412Eu, evtsel);
+    EXPECT_EQ(0xFF, counters);
+    ASSERT_EQ(0, pmc_event_encode("llc_misses", &evtsel, &counters));
+    EXPECT_EQ(0x43412Eu, evtsel);
+}
+
+TEST(intel_pmc_groups, test_encode_raw_event)
+{
+    uint64_t evtsel = 0;
+    uint8_t counters = 0;
+
+    // Without flags the event counts in user and OS mode.
+    ASSERT_EQ(0, pmc_event_encode("r01c2", &evtsel, &counters));
+    EXPECT_EQ(0x4301C2u, evtsel);
+    EXPECT_EQ(0xFF, counters);
+    ASSERT_EQ(0, pmc_event_encode("0x01C2", &evtsel, &counters));
+    EXPECT_EQ(0x4301C2u, evtsel);
+
+    // Given flags and counter mask are kept, with the enable bit set.
+    ASSERT_EQ(0, pmc_event_encode("R0105003C", &evtsel, &counters));
+    EXPECT_EQ(0x0145003Cu, evtsel);
+}
+
+TEST(intel_pmc_groups, test_encode_invalid_event)
+{
+    uint64_t evtsel = 0;
+    uint8_t counters = 0;
+
+    EXPECT_EQ(-1, pmc_event_encode("NOT_AN_EVENT", &evtsel, &counters));
+    EXPECT_EQ(-1, pmc_event_encode("r", &evtsel, &counters));
+    EXPECT_EQ(-1, pmc_event_encode("0x", &evtsel, &counters));
+    EXPECT_EQ(-1, pmc_event_encode("r01g2", &evtsel, &counters));
+    EXPECT_EQ(-1, pmc_event_encode("r100000000", &evtsel, &counters));
+}
+
+TEST(intel_pmc_groups, test_scale_count)
+{
+    // Group on the counters for a third of the time.
+    EXPECT_EQ(300u, pmc_scale_count(100, 3000, 1000));
+    // Group on the counters the whole time.
+    EXPECT_EQ(100u, pmc_scale_count(100, 1000, 1000));
+    EXPECT_EQ(100u, pmc_scale_count(100, 1000, 1001));
+    // Group never ran.
+    EXPECT_EQ(0u, pmc_scale_count(100, 1000, 0));
+    // No overflow of the intermediate product.
+    EXPECT_EQ(UINT64_C(1) << 62, pmc_scale_count(UINT64_C(1) << 61, 2000000000,
+                                                 1000000000));
+}
@@ -0,0 +1,75 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <misc_features.h>
+}
+
+#define NCORES 3
+
+// Reserved and unrelated bits of MSR_MISC_FEATURE_CONTROL.
+#define OTHER_BITS 0xFFFFFFFF00000F00ULL
+
+TEST(intel_prefetch_control, test_set_per_core_bits)
+{
+    uint64_t vals[NCORES] = {0, 0, 0};
+    int disable_bits[NCORES] =
+    {
+        PREFETCH_L2_STREAMER_DISABLE,
+        PREFETCH_DCU_DISABLE | PREFETCH_DCU_IP_DISABLE,
+        0
+    };
+
+    prefetch_control_merge(NCORES, disable_bits, vals);
+    EXPECT_EQ(0x1u, vals[0]);
+    EXPECT_EQ(0xCu, vals[1]);
+    EXPECT_EQ(0x0u, vals[2]);
+}
+
+TEST(intel_prefetch_control, test_keep_other_bits)
+{
+    uint64_t vals[NCORES] =
+    {
+        OTHER_BITS | PREFETCH_DISABLE_MASK,
+        OTHER_BITS,
+        OTHER_BITS | PREFETCH_L2_ADJACENT_DISABLE
+    };
+    int disable_bits[NCORES] =
+    {
+        0,
+        PREFETCH_DISABLE_MASK,
+        PREFETCH_L2_ADJACENT_DISABLE
+    };
+
+    // Prefetchers are re-enabled as well as disabled, and nothing else moves.
+    prefetch_control_merge(NCORES, disable_bits, vals);
+    EXPECT_EQ(OTHER_BITS, vals[0]);
+    EXPECT_EQ(OTHER_BITS | PREFETCH_DISABLE_MASK, vals[1]);
+    EXPECT_EQ(OTHER_BITS | PREFETCH_L2_ADJACENT_DISABLE, vals[2]);
+}
+
+TEST(intel_prefetch_control, test_ignore_bits_outside_mask)
+{
+    uint64_t vals[NCORES] = {0, 0, 0};
+    int disable_bits[NCORES] = {0x10 | PREFETCH_DCU_DISABLE, -1, 0x100};
+
+    prefetch_control_merge(NCORES, disable_bits, vals);
+    EXPECT_EQ((uint64_t)PREFETCH_DCU_DISABLE, vals[0]);
+    EXPECT_EQ((uint64_t)PREFETCH_DISABLE_MASK, vals[1]);
+    EXPECT_EQ(0u, vals[2]);
+}
+
+TEST(intel_prefetch_control, test_no_cores)
+{
+    uint64_t vals[1] = {OTHER_BITS};
+    int disable_bits[1] = {PREFETCH_DISABLE_MASK};
+
+    prefetch_control_merge(0, disable_bits, vals);
+    EXPECT_EQ(OTHER_BITS, vals[0]);
+}
@@ -0,0 +1,69 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <misc_features.h>
+}
+
+// Two cores with two hardware threads each; thread t is on core t % 2.
+#define NCORES 2
+#define NTHREADS 4
+
+// IA32_PERF_CTL requesting ratio 0x1A.
+#define RATIO 0x1A00ULL
+
+TEST(intel_turbo_cores, test_disengage_selected_core)
+{
+    uint64_t vals[NTHREADS] = {RATIO, RATIO, RATIO, RATIO};
+    unsigned changed[NTHREADS];
+    int mask[NCORES] = {0, 1};
+
+    ASSERT_EQ(2u, turbo_core_merge(NTHREADS, NCORES, mask, 0, vals, changed));
+    EXPECT_EQ(1u, changed[0]);
+    EXPECT_EQ(3u, changed[1]);
+    EXPECT_EQ(RATIO, vals[0]);
+    EXPECT_EQ(RATIO | PERF_CTL_TURBO_DISENGAGE, vals[1]);
+    EXPECT_EQ(RATIO, vals[2]);
+    EXPECT_EQ(RATIO | PERF_CTL_TURBO_DISENGAGE, vals[3]);
+}
+
+TEST(intel_turbo_cores, test_skip_unchanged_threads)
+{
+    uint64_t vals[NTHREADS] =
+    {
+        RATIO | PERF_CTL_TURBO_DISENGAGE, RATIO,
+        RATIO, RATIO | PERF_CTL_TURBO_DISENGAGE
+    };
+    unsigned changed[NTHREADS];
+    int mask[NCORES] = {1, 1};
+
+    // Only the threads that still have turbo need a write.
+    ASSERT_EQ(2u, turbo_core_merge(NTHREADS, NCORES, mask, 0, vals, changed));
+    EXPECT_EQ(1u, changed[0]);
+    EXPECT_EQ(2u, changed[1]);
+    EXPECT_EQ(0u, turbo_core_merge(NTHREADS, NCORES, mask, 0, vals, changed));
+}
+
+TEST(intel_turbo_cores, test_enable_keeps_ratio)
+{
+    uint64_t vals[NTHREADS] =
+    {
+        RATIO | PERF_CTL_TURBO_DISENGAGE, RATIO | PERF_CTL_TURBO_DISENGAGE,
+        RATIO | PERF_CTL_TURBO_DISENGAGE, RATIO | PERF_CTL_TURBO_DISENGAGE
+    };
+    unsigned changed[NTHREADS];
+    int mask[NCORES] = {1, 0};
+
+    ASSERT_EQ(2u, turbo_core_merge(NTHREADS, NCORES, mask, 1, vals, changed));
+    EXPECT_EQ(0u, changed[0]);
+    EXPECT_EQ(2u, changed[1]);
+    EXPECT_EQ(RATIO, vals[0]);
+    EXPECT_EQ(RATIO | PERF_CTL_TURBO_DISENGAGE, vals[1]);
+    EXPECT_EQ(RATIO, vals[2]);
+}
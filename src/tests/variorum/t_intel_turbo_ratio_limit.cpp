@@ -0,0 +1,103 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <misc_features.h>
+}
+
+// Broadwell server: 3.6 GHz for 1-2 cores down to 2.6 GHz for 16 cores.
+#define BDX_LIMIT  0x1A1A1C1C1E202424ULL
+#define BDX_LIMIT1 0x1A1A1A1A1A1A1A1AULL
+
+// Skylake server: 3.7 GHz up to 2 cores, then 2, 4, ..., 28 core buckets.
+#define SKX_LIMIT 0x1E1E1F2022232525ULL
+#define SKX_CORES 0x1C18140E0C080402ULL
+
+TEST(intel_turbo_ratio_limit, test_fixed_buckets)
+{
+    uint64_t limit = BDX_LIMIT;
+    uint64_t limit1 = BDX_LIMIT1;
+    int mhz[3] = {3400, 3400, 3000};
+
+    ASSERT_EQ(0, turbo_ratio_limit_merge(3, NULL, mhz, &limit, &limit1, NULL));
+    EXPECT_EQ(0x1A1A1C1C1E1E2222ULL, limit);
+    EXPECT_EQ(BDX_LIMIT1, limit1);
+
+    // Bucket i is fixed at i + 1 active cores.
+    int cores[3] = {1, 2, 3};
+    limit = BDX_LIMIT;
+    ASSERT_EQ(0, turbo_ratio_limit_merge(3, cores, mhz, &limit, &limit1,
+                                         NULL));
+    EXPECT_EQ(0x1A1A1C1C1E1E2222ULL, limit);
+    cores[2] = 4;
+    EXPECT_EQ(-1, turbo_ratio_limit_merge(3, cores, mhz, &limit, &limit1,
+                                          NULL));
+}
+
+TEST(intel_turbo_ratio_limit, test_sixteen_buckets)
+{
+    uint64_t limit = BDX_LIMIT;
+    uint64_t limit1 = BDX_LIMIT1;
+    int mhz[16];
+
+    for (int i = 0; i < 16; i++)
+    {
+        mhz[i] = 2500;
+    }
+    ASSERT_EQ(0, turbo_ratio_limit_merge(16, NULL, mhz, &limit, &limit1,
+                                         NULL));
+    EXPECT_EQ(0x1919191919191919ULL, limit);
+    EXPECT_EQ(0x1919191919191919ULL, limit1);
+
+    // Without MSR_TURBO_RATIO_LIMIT1 only 8 buckets exist.
+    EXPECT_EQ(-1, turbo_ratio_limit_merge(9, NULL, mhz, &limit, NULL, NULL));
+}
+
+TEST(intel_turbo_ratio_limit, test_programmable_core_counts)
+{
+    uint64_t limit = SKX_LIMIT;
+    uint64_t cores = SKX_CORES;
+    int count[2] = {3, 6};
+    int mhz[2] = {3700, 3600};
+
+    ASSERT_EQ(0, turbo_ratio_limit_merge(2, count, mhz, &limit, NULL,
+                                         &cores));
+    EXPECT_EQ(0x1E1E1F2022232425ULL, limit);
+    EXPECT_EQ(0x1C18140E0C080603ULL, cores);
+
+    // Bucket 1 may not cover fewer cores than bucket 0.
+    cores = SKX_CORES;
+    count[1] = 3;
+    EXPECT_EQ(-1, turbo_ratio_limit_merge(2, count, mhz, &limit, NULL,
+                                          &cores));
+    EXPECT_EQ(SKX_CORES, cores);
+}
+
+TEST(intel_turbo_ratio_limit, test_invalid_limits)
+{
+    uint64_t limit = BDX_LIMIT;
+    uint64_t limit1 = BDX_LIMIT1;
+    int mhz[2] = {3000, 3200};
+
+    // More active cores may not raise the limit, including against the
+    // buckets that are left unchanged.
+    EXPECT_EQ(-1, turbo_ratio_limit_merge(2, NULL, mhz, &limit, &limit1,
+                                          NULL));
+    mhz[0] = 3650;
+    EXPECT_EQ(-1, turbo_ratio_limit_merge(1, NULL, mhz, &limit, &limit1,
+                                          NULL));
+    mhz[0] = 2000;
+    EXPECT_EQ(-1, turbo_ratio_limit_merge(1, NULL, mhz, &limit, &limit1,
+                                          NULL));
+    EXPECT_EQ(-1, turbo_ratio_limit_merge(0, NULL, mhz, &limit, &limit1,
+                                          NULL));
+    EXPECT_EQ(BDX_LIMIT, limit);
+    EXPECT_EQ(BDX_LIMIT1, limit1);
+}
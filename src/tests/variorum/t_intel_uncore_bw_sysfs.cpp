@@ -0,0 +1,104 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <uncore_bw_features.h>
+}
+
+class intel_uncore_bw_sysfs : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char tmpl[] = "/tmp/variorum_uncore_XXXXXX";
+            ASSERT_NE((char *)NULL, mkdtemp(tmpl));
+            root = tmpl;
+            unsetenv("VARIORUM_UNCORE_NUM_CHA");
+        }
+
+        void TearDown() override
+        {
+            std::string cmd = "rm -rf " + root;
+            ASSERT_EQ(0, system(cmd.c_str()));
+        }
+
+        void write_file(const std::string &rel, const char *contents)
+        {
+            std::string path = root + "/" + rel;
+            size_t pos = 0;
+            while ((pos = path.find('/', pos + 1)) != std::string::npos)
+            {
+                mkdir(path.substr(0, pos).c_str(), 0755);
+            }
+            FILE *fp = fopen(path.c_str(), "w");
+            ASSERT_NE((FILE *)NULL, fp);
+            fputs(contents, fp);
+            fclose(fp);
+        }
+
+        void add_imc(int id, const char *type)
+        {
+            std::string dir = "uncore_imc_" + std::to_string(id);
+            write_file(dir + "/type", type);
+            write_file(dir + "/cpumask", "0,28\n");
+            write_file(dir + "/events/cas_count_read", "event=0x04,umask=0x03\n");
+            write_file(dir + "/events/cas_count_write", "event=0x04,umask=0x0c\n");
+        }
+
+        std::string root;
+};
+
+TEST_F(intel_uncore_bw_sysfs, test_parse_imc)
+{
+    struct uncore_bw_data data = {};
+
+    add_imc(2, "17\n");
+    add_imc(0, "15\n");
+    add_imc(1, "16\n");
+    write_file("uncore_imc_free_running_0/type", "30\n");
+
+    ASSERT_EQ(0, uncore_bw_parse_imc(root.c_str(), &data));
+    EXPECT_EQ(2u, data.nsockets);
+    EXPECT_EQ(0, data.cpu[0]);
+    EXPECT_EQ(28, data.cpu[1]);
+    ASSERT_EQ(3u, data.nboxes);
+    EXPECT_EQ(15, data.pmu_type[0]);
+    EXPECT_EQ(16, data.pmu_type[1]);
+    EXPECT_EQ(17, data.pmu_type[2]);
+    EXPECT_EQ(0x0304u, data.imc_reads);
+    EXPECT_EQ(0x0c04u, data.imc_writes);
+    free(data.cpu);
+    free(data.pmu_type);
+}
+
+TEST_F(intel_uncore_bw_sysfs, test_parse_imc_missing)
+{
+    struct uncore_bw_data data = {};
+
+    write_file("uncore_imc_free_running_0/type", "30\n");
+    EXPECT_EQ(-1, uncore_bw_parse_imc(root.c_str(), &data));
+    EXPECT_EQ(-1, uncore_bw_parse_imc("/nonexistent", &data));
+}
+
+TEST_F(intel_uncore_bw_sysfs, test_cha_count)
+{
+    EXPECT_EQ(24u, uncore_cha_count(root.c_str(), 24));
+
+    write_file("uncore_cha_0/type", "20\n");
+    write_file("uncore_cha_1/type", "21\n");
+    write_file("uncore_cha_2/type", "22\n");
+    EXPECT_EQ(3u, uncore_cha_count(root.c_str(), 24));
+
+    setenv("VARIORUM_UNCORE_NUM_CHA", "40", 1);
+    EXPECT_EQ(40u, uncore_cha_count(root.c_str(), 24));
+    unsetenv("VARIORUM_UNCORE_NUM_CHA");
+}
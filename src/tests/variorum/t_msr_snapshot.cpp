@@ -0,0 +1,188 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <msr_snapshot.h>
+#include <variorum_error.h>
+}
+
+// Each logical CPU is a sparse file with registers stored at their address,
+// like /dev/cpu/N/msr. A file holds 8 bytes per address, so the registers
+// used here are 8 apart.
+class msr_snapshot : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char fmt[] = "/tmp/t_msr_snapshot_XXXXXX";
+
+            ASSERT_NE((char *)NULL, mkdtemp(fmt));
+            dir = fmt;
+            path_fmt = dir + "/%d";
+            ncpus = (unsigned)sysconf(_SC_NPROCESSORS_CONF);
+            for (unsigned i = 0; i < ncpus; i++)
+            {
+                write_msr(i, 0x611, 0x100000000ULL + 1000 + i);
+                write_msr(i, 0x608, 2000 + i);
+                write_msr(i, 0x620, 0x8000ULL | (100 * 8 + i));
+                write_msr(i, 0x628, 0x4ULL | i);
+                write_msr(i, 0x400, 10 * i + 1);
+                write_msr(i, 0x408, 10 * i + 2);
+                write_msr(i, 0x410, 10 * i + 3);
+                write_msr(i, 0x418, 10 * i + 4);
+                write_msr(i, 0x420, 10 * i + 5);
+            }
+
+            memset(&cfg, 0, sizeof(cfg));
+            cfg.cpu_path_fmt = path_fmt.c_str();
+            cfg.batch_path = NULL;
+            cfg.ncpus = ncpus;
+            cfg.nsockets = 1;
+            cfg.socket_cpu[0] = 0;
+            cfg.pkg_energy_msr = 0x611;
+            cfg.dram_energy_msr = 0x608;
+            cfg.pkg_power_limit_msr = 0x620;
+            cfg.pkg_therm_status_msr = 0x628;
+            cfg.cpu_msrs[SNAPSHOT_INSTRUCTIONS] = 0x400;
+            cfg.cpu_msrs[SNAPSHOT_CORE_CYCLES] = 0x408;
+            cfg.cpu_msrs[SNAPSHOT_REF_CYCLES] = 0x410;
+            cfg.cpu_msrs[SNAPSHOT_APERF] = 0x418;
+            cfg.cpu_msrs[SNAPSHOT_MPERF] = 0x420;
+            cfg.energy_unit_joules = 1.0 / 16384;
+            cfg.dram_energy_unit_joules = 1.0 / 65536;
+            cfg.power_unit_watts = 1.0 / 8;
+        }
+
+        void TearDown() override
+        {
+            char filename[512];
+
+            msr_snapshot_disarm();
+            for (unsigned i = 0; i < ncpus; i++)
+            {
+                snprintf(filename, sizeof(filename), path_fmt.c_str(), i);
+                unlink(filename);
+            }
+            rmdir(dir.c_str());
+        }
+
+        void write_msr(unsigned cpu, off_t msr, uint64_t value)
+        {
+            char filename[512];
+            int fd;
+
+            snprintf(filename, sizeof(filename), path_fmt.c_str(), cpu);
+            fd = open(filename, O_WRONLY | O_CREAT, 0600);
+            ASSERT_GE(fd, 0);
+            ASSERT_EQ((ssize_t)sizeof(value), pwrite(fd, &value, sizeof(value), msr));
+            close(fd);
+        }
+
+        void expect_snapshot(const struct variorum_snapshot *snap)
+        {
+            uint64_t c = (uint64_t)snap->cpu;
+
+            ASSERT_GE(snap->cpu, 0);
+            ASSERT_LT((unsigned)snap->cpu, ncpus);
+            EXPECT_EQ(1u, snap->nsockets);
+            // Energy is read on the socket's CPU and truncated to 32 bits.
+            EXPECT_EQ(1000u, snap->pkg_energy[0]);
+            EXPECT_EQ(2000u, snap->dram_energy[0]);
+            EXPECT_EQ(0u, snap->pkg_energy[1]);
+            EXPECT_EQ(0x8000ULL | 800, snap->pkg_power_limit[0]);
+            EXPECT_EQ(0x4ULL, snap->pkg_therm_status[0]);
+            EXPECT_DOUBLE_EQ(1.0 / 8, snap->power_unit_watts);
+            EXPECT_DOUBLE_EQ(1.0 / 16384, snap->energy_unit_joules);
+            EXPECT_DOUBLE_EQ(1.0 / 65536, snap->dram_energy_unit_joules);
+            EXPECT_EQ(10 * c + 1, snap->instructions);
+            EXPECT_EQ(10 * c + 2, snap->core_cycles);
+            EXPECT_EQ(10 * c + 3, snap->ref_cycles);
+            EXPECT_EQ(10 * c + 4, snap->aperf);
+            EXPECT_EQ(10 * c + 5, snap->mperf);
+            EXPECT_GT(snap->timestamp_ns, 0u);
+        }
+
+        std::string dir;
+        std::string path_fmt;
+        unsigned ncpus;
+        struct msr_snapshot_config cfg;
+};
+
+static struct variorum_snapshot handler_snap;
+static volatile sig_atomic_t handler_rc = 1;
+
+static void snapshot_handler(int sig)
+{
+    (void)sig;
+    handler_rc = msr_snapshot_read(&handler_snap);
+}
+
+TEST_F(msr_snapshot, test_read)
+{
+    struct variorum_snapshot snap;
+
+    ASSERT_EQ(0, msr_snapshot_arm(&cfg));
+    ASSERT_EQ(0, msr_snapshot_read(&snap));
+    expect_snapshot(&snap);
+}
+
+TEST_F(msr_snapshot, test_read_from_signal_handler)
+{
+    struct sigaction sa, old;
+
+    ASSERT_EQ(0, msr_snapshot_arm(&cfg));
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = snapshot_handler;
+    sigemptyset(&sa.sa_mask);
+    ASSERT_EQ(0, sigaction(SIGUSR1, &sa, &old));
+    errno = EAGAIN;
+    raise(SIGUSR1);
+    EXPECT_EQ(EAGAIN, errno);
+    sigaction(SIGUSR1, &old, NULL);
+    ASSERT_EQ(0, handler_rc);
+    expect_snapshot(&handler_snap);
+}
+
+TEST_F(msr_snapshot, test_skip_missing_registers)
+{
+    struct variorum_snapshot snap;
+
+    cfg.dram_energy_msr = 0;
+    cfg.cpu_msrs[SNAPSHOT_APERF] = 0;
+    ASSERT_EQ(0, msr_snapshot_arm(&cfg));
+    ASSERT_EQ(0, msr_snapshot_read(&snap));
+    EXPECT_EQ(0u, snap.dram_energy[0]);
+    EXPECT_EQ(0u, snap.aperf);
+    EXPECT_EQ(1000u, snap.pkg_energy[0]);
+}
+
+TEST_F(msr_snapshot, test_not_armed)
+{
+    struct variorum_snapshot snap;
+
+    EXPECT_EQ(VARIORUM_ERROR_FEATURE_NOT_AVAILABLE, msr_snapshot_read(&snap));
+    ASSERT_EQ(0, msr_snapshot_arm(&cfg));
+    msr_snapshot_disarm();
+    EXPECT_EQ(VARIORUM_ERROR_FEATURE_NOT_AVAILABLE, msr_snapshot_read(&snap));
+}
+
+TEST_F(msr_snapshot, test_arm_errors)
+{
+    cfg.socket_cpu[0] = ncpus;
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, msr_snapshot_arm(&cfg));
+    cfg.socket_cpu[0] = 0;
+    cfg.cpu_path_fmt = "/nonexistent/%d";
+    EXPECT_EQ(VARIORUM_ERROR_MSR_MODULE, msr_snapshot_arm(&cfg));
+}
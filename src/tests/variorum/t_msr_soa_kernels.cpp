@@ -0,0 +1,111 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <msr_soa.h>
+}
+
+// Not a multiple of any vector width, so the remainder loops are covered.
+#define N 37
+
+TEST(msr_soa_kernels, test_alloc_aligned_and_zeroed)
+{
+    uint64_t *a = (uint64_t *) msr_soa_alloc(N, sizeof(uint64_t));
+    ASSERT_NE((uint64_t *)NULL, a);
+    EXPECT_EQ(0u, (uintptr_t)a % MSR_SOA_ALIGN);
+    for (int i = 0; i < N; i++)
+    {
+        EXPECT_EQ(0u, a[i]);
+    }
+    free(a);
+}
+
+TEST(msr_soa_kernels, test_mask)
+{
+    EXPECT_EQ(0xffffffffULL, msr_soa_mask(32));
+    EXPECT_EQ(0xffffffffffffULL, msr_soa_mask(48));
+    EXPECT_EQ(~0ULL, msr_soa_mask(64));
+    EXPECT_EQ(~0ULL, msr_soa_mask(0));
+}
+
+TEST(msr_soa_kernels, test_gather)
+{
+    uint64_t ops[N * 4];
+    uint64_t *view[N];
+    uint64_t *out = (uint64_t *) msr_soa_alloc(N, sizeof(uint64_t));
+
+    // Batch results are strided like struct msr_batch_op.
+    for (int i = 0; i < N; i++)
+    {
+        ops[i * 4 + 3] = 1000 + i;
+        view[i] = &ops[i * 4 + 3];
+    }
+    msr_soa_gather(N, view, out);
+    for (int i = 0; i < N; i++)
+    {
+        EXPECT_EQ(1000u + i, out[i]);
+    }
+    free(out);
+}
+
+TEST(msr_soa_kernels, test_delta_wraparound)
+{
+    uint64_t *now = (uint64_t *) msr_soa_alloc(N, sizeof(uint64_t));
+    uint64_t *old = (uint64_t *) msr_soa_alloc(N, sizeof(uint64_t));
+    uint64_t *out = (uint64_t *) msr_soa_alloc(N, sizeof(uint64_t));
+    double *scaled = (double *) msr_soa_alloc(N, sizeof(double));
+
+    for (int i = 0; i < N; i++)
+    {
+        // Odd elements wrapped around a 48-bit counter.
+        old[i] = (i % 2) ? (1ULL << 48) - 10 : 100;
+        now[i] = (i % 2) ? (uint64_t)i : 100 + (uint64_t)i * 2;
+    }
+    msr_soa_delta(N, msr_soa_mask(48), now, old, out);
+    msr_soa_delta_scale(N, msr_soa_mask(48), 0.5, now, old, scaled);
+    for (int i = 0; i < N; i++)
+    {
+        uint64_t expect = (i % 2) ? 10 + i : 2 * i;
+        EXPECT_EQ(expect, out[i]);
+        EXPECT_DOUBLE_EQ(0.5 * expect, scaled[i]);
+    }
+    free(now);
+    free(old);
+    free(out);
+    free(scaled);
+}
+
+TEST(msr_soa_kernels, test_accumulate_32bit)
+{
+    uint64_t *now = (uint64_t *) msr_soa_alloc(N, sizeof(uint64_t));
+    uint64_t *last = (uint64_t *) msr_soa_alloc(N, sizeof(uint64_t));
+    uint64_t *acc = (uint64_t *) msr_soa_alloc(N, sizeof(uint64_t));
+
+    for (int i = 0; i < N; i++)
+    {
+        now[i] = 0xfffffff0ULL;
+    }
+    // The first call starts the accumulators at the hardware count.
+    msr_soa_accumulate(N, msr_soa_mask(32), now, last, acc);
+    for (int i = 0; i < N; i++)
+    {
+        EXPECT_EQ(0xfffffff0ULL, acc[i]);
+        now[i] = i;
+    }
+    msr_soa_accumulate(N, msr_soa_mask(32), now, last, acc);
+    for (int i = 0; i < N; i++)
+    {
+        EXPECT_EQ(0x100000000ULL + i, acc[i]);
+        EXPECT_EQ((uint64_t)i, last[i]);
+    }
+    free(now);
+    free(last);
+    free(acc);
+}
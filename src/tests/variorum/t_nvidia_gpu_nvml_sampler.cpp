@@ -0,0 +1,107 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <nvidia_gpu_power_features.h>
+#include <nvml_stub.h>
+#include <variorum_metrics.h>
+}
+
+class nvidia_gpu_nvml_sampler : public ::testing::Test
+{
+    protected:
+        void TearDown() override
+        {
+            shutdownNVML();
+        }
+};
+
+TEST_F(nvidia_gpu_nvml_sampler, test_one_field_query_per_device)
+{
+    struct nvidia_gpu_sample *samples = NULL;
+
+    nvml_stub_reset(3, 1);
+    nvml_stub_set_energy(0, 123456789ULL);
+    nvml_stub_set_energy(2, 1ULL);
+    initNVML();
+
+    ASSERT_EQ(0, nvidia_gpu_sample_all(&samples));
+    ASSERT_NE(nullptr, samples);
+    EXPECT_EQ(3, nvml_stub_field_value_calls());
+    EXPECT_EQ(3, nvml_stub_energy_calls());
+    EXPECT_EQ(0, nvml_stub_legacy_power_calls());
+
+    for (unsigned d = 0; d < 3; d++)
+    {
+        EXPECT_DOUBLE_EQ(200.0 + d, samples[d].power_watts);
+        EXPECT_DOUBLE_EQ(300.0 + d, samples[d].power_limit_watts);
+        EXPECT_EQ(60u + d, samples[d].temp_celsius);
+        EXPECT_EQ(70u + d, samples[d].mem_temp_celsius);
+        EXPECT_EQ(1500u, samples[d].sm_clock_mhz);
+        EXPECT_EQ(877u, samples[d].mem_clock_mhz);
+        EXPECT_EQ(50u + d, samples[d].sm_util_percent);
+        EXPECT_EQ(20u + d, samples[d].mem_util_percent);
+    }
+    EXPECT_EQ(123456789ULL, samples[0].energy_mj);
+    EXPECT_EQ(0ULL, samples[1].energy_mj);
+    EXPECT_EQ(1ULL, samples[2].energy_mj);
+}
+
+TEST_F(nvidia_gpu_nvml_sampler, test_power_field_fallback)
+{
+    struct nvidia_gpu_sample *samples = NULL;
+
+    nvml_stub_reset(2, 0);
+    initNVML();
+
+    ASSERT_EQ(0, nvidia_gpu_sample_all(&samples));
+    EXPECT_EQ(2, nvml_stub_field_value_calls());
+    EXPECT_EQ(4, nvml_stub_legacy_power_calls());
+    EXPECT_DOUBLE_EQ(201.0, samples[1].power_watts);
+    EXPECT_DOUBLE_EQ(301.0, samples[1].power_limit_watts);
+    EXPECT_EQ(71u, samples[1].mem_temp_celsius);
+}
+
+TEST_F(nvidia_gpu_nvml_sampler, test_metrics_share_vector)
+{
+    struct variorum_metric_vector metrics;
+    struct variorum_metric *m;
+
+    nvml_stub_reset(2, 1);
+    nvml_stub_set_energy(1, 5000ULL);
+    initNVML();
+
+    variorum_metric_vector_init(&metrics);
+    ASSERT_EQ(0, variorum_metric_vector_append(&metrics, "energy_cpu_joules",
+              VARIORUM_DOMAIN_SOCKET, 0, 42.0, 1));
+    ASSERT_EQ(0, nvidia_gpu_get_metrics(&metrics));
+
+    EXPECT_EQ(1u + 2 * 9, metrics.count);
+    m = variorum_metric_vector_find(&metrics, "energy_cpu_joules",
+                                    VARIORUM_DOMAIN_SOCKET, 0);
+    ASSERT_NE(nullptr, m);
+    EXPECT_DOUBLE_EQ(42.0, m->value);
+    m = variorum_metric_vector_find(&metrics, "energy_gpu_joules",
+                                    VARIORUM_DOMAIN_GPU, 1);
+    ASSERT_NE(nullptr, m);
+    EXPECT_DOUBLE_EQ(5.0, m->value);
+    m = variorum_metric_vector_find(&metrics, "power_gpu_watts",
+                                    VARIORUM_DOMAIN_GPU, 0);
+    ASSERT_NE(nullptr, m);
+    EXPECT_DOUBLE_EQ(200.0, m->value);
+    EXPECT_EQ(nullptr, variorum_metric_vector_find(&metrics, "power_gpu_watts",
+              VARIORUM_DOMAIN_GPU, 2));
+
+    variorum_metric_vector_free(&metrics);
+    EXPECT_EQ(0u, metrics.count);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
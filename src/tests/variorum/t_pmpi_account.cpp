@@ -0,0 +1,150 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "pmpi_account.h"
+}
+
+class pmpi_accounting : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            memset(&acct, 0, sizeof(acct));
+            strcpy(acct.rank.host, "node01");
+            pmpi_account_start(&acct, 10.0, 100.0);
+        }
+
+        // Compute until t, then spend seconds in call at ra, with the rank
+        // drawing watts throughout.
+        void call(int c, uintptr_t ra, double t, double seconds, double watts)
+        {
+            double joules0;
+
+            joules = joules + (t - now) * watts;
+            now = t;
+            joules0 = pmpi_account_enter(&acct, now, joules);
+            now += seconds;
+            joules += seconds * watts;
+            pmpi_account_leave(&acct, c, ra, t, joules0, now, joules);
+        }
+
+        struct pmpi_account acct;
+        double now = 10.0;
+        double joules = 100.0;
+};
+
+TEST_F(pmpi_accounting, splits_time_and_energy)
+{
+    call(PMPI_CALL_SEND, 0x1000, 11.0, 0.5, 100.0);
+    call(PMPI_CALL_BARRIER, 0x2000, 12.0, 1.0, 50.0);
+    call(PMPI_CALL_SEND, 0x1000, 14.0, 0.5, 100.0);
+    pmpi_account_finish(&acct, 15.0, joules + 50.0);
+
+    EXPECT_STREQ("node01", acct.rank.host);
+    EXPECT_DOUBLE_EQ(3.0, acct.rank.mpi_calls);
+    EXPECT_DOUBLE_EQ(2.0, acct.rank.mpi_seconds);
+    EXPECT_DOUBLE_EQ(3.0, acct.rank.compute_seconds);
+    EXPECT_DOUBLE_EQ(150.0, acct.rank.mpi_joules);
+    // 1 s at 100 W, 0.5 s at 50 W, then 1 s and 0.5 s at 100 W.
+    EXPECT_DOUBLE_EQ(275.0, acct.rank.compute_joules);
+    EXPECT_EQ(2u, acct.nsites);
+
+    struct pmpi_site *send = pmpi_account_site(&acct, PMPI_CALL_SEND, 0x1000);
+    EXPECT_EQ(2u, send->calls);
+    EXPECT_DOUBLE_EQ(1.0, send->seconds);
+    EXPECT_DOUBLE_EQ(100.0, send->joules);
+    EXPECT_EQ(2u, acct.nsites);
+}
+
+TEST_F(pmpi_accounting, energy_stays_monotonic)
+{
+    double joules0;
+
+    // An extrapolated reading overshoots the next one.
+    joules0 = pmpi_account_enter(&acct, 11.0, 150.0);
+    EXPECT_DOUBLE_EQ(150.0, joules0);
+    pmpi_account_leave(&acct, PMPI_CALL_WAIT, 0x3000, 11.0, joules0, 12.0,
+                       140.0);
+    joules0 = pmpi_account_enter(&acct, 13.0, 145.0);
+    EXPECT_DOUBLE_EQ(150.0, joules0);
+    pmpi_account_leave(&acct, PMPI_CALL_WAIT, 0x3000, 13.0, joules0, 14.0,
+                       170.0);
+
+    EXPECT_DOUBLE_EQ(50.0, acct.rank.compute_joules);
+    EXPECT_DOUBLE_EQ(20.0, acct.rank.mpi_joules);
+}
+
+TEST_F(pmpi_accounting, full_table_keeps_sites_per_call)
+{
+    struct pmpi_site *site;
+    uintptr_t ra;
+
+    for (ra = 1; ra <= PMPI_MAX_SITES / 2; ra++)
+    {
+        site = pmpi_account_site(&acct, PMPI_CALL_RECV, ra * 16);
+        EXPECT_EQ(ra * 16, site->ra);
+    }
+    EXPECT_EQ((unsigned)PMPI_MAX_SITES / 2, acct.nsites);
+    site = pmpi_account_site(&acct, PMPI_CALL_ALLREDUCE, 0xdead0);
+    EXPECT_EQ(&acct.other_sites[PMPI_CALL_ALLREDUCE], site);
+    EXPECT_EQ(PMPI_CALL_ALLREDUCE, site->call);
+    // Sites already in the table are still found.
+    site = pmpi_account_site(&acct, PMPI_CALL_RECV, 16);
+    EXPECT_EQ((uintptr_t)16, site->ra);
+}
+
+TEST(pmpi_merge, sums_sites_of_all_ranks)
+{
+    struct pmpi_site_record recs[5];
+    const char *names[5] =
+    {
+        "MPI_Send main", "MPI_Barrier solve", "MPI_Send main",
+        "MPI_Allreduce dot", "MPI_Barrier solve"
+    };
+    int i;
+    int n;
+
+    memset(recs, 0, sizeof(recs));
+    for (i = 0; i < 5; i++)
+    {
+        snprintf(recs[i].site, PMPI_SITE_LEN, "%s", names[i]);
+        recs[i].calls = i + 1;
+        recs[i].seconds = 0.5 * (i + 1);
+        recs[i].joules = 10.0 * (i + 1);
+    }
+    n = pmpi_merge_sites(recs, 5);
+
+    ASSERT_EQ(3, n);
+    EXPECT_STREQ("MPI_Allreduce dot", recs[0].site);
+    EXPECT_DOUBLE_EQ(4.0, recs[0].calls);
+    EXPECT_STREQ("MPI_Barrier solve", recs[1].site);
+    EXPECT_DOUBLE_EQ(7.0, recs[1].calls);
+    EXPECT_DOUBLE_EQ(3.5, recs[1].seconds);
+    EXPECT_STREQ("MPI_Send main", recs[2].site);
+    EXPECT_DOUBLE_EQ(4.0, recs[2].calls);
+    EXPECT_DOUBLE_EQ(40.0, recs[2].joules);
+}
+
+TEST(pmpi_energy, accumulates_differences)
+{
+    double total = 0.0;
+    double last = 5000.0;
+
+    EXPECT_DOUBLE_EQ(20.0, pmpi_energy_add(&total, &last, 5020.0));
+    EXPECT_DOUBLE_EQ(30.0, pmpi_energy_add(&total, &last, 5050.0));
+    // A reading that went backwards adds nothing, and later readings count
+    // from it.
+    EXPECT_DOUBLE_EQ(0.0, pmpi_energy_add(&total, &last, 10.0));
+    EXPECT_DOUBLE_EQ(15.0, pmpi_energy_add(&total, &last, 25.0));
+    EXPECT_DOUBLE_EQ(65.0, total);
+    EXPECT_DOUBLE_EQ(25.0, last);
+}
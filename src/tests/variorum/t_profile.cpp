@@ -0,0 +1,147 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <profile.h>
+
+__attribute__((noinline)) int profile_test_leaf(int x)
+{
+    return x * 3 + 1;
+}
+
+__attribute__((noinline)) int profile_test_caller(int x)
+{
+    return profile_test_leaf(x) + 2;
+}
+}
+
+static std::string read_all(FILE *fp)
+{
+    std::string s;
+    char buf[512];
+    size_t n;
+
+    rewind(fp);
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    {
+        s.append(buf, n);
+    }
+    return s;
+}
+
+TEST(profile, test_attribution)
+{
+    struct profile p;
+    uint64_t a[2] = {0x1000, 0x2000};
+    uint64_t b[1] = {0x3000};
+
+    ASSERT_EQ(0, profile_init(&p));
+
+    // Energy and time are split by cycles samples, 2:1.
+    ASSERT_EQ(0, profile_add_sample(&p, PROFILE_EVENT_CYCLES, a, 2));
+    ASSERT_EQ(0, profile_add_sample(&p, PROFILE_EVENT_CYCLES, b, 1));
+    ASSERT_EQ(0, profile_add_sample(&p, PROFILE_EVENT_CYCLES, a, 2));
+    ASSERT_EQ(0, profile_add_sample(&p, PROFILE_EVENT_INSTRUCTIONS, a, 2));
+    profile_close_interval(&p, 3.0, 30.0, 6.0);
+    ASSERT_EQ(2u, p.nstacks);
+    EXPECT_EQ(2u, p.stacks[0].samples);
+    EXPECT_EQ(1u, p.stacks[0].inst_samples);
+    EXPECT_DOUBLE_EQ(2.0, p.stacks[0].seconds);
+    EXPECT_DOUBLE_EQ(20.0, p.stacks[0].pkg_joules);
+    EXPECT_DOUBLE_EQ(4.0, p.stacks[0].dram_joules);
+    EXPECT_DOUBLE_EQ(10.0, p.stacks[1].pkg_joules);
+
+    // Intervals without samples are kept apart.
+    profile_close_interval(&p, 1.0, 5.0, 1.0);
+    EXPECT_DOUBLE_EQ(1.0, p.idle_seconds);
+    EXPECT_DOUBLE_EQ(5.0, p.idle_pkg_joules);
+    EXPECT_DOUBLE_EQ(20.0, p.stacks[0].pkg_joules);
+
+    // Only the stacks sampled in an interval share its energy.
+    ASSERT_EQ(0, profile_add_sample(&p, PROFILE_EVENT_CYCLES, b, 1));
+    profile_close_interval(&p, 1.0, 8.0, 0.0);
+    EXPECT_DOUBLE_EQ(20.0, p.stacks[0].pkg_joules);
+    EXPECT_DOUBLE_EQ(18.0, p.stacks[1].pkg_joules);
+    EXPECT_EQ(2u, p.stacks[1].samples);
+    profile_free(&p);
+}
+
+TEST(profile, test_many_stacks)
+{
+    struct profile p;
+    uint64_t ip;
+
+    ASSERT_EQ(0, profile_init(&p));
+    for (int round = 0; round < 2; round++)
+    {
+        for (ip = 1; ip <= 5000; ip++)
+        {
+            ASSERT_EQ(0, profile_add_sample(&p, PROFILE_EVENT_CYCLES, &ip, 1));
+        }
+    }
+    profile_close_interval(&p, 1.0, 10000.0, 0.0);
+    ASSERT_EQ(5000u, p.nstacks);
+    EXPECT_EQ(2u, p.stacks[4999].samples);
+    EXPECT_DOUBLE_EQ(2.0, p.stacks[4999].pkg_joules);
+    profile_free(&p);
+}
+
+TEST(profile, test_symbolize)
+{
+    struct profile p;
+    char name[256];
+
+    ASSERT_EQ(0, profile_init(&p));
+    ASSERT_EQ(0, profile_load_maps(&p, "/proc/self/maps"));
+
+    profile_symbolize(&p, (uint64_t)(uintptr_t)&profile_test_leaf, name,
+                      sizeof(name));
+    EXPECT_STREQ("profile_test_leaf", name);
+    profile_symbolize(&p, (uint64_t)(uintptr_t)&profile_test_caller + 1, name,
+                      sizeof(name));
+    EXPECT_STREQ("profile_test_caller", name);
+    profile_symbolize(&p, 0x10, name, sizeof(name));
+    EXPECT_STREQ("[unknown]", name);
+    profile_free(&p);
+}
+
+TEST(profile, test_write)
+{
+    struct profile p;
+    uint64_t stack[2] =
+    {
+        (uint64_t)(uintptr_t)&profile_test_leaf,
+        (uint64_t)(uintptr_t)&profile_test_caller
+    };
+    FILE *table = tmpfile();
+    FILE *collapsed = tmpfile();
+
+    ASSERT_NE((FILE *)NULL, table);
+    ASSERT_NE((FILE *)NULL, collapsed);
+    ASSERT_EQ(0, profile_init(&p));
+    ASSERT_EQ(0, profile_load_maps(&p, "/proc/self/maps"));
+    ASSERT_EQ(0, profile_add_sample(&p, PROFILE_EVENT_CYCLES, stack, 2));
+    ASSERT_EQ(0, profile_add_sample(&p, PROFILE_EVENT_CYCLES, stack, 2));
+    ASSERT_EQ(0, profile_add_sample(&p, PROFILE_EVENT_INSTRUCTIONS, stack, 2));
+    profile_close_interval(&p, 0.5, 2.0, 0.5);
+    ASSERT_EQ(0, profile_write(&p, table, collapsed));
+
+    EXPECT_EQ("function samples seconds pkg_joules dram_joules ipc\n"
+              "profile_test_leaf 2 0.500000 2.000000 0.500000 0.500\n",
+              read_all(table));
+    // Root first, weighted in microjoules.
+    EXPECT_EQ("profile_test_caller;profile_test_leaf 2500000\n",
+              read_all(collapsed));
+    fclose(table);
+    fclose(collapsed);
+    profile_free(&p);
+}
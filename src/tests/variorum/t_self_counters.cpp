@@ -0,0 +1,51 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <variorum_self_counters.h>
+}
+
+TEST(self_counters, test_sign_extend)
+{
+    // 48-bit counters read back as negative offsets from the user page.
+    EXPECT_EQ(-1, self_counters_sign_extend(0xFFFFFFFFFFFFULL, 48));
+    EXPECT_EQ(0x7FFFFFFFFFFFLL, self_counters_sign_extend(0x7FFFFFFFFFFFULL, 48));
+    EXPECT_EQ(5, self_counters_sign_extend(0xFFFF000000000005ULL, 48));
+    EXPECT_EQ(-2, self_counters_sign_extend(0xFFFFFFFFFFFFFFFEULL, 64));
+}
+
+TEST(self_counters, test_time_delta)
+{
+    // 1 ns per 2 cycles: mult = 2^31 with a shift of 32.
+    EXPECT_EQ(1000u + 500u,
+              self_counters_time_delta(1000, 1000, 1u << 31, 32));
+    // The remainder keeps the precision of cycles below 2^shift.
+    EXPECT_EQ(10u, self_counters_time_delta(7, 0, 3, 1));
+    EXPECT_EQ(10u, self_counters_time_delta(0, 10, 3, 4));
+}
+
+TEST(self_counters, test_thread_read)
+{
+    uint64_t before[SELF_COUNTERS_NUM], after[SELF_COUNTERS_NUM];
+    volatile double x = 1.0;
+
+    if (self_counters_thread_read(before) != 0)
+    {
+        GTEST_SKIP() << "perf_event self-monitoring is not available";
+    }
+    for (int i = 0; i < 1000000; i++)
+    {
+        x *= 1.0000001;
+    }
+    ASSERT_EQ(0, self_counters_thread_read(after));
+    for (int i = 0; i < SELF_COUNTERS_NUM; i++)
+    {
+        EXPECT_GE(after[i], before[i]);
+    }
+}
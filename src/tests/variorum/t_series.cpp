@@ -0,0 +1,203 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <variorum_error.h>
+#include <variorum_series.h>
+}
+
+struct sample
+{
+    int64_t time;
+    int64_t power;
+    int64_t limit;
+    double temp;
+};
+
+static int collect(int64_t time, const union variorum_series_value *values,
+                   void *arg)
+{
+    struct sample s = {time, values[0].i, values[1].i, values[2].f};
+
+    ((std::vector<struct sample> *)arg)->push_back(s);
+    return 0;
+}
+
+// Samples every 50 ms with jitter, a noisy power in centiwatts, a power limit
+// that changes once, and a temperature stored as doubles.
+class series : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            snprintf(path, sizeof(path), "/tmp/t_series.%d", getpid());
+            srand(1);
+            for (int i = 0; i < 5000; i++)
+            {
+                struct sample s;
+
+                s.time = 1700000000000000LL + i * 50000LL + rand() % 300;
+                s.power = 20000 + rand() % 3000;
+                s.limit = i < 2500 ? 15000 : 12000;
+                s.temp = i % 7 == 0 ? NAN : 40.0 + (i / 100) * 0.5;
+                in.push_back(s);
+            }
+        }
+
+        void TearDown() override
+        {
+            unlink(path);
+        }
+
+        void write(size_t n, bool close)
+        {
+            const struct variorum_series_column columns[] =
+            {
+                {"power", 2}, {"limit", 0}, {"temp", VARIORUM_SERIES_DOUBLE}
+            };
+            struct variorum_series_writer *w;
+            union variorum_series_value v[3];
+            int fd;
+
+            fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+            ASSERT_GE(fd, 0);
+            ASSERT_EQ(0, variorum_series_create(fd, "time", columns, 3, "node01",
+                                                &w));
+            for (size_t i = 0; i < n; i++)
+            {
+                v[0].i = in[i].power;
+                v[1].i = in[i].limit;
+                v[2].f = in[i].temp;
+                ASSERT_EQ(0, variorum_series_append(w, in[i].time, v));
+            }
+            if (close)
+            {
+                ASSERT_EQ(0, variorum_series_close(w));
+            }
+            else
+            {
+                // A writer that dies after its last complete block.
+                ASSERT_EQ(0, variorum_series_flush(w));
+            }
+        }
+
+        void expect_equal(const std::vector<struct sample> &out, size_t first)
+        {
+            for (size_t i = 0; i < out.size(); i++)
+            {
+                const struct sample &s = in[first + i];
+
+                ASSERT_EQ(s.time, out[i].time);
+                ASSERT_EQ(s.power, out[i].power);
+                ASSERT_EQ(s.limit, out[i].limit);
+                ASSERT_EQ(0, memcmp(&s.temp, &out[i].temp, sizeof(double)));
+            }
+        }
+
+        char path[64];
+        std::vector<struct sample> in;
+};
+
+TEST_F(series, round_trip_is_exact_and_compact)
+{
+    struct variorum_series_reader *r;
+    std::vector<struct sample> out;
+    const struct variorum_series_column *columns;
+    uint32_t ncolumns;
+    uint64_t samples;
+    uint64_t blocks;
+    struct stat st;
+
+    write(in.size(), true);
+    ASSERT_EQ(0, variorum_series_open(path, &r));
+    EXPECT_STREQ("time", variorum_series_time_name(r));
+    EXPECT_STREQ("node01", variorum_series_meta(r));
+    columns = variorum_series_columns(r, &ncolumns);
+    ASSERT_EQ(3u, ncolumns);
+    EXPECT_STREQ("limit", columns[1].name);
+    EXPECT_EQ(VARIORUM_SERIES_DOUBLE, columns[2].decimals);
+    variorum_series_extent(r, &samples, &blocks, NULL, NULL);
+    EXPECT_EQ(in.size(), samples);
+    EXPECT_EQ(5u, blocks);
+
+    ASSERT_EQ(0, variorum_series_read(r, INT64_MIN, INT64_MAX, collect, &out));
+    ASSERT_EQ(in.size(), out.size());
+    expect_equal(out, 0);
+    variorum_series_reader_close(r);
+
+    // 32 bytes of raw samples, and the limit and temperature mostly repeat.
+    ASSERT_EQ(0, stat(path, &st));
+    EXPECT_LT(st.st_size, (off_t)(in.size() * 32 / 6));
+}
+
+TEST_F(series, reads_a_range)
+{
+    struct variorum_series_reader *r;
+    std::vector<struct sample> out;
+
+    write(in.size(), true);
+    ASSERT_EQ(0, variorum_series_open(path, &r));
+    ASSERT_EQ(0, variorum_series_read(r, in[2000].time, in[2100].time, collect,
+                                      &out));
+    ASSERT_EQ(101u, out.size());
+    expect_equal(out, 2000);
+    out.clear();
+    ASSERT_EQ(0, variorum_series_read(r, in.back().time + 1, INT64_MAX, collect,
+                                      &out));
+    EXPECT_EQ(0u, out.size());
+    variorum_series_reader_close(r);
+}
+
+TEST_F(series, reads_a_series_without_index)
+{
+    struct variorum_series_reader *r;
+    std::vector<struct sample> out;
+    uint64_t samples;
+
+    write(3000, false);
+    ASSERT_EQ(0, variorum_series_open(path, &r));
+    variorum_series_extent(r, &samples, NULL, NULL, NULL);
+    EXPECT_EQ(3000u, samples);
+    ASSERT_EQ(0, variorum_series_read(r, INT64_MIN, INT64_MAX, collect, &out));
+    ASSERT_EQ(3000u, out.size());
+    expect_equal(out, 0);
+    variorum_series_reader_close(r);
+}
+
+TEST_F(series, rejects_bad_input)
+{
+    const struct variorum_series_column bad = {"x", 19};
+    struct variorum_series_writer *w;
+    struct variorum_series_reader *r;
+    union variorum_series_value v[3];
+    int fd;
+
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_series_create(-1, "time", NULL, 0,
+              NULL, &w));
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_series_create(1, "time", &bad, 1,
+              NULL, &w));
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_series_open("/nonexistent", &r));
+
+    // Time going backwards.
+    write(10, false);
+    fd = open(path, O_WRONLY | O_TRUNC);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(0, variorum_series_create(fd, "time", NULL, 0, NULL, &w));
+    ASSERT_EQ(0, variorum_series_append(w, 10, v));
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_series_append(w, 9, v));
+    ASSERT_EQ(0, variorum_series_close(w));
+}
@@ -0,0 +1,268 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <variorum_error.h>
+#include <variorum_shm.h>
+}
+
+// Every metric of sample n holds n, and sample n has a count derived from n,
+// so a torn copy is detected.
+static uint32_t sample_count(uint64_t n)
+{
+    return 1 + n % VARIORUM_SHM_MAX_METRICS;
+}
+
+static void fill_sample(struct variorum_metric *metrics, uint64_t n)
+{
+    for (uint32_t i = 0; i < sample_count(n); i++)
+    {
+        snprintf(metrics[i].name, VARIORUM_METRIC_NAME_LEN, "m%u", i);
+        metrics[i].domain = 0;
+        metrics[i].index = (int)i;
+        metrics[i].value = (double)n;
+        metrics[i].timestamp_us = n;
+    }
+}
+
+static int check_sample(const struct variorum_shm_sample *s)
+{
+    if (s->count != sample_count(s->sequence))
+    {
+        return -1;
+    }
+    for (uint32_t i = 0; i < s->count; i++)
+    {
+        if (s->metrics[i].value != (double)s->sequence ||
+            s->metrics[i].timestamp_us != s->sequence ||
+            s->metrics[i].index != (int)i)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+class shm : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            snprintf(name, sizeof(name), "t_shm.%d", getpid());
+        }
+
+        char name[64];
+};
+
+TEST_F(shm, test_write_read)
+{
+    struct variorum_metric metrics[VARIORUM_SHM_MAX_METRICS];
+    struct variorum_shm_sample *samples = new struct variorum_shm_sample[8];
+    struct variorum_shm *writer;
+    struct variorum_shm *reader;
+
+    EXPECT_EQ(VARIORUM_ERROR_FEATURE_NOT_AVAILABLE,
+              variorum_shm_attach(name, &reader));
+    ASSERT_EQ(0, variorum_shm_create(name, 4, &writer));
+    ASSERT_EQ(0, variorum_shm_attach(name, &reader));
+    EXPECT_EQ(getpid(), variorum_shm_writer_pid(reader));
+    EXPECT_EQ(VARIORUM_ERROR_FEATURE_NOT_AVAILABLE,
+              variorum_shm_read(reader, &samples[0]));
+    EXPECT_EQ(VARIORUM_ERROR_INVAL, variorum_shm_write(reader, metrics, 1));
+
+    for (uint64_t n = 1; n <= 3; n++)
+    {
+        fill_sample(metrics, n);
+        ASSERT_EQ(0, variorum_shm_write(writer, metrics, sample_count(n)));
+    }
+    ASSERT_EQ(0, variorum_shm_read(reader, &samples[0]));
+    EXPECT_EQ(3u, samples[0].sequence);
+    EXPECT_EQ(0, check_sample(&samples[0]));
+    EXPECT_STREQ("m2", samples[0].metrics[2].name);
+
+    // The history wraps after 4 samples and is returned oldest first.
+    ASSERT_EQ(3, variorum_shm_read_history(reader, samples, 8));
+    EXPECT_EQ(1u, samples[0].sequence);
+    EXPECT_EQ(3u, samples[2].sequence);
+    for (uint64_t n = 4; n <= 10; n++)
+    {
+        fill_sample(metrics, n);
+        ASSERT_EQ(0, variorum_shm_write(writer, metrics, sample_count(n)));
+    }
+    ASSERT_EQ(4, variorum_shm_read_history(reader, samples, 8));
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(7u + i, samples[i].sequence);
+        EXPECT_EQ(0, check_sample(&samples[i]));
+    }
+    ASSERT_EQ(2, variorum_shm_read_history(reader, samples, 2));
+    EXPECT_EQ(9u, samples[0].sequence);
+
+    variorum_shm_detach(reader);
+    variorum_shm_destroy(writer);
+    EXPECT_EQ(VARIORUM_ERROR_FEATURE_NOT_AVAILABLE,
+              variorum_shm_attach(name, &reader));
+    delete[] samples;
+}
+
+TEST_F(shm, test_truncated_sample)
+{
+    struct variorum_metric *metrics =
+        new struct variorum_metric[VARIORUM_SHM_MAX_METRICS + 10];
+    struct variorum_shm_sample *sample = new struct variorum_shm_sample;
+    struct variorum_shm *writer;
+    struct variorum_shm *reader;
+
+    memset(metrics, 0, (VARIORUM_SHM_MAX_METRICS + 10) *
+           sizeof(struct variorum_metric));
+    ASSERT_EQ(0, variorum_shm_create(name, 4, &writer));
+    ASSERT_EQ(0, variorum_shm_attach(name, &reader));
+    EXPECT_EQ(0, variorum_shm_write(writer, metrics, 10));
+    ASSERT_EQ(0, variorum_shm_read(reader, sample));
+    EXPECT_EQ(10u, sample->count);
+    EXPECT_EQ(10u, sample->total);
+
+    EXPECT_EQ(1, variorum_shm_write(writer, metrics,
+                                    VARIORUM_SHM_MAX_METRICS + 10));
+    ASSERT_EQ(0, variorum_shm_read(reader, sample));
+    EXPECT_EQ((uint32_t)VARIORUM_SHM_MAX_METRICS, sample->count);
+    EXPECT_EQ(VARIORUM_SHM_MAX_METRICS + 10u, sample->total);
+
+    variorum_shm_detach(reader);
+    variorum_shm_destroy(writer);
+    delete sample;
+    delete[] metrics;
+}
+
+TEST_F(shm, test_single_writer)
+{
+    struct variorum_shm *writer;
+    struct variorum_shm *other;
+
+    ASSERT_EQ(0, variorum_shm_create(name, 4, &writer));
+    EXPECT_EQ(1, variorum_shm_create(name, 4, &other));
+    EXPECT_EQ(NULL, other);
+    variorum_shm_destroy(writer);
+    ASSERT_EQ(0, variorum_shm_create(name, 4, &writer));
+    variorum_shm_destroy(writer);
+}
+
+TEST_F(shm, test_take_over_dead_writer)
+{
+    struct variorum_metric metrics[VARIORUM_SHM_MAX_METRICS];
+    struct variorum_shm_sample sample;
+    struct variorum_shm *writer;
+    struct variorum_shm *reader;
+    int status;
+    pid_t pid;
+
+    // The child writes a sample and dies without removing the region.
+    pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        fill_sample(metrics, 1);
+        if (variorum_shm_create(name, 4, &writer) != 0 ||
+            variorum_shm_write(writer, metrics, sample_count(1)) != 0)
+        {
+            _exit(1);
+        }
+        _exit(0);
+    }
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+
+    ASSERT_EQ(0, variorum_shm_attach(name, &reader));
+    EXPECT_EQ(pid, variorum_shm_writer_pid(reader));
+    ASSERT_EQ(0, variorum_shm_read(reader, &sample));
+    variorum_shm_detach(reader);
+
+    // The lock of the dead writer is gone, and a region of another size is
+    // replaced.
+    ASSERT_EQ(0, variorum_shm_create(name, 8, &writer));
+    ASSERT_EQ(0, variorum_shm_attach(name, &reader));
+    EXPECT_EQ(getpid(), variorum_shm_writer_pid(reader));
+    EXPECT_EQ(VARIORUM_ERROR_FEATURE_NOT_AVAILABLE,
+              variorum_shm_read(reader, &sample));
+    variorum_shm_detach(reader);
+    variorum_shm_destroy(writer);
+}
+
+TEST_F(shm, test_stress_multi_process)
+{
+    const uint64_t nsamples = 50000;
+    const int nreaders = 4;
+    struct variorum_metric metrics[VARIORUM_SHM_MAX_METRICS];
+    struct variorum_shm *writer;
+    pid_t pids[nreaders];
+    int status;
+
+    // A short history makes the writer lap the readers.
+    ASSERT_EQ(0, variorum_shm_create(name, 4, &writer));
+    for (int r = 0; r < nreaders; r++)
+    {
+        pids[r] = fork();
+        ASSERT_GE(pids[r], 0);
+        if (pids[r] == 0)
+        {
+            struct variorum_shm_sample *samples =
+                new struct variorum_shm_sample[4];
+            struct variorum_shm *reader;
+            uint64_t last = 0;
+            int n;
+
+            alarm(60);
+            if (variorum_shm_attach(name, &reader) != 0)
+            {
+                _exit(2);
+            }
+            while (last < nsamples)
+            {
+                if (variorum_shm_read(reader, &samples[0]) == 0)
+                {
+                    if (check_sample(&samples[0]) || samples[0].sequence < last)
+                    {
+                        _exit(3);
+                    }
+                    last = samples[0].sequence;
+                }
+                n = variorum_shm_read_history(reader, samples, 4);
+                for (int i = 0; i < n; i++)
+                {
+                    if (check_sample(&samples[i]) ||
+                        (i > 0 && samples[i].sequence <= samples[i - 1].sequence))
+                    {
+                        _exit(4);
+                    }
+                }
+            }
+            variorum_shm_detach(reader);
+            delete[] samples;
+            _exit(0);
+        }
+    }
+
+    for (uint64_t n = 1; n <= nsamples; n++)
+    {
+        fill_sample(metrics, n);
+        ASSERT_EQ(0, variorum_shm_write(writer, metrics, sample_count(n)));
+    }
+    for (int r = 0; r < nreaders; r++)
+    {
+        ASSERT_EQ(pids[r], waitpid(pids[r], &status, 0));
+        EXPECT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(0, WEXITSTATUS(status));
+    }
+    variorum_shm_destroy(writer);
+}
@@ -0,0 +1,169 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Start of the traces in microseconds, on a grid point of 100 ms.
+#define T0 1000000000LL
+
+static void write_file(const std::string &path, const char *text)
+{
+    FILE *f = fopen(path.c_str(), "w");
+
+    ASSERT_NE((FILE *)NULL, f);
+    fputs(text, f);
+    fclose(f);
+}
+
+// Rows of a CSV file after its header, split into fields.
+static std::vector<std::vector<std::string> > read_csv(const std::string &path)
+{
+    std::vector<std::vector<std::string> > rows;
+    char line[1024];
+    FILE *f = fopen(path.c_str(), "r");
+
+    if (f == NULL)
+    {
+        return rows;
+    }
+    if (fgets(line, sizeof(line), f) != NULL)
+    {
+        while (fgets(line, sizeof(line), f) != NULL)
+        {
+            std::vector<std::string> fields;
+
+            line[strcspn(line, "\n")] = '\0';
+            for (char *p = line, *q; p != NULL; p = q)
+            {
+                q = strchr(p, ',');
+                if (q != NULL)
+                {
+                    *q++ = '\0';
+                }
+                fields.push_back(p);
+            }
+            rows.push_back(fields);
+        }
+    }
+    fclose(f);
+    return rows;
+}
+
+// Two nodes of a job as var_monitor writes them: node01 with balanced
+// sockets and a power step, node02 later and shorter with imbalanced
+// sockets, and a follower of node01 that must be skipped.
+class var_monitor_analyze : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char tmpl[] = "/tmp/t_var_monitor_analyze.XXXXXX";
+            char text[1024];
+
+            ASSERT_NE((char *)NULL, mkdtemp(tmpl));
+            dir = tmpl;
+            snprintf(text, sizeof(text),
+                     "Hostname,Timestamp,Node Power (W),Socket_0 Power (W),"
+                     "Mem_0 Power (W),Socket_1 Power (W),Mem_1 Power (W)\n"
+                     "node01,%lld,100.00,40.00,10.00,40.00,10.00\n"
+                     "node01,%lld,200.00,80.00,20.00,80.00,20.00\n"
+                     "node01,%lld,200.00,80.00,20.00,80.00,20.00\n",
+                     T0, T0 + 150000, T0 + 300000);
+            write_file(dir + "/node01.var_monitor.dat", text);
+            write_file(dir + "/node01.power.summary",
+                       "host: node01\npid: 1\nruntime ms: 400\n");
+            snprintf(text, sizeof(text),
+                     "Hostname,Timestamp,Node Power (W),Socket_0 Power (W),"
+                     "Mem_0 Power (W),Socket_1 Power (W),Mem_1 Power (W)\n"
+                     "node02,%lld,300.00,100.00,0.00,200.00,0.00\n"
+                     "node02,%lld,300.00,100.00,0.00,200.00,0.00\n",
+                     T0 + 50000, T0 + 250000);
+            write_file(dir + "/node02.var_monitor.dat", text);
+            write_file(dir + "/node01.4242.var_monitor.dat", text);
+        }
+
+        void TearDown() override
+        {
+            std::string cmd = "rm -rf " + dir;
+
+            ASSERT_EQ(0, system(cmd.c_str()));
+        }
+
+        std::string dir;
+};
+
+TEST_F(var_monitor_analyze, test_resample_and_integrate)
+{
+    std::string cmd = std::string(VAR_MONITOR_ANALYZE) + " -j 2 -o " + dir +
+                      "/job " + dir + " > /dev/null";
+    std::map<std::string, std::vector<std::string> > nodes;
+
+    ASSERT_EQ(0, system(cmd.c_str()));
+
+    // Hostname, Samples, Start, End, Runtime, Energy, Mean, Max, Imbalance.
+    for (const auto &row : read_csv(dir + "/job.nodes.csv"))
+    {
+        nodes[row[0]] = row;
+    }
+    ASSERT_EQ(2u, nodes.size());
+    // Trapezoids: 0.15 s at 150 W and 0.15 s at 200 W.
+    EXPECT_EQ("3", nodes["node01"][1]);
+    EXPECT_EQ("400", nodes["node01"][4]);
+    EXPECT_EQ("52.50", nodes["node01"][5]);
+    EXPECT_EQ("175.00", nodes["node01"][6]);
+    EXPECT_EQ("200.00", nodes["node01"][7]);
+    EXPECT_EQ("0.00", nodes["node01"][8]);
+    // No summary, so the runtime is the span of the samples.
+    EXPECT_EQ("2", nodes["node02"][1]);
+    EXPECT_EQ("200", nodes["node02"][4]);
+    EXPECT_EQ("60.00", nodes["node02"][5]);
+    EXPECT_EQ("300.00", nodes["node02"][6]);
+    EXPECT_EQ("66.67", nodes["node02"][8]);
+
+    // Timestamp, Nodes, Total, Node Min, Node Max, Sockets, Socket Min,
+    // Socket Max, Imbalance. node01 is interpolated between its samples,
+    // e.g., 2/3 of the way from 100 W to 200 W at 100 ms.
+    std::vector<std::vector<std::string> > timeline =
+        read_csv(dir + "/job.timeline.csv");
+    ASSERT_EQ(4u, timeline.size());
+    EXPECT_EQ(std::to_string(T0 / 1000), timeline[0][0]);
+    EXPECT_EQ("1", timeline[0][1]);
+    EXPECT_EQ("100.00", timeline[0][2]);
+    EXPECT_EQ(std::to_string(T0 / 1000 + 100), timeline[1][0]);
+    EXPECT_EQ("2", timeline[1][1]);
+    EXPECT_EQ("466.67", timeline[1][2]);
+    EXPECT_EQ("166.67", timeline[1][3]);
+    EXPECT_EQ("300.00", timeline[1][4]);
+    EXPECT_EQ("4", timeline[1][5]);
+    EXPECT_EQ("66.67", timeline[1][6]);
+    EXPECT_EQ("200.00", timeline[1][7]);
+    EXPECT_EQ("500.00", timeline[2][2]);
+    EXPECT_EQ("1", timeline[3][1]);
+    EXPECT_EQ("200.00", timeline[3][2]);
+    EXPECT_EQ("0.00", timeline[3][8]);
+}
+
+TEST_F(var_monitor_analyze, test_step)
+{
+    std::string cmd = std::string(VAR_MONITOR_ANALYZE) + " -s 50 -j 1 -o " +
+                      dir + "/job " + dir + "/node01.var_monitor.dat > /dev/null";
+
+    ASSERT_EQ(0, system(cmd.c_str()));
+    std::vector<std::vector<std::string> > timeline =
+        read_csv(dir + "/job.timeline.csv");
+    ASSERT_EQ(7u, timeline.size());
+    // 1/3 of the way from 100 W to 200 W at 50 ms.
+    EXPECT_EQ("133.33", timeline[1][2]);
+    EXPECT_EQ("200.00", timeline[3][2]);
+}
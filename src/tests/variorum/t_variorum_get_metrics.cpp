@@ -0,0 +1,25 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <variorum.h>
+}
+
+TEST(variorum_queries, test_get_metrics)
+{
+    struct variorum_metric_vector metrics;
+
+    variorum_metric_vector_init(&metrics);
+    EXPECT_EQ(0, variorum_get_metrics(&metrics));
+    variorum_metric_vector_free(&metrics);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
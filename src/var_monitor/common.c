@@ -5,12 +5,19 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <sys/time.h>
 
 #include <variorum.h>
 #include <variorum_topology.h>
 #include <variorum_timers.h>
+#include <variorum_shm.h>
 #include <jansson.h>
 
+#include "series_log.h"
+
+// Region in which the highlander publishes its samples to its foes.
+#define STREAM_NAME "var_monitor"
+
 struct thread_args
 {
     bool measure_all;
@@ -18,11 +25,205 @@ struct thread_args
     bool power_with_util;
 };
 
+static struct variorum_shm *stream = NULL;
+static struct variorum_metric_vector stream_metrics;
+static int stream_truncated = 0;
+
+static struct variorum_shm *follow = NULL;
+static struct variorum_shm_sample *follow_samples = NULL;
+static uint64_t follow_last = 0;
+static uint64_t follow_start_us = 0;
+static struct variorum_metric *follow_columns = NULL;
+static uint32_t follow_ncolumns = 0;
+
 int init_data(void)
 {
     return 0;
 }
 
+/// @brief Open the trace on fd, compressed if its suffix is SERIES_LOG_SUFFIX.
+FILE *open_trace(int fd, const char *suffix)
+{
+    if (strcmp(suffix, SERIES_LOG_SUFFIX) == 0)
+    {
+        return series_log_fdopen(fd);
+    }
+    return fdopen(fd, "w");
+}
+
+/// @brief Start publishing every measurement of the highlander to its foes.
+void stream_open(void)
+{
+    variorum_metric_vector_init(&stream_metrics);
+    if (variorum_shm_create(STREAM_NAME, 0, &stream) != 0)
+    {
+        fprintf(stderr, "Warning: cannot publish samples in /dev/shm.\n");
+        stream = NULL;
+    }
+}
+
+void stream_close(void)
+{
+    if (stream != NULL)
+    {
+        variorum_shm_destroy(stream);
+        stream = NULL;
+    }
+    variorum_metric_vector_free(&stream_metrics);
+}
+
+void stream_publish(void)
+{
+    if (stream == NULL)
+    {
+        return;
+    }
+    variorum_metric_vector_clear(&stream_metrics);
+    if (variorum_get_metrics(&stream_metrics) == 0 && stream_metrics.count > 0)
+    {
+        if (variorum_shm_write(stream, stream_metrics.metrics,
+                               (uint32_t)stream_metrics.count) == 1 &&
+            !stream_truncated)
+        {
+            fprintf(stderr, "Warning: only %d of %zu metrics are published "
+                    "in /dev/shm.\n", VARIORUM_SHM_MAX_METRICS,
+                    stream_metrics.count);
+            stream_truncated = 1;
+        }
+    }
+}
+
+/// @brief Indicate whether a sample has the columns of the last header
+/// written, i.e., the same metrics in the same order.
+static int follow_same_columns(const struct variorum_shm_sample *s)
+{
+    uint32_t j;
+
+    if (s->count != follow_ncolumns)
+    {
+        return 0;
+    }
+    for (j = 0; j < s->count; j++)
+    {
+        if (s->metrics[j].domain != follow_columns[j].domain ||
+            s->metrics[j].index != follow_columns[j].index ||
+            strcmp(s->metrics[j].name, follow_columns[j].name) != 0)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/// @brief Append the samples the highlander published since the last call
+/// to logfile, so a foe records a trace without sampling itself.
+void follow_measurement(void)
+{
+    static const char *domains[] = {"node", "socket", "core", "thread", "gpu",
+                                    "ccd"
+                                   };
+    char hostname[64];
+    struct variorum_shm_sample *s;
+    uint32_t j;
+    int i;
+    int n;
+
+    if (follow_start_us == 0)
+    {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        follow_start_us = tv.tv_sec * (uint64_t)1000000 + tv.tv_usec;
+    }
+    if (follow == NULL && variorum_shm_attach(STREAM_NAME, &follow) != 0)
+    {
+        // The highlander has not published yet.
+        follow = NULL;
+        return;
+    }
+    if (follow_samples == NULL)
+    {
+        follow_samples = malloc(VARIORUM_SHM_DEFAULT_HISTORY *
+                                sizeof(struct variorum_shm_sample));
+        if (follow_samples == NULL)
+        {
+            return;
+        }
+    }
+
+    n = variorum_shm_read_history(follow, follow_samples,
+                                  VARIORUM_SHM_DEFAULT_HISTORY);
+    if (n > 0 && follow_samples[n - 1].sequence < follow_last)
+    {
+        // A new highlander recreated the region.
+        follow_last = 0;
+    }
+    gethostname(hostname, 64);
+    for (i = 0; i < n; i++)
+    {
+        s = &follow_samples[i];
+        // Skip the history from before this process started.
+        if (s->sequence <= follow_last || s->count == 0 ||
+            s->metrics[0].timestamp_us < follow_start_us)
+        {
+            continue;
+        }
+        // Metrics that need two samples, e.g., derived metrics, are missing
+        // from the first one, so write the header again when the columns
+        // change, and every row matches the header above it.
+        if (!follow_same_columns(s))
+        {
+            struct variorum_metric *columns;
+
+            columns = realloc(follow_columns,
+                              s->count * sizeof(struct variorum_metric));
+            if (columns == NULL)
+            {
+                return;
+            }
+            follow_columns = columns;
+            memcpy(follow_columns, s->metrics,
+                   s->count * sizeof(struct variorum_metric));
+            follow_ncolumns = s->count;
+            fprintf(logfile, "Hostname,Timestamp (us)");
+            for (j = 0; j < s->count; j++)
+            {
+                if (s->metrics[j].domain == VARIORUM_DOMAIN_NODE ||
+                    s->metrics[j].domain < 0 || s->metrics[j].domain > 5)
+                {
+                    fprintf(logfile, ",%s", s->metrics[j].name);
+                }
+                else
+                {
+                    fprintf(logfile, ",%s_%s_%d", s->metrics[j].name,
+                            domains[s->metrics[j].domain], s->metrics[j].index);
+                }
+            }
+            fprintf(logfile, "\n");
+        }
+        fprintf(logfile, "%s,%lu", hostname, s->metrics[0].timestamp_us);
+        for (j = 0; j < s->count; j++)
+        {
+            fprintf(logfile, ",%0.2lf", s->metrics[j].value);
+        }
+        fprintf(logfile, "\n");
+        follow_last = s->sequence;
+    }
+}
+
+void follow_close(void)
+{
+    if (follow != NULL)
+    {
+        variorum_shm_detach(follow);
+        follow = NULL;
+    }
+    free(follow_samples);
+    follow_samples = NULL;
+    free(follow_columns);
+    follow_columns = NULL;
+    follow_ncolumns = 0;
+}
+
 void parse_json_power_obj(char *s, int num_sockets)
 {
     const char *hostname = NULL;
@@ -352,6 +553,13 @@ void take_measurement(bool measure_all, bool power_with_util)
 #endif
     pthread_mutex_lock(&mlock);
 
+    // The trace is closed once the application has finished.
+    if (logfile == NULL)
+    {
+        pthread_mutex_unlock(&mlock);
+        return;
+    }
+
     // Default is to just dump out instantaneous power samples
     if (measure_all == false)
     {
@@ -402,6 +610,8 @@ void take_measurement(bool measure_all, bool power_with_util)
         variorum_monitoring(logfile);
     }
 
+    stream_publish();
+
 #if 0
     total_joules += rapl_data[0] + rapl_data[1];
     limit_joules += rapl_data[2] + rapl_data[3];
@@ -0,0 +1,263 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <variorum.h>
+#include <variorum_error.h>
+#include <variorum_flight.h>
+
+#include "flight_recorder.h"
+
+/// @brief Windows whose dump has not started yet. More are dropped.
+#define QUEUE_LEN 16
+
+/// @brief Time the package power is averaged over, in milliseconds.
+#define POWER_WINDOW_MS 10
+
+static struct variorum_flight *flight = NULL;
+static char *dump_prefix = NULL;
+static uint64_t period_ns;
+static volatile int recording = 0;
+static pthread_t sampler;
+static pthread_t dumper;
+
+/// @brief Windows handed from the sampler to the dumper.
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static struct variorum_flight_event queue[QUEUE_LEN];
+static unsigned queue_first = 0;
+static unsigned queued = 0;
+static int sampler_done = 0;
+
+static unsigned long nsamples = 0;
+static unsigned long nlate = 0;
+static unsigned long ndumps = 0;
+static unsigned long ndropped = 0;
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * (uint64_t)1000000000 + ts.tv_nsec;
+}
+
+static void enqueue(const struct variorum_flight_event *ev)
+{
+    pthread_mutex_lock(&queue_lock);
+    if (queued < QUEUE_LEN)
+    {
+        queue[(queue_first + queued) % QUEUE_LEN] = *ev;
+        queued++;
+        pthread_cond_signal(&queue_cond);
+    }
+    else
+    {
+        ndropped++;
+    }
+    pthread_mutex_unlock(&queue_lock);
+}
+
+static void *sample(void *arg)
+{
+    struct variorum_snapshot snap;
+    struct variorum_flight_event ev;
+    struct timespec ts;
+    uint64_t next_ns = monotonic_ns();
+    uint64_t now_ns;
+    uint64_t missed;
+    int rc;
+
+    (void)arg;
+    while (recording)
+    {
+        rc = variorum_read_snapshot(&snap);
+        if (rc != 0)
+        {
+            fprintf(stderr, "Flight recorder: cannot read a snapshot (%d), "
+                    "stopping.\n", rc);
+            break;
+        }
+        nsamples++;
+        if (variorum_flight_record(flight, &snap, &ev))
+        {
+            enqueue(&ev);
+        }
+
+        // Sleep to the next tick, skipping the ticks already missed.
+        next_ns += period_ns;
+        now_ns = monotonic_ns();
+        if (now_ns >= next_ns + period_ns)
+        {
+            missed = (now_ns - next_ns) / period_ns;
+            nlate += missed;
+            next_ns += missed * period_ns;
+        }
+        if (now_ns < next_ns)
+        {
+            ts.tv_sec = next_ns / 1000000000;
+            ts.tv_nsec = next_ns % 1000000000;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+    }
+    if (variorum_flight_finish(flight, &ev))
+    {
+        enqueue(&ev);
+    }
+
+    pthread_mutex_lock(&queue_lock);
+    sampler_done = 1;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+    return NULL;
+}
+
+static void write_window(const struct variorum_flight_event *ev)
+{
+    char fname[4096];
+    FILE *out;
+    int fd;
+    int rc;
+
+    snprintf(fname, sizeof(fname), "%s.flight.%lu.dat", dump_prefix, ndumps++);
+    fd = open(fname, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Flight recorder: cannot open %s -- %s.\n", fname,
+                strerror(errno));
+        return;
+    }
+    out = fdopen(fd, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "Flight recorder: fdopen failed for %s -- %s.\n", fname,
+                strerror(errno));
+        close(fd);
+        return;
+    }
+    rc = variorum_flight_dump(flight, ev, out);
+    fclose(out);
+    if (rc == VARIORUM_ERROR_INVAL)
+    {
+        fprintf(stderr, "Flight recorder: %s is incomplete, its samples were "
+                "overwritten before they could be written.\n", fname);
+    }
+    else if (rc != 0)
+    {
+        fprintf(stderr, "Flight recorder: cannot write %s.\n", fname);
+    }
+    else
+    {
+        printf("Flight recorder: wrote %s, %lu samples around a trigger.\n",
+               fname, (unsigned long)(ev->last - ev->first + 1));
+    }
+}
+
+static void *dump(void *arg)
+{
+    struct variorum_flight_event ev;
+
+    (void)arg;
+    pthread_mutex_lock(&queue_lock);
+    for (;;)
+    {
+        while (queued == 0 && !sampler_done)
+        {
+            pthread_cond_wait(&queue_cond, &queue_lock);
+        }
+        if (queued == 0)
+        {
+            break;
+        }
+        ev = queue[queue_first];
+        queue_first = (queue_first + 1) % QUEUE_LEN;
+        queued--;
+        pthread_mutex_unlock(&queue_lock);
+        write_window(&ev);
+        pthread_mutex_lock(&queue_lock);
+    }
+    pthread_mutex_unlock(&queue_lock);
+    return NULL;
+}
+
+int flight_recorder_start(const char *prefix, double hz, double before,
+                          double after, double watts)
+{
+    struct variorum_flight_config cfg;
+    struct variorum_snapshot snap;
+
+    if (hz <= 0.0 || before < 0.0 || after < 0.0)
+    {
+        return -1;
+    }
+    if (variorum_arm_snapshot() != 0 || variorum_read_snapshot(&snap) != 0)
+    {
+        fprintf(stderr, "Flight recorder: snapshots are not supported on this "
+                "platform.\n");
+        variorum_disarm_snapshot();
+        return -1;
+    }
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.before = (uint32_t)(before * hz);
+    cfg.after = (uint32_t)(after * hz);
+    cfg.power_window = (uint32_t)(hz * POWER_WINDOW_MS / 1000);
+    if (cfg.power_window == 0)
+    {
+        cfg.power_window = 1;
+    }
+    cfg.power_watts = watts;
+    cfg.therm_mask = VARIORUM_FLIGHT_THERM_MASK;
+    cfg.cap_changes = 1;
+    if (variorum_flight_create(&cfg, &flight) != 0)
+    {
+        fprintf(stderr, "Flight recorder: cannot allocate the ring of samples.\n");
+        variorum_disarm_snapshot();
+        return -1;
+    }
+    dump_prefix = strdup(prefix);
+    period_ns = (uint64_t)(1e9 / hz);
+    recording = 1;
+    sampler_done = 0;
+    pthread_create(&sampler, NULL, sample, NULL);
+    pthread_create(&dumper, NULL, dump, NULL);
+    return 0;
+}
+
+void flight_recorder_trigger(void)
+{
+    if (flight != NULL)
+    {
+        variorum_flight_trigger(flight);
+    }
+}
+
+void flight_recorder_stop(void)
+{
+    if (!recording)
+    {
+        return;
+    }
+    recording = 0;
+    pthread_join(sampler, NULL);
+    pthread_join(dumper, NULL);
+    printf("Flight recorder: %lu samples, %lu late, %lu dumps, %lu triggers "
+           "dropped.\n", nsamples, nlate, ndumps, ndropped);
+    variorum_flight_destroy(flight);
+    flight = NULL;
+    free(dump_prefix);
+    dump_prefix = NULL;
+    variorum_disarm_snapshot();
+}
@@ -0,0 +1,45 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+/// @brief Start sampling the node at a high rate into an in-memory flight
+/// recorder, and write the samples around every trigger to
+/// prefix.flight.N.dat.
+///
+/// Samples are snapshots from variorum_read_snapshot(). One thread samples
+/// without doing I/O, another writes the dumps. Triggers are the package
+/// power of all sockets going above watts, PROCHOT, thermal or critical
+/// temperature status becoming set on a socket, a package power limit
+/// changing, and flight_recorder_trigger().
+///
+/// @param [in] prefix Path and host name of the dumps, e.g., node01.
+/// @param [in] hz Samples per second.
+/// @param [in] before Seconds of samples kept before a trigger.
+/// @param [in] after Seconds of samples recorded after a trigger.
+/// @param [in] watts Package power of all sockets that triggers, or 0.
+///
+/// @return 0 if successful, else -1.
+int flight_recorder_start(
+    const char *prefix,
+    double hz,
+    double before,
+    double after,
+    double watts
+);
+
+/// @brief Trigger a dump at the next sample. Async-signal-safe.
+void flight_recorder_trigger(
+    void
+);
+
+/// @brief Stop sampling, and write the samples of the last trigger. A signal
+/// that calls flight_recorder_trigger() must be blocked or ignored first.
+void flight_recorder_stop(
+    void
+);
+
+#endif
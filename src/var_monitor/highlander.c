@@ -3,15 +3,43 @@
 //
 // SPDX-License-Identifier: MIT
 
+#include <errno.h>
 #include <fcntl.h>
 #include <semaphore.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+// Held exclusively by the highlander. Tests elect in their own files.
+#ifndef HIGHLANDER_LEADER_FILE
+#define HIGHLANDER_LEADER_FILE "/dev/shm/variorum.highlander"
+#endif
+// Held shared by every process between highlander() and highlander_wait().
+#ifndef HIGHLANDER_MEMBERS_FILE
+#define HIGHLANDER_MEMBERS_FILE "/dev/shm/variorum.highlander.members"
+#endif
 
 static int amHighlander = -1;
 
-static sem_t *semk = NULL;
-static sem_t *seml = NULL;
+static int leaderfd = -1;
+static int membersfd = -1;
+
+// flock() rather than fcntl() locks: they belong to the open file, so they
+// survive fork() in the application child and are not dropped when another
+// descriptor of the same file is closed in this process.
+static int lock_file(int fd, int op)
+{
+    int rc;
+
+    do
+    {
+        rc = flock(fd, op);
+    }
+    while (rc != 0 && errno == EINTR);
+    return rc;
+}
 
 /// @brief Determines/initializes the process highlander status.
 int highlander(void)
@@ -21,20 +49,38 @@ int highlander(void)
         return amHighlander;
     }
 
-    semk = sem_open("/power_wrapperK", O_CREAT | O_EXCL, 0600, 0);
-    if (semk == NULL || semk == SEM_FAILED)
+    // Join the node first, so a highlander waiting for its foes also waits
+    // for this process.
+    membersfd = open(HIGHLANDER_MEMBERS_FILE, O_RDWR | O_CREAT | O_CLOEXEC,
+                     0600);
+    leaderfd = open(HIGHLANDER_LEADER_FILE, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (membersfd < 0 || leaderfd < 0 || lock_file(membersfd, LOCK_SH) != 0)
     {
-        semk = sem_open("/power_wrapperK", O_CREAT, 0600, 0);
-        seml = sem_open("/power_wrapperL", O_CREAT, 0600, 0);
-        sem_post(semk);
-        int v;
-        sem_getvalue(semk, &v);
-        amHighlander = 0;
-        return 0;
+        fprintf(stderr, "Warning: cannot elect a highlander in /dev/shm -- %s.\n",
+                strerror(errno));
+        if (membersfd >= 0)
+        {
+            close(membersfd);
+        }
+        if (leaderfd >= 0)
+        {
+            close(leaderfd);
+        }
+        membersfd = -1;
+        leaderfd = -1;
+        amHighlander = 1;
+        return 1;
     }
-    seml = sem_open("/power_wrapperL", O_CREAT, 0600, 0);
-    amHighlander = 1;
-    return 1;
+
+    if (lock_file(leaderfd, LOCK_EX | LOCK_NB) == 0)
+    {
+        amHighlander = 1;
+        return 1;
+    }
+    close(leaderfd);
+    leaderfd = -1;
+    amHighlander = 0;
+    return 0;
 }
 
 int highlander_clean(void)
@@ -54,29 +100,39 @@ int highlander_wait(void)
     {
         return 1;
     }
-    if (amHighlander)
+    if (membersfd < 0)
     {
-        int v;
-        sem_getvalue(semk, &v);
-        while (v > 1)
-        {
-            sem_wait(seml);
-        }
-
-        sem_close(semk);
-        sem_close(seml);
-        sem_unlink("/power_wrapperK");
-        sem_unlink("/power_wrapperL");
-
         return 0;
     }
-    else
+    if (amHighlander)
     {
-        sem_wait(semk);
-        sem_post(seml);
-        sem_close(semk);
-        sem_close(seml);
+        // The exclusive lock is granted once every foe released its shared
+        // lock, either in highlander_wait() or by exiting. Foes that arrive
+        // meanwhile are waited for as well, as the samples are still taken.
+        // Holding it keeps later processes in highlander() until the
+        // highlander leaves.
+        lock_file(membersfd, LOCK_EX);
         return 0;
     }
-    return 1;
+    lock_file(membersfd, LOCK_UN);
+    close(membersfd);
+    membersfd = -1;
+    return 0;
+}
+
+/// @brief Causes the highlander to step down and leave the node.
+void highlander_leave(void)
+{
+    if (amHighlander != 1 || membersfd < 0)
+    {
+        return;
+    }
+    // Step down before leaving the node, so the next process blocked in
+    // highlander() wins the election.
+    lock_file(leaderfd, LOCK_UN);
+    close(leaderfd);
+    leaderfd = -1;
+    lock_file(membersfd, LOCK_UN);
+    close(membersfd);
+    membersfd = -1;
 }
@@ -7,16 +7,33 @@
 #define HIGHLANDER_H
 
 /// @brief Determines/initializes the process highlander status.
+///
+/// The highlander is elected with advisory locks on files in /dev/shm, which
+/// the kernel releases when their holder exits. A highlander that crashed
+/// thus never blocks the next election, and nothing has to be cleaned up.
+///
+/// @return 1 if the calling process is the highlander of the node, else 0.
 int highlander(
     void
 );
 
-/// @brief Causes the highlander to wait until all foes have called wait.
+/// @brief Causes the highlander to wait until all foes have called wait or
+/// exited. Foes return immediately and leave the node.
+///
+/// The highlander stays elected, and processes arriving later wait in
+/// highlander(), until it calls highlander_leave(), so it can take its last
+/// sample and release what it shares with its foes first.
 int highlander_wait(
     void
 );
 
-/// @brief Remove outstanding semaphores.
+/// @brief Causes the highlander to step down and leave the node after
+/// highlander_wait(). Does nothing in foes.
+void highlander_leave(
+    void
+);
+
+/// @brief Remove the named semaphores left behind by older versions.
 int highlander_clean(
     void
 );
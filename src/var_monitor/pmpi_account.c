@@ -0,0 +1,132 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pmpi_account.h"
+
+void pmpi_account_start(struct pmpi_account *acct, double time, double joules)
+{
+    char host[sizeof(acct->rank.host)];
+
+    memcpy(host, acct->rank.host, sizeof(host));
+    memset(acct, 0, sizeof(struct pmpi_account));
+    memcpy(acct->rank.host, host, sizeof(host));
+    acct->last_time = time;
+    acct->last_joules = joules;
+}
+
+double pmpi_account_enter(struct pmpi_account *acct, double time,
+                          double joules)
+{
+    if (joules < acct->last_joules)
+    {
+        joules = acct->last_joules;
+    }
+    acct->rank.compute_seconds += time - acct->last_time;
+    acct->rank.compute_joules += joules - acct->last_joules;
+    acct->last_time = time;
+    acct->last_joules = joules;
+    return joules;
+}
+
+void pmpi_account_leave(struct pmpi_account *acct, int call, uintptr_t ra,
+                        double time0, double joules0, double time,
+                        double joules)
+{
+    struct pmpi_site *site;
+
+    if (joules < acct->last_joules)
+    {
+        joules = acct->last_joules;
+    }
+    acct->rank.mpi_seconds += time - time0;
+    acct->rank.mpi_joules += joules - joules0;
+    acct->rank.mpi_calls += 1;
+    site = pmpi_account_site(acct, call, ra);
+    site->calls++;
+    site->seconds += time - time0;
+    site->joules += joules - joules0;
+    acct->last_time = time;
+    acct->last_joules = joules;
+}
+
+void pmpi_account_finish(struct pmpi_account *acct, double time,
+                         double joules)
+{
+    pmpi_account_enter(acct, time, joules);
+}
+
+struct pmpi_site *pmpi_account_site(struct pmpi_account *acct, int call,
+                                    uintptr_t ra)
+{
+    unsigned h = (unsigned)((ra >> 2) * 0x9E3779B1u + call) % PMPI_MAX_SITES;
+    unsigned i;
+
+    for (i = 0; i < PMPI_MAX_SITES; i++)
+    {
+        struct pmpi_site *site = &acct->sites[(h + i) % PMPI_MAX_SITES];
+        if (site->ra == 0)
+        {
+            if (acct->nsites >= PMPI_MAX_SITES / 2)
+            {
+                break;
+            }
+            site->call = call;
+            site->ra = ra;
+            acct->nsites++;
+            return site;
+        }
+        if (site->call == call && site->ra == ra)
+        {
+            return site;
+        }
+    }
+    // Keep the table sparse; further sites are only kept per call.
+    acct->other_sites[call].call = call;
+    return &acct->other_sites[call];
+}
+
+static int pmpi_site_record_cmp(const void *a, const void *b)
+{
+    return strcmp(((const struct pmpi_site_record *)a)->site,
+                  ((const struct pmpi_site_record *)b)->site);
+}
+
+int pmpi_merge_sites(struct pmpi_site_record *recs, int n)
+{
+    int i;
+    int out = 0;
+
+    qsort(recs, n, sizeof(struct pmpi_site_record), pmpi_site_record_cmp);
+    for (i = 0; i < n; i++)
+    {
+        if (out > 0 && strcmp(recs[out - 1].site, recs[i].site) == 0)
+        {
+            recs[out - 1].calls += recs[i].calls;
+            recs[out - 1].seconds += recs[i].seconds;
+            recs[out - 1].joules += recs[i].joules;
+        }
+        else
+        {
+            recs[out++] = recs[i];
+        }
+    }
+    return out;
+}
+
+double pmpi_energy_add(double *total, double *last, double joules)
+{
+    double delta = joules - *last;
+
+    *last = joules;
+    if (delta <= 0.0)
+    {
+        return 0.0;
+    }
+    *total += delta;
+    return delta;
+}
@@ -0,0 +1,197 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PMPI_ACCOUNT_H
+#define PMPI_ACCOUNT_H
+
+#include <stdint.h>
+
+/// @brief Call sites kept per rank, before further sites are only kept per
+/// call.
+#define PMPI_MAX_SITES 1024
+
+/// @brief Length of the name of a call site, call and caller.
+#define PMPI_SITE_LEN 112
+
+/// @brief List of intercepted MPI calls.
+enum pmpi_call_e
+{
+    PMPI_CALL_SEND,
+    PMPI_CALL_SSEND,
+    PMPI_CALL_BSEND,
+    PMPI_CALL_RSEND,
+    PMPI_CALL_RECV,
+    PMPI_CALL_SENDRECV,
+    PMPI_CALL_PROBE,
+    PMPI_CALL_WAIT,
+    PMPI_CALL_WAITANY,
+    PMPI_CALL_WAITSOME,
+    PMPI_CALL_WAITALL,
+    PMPI_CALL_BARRIER,
+    PMPI_CALL_BCAST,
+    PMPI_CALL_REDUCE,
+    PMPI_CALL_ALLREDUCE,
+    PMPI_CALL_GATHER,
+    PMPI_CALL_GATHERV,
+    PMPI_CALL_SCATTER,
+    PMPI_CALL_SCATTERV,
+    PMPI_CALL_ALLGATHER,
+    PMPI_CALL_ALLGATHERV,
+    PMPI_CALL_ALLTOALL,
+    PMPI_CALL_ALLTOALLV,
+    PMPI_CALL_REDUCE_SCATTER,
+    PMPI_CALL_SCAN,
+    PMPI_NUM_CALLS
+};
+
+/// @brief Time and energy of one call site, keyed by call and return
+/// address.
+struct pmpi_site
+{
+    int call;
+    uintptr_t ra;
+    uint64_t calls;
+    double seconds;
+    double joules;
+};
+
+/// @brief Call site record exchanged at MPI_Finalize, keyed by name because
+/// return addresses differ between ranks.
+struct pmpi_site_record
+{
+    char site[PMPI_SITE_LEN];
+    double calls;
+    double seconds;
+    double joules;
+};
+
+/// @brief Totals of one rank exchanged at MPI_Finalize.
+struct pmpi_rank_record
+{
+    char host[64];
+    double mpi_seconds;
+    double compute_seconds;
+    double mpi_joules;
+    double compute_joules;
+    double mpi_calls;
+};
+
+/// @brief Time and energy of one rank, split into MPI calls and the compute
+/// regions between them.
+struct pmpi_account
+{
+    /// @brief Totals of the rank.
+    struct pmpi_rank_record rank;
+    /// @brief Time and energy at the end of the last region.
+    double last_time;
+    double last_joules;
+    /// @brief Open-addressed table of call sites.
+    struct pmpi_site sites[PMPI_MAX_SITES];
+    unsigned nsites;
+    /// @brief Call sites that did not fit in the table, per call.
+    struct pmpi_site other_sites[PMPI_NUM_CALLS];
+};
+
+/// @brief Start accounting at the first compute region.
+///
+/// @param [out] acct Account, cleared except for the host name.
+/// @param [in] time Time, in seconds.
+/// @param [in] joules Energy attributed to the rank so far.
+void pmpi_account_start(
+    struct pmpi_account *acct,
+    double time,
+    double joules
+);
+
+/// @brief Enter an MPI call, closing the compute region that preceded it.
+///
+/// Energy is kept monotonic, as it may be extrapolated past the next
+/// reading.
+///
+/// @param [in,out] acct Account.
+/// @param [in] time Time, in seconds.
+/// @param [in] joules Energy attributed to the rank so far.
+///
+/// @return Energy the call starts at, to pass to pmpi_account_leave().
+double pmpi_account_enter(
+    struct pmpi_account *acct,
+    double time,
+    double joules
+);
+
+/// @brief Leave an MPI call, adding its time and energy to the rank and to
+/// its call site.
+///
+/// @param [in,out] acct Account.
+/// @param [in] call Call, see enum pmpi_call_e.
+/// @param [in] ra Return address of the call.
+/// @param [in] time0 Time the call was entered at.
+/// @param [in] joules0 Energy returned by pmpi_account_enter().
+/// @param [in] time Time, in seconds.
+/// @param [in] joules Energy attributed to the rank so far.
+void pmpi_account_leave(
+    struct pmpi_account *acct,
+    int call,
+    uintptr_t ra,
+    double time0,
+    double joules0,
+    double time,
+    double joules
+);
+
+/// @brief Close the last compute region.
+///
+/// @param [in,out] acct Account.
+/// @param [in] time Time, in seconds.
+/// @param [in] joules Energy attributed to the rank so far.
+void pmpi_account_finish(
+    struct pmpi_account *acct,
+    double time,
+    double joules
+);
+
+/// @brief Find or add the entry of a call site. Once the table is half
+/// full, new sites are added to the entry of their call in other_sites.
+///
+/// @param [in,out] acct Account.
+/// @param [in] call Call, see enum pmpi_call_e.
+/// @param [in] ra Return address of the call.
+///
+/// @return Entry of the site.
+struct pmpi_site *pmpi_account_site(
+    struct pmpi_account *acct,
+    int call,
+    uintptr_t ra
+);
+
+/// @brief Sort records by site and sum the records of the same site.
+///
+/// @param [in,out] recs Records, merged in place.
+/// @param [in] n Number of records.
+///
+/// @return Number of distinct sites.
+int pmpi_merge_sites(
+    struct pmpi_site_record *recs,
+    int n
+);
+
+/// @brief Add the energy of a reading to a running total.
+///
+/// The difference to the previous reading is added, so the total starts at
+/// 0. A reading below the previous one, e.g., after a counter reset, adds
+/// nothing.
+///
+/// @param [in,out] total Energy accumulated so far.
+/// @param [in,out] last Previous reading, replaced by joules.
+/// @param [in] joules Reading.
+///
+/// @return Energy added.
+double pmpi_energy_add(
+    double *total,
+    double *last,
+    double joules
+);
+
+#endif
@@ -20,6 +20,7 @@
 #include <unistd.h>
 
 #include "highlander.h"
+#include "series_log.h"
 
 #if 0
 /********/
@@ -56,7 +57,7 @@ int main(int argc, char **argv)
                         "    power_wrapper_static - monitor power and statically enforce power cap\n"
                         "\n"
                         "SYNOPSIS\n"
-                        "    power_wrapper_static [--help | -h] [-c] -w pcap -a \"executable [exec-args]\"\n"
+                        "    power_wrapper_static [--help | -h] [-c] [-z] -w pcap -a \"executable [exec-args]\"\n"
                         "\n"
                         "OVERVIEW\n"
                         "    Power_wrapper_static is a utility for setting a package-level power cap, and\n"
@@ -74,7 +75,10 @@ int main(int argc, char **argv)
                         "        Package-level power cap (integer).\n"
                         "\n"
                         "    -c\n"
-                        "        Remove stale shared memory.\n"
+                        "        Remove named semaphores left behind by older versions.\n"
+                        "\n"
+                        "    -z\n"
+                        "        Write the trace compressed, to hostname.var_monitor.vts.\n"
                         "\n";
     if (argc == 1 || (argc > 1 && (
                           strncmp(argv[1], "--help", strlen("--help")) == 0 ||
@@ -87,8 +91,9 @@ int main(int argc, char **argv)
     int opt;
     char *app = NULL;
     char **arg = NULL;
+    const char *suffix = ".dat";
 
-    while ((opt = getopt(argc, argv, "cw:a:")) != -1)
+    while ((opt = getopt(argc, argv, "cw:a:z")) != -1)
     {
         switch (opt)
         {
@@ -102,6 +107,9 @@ int main(int argc, char **argv)
             case 'w':
                 watt_cap = atoi(optarg);
                 break;
+            case 'z':
+                suffix = SERIES_LOG_SUFFIX;
+                break;
             case '?':
                 if (optopt == 'w' || optopt == 'a')
                 {
@@ -154,7 +162,7 @@ int main(int argc, char **argv)
         char hostname[64];
         gethostname(hostname, 64);
 
-        rc = asprintf(&fname_dat, "%s.var_monitor.dat", hostname);
+        rc = asprintf(&fname_dat, "%s.var_monitor%s", hostname, suffix);
         if (rc == -1)
         {
             fprintf(stderr,
@@ -172,7 +180,7 @@ int main(int argc, char **argv)
             free(fname_dat);
             return 1;
         }
-        logfile = fdopen(logfd, "w");
+        logfile = open_trace(logfd, suffix);
         if (logfile == NULL)
         {
             fprintf(stderr, "Fatal Error: %s on %s fdopen failed for %s -- %s.\n", argv[0],
@@ -229,6 +237,13 @@ int main(int argc, char **argv)
         take_measurement(true, false);
         end = now_ms();
 
+        /* A compressed trace is only complete once closed. */
+        pthread_mutex_lock(&mlock);
+        fclose(logfile);
+        logfile = NULL;
+        pthread_mutex_unlock(&mlock);
+        highlander_leave();
+
         /* Output summary data. */
         rc = asprintf(&fname_summary, "%s.power.summary", hostname);
         if (rc == -1)
@@ -299,7 +314,6 @@ int main(int argc, char **argv)
     printf("Output Files\n"
            "  %s\n"
            "  %s\n\n", fname_dat, fname_summary);
-    highlander_clean();
     free(fname_dat);
     return 0;
 }
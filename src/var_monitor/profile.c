@@ -0,0 +1,1105 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <elf.h>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <variorum.h>
+#include <variorum_error.h>
+#include <variorum_timers.h>
+
+#include "profile.h"
+
+/// @brief Data pages of the sampling ring buffer of each CPU, a power of two.
+#define PROFILE_RING_PAGES 32
+
+/// @brief Longest function name written, including the terminating null.
+#define PROFILE_NAME_LEN 256
+
+/// @brief Serialises the calls into libvariorum made by the tools, which
+/// share its platform state and are not safe to make concurrently.
+static pthread_mutex_t profile_variorum_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/// @brief Function symbol of an ELF file.
+struct profile_symbol
+{
+    /// @brief Virtual address of the function in the file.
+    uint64_t addr;
+    /// @brief Size of the function in bytes.
+    uint64_t size;
+    /// @brief Name, pointing into the mapped file.
+    const char *name;
+};
+
+struct profile_elf
+{
+    /// @brief Path of the file.
+    char *path;
+    /// @brief Read-only mapping of the whole file, or NULL if it is not a
+    /// 64-bit ELF file.
+    void *map;
+    /// @brief Size of map.
+    size_t map_size;
+    /// @brief Program headers, pointing into map.
+    const Elf64_Phdr *phdr;
+    /// @brief Number of program headers.
+    size_t nphdr;
+    /// @brief Function symbols sorted by address.
+    struct profile_symbol *syms;
+    /// @brief Number of valid entries in syms.
+    size_t nsyms;
+};
+
+/// @brief Per-function totals written by profile_write().
+struct profile_row
+{
+    char name[PROFILE_NAME_LEN];
+    uint64_t samples;
+    uint64_t inst_samples;
+    double seconds;
+    double pkg_joules;
+    double dram_joules;
+};
+
+static uint64_t profile_hash(const uint64_t *ips, uint32_t depth)
+{
+    uint64_t h = 14695981039346656037ULL;
+    uint32_t i;
+
+    for (i = 0; i < depth; i++)
+    {
+        h ^= ips[i];
+        h *= 1099511628211ULL;
+    }
+    return h ^ (h >> 29);
+}
+
+int profile_init(struct profile *p)
+{
+    memset(p, 0, sizeof(struct profile));
+    p->nslots = 1024;
+    p->slots = (size_t *) calloc(p->nslots, sizeof(size_t));
+    if (p->slots == NULL)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+void profile_free(struct profile *p)
+{
+    size_t i;
+
+    for (i = 0; i < p->nmappings; i++)
+    {
+        free(p->mappings[i].path);
+    }
+    for (i = 0; i < p->nelves; i++)
+    {
+        if (p->elves[i].map != NULL)
+        {
+            munmap(p->elves[i].map, p->elves[i].map_size);
+        }
+        free(p->elves[i].syms);
+        free(p->elves[i].path);
+    }
+    free(p->elves);
+    free(p->mappings);
+    free(p->touched);
+    free(p->slots);
+    free(p->stacks);
+    memset(p, 0, sizeof(struct profile));
+}
+
+/// @brief Double the hash table of stacks.
+static int profile_rehash(struct profile *p)
+{
+    size_t nslots = p->nslots * 2;
+    size_t *slots = (size_t *) calloc(nslots, sizeof(size_t));
+    size_t i, j;
+
+    if (slots == NULL)
+    {
+        return -1;
+    }
+    for (i = 0; i < p->nstacks; i++)
+    {
+        j = profile_hash(p->stacks[i].ips, p->stacks[i].depth) & (nslots - 1);
+        while (slots[j] != 0)
+        {
+            j = (j + 1) & (nslots - 1);
+        }
+        slots[j] = i + 1;
+    }
+    free(p->slots);
+    p->slots = slots;
+    p->nslots = nslots;
+    return 0;
+}
+
+/// @brief Find a stack, adding it if it was never sampled.
+///
+/// @return Index of the stack, else -1 if out of memory.
+static long profile_find_stack(struct profile *p, const uint64_t *ips,
+                               uint32_t depth)
+{
+    struct profile_stack *st;
+    size_t j;
+
+    if ((p->nstacks + 1) * 2 > p->nslots && profile_rehash(p))
+    {
+        return -1;
+    }
+    j = profile_hash(ips, depth) & (p->nslots - 1);
+    while (p->slots[j] != 0)
+    {
+        st = &p->stacks[p->slots[j] - 1];
+        if (st->depth == depth &&
+            memcmp(st->ips, ips, depth * sizeof(uint64_t)) == 0)
+        {
+            return (long)(p->slots[j] - 1);
+        }
+        j = (j + 1) & (p->nslots - 1);
+    }
+
+    if (p->nstacks == p->capacity)
+    {
+        size_t capacity = p->capacity ? p->capacity * 2 : 256;
+        struct profile_stack *stacks = (struct profile_stack *)
+                                       realloc(p->stacks, capacity * sizeof(struct profile_stack));
+        size_t *touched;
+
+        if (stacks == NULL)
+        {
+            return -1;
+        }
+        p->stacks = stacks;
+        touched = (size_t *) realloc(p->touched, capacity * sizeof(size_t));
+        if (touched == NULL)
+        {
+            return -1;
+        }
+        p->touched = touched;
+        p->capacity = capacity;
+    }
+    st = &p->stacks[p->nstacks];
+    memset(st, 0, sizeof(struct profile_stack));
+    memcpy(st->ips, ips, depth * sizeof(uint64_t));
+    st->depth = depth;
+    p->slots[j] = ++p->nstacks;
+    return (long)(p->nstacks - 1);
+}
+
+int profile_add_sample(struct profile *p, int event, const uint64_t *ips,
+                       uint32_t depth)
+{
+    struct profile_stack *st;
+    long idx;
+
+    if (depth > PROFILE_STACK_MAX)
+    {
+        depth = PROFILE_STACK_MAX;
+    }
+    idx = profile_find_stack(p, ips, depth);
+    if (idx < 0)
+    {
+        return -1;
+    }
+    st = &p->stacks[idx];
+    if (event == PROFILE_EVENT_INSTRUCTIONS)
+    {
+        st->inst_samples++;
+        return 0;
+    }
+    if (st->pending == 0)
+    {
+        p->touched[p->ntouched++] = (size_t)idx;
+    }
+    st->pending++;
+    p->pending_total++;
+    return 0;
+}
+
+void profile_close_interval(struct profile *p, double seconds,
+                            double pkg_joules, double dram_joules)
+{
+    struct profile_stack *st;
+    double share;
+    size_t i;
+
+    if (p->pending_total == 0)
+    {
+        p->idle_seconds += seconds;
+        p->idle_pkg_joules += pkg_joules;
+        p->idle_dram_joules += dram_joules;
+        return;
+    }
+    for (i = 0; i < p->ntouched; i++)
+    {
+        st = &p->stacks[p->touched[i]];
+        share = (double)st->pending / p->pending_total;
+        st->seconds += share * seconds;
+        st->pkg_joules += share * pkg_joules;
+        st->dram_joules += share * dram_joules;
+        st->samples += st->pending;
+        st->pending = 0;
+    }
+    p->ntouched = 0;
+    p->pending_total = 0;
+}
+
+int profile_add_mapping(struct profile *p, uint64_t start, uint64_t end,
+                        uint64_t pgoff, const char *path)
+{
+    struct profile_mapping *mappings;
+    char *copy = strdup(path);
+
+    if (copy == NULL)
+    {
+        return -1;
+    }
+    mappings = (struct profile_mapping *) realloc(p->mappings,
+               (p->nmappings + 1) * sizeof(struct profile_mapping));
+    if (mappings == NULL)
+    {
+        free(copy);
+        return -1;
+    }
+    p->mappings = mappings;
+    p->mappings[p->nmappings].start = start;
+    p->mappings[p->nmappings].end = end;
+    p->mappings[p->nmappings].pgoff = pgoff;
+    p->mappings[p->nmappings].path = copy;
+    p->nmappings++;
+    return 0;
+}
+
+int profile_load_maps(struct profile *p, const char *maps_path)
+{
+    unsigned long long start, end, pgoff;
+    char line[4096];
+    char perms[8];
+    char *path;
+    size_t n;
+    FILE *fp = fopen(maps_path, "r");
+
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        // Only executable regions hold sampled instruction pointers.
+        if (sscanf(line, "%llx-%llx %7s %llx", &start, &end, perms, &pgoff) != 4 ||
+            strchr(perms, 'x') == NULL)
+        {
+            continue;
+        }
+        path = strchr(line, '/');
+        if (path == NULL)
+        {
+            continue;
+        }
+        n = strlen(path);
+        if (n > 0 && path[n - 1] == '\n')
+        {
+            path[n - 1] = '\0';
+        }
+        if (profile_add_mapping(p, start, end, pgoff, path))
+        {
+            fclose(fp);
+            return -1;
+        }
+    }
+    fclose(fp);
+    return 0;
+}
+
+static int profile_symbol_cmp(const void *a, const void *b)
+{
+    const struct profile_symbol *x = (const struct profile_symbol *)a;
+    const struct profile_symbol *y = (const struct profile_symbol *)b;
+
+    return (x->addr > y->addr) - (x->addr < y->addr);
+}
+
+/// @brief Collect the function symbols of one symbol table section.
+static int profile_elf_section(struct profile_elf *e, const Elf64_Shdr *shdr,
+                               size_t nshdr, size_t idx)
+{
+    const Elf64_Shdr *sh = &shdr[idx];
+    const Elf64_Shdr *strsh;
+    const Elf64_Sym *sym;
+    const char *strtab;
+    struct profile_symbol *syms;
+    size_t nsym, i;
+    int type;
+
+    if (sh->sh_link >= nshdr || sh->sh_entsize != sizeof(Elf64_Sym) ||
+        sh->sh_offset + sh->sh_size > e->map_size)
+    {
+        return 0;
+    }
+    strsh = &shdr[sh->sh_link];
+    if (strsh->sh_offset + strsh->sh_size > e->map_size)
+    {
+        return 0;
+    }
+    sym = (const Elf64_Sym *)((const char *)e->map + sh->sh_offset);
+    strtab = (const char *)e->map + strsh->sh_offset;
+    nsym = sh->sh_size / sizeof(Elf64_Sym);
+
+    syms = (struct profile_symbol *) realloc(e->syms,
+            (e->nsyms + nsym) * sizeof(struct profile_symbol));
+    if (syms == NULL)
+    {
+        return -1;
+    }
+    e->syms = syms;
+    for (i = 0; i < nsym; i++)
+    {
+        type = ELF64_ST_TYPE(sym[i].st_info);
+        if ((type != STT_FUNC && type != STT_GNU_IFUNC) ||
+            sym[i].st_shndx == SHN_UNDEF || sym[i].st_value == 0 ||
+            sym[i].st_name >= strsh->sh_size)
+        {
+            continue;
+        }
+        e->syms[e->nsyms].addr = sym[i].st_value;
+        e->syms[e->nsyms].size = sym[i].st_size;
+        e->syms[e->nsyms].name = strtab + sym[i].st_name;
+        e->nsyms++;
+    }
+    return 0;
+}
+
+/// @brief Map an ELF file and collect its program headers and function
+/// symbols from both .symtab and .dynsym, so stripped libraries still
+/// resolve their exported functions.
+static void profile_elf_load(struct profile_elf *e)
+{
+    const Elf64_Ehdr *eh;
+    const Elf64_Shdr *shdr;
+    struct stat st;
+    size_t i;
+    int fd = open(e->path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return;
+    }
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(Elf64_Ehdr))
+    {
+        close(fd);
+        return;
+    }
+    e->map_size = st.st_size;
+    e->map = mmap(NULL, e->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (e->map == MAP_FAILED)
+    {
+        e->map = NULL;
+        return;
+    }
+
+    eh = (const Elf64_Ehdr *)e->map;
+    if (memcmp(eh->e_ident, ELFMAG, SELFMAG) != 0 ||
+        eh->e_ident[EI_CLASS] != ELFCLASS64 ||
+        eh->e_phoff + eh->e_phnum * sizeof(Elf64_Phdr) > e->map_size ||
+        eh->e_shoff + eh->e_shnum * sizeof(Elf64_Shdr) > e->map_size)
+    {
+        munmap(e->map, e->map_size);
+        e->map = NULL;
+        return;
+    }
+    e->phdr = (const Elf64_Phdr *)((const char *)e->map + eh->e_phoff);
+    e->nphdr = eh->e_phnum;
+
+    shdr = (const Elf64_Shdr *)((const char *)e->map + eh->e_shoff);
+    for (i = 0; i < eh->e_shnum; i++)
+    {
+        if ((shdr[i].sh_type == SHT_SYMTAB || shdr[i].sh_type == SHT_DYNSYM) &&
+            profile_elf_section(e, shdr, eh->e_shnum, i))
+        {
+            break;
+        }
+    }
+    qsort(e->syms, e->nsyms, sizeof(struct profile_symbol), profile_symbol_cmp);
+}
+
+static struct profile_elf *profile_elf_get(struct profile *p, const char *path)
+{
+    struct profile_elf *elves;
+    struct profile_elf *e;
+    size_t i;
+
+    for (i = 0; i < p->nelves; i++)
+    {
+        if (strcmp(p->elves[i].path, path) == 0)
+        {
+            return &p->elves[i];
+        }
+    }
+    elves = (struct profile_elf *) realloc(p->elves,
+                                           (p->nelves + 1) * sizeof(struct profile_elf));
+    if (elves == NULL)
+    {
+        return NULL;
+    }
+    p->elves = elves;
+    e = &p->elves[p->nelves];
+    memset(e, 0, sizeof(struct profile_elf));
+    e->path = strdup(path);
+    if (e->path == NULL)
+    {
+        return NULL;
+    }
+    p->nelves++;
+    profile_elf_load(e);
+    return e;
+}
+
+/// @brief Find the function containing a file offset.
+static const char *profile_elf_lookup(const struct profile_elf *e,
+                                      uint64_t offset)
+{
+    const Elf64_Phdr *ph;
+    uint64_t vaddr = 0;
+    size_t lo, hi, mid;
+    int found = 0;
+    size_t i;
+
+    // Symbols hold link-time addresses, so go through the loadable segment
+    // holding the offset.
+    for (i = 0; i < e->nphdr && !found; i++)
+    {
+        ph = &e->phdr[i];
+        if (ph->p_type == PT_LOAD && offset >= ph->p_offset &&
+            offset < ph->p_offset + ph->p_filesz)
+        {
+            vaddr = offset - ph->p_offset + ph->p_vaddr;
+            found = 1;
+        }
+    }
+    if (!found || e->nsyms == 0)
+    {
+        return NULL;
+    }
+
+    // Last symbol starting at or below vaddr.
+    lo = 0;
+    hi = e->nsyms;
+    while (hi - lo > 1)
+    {
+        mid = (lo + hi) / 2;
+        if (e->syms[mid].addr <= vaddr)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    if (e->syms[lo].addr <= vaddr && vaddr < e->syms[lo].addr + e->syms[lo].size)
+    {
+        return e->syms[lo].name;
+    }
+    return NULL;
+}
+
+void profile_symbolize(struct profile *p, uint64_t ip, char *buf, size_t len)
+{
+    const struct profile_mapping *m = NULL;
+    const struct profile_elf *e;
+    const char *name = NULL;
+    const char *base;
+    uint64_t offset;
+    size_t i;
+
+    for (i = p->nmappings; i > 0; i--)
+    {
+        if (ip >= p->mappings[i - 1].start && ip < p->mappings[i - 1].end)
+        {
+            m = &p->mappings[i - 1];
+            break;
+        }
+    }
+    if (m == NULL)
+    {
+        snprintf(buf, len, "[unknown]");
+        return;
+    }
+
+    offset = ip - m->start + m->pgoff;
+    e = profile_elf_get(p, m->path);
+    if (e != NULL)
+    {
+        name = profile_elf_lookup(e, offset);
+    }
+    if (name != NULL)
+    {
+        snprintf(buf, len, "%s", name);
+        return;
+    }
+    base = strrchr(m->path, '/');
+    snprintf(buf, len, "%s+0x%llx", base ? base + 1 : m->path,
+             (unsigned long long)offset);
+}
+
+static int profile_row_name_cmp(const void *a, const void *b)
+{
+    return strcmp(((const struct profile_row *)a)->name,
+                  ((const struct profile_row *)b)->name);
+}
+
+static int profile_row_energy_cmp(const void *a, const void *b)
+{
+    const struct profile_row *x = (const struct profile_row *)a;
+    const struct profile_row *y = (const struct profile_row *)b;
+    double ex = x->pkg_joules + x->dram_joules;
+    double ey = y->pkg_joules + y->dram_joules;
+
+    if (ex != ey)
+    {
+        return ex < ey ? 1 : -1;
+    }
+    return (x->samples < y->samples) - (x->samples > y->samples);
+}
+
+/// @brief Write one row per leaf function, sorted by energy.
+static int profile_write_table(struct profile *p, FILE *table)
+{
+    struct profile_row *rows;
+    const struct profile_stack *st;
+    size_t nrows = 0;
+    size_t i;
+
+    rows = (struct profile_row *) calloc(p->nstacks ? p->nstacks : 1,
+                                         sizeof(struct profile_row));
+    if (rows == NULL)
+    {
+        return -1;
+    }
+    for (i = 0; i < p->nstacks; i++)
+    {
+        st = &p->stacks[i];
+        profile_symbolize(p, st->ips[0], rows[i].name, PROFILE_NAME_LEN);
+        rows[i].samples = st->samples;
+        rows[i].inst_samples = st->inst_samples;
+        rows[i].seconds = st->seconds;
+        rows[i].pkg_joules = st->pkg_joules;
+        rows[i].dram_joules = st->dram_joules;
+    }
+
+    // Merge the stacks of each function.
+    qsort(rows, p->nstacks, sizeof(struct profile_row), profile_row_name_cmp);
+    for (i = 0; i < p->nstacks; i++)
+    {
+        if (nrows > 0 && strcmp(rows[nrows - 1].name, rows[i].name) == 0)
+        {
+            rows[nrows - 1].samples += rows[i].samples;
+            rows[nrows - 1].inst_samples += rows[i].inst_samples;
+            rows[nrows - 1].seconds += rows[i].seconds;
+            rows[nrows - 1].pkg_joules += rows[i].pkg_joules;
+            rows[nrows - 1].dram_joules += rows[i].dram_joules;
+        }
+        else
+        {
+            rows[nrows++] = rows[i];
+        }
+    }
+    qsort(rows, nrows, sizeof(struct profile_row), profile_row_energy_cmp);
+
+    fprintf(table, "function samples seconds pkg_joules dram_joules ipc\n");
+    for (i = 0; i < nrows; i++)
+    {
+        fprintf(table, "%s %llu %.6lf %.6lf %.6lf %.3lf\n", rows[i].name,
+                (unsigned long long)rows[i].samples, rows[i].seconds,
+                rows[i].pkg_joules, rows[i].dram_joules,
+                rows[i].samples ? (double)rows[i].inst_samples / rows[i].samples : 0.0);
+    }
+    if (p->idle_seconds > 0)
+    {
+        fprintf(table, "[idle] 0 %.6lf %.6lf %.6lf 0.000\n", p->idle_seconds,
+                p->idle_pkg_joules, p->idle_dram_joules);
+    }
+    free(rows);
+    return 0;
+}
+
+/// @brief Write each stack from the root, weighted by its energy, or by its
+/// samples if no energy was measured.
+static int profile_write_collapsed(struct profile *p, FILE *collapsed)
+{
+    const struct profile_stack *st;
+    char name[PROFILE_NAME_LEN];
+    double total = 0.0;
+    unsigned long long weight;
+    size_t i;
+    uint32_t d;
+
+    for (i = 0; i < p->nstacks; i++)
+    {
+        total += p->stacks[i].pkg_joules + p->stacks[i].dram_joules;
+    }
+    for (i = 0; i < p->nstacks; i++)
+    {
+        st = &p->stacks[i];
+        if (total > 0)
+        {
+            weight = (unsigned long long)((st->pkg_joules + st->dram_joules) * 1e6 + 0.5);
+        }
+        else
+        {
+            weight = st->samples;
+        }
+        if (weight == 0)
+        {
+            continue;
+        }
+        for (d = st->depth; d > 0; d--)
+        {
+            profile_symbolize(p, st->ips[d - 1], name, sizeof(name));
+            fprintf(collapsed, "%s%s", name, d > 1 ? ";" : "");
+        }
+        fprintf(collapsed, " %llu\n", weight);
+    }
+    return 0;
+}
+
+int profile_write(struct profile *p, FILE *table, FILE *collapsed)
+{
+    if (table != NULL && profile_write_table(p, table))
+    {
+        return -1;
+    }
+    if (collapsed != NULL && profile_write_collapsed(p, collapsed))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static long perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu,
+                            int group_fd, unsigned long flags)
+{
+    return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+static uint64_t profile_now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * (uint64_t)1000000000 + t.tv_nsec;
+}
+
+void profile_variorum_lock(void)
+{
+    pthread_mutex_lock(&profile_variorum_mutex);
+}
+
+void profile_variorum_unlock(void)
+{
+    pthread_mutex_unlock(&profile_variorum_mutex);
+}
+
+/// @brief Read the package and DRAM energy of the node, summed over
+/// sockets. Energy reading is turned off if the platform does not report
+/// it.
+///
+/// Only the energy counters are read where the platform supports it, so the
+/// counters of the application are not reprogrammed every interval, and the
+/// energy is accumulated across wraps of the 32-bit counters.
+static void sampler_read_energy(struct profile_sampler *s, double *pkg_joules,
+                                double *dram_joules)
+{
+    struct variorum_metric_vector metrics;
+    const struct variorum_metric *m;
+    int found = 0;
+    int ret = 0;
+    size_t i;
+
+    *pkg_joules = 0.0;
+    *dram_joules = 0.0;
+    if (!s->with_energy)
+    {
+        return;
+    }
+    variorum_metric_vector_init(&metrics);
+    profile_variorum_lock();
+    if (s->energy_only)
+    {
+        ret = variorum_get_energy_metrics(&metrics);
+        if (ret == VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED)
+        {
+            s->energy_only = 0;
+        }
+    }
+    if (!s->energy_only)
+    {
+        ret = variorum_get_metrics(&metrics);
+    }
+    profile_variorum_unlock();
+    if (ret == 0)
+    {
+        for (i = 0; i < metrics.count; i++)
+        {
+            m = &metrics.metrics[i];
+            if (m->domain != VARIORUM_DOMAIN_SOCKET)
+            {
+                continue;
+            }
+            if (strcmp(m->name, "energy_cpu_joules") == 0)
+            {
+                *pkg_joules += m->value;
+                found = 1;
+            }
+            else if (strcmp(m->name, "energy_mem_joules") == 0)
+            {
+                *dram_joules += m->value;
+                found = 1;
+            }
+        }
+    }
+    variorum_metric_vector_free(&metrics);
+    s->with_energy = found;
+}
+
+/// @brief Copy len bytes at offset off of a ring buffer, which may wrap.
+static void sampler_ring_copy(const unsigned char *data, uint64_t size,
+                              uint64_t off, void *dst, size_t len)
+{
+    size_t first = len;
+
+    if (off + len > size)
+    {
+        first = size - off;
+    }
+    memcpy(dst, data + off, first);
+    memcpy((unsigned char *)dst + first, data, len - first);
+}
+
+static void sampler_record(struct profile_sampler *s, int cpu,
+                           const struct perf_event_header *hdr)
+{
+    const uint64_t *u = (const uint64_t *)(hdr + 1);
+    size_t words = (hdr->size - sizeof(struct perf_event_header)) / sizeof(uint64_t);
+    uint64_t ips[PROFILE_STACK_MAX];
+    uint32_t depth = 0;
+    uint64_t nr, i;
+    int event;
+
+    switch (hdr->type)
+    {
+        case PERF_RECORD_SAMPLE:
+            // id, ip, then the callchain: nr and nr addresses, leaf first,
+            // mixed with PERF_CONTEXT_* markers.
+            if (words < 3)
+            {
+                return;
+            }
+            event = PROFILE_EVENT_CYCLES;
+            if (s->fd[cpu * PROFILE_NUM_EVENTS + PROFILE_EVENT_INSTRUCTIONS] >= 0 &&
+                u[0] == s->id[cpu * PROFILE_NUM_EVENTS + PROFILE_EVENT_INSTRUCTIONS])
+            {
+                event = PROFILE_EVENT_INSTRUCTIONS;
+            }
+            nr = u[2];
+            if (nr > words - 3)
+            {
+                nr = words - 3;
+            }
+            for (i = 0; i < nr && depth < PROFILE_STACK_MAX; i++)
+            {
+                if (u[3 + i] < PERF_CONTEXT_MAX)
+                {
+                    ips[depth++] = u[3 + i];
+                }
+            }
+            if (depth == 0)
+            {
+                ips[depth++] = u[1];
+            }
+            profile_add_sample(&s->prof, event, ips, depth);
+            break;
+        case PERF_RECORD_MMAP:
+            // pid and tid, addr, len, pgoff, then the file name.
+            if (words > 4 && ((const char *)(u + 4))[0] == '/')
+            {
+                profile_add_mapping(&s->prof, u[1], u[1] + u[2], u[3],
+                                    (const char *)(u + 4));
+            }
+            break;
+        case PERF_RECORD_LOST:
+            if (words >= 2)
+            {
+                s->prof.lost += u[1];
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/// @brief Process the records the kernel added to the ring buffer of a CPU.
+static void sampler_drain(struct profile_sampler *s, int cpu)
+{
+    long pagesize = sysconf(_SC_PAGESIZE);
+    struct perf_event_mmap_page *meta = (struct perf_event_mmap_page *)
+                                        s->ring[cpu];
+    const unsigned char *data = (const unsigned char *)s->ring[cpu] + pagesize;
+    uint64_t size = s->ring_size - pagesize;
+    uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+    uint64_t tail = meta->data_tail;
+    uint64_t buf[8192];
+    struct perf_event_header *hdr = (struct perf_event_header *)buf;
+
+    while (tail < head)
+    {
+        sampler_ring_copy(data, size, tail % size, hdr,
+                          sizeof(struct perf_event_header));
+        if (hdr->size < sizeof(struct perf_event_header))
+        {
+            tail = head;
+            break;
+        }
+        sampler_ring_copy(data, size, tail % size, buf, hdr->size);
+        sampler_record(s, cpu, hdr);
+        tail += hdr->size;
+    }
+    __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+}
+
+/// @brief Drain the samples of the last interval and attribute its energy
+/// to them.
+static void sampler_interval(struct profile_sampler *s)
+{
+    double pkg_joules, dram_joules;
+    uint64_t now;
+    int cpu;
+
+    for (cpu = 0; cpu < s->ncpus; cpu++)
+    {
+        if (s->ring[cpu] != NULL)
+        {
+            sampler_drain(s, cpu);
+        }
+    }
+    sampler_read_energy(s, &pkg_joules, &dram_joules);
+    now = profile_now_ns();
+    // The energy does not wrap, so a decrease only follows a reset.
+    profile_close_interval(&s->prof, (now - s->last_ns) / 1e9,
+                           pkg_joules > s->last_pkg_joules ? pkg_joules - s->last_pkg_joules : 0.0,
+                           dram_joules > s->last_dram_joules ? dram_joules - s->last_dram_joules : 0.0);
+    s->last_pkg_joules = pkg_joules;
+    s->last_dram_joules = dram_joules;
+    s->last_ns = now;
+}
+
+static void *sampler_thread(void *arg)
+{
+    struct profile_sampler *s = (struct profile_sampler *)arg;
+    struct mstimer timer;
+
+    init_msTimer(&timer, s->interval_ms);
+    while (__atomic_load_n(&s->running, __ATOMIC_ACQUIRE))
+    {
+        timer_sleep(&timer);
+        sampler_interval(s);
+    }
+    return NULL;
+}
+
+static void sampler_close(struct profile_sampler *s)
+{
+    int i;
+
+    for (i = 0; s->ring != NULL && i < s->ncpus; i++)
+    {
+        if (s->ring[i] != NULL)
+        {
+            munmap(s->ring[i], s->ring_size);
+        }
+    }
+    for (i = 0; s->fd != NULL && i < s->ncpus * PROFILE_NUM_EVENTS; i++)
+    {
+        if (s->fd[i] >= 0)
+        {
+            close(s->fd[i]);
+        }
+    }
+    free(s->ring);
+    free(s->id);
+    free(s->fd);
+    s->ring = NULL;
+    s->id = NULL;
+    s->fd = NULL;
+}
+
+/// @brief Open the events of one CPU and map their shared ring buffer.
+///
+/// @return 0 if successful, else -1 if the cycles event cannot be sampled
+/// on this CPU, e.g., because it is offline.
+static int sampler_open_cpu(struct profile_sampler *s, int cpu, pid_t pid,
+                            int use_timer, uint64_t period, int enable_on_exec)
+{
+    struct perf_event_attr attr;
+    int *fd = &s->fd[cpu * PROFILE_NUM_EVENTS];
+    uint64_t *id = &s->id[cpu * PROFILE_NUM_EVENTS];
+    void *ring;
+    int e;
+
+    for (e = 0; e < PROFILE_NUM_EVENTS; e++)
+    {
+        if (use_timer && e == PROFILE_EVENT_INSTRUCTIONS)
+        {
+            continue;
+        }
+        memset(&attr, 0, sizeof(struct perf_event_attr));
+        attr.size = sizeof(struct perf_event_attr);
+        if (use_timer)
+        {
+            attr.type = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_TASK_CLOCK;
+        }
+        else
+        {
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = e == PROFILE_EVENT_CYCLES ? PERF_COUNT_HW_CPU_CYCLES :
+                          PERF_COUNT_HW_INSTRUCTIONS;
+        }
+        attr.sample_period = period;
+        attr.sample_type = PERF_SAMPLE_IDENTIFIER | PERF_SAMPLE_IP |
+                           PERF_SAMPLE_CALLCHAIN;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.exclude_callchain_kernel = 1;
+        attr.inherit = 1;
+        // Executable mappings are reported once, with the cycles samples.
+        attr.mmap = e == PROFILE_EVENT_CYCLES;
+        attr.disabled = enable_on_exec;
+        attr.enable_on_exec = enable_on_exec;
+
+        fd[e] = (int)perf_event_open(&attr, pid, cpu, -1, PERF_FLAG_FD_CLOEXEC);
+        if (fd[e] < 0 || ioctl(fd[e], PERF_EVENT_IOC_ID, &id[e]))
+        {
+            // Without instructions samples, IPC is reported as 0.
+            if (e == PROFILE_EVENT_INSTRUCTIONS)
+            {
+                if (fd[e] >= 0)
+                {
+                    close(fd[e]);
+                    fd[e] = -1;
+                }
+                continue;
+            }
+            return -1;
+        }
+        if (e == PROFILE_EVENT_CYCLES)
+        {
+            ring = mmap(NULL, s->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd[e], 0);
+            if (ring == MAP_FAILED)
+            {
+                return -1;
+            }
+            s->ring[cpu] = ring;
+        }
+        else if (ioctl(fd[e], PERF_EVENT_IOC_SET_OUTPUT, fd[PROFILE_EVENT_CYCLES]))
+        {
+            close(fd[e]);
+            fd[e] = -1;
+        }
+    }
+    return 0;
+}
+
+int profile_sampler_start(struct profile_sampler *s, pid_t pid, int use_timer,
+                          uint64_t period, unsigned interval_ms,
+                          int enable_on_exec)
+{
+    int opened = 0;
+    int cpu, i;
+
+    memset(s, 0, sizeof(struct profile_sampler));
+    if (profile_init(&s->prof))
+    {
+        return -1;
+    }
+    s->ncpus = (int)sysconf(_SC_NPROCESSORS_CONF);
+    s->fd = (int *) malloc(s->ncpus * PROFILE_NUM_EVENTS * sizeof(int));
+    s->id = (uint64_t *) calloc(s->ncpus * PROFILE_NUM_EVENTS, sizeof(uint64_t));
+    s->ring = (void **) calloc(s->ncpus, sizeof(void *));
+    if (s->fd == NULL || s->id == NULL || s->ring == NULL)
+    {
+        free(s->fd);
+        s->fd = NULL;
+        sampler_close(s);
+        profile_free(&s->prof);
+        return -1;
+    }
+    for (i = 0; i < s->ncpus * PROFILE_NUM_EVENTS; i++)
+    {
+        s->fd[i] = -1;
+    }
+    s->ring_size = (1 + PROFILE_RING_PAGES) * sysconf(_SC_PAGESIZE);
+    s->interval_ms = interval_ms;
+
+    for (cpu = 0; cpu < s->ncpus; cpu++)
+    {
+        if (sampler_open_cpu(s, cpu, pid, use_timer, period, enable_on_exec) == 0)
+        {
+            opened++;
+            continue;
+        }
+        for (i = 0; i < PROFILE_NUM_EVENTS; i++)
+        {
+            if (s->fd[cpu * PROFILE_NUM_EVENTS + i] >= 0)
+            {
+                close(s->fd[cpu * PROFILE_NUM_EVENTS + i]);
+                s->fd[cpu * PROFILE_NUM_EVENTS + i] = -1;
+            }
+        }
+    }
+    if (opened == 0)
+    {
+        sampler_close(s);
+        profile_free(&s->prof);
+        return -1;
+    }
+
+    s->with_energy = 1;
+    s->energy_only = 1;
+    sampler_read_energy(s, &s->last_pkg_joules, &s->last_dram_joules);
+    s->last_ns = profile_now_ns();
+    __atomic_store_n(&s->running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&s->thread, NULL, sampler_thread, s))
+    {
+        __atomic_store_n(&s->running, 0, __ATOMIC_RELEASE);
+        sampler_close(s);
+        profile_free(&s->prof);
+        return -1;
+    }
+    return 0;
+}
+
+void profile_sampler_stop(struct profile_sampler *s)
+{
+    __atomic_store_n(&s->running, 0, __ATOMIC_RELEASE);
+    pthread_join(s->thread, NULL);
+    sampler_interval(s);
+    sampler_close(s);
+}
@@ -0,0 +1,306 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PROFILE_H_INCLUDE
+#define PROFILE_H_INCLUDE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+/// @brief Deepest call stack kept for a sample, leaf included.
+#define PROFILE_STACK_MAX 64
+
+/// @brief List of sample sources.
+enum profile_event_e
+{
+    /// @brief Core cycles, or task clock in timer mode. Energy and time are
+    /// attributed by these samples.
+    PROFILE_EVENT_CYCLES,
+    /// @brief Instructions retired, sampled with the same period as cycles.
+    PROFILE_EVENT_INSTRUCTIONS,
+    /// @brief Number of sample sources.
+    PROFILE_NUM_EVENTS
+};
+
+/// @brief Energy, time and samples attributed to one unique call stack.
+struct profile_stack
+{
+    /// @brief Instruction pointers, leaf first.
+    uint64_t ips[PROFILE_STACK_MAX];
+    /// @brief Number of valid entries in ips.
+    uint32_t depth;
+    /// @brief Cycles (or timer) samples over the run.
+    uint64_t samples;
+    /// @brief Instructions samples over the run.
+    uint64_t inst_samples;
+    /// @brief Cycles samples in the open interval.
+    uint64_t pending;
+    /// @brief Package energy attributed to this stack, in Joules.
+    double pkg_joules;
+    /// @brief DRAM energy attributed to this stack, in Joules.
+    double dram_joules;
+    /// @brief Wall time attributed to this stack, in seconds.
+    double seconds;
+};
+
+/// @brief Memory region of the profiled process backed by a file.
+struct profile_mapping
+{
+    /// @brief First address of the region.
+    uint64_t start;
+    /// @brief Address past the end of the region.
+    uint64_t end;
+    /// @brief Offset in the file of the first address.
+    uint64_t pgoff;
+    /// @brief Path of the file.
+    char *path;
+};
+
+/// @brief Symbols of a mapped ELF file, loaded on first use.
+struct profile_elf;
+
+/// @brief Energy profile of a process, built interval by interval.
+struct profile
+{
+    /// @brief Unique stacks, in the order they were first sampled.
+    struct profile_stack *stacks;
+    /// @brief Number of valid entries in stacks.
+    size_t nstacks;
+    /// @brief Number of allocated entries in stacks.
+    size_t capacity;
+    /// @brief Open addressing hash table of stacks, holding index + 1 or 0
+    /// for an empty slot.
+    size_t *slots;
+    /// @brief Number of slots, a power of two.
+    size_t nslots;
+    /// @brief Stacks that received cycles samples in the open interval.
+    size_t *touched;
+    /// @brief Number of valid entries in touched.
+    size_t ntouched;
+    /// @brief Cycles samples in the open interval.
+    uint64_t pending_total;
+    /// @brief File-backed regions, in the order they were mapped.
+    struct profile_mapping *mappings;
+    /// @brief Number of valid entries in mappings.
+    size_t nmappings;
+    /// @brief Symbol tables of the mapped files.
+    struct profile_elf *elves;
+    /// @brief Number of valid entries in elves.
+    size_t nelves;
+    /// @brief Package energy of intervals without samples, in Joules.
+    double idle_pkg_joules;
+    /// @brief DRAM energy of intervals without samples, in Joules.
+    double idle_dram_joules;
+    /// @brief Wall time of intervals without samples, in seconds.
+    double idle_seconds;
+    /// @brief Samples dropped by the kernel because a buffer was full.
+    uint64_t lost;
+};
+
+/// @brief perf_event sampler of a process with a background energy reader.
+struct profile_sampler
+{
+    /// @brief Profile the samples are attributed to.
+    struct profile prof;
+    /// @brief Number of CPUs sampled on.
+    int ncpus;
+    /// @brief perf_event file descriptors, PROFILE_NUM_EVENTS per CPU, or -1
+    /// if not opened.
+    int *fd;
+    /// @brief Kernel IDs of the events in fd, telling their samples apart.
+    uint64_t *id;
+    /// @brief Ring buffer of each CPU, shared by its events, or NULL if not
+    /// mapped.
+    void **ring;
+    /// @brief Size of each ring buffer, including its metadata page.
+    size_t ring_size;
+    /// @brief Interval between energy readings, in milliseconds.
+    unsigned interval_ms;
+    /// @brief Whether energy is read, cleared if no energy is reported.
+    int with_energy;
+    /// @brief Whether energy is read with variorum_get_energy_metrics(),
+    /// cleared if the platform does not implement it, so all metrics are
+    /// sampled instead.
+    int energy_only;
+    /// @brief Package energy at the last reading, in Joules.
+    double last_pkg_joules;
+    /// @brief DRAM energy at the last reading, in Joules.
+    double last_dram_joules;
+    /// @brief Time of the last reading, in nanoseconds of CLOCK_MONOTONIC.
+    uint64_t last_ns;
+    /// @brief Energy reader thread.
+    pthread_t thread;
+    /// @brief Cleared to stop the energy reader thread, accessed with
+    /// atomic loads and stores.
+    int running;
+};
+
+/// @brief Initialize an empty profile.
+///
+/// @param [out] p Profile, released with profile_free().
+///
+/// @return 0 if successful, else -1 if out of memory.
+int profile_init(
+    struct profile *p
+);
+
+/// @brief Release a profile.
+///
+/// @param [in,out] p Profile.
+void profile_free(
+    struct profile *p
+);
+
+/// @brief Record one sample in the open interval.
+///
+/// @param [in,out] p Profile.
+/// @param [in] event Sample source (enum profile_event_e).
+/// @param [in] ips Instruction pointers, leaf first.
+/// @param [in] depth Number of entries in ips, truncated to
+///        PROFILE_STACK_MAX.
+///
+/// @return 0 if successful, else -1 if out of memory.
+int profile_add_sample(
+    struct profile *p,
+    int event,
+    const uint64_t *ips,
+    uint32_t depth
+);
+
+/// @brief Close the open interval, attributing its energy and time to the
+/// stacks sampled in it in proportion to their cycles samples.
+///
+/// @param [in,out] p Profile.
+/// @param [in] seconds Length of the interval.
+/// @param [in] pkg_joules Package energy consumed in the interval.
+/// @param [in] dram_joules DRAM energy consumed in the interval.
+void profile_close_interval(
+    struct profile *p,
+    double seconds,
+    double pkg_joules,
+    double dram_joules
+);
+
+/// @brief Add a file-backed region of the profiled process.
+///
+/// Later regions take precedence over earlier ones they overlap.
+///
+/// @param [in,out] p Profile.
+/// @param [in] start First address of the region.
+/// @param [in] end Address past the end of the region.
+/// @param [in] pgoff Offset in the file of the first address.
+/// @param [in] path Path of the file.
+///
+/// @return 0 if successful, else -1 if out of memory.
+int profile_add_mapping(
+    struct profile *p,
+    uint64_t start,
+    uint64_t end,
+    uint64_t pgoff,
+    const char *path
+);
+
+/// @brief Add the file-backed regions listed in a maps file, e.g.,
+/// /proc/self/maps.
+///
+/// @param [in,out] p Profile.
+/// @param [in] maps_path Path of the maps file.
+///
+/// @return 0 if successful, else -1 if the file cannot be read.
+int profile_load_maps(
+    struct profile *p,
+    const char *maps_path
+);
+
+/// @brief Resolve an instruction pointer to the function containing it,
+/// using the ELF symbol tables of the mapped files.
+///
+/// Addresses without a symbol resolve to the file name and offset, e.g.,
+/// libfoo.so+0x1234, and addresses outside any mapping to [unknown].
+///
+/// @param [in,out] p Profile, caching the symbol tables it loads.
+/// @param [in] ip Instruction pointer.
+/// @param [out] buf Function name.
+/// @param [in] len Size of buf.
+void profile_symbolize(
+    struct profile *p,
+    uint64_t ip,
+    char *buf,
+    size_t len
+);
+
+/// @brief Write the per-function table and the collapsed stacks of a
+/// profile.
+///
+/// The table has one row per leaf function, sorted by energy, with its
+/// samples, wall time, package and DRAM energy, and instructions per cycle
+/// (0 without instructions samples). Collapsed stacks list the functions of
+/// each stack from the root, separated by semicolons, followed by its energy
+/// in microjoules, the input format of flamegraph.pl.
+///
+/// @param [in,out] p Profile, caching the symbol tables it loads.
+/// @param [in] table Output of the table, or NULL.
+/// @param [in] collapsed Output of the collapsed stacks, or NULL.
+///
+/// @return 0 if successful, else -1 if out of memory.
+int profile_write(
+    struct profile *p,
+    FILE *table,
+    FILE *collapsed
+);
+
+/// @brief Take the lock held around every call into libvariorum made by the
+/// profiler and the PMPI library.
+///
+/// libvariorum is not thread-safe: its platform state and MSR batches are
+/// shared by all threads of a process. The energy reader thread of the
+/// sampler takes this lock, so other threads of the same tool must take it
+/// too before calling into libvariorum.
+void profile_variorum_lock(void);
+
+/// @brief Release the lock taken with profile_variorum_lock().
+void profile_variorum_unlock(void);
+
+/// @brief Start sampling a process and reading energy in the background.
+///
+/// Samples are taken in user space only, with frame pointer call stacks,
+/// from the process and the threads and children it creates afterwards.
+/// Events that follow children cannot share a ring buffer across CPUs, so
+/// one is opened per online CPU.
+///
+/// @param [out] s Sampler, stopped with profile_sampler_stop().
+/// @param [in] pid Process to sample, 0 for the calling process.
+/// @param [in] use_timer Sample on task clock instead of cycles; no
+///        instructions are sampled.
+/// @param [in] period Sampling period in cycles, or in nanoseconds with
+///        use_timer.
+/// @param [in] interval_ms Interval between energy readings.
+/// @param [in] enable_on_exec Start counting when pid calls exec().
+///
+/// Energy is read with libvariorum under profile_variorum_lock(). When pid
+/// is the calling process, the application must not call libvariorum
+/// itself while it is sampled.
+///
+/// @return 0 if successful, else -1 if perf_event_open() or mmap() fails.
+int profile_sampler_start(
+    struct profile_sampler *s,
+    pid_t pid,
+    int use_timer,
+    uint64_t period,
+    unsigned interval_ms,
+    int enable_on_exec
+);
+
+/// @brief Stop the energy reader, drain the last samples and close the
+/// sampling events. The profile stays valid until profile_free().
+///
+/// @param [in,out] s Sampler.
+void profile_sampler_stop(
+    struct profile_sampler *s
+);
+
+#endif
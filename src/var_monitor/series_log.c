@@ -0,0 +1,775 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#define _GNU_SOURCE
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "series_log.h"
+
+// Kinds of the fields of a trace line.
+#define FIELD_TEXT 'T'
+#define FIELD_TIME 't'
+#define FIELD_FIXED 'i'
+#define FIELD_DOUBLE 'f'
+
+// Largest number of digits of a number stored as a scaled integer.
+#define MAX_DIGITS 18
+
+/// @brief Layout of the lines of a text trace, kept in the metadata of its
+/// series to write the trace back as it was.
+struct layout
+{
+    char *header;
+    char delim;
+    int trailing;
+    size_t nfields;
+    char *kinds;
+    int *decimals;
+    char **text;
+    size_t time_field;
+};
+
+struct series_log
+{
+    int fd;
+    struct variorum_series_writer *writer;
+    struct layout layout;
+    int have_header;
+    char *line;
+    size_t len;
+    size_t cap;
+    char **fields;
+    size_t cap_fields;
+    union variorum_series_value *values;
+    unsigned long lineno;
+    unsigned long lost;
+    int error;
+};
+
+static const int64_t pow10_table[MAX_DIGITS + 1] =
+{
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+    100000000LL, 1000000000LL, 10000000000LL, 100000000000LL,
+    1000000000000LL, 10000000000000LL, 100000000000000LL,
+    1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+    1000000000000000000LL
+};
+
+static void free_layout(struct layout *l)
+{
+    size_t i;
+
+    for (i = 0; l->text != NULL && i < l->nfields; i++)
+    {
+        free(l->text[i]);
+    }
+    free(l->text);
+    free(l->header);
+    free(l->kinds);
+    free(l->decimals);
+    memset(l, 0, sizeof(*l));
+}
+
+/// @brief Split a line into its fields, in place.
+///
+/// @return Number of fields, or -1 on error.
+static long split(struct series_log *log, char *line, char delim)
+{
+    char **fields;
+    size_t n = 0;
+    char *p = line;
+
+    for (;;)
+    {
+        if (delim == ' ')
+        {
+            while (*p == ' ' || *p == '\t')
+            {
+                p++;
+            }
+            if (*p == '\0')
+            {
+                break;
+            }
+        }
+        if (n == log->cap_fields)
+        {
+            log->cap_fields = log->cap_fields ? 2 * log->cap_fields : 64;
+            fields = (char **) realloc(log->fields, log->cap_fields * sizeof(char *));
+            if (fields == NULL)
+            {
+                return -1;
+            }
+            log->fields = fields;
+        }
+        log->fields[n++] = p;
+        while (*p != '\0' && (delim == ' ' ? *p != ' ' && *p != '\t' : *p != delim))
+        {
+            p++;
+        }
+        if (*p == '\0')
+        {
+            break;
+        }
+        *p++ = '\0';
+    }
+    return (long)n;
+}
+
+/// @brief Parse a number written as -?[0-9]+(.[0-9]*)? into k and d, its
+/// value being k / 10^d.
+static int parse_fixed(const char *s, int64_t *k, int *d)
+{
+    int64_t v = 0;
+    int digits = 0;
+    int neg = 0;
+
+    *d = -1;
+    if (*s == '-')
+    {
+        neg = 1;
+        s++;
+    }
+    if (!isdigit((unsigned char)*s))
+    {
+        return -1;
+    }
+    for (; *s != '\0'; s++)
+    {
+        if (*s == '.' && *d < 0)
+        {
+            *d = 0;
+            continue;
+        }
+        if (!isdigit((unsigned char)*s) || ++digits > MAX_DIGITS)
+        {
+            return -1;
+        }
+        v = v * 10 + (*s - '0');
+        if (*d >= 0)
+        {
+            (*d)++;
+        }
+    }
+    if (*d < 0)
+    {
+        *d = 0;
+    }
+    *k = neg ? -v : v;
+    return 0;
+}
+
+/// @brief Parse a number into a scaled integer with d decimals.
+static int parse_scaled(const char *s, int d, int64_t *k)
+{
+    int64_t v;
+    int digits;
+
+    if (parse_fixed(s, &v, &digits) != 0 || digits > d ||
+        __builtin_mul_overflow(v, pow10_table[d - digits], k))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_double(const char *s, double *value)
+{
+    char *end;
+
+    *value = strtod(s, &end);
+    return end != s && *end == '\0' ? 0 : -1;
+}
+
+static void format_fixed(char *buf, size_t len, int64_t k, int d)
+{
+    uint64_t u = k < 0 ? -(uint64_t)k : (uint64_t)k;
+
+    if (d == 0)
+    {
+        snprintf(buf, len, "%s%lu", k < 0 ? "-" : "", (unsigned long)u);
+        return;
+    }
+    snprintf(buf, len, "%s%lu.%0*lu", k < 0 ? "-" : "",
+             (unsigned long)(u / pow10_table[d]), d,
+             (unsigned long)(u % pow10_table[d]));
+}
+
+/// @brief Shortest text that reads back as the same double.
+static void format_double(char *buf, size_t len, double value)
+{
+    double back;
+    int prec;
+
+    for (prec = 1; prec < 17; prec++)
+    {
+        snprintf(buf, len, "%.*g", prec, value);
+        back = strtod(buf, NULL);
+        if (memcmp(&back, &value, sizeof(double)) == 0)
+        {
+            return;
+        }
+    }
+    snprintf(buf, len, "%.17g", value);
+}
+
+/// @brief Serialize the layout into the metadata of the series.
+static char *layout_meta(const struct layout *l)
+{
+    char *meta;
+    char *p;
+    size_t len;
+    size_t i;
+
+    len = 64 + strlen(l->header);
+    for (i = 0; i < l->nfields; i++)
+    {
+        len += 8 + (l->text[i] != NULL ? 32 + strlen(l->text[i]) : 0);
+    }
+    meta = (char *) malloc(len);
+    if (meta == NULL)
+    {
+        return NULL;
+    }
+    p = meta + sprintf(meta, "delimiter=%s\ntrailing=%d\nfields=",
+                       l->delim == ',' ? "comma" : "space", l->trailing);
+    for (i = 0; i < l->nfields; i++)
+    {
+        p += sprintf(p, "%s%c", i ? "," : "", l->kinds[i]);
+        if (l->kinds[i] != FIELD_TEXT && l->kinds[i] != FIELD_DOUBLE)
+        {
+            p += sprintf(p, "%d", l->decimals[i]);
+        }
+    }
+    *p++ = '\n';
+    for (i = 0; i < l->nfields; i++)
+    {
+        if (l->text[i] != NULL)
+        {
+            p += sprintf(p, "text=%zu:%s\n", i, l->text[i]);
+        }
+    }
+    sprintf(p, "header=%s\n", l->header);
+    return meta;
+}
+
+/// @brief Read the layout back from the metadata of a series.
+static int parse_layout(const char *meta, struct layout *l)
+{
+    const char *p;
+    const char *eol;
+    char *end;
+    size_t i;
+    size_t n;
+
+    memset(l, 0, sizeof(*l));
+    l->delim = ',';
+    for (p = meta; *p != '\0'; p = *eol ? eol + 1 : eol)
+    {
+        eol = strchr(p, '\n');
+        if (eol == NULL)
+        {
+            eol = p + strlen(p);
+        }
+        n = eol - p;
+        if (strncmp(p, "delimiter=space", n) == 0 && n == 15)
+        {
+            l->delim = ' ';
+        }
+        else if (strncmp(p, "trailing=", 9) == 0)
+        {
+            l->trailing = p[9] == '1';
+        }
+        else if (strncmp(p, "header=", 7) == 0)
+        {
+            l->header = strndup(p + 7, n - 7);
+        }
+        else if (strncmp(p, "fields=", 7) == 0 && l->kinds == NULL)
+        {
+            l->nfields = n > 7;
+            for (i = 7; i < n; i++)
+            {
+                l->nfields += p[i] == ',';
+            }
+            l->kinds = (char *) calloc(l->nfields + 1, 1);
+            l->decimals = (int *) calloc(l->nfields + 1, sizeof(int));
+            l->text = (char **) calloc(l->nfields + 1, sizeof(char *));
+            if (l->kinds == NULL || l->decimals == NULL || l->text == NULL)
+            {
+                return -1;
+            }
+            for (i = 0, end = (char *)p + 7; i < l->nfields; i++)
+            {
+                l->kinds[i] = *end;
+                l->decimals[i] = (int)strtol(end + 1, &end, 10);
+                if (l->kinds[i] == FIELD_TIME)
+                {
+                    l->time_field = i;
+                }
+                if (*end == ',')
+                {
+                    end++;
+                }
+            }
+        }
+        else if (strncmp(p, "text=", 5) == 0)
+        {
+            i = strtoul(p + 5, &end, 10);
+            if (*end == ':' && i < l->nfields && end < eol)
+            {
+                l->text[i] = strndup(end + 1, eol - end - 1);
+            }
+        }
+    }
+    if (l->header == NULL)
+    {
+        l->header = strdup("");
+    }
+    return l->header != NULL ? 0 : -1;
+}
+
+/// @brief Start the series from the first sample: its numbers set the kind
+/// and decimals of the fields.
+static int start_series(struct series_log *log, long n)
+{
+    struct layout *l = &log->layout;
+    struct variorum_series_column *columns;
+    char *names = NULL;
+    char **header = NULL;
+    char **row = log->fields;
+    size_t cap_row = log->cap_fields;
+    char *meta;
+    double f;
+    long nheader = 0;
+    long i;
+    uint32_t c = 0;
+    int64_t k;
+    int rc;
+
+    l->nfields = n;
+    l->kinds = (char *) calloc(n + 1, 1);
+    l->decimals = (int *) calloc(n + 1, sizeof(int));
+    l->text = (char **) calloc(n + 1, sizeof(char *));
+    columns = (struct variorum_series_column *) calloc(n + 1,
+              sizeof(struct variorum_series_column));
+    log->values = (union variorum_series_value *) calloc(n + 1,
+                  sizeof(union variorum_series_value));
+    if (l->kinds == NULL || l->decimals == NULL || l->text == NULL ||
+        columns == NULL || log->values == NULL)
+    {
+        free(columns);
+        return -1;
+    }
+    l->time_field = n;
+    for (i = 0; i < n; i++)
+    {
+        if (parse_fixed(log->fields[i], &k, &l->decimals[i]) == 0)
+        {
+            l->kinds[i] = l->time_field == (size_t)n ? FIELD_TIME : FIELD_FIXED;
+            if (l->kinds[i] == FIELD_TIME)
+            {
+                l->time_field = i;
+            }
+        }
+        else if (parse_double(log->fields[i], &f) == 0)
+        {
+            l->kinds[i] = FIELD_DOUBLE;
+            l->decimals[i] = VARIORUM_SERIES_DOUBLE;
+        }
+        else
+        {
+            l->kinds[i] = FIELD_TEXT;
+            l->text[i] = strdup(log->fields[i]);
+            if (l->text[i] == NULL)
+            {
+                free(columns);
+                return -1;
+            }
+        }
+    }
+
+    // Column names from the header, if it has a name for every field.
+    if (l->header != NULL)
+    {
+        names = strdup(l->header);
+        if (names != NULL)
+        {
+            log->fields = NULL;
+            log->cap_fields = 0;
+            nheader = split(log, names, l->delim);
+            if (l->trailing && nheader > 0)
+            {
+                nheader--;
+            }
+            header = log->fields;
+            log->fields = row;
+            log->cap_fields = cap_row;
+        }
+    }
+    for (i = 0; i < n; i++)
+    {
+        if (l->kinds[i] == FIELD_FIXED || l->kinds[i] == FIELD_DOUBLE)
+        {
+            columns[c].name = nheader == n ? header[i] : "";
+            columns[c].decimals = l->decimals[i];
+            c++;
+        }
+    }
+    if (l->header == NULL)
+    {
+        l->header = strdup("");
+    }
+    meta = l->header != NULL ? layout_meta(l) : NULL;
+    rc = meta != NULL && l->time_field < (size_t)n ?
+         variorum_series_create(log->fd, nheader == n ? header[l->time_field] : "time",
+                                columns, c, meta, &log->writer) : -1;
+    if (rc == 0)
+    {
+        log->fd = -1;
+    }
+    free(meta);
+    free(names);
+    free(header);
+    free(columns);
+    return rc == 0 ? 0 : -1;
+}
+
+/// @brief Store one line of the trace.
+static void feed(struct series_log *log, char *line)
+{
+    struct layout *l = &log->layout;
+    size_t len = strlen(line);
+    uint32_t c = 0;
+    int64_t time = 0;
+    long n;
+    long i;
+
+    log->lineno++;
+    if (len > 0 && line[len - 1] == '\r')
+    {
+        line[--len] = '\0';
+    }
+    if (log->error || len == 0)
+    {
+        return;
+    }
+    if (!log->have_header)
+    {
+        log->have_header = 1;
+        l->header = strdup(line);
+        l->delim = strchr(line, ',') != NULL ? ',' : ' ';
+        l->trailing = l->delim == ',' && line[len - 1] == ',';
+        if (l->header == NULL)
+        {
+            log->error = 1;
+        }
+        return;
+    }
+
+    n = split(log, line, l->delim);
+    if (n > 0 && l->trailing && log->fields[n - 1][0] == '\0')
+    {
+        n--;
+    }
+    if (n <= 0)
+    {
+        return;
+    }
+    if (log->writer == NULL && start_series(log, n) != 0)
+    {
+        log->error = 1;
+        return;
+    }
+    if (n != (long)l->nfields)
+    {
+        log->lost++;
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        switch (l->kinds[i])
+        {
+            case FIELD_TEXT:
+                if (strcmp(log->fields[i], l->text[i]) != 0)
+                {
+                    log->lost++;
+                    return;
+                }
+                break;
+            case FIELD_TIME:
+                if (parse_scaled(log->fields[i], l->decimals[i], &time) != 0)
+                {
+                    log->lost++;
+                    return;
+                }
+                break;
+            case FIELD_FIXED:
+                if (parse_scaled(log->fields[i], l->decimals[i],
+                                 &log->values[c++].i) != 0)
+                {
+                    log->lost++;
+                    return;
+                }
+                break;
+            default:
+                if (parse_double(log->fields[i], &log->values[c++].f) != 0)
+                {
+                    log->lost++;
+                    return;
+                }
+                break;
+        }
+    }
+    if (variorum_series_append(log->writer, time, log->values) != 0)
+    {
+        log->lost++;
+    }
+}
+
+static struct series_log *log_create(int fd)
+{
+    struct series_log *log;
+
+    log = (struct series_log *) calloc(1, sizeof(struct series_log));
+    if (log != NULL)
+    {
+        log->fd = fd;
+    }
+    return log;
+}
+
+/// @brief Store the last line, close the series and release the log.
+static int log_close(struct series_log *log, unsigned long *lost)
+{
+    int rc = 0;
+
+    if (log->len > 0)
+    {
+        log->line[log->len] = '\0';
+        feed(log, log->line);
+    }
+    if (log->writer == NULL && !log->error)
+    {
+        // A trace without samples keeps its header only.
+        if (log->layout.header == NULL)
+        {
+            log->layout.header = strdup("");
+        }
+        log->layout.text = (char **) calloc(1, sizeof(char *));
+        char *meta = log->layout.header != NULL && log->layout.text != NULL ?
+                     layout_meta(&log->layout) : NULL;
+        rc = meta != NULL ? variorum_series_create(log->fd, "time", NULL, 0, meta,
+                &log->writer) : -1;
+        if (rc == 0)
+        {
+            log->fd = -1;
+        }
+        free(meta);
+    }
+    if (log->writer != NULL && variorum_series_close(log->writer) != 0)
+    {
+        rc = -1;
+    }
+    if (log->fd >= 0)
+    {
+        close(log->fd);
+    }
+    if (lost != NULL)
+    {
+        *lost = log->lost;
+    }
+    rc = rc != 0 || log->error ? -1 : 0;
+    free_layout(&log->layout);
+    free(log->line);
+    free(log->fields);
+    free(log->values);
+    free(log);
+    return rc;
+}
+
+static ssize_t cookie_write(void *cookie, const char *buf, size_t size)
+{
+    struct series_log *log = (struct series_log *)cookie;
+    const char *p = buf;
+    const char *eol;
+    char *line;
+    size_t n;
+
+    while ((size_t)(p - buf) < size)
+    {
+        eol = memchr(p, '\n', size - (p - buf));
+        n = eol != NULL ? (size_t)(eol - p) : size - (p - buf);
+        if (log->len + n + 1 > log->cap)
+        {
+            log->cap = 2 * (log->len + n + 1);
+            line = (char *) realloc(log->line, log->cap);
+            if (line == NULL)
+            {
+                log->error = 1;
+                return -1;
+            }
+            log->line = line;
+        }
+        memcpy(log->line + log->len, p, n);
+        log->len += n;
+        if (eol == NULL)
+        {
+            break;
+        }
+        log->line[log->len] = '\0';
+        feed(log, log->line);
+        log->len = 0;
+        p = eol + 1;
+    }
+    return size;
+}
+
+static int cookie_close(void *cookie)
+{
+    struct series_log *log = (struct series_log *)cookie;
+    unsigned long lost;
+    int rc;
+
+    rc = log_close(log, &lost);
+    if (lost > 0)
+    {
+        fprintf(stderr, "Warning: %lu lines of the trace could not be "
+                "compressed exactly and were dropped.\n", lost);
+    }
+    return rc;
+}
+
+FILE *series_log_fdopen(int fd)
+{
+    cookie_io_functions_t io = {NULL, cookie_write, NULL, cookie_close};
+    struct series_log *log;
+    FILE *f;
+
+    log = log_create(fd);
+    if (log == NULL)
+    {
+        return NULL;
+    }
+    f = fopencookie(log, "w", io);
+    if (f == NULL)
+    {
+        free(log);
+    }
+    return f;
+}
+
+int series_log_compress(FILE *in, int fd, unsigned long *lines)
+{
+    struct series_log *log;
+    char *line = NULL;
+    size_t cap = 0;
+    ssize_t n;
+
+    log = log_create(fd);
+    if (log == NULL)
+    {
+        close(fd);
+        return -1;
+    }
+    while ((n = getline(&line, &cap, in)) > 0)
+    {
+        if (line[n - 1] == '\n')
+        {
+            line[n - 1] = '\0';
+        }
+        feed(log, line);
+    }
+    free(line);
+    return log_close(log, lines);
+}
+
+int series_log_parse_time(const struct variorum_series_reader *reader,
+                          const char *text, int64_t *time)
+{
+    struct layout l;
+    int rc = -1;
+
+    if (parse_layout(variorum_series_meta(reader), &l) == 0 && l.kinds != NULL &&
+        l.kinds[l.time_field] == FIELD_TIME)
+    {
+        rc = parse_scaled(text, l.decimals[l.time_field], time);
+    }
+    free_layout(&l);
+    return rc;
+}
+
+struct extract
+{
+    struct layout *layout;
+    FILE *out;
+};
+
+static int write_line(int64_t time, const union variorum_series_value *values,
+                      void *arg)
+{
+    struct extract *e = (struct extract *)arg;
+    struct layout *l = e->layout;
+    char buf[64];
+    uint32_t c = 0;
+    size_t i;
+
+    for (i = 0; i < l->nfields; i++)
+    {
+        if (i > 0)
+        {
+            fputc(l->delim, e->out);
+        }
+        switch (l->kinds[i])
+        {
+            case FIELD_TEXT:
+                fputs(l->text[i] != NULL ? l->text[i] : "", e->out);
+                continue;
+            case FIELD_TIME:
+                format_fixed(buf, sizeof(buf), time, l->decimals[i]);
+                break;
+            case FIELD_FIXED:
+                format_fixed(buf, sizeof(buf), values[c++].i, l->decimals[i]);
+                break;
+            default:
+                format_double(buf, sizeof(buf), values[c++].f);
+                break;
+        }
+        fputs(buf, e->out);
+    }
+    if (l->trailing)
+    {
+        fputc(l->delim, e->out);
+    }
+    fputc('\n', e->out);
+    return ferror(e->out);
+}
+
+int series_log_extract(struct variorum_series_reader *reader, int64_t from,
+                       int64_t to, int header, FILE *out)
+{
+    struct layout l;
+    struct extract e;
+    int rc = -1;
+
+    if (parse_layout(variorum_series_meta(reader), &l) == 0)
+    {
+        if (header && l.header[0] != '\0')
+        {
+            fprintf(out, "%s\n", l.header);
+        }
+        e.layout = &l;
+        e.out = out;
+        rc = l.nfields == 0 ? 0 :
+             variorum_series_read(reader, from, to, write_line, &e);
+    }
+    free_layout(&l);
+    return rc == 0 && !ferror(out) ? 0 : -1;
+}
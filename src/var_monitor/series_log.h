@@ -0,0 +1,76 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef SERIES_LOG_H
+#define SERIES_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <variorum_series.h>
+
+/// @brief Suffix of compressed traces.
+#define SERIES_LOG_SUFFIX ".vts"
+
+/// @brief Open a stream that compresses the text trace written to it.
+///
+/// The first line of the trace is its header, and every other line a sample
+/// of comma- or space-delimited fields, as written by var_monitor and the
+/// power wrappers. The first numeric field is the time, fields that are not
+/// numbers must not change, and every number is stored exactly as written.
+/// The series is complete once the stream is closed with fclose().
+///
+/// @param [in] fd File descriptor open for writing, owned by the stream.
+///
+/// @return Stream, or NULL on error.
+FILE *series_log_fdopen(
+    int fd
+);
+
+/// @brief Compress a text trace.
+///
+/// @param [in] in Text trace.
+/// @param [in] fd File descriptor of the series, closed on return.
+/// @param [out] lines Number of lines that could not be stored.
+///
+/// @return 0 if successful, else -1.
+int series_log_compress(
+    FILE *in,
+    int fd,
+    unsigned long *lines
+);
+
+/// @brief Convert a time written as in the trace to series time.
+///
+/// @param [in] reader Series.
+/// @param [in] text Time, e.g., 1700000000123456.
+/// @param [out] time Series time.
+///
+/// @return 0 if successful, else -1.
+int series_log_parse_time(
+    const struct variorum_series_reader *reader,
+    const char *text,
+    int64_t *time
+);
+
+/// @brief Write the samples of a series with from <= time <= to as the text
+/// trace they were compressed from.
+///
+/// @param [in,out] reader Series.
+/// @param [in] from First time.
+/// @param [in] to Last time.
+/// @param [in] header Also write the header line.
+/// @param [in] out Output.
+///
+/// @return 0 if successful, else -1.
+int series_log_extract(
+    struct variorum_series_reader *reader,
+    int64_t from,
+    int64_t to,
+    int header,
+    FILE *out
+);
+
+#endif
@@ -9,6 +9,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,7 +20,9 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include "flight_recorder.h"
 #include "highlander.h"
+#include "series_log.h"
 
 #define FASTEST_SAMPLE_INTERVAL_MS 50
 
@@ -52,6 +55,12 @@ static int running = 1;
 
 #include "common.c"
 
+static void flight_signal(int sig)
+{
+    (void)sig;
+    flight_recorder_trigger();
+}
+
 int main(int argc, char **argv)
 {
     const char *usage = "\n"
@@ -74,7 +83,7 @@ int main(int argc, char **argv)
                         "        Display this help information, then exit.\n"
                         "\n"
                         "    -c\n"
-                        "        Remove stale shared memory.\n"
+                        "        Remove named semaphores left behind by older versions.\n"
                         "\n"
                         "    -p path_to_trace\n"
                         "        Path to store application trace.\n"
@@ -87,6 +96,34 @@ int main(int argc, char **argv)
                         "\n"
                         "    -u\n"
                         "        Sampling and printing node utilization \n"
+                        "\n"
+                        "    -f\n"
+                        "        If another var_monitor already samples this node, record its\n"
+                        "        samples in hostname.pid.var_monitor.dat instead of only\n"
+                        "        running the application.\n"
+                        "\n"
+                        "    -z\n"
+                        "        Write the trace compressed, to hostname.var_monitor.vts instead\n"
+                        "        of hostname.var_monitor.dat. Use var_monitor_series to read it.\n"
+                        "\n"
+                        "    -r hz\n"
+                        "        Also sample package power, power limits and thermal status at hz\n"
+                        "        (e.g., 2000) into an in-memory flight recorder, and write the\n"
+                        "        samples around every trigger to hostname.flight.N.dat. Triggers\n"
+                        "        are PROCHOT or thermal status on a socket, a power limit change,\n"
+                        "        the power above -t, and SIGUSR1. Intel only.\n"
+                        "\n"
+                        "    -t watts\n"
+                        "        Package power of all sockets that triggers the flight recorder.\n"
+                        "\n"
+                        "    -H before:after\n"
+                        "        Seconds of samples the flight recorder keeps before and records\n"
+                        "        after a trigger (default = 2:1).\n"
+                        "\n"
+                        "NOTES\n"
+                        "    Only one var_monitor per node samples the node. It keeps sampling\n"
+                        "    until the applications of all other var_monitors of the node have\n"
+                        "    finished.\n"
                         "\n";
 
     if (argc == 1 || (argc > 1 && (
@@ -101,6 +138,12 @@ int main(int argc, char **argv)
     char *app;
     char **arg = NULL;
     int set_app = 0;
+    int follow_leader = 0;
+    const char *suffix = ".dat";
+    double flight_hz = 0.0;
+    double flight_watts = 0.0;
+    double flight_before = 2.0;
+    double flight_after = 1.0;
     char *logpath = NULL;
     // Default struct with sampling interval of 50ms and verbosity of 0.
     struct thread_args th_args;
@@ -108,7 +151,7 @@ int main(int argc, char **argv)
     th_args.measure_all = false;
     th_args.power_with_util = false;
 
-    while ((opt = getopt(argc, argv, "ca:p:i:v:u")) != -1)
+    while ((opt = getopt(argc, argv, "ca:p:i:v:ufzr:t:H:")) != -1)
     {
         switch (opt)
         {
@@ -138,8 +181,29 @@ int main(int argc, char **argv)
             case 'u':
                 th_args.power_with_util = true;
                 break;
+            case 'f':
+                follow_leader = 1;
+                break;
+            case 'z':
+                suffix = SERIES_LOG_SUFFIX;
+                break;
+            case 'r':
+                flight_hz = atof(optarg);
+                break;
+            case 't':
+                flight_watts = atof(optarg);
+                break;
+            case 'H':
+                if (sscanf(optarg, "%lf:%lf", &flight_before, &flight_after) < 1 ||
+                    flight_before < 0.0 || flight_after < 0.0)
+                {
+                    fprintf(stderr, "\nError: invalid flight recorder window \"%s\"\n",
+                            optarg);
+                    return 1;
+                }
+                break;
             case '?':
-                if (optopt == 'a')
+                if (optopt == 'a' || optopt == 'r' || optopt == 't' || optopt == 'H')
                 {
                     fprintf(stderr, "Option -%c requires an argument.\n", optopt);
                 }
@@ -205,7 +269,8 @@ int main(int argc, char **argv)
         if (logpath)
         {
             /* Output trace data into the specified location. */
-            rc = asprintf(&fname_dat, "%s/%s.var_monitor.dat", logpath, hostname);
+            rc = asprintf(&fname_dat, "%s/%s.var_monitor%s", logpath, hostname,
+                          suffix);
             if (rc == -1)
             {
                 fprintf(stderr,
@@ -229,7 +294,7 @@ int main(int argc, char **argv)
         else
         {
             /* Output trace data into the default location. */
-            rc = asprintf(&fname_dat, "%s.var_monitor.dat", hostname);
+            rc = asprintf(&fname_dat, "%s.var_monitor%s", hostname, suffix);
             if (rc == -1)
             {
                 fprintf(stderr,
@@ -260,7 +325,7 @@ int main(int argc, char **argv)
                     hostname, fname_dat, strerror(errno));
             return 1;
         }
-        logfile = fdopen(logfd, "w");
+        logfile = open_trace(logfd, suffix);
         if (logfile == NULL)
         {
             fprintf(stderr, "Fatal Error: %s on %s fdopen failed for %s -- %s.\n", argv[0],
@@ -301,6 +366,9 @@ int main(int argc, char **argv)
             printf("Trace and summary files will be dumped in ./\n");
         }
 
+        /* Publish the samples to the other var_monitors of the node. */
+        stream_open();
+
         /* Start power measurement thread. */
         pthread_attr_t mattr;
         pthread_t mthread;
@@ -309,6 +377,34 @@ int main(int argc, char **argv)
         pthread_mutex_init(&mlock, NULL);
         pthread_create(&mthread, &mattr, power_measurement, (void *) &th_args);
 
+        /* Start the flight recorder, triggered by hand with SIGUSR1. */
+        if (flight_hz > 0.0)
+        {
+            char *prefix = NULL;
+
+            if (logpath)
+            {
+                rc = asprintf(&prefix, "%s/%s", logpath, hostname);
+            }
+            else
+            {
+                rc = asprintf(&prefix, "%s", hostname);
+            }
+            if (rc != -1 && flight_recorder_start(prefix, flight_hz, flight_before,
+                                                  flight_after, flight_watts) == 0)
+            {
+                struct sigaction sa;
+
+                memset(&sa, 0, sizeof(sa));
+                sa.sa_handler = flight_signal;
+                sigemptyset(&sa.sa_mask);
+                sigaction(SIGUSR1, &sa, NULL);
+                printf("Flight recorder sampling at %0.0lf Hz, kill -USR1 %d to "
+                       "trigger.\n", flight_hz, getpid());
+            }
+            free(prefix);
+        }
+
         /* Fork. */
         pid_t app_pid = fork();
         if (app_pid == 0)
@@ -331,11 +427,28 @@ int main(int argc, char **argv)
 
         highlander_wait();
 
+        if (flight_hz > 0.0)
+        {
+            signal(SIGUSR1, SIG_IGN);
+            flight_recorder_stop();
+        }
+
         /* Stop power measurement thread. */
         running = 0;
         take_measurement(th_args.measure_all, th_args.power_with_util);
         end = now_ms();
 
+        /* The detached thread may still be sampling, so close the trace
+         * under the lock; a compressed trace is only complete once closed. */
+        pthread_mutex_lock(&mlock);
+        stream_close();
+        fclose(logfile);
+        logfile = NULL;
+        pthread_mutex_unlock(&mlock);
+
+        /* The stream is closed, so the next highlander can publish. */
+        highlander_leave();
+
         if (logpath)
         {
             /* Output summary data into the specified location. */
@@ -401,6 +514,50 @@ int main(int argc, char **argv)
     }
     else
     {
+        char hostname[64];
+        gethostname(hostname, 64);
+
+        if (follow_leader)
+        {
+            /* Record the samples of the highlander into our own trace. */
+            int logfd;
+
+            if (logpath)
+            {
+                rc = asprintf(&fname_dat, "%s/%s.%d.var_monitor%s", logpath,
+                              hostname, getpid(), suffix);
+            }
+            else
+            {
+                rc = asprintf(&fname_dat, "%s.%d.var_monitor%s", hostname,
+                              getpid(), suffix);
+            }
+            if (rc == -1)
+            {
+                fprintf(stderr,
+                        "%s:%d asprintf failed, perhaps out of memory.\n",
+                        __FILE__, __LINE__);
+                return 1;
+            }
+
+            logfd = open(fname_dat, O_WRONLY | O_CREAT | O_EXCL | O_NOATIME | O_NDELAY,
+                         S_IRUSR | S_IWUSR);
+            if (logfd < 0)
+            {
+                fprintf(stderr,
+                        "Fatal Error: %s on %s cannot open the appropriate fd for %s -- %s.\n", argv[0],
+                        hostname, fname_dat, strerror(errno));
+                return 1;
+            }
+            logfile = open_trace(logfd, suffix);
+            if (logfile == NULL)
+            {
+                fprintf(stderr, "Fatal Error: %s on %s fdopen failed for %s -- %s.\n", argv[0],
+                        hostname, fname_dat, strerror(errno));
+                return 1;
+            }
+        }
+
         /* Fork. */
         pid_t app_pid = fork();
         if (app_pid == 0)
@@ -411,9 +568,28 @@ int main(int argc, char **argv)
             return 1;
         }
         /* Wait. */
-        waitpid(app_pid, NULL, 0);
+        if (logfile != NULL)
+        {
+            while (waitpid(app_pid, NULL, WNOHANG) == 0)
+            {
+                follow_measurement();
+                usleep(th_args.sample_interval * 1000);
+            }
+            follow_measurement();
+            follow_close();
+            fclose(logfile);
+
+            printf("Output Files:\n"
+                   "  %s\n\n", fname_dat);
+        }
+        else
+        {
+            waitpid(app_pid, NULL, 0);
+        }
 
         highlander_wait();
+        free(fname_dat);
+        return 0;
     }
 
     if (th_args.power_with_util == true)
@@ -430,7 +606,6 @@ int main(int argc, char **argv)
                "  %s\n\n", fname_dat, fname_summary);
     }
 
-    highlander_clean();
     free(fname_dat);
     free(fname_util);
     free(fname_summary);
@@ -0,0 +1,1028 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#define _GNU_SOURCE
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define DEFAULT_STEP_MS 100
+#define DEFAULT_OUTLIER_Z 3.5
+#define MAX_SOCKETS 16
+#define MAX_COLUMNS 256
+#define HOST_LEN 64
+
+#define TRACE_SUFFIX ".var_monitor.dat"
+#define SUMMARY_SUFFIX ".power.summary"
+
+enum column_kind
+{
+    COL_SKIP,
+    COL_HOST,
+    COL_TIME,
+    COL_NODE,
+    COL_CPU,
+    COL_MEM,
+    COL_GPU,
+};
+
+struct column
+{
+    int kind;
+    int index;
+};
+
+/// @brief Job-wide values of one point of the common time grid.
+struct grid_point
+{
+    double total_w;
+    double node_min_w;
+    double node_max_w;
+    double socket_sum_w;
+    double socket_min_w;
+    double socket_max_w;
+    /// @brief Sum over nodes of (max - min) / mean of their sockets.
+    double imbalance;
+    uint32_t nodes;
+    uint32_t sockets;
+    uint32_t imbalanced_nodes;
+};
+
+/// @brief Grid points from base on, growing in both directions.
+struct grid
+{
+    int64_t base;
+    size_t len;
+    struct grid_point *points;
+};
+
+/// @brief Result of one trace.
+struct node_result
+{
+    char host[HOST_LEN];
+    int error;
+    uint64_t samples;
+    int64_t start_us;
+    int64_t end_us;
+    double energy_j;
+    double max_w;
+    double imbalance_sum;
+    uint64_t imbalance_count;
+    double runtime_ms;
+    double z;
+};
+
+struct job
+{
+    char **paths;
+    size_t npaths;
+    struct node_result *results;
+    int64_t step_us;
+    size_t next;
+    pthread_mutex_t lock;
+};
+
+struct worker
+{
+    pthread_t thread;
+    struct job *job;
+    struct grid grid;
+};
+
+static double now_s(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static int ends_with(const char *s, const char *suffix)
+{
+    size_t n = strlen(s);
+    size_t m = strlen(suffix);
+
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+/// @brief Grid point of index i, allocating it if needed.
+static struct grid_point *grid_at(struct grid *g, int64_t i)
+{
+    struct grid_point *points;
+    int64_t base;
+    size_t len;
+    size_t k;
+
+    if (g->len == 0 || i < g->base || i >= g->base + (int64_t)g->len)
+    {
+        // Grow at least twofold towards the requested point.
+        if (g->len == 0)
+        {
+            base = i;
+            len = 1024;
+        }
+        else if (i < g->base)
+        {
+            base = i - (int64_t)g->len;
+            len = g->base + 2 * g->len - base;
+        }
+        else
+        {
+            base = g->base;
+            len = i + 1 + g->len - base;
+        }
+        points = (struct grid_point *) calloc(len, sizeof(struct grid_point));
+        if (points == NULL)
+        {
+            return NULL;
+        }
+        if (g->len != 0)
+        {
+            memcpy(points + (g->base - base), g->points,
+                   g->len * sizeof(struct grid_point));
+        }
+        for (k = 0; k < len; k++)
+        {
+            if (points[k].nodes == 0)
+            {
+                points[k].node_min_w = INFINITY;
+                points[k].socket_min_w = INFINITY;
+                points[k].node_max_w = -INFINITY;
+                points[k].socket_max_w = -INFINITY;
+            }
+        }
+        free(g->points);
+        g->points = points;
+        g->base = base;
+        g->len = len;
+    }
+    return &g->points[i - g->base];
+}
+
+static void grid_merge(struct grid *dst, const struct grid *src)
+{
+    const struct grid_point *s;
+    struct grid_point *d;
+    size_t k;
+
+    for (k = 0; k < src->len; k++)
+    {
+        s = &src->points[k];
+        if (s->nodes == 0)
+        {
+            continue;
+        }
+        d = grid_at(dst, src->base + (int64_t)k);
+        if (d == NULL)
+        {
+            return;
+        }
+        d->total_w += s->total_w;
+        d->socket_sum_w += s->socket_sum_w;
+        d->nodes += s->nodes;
+        d->sockets += s->sockets;
+        d->imbalance += s->imbalance;
+        d->imbalanced_nodes += s->imbalanced_nodes;
+        d->node_min_w = fmin(d->node_min_w, s->node_min_w);
+        d->node_max_w = fmax(d->node_max_w, s->node_max_w);
+        d->socket_min_w = fmin(d->socket_min_w, s->socket_min_w);
+        d->socket_max_w = fmax(d->socket_max_w, s->socket_max_w);
+    }
+}
+
+/// @brief Parse a number as written by var_monitor, e.g., 123.45, falling
+/// back to strtod() for other forms.
+static const char *parse_number(const char *p, const char *end, double *value)
+{
+    const char *start = p;
+    char buf[64];
+    double v = 0.0;
+    double scale = 1.0;
+    int neg = 0;
+    size_t n;
+
+    while (p < end && *p == ' ')
+    {
+        p++;
+    }
+    if (p < end && *p == '-')
+    {
+        neg = 1;
+        p++;
+    }
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        v = v * 10.0 + (*p++ - '0');
+    }
+    if (p < end && *p == '.')
+    {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            scale *= 0.1;
+            v += (*p++ - '0') * scale;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E' || *p == 'n' || *p == 'i'))
+    {
+        n = 0;
+        while (start + n < end && start[n] != ',' && start[n] != '\n' &&
+               n < sizeof(buf) - 1)
+        {
+            buf[n] = start[n];
+            n++;
+        }
+        buf[n] = '\0';
+        *value = strtod(buf, NULL);
+        return start + n;
+    }
+    *value = neg ? -v : v;
+    return p;
+}
+
+/// @brief Classify a header field of a var_monitor trace, or of the trace
+/// of a var_monitor that followed another one (-f).
+static struct column classify(const char *name, size_t len, int *time_ms)
+{
+    struct column c = {COL_SKIP, 0};
+    char field[128];
+
+    while (len > 0 && isspace((unsigned char)name[len - 1]))
+    {
+        len--;
+    }
+    while (len > 0 && isspace((unsigned char)*name))
+    {
+        name++;
+        len--;
+    }
+    if (len >= sizeof(field))
+    {
+        return c;
+    }
+    memcpy(field, name, len);
+    field[len] = '\0';
+
+    if (strcmp(field, "Hostname") == 0)
+    {
+        c.kind = COL_HOST;
+    }
+    else if (strncmp(field, "Timestamp", 9) == 0)
+    {
+        c.kind = COL_TIME;
+        *time_ms = strstr(field, "(ms)") != NULL;
+    }
+    else if (strcmp(field, "Node Power (W)") == 0 ||
+             strcmp(field, "power_node_watts") == 0)
+    {
+        c.kind = COL_NODE;
+    }
+    else if (sscanf(field, "Socket_%d Power (W)", &c.index) == 1 ||
+             sscanf(field, "power_cpu_watts_socket_%d", &c.index) == 1)
+    {
+        c.kind = COL_CPU;
+    }
+    else if (sscanf(field, "Mem_%d Power (W)", &c.index) == 1 ||
+             sscanf(field, "power_mem_watts_socket_%d", &c.index) == 1)
+    {
+        c.kind = COL_MEM;
+    }
+    else if (sscanf(field, "GPU_%d Power (W)", &c.index) == 1 ||
+             sscanf(field, "power_gpu_watts_gpu_%d", &c.index) == 1)
+    {
+        c.kind = COL_GPU;
+    }
+    if ((c.kind == COL_CPU || c.kind == COL_MEM) &&
+        (c.index < 0 || c.index >= MAX_SOCKETS))
+    {
+        c.kind = COL_SKIP;
+    }
+    return c;
+}
+
+/// @brief Read runtime ms from the summary file next to a trace, if any.
+static void read_summary(const char *path, struct node_result *r)
+{
+    char summary[4096];
+    char line[256];
+    size_t n = strlen(path) - strlen(TRACE_SUFFIX);
+    FILE *f;
+
+    r->runtime_ms = NAN;
+    if (n + strlen(SUMMARY_SUFFIX) >= sizeof(summary))
+    {
+        return;
+    }
+    memcpy(summary, path, n);
+    strcpy(summary + n, SUMMARY_SUFFIX);
+    f = fopen(summary, "r");
+    if (f == NULL)
+    {
+        return;
+    }
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        if (sscanf(line, "runtime ms: %lf", &r->runtime_ms) == 1)
+        {
+            break;
+        }
+    }
+    fclose(f);
+}
+
+/// @brief Resample one trace onto the grid of the worker, and compute the
+/// per-node results, in a single pass over the mapped file.
+static void analyze(struct worker *w, const char *path, struct node_result *r)
+{
+    struct column cols[MAX_COLUMNS];
+    const char *data;
+    const char *p;
+    const char *end;
+    const char *eol;
+    const char *field;
+    struct stat st;
+    int ncols = 0;
+    int time_ms = 0;
+    int have_node = 0;
+    int nsockets = 0;
+    int col;
+    int fd;
+    int i;
+    int64_t step = w->job->step_us;
+    int64_t t;
+    int64_t t_prev = 0;
+    int64_t g;
+    double v;
+    double frac;
+    double node;
+    double node_prev = 0.0;
+    double cpu[MAX_SOCKETS];
+    double cpu_prev[MAX_SOCKETS];
+    double sum;
+    double smin;
+    double smax;
+    struct grid_point *gp;
+
+    memset(r, 0, sizeof(*r));
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        r->error = 1;
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return;
+    }
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        r->error = 1;
+        return;
+    }
+    madvise((void *)data, st.st_size, MADV_SEQUENTIAL);
+    end = data + st.st_size;
+
+    // Header.
+    eol = memchr(data, '\n', st.st_size);
+    if (eol == NULL)
+    {
+        r->error = 1;
+        munmap((void *)data, st.st_size);
+        return;
+    }
+    for (p = data; p <= eol && ncols < MAX_COLUMNS;)
+    {
+        field = p;
+        while (p < eol && *p != ',')
+        {
+            p++;
+        }
+        cols[ncols] = classify(field, p - field, &time_ms);
+        if (cols[ncols].kind == COL_NODE)
+        {
+            have_node = 1;
+        }
+        if (cols[ncols].kind == COL_CPU && cols[ncols].index + 1 > nsockets)
+        {
+            nsockets = cols[ncols].index + 1;
+        }
+        ncols++;
+        p++;
+    }
+
+    // Rows.
+    for (p = eol + 1; p < end; p = eol + 1)
+    {
+        eol = memchr(p, '\n', end - p);
+        if (eol == NULL)
+        {
+            eol = end;
+        }
+        t = -1;
+        node = 0.0;
+        memset(cpu, 0, sizeof(cpu));
+        for (col = 0; col < ncols && p < eol; col++)
+        {
+            field = p;
+            if (cols[col].kind == COL_HOST)
+            {
+                while (p < eol && *p != ',')
+                {
+                    p++;
+                }
+                if (r->host[0] == '\0')
+                {
+                    snprintf(r->host, HOST_LEN, "%.*s", (int)(p - field), field);
+                }
+            }
+            else if (cols[col].kind == COL_SKIP)
+            {
+                while (p < eol && *p != ',')
+                {
+                    p++;
+                }
+            }
+            else
+            {
+                p = parse_number(p, eol, &v);
+                switch (cols[col].kind)
+                {
+                    case COL_TIME:
+                        t = time_ms ? (int64_t)(v * 1000) : (int64_t)v;
+                        break;
+                    case COL_NODE:
+                        node = v;
+                        break;
+                    case COL_CPU:
+                        cpu[cols[col].index] = v;
+                        if (!have_node)
+                        {
+                            node += v;
+                        }
+                        break;
+                    default:
+                        if (!have_node)
+                        {
+                            node += v;
+                        }
+                        break;
+                }
+                while (p < eol && *p != ',')
+                {
+                    p++;
+                }
+            }
+            p++;
+        }
+        if (t < 0 || (r->samples > 0 && t <= t_prev))
+        {
+            continue;
+        }
+
+        if (r->samples == 0)
+        {
+            r->start_us = t;
+            t_prev = t - 1;
+            node_prev = node;
+            memcpy(cpu_prev, cpu, sizeof(cpu));
+        }
+        else
+        {
+            r->energy_j += (t - t_prev) / 1e6 * (node + node_prev) / 2.0;
+        }
+        r->samples++;
+        r->end_us = t;
+        if (node > r->max_w)
+        {
+            r->max_w = node;
+        }
+
+        // Interpolate the grid points since the previous sample.
+        for (g = (t_prev / step + 1) * step; g <= t; g += step)
+        {
+            frac = (double)(g - t_prev) / (double)(t - t_prev);
+            gp = grid_at(&w->grid, g / step);
+            if (gp == NULL)
+            {
+                break;
+            }
+            v = node_prev + frac * (node - node_prev);
+            gp->total_w += v;
+            gp->node_min_w = fmin(gp->node_min_w, v);
+            gp->node_max_w = fmax(gp->node_max_w, v);
+            gp->nodes++;
+            sum = 0.0;
+            smin = INFINITY;
+            smax = -INFINITY;
+            for (i = 0; i < nsockets; i++)
+            {
+                v = cpu_prev[i] + frac * (cpu[i] - cpu_prev[i]);
+                sum += v;
+                smin = fmin(smin, v);
+                smax = fmax(smax, v);
+            }
+            if (nsockets > 0)
+            {
+                gp->socket_sum_w += sum;
+                gp->socket_min_w = fmin(gp->socket_min_w, smin);
+                gp->socket_max_w = fmax(gp->socket_max_w, smax);
+                gp->sockets += nsockets;
+            }
+            if (nsockets > 1 && sum > 0.0)
+            {
+                v = (smax - smin) / (sum / nsockets);
+                gp->imbalance += v;
+                gp->imbalanced_nodes++;
+                r->imbalance_sum += v;
+                r->imbalance_count++;
+            }
+        }
+        t_prev = t;
+        node_prev = node;
+        memcpy(cpu_prev, cpu, sizeof(cpu));
+    }
+    munmap((void *)data, st.st_size);
+
+    if (r->samples == 0)
+    {
+        r->error = 1;
+        return;
+    }
+    if (r->host[0] == '\0')
+    {
+        snprintf(r->host, HOST_LEN, "%s", path);
+    }
+    read_summary(path, r);
+    if (isnan(r->runtime_ms))
+    {
+        r->runtime_ms = (r->end_us - r->start_us) / 1000.0;
+    }
+}
+
+static void *work(void *arg)
+{
+    struct worker *w = (struct worker *)arg;
+    struct job *job = w->job;
+    size_t i;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&job->lock);
+        i = job->next++;
+        pthread_mutex_unlock(&job->lock);
+        if (i >= job->npaths)
+        {
+            break;
+        }
+        analyze(w, job->paths[i], &job->results[i]);
+    }
+    return arg;
+}
+
+static int add_path(struct job *job, size_t *cap, const char *path)
+{
+    char **paths;
+
+    if (job->npaths == *cap)
+    {
+        *cap = *cap ? 2 * *cap : 1024;
+        paths = (char **) realloc(job->paths, *cap * sizeof(char *));
+        if (paths == NULL)
+        {
+            return -1;
+        }
+        job->paths = paths;
+    }
+    job->paths[job->npaths] = strdup(path);
+    return job->paths[job->npaths++] != NULL ? 0 : -1;
+}
+
+/// @brief Add a trace, or all traces of a directory. Traces of followers
+/// (hostname.pid.var_monitor.dat) repeat the samples of their node and are
+/// skipped.
+static int add_input(struct job *job, size_t *cap, const char *path)
+{
+    struct dirent *e;
+    struct stat st;
+    char file[4096];
+    size_t n;
+    size_t k;
+    DIR *d;
+
+    if (stat(path, &st) != 0)
+    {
+        fprintf(stderr, "Error: cannot access %s -- %s.\n", path, strerror(errno));
+        return -1;
+    }
+    if (!S_ISDIR(st.st_mode))
+    {
+        return add_path(job, cap, path);
+    }
+    d = opendir(path);
+    if (d == NULL)
+    {
+        fprintf(stderr, "Error: cannot open %s -- %s.\n", path, strerror(errno));
+        return -1;
+    }
+    while ((e = readdir(d)) != NULL)
+    {
+        if (!ends_with(e->d_name, TRACE_SUFFIX))
+        {
+            continue;
+        }
+        n = strlen(e->d_name) - strlen(TRACE_SUFFIX);
+        k = n;
+        while (k > 0 && isdigit((unsigned char)e->d_name[k - 1]))
+        {
+            k--;
+        }
+        if (k > 0 && k < n && e->d_name[k - 1] == '.')
+        {
+            continue;
+        }
+        snprintf(file, sizeof(file), "%s/%s", path, e->d_name);
+        if (add_path(job, cap, file) != 0)
+        {
+            closedir(d);
+            return -1;
+        }
+    }
+    closedir(d);
+    return 0;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double mean_w(const struct node_result *r)
+{
+    return r->end_us > r->start_us ? r->energy_j / ((r->end_us - r->start_us) / 1e6)
+           : r->max_w;
+}
+
+/// @brief Modified z-score of the mean power of every node, from the median
+/// and the median absolute deviation of all nodes.
+static void score_nodes(struct job *job)
+{
+    double *values;
+    double median;
+    double mad;
+    size_t n = 0;
+    size_t i;
+
+    values = (double *) malloc(job->npaths * sizeof(double));
+    if (values == NULL)
+    {
+        return;
+    }
+    for (i = 0; i < job->npaths; i++)
+    {
+        if (!job->results[i].error)
+        {
+            values[n++] = mean_w(&job->results[i]);
+        }
+    }
+    if (n == 0)
+    {
+        free(values);
+        return;
+    }
+    qsort(values, n, sizeof(double), compare_double);
+    median = n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+    for (i = 0; i < n; i++)
+    {
+        values[i] = fabs(values[i] - median);
+    }
+    qsort(values, n, sizeof(double), compare_double);
+    mad = n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+    for (i = 0; i < job->npaths; i++)
+    {
+        if (job->results[i].error)
+        {
+            continue;
+        }
+        if (mad > 0.0)
+        {
+            job->results[i].z = 0.6745 * (mean_w(&job->results[i]) - median) / mad;
+        }
+        else
+        {
+            job->results[i].z = mean_w(&job->results[i]) == median ? 0.0 : INFINITY;
+        }
+    }
+    free(values);
+}
+
+int main(int argc, char **argv)
+{
+    const char *usage = "\n"
+                        "NAME\n"
+                        "    var_monitor_analyze - Merge and analyze the traces of a job\n"
+                        "\n"
+                        "SYNOPSIS\n"
+                        "    var_monitor_analyze [--help | -h] [OPTIONS]... path...\n"
+                        "\n"
+                        "OVERVIEW\n"
+                        "    Reads the hostname.var_monitor.dat traces (and the\n"
+                        "    hostname.power.summary files next to them) of all nodes of a job\n"
+                        "    in parallel, resamples every node onto a common time grid, and\n"
+                        "    reports the job's energy-to-solution, total power and socket\n"
+                        "    imbalance over time, and the nodes whose mean power is an\n"
+                        "    outlier. A path is a trace or a directory of traces.\n"
+                        "\n"
+                        "OPTIONS\n"
+                        "    --help | -h\n"
+                        "        Display this help information, then exit.\n"
+                        "\n"
+                        "    -s ms_step\n"
+                        "        Step of the time grid in milliseconds (default = 100ms).\n"
+                        "\n"
+                        "    -j threads\n"
+                        "        Number of threads (default = number of online CPUs).\n"
+                        "\n"
+                        "    -o prefix\n"
+                        "        Write prefix.timeline.csv and prefix.nodes.csv\n"
+                        "        (default = job).\n"
+                        "\n"
+                        "    -z threshold\n"
+                        "        Modified z-score beyond which a node is an outlier\n"
+                        "        (default = 3.5).\n"
+                        "\n";
+
+    if (argc == 1 || (argc > 1 && (
+                          strncmp(argv[1], "--help", strlen("--help")) == 0 ||
+                          strncmp(argv[1], "-h", strlen("-h")) == 0)))
+    {
+        printf("%s", usage);
+        return 0;
+    }
+
+    int opt;
+    long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned step_ms = DEFAULT_STEP_MS;
+    double threshold = DEFAULT_OUTLIER_Z;
+    const char *prefix = "job";
+
+    while ((opt = getopt(argc, argv, "s:j:o:z:")) != -1)
+    {
+        switch (opt)
+        {
+            case 's':
+                step_ms = atoi(optarg);
+                if (step_ms == 0)
+                {
+                    step_ms = DEFAULT_STEP_MS;
+                }
+                break;
+            case 'j':
+                nthreads = atol(optarg);
+                break;
+            case 'o':
+                prefix = optarg;
+                break;
+            case 'z':
+                threshold = atof(optarg);
+                break;
+            case '?':
+                if (optopt == 's' || optopt == 'j' || optopt == 'o' || optopt == 'z')
+                {
+                    fprintf(stderr, "Option -%c requires an argument.\n", optopt);
+                }
+                else if (isprint(optopt))
+                {
+                    fprintf(stderr, "\nError: unknown parameter \"-%c\"\n", optopt);
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown option character `\\x%x'.\n", optopt);
+                }
+                fprintf(stderr, "%s", usage);
+                return 1;
+            default:
+                return 1;
+        }
+    }
+    if (optind >= argc)
+    {
+        printf("Error: Must specify at least one trace or directory.\n");
+        printf("%s", usage);
+        return 1;
+    }
+    if (nthreads < 1)
+    {
+        nthreads = 1;
+    }
+
+    struct job job;
+    struct worker *workers;
+    struct grid grid;
+    struct grid_point *gp;
+    struct node_result *r;
+    size_t cap = 0;
+    size_t nodes = 0;
+    size_t failed = 0;
+    size_t outliers = 0;
+    size_t i;
+    long t;
+    char *fname = NULL;
+    FILE *timeline;
+    FILE *nodefile;
+    double start = now_s();
+    double energy = 0.0;
+    double power_sum = 0.0;
+    double power_peak = 0.0;
+    double imbalance;
+    double imbalance_sum = 0.0;
+    double imbalance_peak = 0.0;
+    size_t points = 0;
+    size_t imbalance_points = 0;
+    uint64_t samples = 0;
+    int64_t job_start = INT64_MAX;
+    int64_t job_end = INT64_MIN;
+
+    memset(&job, 0, sizeof(job));
+    for (i = optind; i < (size_t)argc; i++)
+    {
+        if (add_input(&job, &cap, argv[i]) != 0)
+        {
+            return 1;
+        }
+    }
+    if (job.npaths == 0)
+    {
+        fprintf(stderr, "Error: no traces found.\n");
+        return 1;
+    }
+    if ((size_t)nthreads > job.npaths)
+    {
+        nthreads = job.npaths;
+    }
+    job.step_us = step_ms * (int64_t)1000;
+    job.results = (struct node_result *) calloc(job.npaths,
+                  sizeof(struct node_result));
+    workers = (struct worker *) calloc(nthreads, sizeof(struct worker));
+    if (job.results == NULL || workers == NULL)
+    {
+        return 1;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+
+    for (t = 0; t < nthreads; t++)
+    {
+        workers[t].job = &job;
+        pthread_create(&workers[t].thread, NULL, work, &workers[t]);
+    }
+    memset(&grid, 0, sizeof(grid));
+    for (t = 0; t < nthreads; t++)
+    {
+        pthread_join(workers[t].thread, NULL);
+        grid_merge(&grid, &workers[t].grid);
+        free(workers[t].grid.points);
+    }
+    score_nodes(&job);
+
+    // Job timeline.
+    if (asprintf(&fname, "%s.timeline.csv", prefix) == -1 ||
+        (timeline = fopen(fname, "w")) == NULL)
+    {
+        fprintf(stderr, "Error: cannot write %s.timeline.csv.\n", prefix);
+        return 1;
+    }
+    free(fname);
+    fprintf(timeline, "Timestamp (ms),Nodes,Total Power (W),Node Min Power (W),"
+            "Node Max Power (W),Sockets,Socket Min Power (W),"
+            "Socket Max Power (W),Socket Imbalance (%%)\n");
+    for (i = 0; i < grid.len; i++)
+    {
+        gp = &grid.points[i];
+        if (gp->nodes == 0)
+        {
+            continue;
+        }
+        imbalance = gp->imbalanced_nodes ?
+                    100.0 * gp->imbalance / gp->imbalanced_nodes : 0.0;
+        fprintf(timeline, "%ld,%u,%0.2f,%0.2f,%0.2f,%u,%0.2f,%0.2f,%0.2f\n",
+                (long)((grid.base + (int64_t)i) * step_ms), gp->nodes, gp->total_w,
+                gp->node_min_w, gp->node_max_w, gp->sockets,
+                gp->sockets ? gp->socket_min_w : 0.0,
+                gp->sockets ? gp->socket_max_w : 0.0, imbalance);
+        points++;
+        power_sum += gp->total_w;
+        if (gp->total_w > power_peak)
+        {
+            power_peak = gp->total_w;
+        }
+        if (gp->imbalanced_nodes)
+        {
+            imbalance_points++;
+            imbalance_sum += imbalance;
+            if (imbalance > imbalance_peak)
+            {
+                imbalance_peak = imbalance;
+            }
+        }
+    }
+    fclose(timeline);
+
+    // Nodes.
+    if (asprintf(&fname, "%s.nodes.csv", prefix) == -1 ||
+        (nodefile = fopen(fname, "w")) == NULL)
+    {
+        fprintf(stderr, "Error: cannot write %s.nodes.csv.\n", prefix);
+        return 1;
+    }
+    free(fname);
+    fprintf(nodefile, "Hostname,Samples,Start (ms),End (ms),Runtime (ms),"
+            "Energy (J),Mean Power (W),Max Power (W),Socket Imbalance (%%),"
+            "Z-Score,Outlier\n");
+    for (i = 0; i < job.npaths; i++)
+    {
+        r = &job.results[i];
+        if (r->error)
+        {
+            fprintf(stderr, "Warning: cannot analyze %s.\n", job.paths[i]);
+            failed++;
+            continue;
+        }
+        nodes++;
+        samples += r->samples;
+        energy += r->energy_j;
+        if (r->start_us < job_start)
+        {
+            job_start = r->start_us;
+        }
+        if (r->end_us > job_end)
+        {
+            job_end = r->end_us;
+        }
+        if (fabs(r->z) > threshold)
+        {
+            outliers++;
+        }
+        fprintf(nodefile, "%s,%lu,%ld,%ld,%0.0f,%0.2f,%0.2f,%0.2f,%0.2f,%0.2f,%d\n",
+                r->host, (unsigned long)r->samples, (long)(r->start_us / 1000),
+                (long)(r->end_us / 1000), r->runtime_ms, r->energy_j, mean_w(r),
+                r->max_w, r->imbalance_count ?
+                100.0 * r->imbalance_sum / r->imbalance_count : 0.0, r->z,
+                fabs(r->z) > threshold);
+    }
+    fclose(nodefile);
+
+    printf("Traces           %zu (%zu unreadable)\n", job.npaths, failed);
+    printf("Samples          %lu\n", (unsigned long)samples);
+    if (nodes > 0)
+    {
+        printf("Duration         %0.3f s\n", (job_end - job_start) / 1e6);
+        printf("Energy           %0.2f J (%0.4f kWh)\n", energy, energy / 3.6e6);
+        printf("Total power      mean %0.2f W, peak %0.2f W over %zu points of %u ms\n",
+               points ? power_sum / points : 0.0, power_peak, points, step_ms);
+        printf("Socket imbalance mean %0.2f%%, peak %0.2f%%\n",
+               imbalance_points ? imbalance_sum / imbalance_points : 0.0,
+               imbalance_peak);
+        printf("Outliers         %zu of %zu nodes with |z| > %0.1f\n", outliers,
+               nodes, threshold);
+        for (i = 0; i < job.npaths; i++)
+        {
+            r = &job.results[i];
+            if (!r->error && fabs(r->z) > threshold)
+            {
+                printf("  %-24s mean %0.2f W, z %0.2f\n", r->host, mean_w(r), r->z);
+            }
+        }
+    }
+    printf("Output Files\n"
+           "  %s.timeline.csv\n"
+           "  %s.nodes.csv\n", prefix, prefix);
+    printf("Analyzed in %0.2f s with %ld threads\n", now_s() - start, nthreads);
+
+    for (i = 0; i < job.npaths; i++)
+    {
+        free(job.paths[i]);
+    }
+    free(job.paths);
+    free(job.results);
+    free(workers);
+    free(grid.points);
+    return 0;
+}
@@ -0,0 +1,280 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <variorum_series.h>
+
+#include "series_log.h"
+
+static int compress(const char *path, const char *output)
+{
+    char name[4096];
+    unsigned long lost = 0;
+    struct stat in_st;
+    struct stat out_st;
+    size_t n;
+    FILE *in;
+    int fd;
+
+    if (output == NULL)
+    {
+        // trace.dat becomes trace.vts, anything else gets the suffix added.
+        n = strlen(path);
+        if (n > 4 && strcmp(path + n - 4, ".dat") == 0)
+        {
+            n -= 4;
+        }
+        snprintf(name, sizeof(name), "%.*s%s", (int)n, path, SERIES_LOG_SUFFIX);
+        output = name;
+    }
+    in = fopen(path, "r");
+    if (in == NULL)
+    {
+        fprintf(stderr, "Error: cannot open %s -- %s.\n", path, strerror(errno));
+        return 1;
+    }
+    fd = open(output, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Error: cannot create %s -- %s.\n", output,
+                strerror(errno));
+        fclose(in);
+        return 1;
+    }
+    if (series_log_compress(in, fd, &lost) != 0)
+    {
+        fprintf(stderr, "Error: cannot compress %s into %s.\n", path, output);
+        fclose(in);
+        return 1;
+    }
+    fstat(fileno(in), &in_st);
+    fclose(in);
+    if (lost > 0)
+    {
+        fprintf(stderr, "Warning: %lu lines of %s could not be stored exactly "
+                "and were dropped.\n", lost, path);
+    }
+    if (stat(output, &out_st) == 0 && out_st.st_size > 0)
+    {
+        printf("%s: %ld bytes, %s: %ld bytes (%0.1fx)\n", path,
+               (long)in_st.st_size, output, (long)out_st.st_size,
+               (double)in_st.st_size / out_st.st_size);
+    }
+    return lost > 0;
+}
+
+static int info(const char *path)
+{
+    struct variorum_series_reader *r;
+    const struct variorum_series_column *columns;
+    struct stat st;
+    uint32_t ncolumns;
+    uint32_t c;
+    uint64_t samples;
+    uint64_t blocks;
+    int64_t first;
+    int64_t last;
+
+    if (variorum_series_open(path, &r) != 0)
+    {
+        fprintf(stderr, "Error: %s is not a compressed trace.\n", path);
+        return 1;
+    }
+    stat(path, &st);
+    variorum_series_extent(r, &samples, &blocks, &first, &last);
+    columns = variorum_series_columns(r, &ncolumns);
+    printf("File             %s\n", path);
+    printf("Size             %ld bytes, %0.2f bytes per sample\n",
+           (long)st.st_size, samples ? (double)st.st_size / samples : 0.0);
+    printf("Samples          %lu in %lu blocks\n", (unsigned long)samples,
+           (unsigned long)blocks);
+    printf("Time             %s from %ld to %ld\n", variorum_series_time_name(r),
+           (long)first, (long)last);
+    printf("Columns          %u\n", ncolumns);
+    for (c = 0; c < ncolumns; c++)
+    {
+        if (columns[c].decimals == VARIORUM_SERIES_DOUBLE)
+        {
+            printf("  %-40s double\n", columns[c].name);
+        }
+        else
+        {
+            printf("  %-40s %d decimals\n", columns[c].name, columns[c].decimals);
+        }
+    }
+    variorum_series_reader_close(r);
+    return 0;
+}
+
+static int extract(const char *path, const char *from, const char *to,
+                   int header, const char *output)
+{
+    struct variorum_series_reader *r;
+    int64_t first = INT64_MIN;
+    int64_t last = INT64_MAX;
+    FILE *out = stdout;
+    int rc;
+
+    if (variorum_series_open(path, &r) != 0)
+    {
+        fprintf(stderr, "Error: %s is not a compressed trace.\n", path);
+        return 1;
+    }
+    if ((from != NULL && series_log_parse_time(r, from, &first) != 0) ||
+        (to != NULL && series_log_parse_time(r, to, &last) != 0))
+    {
+        fprintf(stderr, "Error: invalid time range for %s.\n", path);
+        variorum_series_reader_close(r);
+        return 1;
+    }
+    if (output != NULL)
+    {
+        out = fopen(output, "w");
+        if (out == NULL)
+        {
+            fprintf(stderr, "Error: cannot create %s -- %s.\n", output,
+                    strerror(errno));
+            variorum_series_reader_close(r);
+            return 1;
+        }
+    }
+    rc = series_log_extract(r, first, last, header, out);
+    if (rc != 0)
+    {
+        fprintf(stderr, "Error: %s is corrupted.\n", path);
+    }
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    variorum_series_reader_close(r);
+    return rc != 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *usage = "\n"
+                        "NAME\n"
+                        "    var_monitor_series - Compress traces and read them back\n"
+                        "\n"
+                        "SYNOPSIS\n"
+                        "    var_monitor_series [--help | -h] -c trace [-o file]\n"
+                        "    var_monitor_series [--help | -h] [OPTIONS]... file.vts\n"
+                        "    var_monitor_series [--help | -h] -l file.vts\n"
+                        "\n"
+                        "OVERVIEW\n"
+                        "    Traces written by var_monitor and the power wrappers with -z are\n"
+                        "    compressed series of samples (.vts). The var_monitor_series writes\n"
+                        "    the samples of a time range of such a file back as the text trace\n"
+                        "    they came from, reading only the blocks of samples in that range.\n"
+                        "    With -c, it compresses an existing text trace. Every value is kept\n"
+                        "    exactly as written in the text trace.\n"
+                        "\n"
+                        "OPTIONS\n"
+                        "    --help | -h\n"
+                        "        Display this help information, then exit.\n"
+                        "\n"
+                        "    -c trace\n"
+                        "        Compress trace into trace.vts, or the file given with -o.\n"
+                        "\n"
+                        "    -l\n"
+                        "        List the columns, samples and time range of the file.\n"
+                        "\n"
+                        "    -s time\n"
+                        "        First time to write, in the unit of the time column.\n"
+                        "\n"
+                        "    -e time\n"
+                        "        Last time to write, in the unit of the time column.\n"
+                        "\n"
+                        "    -n\n"
+                        "        Do not write the header line.\n"
+                        "\n"
+                        "    -o file\n"
+                        "        Write to file instead of stdout.\n"
+                        "\n";
+
+    if (argc == 1 || (argc > 1 && (
+                          strncmp(argv[1], "--help", strlen("--help")) == 0 ||
+                          strncmp(argv[1], "-h", strlen("-h")) == 0)))
+    {
+        printf("%s", usage);
+        return 0;
+    }
+
+    int opt;
+    int list = 0;
+    int header = 1;
+    char *trace = NULL;
+    char *from = NULL;
+    char *to = NULL;
+    char *output = NULL;
+
+    while ((opt = getopt(argc, argv, "c:ls:e:no:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c':
+                trace = optarg;
+                break;
+            case 'l':
+                list = 1;
+                break;
+            case 's':
+                from = optarg;
+                break;
+            case 'e':
+                to = optarg;
+                break;
+            case 'n':
+                header = 0;
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case '?':
+                if (optopt == 'c' || optopt == 's' || optopt == 'e' ||
+                    optopt == 'o')
+                {
+                    fprintf(stderr, "Option -%c requires an argument.\n", optopt);
+                }
+                else if (isprint(optopt))
+                {
+                    fprintf(stderr, "\nError: unknown parameter \"-%c\"\n", optopt);
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown option character `\\x%x'.\n", optopt);
+                }
+                fprintf(stderr, "%s", usage);
+                return 1;
+            default:
+                return 1;
+        }
+    }
+
+    if (trace != NULL)
+    {
+        return compress(trace, output);
+    }
+    if (optind != argc - 1)
+    {
+        printf("Error: Must specify one compressed trace.\n");
+        printf("%s", usage);
+        return 1;
+    }
+    if (list)
+    {
+        return info(argv[optind]);
+    }
+    return extract(argv[optind], from, to, header, output);
+}
@@ -0,0 +1,366 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <ctype.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <variorum.h>
+#include <variorum_agg.h>
+#include <variorum_shm.h>
+
+#define DEFAULT_METRIC "power_node_watts"
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+static uint64_t now_ms(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * (uint64_t)1000 + tv.tv_usec / 1000;
+}
+
+struct timeline
+{
+    FILE *out;
+    unsigned interval_ms;
+};
+
+static void write_timeline(const struct variorum_agg_summary *s, void *arg)
+{
+    struct timeline *t = (struct timeline *)arg;
+
+    fprintf(t->out, "%lu %u %u %0.2lf %0.2lf %0.2lf %0.2lf %0.2lf %0.2lf\n",
+            s->bucket * t->interval_ms, s->nodes, s->expected, s->sum, s->min,
+            s->max, variorum_agg_summary_percentile(s, 50),
+            variorum_agg_summary_percentile(s, 90),
+            variorum_agg_summary_percentile(s, 99));
+    fflush(t->out);
+}
+
+/// @brief Sum of all values of a metric in a sample.
+///
+/// @return 0 if the sample has the metric, else -1.
+static int sum_metric(const struct variorum_metric *metrics, size_t count,
+                      const char *name, double *value)
+{
+    int found = -1;
+    size_t i;
+
+    *value = 0.0;
+    for (i = 0; i < count; i++)
+    {
+        if (strcmp(metrics[i].name, name) == 0)
+        {
+            *value += metrics[i].value;
+            found = 0;
+        }
+    }
+    return found;
+}
+
+static int run_node(const char *parent, unsigned interval_ms,
+                    const char *metric, const char *region)
+{
+    struct variorum_metric_vector metrics;
+    struct variorum_shm_sample *sample = NULL;
+    struct variorum_shm *shm = NULL;
+    struct timespec t;
+    uint64_t next;
+    uint64_t now;
+    double value;
+    int fd;
+    int rc;
+
+    fd = variorum_agg_connect(parent);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Error: cannot connect to %s.\n", parent);
+        return 1;
+    }
+    if (region != NULL)
+    {
+        sample = malloc(sizeof(struct variorum_shm_sample));
+        if (sample == NULL || variorum_shm_attach(region, &shm) != 0)
+        {
+            fprintf(stderr, "Error: cannot read the telemetry region %s.\n",
+                    region);
+            free(sample);
+            close(fd);
+            return 1;
+        }
+    }
+    variorum_metric_vector_init(&metrics);
+    if (shm == NULL && (variorum_get_metrics(&metrics) != 0 ||
+                        sum_metric(metrics.metrics, metrics.count, metric, &value) != 0))
+    {
+        fprintf(stderr, "Error: %s is not available on this node.\n", metric);
+        variorum_metric_vector_free(&metrics);
+        close(fd);
+        return 1;
+    }
+
+    // Sample at the end of every bucket and send the value for it.
+    next = (variorum_agg_bucket(now_ms(), interval_ms) + 1) * interval_ms;
+    while (!stop)
+    {
+        now = now_ms();
+        if (now < next)
+        {
+            t.tv_sec = (next - now) / 1000;
+            t.tv_nsec = (next - now) % 1000 * 1000000L;
+            nanosleep(&t, NULL);
+            continue;
+        }
+        if (shm != NULL)
+        {
+            rc = variorum_shm_read(shm, sample);
+            if (rc == 0)
+            {
+                rc = sum_metric(sample->metrics, sample->count, metric, &value);
+            }
+        }
+        else
+        {
+            variorum_metric_vector_clear(&metrics);
+            rc = variorum_get_metrics(&metrics);
+            if (rc == 0)
+            {
+                rc = sum_metric(metrics.metrics, metrics.count, metric, &value);
+            }
+        }
+        if (rc == 0 &&
+            variorum_agg_send_sample(fd, next / interval_ms - 1, value) != 0)
+        {
+            fprintf(stderr, "Error: lost the connection to %s.\n", parent);
+            break;
+        }
+        next = (variorum_agg_bucket(now_ms(), interval_ms) + 1) * interval_ms;
+    }
+
+    variorum_metric_vector_free(&metrics);
+    if (shm != NULL)
+    {
+        variorum_shm_detach(shm);
+    }
+    free(sample);
+    close(fd);
+    return 0;
+}
+
+static int run_aggregator(const char *listen_addr, const char *parent,
+                          unsigned interval_ms, unsigned lateness_ms,
+                          const char *output)
+{
+    struct variorum_agg *agg;
+    struct timeline t;
+    int rc;
+
+    rc = variorum_agg_create(listen_addr, parent, interval_ms, lateness_ms,
+                             &agg);
+    if (rc != 0)
+    {
+        fprintf(stderr, "Error: cannot listen on %s%s%s.\n", listen_addr,
+                parent != NULL ? " or connect to " : "",
+                parent != NULL ? parent : "");
+        return 1;
+    }
+    fprintf(stderr, "Listening on %s\n", variorum_agg_address(agg));
+
+    t.out = NULL;
+    t.interval_ms = interval_ms;
+    if (output != NULL && strcmp(output, "-") != 0)
+    {
+        t.out = fopen(output, "w");
+        if (t.out == NULL)
+        {
+            fprintf(stderr, "Error: cannot open %s.\n", output);
+            variorum_agg_destroy(agg);
+            return 1;
+        }
+    }
+    else if (output != NULL || parent == NULL)
+    {
+        t.out = stdout;
+    }
+    if (t.out != NULL)
+    {
+        fprintf(t.out, "# time_ms nodes expected sum min max p50 p90 p99\n");
+        variorum_agg_set_callback(agg, write_timeline, &t);
+    }
+
+    while (!stop)
+    {
+        if (variorum_agg_run(agg, 100) != 0)
+        {
+            break;
+        }
+    }
+    variorum_agg_flush(agg);
+    variorum_agg_destroy(agg);
+    if (t.out != NULL && t.out != stdout)
+    {
+        fclose(t.out);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *usage = "\n"
+                        "NAME\n"
+                        "    variorum_aggregator - Cluster-wide power aggregation tree\n"
+                        "\n"
+                        "SYNOPSIS\n"
+                        "    variorum_aggregator [--help | -h] -l address [OPTIONS]...\n"
+                        "    variorum_aggregator [--help | -h] -s -p address [OPTIONS]...\n"
+                        "\n"
+                        "OVERVIEW\n"
+                        "    With -l, the variorum_aggregator reduces the values of its\n"
+                        "    children per time bucket to their sum, minimum, maximum and\n"
+                        "    percentiles, and forwards every bucket to its parent (-p), or\n"
+                        "    writes it to the job-wide timeline if it is the root. With -s, it\n"
+                        "    samples a metric of its node at the end of every bucket and sends\n"
+                        "    it to its parent. Addresses are unix:path or tcp:host:port. It\n"
+                        "    runs until interrupted.\n"
+                        "\n"
+                        "OPTIONS\n"
+                        "    --help | -h\n"
+                        "        Display this help information, then exit.\n"
+                        "\n"
+                        "    -l address\n"
+                        "        Aggregate the children connecting to address.\n"
+                        "\n"
+                        "    -s\n"
+                        "        Send the values of this node to the parent.\n"
+                        "\n"
+                        "    -p address\n"
+                        "        Address of the parent aggregator.\n"
+                        "\n"
+                        "    -i ms_interval\n"
+                        "        Bucket length in milliseconds (default = 100ms), which must be\n"
+                        "        the same in the whole tree.\n"
+                        "\n"
+                        "    -L ms_lateness\n"
+                        "        Time per level after the end of a bucket after which it is\n"
+                        "        completed without the missing children (default = 2 buckets).\n"
+                        "\n"
+                        "    -o file\n"
+                        "        Write the timeline to file, - for stdout (default for the root).\n"
+                        "\n"
+                        "    -m metric\n"
+                        "        Metric the node sends, summed over its domains\n"
+                        "        (default = power_node_watts).\n"
+                        "\n"
+                        "    -n name\n"
+                        "        Read the metric from the telemetry region of variorum_publisher\n"
+                        "        instead of sampling the node.\n"
+                        "\n";
+
+    if (argc == 1 || (argc > 1 && (
+                          strncmp(argv[1], "--help", strlen("--help")) == 0 ||
+                          strncmp(argv[1], "-h", strlen("-h")) == 0)))
+    {
+        printf("%s", usage);
+        return 0;
+    }
+
+    int opt;
+    int node = 0;
+    char *listen_addr = NULL;
+    char *parent = NULL;
+    char *output = NULL;
+    char *metric = DEFAULT_METRIC;
+    char *region = NULL;
+    unsigned interval_ms = VARIORUM_AGG_DEFAULT_INTERVAL_MS;
+    unsigned lateness_ms = 0;
+    struct sigaction sa;
+
+    while ((opt = getopt(argc, argv, "l:sp:i:L:o:m:n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'l':
+                listen_addr = optarg;
+                break;
+            case 's':
+                node = 1;
+                break;
+            case 'p':
+                parent = optarg;
+                break;
+            case 'i':
+                interval_ms = atoi(optarg);
+                if (interval_ms == 0)
+                {
+                    interval_ms = VARIORUM_AGG_DEFAULT_INTERVAL_MS;
+                }
+                break;
+            case 'L':
+                lateness_ms = atoi(optarg);
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'm':
+                metric = optarg;
+                break;
+            case 'n':
+                region = optarg;
+                break;
+            case '?':
+                if (optopt == 'l' || optopt == 'p' || optopt == 'i' ||
+                    optopt == 'L' || optopt == 'o' || optopt == 'm' ||
+                    optopt == 'n')
+                {
+                    fprintf(stderr, "Option -%c requires an argument.\n", optopt);
+                }
+                else if (isprint(optopt))
+                {
+                    fprintf(stderr, "\nError: unknown parameter \"-%c\"\n", optopt);
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown option character `\\x%x'.\n", optopt);
+                }
+                fprintf(stderr, "%s", usage);
+                return 1;
+            default:
+                return 1;
+        }
+    }
+
+    if (node == (listen_addr != NULL) || (node && parent == NULL))
+    {
+        printf("Error: Must specify either -l address, or -s and -p address.\n");
+        printf("%s", usage);
+        return 1;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+
+    if (node)
+    {
+        return run_node(parent, interval_ms, metric, region);
+    }
+    return run_aggregator(listen_addr, parent, interval_ms, lateness_ms,
+                          output);
+}
@@ -0,0 +1,535 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <ctype.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <variorum_agg.h>
+
+#define ADDR_LEN 256
+#define MAX_LEVELS 16
+
+/// @brief Counters an inner aggregator reports when it is stopped.
+struct inner_report
+{
+    uint64_t messages;
+    uint64_t late;
+    double cpu_s;
+};
+
+struct root_state
+{
+    unsigned interval_ms;
+    unsigned nodes;
+    uint64_t first_bucket;
+    uint64_t buckets;
+    uint64_t complete;
+    double *latency_ms;
+    size_t nlatency;
+    size_t capacity;
+};
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+static double now_ms(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+static double cpu_seconds(int who)
+{
+    struct rusage ru;
+
+    getrusage(who, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void on_bucket(const struct variorum_agg_summary *s, void *arg)
+{
+    struct root_state *r = (struct root_state *)arg;
+    void *p;
+
+    // Skip the buckets before every node was connected.
+    if (s->bucket < r->first_bucket)
+    {
+        return;
+    }
+    r->buckets++;
+    if (s->nodes == r->nodes)
+    {
+        r->complete++;
+    }
+    if (r->nlatency == r->capacity)
+    {
+        p = realloc(r->latency_ms, 2 * (r->capacity + 64) * sizeof(double));
+        if (p == NULL)
+        {
+            return;
+        }
+        r->latency_ms = (double *)p;
+        r->capacity = 2 * (r->capacity + 64);
+    }
+    r->latency_ms[r->nlatency++] = now_ms() - (double)(s->bucket + 1) *
+                                   r->interval_ms;
+}
+
+static void install_handler(void)
+{
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+}
+
+/// @brief Body of an inner aggregator process.
+static void run_inner(const char *listen_addr, const char *parent,
+                      unsigned interval_ms, int addr_fd, int report_fd)
+{
+    struct variorum_agg_stats stats;
+    struct inner_report report;
+    struct variorum_agg *agg;
+    char addr[ADDR_LEN] = {'\0'};
+    ssize_t rc;
+
+    install_handler();
+    if (variorum_agg_create(listen_addr, parent, interval_ms, 0, &agg) == 0)
+    {
+        snprintf(addr, ADDR_LEN, "%s", variorum_agg_address(agg));
+    }
+    rc = write(addr_fd, addr, ADDR_LEN);
+    close(addr_fd);
+    if (addr[0] == '\0' || rc != ADDR_LEN)
+    {
+        _exit(1);
+    }
+    while (!stop)
+    {
+        variorum_agg_run(agg, 100);
+    }
+    variorum_agg_get_stats(agg, &stats);
+    report.messages = stats.messages;
+    report.late = stats.late;
+    report.cpu_s = cpu_seconds(RUSAGE_SELF);
+    rc = write(report_fd, &report, sizeof(report));
+    variorum_agg_destroy(agg);
+    _exit(rc == sizeof(report) ? 0 : 1);
+}
+
+/// @brief Body of a process that simulates count nodes sending at the end of
+/// every bucket.
+static void run_nodes(const char *parent, unsigned first, unsigned count,
+                      unsigned interval_ms)
+{
+    struct timespec t;
+    uint64_t bucket;
+    double next;
+    double now;
+    unsigned i;
+    int *fds;
+
+    install_handler();
+    fds = malloc(count * sizeof(int));
+    if (fds == NULL)
+    {
+        _exit(1);
+    }
+    for (i = 0; i < count; i++)
+    {
+        fds[i] = variorum_agg_connect(parent);
+        if (fds[i] < 0)
+        {
+            fprintf(stderr, "Error: node %u cannot connect to %s.\n", first + i,
+                    parent);
+            _exit(1);
+        }
+    }
+
+    bucket = variorum_agg_bucket((uint64_t)now_ms(), interval_ms) + 1;
+    while (!stop)
+    {
+        next = (double)bucket * interval_ms;
+        now = now_ms();
+        if (now < next)
+        {
+            t.tv_sec = (time_t)((next - now) / 1000);
+            t.tv_nsec = (long)((next - now - t.tv_sec * 1000.0) * 1e6);
+            nanosleep(&t, NULL);
+            continue;
+        }
+        // Node power between 200 W and 300 W that changes over time.
+        for (i = 0; i < count && !stop; i++)
+        {
+            if (variorum_agg_send_sample(fds[i], bucket - 1,
+                                         200.0 + (first + i + bucket) % 100) != 0)
+            {
+                _exit(1);
+            }
+        }
+        bucket = variorum_agg_bucket((uint64_t)now_ms(), interval_ms) + 1;
+    }
+    _exit(0);
+}
+
+static void make_address(char *addr, const char *transport, int level, int i)
+{
+    if (strcmp(transport, "tcp") == 0)
+    {
+        snprintf(addr, ADDR_LEN, "tcp:127.0.0.1:0");
+    }
+    else
+    {
+        snprintf(addr, ADDR_LEN, "unix:/tmp/variorum_aggregator_bench.%d.%d.%d",
+                 getpid(), level, i);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *usage = "\n"
+                        "NAME\n"
+                        "    variorum_aggregator_bench - Fan-in benchmark of the aggregation tree\n"
+                        "\n"
+                        "SYNOPSIS\n"
+                        "    variorum_aggregator_bench [--help | -h] [OPTIONS]...\n"
+                        "\n"
+                        "OVERVIEW\n"
+                        "    Builds an aggregation tree of local processes, with simulated\n"
+                        "    nodes sending one sample per bucket, and reports how many buckets\n"
+                        "    the root completed with every node, the latency from the end of a\n"
+                        "    bucket to its completion at the root, and the CPU time of the\n"
+                        "    aggregators.\n"
+                        "\n"
+                        "OPTIONS\n"
+                        "    --help | -h\n"
+                        "        Display this help information, then exit.\n"
+                        "\n"
+                        "    -n nodes\n"
+                        "        Number of simulated nodes (default = 1024).\n"
+                        "\n"
+                        "    -k fan_in\n"
+                        "        Largest number of children per aggregator (default = 32).\n"
+                        "\n"
+                        "    -r rate\n"
+                        "        Samples per second and node (default = 10).\n"
+                        "\n"
+                        "    -d seconds\n"
+                        "        Duration of the measurement (default = 10).\n"
+                        "\n"
+                        "    -t unix | tcp\n"
+                        "        Transport, Unix domain sockets or TCP on loopback\n"
+                        "        (default = unix).\n"
+                        "\n";
+
+    if (argc > 1 && (strncmp(argv[1], "--help", strlen("--help")) == 0 ||
+                     strncmp(argv[1], "-h", strlen("-h")) == 0))
+    {
+        printf("%s", usage);
+        return 0;
+    }
+
+    int opt;
+    unsigned nodes = 1024;
+    unsigned fan_in = 32;
+    unsigned rate = 10;
+    unsigned seconds = 10;
+    const char *transport = "unix";
+
+    while ((opt = getopt(argc, argv, "n:k:r:d:t:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                nodes = atoi(optarg);
+                break;
+            case 'k':
+                fan_in = atoi(optarg);
+                break;
+            case 'r':
+                rate = atoi(optarg);
+                break;
+            case 'd':
+                seconds = atoi(optarg);
+                break;
+            case 't':
+                transport = optarg;
+                break;
+            case '?':
+                if (optopt == 'n' || optopt == 'k' || optopt == 'r' ||
+                    optopt == 'd' || optopt == 't')
+                {
+                    fprintf(stderr, "Option -%c requires an argument.\n", optopt);
+                }
+                else if (isprint(optopt))
+                {
+                    fprintf(stderr, "\nError: unknown parameter \"-%c\"\n", optopt);
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown option character `\\x%x'.\n", optopt);
+                }
+                fprintf(stderr, "%s", usage);
+                return 1;
+            default:
+                return 1;
+        }
+    }
+    if (nodes == 0 || fan_in < 2 || rate == 0 || rate > 1000 || seconds == 0 ||
+        (strcmp(transport, "unix") != 0 && strcmp(transport, "tcp") != 0))
+    {
+        fprintf(stderr, "Error: invalid parameters.\n%s", usage);
+        return 1;
+    }
+
+    unsigned interval_ms = 1000 / rate;
+    unsigned width[MAX_LEVELS];
+    char *addrs[MAX_LEVELS];
+    unsigned nlevels = 0;
+    unsigned ninner = 0;
+    unsigned nsims;
+    unsigned level;
+    unsigned i;
+    pid_t *inner_pids;
+    pid_t *sim_pids;
+    int report_pipe[2];
+    int addr_pipe[2];
+    struct rlimit rl;
+    struct root_state root_state;
+    struct variorum_agg *root;
+    struct variorum_agg_stats root_stats;
+    struct inner_report report;
+    struct inner_report total;
+    double max_cpu_s = 0.0;
+    double root_cpu_s;
+    double start;
+    char root_addr[ADDR_LEN];
+
+    // Level 0 are the aggregators of the nodes, the last level is the root.
+    width[0] = (nodes + fan_in - 1) / fan_in;
+    nlevels = 1;
+    while (width[nlevels - 1] > 1 && nlevels < MAX_LEVELS)
+    {
+        width[nlevels] = (width[nlevels - 1] + fan_in - 1) / fan_in;
+        nlevels++;
+    }
+    if (width[nlevels - 1] != 1)
+    {
+        fprintf(stderr, "Error: too many levels, increase -k.\n");
+        return 1;
+    }
+    for (level = 0; level + 1 < nlevels; level++)
+    {
+        ninner += width[level];
+    }
+
+    // Every aggregator holds a socket per child.
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max)
+    {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    memset(&root_state, 0, sizeof(root_state));
+    root_state.interval_ms = interval_ms;
+    root_state.nodes = nodes;
+    root_state.first_bucket = UINT64_MAX;
+    make_address(root_addr, transport, nlevels - 1, 0);
+    if (variorum_agg_create(root_addr, NULL, interval_ms, 0, &root) != 0)
+    {
+        fprintf(stderr, "Error: cannot listen on %s.\n", root_addr);
+        return 1;
+    }
+    variorum_agg_set_callback(root, on_bucket, &root_state);
+
+    inner_pids = calloc(ninner + 1, sizeof(pid_t));
+    sim_pids = calloc(width[0], sizeof(pid_t));
+    for (level = 0; level < nlevels; level++)
+    {
+        addrs[level] = calloc(width[level], ADDR_LEN);
+        if (addrs[level] == NULL)
+        {
+            return 1;
+        }
+    }
+    snprintf(addrs[nlevels - 1], ADDR_LEN, "%s", variorum_agg_address(root));
+    if (inner_pids == NULL || sim_pids == NULL || pipe(report_pipe) != 0)
+    {
+        return 1;
+    }
+
+    // Start the inner aggregators top-down, so their parents exist.
+    ninner = 0;
+    for (level = nlevels - 1; level-- > 0;)
+    {
+        for (i = 0; i < width[level]; i++)
+        {
+            char addr[ADDR_LEN];
+            const char *parent = addrs[level + 1] + (i / fan_in) * ADDR_LEN;
+
+            make_address(addr, transport, level, i);
+            if (pipe(addr_pipe) != 0)
+            {
+                return 1;
+            }
+            inner_pids[ninner] = fork();
+            if (inner_pids[ninner] == 0)
+            {
+                close(addr_pipe[0]);
+                close(report_pipe[0]);
+                run_inner(addr, parent, interval_ms, addr_pipe[1], report_pipe[1]);
+            }
+            close(addr_pipe[1]);
+            if (read(addr_pipe[0], addrs[level] + i * ADDR_LEN, ADDR_LEN) !=
+                ADDR_LEN || addrs[level][i * ADDR_LEN] == '\0')
+            {
+                fprintf(stderr, "Error: aggregator %u of level %u failed.\n", i,
+                        level);
+                return 1;
+            }
+            close(addr_pipe[0]);
+            ninner++;
+            variorum_agg_run(root, 0);
+        }
+    }
+
+    // One process per aggregator of level 0 simulates its nodes.
+    nsims = nlevels > 1 ? width[0] : 1;
+    for (i = 0; i < nsims; i++)
+    {
+        unsigned first = i * fan_in;
+        unsigned count = nodes - first < fan_in ? nodes - first : fan_in;
+        const char *parent = nlevels > 1 ? addrs[0] + i * ADDR_LEN : addrs[0];
+
+        if (nlevels == 1)
+        {
+            count = nodes;
+        }
+        sim_pids[i] = fork();
+        if (sim_pids[i] == 0)
+        {
+            close(report_pipe[0]);
+            close(report_pipe[1]);
+            run_nodes(parent, first, count, interval_ms);
+        }
+    }
+    close(report_pipe[1]);
+
+    // Give the nodes a second to connect, then measure.
+    install_handler();
+    variorum_agg_run(root, 1000);
+    start = now_ms();
+    root_cpu_s = cpu_seconds(RUSAGE_SELF);
+    root_state.first_bucket = variorum_agg_bucket((uint64_t)start,
+                                                  interval_ms) + 1;
+    while (!stop && now_ms() < start + seconds * 1000.0)
+    {
+        variorum_agg_run(root, 100);
+    }
+    root_cpu_s = cpu_seconds(RUSAGE_SELF) - root_cpu_s;
+    variorum_agg_get_stats(root, &root_stats);
+
+    for (i = 0; i < nsims; i++)
+    {
+        kill(sim_pids[i], SIGTERM);
+        waitpid(sim_pids[i], NULL, 0);
+    }
+    memset(&total, 0, sizeof(total));
+    for (i = 0; i < ninner; i++)
+    {
+        kill(inner_pids[i], SIGTERM);
+    }
+    for (i = 0; i < ninner; i++)
+    {
+        if (read(report_pipe[0], &report, sizeof(report)) == sizeof(report))
+        {
+            total.messages += report.messages;
+            total.late += report.late;
+            total.cpu_s += report.cpu_s;
+            if (report.cpu_s > max_cpu_s)
+            {
+                max_cpu_s = report.cpu_s;
+            }
+        }
+    }
+    for (i = 0; i < ninner; i++)
+    {
+        waitpid(inner_pids[i], NULL, 0);
+    }
+    variorum_agg_destroy(root);
+
+    printf("nodes            %u\n", nodes);
+    printf("fan-in           %u\n", fan_in);
+    printf("levels           %u (%u inner aggregators)\n", nlevels, ninner);
+    printf("rate             %u Hz\n", rate);
+    printf("transport        %s\n", transport);
+    printf("buckets          %lu\n", root_state.buckets);
+    printf("complete         %lu (%0.1f%%)\n", root_state.complete,
+           root_state.buckets ? 100.0 * root_state.complete / root_state.buckets :
+           0.0);
+    if (root_state.nlatency > 0)
+    {
+        double sum = 0.0;
+
+        qsort(root_state.latency_ms, root_state.nlatency, sizeof(double),
+              compare_double);
+        for (i = 0; i < root_state.nlatency; i++)
+        {
+            sum += root_state.latency_ms[i];
+        }
+        printf("latency ms       mean %0.2f  p50 %0.2f  p99 %0.2f  max %0.2f\n",
+               sum / root_state.nlatency,
+               root_state.latency_ms[root_state.nlatency / 2],
+               root_state.latency_ms[root_state.nlatency * 99 / 100],
+               root_state.latency_ms[root_state.nlatency - 1]);
+    }
+    printf("root             %0.0f msgs/s, %0.2f%% CPU\n",
+           root_stats.messages / (seconds + 1.0), 100.0 * root_cpu_s / seconds);
+    if (ninner > 0)
+    {
+        printf("inner            %0.0f msgs/s total, %0.2f%% CPU mean, %0.2f%% max\n",
+               total.messages / (seconds + 1.0),
+               100.0 * total.cpu_s / ninner / (seconds + 1.0),
+               100.0 * max_cpu_s / (seconds + 1.0));
+    }
+    printf("late messages    %lu\n", root_stats.late + total.late);
+
+    for (level = 0; level < nlevels; level++)
+    {
+        free(addrs[level]);
+    }
+    free(root_state.latency_ms);
+    free(inner_pids);
+    free(sim_pids);
+    return 0;
+}
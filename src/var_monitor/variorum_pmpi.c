@@ -0,0 +1,795 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#define _GNU_SOURCE
+
+#include <mpi.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <variorum.h>
+#include <variorum_metrics.h>
+
+#include "pmpi_account.h"
+#include "profile.h"
+
+/* PMPI interposition library: linked before the MPI library or preloaded into
+ * an MPI application, it splits the wall time and the package energy of each
+ * rank into time spent inside MPI and time spent computing, per rank and per
+ * call site, and writes a job summary from rank 0 at MPI_Finalize.
+ *
+ * Only the first rank of each node (MPI_COMM_TYPE_SHARED) reads energy, from
+ * a helper thread, and publishes the node energy accumulated since MPI_Init
+ * and the power in a shared memory window. It reads only the energy counters,
+ * so the counters of the application are left alone. The other ranks read the
+ * window with plain loads, so the number of MSR reads does not grow with the
+ * number of ranks per node. Node energy is shared equally among the ranks of
+ * the node.
+ *
+ * Calls made from threads other than the one that initialized MPI are passed
+ * through without being accounted; their time counts as compute time of the
+ * rank, and their number is reported in the summary. It is configured with:
+ *
+ *   VARIORUM_PMPI_OUTPUT       summary file written by rank 0, or - for
+ *                              stdout (default = variorum_pmpi.dat)
+ *   VARIORUM_PMPI_INTERVAL_MS  energy reading interval (default = 100)
+ */
+
+#define DEFAULT_INTERVAL_MS 100
+
+static const char *pmpi_call_names[PMPI_NUM_CALLS] =
+{
+    "MPI_Send",
+    "MPI_Ssend",
+    "MPI_Bsend",
+    "MPI_Rsend",
+    "MPI_Recv",
+    "MPI_Sendrecv",
+    "MPI_Probe",
+    "MPI_Wait",
+    "MPI_Waitany",
+    "MPI_Waitsome",
+    "MPI_Waitall",
+    "MPI_Barrier",
+    "MPI_Bcast",
+    "MPI_Reduce",
+    "MPI_Allreduce",
+    "MPI_Gather",
+    "MPI_Gatherv",
+    "MPI_Scatter",
+    "MPI_Scatterv",
+    "MPI_Allgather",
+    "MPI_Allgatherv",
+    "MPI_Alltoall",
+    "MPI_Alltoallv",
+    "MPI_Reduce_scatter",
+    "MPI_Scan"
+};
+
+/// @brief Node energy published by the leader, protected by a sequence
+/// counter that is odd while the leader writes.
+struct pmpi_node
+{
+    uint64_t seq;
+    int have_energy;
+    double time;
+    double joules;
+    double watts;
+};
+
+static int pmpi_active = 0;
+// Per thread, as calls from other threads pass through while the main thread
+// is in a call under MPI_THREAD_MULTIPLE.
+static __thread int pmpi_depth = 0;
+static pthread_t pmpi_main_thread;
+// Calls from threads other than pmpi_main_thread, which are not accounted.
+static uint64_t pmpi_other_calls = 0;
+
+static MPI_Comm pmpi_node_comm = MPI_COMM_NULL;
+static MPI_Win pmpi_win = MPI_WIN_NULL;
+static struct pmpi_node *pmpi_node = NULL;
+static int pmpi_local_size = 1;
+static int pmpi_leader = 0;
+
+static pthread_t pmpi_reader;
+static int pmpi_reader_running = 0;
+static volatile int pmpi_reader_stop = 0;
+static unsigned pmpi_interval_ms = DEFAULT_INTERVAL_MS;
+static double pmpi_node_total_joules = 0.0;
+static double pmpi_node_last_reading = 0.0;
+
+static struct pmpi_account pmpi_acct;
+
+/// @brief Current time, in seconds of CLOCK_MONOTONIC, which is shared by
+/// all ranks of a node.
+static double pmpi_now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/// @brief Read the package energy of the node, summed over sockets, which
+/// does not wrap around.
+///
+/// @return 0 if successful, else -1 if the platform does not report it.
+static int pmpi_read_energy(double *joules)
+{
+    struct variorum_metric_vector metrics;
+    const struct variorum_metric *m;
+    int found = 0;
+    int ret;
+    size_t i;
+
+    *joules = 0.0;
+    variorum_metric_vector_init(&metrics);
+    profile_variorum_lock();
+    ret = variorum_get_energy_metrics(&metrics);
+    profile_variorum_unlock();
+    if (ret == 0)
+    {
+        for (i = 0; i < metrics.count; i++)
+        {
+            m = &metrics.metrics[i];
+            if (m->domain == VARIORUM_DOMAIN_SOCKET &&
+                strcmp(m->name, "energy_cpu_joules") == 0)
+            {
+                *joules += m->value;
+                found = 1;
+            }
+        }
+    }
+    variorum_metric_vector_free(&metrics);
+    return found ? 0 : -1;
+}
+
+static void pmpi_publish(double time, double joules, double watts)
+{
+    uint64_t seq = __atomic_load_n(&pmpi_node->seq, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&pmpi_node->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store(&pmpi_node->time, &time, __ATOMIC_RELAXED);
+    __atomic_store(&pmpi_node->joules, &joules, __ATOMIC_RELAXED);
+    __atomic_store(&pmpi_node->watts, &watts, __ATOMIC_RELAXED);
+    __atomic_store_n(&pmpi_node->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/// @brief Energy reader of the node leader. Only differences between
+/// readings are published, accumulated since MPI_Init.
+static void *pmpi_reader_main(void *arg)
+{
+    struct timespec interval;
+    double time;
+    double joules;
+    double delta = 0.0;
+    double last_time = pmpi_node->time;
+
+    (void)arg;
+    interval.tv_sec = pmpi_interval_ms / 1000;
+    interval.tv_nsec = (pmpi_interval_ms % 1000) * 1000000L;
+    while (!pmpi_reader_stop)
+    {
+        nanosleep(&interval, NULL);
+        if (pmpi_read_energy(&joules))
+        {
+            continue;
+        }
+        time = pmpi_now();
+        delta += pmpi_energy_add(&pmpi_node_total_joules, &pmpi_node_last_reading,
+                                 joules);
+        if (time > last_time)
+        {
+            pmpi_publish(time, pmpi_node_total_joules, delta / (time - last_time));
+            last_time = time;
+            delta = 0.0;
+        }
+    }
+    return NULL;
+}
+
+/// @brief Estimate the node energy at time now from the last reading of the
+/// leader and the power measured over its last interval.
+static double pmpi_node_joules(double now)
+{
+    uint64_t seq1;
+    uint64_t seq2;
+    double time;
+    double joules;
+    double watts;
+
+    if (pmpi_node == NULL || !pmpi_node->have_energy)
+    {
+        return 0.0;
+    }
+    do
+    {
+        seq1 = __atomic_load_n(&pmpi_node->seq, __ATOMIC_ACQUIRE);
+        __atomic_load(&pmpi_node->time, &time, __ATOMIC_RELAXED);
+        __atomic_load(&pmpi_node->joules, &joules, __ATOMIC_RELAXED);
+        __atomic_load(&pmpi_node->watts, &watts, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seq2 = __atomic_load_n(&pmpi_node->seq, __ATOMIC_RELAXED);
+    }
+    while ((seq1 & 1) || seq1 != seq2);
+
+    if (now > time)
+    {
+        joules += watts * (now - time);
+    }
+    return joules;
+}
+
+/// @brief Take the time and this rank's share of the node energy.
+static void pmpi_sample(double *time, double *joules)
+{
+    *time = pmpi_now();
+    *joules = pmpi_node_joules(*time) / pmpi_local_size;
+}
+
+/// @brief Enter an MPI call, closing the compute region that preceded it.
+///
+/// @return 1 if the call is accounted, else 0.
+static int pmpi_enter(double *time, double *joules)
+{
+    if (!pmpi_active || pmpi_depth++ > 0)
+    {
+        return 0;
+    }
+    if (!pthread_equal(pthread_self(), pmpi_main_thread))
+    {
+        __atomic_fetch_add(&pmpi_other_calls, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    pmpi_sample(time, joules);
+    *joules = pmpi_account_enter(&pmpi_acct, *time, *joules);
+    return 1;
+}
+
+static void pmpi_leave(int accounted, int call, void *ra, double time0,
+                       double joules0)
+{
+    double time;
+    double joules;
+
+    pmpi_depth--;
+    if (!accounted)
+    {
+        return;
+    }
+    pmpi_sample(&time, &joules);
+    pmpi_account_leave(&pmpi_acct, call, (uintptr_t)ra, time0, joules0, time,
+                       joules);
+}
+
+/* Wrap a blocking call: CALL is the enum suffix and the arguments follow the
+ * PMPI function.
+ */
+#define PMPI_WRAP(CALL, PMPI_FN, ...)                                        \
+    double time0 = 0.0;                                                     \
+    double joules0 = 0.0;                                                   \
+    int accounted = pmpi_enter(&time0, &joules0);                           \
+    int rc = PMPI_FN(__VA_ARGS__);                                          \
+    pmpi_leave(accounted, PMPI_CALL_##CALL, __builtin_return_address(0),    \
+               time0, joules0);                                             \
+    return rc
+
+static void pmpi_setup(void)
+{
+    MPI_Aint size;
+    int disp_unit;
+    int local_rank;
+    char *val;
+    void *base;
+    double time;
+    double joules;
+
+    val = getenv("VARIORUM_PMPI_INTERVAL_MS");
+    if (val != NULL && atoi(val) > 0)
+    {
+        pmpi_interval_ms = atoi(val);
+    }
+
+    PMPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL,
+                         &pmpi_node_comm);
+    PMPI_Comm_rank(pmpi_node_comm, &local_rank);
+    PMPI_Comm_size(pmpi_node_comm, &pmpi_local_size);
+    pmpi_leader = (local_rank == 0);
+
+    PMPI_Win_allocate_shared(pmpi_leader ? sizeof(struct pmpi_node) : 0, 1,
+                             MPI_INFO_NULL, pmpi_node_comm, &base, &pmpi_win);
+    PMPI_Win_shared_query(pmpi_win, 0, &size, &disp_unit, &pmpi_node);
+    PMPI_Win_lock_all(MPI_MODE_NOCHECK, pmpi_win);
+
+    if (pmpi_leader)
+    {
+        memset(pmpi_node, 0, sizeof(struct pmpi_node));
+        if (pmpi_read_energy(&joules) == 0)
+        {
+            pmpi_node->have_energy = 1;
+            pmpi_node_total_joules = 0.0;
+            pmpi_node_last_reading = joules;
+            pmpi_publish(pmpi_now(), 0.0, 0.0);
+            pmpi_reader_stop = 0;
+            if (pthread_create(&pmpi_reader, NULL, pmpi_reader_main, NULL) == 0)
+            {
+                pmpi_reader_running = 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "variorum_pmpi: energy is not available, reporting "
+                    "time only.\n");
+        }
+    }
+    PMPI_Win_sync(pmpi_win);
+    PMPI_Barrier(pmpi_node_comm);
+    PMPI_Win_sync(pmpi_win);
+
+    memset(&pmpi_acct.rank, 0, sizeof(pmpi_acct.rank));
+    PMPI_Get_processor_name(pmpi_acct.rank.host, &disp_unit);
+    pmpi_main_thread = pthread_self();
+    pmpi_sample(&time, &joules);
+    pmpi_account_start(&pmpi_acct, time, joules);
+    pmpi_active = 1;
+}
+
+static int pmpi_site_record_time_cmp(const void *a, const void *b)
+{
+    double ta = ((const struct pmpi_site_record *)a)->seconds;
+    double tb = ((const struct pmpi_site_record *)b)->seconds;
+
+    return (ta < tb) - (ta > tb);
+}
+
+/// @brief Name the local call sites after the function that made the call.
+static int pmpi_local_sites(struct pmpi_site_record **out)
+{
+    struct pmpi_site_record *recs;
+    struct profile prof;
+    char caller[PMPI_SITE_LEN - 20];
+    int have_maps;
+    int n = 0;
+    unsigned i;
+
+    recs = (struct pmpi_site_record *) calloc(PMPI_MAX_SITES + PMPI_NUM_CALLS,
+            sizeof(struct pmpi_site_record));
+    if (recs == NULL)
+    {
+        *out = NULL;
+        return 0;
+    }
+    have_maps = (profile_init(&prof) == 0);
+    if (have_maps)
+    {
+        profile_load_maps(&prof, "/proc/self/maps");
+    }
+    for (i = 0; i < PMPI_MAX_SITES + PMPI_NUM_CALLS; i++)
+    {
+        const struct pmpi_site *site = i < PMPI_MAX_SITES ? &pmpi_acct.sites[i] :
+                                       &pmpi_acct.other_sites[i - PMPI_MAX_SITES];
+        if (site->calls == 0)
+        {
+            continue;
+        }
+        if (i >= PMPI_MAX_SITES)
+        {
+            snprintf(caller, sizeof(caller), "[other]");
+        }
+        else if (have_maps)
+        {
+            // The return address may be past the end of the caller.
+            profile_symbolize(&prof, site->ra - 1, caller, sizeof(caller));
+        }
+        else
+        {
+            snprintf(caller, sizeof(caller), "[unknown]");
+        }
+        snprintf(recs[n].site, PMPI_SITE_LEN, "%s %s",
+                 pmpi_call_names[site->call], caller);
+        recs[n].calls = site->calls;
+        recs[n].seconds = site->seconds;
+        recs[n].joules = site->joules;
+        n++;
+    }
+    if (have_maps)
+    {
+        profile_free(&prof);
+    }
+    *out = recs;
+    return pmpi_merge_sites(recs, n);
+}
+
+static void pmpi_write_summary(FILE *fp, int nranks, int nnodes,
+                               double node_joules, int have_energy,
+                               uint64_t other_calls,
+                               const struct pmpi_rank_record *ranks,
+                               struct pmpi_site_record *sites, int nsites)
+{
+    double wall = 0.0;
+    double mpi_seconds = 0.0;
+    double mpi_joules = 0.0;
+    double joules = 0.0;
+    int i;
+
+    for (i = 0; i < nranks; i++)
+    {
+        if (ranks[i].mpi_seconds + ranks[i].compute_seconds > wall)
+        {
+            wall = ranks[i].mpi_seconds + ranks[i].compute_seconds;
+        }
+        mpi_seconds += ranks[i].mpi_seconds;
+        mpi_joules += ranks[i].mpi_joules;
+        joules += ranks[i].mpi_joules + ranks[i].compute_joules;
+    }
+
+    fprintf(fp, "# variorum_pmpi: %d ranks on %d nodes, %.6f s\n", nranks,
+            nnodes, wall);
+    if (have_energy)
+    {
+        fprintf(fp, "# package energy: %.6f J measured, %.6f J attributed, "
+                "%.1f%% in MPI\n", node_joules, joules,
+                joules > 0.0 ? 100.0 * mpi_joules / joules : 0.0);
+    }
+    else
+    {
+        fprintf(fp, "# package energy: not available\n");
+    }
+    fprintf(fp, "# time in MPI: %.1f%%\n",
+            wall > 0.0 ? 100.0 * mpi_seconds / (wall * nranks) : 0.0);
+    if (other_calls > 0)
+    {
+        fprintf(fp, "# MPI calls from other threads, not accounted: %llu\n",
+                (unsigned long long)other_calls);
+    }
+
+    fprintf(fp, "\nrank host mpi_calls mpi_seconds compute_seconds "
+            "mpi_joules compute_joules\n");
+    for (i = 0; i < nranks; i++)
+    {
+        fprintf(fp, "%d %s %.0f %.6f %.6f %.6f %.6f\n", i, ranks[i].host,
+                ranks[i].mpi_calls, ranks[i].mpi_seconds,
+                ranks[i].compute_seconds, ranks[i].mpi_joules,
+                ranks[i].compute_joules);
+    }
+
+    qsort(sites, nsites, sizeof(struct pmpi_site_record),
+          pmpi_site_record_time_cmp);
+    fprintf(fp, "\ncall caller calls seconds joules\n");
+    for (i = 0; i < nsites; i++)
+    {
+        fprintf(fp, "%s %.0f %.6f %.6f\n", sites[i].site, sites[i].calls,
+                sites[i].seconds, sites[i].joules);
+    }
+}
+
+static void pmpi_teardown(void)
+{
+    struct pmpi_rank_record *ranks = NULL;
+    struct pmpi_site_record *local_sites = NULL;
+    struct pmpi_site_record *sites = NULL;
+    int *counts = NULL;
+    int *displs = NULL;
+    double node_joules = 0.0;
+    double local_joules = 0.0;
+    uint64_t local_other_calls;
+    uint64_t other_calls = 0;
+    int have_energy;
+    int leaders;
+    int nlocal;
+    int nsites = 0;
+    int rank;
+    int nranks;
+    int i;
+    double time;
+    double joules;
+    const char *path;
+    FILE *fp;
+
+    // Close the last compute region.
+    pmpi_sample(&time, &joules);
+    pmpi_account_finish(&pmpi_acct, time, joules);
+    pmpi_active = 0;
+
+    PMPI_Barrier(pmpi_node_comm);
+    if (pmpi_leader && pmpi_node->have_energy)
+    {
+        pmpi_reader_stop = 1;
+        if (pmpi_reader_running)
+        {
+            pthread_join(pmpi_reader, NULL);
+            pmpi_reader_running = 0;
+        }
+        if (pmpi_read_energy(&joules) == 0)
+        {
+            pmpi_energy_add(&pmpi_node_total_joules, &pmpi_node_last_reading,
+                            joules);
+        }
+        local_joules = pmpi_node_total_joules;
+    }
+    have_energy = (pmpi_node != NULL && pmpi_node->have_energy);
+
+    PMPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    PMPI_Comm_size(MPI_COMM_WORLD, &nranks);
+    PMPI_Reduce(&local_joules, &node_joules, 1, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD);
+    PMPI_Reduce(&pmpi_leader, &leaders, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(&have_energy, &i, 1, MPI_INT, MPI_MIN, 0, MPI_COMM_WORLD);
+    have_energy = i;
+    local_other_calls = __atomic_load_n(&pmpi_other_calls, __ATOMIC_RELAXED);
+    PMPI_Reduce(&local_other_calls, &other_calls, 1, MPI_UINT64_T, MPI_SUM, 0,
+                MPI_COMM_WORLD);
+
+    if (rank == 0)
+    {
+        ranks = (struct pmpi_rank_record *) calloc(nranks,
+                sizeof(struct pmpi_rank_record));
+        counts = (int *) calloc(nranks, sizeof(int));
+        displs = (int *) calloc(nranks, sizeof(int));
+    }
+    PMPI_Gather(&pmpi_acct.rank, sizeof(struct pmpi_rank_record), MPI_BYTE, ranks,
+                sizeof(struct pmpi_rank_record), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    nlocal = pmpi_local_sites(&local_sites);
+    i = nlocal * (int)sizeof(struct pmpi_site_record);
+    PMPI_Gather(&i, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank == 0)
+    {
+        for (i = 0; i < nranks; i++)
+        {
+            displs[i] = nsites * (int)sizeof(struct pmpi_site_record);
+            nsites += counts[i] / (int)sizeof(struct pmpi_site_record);
+        }
+        sites = (struct pmpi_site_record *) calloc(nsites + 1,
+                sizeof(struct pmpi_site_record));
+    }
+    PMPI_Gatherv(local_sites, nlocal * (int)sizeof(struct pmpi_site_record),
+                 MPI_BYTE, sites, counts, displs, MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    if (rank == 0 && ranks != NULL && sites != NULL)
+    {
+        nsites = pmpi_merge_sites(sites, nsites);
+        path = getenv("VARIORUM_PMPI_OUTPUT");
+        if (path == NULL)
+        {
+            path = "variorum_pmpi.dat";
+        }
+        fp = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+        if (fp == NULL)
+        {
+            fprintf(stderr, "variorum_pmpi: cannot open %s.\n", path);
+        }
+        else
+        {
+            pmpi_write_summary(fp, nranks, leaders, node_joules, have_energy,
+                               other_calls, ranks, sites, nsites);
+            if (fp != stdout)
+            {
+                fclose(fp);
+            }
+        }
+    }
+
+    PMPI_Win_unlock_all(pmpi_win);
+    PMPI_Win_free(&pmpi_win);
+    pmpi_node = NULL;
+    PMPI_Comm_free(&pmpi_node_comm);
+    free(local_sites);
+    free(sites);
+    free(ranks);
+    free(counts);
+    free(displs);
+}
+
+int MPI_Init(int *argc, char ***argv)
+{
+    int rc = PMPI_Init(argc, argv);
+
+    if (rc == MPI_SUCCESS)
+    {
+        pmpi_setup();
+    }
+    return rc;
+}
+
+int MPI_Init_thread(int *argc, char ***argv, int required, int *provided)
+{
+    int rc = PMPI_Init_thread(argc, argv, required, provided);
+
+    if (rc == MPI_SUCCESS)
+    {
+        pmpi_setup();
+    }
+    return rc;
+}
+
+int MPI_Finalize(void)
+{
+    if (pmpi_active)
+    {
+        pmpi_teardown();
+    }
+    return PMPI_Finalize();
+}
+
+int MPI_Send(const void *buf, int count, MPI_Datatype datatype, int dest,
+             int tag, MPI_Comm comm)
+{
+    PMPI_WRAP(SEND, PMPI_Send, buf, count, datatype, dest, tag, comm);
+}
+
+int MPI_Ssend(const void *buf, int count, MPI_Datatype datatype, int dest,
+              int tag, MPI_Comm comm)
+{
+    PMPI_WRAP(SSEND, PMPI_Ssend, buf, count, datatype, dest, tag, comm);
+}
+
+int MPI_Bsend(const void *buf, int count, MPI_Datatype datatype, int dest,
+              int tag, MPI_Comm comm)
+{
+    PMPI_WRAP(BSEND, PMPI_Bsend, buf, count, datatype, dest, tag, comm);
+}
+
+int MPI_Rsend(const void *buf, int count, MPI_Datatype datatype, int dest,
+              int tag, MPI_Comm comm)
+{
+    PMPI_WRAP(RSEND, PMPI_Rsend, buf, count, datatype, dest, tag, comm);
+}
+
+int MPI_Recv(void *buf, int count, MPI_Datatype datatype, int source, int tag,
+             MPI_Comm comm, MPI_Status *status)
+{
+    PMPI_WRAP(RECV, PMPI_Recv, buf, count, datatype, source, tag, comm, status);
+}
+
+int MPI_Sendrecv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                 int dest, int sendtag, void *recvbuf, int recvcount,
+                 MPI_Datatype recvtype, int source, int recvtag, MPI_Comm comm,
+                 MPI_Status *status)
+{
+    PMPI_WRAP(SENDRECV, PMPI_Sendrecv, sendbuf, sendcount, sendtype, dest,
+              sendtag, recvbuf, recvcount, recvtype, source, recvtag, comm,
+              status);
+}
+
+int MPI_Probe(int source, int tag, MPI_Comm comm, MPI_Status *status)
+{
+    PMPI_WRAP(PROBE, PMPI_Probe, source, tag, comm, status);
+}
+
+int MPI_Wait(MPI_Request *request, MPI_Status *status)
+{
+    PMPI_WRAP(WAIT, PMPI_Wait, request, status);
+}
+
+int MPI_Waitany(int count, MPI_Request array_of_requests[], int *index,
+                MPI_Status *status)
+{
+    PMPI_WRAP(WAITANY, PMPI_Waitany, count, array_of_requests, index, status);
+}
+
+int MPI_Waitsome(int incount, MPI_Request array_of_requests[], int *outcount,
+                 int array_of_indices[], MPI_Status array_of_statuses[])
+{
+    PMPI_WRAP(WAITSOME, PMPI_Waitsome, incount, array_of_requests, outcount,
+              array_of_indices, array_of_statuses);
+}
+
+int MPI_Waitall(int count, MPI_Request array_of_requests[],
+                MPI_Status array_of_statuses[])
+{
+    PMPI_WRAP(WAITALL, PMPI_Waitall, count, array_of_requests,
+              array_of_statuses);
+}
+
+int MPI_Barrier(MPI_Comm comm)
+{
+    PMPI_WRAP(BARRIER, PMPI_Barrier, comm);
+}
+
+int MPI_Bcast(void *buffer, int count, MPI_Datatype datatype, int root,
+              MPI_Comm comm)
+{
+    PMPI_WRAP(BCAST, PMPI_Bcast, buffer, count, datatype, root, comm);
+}
+
+int MPI_Reduce(const void *sendbuf, void *recvbuf, int count,
+               MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm)
+{
+    PMPI_WRAP(REDUCE, PMPI_Reduce, sendbuf, recvbuf, count, datatype, op, root,
+              comm);
+}
+
+int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count,
+                  MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    PMPI_WRAP(ALLREDUCE, PMPI_Allreduce, sendbuf, recvbuf, count, datatype, op,
+              comm);
+}
+
+int MPI_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+               void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+               MPI_Comm comm)
+{
+    PMPI_WRAP(GATHER, PMPI_Gather, sendbuf, sendcount, sendtype, recvbuf,
+              recvcount, recvtype, root, comm);
+}
+
+int MPI_Gatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                void *recvbuf, const int recvcounts[], const int displs[],
+                MPI_Datatype recvtype, int root, MPI_Comm comm)
+{
+    PMPI_WRAP(GATHERV, PMPI_Gatherv, sendbuf, sendcount, sendtype, recvbuf,
+              recvcounts, displs, recvtype, root, comm);
+}
+
+int MPI_Scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+                MPI_Comm comm)
+{
+    PMPI_WRAP(SCATTER, PMPI_Scatter, sendbuf, sendcount, sendtype, recvbuf,
+              recvcount, recvtype, root, comm);
+}
+
+int MPI_Scatterv(const void *sendbuf, const int sendcounts[],
+                 const int displs[], MPI_Datatype sendtype, void *recvbuf,
+                 int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm)
+{
+    PMPI_WRAP(SCATTERV, PMPI_Scatterv, sendbuf, sendcounts, displs, sendtype,
+              recvbuf, recvcount, recvtype, root, comm);
+}
+
+int MPI_Allgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                  void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                  MPI_Comm comm)
+{
+    PMPI_WRAP(ALLGATHER, PMPI_Allgather, sendbuf, sendcount, sendtype, recvbuf,
+              recvcount, recvtype, comm);
+}
+
+int MPI_Allgatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                   void *recvbuf, const int recvcounts[], const int displs[],
+                   MPI_Datatype recvtype, MPI_Comm comm)
+{
+    PMPI_WRAP(ALLGATHERV, PMPI_Allgatherv, sendbuf, sendcount, sendtype,
+              recvbuf, recvcounts, displs, recvtype, comm);
+}
+
+int MPI_Alltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                 void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                 MPI_Comm comm)
+{
+    PMPI_WRAP(ALLTOALL, PMPI_Alltoall, sendbuf, sendcount, sendtype, recvbuf,
+              recvcount, recvtype, comm);
+}
+
+int MPI_Alltoallv(const void *sendbuf, const int sendcounts[],
+                  const int sdispls[], MPI_Datatype sendtype, void *recvbuf,
+                  const int recvcounts[], const int rdispls[],
+                  MPI_Datatype recvtype, MPI_Comm comm)
+{
+    PMPI_WRAP(ALLTOALLV, PMPI_Alltoallv, sendbuf, sendcounts, sdispls, sendtype,
+              recvbuf, recvcounts, rdispls, recvtype, comm);
+}
+
+int MPI_Reduce_scatter(const void *sendbuf, void *recvbuf,
+                       const int recvcounts[], MPI_Datatype datatype, MPI_Op op,
+                       MPI_Comm comm)
+{
+    PMPI_WRAP(REDUCE_SCATTER, PMPI_Reduce_scatter, sendbuf, recvbuf, recvcounts,
+              datatype, op, comm);
+}
+
+int MPI_Scan(const void *sendbuf, void *recvbuf, int count,
+             MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    PMPI_WRAP(SCAN, PMPI_Scan, sendbuf, recvbuf, count, datatype, op, comm);
+}
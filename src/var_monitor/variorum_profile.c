@@ -0,0 +1,284 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#define _GNU_SOURCE
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "profile.h"
+
+#define DEFAULT_INTERVAL_MS 100
+#define DEFAULT_CYCLES_PERIOD 10000000
+#define DEFAULT_TIMER_PERIOD_NS 1000000
+
+static FILE *open_output(const char *argv0, const char *hostname,
+                         const char *fname)
+{
+    FILE *fp;
+    int fd = open(fname, O_WRONLY | O_CREAT | O_EXCL | O_NOATIME | O_NDELAY,
+                  S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        fprintf(stderr,
+                "Fatal Error: %s on %s cannot open the appropriate fd for %s -- %s.\n", argv0,
+                hostname, fname, strerror(errno));
+        return NULL;
+    }
+    fp = fdopen(fd, "w");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Fatal Error: %s on %s fdopen failed for %s -- %s.\n", argv0,
+                hostname, fname, strerror(errno));
+        close(fd);
+    }
+    return fp;
+}
+
+int main(int argc, char **argv)
+{
+    const char *usage = "\n"
+                        "NAME\n"
+                        "    variorum_profile - Energy-attributing sampling profiler\n"
+                        "\n"
+                        "SYNOPSIS\n"
+                        "    variorum_profile [--help | -h] [OPTIONS]... -a \"executable [<exec-args>]\"\n"
+                        "\n"
+                        "OVERVIEW\n"
+                        "    The variorum_profile samples the call stacks of an application and\n"
+                        "    attributes the package and DRAM energy of each interval to the\n"
+                        "    functions sampled in it.\n"
+                        "\n"
+                        "REQUIRED\n"
+                        "    -a \"executable [<exec-args>]\"\n"
+                        "        Application and arguments surrounded by quotes.\n"
+                        "\n"
+                        "OPTIONS\n"
+                        "    --help | -h\n"
+                        "        Display this help information, then exit.\n"
+                        "\n"
+                        "    -p path_to_output\n"
+                        "        Path to store the profile.\n"
+                        "\n"
+                        "    -i ms_interval\n"
+                        "        Energy reading interval in milliseconds (default = 100ms).\n"
+                        "\n"
+                        "    -t\n"
+                        "        Sample on task clock instead of cycles, e.g., in virtual\n"
+                        "        machines without hardware counters. IPC is not reported.\n"
+                        "\n"
+                        "    -P period\n"
+                        "        Sampling period in cycles (default = 10000000), or in\n"
+                        "        nanoseconds with -t (default = 1000000).\n"
+                        "\n";
+
+    if (argc == 1 || (argc > 1 && (
+                          strncmp(argv[1], "--help", strlen("--help")) == 0 ||
+                          strncmp(argv[1], "-h", strlen("-h")) == 0)))
+    {
+        printf("%s", usage);
+        return 0;
+    }
+
+    int opt;
+    char *app = NULL;
+    char **arg = NULL;
+    char *logpath = NULL;
+    unsigned interval_ms = DEFAULT_INTERVAL_MS;
+    int use_timer = 0;
+    unsigned long long period = 0;
+
+    while ((opt = getopt(argc, argv, "a:p:i:tP:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'a':
+                app = optarg;
+                break;
+            case 'p':
+                logpath = strdup(optarg);
+                break;
+            case 'i':
+                interval_ms = atoi(optarg);
+                if (interval_ms == 0)
+                {
+                    interval_ms = DEFAULT_INTERVAL_MS;
+                }
+                break;
+            case 't':
+                use_timer = 1;
+                break;
+            case 'P':
+                period = strtoull(optarg, NULL, 10);
+                break;
+            case '?':
+                if (optopt == 'a' || optopt == 'p' || optopt == 'i' || optopt == 'P')
+                {
+                    fprintf(stderr, "Option -%c requires an argument.\n", optopt);
+                }
+                else if (isprint(optopt))
+                {
+                    fprintf(stderr, "\nError: unknown parameter \"-%c\"\n", optopt);
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown option character `\\x%x'.\n", optopt);
+                }
+                fprintf(stderr, "%s", usage);
+                return 1;
+            default:
+                return 1;
+        }
+    }
+
+    if (app == NULL)
+    {
+        printf("Error: Must specify -a flag with application and arguments in quotes.\n");
+        printf("%s", usage);
+        return 0;
+    }
+    if (period == 0)
+    {
+        period = use_timer ? DEFAULT_TIMER_PERIOD_NS : DEFAULT_CYCLES_PERIOD;
+    }
+
+    char *app_split = strtok(app, " ");
+    int n_spaces = 0;
+    while (app_split)
+    {
+        arg = realloc(arg, sizeof(char *) * ++n_spaces);
+        if (arg == NULL)
+        {
+            return 1; /* memory allocation failed */
+        }
+        arg[n_spaces - 1] = app_split;
+        app_split = strtok(NULL, " ");
+    }
+    arg = realloc(arg, sizeof(char *) * (n_spaces + 1));
+    arg[n_spaces] = 0;
+
+    /* The child waits on the pipe until the events are opened, and they start
+     * counting when it calls exec. */
+    int go[2];
+    char c = 0;
+    if (pipe(go))
+    {
+        fprintf(stderr, "%s: pipe failed -- %s.\n", argv[0], strerror(errno));
+        return 1;
+    }
+    pid_t app_pid = fork();
+    if (app_pid == 0)
+    {
+        /* I'm the child. */
+        close(go[1]);
+        if (read(go[0], &c, 1) != 1)
+        {
+            return 1;
+        }
+        close(go[0]);
+        execvp(arg[0], &arg[0]);
+        printf("Fork failure\n");
+        return 1;
+    }
+    close(go[0]);
+
+    struct profile_sampler sampler;
+    if (profile_sampler_start(&sampler, app_pid, use_timer, period, interval_ms,
+                              1))
+    {
+        fprintf(stderr,
+                "%s: cannot sample %s -- %s. Check perf_event_paranoid, or try -t.\n",
+                argv[0], arg[0], strerror(errno));
+        kill(app_pid, SIGKILL);
+        waitpid(app_pid, NULL, 0);
+        return 1;
+    }
+    printf("Profiling:");
+    int i;
+    for (i = 0; i < n_spaces; i++)
+    {
+        printf(" %s", arg[i]);
+    }
+    printf("\n");
+    fflush(stdout);
+    if (write(go[1], &c, 1) != 1)
+    {
+        fprintf(stderr, "%s: cannot start %s.\n", argv[0], arg[0]);
+    }
+    close(go[1]);
+
+    /* Wait. */
+    waitpid(app_pid, NULL, 0);
+    profile_sampler_stop(&sampler);
+
+    char hostname[64];
+    char *fname_dat = NULL;
+    char *fname_folded = NULL;
+    int rc;
+    gethostname(hostname, 64);
+    if (logpath)
+    {
+        rc = asprintf(&fname_dat, "%s/%s.variorum_profile.dat", logpath, hostname);
+        if (rc != -1)
+        {
+            rc = asprintf(&fname_folded, "%s/%s.variorum_profile.folded", logpath,
+                          hostname);
+        }
+    }
+    else
+    {
+        rc = asprintf(&fname_dat, "%s.variorum_profile.dat", hostname);
+        if (rc != -1)
+        {
+            rc = asprintf(&fname_folded, "%s.variorum_profile.folded", hostname);
+        }
+    }
+    if (rc == -1)
+    {
+        fprintf(stderr,
+                "%s:%d asprintf failed, perhaps out of memory.\n",
+                __FILE__, __LINE__);
+        return 1;
+    }
+
+    FILE *datfile = open_output(argv[0], hostname, fname_dat);
+    FILE *foldedfile = open_output(argv[0], hostname, fname_folded);
+    if (datfile == NULL || foldedfile == NULL)
+    {
+        return 1;
+    }
+    if (sampler.prof.lost > 0)
+    {
+        fprintf(stderr, "%s: %llu samples were lost, consider a larger -P.\n",
+                argv[0], (unsigned long long)sampler.prof.lost);
+    }
+    if (profile_write(&sampler.prof, datfile, foldedfile))
+    {
+        fprintf(stderr, "%s: writing the profile failed, perhaps out of memory.\n",
+                argv[0]);
+    }
+    fclose(datfile);
+    fclose(foldedfile);
+    profile_free(&sampler.prof);
+
+    printf("Output Files:\n"
+           "  %s\n"
+           "  %s\n\n", fname_dat, fname_folded);
+
+    free(fname_dat);
+    free(fname_folded);
+    free(logpath);
+    free(arg);
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "profile.h"
+
+/* Library mode of variorum_profile: preloaded into an application, it samples
+ * the process from its constructor to its destructor and symbolizes the
+ * samples with /proc/self/maps at exit. It is configured with:
+ *
+ *   VARIORUM_PROFILE_OUTPUT       prefix of the output files
+ *                                 (default = hostname.pid)
+ *   VARIORUM_PROFILE_INTERVAL_MS  energy reading interval (default = 100)
+ *   VARIORUM_PROFILE_TIMER        sample on task clock if set to 1
+ *   VARIORUM_PROFILE_PERIOD       sampling period in cycles, or in
+ *                                 nanoseconds with VARIORUM_PROFILE_TIMER
+ */
+
+#define DEFAULT_INTERVAL_MS 100
+#define DEFAULT_CYCLES_PERIOD 10000000
+#define DEFAULT_TIMER_PERIOD_NS 1000000
+
+static struct profile_sampler sampler;
+static pid_t owner = 0;
+
+__attribute__((constructor))
+static void variorum_profile_begin(void)
+{
+    char *val;
+    unsigned interval_ms = DEFAULT_INTERVAL_MS;
+    int use_timer = 0;
+    unsigned long long period = 0;
+
+    val = getenv("VARIORUM_PROFILE_INTERVAL_MS");
+    if (val != NULL && atoi(val) > 0)
+    {
+        interval_ms = atoi(val);
+    }
+    val = getenv("VARIORUM_PROFILE_TIMER");
+    if (val != NULL && atoi(val) == 1)
+    {
+        use_timer = 1;
+    }
+    val = getenv("VARIORUM_PROFILE_PERIOD");
+    if (val != NULL)
+    {
+        period = strtoull(val, NULL, 10);
+    }
+    if (period == 0)
+    {
+        period = use_timer ? DEFAULT_TIMER_PERIOD_NS : DEFAULT_CYCLES_PERIOD;
+    }
+
+    if (profile_sampler_start(&sampler, 0, use_timer, period, interval_ms, 0))
+    {
+        fprintf(stderr, "variorum_profile: cannot sample pid %d.\n", getpid());
+        return;
+    }
+    owner = getpid();
+}
+
+__attribute__((destructor))
+static void variorum_profile_end(void)
+{
+    char *prefix = getenv("VARIORUM_PROFILE_OUTPUT");
+    char *fname_dat = NULL;
+    char *fname_folded = NULL;
+    char hostname[64];
+    FILE *datfile;
+    FILE *foldedfile;
+    int rc;
+
+    // Forked children inherit the state but not the energy reader thread.
+    if (owner == 0 || owner != getpid())
+    {
+        return;
+    }
+    profile_sampler_stop(&sampler);
+    profile_load_maps(&sampler.prof, "/proc/self/maps");
+
+    gethostname(hostname, 64);
+    if (prefix)
+    {
+        rc = asprintf(&fname_dat, "%s.variorum_profile.dat", prefix);
+        if (rc != -1)
+        {
+            rc = asprintf(&fname_folded, "%s.variorum_profile.folded", prefix);
+        }
+    }
+    else
+    {
+        rc = asprintf(&fname_dat, "%s.%d.variorum_profile.dat", hostname, owner);
+        if (rc != -1)
+        {
+            rc = asprintf(&fname_folded, "%s.%d.variorum_profile.folded", hostname,
+                          owner);
+        }
+    }
+    if (rc == -1)
+    {
+        fprintf(stderr,
+                "%s:%d asprintf failed, perhaps out of memory.\n",
+                __FILE__, __LINE__);
+        profile_free(&sampler.prof);
+        return;
+    }
+
+    datfile = fopen(fname_dat, "w");
+    foldedfile = fopen(fname_folded, "w");
+    if (datfile == NULL || foldedfile == NULL)
+    {
+        fprintf(stderr, "variorum_profile: cannot open %s or %s.\n", fname_dat,
+                fname_folded);
+    }
+    else if (profile_write(&sampler.prof, datfile, foldedfile))
+    {
+        fprintf(stderr, "variorum_profile: writing the profile failed.\n");
+    }
+    if (datfile != NULL)
+    {
+        fclose(datfile);
+    }
+    if (foldedfile != NULL)
+    {
+        fclose(foldedfile);
+    }
+    profile_free(&sampler.prof);
+    free(fname_dat);
+    free(fname_folded);
+}
@@ -0,0 +1,123 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <ctype.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <variorum_shm.h>
+
+#define DEFAULT_INTERVAL_MS 100
+
+int main(int argc, char **argv)
+{
+    const char *usage = "\n"
+                        "NAME\n"
+                        "    variorum_publisher - Node-level shared-memory telemetry publisher\n"
+                        "\n"
+                        "SYNOPSIS\n"
+                        "    variorum_publisher [--help | -h] [OPTIONS]...\n"
+                        "\n"
+                        "OVERVIEW\n"
+                        "    The variorum_publisher samples all metrics of the node at a regular\n"
+                        "    interval and publishes the newest samples in /dev/shm/variorum.name,\n"
+                        "    where any number of local processes read them with\n"
+                        "    variorum_shm_attach() and variorum_shm_read(). Only one publisher\n"
+                        "    runs per node and name. It runs until interrupted.\n"
+                        "\n"
+                        "OPTIONS\n"
+                        "    --help | -h\n"
+                        "        Display this help information, then exit.\n"
+                        "\n"
+                        "    -n name\n"
+                        "        Region name (default = variorum).\n"
+                        "\n"
+                        "    -i ms_interval\n"
+                        "        Sampling interval in milliseconds (default = 100ms).\n"
+                        "\n"
+                        "    -H history\n"
+                        "        Number of samples kept in the region (default = 64).\n"
+                        "\n";
+
+    if (argc > 1 && (strncmp(argv[1], "--help", strlen("--help")) == 0 ||
+                     strncmp(argv[1], "-h", strlen("-h")) == 0))
+    {
+        printf("%s", usage);
+        return 0;
+    }
+
+    int opt;
+    int sig;
+    int rc;
+    char *name = NULL;
+    unsigned interval_ms = DEFAULT_INTERVAL_MS;
+    unsigned history = 0;
+    sigset_t signals;
+
+    while ((opt = getopt(argc, argv, "n:i:H:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                name = optarg;
+                break;
+            case 'i':
+                interval_ms = atoi(optarg);
+                if (interval_ms == 0)
+                {
+                    interval_ms = DEFAULT_INTERVAL_MS;
+                }
+                break;
+            case 'H':
+                history = atoi(optarg);
+                break;
+            case '?':
+                if (optopt == 'n' || optopt == 'i' || optopt == 'H')
+                {
+                    fprintf(stderr, "Option -%c requires an argument.\n", optopt);
+                }
+                else if (isprint(optopt))
+                {
+                    fprintf(stderr, "\nError: unknown parameter \"-%c\"\n", optopt);
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown option character `\\x%x'.\n", optopt);
+                }
+                fprintf(stderr, "%s", usage);
+                return 1;
+            default:
+                return 1;
+        }
+    }
+
+    // Block the signals before the publisher thread starts, so it inherits
+    // the mask and only the main thread receives them.
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    sigprocmask(SIG_BLOCK, &signals, NULL);
+
+    rc = variorum_shm_publish(name, interval_ms, history);
+    if (rc == 1)
+    {
+        fprintf(stderr, "%s: another process already publishes %s.\n", argv[0],
+                name != NULL ? name : VARIORUM_SHM_DEFAULT_NAME);
+        return 1;
+    }
+    if (rc != 0)
+    {
+        fprintf(stderr, "%s: cannot publish telemetry on this node.\n", argv[0]);
+        return 1;
+    }
+
+    sigwait(&signals, &sig);
+    variorum_shm_unpublish();
+    return 0;
+}
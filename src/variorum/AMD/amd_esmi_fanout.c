@@ -0,0 +1,217 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <e_smi/e_smi.h>
+
+#include "amd_esmi_fanout.h"
+
+/// @brief Block of cores handled by one worker.
+struct fanout_task
+{
+    enum esmi_core_op_e op;
+    int first;
+    int last;
+    uint32_t set_value;
+    struct esmi_core_result *results;
+};
+
+/// @brief Last boost limit successfully set on each core. Workers only touch
+/// their own block of cores, so no locking is needed.
+static struct
+{
+    uint32_t *value;
+    unsigned char *valid;
+    int ncores;
+} boost_cache = {NULL, NULL, 0};
+
+static int boost_cache_reserve(int ncores)
+{
+    uint32_t *value;
+    unsigned char *valid;
+
+    if (ncores <= boost_cache.ncores)
+    {
+        return 0;
+    }
+    value = (uint32_t *) calloc(ncores, sizeof(uint32_t));
+    valid = (unsigned char *) calloc(ncores, sizeof(unsigned char));
+    if (value == NULL || valid == NULL)
+    {
+        free(value);
+        free(valid);
+        return -1;
+    }
+    if (boost_cache.ncores > 0)
+    {
+        memcpy(value, boost_cache.value, boost_cache.ncores * sizeof(uint32_t));
+        memcpy(valid, boost_cache.valid, boost_cache.ncores);
+    }
+    free(boost_cache.value);
+    free(boost_cache.valid);
+    boost_cache.value = value;
+    boost_cache.valid = valid;
+    boost_cache.ncores = ncores;
+    return 0;
+}
+
+void esmi_boostlimit_cache_invalidate(void)
+{
+    if (boost_cache.valid != NULL)
+    {
+        memset(boost_cache.valid, 0, boost_cache.ncores);
+    }
+}
+
+static void run_core_op(struct fanout_task *t)
+{
+    struct esmi_core_result *r;
+    uint64_t energy;
+    uint32_t boostlimit;
+    int core;
+
+    for (core = t->first; core < t->last; core++)
+    {
+        r = &t->results[core];
+        r->skipped = 0;
+        switch (t->op)
+        {
+            case ESMI_CORE_ENERGY_GET:
+                energy = 0;
+                r->status = esmi_core_energy_get(core, &energy);
+                r->value = energy;
+                break;
+            case ESMI_CORE_BOOSTLIMIT_GET:
+                boostlimit = 0;
+                r->status = esmi_core_boostlimit_get(core, &boostlimit);
+                r->value = boostlimit;
+                break;
+            case ESMI_CORE_BOOSTLIMIT_SET:
+                r->value = t->set_value;
+                if (boost_cache.valid[core] && boost_cache.value[core] == t->set_value)
+                {
+                    r->status = ESMI_SUCCESS;
+                    r->skipped = 1;
+                    break;
+                }
+                r->status = esmi_core_boostlimit_set(core, t->set_value);
+                boost_cache.value[core] = t->set_value;
+                boost_cache.valid[core] = (r->status == ESMI_SUCCESS);
+                break;
+        }
+    }
+}
+
+static void *fanout_worker(void *arg)
+{
+    run_core_op((struct fanout_task *)arg);
+    return NULL;
+}
+
+int esmi_fanout_num_workers(int num_sockets, int ncores)
+{
+    char *val = getenv("VARIORUM_ESMI_WORKERS");
+    int nworkers = num_sockets;
+
+    if (val != NULL && atoi(val) > 0)
+    {
+        nworkers = atoi(val);
+    }
+    if (nworkers > ncores)
+    {
+        nworkers = ncores;
+    }
+    if (nworkers < 1)
+    {
+        nworkers = 1;
+    }
+    return nworkers;
+}
+
+int esmi_core_fanout(enum esmi_core_op_e op, int ncores, int nworkers,
+                     uint32_t set_value, struct esmi_core_result *results)
+{
+    struct fanout_task *tasks;
+    pthread_t *threads;
+    int *started;
+    int nfailed = 0;
+    int w;
+    int i;
+
+    if (ncores <= 0 || results == NULL)
+    {
+        return -1;
+    }
+    if (nworkers < 1)
+    {
+        nworkers = 1;
+    }
+    if (nworkers > ncores)
+    {
+        nworkers = ncores;
+    }
+    if (op == ESMI_CORE_BOOSTLIMIT_SET && boost_cache_reserve(ncores))
+    {
+        return -1;
+    }
+
+    tasks = (struct fanout_task *) malloc(nworkers * sizeof(struct fanout_task));
+    threads = (pthread_t *) malloc(nworkers * sizeof(pthread_t));
+    started = (int *) calloc(nworkers, sizeof(int));
+    if (tasks == NULL || threads == NULL || started == NULL)
+    {
+        free(tasks);
+        free(threads);
+        free(started);
+        return -1;
+    }
+
+    /* Cores are numbered contiguously within a socket (and within a CCD), so
+     * contiguous blocks keep each worker on one HSMP mailbox. */
+    for (w = 0; w < nworkers; w++)
+    {
+        tasks[w].op = op;
+        tasks[w].first = (int)((long)ncores * w / nworkers);
+        tasks[w].last = (int)((long)ncores * (w + 1) / nworkers);
+        tasks[w].set_value = set_value;
+        tasks[w].results = results;
+    }
+
+    /* The calling thread handles the first block. If a worker cannot be
+     * started, its block also runs on the calling thread. */
+    for (w = 1; w < nworkers; w++)
+    {
+        started[w] = (pthread_create(&threads[w], NULL, fanout_worker,
+                                     &tasks[w]) == 0);
+    }
+    run_core_op(&tasks[0]);
+    for (w = 1; w < nworkers; w++)
+    {
+        if (started[w])
+        {
+            pthread_join(threads[w], NULL);
+        }
+        else
+        {
+            run_core_op(&tasks[w]);
+        }
+    }
+
+    for (i = 0; i < ncores; i++)
+    {
+        if (results[i].status != ESMI_SUCCESS)
+        {
+            nfailed++;
+        }
+    }
+
+    free(tasks);
+    free(threads);
+    free(started);
+    return nfailed;
+}
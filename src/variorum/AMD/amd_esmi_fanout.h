@@ -0,0 +1,79 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef AMD_ESMI_FANOUT_H_INCLUDE
+#define AMD_ESMI_FANOUT_H_INCLUDE
+
+#include <stdint.h>
+
+/// @brief List of per-core E-SMI operations that can be fanned out.
+enum esmi_core_op_e
+{
+    /// @brief esmi_core_energy_get(), value in microjoules.
+    ESMI_CORE_ENERGY_GET,
+    /// @brief esmi_core_boostlimit_get(), value in MHz.
+    ESMI_CORE_BOOSTLIMIT_GET,
+    /// @brief esmi_core_boostlimit_set(), value in MHz.
+    ESMI_CORE_BOOSTLIMIT_SET,
+};
+
+/// @brief Outcome of one per-core E-SMI operation.
+struct esmi_core_result
+{
+    /// @brief Value read, or the value written for ESMI_CORE_BOOSTLIMIT_SET.
+    uint64_t value;
+    /// @brief E-SMI status (esmi_status_t) of the operation.
+    int status;
+    /// @brief Indicator that a write was skipped because the core already
+    /// holds the requested value.
+    int skipped;
+};
+
+/// @brief Determine the number of workers used to fan out per-core
+/// operations.
+///
+/// Defaults to one worker per socket. VARIORUM_ESMI_WORKERS overrides the
+/// default, e.g., to use one worker per CCD. The result is clamped to
+/// [1, ncores].
+///
+/// @param [in] num_sockets Number of sockets in the node.
+/// @param [in] ncores Total number of cores in the node.
+///
+/// @return Number of workers.
+int esmi_fanout_num_workers(
+    int num_sockets,
+    int ncores
+);
+
+/// @brief Run a per-core E-SMI operation on every core, spreading contiguous
+/// blocks of cores across a pool of worker threads.
+///
+/// Boost limit writes are deduplicated against the last value successfully
+/// set on each core. Results are reported per core, and nothing is printed,
+/// so callers report failures in core order.
+///
+/// @param [in] op Operation to run.
+/// @param [in] ncores Total number of cores in the node.
+/// @param [in] nworkers Number of workers, see esmi_fanout_num_workers().
+/// @param [in] set_value Value to write for ESMI_CORE_BOOSTLIMIT_SET.
+/// @param [out] results Array of ncores results, indexed by core.
+///
+/// @return Number of failed operations, or -1 if the executor could not be
+/// set up.
+int esmi_core_fanout(
+    enum esmi_core_op_e op,
+    int ncores,
+    int nworkers,
+    uint32_t set_value,
+    struct esmi_core_result *results
+);
+
+/// @brief Forget all cached boost limits, e.g., after a socket-wide boost
+/// limit was set.
+void esmi_boostlimit_cache_invalidate(
+    void
+);
+
+#endif
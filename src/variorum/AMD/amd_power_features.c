@@ -6,6 +6,8 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -13,6 +15,7 @@
 #include <variorum_error.h>
 
 #include "msr_core.h"
+#include "msr_soa.h"
 #include "amd_power_features.h"
 
 #ifdef LIBJUSTIFY_FOUND
@@ -170,3 +173,204 @@ int print_energy_data(FILE *writedest, off_t msr_rapl_unit,
 
     return 0;
 }
+
+static int cores_per_ccd(void)
+{
+    static int cpc = 0;
+    char *val;
+
+    if (cpc == 0)
+    {
+        cpc = AMD_DEFAULT_CORES_PER_CCD;
+        val = getenv("VARIORUM_AMD_CORES_PER_CCD");
+        if (val != NULL && atoi(val) > 0)
+        {
+            cpc = atoi(val);
+        }
+    }
+    return cpc;
+}
+
+static int core_power_storage(struct core_power_sampler **sampler,
+                              off_t msr_rapl_unit,
+                              off_t msr_core_energy_status)
+{
+    static struct core_power_sampler *cps = NULL;
+    uint64_t unit = 0;
+    unsigned ncores = 0;
+    unsigned i;
+
+    if (cps != NULL)
+    {
+        *sampler = cps;
+        return 0;
+    }
+
+#ifdef VARIORUM_WITH_AMD_CPU
+    variorum_get_topology(NULL, &ncores, NULL, P_AMD_CPU_IDX);
+#endif
+    if (ncores == 0)
+    {
+        return -1;
+    }
+
+    // The energy unit is shared by all cores and does not change at runtime.
+    if (read_msr_by_idx(0, msr_rapl_unit, &unit) != 0)
+    {
+        return -1;
+    }
+
+    cps = (struct core_power_sampler *) calloc(1,
+            sizeof(struct core_power_sampler));
+    cps->ncores = ncores;
+    cps->energy_unit = 1.0 / (double)(1UL << MASK_VAL(unit, 12, 8));
+    cps->core_bits = (uint64_t **) calloc(ncores, sizeof(uint64_t *));
+    cps->raw = (uint64_t *) msr_soa_alloc(ncores, sizeof(uint64_t));
+    cps->last_raw = (uint64_t *) msr_soa_alloc(ncores, sizeof(uint64_t));
+    cps->acc = (uint64_t *) msr_soa_alloc(ncores, sizeof(uint64_t));
+    cps->watts = (double *) msr_soa_alloc(ncores, sizeof(double));
+
+    // One operation per physical core; the energy counter is per core, so
+    // the SMT siblings would only return the same value.
+    allocate_batch(CORE_ENERGY_DATA, ncores);
+    for (i = 0; i < ncores; i++)
+    {
+        create_batch_op(msr_core_energy_status, i, &cps->core_bits[i],
+                        CORE_ENERGY_DATA);
+    }
+
+#ifdef VARIORUM_DEBUG
+    fprintf(stderr, "%s %s::%d DEBUG: (storage) initialized core power "
+            "sampler for %u cores at %p\n", getenv("HOSTNAME"), __FILE__,
+            __LINE__, ncores, cps);
+#endif
+    *sampler = cps;
+    return 0;
+}
+
+int sample_core_power(off_t msr_rapl_unit, off_t msr_core_energy_status,
+                      struct core_power_sampler **sampler)
+{
+    struct core_power_sampler *cps = NULL;
+    struct timeval now;
+    double elapsed;
+
+    if (core_power_storage(&cps, msr_rapl_unit, msr_core_energy_status))
+    {
+        variorum_error_handler("Could not set up per-core energy sampling",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+
+    read_batch(CORE_ENERGY_DATA);
+    gettimeofday(&now, NULL);
+
+    cps->prev_us = cps->now_us;
+    cps->now_us = now.tv_sec * (uint64_t)1000000 + now.tv_usec;
+    msr_soa_gather(cps->ncores, cps->core_bits, cps->raw);
+
+    // Masking differences to 32 bits handles a single wraparound of the
+    // counter between reads. On the first read last_raw and acc are zero, so
+    // the accumulators start at the current hardware count.
+    if (cps->nsamples > 0)
+    {
+        elapsed = (cps->now_us - cps->prev_us) / 1000000.0;
+        msr_soa_delta_scale(cps->ncores, msr_soa_mask(32),
+                            elapsed > 0 ? cps->energy_unit / elapsed : 0.0,
+                            cps->raw, cps->last_raw, cps->watts);
+    }
+    msr_soa_accumulate(cps->ncores, msr_soa_mask(32), cps->raw, cps->last_raw,
+                       cps->acc);
+    cps->nsamples++;
+
+    if (sampler != NULL)
+    {
+        *sampler = cps;
+    }
+    return 0;
+}
+
+void append_core_power_metrics(struct variorum_metric_vector *metrics,
+                                const struct core_power_sampler *cps,
+                                unsigned nsockets, unsigned cpc)
+{
+    unsigned cores_per_socket;
+    unsigned ccds_per_socket;
+    unsigned socket, first, last, ccd;
+    unsigned i;
+    double joules, watts;
+
+    if (nsockets == 0)
+    {
+        nsockets = 1;
+    }
+
+    for (i = 0; i < cps->ncores; i++)
+    {
+        variorum_metric_vector_append(metrics, "energy_cpu_joules",
+                                      VARIORUM_DOMAIN_CORE, i,
+                                      cps->acc[i] * cps->energy_unit,
+                                      cps->now_us);
+        if (cps->nsamples > 1)
+        {
+            variorum_metric_vector_append(metrics, "power_cpu_watts",
+                                          VARIORUM_DOMAIN_CORE, i,
+                                          cps->watts[i], cps->now_us);
+        }
+    }
+
+    // CCDs never span sockets, so number them per socket.
+    cores_per_socket = cps->ncores / nsockets;
+    ccds_per_socket = (cores_per_socket + cpc - 1) / cpc;
+    for (socket = 0; socket < nsockets; socket++)
+    {
+        for (ccd = 0; ccd < ccds_per_socket; ccd++)
+        {
+            first = socket * cores_per_socket + ccd * cpc;
+            last = first + cpc;
+            if (last > (socket + 1) * cores_per_socket)
+            {
+                last = (socket + 1) * cores_per_socket;
+            }
+
+            joules = 0.0;
+            watts = 0.0;
+            for (i = first; i < last; i++)
+            {
+                joules += cps->acc[i] * cps->energy_unit;
+                watts += cps->watts[i];
+            }
+
+            variorum_metric_vector_append(metrics, "energy_cpu_joules",
+                                          VARIORUM_DOMAIN_CCD,
+                                          socket * ccds_per_socket + ccd,
+                                          joules, cps->now_us);
+            if (cps->nsamples > 1)
+            {
+                variorum_metric_vector_append(metrics, "power_cpu_watts",
+                                              VARIORUM_DOMAIN_CCD,
+                                              socket * ccds_per_socket + ccd,
+                                              watts, cps->now_us);
+            }
+        }
+    }
+}
+
+int get_core_power_metrics(struct variorum_metric_vector *metrics,
+                           off_t msr_rapl_unit, off_t msr_core_energy_status)
+{
+    struct core_power_sampler *cps = NULL;
+    unsigned nsockets = 0;
+
+    if (sample_core_power(msr_rapl_unit, msr_core_energy_status, &cps))
+    {
+        return -1;
+    }
+
+#ifdef VARIORUM_WITH_AMD_CPU
+    variorum_get_topology(&nsockets, NULL, NULL, P_AMD_CPU_IDX);
+#endif
+    append_core_power_metrics(metrics, cps, nsockets, cores_per_ccd());
+    return 0;
+}
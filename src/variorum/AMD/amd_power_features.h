@@ -8,8 +8,15 @@
 
 #include <linux/types.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <sys/types.h>
 
+#include <variorum_metrics.h>
+
+/// @brief Default number of cores per core complex die (CCD) on family 19h
+/// processors, overridden by VARIORUM_AMD_CORES_PER_CCD.
+#define AMD_DEFAULT_CORES_PER_CCD 8
+
 struct rapl_units
 {
     /// @brief Raw 64-bit value stored in MSR_RAPL_POWER_UNIT.
@@ -32,10 +39,91 @@ struct rapl_data
     double *core_joules;
 };
 
+/// @brief Per-core energy and power derived from successive reads of the
+/// 32-bit MSR_CORE_ENERGY_STATUS counters.
+///
+/// All arrays come from msr_soa_alloc() and are indexed by core, so each
+/// sample is updated for every core with the msr_soa kernels.
+struct core_power_sampler
+{
+    /// @brief Number of physical cores sampled.
+    unsigned ncores;
+    /// @brief Raw 64-bit values filled in by the CORE_ENERGY_DATA batch.
+    uint64_t **core_bits;
+    /// @brief Contiguous copy of each counter from the current read.
+    uint64_t *raw;
+    /// @brief Each counter from the previous read.
+    uint64_t *last_raw;
+    /// @brief Energy in ESU extended to 64 bits across counter wraparound.
+    uint64_t *acc;
+    /// @brief Average power in Watts between the last two reads.
+    double *watts;
+    /// @brief Joules per ESU, read once from MSR_RAPL_POWER_UNIT.
+    double energy_unit;
+    /// @brief Time of the current read, in microseconds since the epoch.
+    uint64_t now_us;
+    /// @brief Time of the previous read, in microseconds since the epoch.
+    uint64_t prev_us;
+    /// @brief Number of reads taken so far.
+    uint64_t nsamples;
+};
+
 int print_energy_data(
     FILE *writedest,
     off_t msr_rapl_unit,
     off_t msr_core_energy_status
 );
 
+/// @brief Read the energy counters of every core and update the 64-bit
+/// accumulators and per-core power.
+///
+/// The first call sets up the batch and reads the energy unit; later calls
+/// only issue the batch read. Power is available from the second call on.
+///
+/// @param [in] msr_rapl_unit Unique MSR address for MSR_RAPL_POWER_UNIT.
+/// @param [in] msr_core_energy_status Unique MSR address for
+///        MSR_CORE_ENERGY_STATUS.
+/// @param [out] sampler Pointer to the internal sampler state.
+///
+/// @return 0 if successful, else -1
+int sample_core_power(
+    off_t msr_rapl_unit,
+    off_t msr_core_energy_status,
+    struct core_power_sampler **sampler
+);
+
+/// @brief Append the energy and power of every core of a sample, then their
+/// sums over each CCD, to a metric vector.
+///
+/// Cores are split evenly among the sockets, and the cores of a socket into
+/// CCDs of cpc cores, the last of which may be smaller. CCDs never
+/// span sockets and are numbered across sockets. Power is appended from the
+/// second sample on.
+///
+/// @param [in,out] metrics Metric vector.
+/// @param [in] cps Sampler state after sample_core_power().
+/// @param [in] nsockets Number of sockets, 0 is taken as 1.
+/// @param [in] cpc Number of cores per CCD, at least 1.
+void append_core_power_metrics(
+    struct variorum_metric_vector *metrics,
+    const struct core_power_sampler *cps,
+    unsigned nsockets,
+    unsigned cpc
+);
+
+/// @brief Take one per-core sample and append per-core and per-CCD energy
+/// and power to a metric vector.
+///
+/// @param [in,out] metrics Metric vector.
+/// @param [in] msr_rapl_unit Unique MSR address for MSR_RAPL_POWER_UNIT.
+/// @param [in] msr_core_energy_status Unique MSR address for
+///        MSR_CORE_ENERGY_STATUS.
+///
+/// @return 0 if successful, else -1
+int get_core_power_metrics(
+    struct variorum_metric_vector *metrics,
+    off_t msr_rapl_unit,
+    off_t msr_core_energy_status
+);
+
 #endif
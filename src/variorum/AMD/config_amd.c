@@ -80,11 +80,13 @@ int set_amd_func_ptrs(int idx)
             g_platform[idx].variorum_get_node_power_domain_info_json =
                 amd_cpu_epyc_get_node_power_domain_info_json;
             g_platform[idx].variorum_get_frequency_json = amd_cpu_epyc_get_json_boostlimit;
+            g_platform[idx].variorum_get_metrics = amd_cpu_epyc_get_metrics;
             break;
         default:
             fprintf(stdout, "ESMI not initialized, drivers not found. "
                     "Msg[%d]: %s\n", ret, esmi_get_err_msg(ret));
             g_platform[idx].variorum_print_energy = amd_cpu_epyc_print_energy;
+            g_platform[idx].variorum_get_metrics = amd_cpu_epyc_get_metrics;
             ret = 0;
     }
     return ret;
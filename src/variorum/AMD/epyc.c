@@ -15,6 +15,7 @@
 #include <e_smi/e_smi.h>
 
 #include "msr_core.h"
+#include "amd_esmi_fanout.h"
 #include "amd_power_features.h"
 
 #ifdef LIBJUSTIFY_FOUND
@@ -380,7 +381,10 @@ int amd_cpu_epyc_print_energy(int long_ver)
     if (!esmi_init() && long_ver == 0)
     {
         int i;
+        int nsockets = 0;
+        int ncores = 0;
         uint64_t energy;
+        struct esmi_core_result *results;
 
         fprintf(stdout, "_SOCKET_ENERGY :\n");
 #ifdef LIBJUSTIFY_FOUND
@@ -423,11 +427,31 @@ int amd_cpu_epyc_print_energy(int long_ver)
 #endif
 
 #ifdef VARIORUM_WITH_AMD_CPU
-        for (i = 0; i < g_platform[P_AMD_CPU_IDX].total_cores; i++)
+        nsockets = g_platform[P_AMD_CPU_IDX].num_sockets;
+        ncores = g_platform[P_AMD_CPU_IDX].total_cores;
 #endif
+        results = (struct esmi_core_result *) calloc(ncores,
+                  sizeof(struct esmi_core_result));
+        if (results == NULL)
         {
-            energy = 0;
-            ret = esmi_core_energy_get(i, &energy);
+            variorum_error_handler("Could not allocate memory for core results",
+                                   VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
+                                   __FILE__, __FUNCTION__, __LINE__);
+            return -1;
+        }
+        if (esmi_core_fanout(ESMI_CORE_ENERGY_GET, ncores,
+                             esmi_fanout_num_workers(nsockets, ncores), 0, results) < 0)
+        {
+            variorum_error_handler("Could not query the core energies",
+                                   VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"),
+                                   __FILE__, __FUNCTION__, __LINE__);
+            free(results);
+            return -1;
+        }
+
+        for (i = 0; i < ncores; i++)
+        {
+            ret = results[i].status;
             if (ret != 0)
             {
                 fprintf(stdout, "Failed to get core[%d] _COREENERGY, Err[%d]:%s\n",
@@ -438,13 +462,14 @@ int amd_cpu_epyc_print_energy(int long_ver)
             {
 #if LIBJUSTIFY_FOUND
                 cfprintf(stdout, "%d |  %.06f |\n",
-                         i, (double)energy / 1000000);
+                         i, (double)results[i].value / 1000000);
 #else
                 fprintf(stdout, " %6d | %17.06f | \n",
-                        i, (double)energy / 1000000);
+                        i, (double)results[i].value / 1000000);
 #endif
             }
         }
+        free(results);
         return 0;
     }
 energy_batch:
@@ -463,7 +488,32 @@ int amd_cpu_epyc_print_boostlimit(int long_ver)
     }
 
     int i, ret;
-    uint32_t boostlimit;
+    int nsockets = 0;
+    int ncores = 0;
+    struct esmi_core_result *results;
+
+#ifdef VARIORUM_WITH_AMD_CPU
+    nsockets = g_platform[P_AMD_CPU_IDX].num_sockets;
+    ncores = g_platform[P_AMD_CPU_IDX].total_cores;
+#endif
+    results = (struct esmi_core_result *) calloc(ncores,
+              sizeof(struct esmi_core_result));
+    if (results == NULL)
+    {
+        variorum_error_handler("Could not allocate memory for core results",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    if (esmi_core_fanout(ESMI_CORE_BOOSTLIMIT_GET, ncores,
+                         esmi_fanout_num_workers(nsockets, ncores), 0, results) < 0)
+    {
+        variorum_error_handler("Could not query the core boost limits",
+                               VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        free(results);
+        return -1;
+    }
 
 #ifdef LIBJUSTIFY_FOUND
     cfprintf(stdout, "%s |  %s  |\n", "Core", "Freq(MHz)");
@@ -471,27 +521,26 @@ int amd_cpu_epyc_print_boostlimit(int long_ver)
     fprintf(stdout, " Core   | Freq (MHz)  |\n");
 #endif
 
-#ifdef VARIORUM_WITH_AMD_CPU
-    for (i = 0; i < g_platform[P_AMD_CPU_IDX].total_cores; i++)
-#endif
+    for (i = 0; i < ncores; i++)
     {
-        boostlimit = 0;
-        ret = esmi_core_boostlimit_get(i, &boostlimit);
+        ret = results[i].status;
         if (ret != 0)
         {
             fprintf(stdout, "Failed to get core[%u] _BOOSTLIMIT, Err[%d]:%s\n",
                     i, ret, esmi_get_err_msg(ret));
+            free(results);
             return ret;
         }
         else
         {
 #ifdef LIBJUSTIFY_FOUND
-            cfprintf(stdout, "%d |  %u  |\n", i, boostlimit);
+            cfprintf(stdout, "%d |  %u  |\n", i, (uint32_t)results[i].value);
 #else
-            fprintf(stdout, "%6d  | %10u  |\n", i, boostlimit);
+            fprintf(stdout, "%6d  | %10u  |\n", i, (uint32_t)results[i].value);
 #endif
         }
     }
+    free(results);
 
 #ifdef LIBJUSTIFY_FOUND
     cflush();
@@ -508,14 +557,33 @@ int amd_cpu_epyc_get_json_boostlimit(json_t *get_clock_obj_json)
         printf("Running %s\n\n", __FUNCTION__);
     }
 
-    int socket, core,  ret;
-    uint32_t boostlimit;
+    int socket, core;
+    struct esmi_core_result *results;
 
     int num_sockets = g_platform[P_AMD_CPU_IDX].num_sockets;
     int total_cores = g_platform[P_AMD_CPU_IDX].total_cores;
     int cores_per_socket = total_cores / num_sockets;
     int current_core = 0;
 
+    results = (struct esmi_core_result *) calloc(total_cores,
+              sizeof(struct esmi_core_result));
+    if (results == NULL)
+    {
+        variorum_error_handler("Could not allocate memory for core results",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    if (esmi_core_fanout(ESMI_CORE_BOOSTLIMIT_GET, total_cores,
+                         esmi_fanout_num_workers(num_sockets, total_cores), 0, results) < 0)
+    {
+        variorum_error_handler("Could not query the core boost limits",
+                               VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        free(results);
+        return -1;
+    }
+
     for (socket = 0; socket < num_sockets; ++socket)
     {
         char socket_name[16];
@@ -535,13 +603,15 @@ int amd_cpu_epyc_get_json_boostlimit(json_t *get_clock_obj_json)
 
         for (core = 0; core < cores_per_socket; ++core)
         {
-            ret = esmi_core_boostlimit_get(current_core, &boostlimit);
             char core_avg_string[24];
             snprintf(core_avg_string, 24, "core_%d_avg_freq_mhz", current_core);
-            json_object_set_new(core_obj, core_avg_string, json_real(boostlimit));
+            json_object_set_new(core_obj, core_avg_string,
+                                json_real(results[current_core].status == 0 ?
+                                          (double)results[current_core].value : -1.0));
             current_core++;
         }
     }
+    free(results);
     return 0;
 }
 
@@ -554,25 +624,53 @@ int amd_cpu_epyc_set_each_core_boostlimit(int boostlimit)
     }
 
     int i, ret;
+    int nsockets = 0;
+    int ncores = 0;
+    int permission_denied = 0;
+    struct esmi_core_result *results;
 
 #ifdef VARIORUM_WITH_AMD_CPU
-    for (i = 0; i < g_platform[P_AMD_CPU_IDX].total_cores; i++)
+    nsockets = g_platform[P_AMD_CPU_IDX].num_sockets;
+    ncores = g_platform[P_AMD_CPU_IDX].total_cores;
 #endif
+    results = (struct esmi_core_result *) calloc(ncores,
+              sizeof(struct esmi_core_result));
+    if (results == NULL)
+    {
+        variorum_error_handler("Could not allocate memory for core results",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    /* Cores already at the requested limit are skipped. */
+    if (esmi_core_fanout(ESMI_CORE_BOOSTLIMIT_SET, ncores,
+                         esmi_fanout_num_workers(nsockets, ncores), boostlimit, results) < 0)
+    {
+        variorum_error_handler("Could not set the core boost limits",
+                               VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        free(results);
+        return -1;
+    }
+
+    for (i = 0; i < ncores; i++)
     {
-        ret = esmi_core_boostlimit_set(i, boostlimit);
+        ret = results[i].status;
         if (ret != 0)
         {
             fprintf(stdout, "Failed to set core[%u] _BOOSTLIMIT, Err[%d]:%s\n",
                     i, ret, esmi_get_err_msg(ret));
-            if (ret == ESMI_PERMISSION)
-            {
-                variorum_error_handler("Incorrect permissions",
-                                       VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
-                                       __FILE__, __FUNCTION__, __LINE__);
-                return -1;
-            }
+            permission_denied |= (ret == ESMI_PERMISSION);
         }
     }
+    free(results);
+    if (permission_denied)
+    {
+        variorum_error_handler("Incorrect permissions",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
 
 #ifdef VARIORUM_DEBUG
     fprintf(stdout, "Values are input:%2u MHz\n",
@@ -650,6 +748,8 @@ int amd_cpu_epyc_set_socket_boostlimit(int socket, int boostlimit)
     }
     int ret;
 
+    /* A socket-wide limit overrides the per-core limits. */
+    esmi_boostlimit_cache_invalidate();
     ret = esmi_socket_boostlimit_set(socket, boostlimit);
     if (ret != 0)
     {
@@ -785,3 +885,15 @@ int amd_cpu_epyc_get_node_power_domain_info_json(char **get_domain_obj_str)
 
     return 0;
 }
+
+int amd_cpu_epyc_get_metrics(struct variorum_metric_vector *metrics)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return get_core_power_metrics(metrics, msrs.msr_rapl_power_unit,
+                                  msrs.msr_core_energy_stat);
+}
@@ -17,17 +17,18 @@
 #include <cprintf.h>
 #endif
 
-void get_power_data(int chipid, int total_sockets, int verbose, FILE *output)
+uint32_t m_num_devices = 0;
+static int m_rsmi_initialized = 0;
+static int m_rsmi_atexit = 0;
+
+int initRSMI(void)
 {
     rsmi_status_t ret;
-    uint32_t num_devices;
-    int gpus_per_socket;
-    char hostname[1024];
-    static int init = 0;
-    static struct timeval start;
-    struct timeval now;
 
-    gethostname(hostname, 1024);
+    if (m_rsmi_initialized)
+    {
+        return 0;
+    }
 
     ret = rsmi_init(0);
     if (ret != RSMI_STATUS_SUCCESS)
@@ -36,19 +37,195 @@ void get_power_data(int chipid, int total_sockets, int verbose, FILE *output)
                                VARIORUM_ERROR_PLATFORM_ENV,
                                getenv("HOSTNAME"), __FILE__, __FUNCTION__,
                                __LINE__);
-        exit(-1);
+        return -1;
     }
 
-    ret = rsmi_num_monitor_devices(&num_devices);
+    ret = rsmi_num_monitor_devices(&m_num_devices);
     if (ret != RSMI_STATUS_SUCCESS)
     {
         variorum_error_handler("Could not get number of GPU devices",
                                VARIORUM_ERROR_PLATFORM_ENV,
                                getenv("HOSTNAME"), __FILE__, __FUNCTION__,
                                __LINE__);
+        m_num_devices = 0;
+    }
+
+    if (!m_rsmi_atexit)
+    {
+        atexit(shutdownRSMI);
+        m_rsmi_atexit = 1;
+    }
+    m_rsmi_initialized = 1;
+    return 0;
+}
+
+void shutdownRSMI(void)
+{
+    rsmi_status_t ret;
+
+    if (!m_rsmi_initialized)
+    {
+        return;
+    }
+
+    ret = rsmi_shut_down();
+    if (ret != RSMI_STATUS_SUCCESS)
+    {
+        variorum_error_handler("Could not shutdown RSMI",
+                               VARIORUM_ERROR_PLATFORM_ENV,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
+                               __LINE__);
+    }
+    m_rsmi_initialized = 0;
+    m_num_devices = 0;
+}
+
+int sample_all_gpu_data(struct amd_gpu_sample **samples)
+{
+    static struct amd_gpu_sample *s = NULL;
+    static uint32_t allocated = 0;
+    rsmi_status_t ret;
+    RSMI_POWER_TYPE pwr_type;
+    rsmi_frequencies_t freq;
+    uint64_t pwr_val;
+    int64_t temp_val;
+    uint32_t i;
+    int err = 0;
+
+    if (initRSMI())
+    {
+        return -1;
+    }
+
+    if (allocated < m_num_devices)
+    {
+        free(s);
+        s = (struct amd_gpu_sample *) calloc(m_num_devices,
+                                             sizeof(struct amd_gpu_sample));
+        if (s == NULL)
+        {
+            allocated = 0;
+            return -1;
+        }
+        allocated = m_num_devices;
+    }
+
+    /* Gather every metric for every device in a single pass. */
+    for (i = 0; i < m_num_devices; i++)
+    {
+        pwr_val = 0;
+        pwr_type = RSMI_AVERAGE_POWER;
+        ret = rsmi_dev_power_get(i, &pwr_val, &pwr_type);
+        err |= (ret != RSMI_STATUS_SUCCESS);
+        s[i].power_watts = (double)pwr_val / (1000 * 1000); // Convert to Watts.
+
+        temp_val = 0;
+        ret = rsmi_dev_temp_metric_get(i, RSMI_TEMP_TYPE_EDGE, RSMI_TEMP_CURRENT,
+                                       &temp_val);
+        err |= (ret != RSMI_STATUS_SUCCESS);
+        s[i].temp_celsius = (double)temp_val / 1000; // Convert to Celcius.
+
+        ret = rsmi_dev_gpu_clk_freq_get(i, RSMI_CLK_TYPE_SYS, &freq);
+        err |= (ret != RSMI_STATUS_SUCCESS);
+        s[i].sys_clock_mhz = (ret == RSMI_STATUS_SUCCESS) ?
+                             freq.frequency[freq.current] / (1000 * 1000) : 0; // Convert to MHz
+
+        ret = rsmi_dev_gpu_clk_freq_get(i, RSMI_CLK_TYPE_MEM, &freq);
+        err |= (ret != RSMI_STATUS_SUCCESS);
+        s[i].mem_clock_mhz = (ret == RSMI_STATUS_SUCCESS) ?
+                             freq.frequency[freq.current] / (1000 * 1000) : 0; // Convert to MHz
+
+        s[i].util_percent = 0;
+        ret = rsmi_dev_busy_percent_get(i, &s[i].util_percent);
+        err |= (ret != RSMI_STATUS_SUCCESS);
+    }
+
+    if (err)
+    {
+        variorum_error_handler("RSMI API was not successful",
+                               VARIORUM_ERROR_PLATFORM_ENV,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
+                               __LINE__);
+    }
+
+    if (samples != NULL)
+    {
+        *samples = s;
+    }
+    return 0;
+}
+
+void get_all_gpu_data(int total_sockets, FILE *output)
+{
+    struct amd_gpu_sample *samples = NULL;
+    int gpus_per_socket;
+    char hostname[1024];
+    static int init = 0;
+    uint32_t i;
+
+    gethostname(hostname, 1024);
+
+    if (sample_all_gpu_data(&samples))
+    {
+        return;
     }
 
-    gpus_per_socket = num_devices / total_sockets;
+    gpus_per_socket = m_num_devices / total_sockets;
+
+    if (!init)
+    {
+        init = 1;
+#ifdef LIBJUSTIFY_FOUND
+        cfprintf(output, "%s %s %s %s %s %s %s %s %s %s\n",
+                 "_AMD_GPU_MONITOR", "Host", "Timestamp_ms", "Socket", "DeviceID",
+                 "Power", "Temperature", "SystemClock_MHz", "MemoryClock_MHz", "Util");
+#else
+        fprintf(output,
+                "_AMD_GPU_MONITOR Host Timestamp_ms Socket DeviceID Power "
+                "Temperature SystemClock_MHz MemoryClock_MHz Util\n");
+#endif
+    }
+
+    for (i = 0; i < m_num_devices; i++)
+    {
+#ifdef LIBJUSTIFY_FOUND
+        cfprintf(output, "%s %s %ld %d %d %0.2lf %0.2lf %d %d %d\n",
+                 "_AMD_GPU_MONITOR", hostname, now_ms(),
+                 gpus_per_socket > 0 ? (int)i / gpus_per_socket : 0, i,
+                 samples[i].power_watts, samples[i].temp_celsius,
+                 samples[i].sys_clock_mhz, samples[i].mem_clock_mhz,
+                 samples[i].util_percent);
+#else
+        fprintf(output, "%s %s %ld %d %d %0.2lf %0.2lf %d %d %d\n",
+                "_AMD_GPU_MONITOR", hostname, now_ms(),
+                gpus_per_socket > 0 ? (int)i / gpus_per_socket : 0, i,
+                samples[i].power_watts, samples[i].temp_celsius,
+                samples[i].sys_clock_mhz, samples[i].mem_clock_mhz,
+                samples[i].util_percent);
+#endif
+    }
+#ifdef LIBJUSTIFY_FOUND
+    cflush();
+#endif
+}
+
+void get_power_data(int chipid, int total_sockets, int verbose, FILE *output)
+{
+    rsmi_status_t ret;
+    int gpus_per_socket;
+    char hostname[1024];
+    static int init = 0;
+    static struct timeval start;
+    struct timeval now;
+
+    gethostname(hostname, 1024);
+
+    if (initRSMI())
+    {
+        return;
+    }
+
+    gpus_per_socket = m_num_devices / total_sockets;
 
     if (!init)
     {
@@ -130,22 +307,12 @@ void get_power_data(int chipid, int total_sockets, int verbose, FILE *output)
 #ifdef LIBJUSTIFY_FOUND
     cflush();
 #endif
-
-    ret = rsmi_shut_down();
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not shutdown RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
 }
 
 void get_power_limit_data(int chipid, int total_sockets, int verbose,
                           FILE *output)
 {
     rsmi_status_t ret;
-    uint32_t num_devices;
     int gpus_per_socket;
     char hostname[1024];
     static int init = 0;
@@ -154,26 +321,12 @@ void get_power_limit_data(int chipid, int total_sockets, int verbose,
 
     gethostname(hostname, 1024);
 
-    ret = rsmi_init(0);
-    if (ret != RSMI_STATUS_SUCCESS)
+    if (initRSMI())
     {
-        variorum_error_handler("Could not initialize RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-        exit(-1);
+        return;
     }
 
-    ret = rsmi_num_monitor_devices(&num_devices);
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not get number of GPU devices",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
-
-    gpus_per_socket = num_devices / total_sockets;
+    gpus_per_socket = m_num_devices / total_sockets;
 
     if (!init)
     {
@@ -264,21 +417,11 @@ void get_power_limit_data(int chipid, int total_sockets, int verbose,
 #ifdef LIBJUSTIFY_FOUND
     cflush();
 #endif
-
-    ret = rsmi_shut_down();
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not shutdown RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
 }
 
 void get_thermals_data(int chipid, int total_sockets, int verbose, FILE *output)
 {
     rsmi_status_t ret;
-    uint32_t num_devices;
     int gpus_per_socket;
     char hostname[1024];
     static int init = 0;
@@ -288,26 +431,12 @@ void get_thermals_data(int chipid, int total_sockets, int verbose, FILE *output)
 
     gethostname(hostname, 1024);
 
-    ret = rsmi_init(0);
-    if (ret != RSMI_STATUS_SUCCESS)
+    if (initRSMI())
     {
-        variorum_error_handler("Could not initialize RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-        exit(-1);
+        return;
     }
 
-    ret = rsmi_num_monitor_devices(&num_devices);
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not get number of GPU devices",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
-
-    gpus_per_socket = num_devices / total_sockets;
+    gpus_per_socket = m_num_devices / total_sockets;
 
     if (!init)
     {
@@ -380,45 +509,22 @@ void get_thermals_data(int chipid, int total_sockets, int verbose, FILE *output)
 #ifdef LIBJUSTIFY_FOUND
     cflush();
 #endif
-    ret = rsmi_shut_down();
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not shutdown RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
 }
 
 void get_thermals_json(int chipid, int total_sockets, json_t *output)
 {
     rsmi_status_t ret;
-    uint32_t num_devices;
     int gpus_per_socket;
     char hostname[1024];
 
     gethostname(hostname, 1024);
 
-    ret = rsmi_init(0);
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not initialize RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-        exit(-1);
-    }
-
-    ret = rsmi_num_monitor_devices(&num_devices);
-    if (ret != RSMI_STATUS_SUCCESS)
+    if (initRSMI())
     {
-        variorum_error_handler("Could not get number of GPU devices",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
+        return;
     }
 
-    gpus_per_socket = num_devices / total_sockets;
+    gpus_per_socket = m_num_devices / total_sockets;
 
     char socketid[12];
     snprintf(socketid, 12, "socket_%d", chipid);
@@ -458,22 +564,11 @@ void get_thermals_json(int chipid, int total_sockets, json_t *output)
         snprintf(gpuid, 32, "temp_celsius_gpu_%d", i);
         json_object_set_new(gpu_obj, gpuid, json_real(temp_val_flt));
     }
-
-    ret = rsmi_shut_down();
-
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not shutdown RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
 }
 
 void get_clocks_data(int chipid, int total_sockets, int verbose, FILE *output)
 {
     rsmi_status_t ret;
-    uint32_t num_devices;
     int gpus_per_socket;
     char hostname[1024];
     static int init = 0;
@@ -482,26 +577,12 @@ void get_clocks_data(int chipid, int total_sockets, int verbose, FILE *output)
 
     gethostname(hostname, 1024);
 
-    ret = rsmi_init(0);
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not initialize RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-        exit(-1);
-    }
-
-    ret = rsmi_num_monitor_devices(&num_devices);
-    if (ret != RSMI_STATUS_SUCCESS)
+    if (initRSMI())
     {
-        variorum_error_handler("Could not get number of GPU devices",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
+        return;
     }
 
-    gpus_per_socket = num_devices / total_sockets;
+    gpus_per_socket = m_num_devices / total_sockets;
 
     if (!init)
     {
@@ -580,44 +661,22 @@ void get_clocks_data(int chipid, int total_sockets, int verbose, FILE *output)
 #ifdef LIBJUSTIFY_FOUND
     cflush();
 #endif
-    ret = rsmi_shut_down();
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not shutdown RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
 }
 
 void get_clocks_json(int chipid, int total_sockets, json_t *output)
 {
     rsmi_status_t ret;
-    uint32_t num_devices;
     int gpus_per_socket;
     char socketID[16];
 
     snprintf(socketID, 16, "socket_%d", chipid);
 
-    ret = rsmi_init(0);
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not initialize RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
-
-    ret = rsmi_num_monitor_devices(&num_devices);
-    if (ret != RSMI_STATUS_SUCCESS)
+    if (initRSMI())
     {
-        variorum_error_handler("Could not get number of GPU devices",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
+        return;
     }
 
-    gpus_per_socket = num_devices / total_sockets;
+    gpus_per_socket = m_num_devices / total_sockets;
 
     json_t *socket_obj = json_object_get(output, socketID);
     if (socket_obj == NULL)
@@ -665,22 +724,12 @@ void get_clocks_json(int chipid, int total_sockets, json_t *output)
         json_object_set_new(gpu_obj, gpu_clock_string, json_integer(f_sys_val));
         json_object_set_new(gpu_obj, gpu_mem_clock_string, json_integer(f_mem_val));
     }
-
-    ret = rsmi_shut_down();
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not shutdown RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
 }
 
 void get_gpu_utilization_data(int chipid, int total_sockets, int verbose,
                               FILE *output)
 {
     rsmi_status_t ret;
-    uint32_t num_devices;
     int gpus_per_socket;
     char hostname[1024];
     static int init = 0;
@@ -689,26 +738,12 @@ void get_gpu_utilization_data(int chipid, int total_sockets, int verbose,
 
     gethostname(hostname, 1024);
 
-    ret = rsmi_init(0);
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not initialize RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-        exit(-1);
-    }
-
-    ret = rsmi_num_monitor_devices(&num_devices);
-    if (ret != RSMI_STATUS_SUCCESS)
+    if (initRSMI())
     {
-        variorum_error_handler("Could not get number of GPU devices",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
+        return;
     }
 
-    gpus_per_socket = num_devices / total_sockets;
+    gpus_per_socket = m_num_devices / total_sockets;
 
     if (!init)
     {
@@ -773,21 +808,12 @@ void get_gpu_utilization_data(int chipid, int total_sockets, int verbose,
 #ifdef LIBJUSTIFY_FOUND
     cflush();
 #endif
-    ret = rsmi_shut_down();
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not shutdown RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
 }
 
 void get_gpu_utilization_data_json(int chipid, int total_sockets,
                                    json_t *get_gpu_util_obj)
 {
     rsmi_status_t ret;
-    uint32_t num_devices;
     int gpus_per_socket;
     char socket_id[12];
     char hostname[1024];
@@ -830,25 +856,12 @@ void get_gpu_utilization_data_json(int chipid, int total_sockets,
         json_object_set_new(gpu_obj, socket_id, socket_obj);
     }
 
-    ret = rsmi_init(0);
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not initialize RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
-
-    ret = rsmi_num_monitor_devices(&num_devices);
-    if (ret != RSMI_STATUS_SUCCESS)
+    if (initRSMI())
     {
-        variorum_error_handler("Could not get number of GPU devices",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
+        return;
     }
 
-    gpus_per_socket = num_devices / total_sockets;
+    gpus_per_socket = m_num_devices / total_sockets;
 
     if (!init)
     {
@@ -861,6 +874,8 @@ void get_gpu_utilization_data_json(int chipid, int total_sockets,
     for (i = chipid * gpus_per_socket; i < (chipid + 1) * gpus_per_socket; i++)
     {
         uint32_t utilpercent = 0; // Percentage of time the GPU was busy
+
+        ret = rsmi_dev_busy_percent_get(i, &utilpercent);
         if (ret != RSMI_STATUS_SUCCESS)
         {
             variorum_error_handler("RSMI API was not successful",
@@ -871,22 +886,12 @@ void get_gpu_utilization_data_json(int chipid, int total_sockets,
         snprintf(device_id, 12, "GPU%d_util%%", i);
         json_object_set_new(socket_obj, device_id, json_integer(utilpercent));
     }
-
-    ret = rsmi_shut_down();
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not shutdown RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
 }
 
 void cap_each_gpu_power_limit(int chipid, int total_sockets,
                               unsigned int powerlimit)
 {
     rsmi_status_t ret;
-    uint32_t num_devices;
     int gpus_per_socket;
     char hostname[1024];
     static int init = 0;
@@ -896,26 +901,12 @@ void cap_each_gpu_power_limit(int chipid, int total_sockets,
 
     gethostname(hostname, 1024);
 
-    ret = rsmi_init(0);
-    if (ret != RSMI_STATUS_SUCCESS)
+    if (initRSMI())
     {
-        variorum_error_handler("Could not initialize RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-        exit(-1);
+        return;
     }
 
-    ret = rsmi_num_monitor_devices(&num_devices);
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not get number of GPU devices",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
-
-    gpus_per_socket = num_devices / total_sockets;
+    gpus_per_socket = m_num_devices / total_sockets;
 
     if (!init)
     {
@@ -947,20 +938,11 @@ void cap_each_gpu_power_limit(int chipid, int total_sockets,
             }
         }
     }
-    ret = rsmi_shut_down();
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not shutdown RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
 }
 
 void get_json_power_data(json_t *get_power_obj, int total_sockets)
 {
     int chipid;
-    uint32_t num_devices;
     int gpus_per_socket;
     uint64_t pwr_val = 0;
     double pwr_val_flt = 0.0;
@@ -973,27 +955,12 @@ void get_json_power_data(json_t *get_power_obj, int total_sockets)
     char devID[devIDlen];
     char socketID[24];
 
-    ret = rsmi_init(0);
-    if (ret != RSMI_STATUS_SUCCESS)
+    if (initRSMI())
     {
-        variorum_error_handler("Could not initialize RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-        exit(-1);
+        return;
     }
 
-    ret = rsmi_num_monitor_devices(&num_devices);
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not get number of GPU devices",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-        exit(-1);
-    }
-
-    gpus_per_socket = num_devices / total_sockets;
+    gpus_per_socket = m_num_devices / total_sockets;
 
     json_object_set_new(get_power_obj, "num_gpus_per_socket",
                         json_integer(gpus_per_socket));
@@ -1029,7 +996,16 @@ void get_json_power_data(json_t *get_power_obj, int total_sockets)
              */
 
             RSMI_POWER_TYPE pwr_type = RSMI_AVERAGE_POWER;
+            // A failed read reports 0 W rather than the previous GPU.
+            pwr_val = 0;
             ret = rsmi_dev_power_get(d, &pwr_val, &pwr_type);
+            if (ret != RSMI_STATUS_SUCCESS)
+            {
+                variorum_error_handler("RSMI API was not successful",
+                                       VARIORUM_ERROR_PLATFORM_ENV,
+                                       getenv("HOSTNAME"), __FILE__, __FUNCTION__,
+                                       __LINE__);
+            }
             pwr_val_flt = (double)(pwr_val / (1000 * 1000)); // Convert to Watts
             snprintf(devID, devIDlen, "GPU_%d", d);
             json_object_set_new(gpu_obj, devID, json_real(pwr_val_flt));
@@ -1047,14 +1023,4 @@ void get_json_power_data(json_t *get_power_obj, int total_sockets)
                         json_real(power_node + total_gpu_power));
     }
 
-
-    ret = rsmi_shut_down();
-    if (ret != RSMI_STATUS_SUCCESS)
-    {
-        variorum_error_handler("Could not shutdown RSMI",
-                               VARIORUM_ERROR_PLATFORM_ENV,
-                               getenv("HOSTNAME"), __FILE__, __FUNCTION__,
-                               __LINE__);
-    }
-
 }
@@ -12,6 +12,65 @@
 
 #include <rocm_smi/rocm_smi.h>
 
+/// @brief Number of GPU devices enumerated when the RSMI session started.
+extern uint32_t m_num_devices;
+
+/// @brief Structure containing a single sample of all monitored metrics for
+/// one GPU device.
+struct amd_gpu_sample
+{
+    /// @brief Average power usage in Watts.
+    double power_watts;
+    /// @brief Edge temperature in degrees Celsius.
+    double temp_celsius;
+    /// @brief Current system clock in MHz.
+    uint32_t sys_clock_mhz;
+    /// @brief Current memory clock in MHz.
+    uint32_t mem_clock_mhz;
+    /// @brief Percentage of time the GPU was busy.
+    uint32_t util_percent;
+};
+
+/// @brief Initialize ROCm SMI and cache the number of devices.
+///
+/// The RSMI session is started once when the AMD GPU function pointers are
+/// first set and stays open across variorum_enter() and variorum_exit(), so
+/// individual queries do not pay for rsmi_init() and rsmi_shut_down().
+/// Subsequent calls are no-ops. The session is shut down at process exit.
+///
+/// @return 0 if successful, else -1 if rsmi_init() fails.
+int initRSMI(
+    void
+);
+
+/// @brief Shut down the ROCm SMI session started by initRSMI().
+///
+/// Registered with atexit() by the first successful initRSMI(). A later
+/// initRSMI() starts a new session.
+void shutdownRSMI(
+    void
+);
+
+/// @brief Gather power, temperature, clocks and busy percent for all devices
+/// in a single pass.
+///
+/// @param [out] samples Pointer to an internal array of m_num_devices
+///        samples, valid until the next call.
+///
+/// @return 0 if successful, else -1 if the RSMI session is unavailable.
+int sample_all_gpu_data(
+    struct amd_gpu_sample **samples
+);
+
+/// @brief Print one sample of all monitored metrics for every device.
+///
+/// @param [in] total_sockets Number of sockets on the node.
+/// @param [in] output File stream where output will be written to.
+void get_all_gpu_data(
+    int total_sockets,
+    FILE *output
+);
+
 void get_power_data(
     int chipid,
     int total_sockets,
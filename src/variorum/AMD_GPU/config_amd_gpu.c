@@ -42,11 +42,15 @@ int set_amd_gpu_func_ptrs(int idx)
             amd_gpu_instinct_cap_each_gpu_power_limit;
         /* Initialize JSON interfaces */
         g_platform[idx].variorum_get_power_json = amd_gpu_instinct_get_power_json;
+        /* Initialize monitoring interface */
+        g_platform[idx].variorum_monitoring = amd_gpu_instinct_monitoring;
     }
     else
     {
         err = VARIORUM_ERROR_UNSUPPORTED_PLATFORM;
     }
 
+    initRSMI();
+
     return err;
 }
@@ -8,6 +8,8 @@
 
 #include <inttypes.h>
 
+#include <amd_gpu_power_features.h>
+
 uint64_t *detect_amd_gpu_arch(
     void
 );
@@ -228,3 +228,22 @@ int amd_gpu_instinct_get_power_json(json_t *get_power_obj)
 
     return 0;
 }
+
+int amd_gpu_instinct_monitoring(FILE *output)
+{
+    char *val = getenv("VARIORUM_LOG");
+    unsigned nsockets;
+
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+#ifdef VARIORUM_WITH_AMD_GPU
+    variorum_get_topology(&nsockets, NULL, NULL, P_AMD_GPU_IDX);
+#endif
+
+    get_all_gpu_data(nsockets, output);
+
+    return 0;
+}
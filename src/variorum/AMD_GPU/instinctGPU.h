@@ -7,6 +7,7 @@
 #define INSTINCTGPU_H_INCLUDE
 
 #include <jansson.h>
+#include <stdio.h>
 #include <sys/time.h>
 
 int amd_gpu_instinct_get_power(
@@ -49,4 +50,8 @@ int amd_gpu_instinct_get_gpu_utilization_json(
     char **get_gpu_util_obj_str
 );
 
+int amd_gpu_instinct_monitoring(
+    FILE *output
+);
+
 #endif
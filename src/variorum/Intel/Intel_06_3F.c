@@ -10,8 +10,11 @@
 #include <clocks_features.h>
 #include <config_architecture.h>
 #include <counters_features.h>
+#include <cstate_features.h>
+#include <derived_features.h>
 #include <misc_features.h>
 #include <intel_power_features.h>
+#include <snapshot_features.h>
 #include <thermal_features.h>
 
 static struct haswell_3f_offsets msrs =
@@ -23,6 +26,9 @@ static struct haswell_3f_offsets msrs =
     .ia32_therm_interrupt         = 0x19B,
     .ia32_therm_status            = 0x19C,
     .ia32_misc_enable             = 0x1A0,
+    .msr_misc_feature_control     = 0x1A4,
+    .ia32_energy_perf_bias        = 0x1B0,
+    .ia32_pm_enable               = 0x770,
     .msr_temperature_target       = 0x1A2,
     .msr_turbo_ratio_limit        = 0x1AD,
     .msr_turbo_ratio_limit1       = 0x1AE,
@@ -68,6 +74,15 @@ static struct haswell_3f_offsets msrs =
     .ia32_perfevtsel_counters[7]  = 0x18D,
 };
 
+static const struct cstate_msrs cstates =
+{
+    .pkg        = {0x60D, 0x3F8, 0x3F9},
+    .core       = {0x3FC, 0x3FD},
+    .tsc        = 0x10,
+    .cst_config = 0xE2,
+    .cst_limit_mask = 0x7,
+};
+
 int intel_cpu_fm_06_3f_get_power_limits(int long_ver)
 {
     unsigned socket;
@@ -189,6 +204,12 @@ int intel_cpu_fm_06_3f_get_features(void)
             msrs.ia32_therm_status);
     fprintf(stdout, "ia32_misc_enable             = 0x%lx\n",
             msrs.ia32_misc_enable);
+    fprintf(stdout, "msr_misc_feature_control     = 0x%lx\n",
+            msrs.msr_misc_feature_control);
+    fprintf(stdout, "ia32_energy_perf_bias        = 0x%lx\n",
+            msrs.ia32_energy_perf_bias);
+    fprintf(stdout, "ia32_pm_enable               = 0x%lx\n",
+            msrs.ia32_pm_enable);
     fprintf(stdout, "msr_temperature_target       = 0x%lx\n",
             msrs.msr_temperature_target);
     fprintf(stdout, "msr_turbo_ratio_limit        = 0x%lx\n",
@@ -440,7 +461,8 @@ int intel_cpu_fm_06_3f_monitoring(FILE *output)
                              msrs.msr_dram_power_limit, msrs.msr_rapl_power_unit, msrs.msr_pkg_energy_status,
                              msrs.msr_dram_energy_status, msrs.ia32_fixed_counters,
                              msrs.ia32_perf_global_ctrl, msrs.ia32_fixed_ctr_ctrl, msrs.ia32_aperf,
-                             msrs.ia32_mperf, msrs.ia32_time_stamp_counter);
+                             msrs.ia32_mperf, msrs.ia32_time_stamp_counter,
+                             msrs.msr_platform_info, &cstates);
     return 0;
 }
 
@@ -578,3 +600,281 @@ int intel_cpu_fm_06_3f_get_energy_json(json_t *get_energy_obj)
 
     return 0;
 }
+
+int intel_cpu_fm_06_3f_get_cstate_residency_json(json_t *get_cstate_obj)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return json_get_cstate_residency(get_cstate_obj, &cstates);
+}
+
+int intel_cpu_fm_06_3f_cap_core_cstate_latency(int core_id, int max_latency_us)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return cap_cstate_latency(CORE, core_id, max_latency_us);
+}
+
+int intel_cpu_fm_06_3f_cap_socket_cstate_latency(int socket_id, int max_latency_us)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return cap_cstate_latency(SOCKET, socket_id, max_latency_us);
+}
+
+int intel_cpu_fm_06_3f_cap_node_cstate_latency(int max_latency_us)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return cap_node_cstate_latency(max_latency_us);
+}
+
+int intel_cpu_fm_06_3f_cap_socket_pkg_cstate_limit(int socket_id, int limit)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return cap_pkg_cstate_limit(&cstates, socket_id, limit);
+}
+
+int intel_cpu_fm_06_3f_save_cstate_limits(void)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return save_cstate_limits(&cstates);
+}
+
+int intel_cpu_fm_06_3f_restore_cstate_limits(void)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return restore_cstate_limits(&cstates);
+}
+
+int intel_cpu_fm_06_3f_get_prefetch_control(int *disable_bits)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return get_prefetch_control(msrs.msr_misc_feature_control, disable_bits);
+}
+
+int intel_cpu_fm_06_3f_set_prefetch_control(const int *disable_bits)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return set_prefetch_control(msrs.msr_misc_feature_control, disable_bits);
+}
+
+int intel_cpu_fm_06_3f_push_prefetch_control(const int *disable_bits)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return push_prefetch_control(msrs.msr_misc_feature_control, disable_bits);
+}
+
+int intel_cpu_fm_06_3f_pop_prefetch_control(void)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return pop_prefetch_control(msrs.msr_misc_feature_control);
+}
+
+int intel_cpu_fm_06_3f_cap_turbo_ratio_limit(int nbuckets, const int *bucket_cores,
+                                             const int *bucket_freq_mhz)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return set_turbo_ratio_limits(msrs.msr_platform_info,
+                                  msrs.msr_turbo_ratio_limit, msrs.msr_turbo_ratio_limit1,
+                                  0, nbuckets, bucket_cores,
+                                  bucket_freq_mhz);
+}
+
+int intel_cpu_fm_06_3f_get_energy_perf_bias(int *epb)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return get_energy_perf_bias(msrs.ia32_energy_perf_bias, epb);
+}
+
+int intel_cpu_fm_06_3f_set_energy_perf_bias(const int *epb)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return set_energy_perf_bias(msrs.ia32_energy_perf_bias, epb);
+}
+
+int intel_cpu_fm_06_3f_get_turbo_cores(int *enabled)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return get_turbo_cores(msrs.ia32_perf_ctl, enabled);
+}
+
+int intel_cpu_fm_06_3f_set_turbo_cores(const int *core_mask, int enable)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return set_turbo_cores(msrs.ia32_perf_ctl, msrs.ia32_pm_enable, core_mask,
+                           enable);
+}
+
+int intel_cpu_fm_06_3f_get_thread_fixed_counters(uint64_t *counts)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return get_thread_fixed_counters(msrs.ia32_fixed_counters,
+                                     msrs.ia32_perf_global_ctrl,
+                                     msrs.ia32_fixed_ctr_ctrl, counts);
+}
+
+int intel_cpu_fm_06_3f_arm_snapshot(void)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return arm_snapshot(msrs.msr_rapl_power_unit, msrs.msr_pkg_energy_status,
+                        msrs.msr_dram_energy_status, 1,
+                        msrs.ia32_fixed_counters, msrs.ia32_perf_global_ctrl,
+                        msrs.ia32_fixed_ctr_ctrl, msrs.ia32_aperf,
+                        msrs.ia32_mperf, msrs.msr_pkg_power_limit,
+                        msrs.ia32_package_therm_status);
+}
+
+int intel_cpu_fm_06_3f_get_metrics(struct variorum_metric_vector *metrics)
+{
+    struct rapl_data *rapl = NULL;
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    get_energy_metrics(metrics, msrs.msr_rapl_power_unit,
+                       msrs.msr_pkg_energy_status, msrs.msr_dram_energy_status);
+    rapl_storage(&rapl);
+    get_derived_metrics(metrics, msrs.ia32_fixed_counters,
+                        msrs.ia32_perf_global_ctrl, msrs.ia32_fixed_ctr_ctrl,
+                        msrs.ia32_aperf, msrs.ia32_mperf, msrs.ia32_time_stamp_counter,
+                        msrs.msr_platform_info, rapl->pkg_total_joules);
+    get_cstate_metrics(metrics, &cstates);
+    return 0;
+}
+
+int intel_cpu_fm_06_3f_get_energy_metrics(struct variorum_metric_vector *metrics)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    get_total_energy_metrics(metrics, msrs.msr_rapl_power_unit,
+                             msrs.msr_pkg_energy_status, msrs.msr_dram_energy_status);
+    return 0;
+}
+
+int intel_cpu_fm_06_3f_start_pmc_events(const char *events)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return pmc_groups_start(events, msrs.ia32_perfevtsel_counters,
+                            msrs.ia32_perfmon_counters);
+}
+
+int intel_cpu_fm_06_3f_read_pmc_events(struct variorum_metric_vector *metrics)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return pmc_groups_read(metrics, msrs.ia32_perfevtsel_counters,
+                           msrs.ia32_perfmon_counters);
+}
+
+int intel_cpu_fm_06_3f_stop_pmc_events(void)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return pmc_groups_stop(msrs.ia32_perfevtsel_counters);
+}
@@ -9,6 +9,8 @@
 #include <jansson.h>
 #include <sys/types.h>
 
+#include <variorum_metrics.h>
+
 /// @brief List of unique addresses for Skylake Family/Model 55H.
 struct skylake_55_offsets
 {
@@ -28,6 +30,12 @@ struct skylake_55_offsets
     off_t msr_therm2_ctl;
     /// @brief Address for IA32_MISC_ENABLE.
     off_t ia32_misc_enable;
+    /// @brief Address for MSR_MISC_FEATURE_CONTROL.
+    off_t msr_misc_feature_control;
+    /// @brief Address for IA32_ENERGY_PERF_BIAS.
+    off_t ia32_energy_perf_bias;
+    /// @brief Address for IA32_PM_ENABLE.
+    off_t ia32_pm_enable;
     /// @brief Address for TEMPERATURE_TARGET.
     off_t msr_temperature_target;
     /// @brief Address for TURBO_RATIO_LIMIT.
@@ -154,4 +162,102 @@ int intel_cpu_fm_06_55_get_energy_json(
     json_t *get_energy_obj
 );
 
+int intel_cpu_fm_06_55_get_cstate_residency_json(
+    json_t *get_cstate_obj
+);
+
+int intel_cpu_fm_06_55_cap_core_cstate_latency(
+    int core_id,
+    int max_latency_us
+);
+
+int intel_cpu_fm_06_55_cap_socket_cstate_latency(
+    int socket_id,
+    int max_latency_us
+);
+
+int intel_cpu_fm_06_55_cap_node_cstate_latency(
+    int max_latency_us
+);
+
+int intel_cpu_fm_06_55_cap_socket_pkg_cstate_limit(
+    int socket_id,
+    int limit
+);
+
+int intel_cpu_fm_06_55_save_cstate_limits(
+    void
+);
+
+int intel_cpu_fm_06_55_restore_cstate_limits(
+    void
+);
+
+int intel_cpu_fm_06_55_get_prefetch_control(
+    int *disable_bits
+);
+
+int intel_cpu_fm_06_55_set_prefetch_control(
+    const int *disable_bits
+);
+
+int intel_cpu_fm_06_55_push_prefetch_control(
+    const int *disable_bits
+);
+
+int intel_cpu_fm_06_55_pop_prefetch_control(
+    void
+);
+
+int intel_cpu_fm_06_55_cap_turbo_ratio_limit(
+    int nbuckets,
+    const int *bucket_cores,
+    const int *bucket_freq_mhz
+);
+
+int intel_cpu_fm_06_55_get_energy_perf_bias(
+    int *epb
+);
+
+int intel_cpu_fm_06_55_set_energy_perf_bias(
+    const int *epb
+);
+
+int intel_cpu_fm_06_55_get_turbo_cores(
+    int *enabled
+);
+
+int intel_cpu_fm_06_55_set_turbo_cores(
+    const int *core_mask,
+    int enable
+);
+
+int intel_cpu_fm_06_55_get_thread_fixed_counters(
+    uint64_t *counts
+);
+
+int intel_cpu_fm_06_55_arm_snapshot(
+    void
+);
+
+int intel_cpu_fm_06_55_get_metrics(
+    struct variorum_metric_vector *metrics
+);
+
+int intel_cpu_fm_06_55_get_energy_metrics(
+    struct variorum_metric_vector *metrics
+);
+
+int intel_cpu_fm_06_55_start_pmc_events(
+    const char *events
+);
+
+int intel_cpu_fm_06_55_read_pmc_events(
+    struct variorum_metric_vector *metrics
+);
+
+int intel_cpu_fm_06_55_stop_pmc_events(
+    void
+);
+
 #endif
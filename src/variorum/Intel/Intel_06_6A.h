@@ -9,6 +9,8 @@
 #include <jansson.h>
 #include <sys/types.h>
 
+#include <variorum_metrics.h>
+
 /// @brief List of unique addresses for Ice Lake Family/Model 6AH.
 struct icelake_6a_offsets
 {
@@ -16,6 +18,14 @@ struct icelake_6a_offsets
     off_t msr_platform_info;
     /// @brief Address for IA32_TIME_STAMP_COUNTER.
     off_t ia32_time_stamp_counter;
+    /// @brief Address for IA32_PERF_CTL.
+    off_t ia32_perf_ctl;
+    /// @brief Address for MSR_MISC_FEATURE_CONTROL.
+    off_t msr_misc_feature_control;
+    /// @brief Address for IA32_ENERGY_PERF_BIAS.
+    off_t ia32_energy_perf_bias;
+    /// @brief Address for IA32_PM_ENABLE.
+    off_t ia32_pm_enable;
     /// @brief Address for RAPL_POWER_UNIT.
     off_t msr_rapl_power_unit;
     /// @brief Address for PKG_POWER_LIMIT.
@@ -60,4 +70,76 @@ int intel_cpu_fm_06_6a_get_energy_json(
     json_t *get_energy_obj
 );
 
+int intel_cpu_fm_06_6a_get_cstate_residency_json(
+    json_t *get_cstate_obj
+);
+
+int intel_cpu_fm_06_6a_cap_core_cstate_latency(
+    int core_id,
+    int max_latency_us
+);
+
+int intel_cpu_fm_06_6a_cap_socket_cstate_latency(
+    int socket_id,
+    int max_latency_us
+);
+
+int intel_cpu_fm_06_6a_cap_node_cstate_latency(
+    int max_latency_us
+);
+
+int intel_cpu_fm_06_6a_cap_socket_pkg_cstate_limit(
+    int socket_id,
+    int limit
+);
+
+int intel_cpu_fm_06_6a_save_cstate_limits(
+    void
+);
+
+int intel_cpu_fm_06_6a_restore_cstate_limits(
+    void
+);
+
+int intel_cpu_fm_06_6a_get_prefetch_control(
+    int *disable_bits
+);
+
+int intel_cpu_fm_06_6a_set_prefetch_control(
+    const int *disable_bits
+);
+
+int intel_cpu_fm_06_6a_push_prefetch_control(
+    const int *disable_bits
+);
+
+int intel_cpu_fm_06_6a_pop_prefetch_control(
+    void
+);
+
+int intel_cpu_fm_06_6a_get_energy_perf_bias(
+    int *epb
+);
+
+int intel_cpu_fm_06_6a_set_energy_perf_bias(
+    const int *epb
+);
+
+int intel_cpu_fm_06_6a_get_turbo_cores(
+    int *enabled
+);
+
+int intel_cpu_fm_06_6a_set_turbo_cores(
+    const int *core_mask,
+    int enable
+);
+
+int intel_cpu_fm_06_6a_get_metrics(
+    struct variorum_metric_vector *metrics
+);
+
+int intel_cpu_fm_06_6a_get_energy_metrics(
+    struct variorum_metric_vector *metrics
+);
+
 #endif
@@ -18,6 +18,7 @@
 #include <Intel_06_55.h>
 #include <Intel_06_6A.h>
 #include <Intel_06_8F.h>
+#include <pmc_event_table.h>
 
 uint64_t *detect_intel_arch(void)
 {
@@ -78,6 +79,13 @@ int set_intel_func_ptrs(int idx)
         g_platform[idx].variorum_print_features = intel_cpu_fm_06_2a_get_features;
         g_platform[idx].variorum_print_thermals = intel_cpu_fm_06_2a_get_thermals;
         g_platform[idx].variorum_print_counters = intel_cpu_fm_06_2a_get_counters;
+        g_platform[idx].variorum_start_pmc_events =
+            intel_cpu_fm_06_2a_start_pmc_events;
+        g_platform[idx].variorum_read_pmc_events =
+            intel_cpu_fm_06_2a_read_pmc_events;
+        g_platform[idx].variorum_stop_pmc_events =
+            intel_cpu_fm_06_2a_stop_pmc_events;
+        pmc_event_table_select(&pmc_events_sandybridge);
         g_platform[idx].variorum_print_frequency = intel_cpu_fm_06_2a_get_clocks;
         g_platform[idx].variorum_print_power = intel_cpu_fm_06_2a_get_power;
         g_platform[idx].variorum_print_energy = intel_cpu_fm_06_2a_get_energy;
@@ -100,6 +108,42 @@ int set_intel_func_ptrs(int idx)
             intel_cpu_fm_06_2a_get_thermals_json;
         g_platform[idx].variorum_get_frequency_json =
             intel_cpu_fm_06_2a_get_clocks_json;
+        g_platform[idx].variorum_get_cstate_residency_json =
+            intel_cpu_fm_06_2a_get_cstate_residency_json;
+        g_platform[idx].variorum_cap_core_cstate_latency =
+            intel_cpu_fm_06_2a_cap_core_cstate_latency;
+        g_platform[idx].variorum_cap_socket_cstate_latency =
+            intel_cpu_fm_06_2a_cap_socket_cstate_latency;
+        g_platform[idx].variorum_cap_node_cstate_latency =
+            intel_cpu_fm_06_2a_cap_node_cstate_latency;
+        g_platform[idx].variorum_cap_socket_pkg_cstate_limit =
+            intel_cpu_fm_06_2a_cap_socket_pkg_cstate_limit;
+        g_platform[idx].variorum_save_cstate_limits =
+            intel_cpu_fm_06_2a_save_cstate_limits;
+        g_platform[idx].variorum_restore_cstate_limits =
+            intel_cpu_fm_06_2a_restore_cstate_limits;
+        g_platform[idx].variorum_get_prefetch_control =
+            intel_cpu_fm_06_2a_get_prefetch_control;
+        g_platform[idx].variorum_set_prefetch_control =
+            intel_cpu_fm_06_2a_set_prefetch_control;
+        g_platform[idx].variorum_push_prefetch_control =
+            intel_cpu_fm_06_2a_push_prefetch_control;
+        g_platform[idx].variorum_pop_prefetch_control =
+            intel_cpu_fm_06_2a_pop_prefetch_control;
+        g_platform[idx].variorum_cap_turbo_ratio_limit =
+            intel_cpu_fm_06_2a_cap_turbo_ratio_limit;
+        g_platform[idx].variorum_get_energy_perf_bias =
+            intel_cpu_fm_06_2a_get_energy_perf_bias;
+        g_platform[idx].variorum_set_energy_perf_bias =
+            intel_cpu_fm_06_2a_set_energy_perf_bias;
+        g_platform[idx].variorum_get_turbo_cores =
+            intel_cpu_fm_06_2a_get_turbo_cores;
+        g_platform[idx].variorum_set_turbo_cores =
+            intel_cpu_fm_06_2a_set_turbo_cores;
+        g_platform[idx].variorum_get_thread_fixed_counters =
+            intel_cpu_fm_06_2a_get_thread_fixed_counters;
+        g_platform[idx].variorum_arm_snapshot =
+            intel_cpu_fm_06_2a_arm_snapshot;
     }
     else if (*g_platform[idx].arch_id == FM_06_2D)
     {
@@ -110,6 +154,13 @@ int set_intel_func_ptrs(int idx)
         g_platform[idx].variorum_print_features = intel_cpu_fm_06_2d_get_features;
         g_platform[idx].variorum_print_thermals = intel_cpu_fm_06_2d_get_thermals;
         g_platform[idx].variorum_print_counters = intel_cpu_fm_06_2d_get_counters;
+        g_platform[idx].variorum_start_pmc_events =
+            intel_cpu_fm_06_2d_start_pmc_events;
+        g_platform[idx].variorum_read_pmc_events =
+            intel_cpu_fm_06_2d_read_pmc_events;
+        g_platform[idx].variorum_stop_pmc_events =
+            intel_cpu_fm_06_2d_stop_pmc_events;
+        pmc_event_table_select(&pmc_events_sandybridge);
         g_platform[idx].variorum_print_frequency = intel_cpu_fm_06_2d_get_clocks;
         g_platform[idx].variorum_print_power = intel_cpu_fm_06_2d_get_power;
         g_platform[idx].variorum_print_energy = intel_cpu_fm_06_2d_get_energy;
@@ -132,6 +183,42 @@ int set_intel_func_ptrs(int idx)
             intel_cpu_fm_06_2d_get_thermals_json;
         g_platform[idx].variorum_get_frequency_json =
             intel_cpu_fm_06_2d_get_clocks_json;
+        g_platform[idx].variorum_get_cstate_residency_json =
+            intel_cpu_fm_06_2d_get_cstate_residency_json;
+        g_platform[idx].variorum_cap_core_cstate_latency =
+            intel_cpu_fm_06_2d_cap_core_cstate_latency;
+        g_platform[idx].variorum_cap_socket_cstate_latency =
+            intel_cpu_fm_06_2d_cap_socket_cstate_latency;
+        g_platform[idx].variorum_cap_node_cstate_latency =
+            intel_cpu_fm_06_2d_cap_node_cstate_latency;
+        g_platform[idx].variorum_cap_socket_pkg_cstate_limit =
+            intel_cpu_fm_06_2d_cap_socket_pkg_cstate_limit;
+        g_platform[idx].variorum_save_cstate_limits =
+            intel_cpu_fm_06_2d_save_cstate_limits;
+        g_platform[idx].variorum_restore_cstate_limits =
+            intel_cpu_fm_06_2d_restore_cstate_limits;
+        g_platform[idx].variorum_get_prefetch_control =
+            intel_cpu_fm_06_2d_get_prefetch_control;
+        g_platform[idx].variorum_set_prefetch_control =
+            intel_cpu_fm_06_2d_set_prefetch_control;
+        g_platform[idx].variorum_push_prefetch_control =
+            intel_cpu_fm_06_2d_push_prefetch_control;
+        g_platform[idx].variorum_pop_prefetch_control =
+            intel_cpu_fm_06_2d_pop_prefetch_control;
+        g_platform[idx].variorum_cap_turbo_ratio_limit =
+            intel_cpu_fm_06_2d_cap_turbo_ratio_limit;
+        g_platform[idx].variorum_get_energy_perf_bias =
+            intel_cpu_fm_06_2d_get_energy_perf_bias;
+        g_platform[idx].variorum_set_energy_perf_bias =
+            intel_cpu_fm_06_2d_set_energy_perf_bias;
+        g_platform[idx].variorum_get_turbo_cores =
+            intel_cpu_fm_06_2d_get_turbo_cores;
+        g_platform[idx].variorum_set_turbo_cores =
+            intel_cpu_fm_06_2d_set_turbo_cores;
+        g_platform[idx].variorum_get_thread_fixed_counters =
+            intel_cpu_fm_06_2d_get_thread_fixed_counters;
+        g_platform[idx].variorum_arm_snapshot =
+            intel_cpu_fm_06_2d_arm_snapshot;
     }
     // Ivy Bridge 06_3E
     else if (*g_platform[idx].arch_id == FM_06_3E)
@@ -143,6 +230,13 @@ int set_intel_func_ptrs(int idx)
         g_platform[idx].variorum_print_features = intel_cpu_fm_06_3e_get_features;
         g_platform[idx].variorum_print_thermals = intel_cpu_fm_06_3e_get_thermals;
         g_platform[idx].variorum_print_counters = intel_cpu_fm_06_3e_get_counters;
+        g_platform[idx].variorum_start_pmc_events =
+            intel_cpu_fm_06_3e_start_pmc_events;
+        g_platform[idx].variorum_read_pmc_events =
+            intel_cpu_fm_06_3e_read_pmc_events;
+        g_platform[idx].variorum_stop_pmc_events =
+            intel_cpu_fm_06_3e_stop_pmc_events;
+        pmc_event_table_select(&pmc_events_ivybridge);
         g_platform[idx].variorum_print_frequency = intel_cpu_fm_06_3e_get_clocks;
         g_platform[idx].variorum_print_power = intel_cpu_fm_06_3e_get_power;
         g_platform[idx].variorum_print_energy = intel_cpu_fm_06_3e_get_energy;
@@ -165,6 +259,42 @@ int set_intel_func_ptrs(int idx)
             intel_cpu_fm_06_3e_get_thermals_json;
         g_platform[idx].variorum_get_frequency_json =
             intel_cpu_fm_06_3e_get_clocks_json;
+        g_platform[idx].variorum_get_cstate_residency_json =
+            intel_cpu_fm_06_3e_get_cstate_residency_json;
+        g_platform[idx].variorum_cap_core_cstate_latency =
+            intel_cpu_fm_06_3e_cap_core_cstate_latency;
+        g_platform[idx].variorum_cap_socket_cstate_latency =
+            intel_cpu_fm_06_3e_cap_socket_cstate_latency;
+        g_platform[idx].variorum_cap_node_cstate_latency =
+            intel_cpu_fm_06_3e_cap_node_cstate_latency;
+        g_platform[idx].variorum_cap_socket_pkg_cstate_limit =
+            intel_cpu_fm_06_3e_cap_socket_pkg_cstate_limit;
+        g_platform[idx].variorum_save_cstate_limits =
+            intel_cpu_fm_06_3e_save_cstate_limits;
+        g_platform[idx].variorum_restore_cstate_limits =
+            intel_cpu_fm_06_3e_restore_cstate_limits;
+        g_platform[idx].variorum_get_prefetch_control =
+            intel_cpu_fm_06_3e_get_prefetch_control;
+        g_platform[idx].variorum_set_prefetch_control =
+            intel_cpu_fm_06_3e_set_prefetch_control;
+        g_platform[idx].variorum_push_prefetch_control =
+            intel_cpu_fm_06_3e_push_prefetch_control;
+        g_platform[idx].variorum_pop_prefetch_control =
+            intel_cpu_fm_06_3e_pop_prefetch_control;
+        g_platform[idx].variorum_cap_turbo_ratio_limit =
+            intel_cpu_fm_06_3e_cap_turbo_ratio_limit;
+        g_platform[idx].variorum_get_energy_perf_bias =
+            intel_cpu_fm_06_3e_get_energy_perf_bias;
+        g_platform[idx].variorum_set_energy_perf_bias =
+            intel_cpu_fm_06_3e_set_energy_perf_bias;
+        g_platform[idx].variorum_get_turbo_cores =
+            intel_cpu_fm_06_3e_get_turbo_cores;
+        g_platform[idx].variorum_set_turbo_cores =
+            intel_cpu_fm_06_3e_set_turbo_cores;
+        g_platform[idx].variorum_get_thread_fixed_counters =
+            intel_cpu_fm_06_3e_get_thread_fixed_counters;
+        g_platform[idx].variorum_arm_snapshot =
+            intel_cpu_fm_06_3e_arm_snapshot;
     }
     // Haswell 06_3F
     else if (*g_platform[idx].arch_id == FM_06_3F)
@@ -176,6 +306,13 @@ int set_intel_func_ptrs(int idx)
         g_platform[idx].variorum_print_features = intel_cpu_fm_06_3f_get_features;
         g_platform[idx].variorum_print_thermals = intel_cpu_fm_06_3f_get_thermals;
         g_platform[idx].variorum_print_counters = intel_cpu_fm_06_3f_get_counters;
+        g_platform[idx].variorum_start_pmc_events =
+            intel_cpu_fm_06_3f_start_pmc_events;
+        g_platform[idx].variorum_read_pmc_events =
+            intel_cpu_fm_06_3f_read_pmc_events;
+        g_platform[idx].variorum_stop_pmc_events =
+            intel_cpu_fm_06_3f_stop_pmc_events;
+        pmc_event_table_select(&pmc_events_haswell);
         g_platform[idx].variorum_print_frequency = intel_cpu_fm_06_3f_get_clocks;
         g_platform[idx].variorum_print_power = intel_cpu_fm_06_3f_get_power;
         g_platform[idx].variorum_print_energy = intel_cpu_fm_06_3f_get_energy;
@@ -198,6 +335,45 @@ int set_intel_func_ptrs(int idx)
             intel_cpu_fm_06_3f_get_thermals_json;
         g_platform[idx].variorum_get_energy_json =
             intel_cpu_fm_06_3f_get_energy_json;
+        g_platform[idx].variorum_get_metrics = intel_cpu_fm_06_3f_get_metrics;
+        g_platform[idx].variorum_get_energy_metrics =
+            intel_cpu_fm_06_3f_get_energy_metrics;
+        g_platform[idx].variorum_get_cstate_residency_json =
+            intel_cpu_fm_06_3f_get_cstate_residency_json;
+        g_platform[idx].variorum_cap_core_cstate_latency =
+            intel_cpu_fm_06_3f_cap_core_cstate_latency;
+        g_platform[idx].variorum_cap_socket_cstate_latency =
+            intel_cpu_fm_06_3f_cap_socket_cstate_latency;
+        g_platform[idx].variorum_cap_node_cstate_latency =
+            intel_cpu_fm_06_3f_cap_node_cstate_latency;
+        g_platform[idx].variorum_cap_socket_pkg_cstate_limit =
+            intel_cpu_fm_06_3f_cap_socket_pkg_cstate_limit;
+        g_platform[idx].variorum_save_cstate_limits =
+            intel_cpu_fm_06_3f_save_cstate_limits;
+        g_platform[idx].variorum_restore_cstate_limits =
+            intel_cpu_fm_06_3f_restore_cstate_limits;
+        g_platform[idx].variorum_get_prefetch_control =
+            intel_cpu_fm_06_3f_get_prefetch_control;
+        g_platform[idx].variorum_set_prefetch_control =
+            intel_cpu_fm_06_3f_set_prefetch_control;
+        g_platform[idx].variorum_push_prefetch_control =
+            intel_cpu_fm_06_3f_push_prefetch_control;
+        g_platform[idx].variorum_pop_prefetch_control =
+            intel_cpu_fm_06_3f_pop_prefetch_control;
+        g_platform[idx].variorum_cap_turbo_ratio_limit =
+            intel_cpu_fm_06_3f_cap_turbo_ratio_limit;
+        g_platform[idx].variorum_get_energy_perf_bias =
+            intel_cpu_fm_06_3f_get_energy_perf_bias;
+        g_platform[idx].variorum_set_energy_perf_bias =
+            intel_cpu_fm_06_3f_set_energy_perf_bias;
+        g_platform[idx].variorum_get_turbo_cores =
+            intel_cpu_fm_06_3f_get_turbo_cores;
+        g_platform[idx].variorum_set_turbo_cores =
+            intel_cpu_fm_06_3f_set_turbo_cores;
+        g_platform[idx].variorum_get_thread_fixed_counters =
+            intel_cpu_fm_06_3f_get_thread_fixed_counters;
+        g_platform[idx].variorum_arm_snapshot =
+            intel_cpu_fm_06_3f_arm_snapshot;
     }
     // Broadwell 06_4F
     else if (*g_platform[idx].arch_id == FM_06_4F)
@@ -209,6 +385,13 @@ int set_intel_func_ptrs(int idx)
         g_platform[idx].variorum_print_features = intel_cpu_fm_06_4f_get_features;
         g_platform[idx].variorum_print_thermals = intel_cpu_fm_06_4f_get_thermals;
         g_platform[idx].variorum_print_counters = intel_cpu_fm_06_4f_get_counters;
+        g_platform[idx].variorum_start_pmc_events =
+            intel_cpu_fm_06_4f_start_pmc_events;
+        g_platform[idx].variorum_read_pmc_events =
+            intel_cpu_fm_06_4f_read_pmc_events;
+        g_platform[idx].variorum_stop_pmc_events =
+            intel_cpu_fm_06_4f_stop_pmc_events;
+        pmc_event_table_select(&pmc_events_broadwell);
         g_platform[idx].variorum_print_frequency = intel_cpu_fm_06_4f_get_clocks;
         g_platform[idx].variorum_print_power = intel_cpu_fm_06_4f_get_power;
         g_platform[idx].variorum_print_energy = intel_cpu_fm_06_4f_get_energy;
@@ -233,6 +416,45 @@ int set_intel_func_ptrs(int idx)
             intel_cpu_fm_06_4f_get_clocks_json;
         g_platform[idx].variorum_get_energy_json =
             intel_cpu_fm_06_4f_get_energy_json;
+        g_platform[idx].variorum_get_metrics = intel_cpu_fm_06_4f_get_metrics;
+        g_platform[idx].variorum_get_energy_metrics =
+            intel_cpu_fm_06_4f_get_energy_metrics;
+        g_platform[idx].variorum_get_cstate_residency_json =
+            intel_cpu_fm_06_4f_get_cstate_residency_json;
+        g_platform[idx].variorum_cap_core_cstate_latency =
+            intel_cpu_fm_06_4f_cap_core_cstate_latency;
+        g_platform[idx].variorum_cap_socket_cstate_latency =
+            intel_cpu_fm_06_4f_cap_socket_cstate_latency;
+        g_platform[idx].variorum_cap_node_cstate_latency =
+            intel_cpu_fm_06_4f_cap_node_cstate_latency;
+        g_platform[idx].variorum_cap_socket_pkg_cstate_limit =
+            intel_cpu_fm_06_4f_cap_socket_pkg_cstate_limit;
+        g_platform[idx].variorum_save_cstate_limits =
+            intel_cpu_fm_06_4f_save_cstate_limits;
+        g_platform[idx].variorum_restore_cstate_limits =
+            intel_cpu_fm_06_4f_restore_cstate_limits;
+        g_platform[idx].variorum_get_prefetch_control =
+            intel_cpu_fm_06_4f_get_prefetch_control;
+        g_platform[idx].variorum_set_prefetch_control =
+            intel_cpu_fm_06_4f_set_prefetch_control;
+        g_platform[idx].variorum_push_prefetch_control =
+            intel_cpu_fm_06_4f_push_prefetch_control;
+        g_platform[idx].variorum_pop_prefetch_control =
+            intel_cpu_fm_06_4f_pop_prefetch_control;
+        g_platform[idx].variorum_cap_turbo_ratio_limit =
+            intel_cpu_fm_06_4f_cap_turbo_ratio_limit;
+        g_platform[idx].variorum_get_energy_perf_bias =
+            intel_cpu_fm_06_4f_get_energy_perf_bias;
+        g_platform[idx].variorum_set_energy_perf_bias =
+            intel_cpu_fm_06_4f_set_energy_perf_bias;
+        g_platform[idx].variorum_get_turbo_cores =
+            intel_cpu_fm_06_4f_get_turbo_cores;
+        g_platform[idx].variorum_set_turbo_cores =
+            intel_cpu_fm_06_4f_set_turbo_cores;
+        g_platform[idx].variorum_get_thread_fixed_counters =
+            intel_cpu_fm_06_4f_get_thread_fixed_counters;
+        g_platform[idx].variorum_arm_snapshot =
+            intel_cpu_fm_06_4f_arm_snapshot;
     }
     // Skylake 06_55
     else if (*g_platform[idx].arch_id == FM_06_55)
@@ -244,6 +466,13 @@ int set_intel_func_ptrs(int idx)
         g_platform[idx].variorum_print_features = intel_cpu_fm_06_55_get_features;
         g_platform[idx].variorum_print_thermals = intel_cpu_fm_06_55_get_thermals;
         g_platform[idx].variorum_print_counters = intel_cpu_fm_06_55_get_counters;
+        g_platform[idx].variorum_start_pmc_events =
+            intel_cpu_fm_06_55_start_pmc_events;
+        g_platform[idx].variorum_read_pmc_events =
+            intel_cpu_fm_06_55_read_pmc_events;
+        g_platform[idx].variorum_stop_pmc_events =
+            intel_cpu_fm_06_55_stop_pmc_events;
+        pmc_event_table_select(&pmc_events_skylakex);
         g_platform[idx].variorum_print_frequency = intel_cpu_fm_06_55_get_clocks;
         g_platform[idx].variorum_print_power = intel_cpu_fm_06_55_get_power;
         g_platform[idx].variorum_print_energy = intel_cpu_fm_06_55_get_energy;
@@ -268,6 +497,45 @@ int set_intel_func_ptrs(int idx)
             intel_cpu_fm_06_55_get_clocks_json;
         g_platform[idx].variorum_get_energy_json =
             intel_cpu_fm_06_55_get_energy_json;
+        g_platform[idx].variorum_get_metrics = intel_cpu_fm_06_55_get_metrics;
+        g_platform[idx].variorum_get_energy_metrics =
+            intel_cpu_fm_06_55_get_energy_metrics;
+        g_platform[idx].variorum_get_cstate_residency_json =
+            intel_cpu_fm_06_55_get_cstate_residency_json;
+        g_platform[idx].variorum_cap_core_cstate_latency =
+            intel_cpu_fm_06_55_cap_core_cstate_latency;
+        g_platform[idx].variorum_cap_socket_cstate_latency =
+            intel_cpu_fm_06_55_cap_socket_cstate_latency;
+        g_platform[idx].variorum_cap_node_cstate_latency =
+            intel_cpu_fm_06_55_cap_node_cstate_latency;
+        g_platform[idx].variorum_cap_socket_pkg_cstate_limit =
+            intel_cpu_fm_06_55_cap_socket_pkg_cstate_limit;
+        g_platform[idx].variorum_save_cstate_limits =
+            intel_cpu_fm_06_55_save_cstate_limits;
+        g_platform[idx].variorum_restore_cstate_limits =
+            intel_cpu_fm_06_55_restore_cstate_limits;
+        g_platform[idx].variorum_get_prefetch_control =
+            intel_cpu_fm_06_55_get_prefetch_control;
+        g_platform[idx].variorum_set_prefetch_control =
+            intel_cpu_fm_06_55_set_prefetch_control;
+        g_platform[idx].variorum_push_prefetch_control =
+            intel_cpu_fm_06_55_push_prefetch_control;
+        g_platform[idx].variorum_pop_prefetch_control =
+            intel_cpu_fm_06_55_pop_prefetch_control;
+        g_platform[idx].variorum_cap_turbo_ratio_limit =
+            intel_cpu_fm_06_55_cap_turbo_ratio_limit;
+        g_platform[idx].variorum_get_energy_perf_bias =
+            intel_cpu_fm_06_55_get_energy_perf_bias;
+        g_platform[idx].variorum_set_energy_perf_bias =
+            intel_cpu_fm_06_55_set_energy_perf_bias;
+        g_platform[idx].variorum_get_turbo_cores =
+            intel_cpu_fm_06_55_get_turbo_cores;
+        g_platform[idx].variorum_set_turbo_cores =
+            intel_cpu_fm_06_55_set_turbo_cores;
+        g_platform[idx].variorum_get_thread_fixed_counters =
+            intel_cpu_fm_06_55_get_thread_fixed_counters;
+        g_platform[idx].variorum_arm_snapshot =
+            intel_cpu_fm_06_55_arm_snapshot;
     }
     // Kaby Lake 06_9E
     else if (*g_platform[idx].arch_id == FM_06_9E)
@@ -279,6 +547,13 @@ int set_intel_func_ptrs(int idx)
         g_platform[idx].variorum_print_features = intel_cpu_fm_06_9e_get_features;
         g_platform[idx].variorum_print_thermals = intel_cpu_fm_06_9e_get_thermals;
         g_platform[idx].variorum_print_counters = intel_cpu_fm_06_9e_get_counters;
+        g_platform[idx].variorum_start_pmc_events =
+            intel_cpu_fm_06_9e_start_pmc_events;
+        g_platform[idx].variorum_read_pmc_events =
+            intel_cpu_fm_06_9e_read_pmc_events;
+        g_platform[idx].variorum_stop_pmc_events =
+            intel_cpu_fm_06_9e_stop_pmc_events;
+        pmc_event_table_select(&pmc_events_kabylake);
         g_platform[idx].variorum_print_frequency = intel_cpu_fm_06_9e_get_clocks;
         g_platform[idx].variorum_print_power = intel_cpu_fm_06_9e_get_power;
         g_platform[idx].variorum_print_energy = intel_cpu_fm_06_9e_get_energy;
@@ -299,6 +574,42 @@ int set_intel_func_ptrs(int idx)
             intel_cpu_fm_06_9e_get_thermals_json;
         g_platform[idx].variorum_get_frequency_json =
             intel_cpu_fm_06_9e_get_clocks_json;
+        g_platform[idx].variorum_get_cstate_residency_json =
+            intel_cpu_fm_06_9e_get_cstate_residency_json;
+        g_platform[idx].variorum_cap_core_cstate_latency =
+            intel_cpu_fm_06_9e_cap_core_cstate_latency;
+        g_platform[idx].variorum_cap_socket_cstate_latency =
+            intel_cpu_fm_06_9e_cap_socket_cstate_latency;
+        g_platform[idx].variorum_cap_node_cstate_latency =
+            intel_cpu_fm_06_9e_cap_node_cstate_latency;
+        g_platform[idx].variorum_cap_socket_pkg_cstate_limit =
+            intel_cpu_fm_06_9e_cap_socket_pkg_cstate_limit;
+        g_platform[idx].variorum_save_cstate_limits =
+            intel_cpu_fm_06_9e_save_cstate_limits;
+        g_platform[idx].variorum_restore_cstate_limits =
+            intel_cpu_fm_06_9e_restore_cstate_limits;
+        g_platform[idx].variorum_get_prefetch_control =
+            intel_cpu_fm_06_9e_get_prefetch_control;
+        g_platform[idx].variorum_set_prefetch_control =
+            intel_cpu_fm_06_9e_set_prefetch_control;
+        g_platform[idx].variorum_push_prefetch_control =
+            intel_cpu_fm_06_9e_push_prefetch_control;
+        g_platform[idx].variorum_pop_prefetch_control =
+            intel_cpu_fm_06_9e_pop_prefetch_control;
+        g_platform[idx].variorum_cap_turbo_ratio_limit =
+            intel_cpu_fm_06_9e_cap_turbo_ratio_limit;
+        g_platform[idx].variorum_get_energy_perf_bias =
+            intel_cpu_fm_06_9e_get_energy_perf_bias;
+        g_platform[idx].variorum_set_energy_perf_bias =
+            intel_cpu_fm_06_9e_set_energy_perf_bias;
+        g_platform[idx].variorum_get_turbo_cores =
+            intel_cpu_fm_06_9e_get_turbo_cores;
+        g_platform[idx].variorum_set_turbo_cores =
+            intel_cpu_fm_06_9e_set_turbo_cores;
+        g_platform[idx].variorum_get_thread_fixed_counters =
+            intel_cpu_fm_06_9e_get_thread_fixed_counters;
+        g_platform[idx].variorum_arm_snapshot =
+            intel_cpu_fm_06_9e_arm_snapshot;
     }
     // Ice Lake 06_6A
     else if (*g_platform[idx].arch_id == FM_06_6A)
@@ -308,6 +619,39 @@ int set_intel_func_ptrs(int idx)
         g_platform[idx].variorum_print_features = intel_cpu_fm_06_6a_get_features;
         g_platform[idx].variorum_print_power = intel_cpu_fm_06_6a_get_power;
         g_platform[idx].variorum_print_energy = intel_cpu_fm_06_6a_get_energy;
+        g_platform[idx].variorum_get_metrics = intel_cpu_fm_06_6a_get_metrics;
+        g_platform[idx].variorum_get_energy_metrics =
+            intel_cpu_fm_06_6a_get_energy_metrics;
+        g_platform[idx].variorum_get_cstate_residency_json =
+            intel_cpu_fm_06_6a_get_cstate_residency_json;
+        g_platform[idx].variorum_cap_core_cstate_latency =
+            intel_cpu_fm_06_6a_cap_core_cstate_latency;
+        g_platform[idx].variorum_cap_socket_cstate_latency =
+            intel_cpu_fm_06_6a_cap_socket_cstate_latency;
+        g_platform[idx].variorum_cap_node_cstate_latency =
+            intel_cpu_fm_06_6a_cap_node_cstate_latency;
+        g_platform[idx].variorum_cap_socket_pkg_cstate_limit =
+            intel_cpu_fm_06_6a_cap_socket_pkg_cstate_limit;
+        g_platform[idx].variorum_save_cstate_limits =
+            intel_cpu_fm_06_6a_save_cstate_limits;
+        g_platform[idx].variorum_restore_cstate_limits =
+            intel_cpu_fm_06_6a_restore_cstate_limits;
+        g_platform[idx].variorum_get_prefetch_control =
+            intel_cpu_fm_06_6a_get_prefetch_control;
+        g_platform[idx].variorum_set_prefetch_control =
+            intel_cpu_fm_06_6a_set_prefetch_control;
+        g_platform[idx].variorum_push_prefetch_control =
+            intel_cpu_fm_06_6a_push_prefetch_control;
+        g_platform[idx].variorum_pop_prefetch_control =
+            intel_cpu_fm_06_6a_pop_prefetch_control;
+        g_platform[idx].variorum_get_energy_perf_bias =
+            intel_cpu_fm_06_6a_get_energy_perf_bias;
+        g_platform[idx].variorum_set_energy_perf_bias =
+            intel_cpu_fm_06_6a_set_energy_perf_bias;
+        g_platform[idx].variorum_get_turbo_cores =
+            intel_cpu_fm_06_6a_get_turbo_cores;
+        g_platform[idx].variorum_set_turbo_cores =
+            intel_cpu_fm_06_6a_set_turbo_cores;
     }
     // Sapphire Rapids 06_8F
     else if (*g_platform[idx].arch_id == FM_06_8F)
@@ -321,6 +665,43 @@ int set_intel_func_ptrs(int idx)
         g_platform[idx].variorum_get_node_power_domain_info_json =
             fm_06_8f_get_node_power_domain_info_json;
         g_platform[idx].variorum_monitoring = fm_06_8f_monitoring;
+        g_platform[idx].variorum_get_metrics = fm_06_8f_get_metrics;
+        g_platform[idx].variorum_get_energy_metrics =
+            fm_06_8f_get_energy_metrics;
+        g_platform[idx].variorum_get_cstate_residency_json =
+            fm_06_8f_get_cstate_residency_json;
+        g_platform[idx].variorum_cap_core_cstate_latency =
+            fm_06_8f_cap_core_cstate_latency;
+        g_platform[idx].variorum_cap_socket_cstate_latency =
+            fm_06_8f_cap_socket_cstate_latency;
+        g_platform[idx].variorum_cap_node_cstate_latency =
+            fm_06_8f_cap_node_cstate_latency;
+        g_platform[idx].variorum_cap_socket_pkg_cstate_limit =
+            fm_06_8f_cap_socket_pkg_cstate_limit;
+        g_platform[idx].variorum_save_cstate_limits =
+            fm_06_8f_save_cstate_limits;
+        g_platform[idx].variorum_restore_cstate_limits =
+            fm_06_8f_restore_cstate_limits;
+        g_platform[idx].variorum_get_prefetch_control =
+            fm_06_8f_get_prefetch_control;
+        g_platform[idx].variorum_set_prefetch_control =
+            fm_06_8f_set_prefetch_control;
+        g_platform[idx].variorum_push_prefetch_control =
+            fm_06_8f_push_prefetch_control;
+        g_platform[idx].variorum_pop_prefetch_control =
+            fm_06_8f_pop_prefetch_control;
+        g_platform[idx].variorum_get_energy_perf_bias =
+            fm_06_8f_get_energy_perf_bias;
+        g_platform[idx].variorum_set_energy_perf_bias =
+            fm_06_8f_set_energy_perf_bias;
+        g_platform[idx].variorum_get_turbo_cores =
+            fm_06_8f_get_turbo_cores;
+        g_platform[idx].variorum_set_turbo_cores =
+            fm_06_8f_set_turbo_cores;
+        g_platform[idx].variorum_get_thread_fixed_counters =
+            fm_06_8f_get_thread_fixed_counters;
+        g_platform[idx].variorum_arm_snapshot =
+            fm_06_8f_arm_snapshot;
     }
     else
     {
@@ -3,17 +3,27 @@
 //
 // SPDX-License-Identifier: MIT
 
+#define _GNU_SOURCE
+#include <sched.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <clocks_features.h>
 #include <counters_features.h>
+#include <cstate_features.h>
 #include <config_architecture.h>
+#include <derived_features.h>
+#include <misc_features.h>
 #include <msr_core.h>
+#include <msr_soa.h>
+#include <pmc_event_table.h>
 #include <intel_power_features.h>
 #include <variorum_cpuid.h>
 #include <variorum_error.h>
@@ -38,6 +48,26 @@ int cpuid_num_pmc(void)
     return MASK_VAL(rax, 15, 8);
 }
 
+int cpuid_pmc_width(void)
+{
+    /* See Manual Vol 3B, Section 18.2.1 for details. */
+    uint64_t rax, rbx, rcx, rdx;
+    int leaf = 10; // 0A
+
+    cpuid(leaf, &rax, &rbx, &rcx, &rdx);
+    return MASK_VAL(rax, 23, 16);
+}
+
+int cpuid_fixed_width(void)
+{
+    /* See Manual Vol 3B, Section 18.2.2 for details. */
+    uint64_t rax, rbx, rcx, rdx;
+    int leaf = 10; // 0A
+
+    cpuid(leaf, &rax, &rbx, &rcx, &rdx);
+    return MASK_VAL(rdx, 12, 5);
+}
+
 /*****************************************/
 /* Fixed Counters Performance Monitoring */
 /*****************************************/
@@ -138,6 +168,39 @@ void disable_fixed_counters(off_t *msrs_fixed_ctrs, off_t msr1, off_t msr2)
     set_fixed_counter_ctrl(c0, c1, c2, msr1, msr2);
 }
 
+int get_thread_fixed_counters(off_t *msrs_fixed_ctrs, off_t msr1, off_t msr2,
+                              uint64_t *counts)
+{
+    static int init = 0;
+    struct fixed_counter *c0, *c1, *c2;
+    int cpu;
+
+    fixed_counter_storage(&c0, &c1, &c2, msrs_fixed_ctrs);
+    if (!init)
+    {
+        enable_fixed_counters(msrs_fixed_ctrs, msr1, msr2);
+        init = 1;
+    }
+    if (read_batch(FIXED_COUNTERS_DATA))
+    {
+        variorum_error_handler("Batch read error", VARIORUM_ERROR_MSR_BATCH,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    cpu = sched_getcpu();
+    if (cpu < 0)
+    {
+        variorum_error_handler("Cannot determine current CPU",
+                               VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    counts[0] = *c0->value[cpu];
+    counts[1] = *c1->value[cpu];
+    counts[2] = *c2->value[cpu];
+    return 0;
+}
+
 void set_fixed_counter_ctrl(struct fixed_counter *ctr0,
                             struct fixed_counter *ctr1, struct fixed_counter *ctr2, off_t msr1, off_t msr2)
 {
@@ -1077,6 +1140,459 @@ void clear_all_pmc(off_t *msrs_perfmon_ctrs)
     write_batch(COUNTERS_DATA);
 }
 
+/****************************/
+/* Performance Event Groups */
+/****************************/
+
+/* IA32_PERFEVTSELx flags [23:16] */
+#define PMC_FLAG_USR 0x01
+#define PMC_FLAG_OS  0x02
+#define PMC_FLAG_EN  0x40
+
+static struct pmc_groups *pmc_groups_state = NULL;
+
+static uint64_t pmc_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * (uint64_t)1000000000 + ts.tv_nsec;
+}
+
+int pmc_event_encode(const char *name, uint64_t *evtsel, uint8_t *counters)
+{
+    const struct pmc_event_def *def;
+    const char *hex = NULL;
+    char *end = NULL;
+    uint64_t raw;
+    uint64_t flags;
+
+    // Model-specific names first, then the architectural events.
+    def = pmc_event_lookup(pmc_event_table_selected(), name);
+    if (def == NULL)
+    {
+        def = pmc_event_lookup(&pmc_events_architectural, name);
+    }
+    if (def != NULL)
+    {
+        *evtsel = ((uint64_t)def->cmask << 24) |
+                  ((uint64_t)(def->flags | PMC_FLAG_EN | PMC_FLAG_OS | PMC_FLAG_USR) << 16) |
+                  ((uint64_t)def->umask << 8) | def->eventsel;
+        *counters = def->counters;
+        return 0;
+    }
+
+    if (name[0] == 'r' || name[0] == 'R')
+    {
+        hex = name + 1;
+    }
+    else if (name[0] == '0' && (name[1] == 'x' || name[1] == 'X'))
+    {
+        hex = name + 2;
+    }
+    if (hex == NULL || *hex == '\0')
+    {
+        return -1;
+    }
+    raw = strtoull(hex, &end, 16);
+    if (*end != '\0' || raw > 0xFFFFFFFFULL)
+    {
+        return -1;
+    }
+
+    flags = MASK_VAL(raw, 23, 16);
+    if (flags == 0)
+    {
+        flags = PMC_FLAG_OS | PMC_FLAG_USR;
+    }
+    *evtsel = (raw & ~MASK_RANGE(23, 16)) | ((flags | PMC_FLAG_EN) << 16);
+    *counters = 0xFF;
+    return 0;
+}
+
+uint64_t pmc_scale_count(uint64_t count, uint64_t enabled_ns,
+                         uint64_t running_ns)
+{
+    if (running_ns == 0)
+    {
+        return 0;
+    }
+    if (running_ns >= enabled_ns)
+    {
+        return count;
+    }
+    return (uint64_t)((double)count * enabled_ns / running_ns);
+}
+
+static void free_pmc_groups(struct pmc_groups *pg)
+{
+    int i;
+
+    for (i = 0; i < pg->nevents; i++)
+    {
+        free(pg->events[i].count);
+        free(pg->events[i].last);
+    }
+    free(pg->events);
+    free(pg->running_ns);
+    free(pg->raw);
+    free(pg);
+}
+
+/// @brief Write the event select values of the active group to all logical
+/// processors with one COUNTERS_CTRL batch. Counters not used by the group
+/// are disabled.
+static void program_pmc_group(struct pmc_groups *pg, struct perfevtsel *evt,
+                              unsigned nthreads)
+{
+    uint64_t **sel[PMC_MAX_COUNTERS] =
+    {
+        evt->perf_evtsel0, evt->perf_evtsel1, evt->perf_evtsel2, evt->perf_evtsel3,
+        evt->perf_evtsel4, evt->perf_evtsel5, evt->perf_evtsel6, evt->perf_evtsel7
+    };
+    unsigned t;
+    int c, e;
+
+    for (c = 0; c < pg->npmc; c++)
+    {
+        for (t = 0; t < nthreads; t++)
+        {
+            *sel[c][t] = 0;
+        }
+    }
+    for (e = 0; e < pg->nevents; e++)
+    {
+        if (pg->events[e].group != pg->active)
+        {
+            continue;
+        }
+        for (t = 0; t < nthreads; t++)
+        {
+            *sel[pg->events[e].counter][t] = pg->events[e].evtsel;
+        }
+    }
+    write_batch(COUNTERS_CTRL);
+}
+
+/// @brief Program the active group on counters cleared to 0, which is then
+/// the starting point of its events. The counters are disabled before they
+/// are cleared, so no counts of the previous group carry over.
+static void start_pmc_group(struct pmc_groups *pg, struct perfevtsel *evt,
+                            struct pmc *p, unsigned nthreads)
+{
+    uint64_t **sel[PMC_MAX_COUNTERS] =
+    {
+        evt->perf_evtsel0, evt->perf_evtsel1, evt->perf_evtsel2, evt->perf_evtsel3,
+        evt->perf_evtsel4, evt->perf_evtsel5, evt->perf_evtsel6, evt->perf_evtsel7
+    };
+    uint64_t **ctr[PMC_MAX_COUNTERS] =
+    {
+        p->pmc0, p->pmc1, p->pmc2, p->pmc3, p->pmc4, p->pmc5, p->pmc6, p->pmc7
+    };
+    unsigned t;
+    int c, e;
+
+    for (c = 0; c < pg->npmc; c++)
+    {
+        for (t = 0; t < nthreads; t++)
+        {
+            *sel[c][t] = 0;
+        }
+    }
+    write_batch(COUNTERS_CTRL);
+    for (c = 0; c < pg->npmc; c++)
+    {
+        for (t = 0; t < nthreads; t++)
+        {
+            *ctr[c][t] = 0;
+        }
+    }
+    write_batch(COUNTERS_DATA);
+    for (e = 0; e < pg->nevents; e++)
+    {
+        if (pg->events[e].group == pg->active)
+        {
+            memset(pg->events[e].last, 0, nthreads * sizeof(uint64_t));
+        }
+    }
+    program_pmc_group(pg, evt, nthreads);
+}
+
+/// @brief Read all counters with one COUNTERS_DATA batch and add the change
+/// since the last read to the events of the active group.
+static void accumulate_pmc_group(struct pmc_groups *pg, struct pmc *p,
+                                 unsigned nthreads)
+{
+    uint64_t **ctr[PMC_MAX_COUNTERS] =
+    {
+        p->pmc0, p->pmc1, p->pmc2, p->pmc3, p->pmc4, p->pmc5, p->pmc6, p->pmc7
+    };
+    struct pmc_event *ev;
+    uint64_t now;
+    int e;
+
+    read_batch(COUNTERS_DATA);
+    now = pmc_now_ns();
+    pg->enabled_ns += now - pg->last_ns;
+    pg->running_ns[pg->active] += now - pg->last_ns;
+    pg->last_ns = now;
+
+    for (e = 0; e < pg->nevents; e++)
+    {
+        ev = &pg->events[e];
+        if (ev->group != pg->active)
+        {
+            continue;
+        }
+        msr_soa_gather(nthreads, ctr[ev->counter], pg->raw);
+        msr_soa_accumulate(nthreads, pg->width_mask, pg->raw, ev->last, ev->count);
+    }
+}
+
+/// @brief Place an event on the first free counter it can use, in the first
+/// group with such a counter, opening a new group if needed.
+///
+/// @return 0 if successful, else -1 if none of the available counters can
+/// count the event.
+static int schedule_pmc_event(struct pmc_groups *pg, uint8_t **used,
+                              struct pmc_event *ev, uint8_t counters)
+{
+    unsigned allowed = counters & ((1U << pg->npmc) - 1);
+    int g, c;
+
+    if (allowed == 0)
+    {
+        return -1;
+    }
+    for (g = 0; ; g++)
+    {
+        if (g == pg->ngroups)
+        {
+            *used = (uint8_t *) realloc(*used, (g + 1) * sizeof(uint8_t));
+            (*used)[g] = 0;
+            pg->ngroups++;
+        }
+        for (c = 0; c < pg->npmc; c++)
+        {
+            if ((allowed & (1U << c)) && !((*used)[g] & (1U << c)))
+            {
+                (*used)[g] |= 1U << c;
+                ev->group = g;
+                ev->counter = c;
+                return 0;
+            }
+        }
+    }
+}
+
+int pmc_groups_start(const char *events, off_t *msrs_perfevtsel_ctrs,
+                     off_t *msrs_perfmon_ctrs)
+{
+    struct pmc_groups *pg = NULL;
+    struct perfevtsel *evt = NULL;
+    struct pmc *p = NULL;
+    unsigned nthreads = 0;
+    char *list, *tok, *save = NULL;
+    char *variorum_error_msg;
+    uint64_t evtsel;
+    uint8_t counters;
+    uint8_t *used = NULL;
+    int avail, width;
+    char *val;
+
+    if (pmc_groups_state != NULL)
+    {
+        pmc_groups_stop(msrs_perfevtsel_ctrs);
+    }
+
+    avail = cpuid_num_pmc();
+    if (avail < 1)
+    {
+        variorum_error_handler("No general-purpose performance counters available",
+                               VARIORUM_ERROR_FEATURE_NOT_AVAILABLE,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    if (avail > PMC_MAX_COUNTERS)
+    {
+        avail = PMC_MAX_COUNTERS;
+    }
+    if (events == NULL || *events == '\0')
+    {
+        variorum_error_handler("No events requested", VARIORUM_ERROR_INVAL,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(NULL, NULL, &nthreads, P_INTEL_CPU_IDX);
+#endif
+
+    pg = (struct pmc_groups *) calloc(1, sizeof(struct pmc_groups));
+    pg->npmc = avail;
+    width = cpuid_pmc_width();
+    pg->width_mask = msr_soa_mask(width);
+    pg->interval_ns = PMC_DEFAULT_MUX_INTERVAL_MS * (uint64_t)1000000;
+    val = getenv("VARIORUM_PMC_MUX_INTERVAL_MS");
+    if (val != NULL && atoi(val) > 0)
+    {
+        pg->interval_ns = atoi(val) * (uint64_t)1000000;
+    }
+
+    list = strdup(events);
+    for (tok = strtok_r(list, ",", &save); tok != NULL;
+         tok = strtok_r(NULL, ",", &save))
+    {
+        while (*tok == ' ')
+        {
+            tok++;
+        }
+        if (pmc_event_encode(tok, &evtsel, &counters) != 0)
+        {
+            variorum_error_msg = (char *) malloc(NAME_MAX * sizeof(char));
+            snprintf(variorum_error_msg, NAME_MAX, "Unknown event %s", tok);
+            variorum_error_handler(variorum_error_msg, VARIORUM_ERROR_INVAL,
+                                   getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+            free(variorum_error_msg);
+            free(used);
+            free(list);
+            free_pmc_groups(pg);
+            return -1;
+        }
+        pg->events = (struct pmc_event *) realloc(pg->events,
+                     (pg->nevents + 1) * sizeof(struct pmc_event));
+        memset(&pg->events[pg->nevents], 0, sizeof(struct pmc_event));
+        snprintf(pg->events[pg->nevents].name, VARIORUM_METRIC_NAME_LEN, "%s", tok);
+        pg->events[pg->nevents].evtsel = evtsel;
+        if (schedule_pmc_event(pg, &used, &pg->events[pg->nevents], counters) != 0)
+        {
+            variorum_error_msg = (char *) malloc(NAME_MAX * sizeof(char));
+            snprintf(variorum_error_msg, NAME_MAX,
+                     "Event %s cannot be counted on the available counters", tok);
+            variorum_error_handler(variorum_error_msg, VARIORUM_ERROR_INVAL,
+                                   getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+            free(variorum_error_msg);
+            free(used);
+            free(list);
+            free_pmc_groups(pg);
+            return -1;
+        }
+        pg->events[pg->nevents].count = (uint64_t *) msr_soa_alloc(nthreads,
+                                        sizeof(uint64_t));
+        pg->events[pg->nevents].last = (uint64_t *) msr_soa_alloc(nthreads,
+                                       sizeof(uint64_t));
+        pg->nevents++;
+    }
+    free(list);
+    free(used);
+
+    if (pg->nevents == 0)
+    {
+        variorum_error_handler("No events requested", VARIORUM_ERROR_INVAL,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+        free_pmc_groups(pg);
+        return -1;
+    }
+    pg->running_ns = (uint64_t *) calloc(pg->ngroups, sizeof(uint64_t));
+    pg->raw = (uint64_t *) msr_soa_alloc(nthreads, sizeof(uint64_t));
+
+    perfevtsel_storage(&evt, msrs_perfevtsel_ctrs);
+    pmc_storage(&p, msrs_perfmon_ctrs);
+
+    pg->active = 0;
+    start_pmc_group(pg, evt, p, nthreads);
+    pg->last_ns = pg->switch_ns = pmc_now_ns();
+
+    pmc_groups_state = pg;
+    return 0;
+}
+
+int pmc_groups_read(struct variorum_metric_vector *metrics,
+                    off_t *msrs_perfevtsel_ctrs, off_t *msrs_perfmon_ctrs)
+{
+    struct pmc_groups *pg = pmc_groups_state;
+    struct perfevtsel *evt = NULL;
+    struct pmc *p = NULL;
+    struct timeval now;
+    unsigned nthreads = 0;
+    uint64_t ts;
+    unsigned t;
+    int e;
+
+    if (pg == NULL)
+    {
+        variorum_error_handler("No performance events started",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(NULL, NULL, &nthreads, P_INTEL_CPU_IDX);
+#endif
+    perfevtsel_storage(&evt, msrs_perfevtsel_ctrs);
+    pmc_storage(&p, msrs_perfmon_ctrs);
+
+    accumulate_pmc_group(pg, p, nthreads);
+    gettimeofday(&now, NULL);
+    ts = now.tv_sec * (uint64_t)1000000 + now.tv_usec;
+
+    for (e = 0; e < pg->nevents; e++)
+    {
+        if (pg->running_ns[pg->events[e].group] == 0)
+        {
+            continue;
+        }
+        for (t = 0; t < nthreads; t++)
+        {
+            variorum_metric_vector_append(metrics, pg->events[e].name,
+                                          VARIORUM_DOMAIN_THREAD, t,
+                                          (double)pmc_scale_count(pg->events[e].count[t],
+                                                  pg->enabled_ns,
+                                                  pg->running_ns[pg->events[e].group]),
+                                          ts);
+        }
+    }
+
+    // Rotation happens here rather than on a timer thread because the MSR
+    // files are only open for the duration of a variorum call.
+    if (pg->ngroups > 1 && pg->last_ns - pg->switch_ns >= pg->interval_ns)
+    {
+        pg->active = (pg->active + 1) % pg->ngroups;
+        start_pmc_group(pg, evt, p, nthreads);
+        pg->switch_ns = pg->last_ns;
+    }
+    return 0;
+}
+
+int pmc_groups_stop(off_t *msrs_perfevtsel_ctrs)
+{
+    struct pmc_groups *pg = pmc_groups_state;
+    struct perfevtsel *evt = NULL;
+    unsigned nthreads = 0;
+
+    if (pg == NULL)
+    {
+        variorum_error_handler("No performance events started",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(NULL, NULL, &nthreads, P_INTEL_CPU_IDX);
+#endif
+    perfevtsel_storage(&evt, msrs_perfevtsel_ctrs);
+
+    // An empty group disables every counter.
+    pg->active = -1;
+    program_pmc_group(pg, evt, nthreads);
+
+    free_pmc_groups(pg);
+    pmc_groups_state = NULL;
+    return 0;
+}
+
 ///*************************************/
 ///* Uncore PCU Performance Monitoring */
 ///*************************************/
@@ -1277,7 +1793,8 @@ void get_all_power_data_fixed(FILE *writedest, off_t msr_pkg_power_limit,
                               off_t msr_dram_power_limit, off_t msr_rapl_unit,
                               off_t msr_package_energy_status, off_t msr_dram_energy_status,
                               off_t *msrs_fixed_ctrs, off_t msr_perf_global_ctrl,
-                              off_t msr_fixed_counter_ctrl, off_t msr_aperf, off_t msr_mperf, off_t msr_tsc)
+                              off_t msr_fixed_counter_ctrl, off_t msr_aperf, off_t msr_mperf, off_t msr_tsc,
+                              off_t msr_platform_info, const struct cstate_msrs *cstates)
 {
     // The length of the rlim array assumes dual socket system.
     static struct rapl_limit *rlim;
@@ -1285,18 +1802,26 @@ void get_all_power_data_fixed(FILE *writedest, off_t msr_pkg_power_limit,
     static struct rapl_data *rapl = NULL;
     static struct fixed_counter *c0, *c1, *c2;
     static struct clocks_data *cd;
+    static struct derived_metrics dm;
     static int init_get_power_data = 0;
-    static unsigned nsockets, nthreads;
+    static unsigned nsockets, ncores, nthreads;
+    struct cstate_data *cs = NULL;
     char hostname[1024];
-    unsigned i;
+    unsigned i, j, s;
     int rlim_idx = 0;
+    int max_non_turbo_ratio = 0;
+    double derived[5];
 
 #ifdef VARIORUM_WITH_INTEL_CPU
-    variorum_get_topology(&nsockets, NULL, &nthreads, P_INTEL_CPU_IDX);
+    variorum_get_topology(&nsockets, &ncores, &nthreads, P_INTEL_CPU_IDX);
 #endif
     gethostname(hostname, 1024);
 
     get_power(msr_rapl_unit, msr_package_energy_status, msr_dram_energy_status);
+    if (sample_cstate_residency(cstates, &cs))
+    {
+        exit(1);
+    }
 
     if (!init_get_power_data)
     {
@@ -1314,12 +1839,19 @@ void get_all_power_data_fixed(FILE *writedest, off_t msr_pkg_power_limit,
         enable_fixed_counters(msrs_fixed_ctrs, msr_perf_global_ctrl,
                               msr_fixed_counter_ctrl);
         clocks_storage(&cd, msr_aperf, msr_mperf, msr_tsc);
+        get_max_non_turbo_ratio(msr_platform_info, &max_non_turbo_ratio);
+        derived_metrics_init(&dm, nsockets, ncores, nthreads,
+                             max_non_turbo_ratio, cpuid_fixed_width());
+        // enable_fixed_counters() sets AnyThread.
+        dm.any_thread = 1;
 #ifdef LIBJUSTIFY_FOUND
         int pkglabels = 5;
+        int derivedlabels = 5;
         int threadlabels = 6;
         int max_str_len = 128;
         char pkg_strs[nsockets][pkglabels][max_str_len];
         char thread_strs[nthreads][threadlabels][max_str_len];
+        char derived_strs[nsockets][derivedlabels][max_str_len];
 
         for (i = 0; i < nsockets; i++)
         {
@@ -1338,6 +1870,14 @@ void get_all_power_data_fixed(FILE *writedest, off_t msr_pkg_power_limit,
             snprintf(thread_strs[i][4], max_str_len, "MPERF%d", i);
             snprintf(thread_strs[i][4], max_str_len, "TSC%d", i);
         }
+        for (i = 0; i < nsockets; i++)
+        {
+            snprintf(derived_strs[i][0], max_str_len, "pkg%d_ipc", i);
+            snprintf(derived_strs[i][1], max_str_len, "pkg%d_busy_ghz", i);
+            snprintf(derived_strs[i][2], max_str_len, "pkg%d_util_percent", i);
+            snprintf(derived_strs[i][3], max_str_len, "pkg%d_inst_per_joule", i);
+            snprintf(derived_strs[i][4], max_str_len, "pkg%d_watts", i);
+        }
 
         cfprintf(writedest, "%-s %s ", "_VAR_MONITOR", "time");
 #else
@@ -1389,6 +1929,42 @@ void get_all_power_data_fixed(FILE *writedest, off_t msr_pkg_power_limit,
                     i, i, i);
 #endif
         }
+
+        for (i = 0; i < nsockets; i++)
+        {
+#ifdef LIBJUSTIFY_FOUND
+            cfprintf(writedest, "%s %s %s %s %s ",
+                     derived_strs[i][0], derived_strs[i][1],
+                     derived_strs[i][2], derived_strs[i][3],
+                     derived_strs[i][4]);
+#else
+            fprintf(writedest,
+                    " pkg%d_ipc pkg%d_busy_ghz pkg%d_util_percent pkg%d_inst_per_joule pkg%d_watts",
+                    i, i, i, i, i);
+#endif
+        }
+
+        // Package C-states of each socket, then the average of its cores in
+        // each core C-state.
+        for (i = 0; i < nsockets; i++)
+        {
+            for (s = 0; s < cs->npkg; s++)
+            {
+#ifdef LIBJUSTIFY_FOUND
+                cfprintf(writedest, "pkg%d_%s_percent ", i, cs->pkg_name[s]);
+#else
+                fprintf(writedest, " pkg%d_%s_percent", i, cs->pkg_name[s]);
+#endif
+            }
+            for (s = 0; s < cs->ncore; s++)
+            {
+#ifdef LIBJUSTIFY_FOUND
+                cfprintf(writedest, "pkg%d_core_%s_percent ", i, cs->core_name[s]);
+#else
+                fprintf(writedest, " pkg%d_core_%s_percent", i, cs->core_name[s]);
+#endif
+            }
+        }
 #ifdef LIBJUSTIFY_FOUND
         cfprintf(writedest, "\n");
 #else
@@ -1398,6 +1974,10 @@ void get_all_power_data_fixed(FILE *writedest, off_t msr_pkg_power_limit,
 
     read_batch(FIXED_COUNTERS_DATA);
     read_batch(CLOCKS_DATA);
+    if (dm.nthreads > 0)
+    {
+        derived_metrics_sample(&dm, c0, c1, cd, rapl->pkg_total_joules);
+    }
     rlim_idx = 0;
     for (i = 0; i < nsockets; i++)
     {
@@ -1440,6 +2020,57 @@ void get_all_power_data_fixed(FILE *writedest, off_t msr_pkg_power_limit,
                 *c2->value[i], *cd->aperf[i], *cd->mperf[i], *cd->tsc[i]);
 #endif
     }
+
+    for (i = 0; i < nsockets; i++)
+    {
+        // Socket entries follow the thread and core entries. All are zero
+        // until the second sample.
+        memset(derived, 0, sizeof(derived));
+        if (dm.nsamples >= 2)
+        {
+            derived[0] = dm.ipc[nthreads + ncores + i];
+            derived[1] = dm.busy_ghz[nthreads + ncores + i];
+            derived[2] = dm.util_percent[nthreads + ncores + i];
+            derived[3] = dm.inst_per_joule[i];
+            derived[4] = dm.socket_watts[i];
+        }
+#ifdef LIBJUSTIFY_FOUND
+        cfprintf(writedest, "%lf %lf %lf %lf %lf ", derived[0], derived[1],
+                 derived[2], derived[3], derived[4]);
+#else
+        fprintf(writedest, " %lf %lf %lf %lf %lf", derived[0], derived[1],
+                derived[2], derived[3], derived[4]);
+#endif
+    }
+
+    for (i = 0; i < nsockets; i++)
+    {
+        unsigned cores_per_socket = ncores / nsockets;
+
+        for (s = 0; s < cs->npkg; s++)
+        {
+#ifdef LIBJUSTIFY_FOUND
+            cfprintf(writedest, "%lf ", cs->pkg_percent[s * nsockets + i]);
+#else
+            fprintf(writedest, " %lf", cs->pkg_percent[s * nsockets + i]);
+#endif
+        }
+        for (s = 0; s < cs->ncore; s++)
+        {
+            double avg = 0.0;
+
+            for (j = 0; j < cores_per_socket; j++)
+            {
+                avg += cs->core_percent[s * ncores + i * cores_per_socket + j];
+            }
+            avg /= cores_per_socket;
+#ifdef LIBJUSTIFY_FOUND
+            cfprintf(writedest, "%lf ", avg);
+#else
+            fprintf(writedest, " %lf", avg);
+#endif
+        }
+    }
 #ifdef LIBJUSTIFY_FOUND
     cfprintf(writedest, "\n");
     cflush();
@@ -8,6 +8,19 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <sys/types.h>
+
+#include <variorum_metrics.h>
+
+struct cstate_msrs;
+
+/// @brief Default time slice in milliseconds for each event group when more
+/// events are requested than there are general-purpose counters, overridden
+/// by VARIORUM_PMC_MUX_INTERVAL_MS.
+#define PMC_DEFAULT_MUX_INTERVAL_MS 10
+
+/// @brief Maximum number of general-purpose counters per logical processor.
+#define PMC_MAX_COUNTERS 8
 
 /// @brief Structure containing configuration data for each fixed-function
 /// performance counter as encoded in IA32_PERF_GLOBAL_CTL and
@@ -138,6 +151,28 @@ void disable_fixed_counters(
     off_t msr2
 );
 
+/// @brief Read the fixed-function counters of the logical processor the
+/// calling thread runs on, with the FIXED_COUNTERS_DATA batch.
+///
+/// This is the fallback for when the thread cannot monitor itself through
+/// perf_event. The counters are enabled on the first call, and count all
+/// threads that ran on the logical processor.
+///
+/// @param [in] msrs_fixed_ctrs Array storing unique MSR addresses for fixed
+///        counters.
+/// @param [in] msr1 Unique MSR address for IA32_PERF_GLOBAL_CTRL.
+/// @param [in] msr2 Unique MSR address for IA32_FIXED_CTR_CTRL.
+/// @param [out] counts Instructions retired, core cycles and reference
+///        cycles.
+///
+/// @return 0 if successful, else -1.
+int get_thread_fixed_counters(
+    off_t *msrs_fixed_ctrs,
+    off_t msr1,
+    off_t msr2,
+    uint64_t *counts
+);
+
 void print_fixed_counter_data(
     FILE *writedest,
     off_t *msrs_fixed_ctrs
@@ -207,6 +242,20 @@ int cpuid_num_pmc(
     void
 );
 
+/// @brief Get the bit width of the general-purpose performance counters.
+///
+/// @return Bit width reported in CPUID.0AH:EAX[23:16].
+int cpuid_pmc_width(
+    void
+);
+
+/// @brief Get the bit width of the fixed-function performance counters.
+///
+/// @return Bit width reported in CPUID.0AH:EDX[12:5].
+int cpuid_fixed_width(
+    void
+);
+
 /// @brief Structure containing data of performance event select counters.
 struct perfevtsel
 {
@@ -312,6 +361,146 @@ void clear_all_pmc(
     off_t *msrs_perfmon_ctrs
 );
 
+/****************************/
+/* Performance Event Groups */
+/****************************/
+
+/// @brief Structure containing one requested event and its counts on each
+/// logical processor.
+struct pmc_event
+{
+    /// @brief Event name as requested, also used as the metric name.
+    char name[VARIORUM_METRIC_NAME_LEN];
+    /// @brief Value written to IA32_PERFEVTSELx while the event is scheduled.
+    uint64_t evtsel;
+    /// @brief Event group the event belongs to.
+    int group;
+    /// @brief General-purpose counter used by the event within its group.
+    int counter;
+    /// @brief Count accumulated while the event was scheduled, per logical
+    /// processor, in an array from msr_soa_alloc().
+    uint64_t *count;
+    /// @brief Counter value at the last read, per logical processor.
+    uint64_t *last;
+};
+
+/// @brief Structure containing the state of the event group engine.
+///
+/// Events are split into groups of at most one event per general-purpose
+/// counter, honoring the counters each event is restricted to. When there is
+/// more than one group, the groups take turns on the counters and each count
+/// is scaled by the ratio of enabled to running time.
+struct pmc_groups
+{
+    /// @brief Requested events.
+    struct pmc_event *events;
+    /// @brief Number of requested events.
+    int nevents;
+    /// @brief Number of event groups.
+    int ngroups;
+    /// @brief Number of general-purpose counters used per group.
+    int npmc;
+    /// @brief Group currently programmed on the counters.
+    int active;
+    /// @brief Mask covering the implemented bits of a counter.
+    uint64_t width_mask;
+    /// @brief Time slice of each group in nanoseconds.
+    uint64_t interval_ns;
+    /// @brief Time since the events were started, in nanoseconds.
+    uint64_t enabled_ns;
+    /// @brief Time each group has been programmed, in nanoseconds.
+    uint64_t *running_ns;
+    /// @brief Monotonic time of the last read, in nanoseconds.
+    uint64_t last_ns;
+    /// @brief Monotonic time the active group was programmed, in nanoseconds.
+    uint64_t switch_ns;
+    /// @brief Contiguous copy of one counter of all logical processors.
+    uint64_t *raw;
+};
+
+/// @brief Translate an event name or raw encoding into an IA32_PERFEVTSELx
+/// value.
+///
+/// Names are looked up in the event table selected for the model, then in
+/// the architectural events (e.g., INSTRUCTION_RETIRED), and are matched
+/// without regard to case. Raw encodings are written as r<hex> or 0x<hex>
+/// with the event select in bits 7:0, the unit mask in bits 15:8, optional
+/// flags in bits 23:16 and the counter mask in bits 31:24. Without flags the
+/// event counts in user and OS mode. The enable bit is always set.
+///
+/// @param [in] name Event name or raw encoding.
+/// @param [out] evtsel Value to write to IA32_PERFEVTSELx.
+/// @param [out] counters Bit mask of the general-purpose counters that can
+///        count the event.
+///
+/// @return 0 if successful, else -1 if the event is unknown.
+int pmc_event_encode(
+    const char *name,
+    uint64_t *evtsel,
+    uint8_t *counters
+);
+
+/// @brief Scale a count by the ratio of enabled to running time.
+///
+/// @param [in] count Count accumulated while the event was scheduled.
+/// @param [in] enabled_ns Time the event was requested.
+/// @param [in] running_ns Time the event was programmed on a counter.
+///
+/// @return Estimated count over the enabled time, or 0 if the event never
+/// ran.
+uint64_t pmc_scale_count(
+    uint64_t count,
+    uint64_t enabled_ns,
+    uint64_t running_ns
+);
+
+/// @brief Schedule a list of events onto the general-purpose counters of all
+/// logical processors and program the first group.
+///
+/// Any events started earlier are stopped first.
+///
+/// @param [in] events Comma-separated list of event names or raw encodings.
+/// @param [in] msrs_perfevtsel_ctrs Array of unique addresses for
+///        PERFEVTSEL_CTRS.
+/// @param [in] msrs_perfmon_ctrs Array of unique addresses for
+///        PERFMON_CTRS.
+///
+/// @return 0 if successful, else -1
+int pmc_groups_start(
+    const char *events,
+    off_t *msrs_perfevtsel_ctrs,
+    off_t *msrs_perfmon_ctrs
+);
+
+/// @brief Accumulate the counters of the active group, rotate to the next
+/// group if its time slice has expired, and append the scaled count of every
+/// event on every logical processor to a metric vector.
+///
+/// Events whose group has not run yet are not appended.
+///
+/// @param [in,out] metrics Metric vector.
+/// @param [in] msrs_perfevtsel_ctrs Array of unique addresses for
+///        PERFEVTSEL_CTRS.
+/// @param [in] msrs_perfmon_ctrs Array of unique addresses for
+///        PERFMON_CTRS.
+///
+/// @return 0 if successful, else -1 if no events were started.
+int pmc_groups_read(
+    struct variorum_metric_vector *metrics,
+    off_t *msrs_perfevtsel_ctrs,
+    off_t *msrs_perfmon_ctrs
+);
+
+/// @brief Disable the general-purpose counters and release the event groups.
+///
+/// @param [in] msrs_perfevtsel_ctrs Array of unique addresses for
+///        PERFEVTSEL_CTRS.
+///
+/// @return 0 if successful, else -1 if no events were started.
+int pmc_groups_stop(
+    off_t *msrs_perfevtsel_ctrs
+);
+
 /// @brief Structure containing data of uncore performance event select
 /// counters.
 struct unc_perfevtsel
@@ -417,7 +606,9 @@ void get_all_power_data_fixed(
     off_t msr_fixed_counter_ctrl,
     off_t msr_aperf,
     off_t msr_mperf,
-    off_t msr_tsc
+    off_t msr_tsc,
+    off_t msr_platform_info,
+    const struct cstate_msrs *cstates
 );
 
 #endif
@@ -0,0 +1,722 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstate_features.h>
+#include <clocks_features.h>
+#include <config_architecture.h>
+#include <msr_core.h>
+#include <msr_soa.h>
+#include <variorum_error.h>
+
+static const char *const cstate_pkg_names[CSTATE_PKG_MAX] =
+{
+    "c2", "c3", "c6", "c7", "c8", "c9", "c10"
+};
+
+static const char *const cstate_core_names[CSTATE_CORE_MAX] =
+{
+    "c3", "c6", "c7"
+};
+
+void cstate_residency_percent(unsigned nstates, unsigned n,
+                              const uint64_t *now, const uint64_t *old, double *percent)
+{
+    const uint64_t *tsc_now = now + nstates * n;
+    const uint64_t *tsc_old = old + nstates * n;
+    unsigned s, i;
+
+    for (s = 0; s < nstates; s++)
+    {
+        for (i = 0; i < n; i++)
+        {
+            uint64_t dtsc = tsc_now[i] - tsc_old[i];
+            uint64_t dres = now[s * n + i] - old[s * n + i];
+            percent[s * n + i] = dtsc > 0 ? 100.0 * dres / dtsc : 0.0;
+        }
+    }
+}
+
+/// @brief Set up the residency batches of all sockets and cores.
+static int cstate_storage(struct cstate_data **data,
+                          const struct cstate_msrs *msrs)
+{
+    static struct cstate_data *cs = NULL;
+    unsigned nsockets = 0;
+    unsigned ncores = 0;
+    off_t pkg_msr[CSTATE_PKG_MAX];
+    off_t core_msr[CSTATE_CORE_MAX];
+    unsigned s, i;
+
+    if (cs != NULL)
+    {
+        *data = cs;
+        return 0;
+    }
+
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(&nsockets, &ncores, NULL, P_INTEL_CPU_IDX);
+#endif
+    if (nsockets == 0 || ncores == 0)
+    {
+        return -1;
+    }
+
+    cs = (struct cstate_data *) calloc(1, sizeof(struct cstate_data));
+    cs->nsockets = nsockets;
+    cs->ncores = ncores;
+    for (s = 0; s < CSTATE_PKG_MAX; s++)
+    {
+        if (msrs->pkg[s] != 0)
+        {
+            pkg_msr[cs->npkg] = msrs->pkg[s];
+            cs->pkg_name[cs->npkg++] = cstate_pkg_names[s];
+        }
+    }
+    for (s = 0; s < CSTATE_CORE_MAX; s++)
+    {
+        if (msrs->core[s] != 0)
+        {
+            core_msr[cs->ncore] = msrs->core[s];
+            cs->core_name[cs->ncore++] = cstate_core_names[s];
+        }
+    }
+
+    cs->pkg_bits = (uint64_t **) calloc((cs->npkg + 1) * nsockets,
+                                        sizeof(uint64_t *));
+    cs->core_bits = (uint64_t **) calloc((cs->ncore + 1) * ncores,
+                                         sizeof(uint64_t *));
+    cs->pkg_now = (uint64_t *) msr_soa_alloc((cs->npkg + 1) * nsockets,
+                  sizeof(uint64_t));
+    cs->pkg_old = (uint64_t *) msr_soa_alloc((cs->npkg + 1) * nsockets,
+                  sizeof(uint64_t));
+    cs->core_now = (uint64_t *) msr_soa_alloc((cs->ncore + 1) * ncores,
+                   sizeof(uint64_t));
+    cs->core_old = (uint64_t *) msr_soa_alloc((cs->ncore + 1) * ncores,
+                   sizeof(uint64_t));
+    cs->pkg_percent = (double *) msr_soa_alloc(cs->npkg * nsockets,
+                      sizeof(double));
+    cs->core_percent = (double *) msr_soa_alloc(cs->ncore * ncores,
+                       sizeof(double));
+
+    // Each batch ends with a TSC row read on the same CPUs, so a residency
+    // and its reference are taken at the same moment.
+    allocate_batch(PKG_CRESIDENCY, (cs->npkg + 1) * nsockets);
+    for (s = 0; s < cs->npkg; s++)
+    {
+        load_socket_batch(pkg_msr[s], &cs->pkg_bits[s * nsockets],
+                          PKG_CRESIDENCY);
+    }
+    load_socket_batch(msrs->tsc, &cs->pkg_bits[cs->npkg * nsockets],
+                      PKG_CRESIDENCY);
+
+    // Core residency is shared by the threads of a core, so it is read on
+    // the first thread of each core only.
+    allocate_batch(CORE_CRESIDENCY, (cs->ncore + 1) * ncores);
+    for (s = 0; s <= cs->ncore; s++)
+    {
+        for (i = 0; i < ncores; i++)
+        {
+            create_batch_op(s < cs->ncore ? core_msr[s] : msrs->tsc, i,
+                            &cs->core_bits[s * ncores + i], CORE_CRESIDENCY);
+        }
+    }
+
+#ifdef VARIORUM_DEBUG
+    fprintf(stderr, "%s %s::%d DEBUG: (storage) %u package and %u core "
+            "C-states at %p\n", getenv("HOSTNAME"), __FILE__, __LINE__, cs->npkg,
+            cs->ncore, cs);
+#endif
+    *data = cs;
+    return 0;
+}
+
+int sample_cstate_residency(const struct cstate_msrs *msrs,
+                            struct cstate_data **data)
+{
+    struct cstate_data *cs = NULL;
+    struct timeval now;
+    uint64_t *tmp;
+
+    if (cstate_storage(&cs, msrs))
+    {
+        variorum_error_handler("Could not set up C-state residency sampling",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+
+    // On a failed read the previous sample is kept as the baseline of the
+    // next one.
+    if (read_batch(PKG_CRESIDENCY) || read_batch(CORE_CRESIDENCY))
+    {
+        variorum_error_handler("Could not read C-state residency counters",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    gettimeofday(&now, NULL);
+    cs->time_us = now.tv_sec * (uint64_t)1000000 + now.tv_usec;
+
+    tmp = cs->pkg_old;
+    cs->pkg_old = cs->pkg_now;
+    cs->pkg_now = tmp;
+    tmp = cs->core_old;
+    cs->core_old = cs->core_now;
+    cs->core_now = tmp;
+    msr_soa_gather((cs->npkg + 1) * cs->nsockets, cs->pkg_bits, cs->pkg_now);
+    msr_soa_gather((cs->ncore + 1) * cs->ncores, cs->core_bits, cs->core_now);
+
+    // The previous counters of the first call are still zero, and the
+    // residency counters and the TSC count from reset, so the first call
+    // reports the residency since reset.
+    cstate_residency_percent(cs->npkg, cs->nsockets, cs->pkg_now, cs->pkg_old,
+                             cs->pkg_percent);
+    cstate_residency_percent(cs->ncore, cs->ncores, cs->core_now,
+                             cs->core_old, cs->core_percent);
+    cs->nsamples++;
+
+    if (data != NULL)
+    {
+        *data = cs;
+    }
+    return 0;
+}
+
+int get_cstate_metrics(struct variorum_metric_vector *metrics,
+                       const struct cstate_msrs *msrs)
+{
+    struct cstate_data *cs = NULL;
+    char name[VARIORUM_METRIC_NAME_LEN];
+    unsigned s, i;
+
+    if (sample_cstate_residency(msrs, &cs))
+    {
+        return -1;
+    }
+
+    for (s = 0; s < cs->npkg; s++)
+    {
+        snprintf(name, VARIORUM_METRIC_NAME_LEN, "cstate_pkg_%s_percent",
+                 cs->pkg_name[s]);
+        for (i = 0; i < cs->nsockets; i++)
+        {
+            variorum_metric_vector_append(metrics, name, VARIORUM_DOMAIN_SOCKET, i,
+                                          cs->pkg_percent[s * cs->nsockets + i], cs->time_us);
+        }
+    }
+    for (s = 0; s < cs->ncore; s++)
+    {
+        snprintf(name, VARIORUM_METRIC_NAME_LEN, "cstate_core_%s_percent",
+                 cs->core_name[s]);
+        for (i = 0; i < cs->ncores; i++)
+        {
+            variorum_metric_vector_append(metrics, name, VARIORUM_DOMAIN_CORE, i,
+                                          cs->core_percent[s * cs->ncores + i], cs->time_us);
+        }
+    }
+    return 0;
+}
+
+int json_get_cstate_residency(json_t *get_cstate_obj,
+                              const struct cstate_msrs *msrs)
+{
+    struct cstate_data *cs = NULL;
+    unsigned cores_per_socket;
+    unsigned s, i, j;
+    char key[48];
+
+    if (sample_cstate_residency(msrs, &cs))
+    {
+        return -1;
+    }
+    cores_per_socket = cs->ncores / cs->nsockets;
+
+    for (i = 0; i < cs->nsockets; i++)
+    {
+        json_t *socket_obj = make_socket_obj(get_cstate_obj, i);
+        json_t *cpu_obj = json_object();
+        json_object_set_new(socket_obj, "CPU", cpu_obj);
+        json_t *core_obj = json_object();
+        json_object_set_new(cpu_obj, "core", core_obj);
+
+        for (s = 0; s < cs->npkg; s++)
+        {
+            snprintf(key, sizeof(key), "cstate_pkg_%s_percent", cs->pkg_name[s]);
+            json_object_set_new(cpu_obj, key,
+                                json_real(cs->pkg_percent[s * cs->nsockets + i]));
+        }
+        for (j = 0; j < cores_per_socket; j++)
+        {
+            for (s = 0; s < cs->ncore; s++)
+            {
+                snprintf(key, sizeof(key), "core_%d_cstate_%s_percent", j,
+                         cs->core_name[s]);
+                json_object_set_new(core_obj, key,
+                                    json_real(cs->core_percent[s * cs->ncores +
+                                              i * cores_per_socket + j]));
+            }
+        }
+    }
+    return 0;
+}
+
+/// @brief Read an unsigned value from a file.
+static int cpuidle_read(const char *path, unsigned *val)
+{
+    FILE *fp = fopen(path, "r");
+    int ok;
+
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    ok = fscanf(fp, "%u", val) == 1;
+    fclose(fp);
+    return ok ? 0 : -1;
+}
+
+/// @brief Set the disable knob of state k of a CPU unless it already has the
+/// value. The knob is read every time, as anything may change it.
+static int cpuidle_set_disable(const char *root, unsigned cpu, unsigned k,
+                               int disable)
+{
+    char path[FILENAME_SIZE];
+    unsigned cur;
+    FILE *fp;
+    int err;
+
+    snprintf(path, sizeof(path), "%s/cpu%u/cpuidle/state%u/disable", root, cpu,
+             k);
+    if (cpuidle_read(path, &cur) == 0 && (cur != 0) == (disable != 0))
+    {
+        return 0;
+    }
+    fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    err = fprintf(fp, "%d\n", disable != 0) < 0;
+    err |= fclose(fp) != 0;
+    return err ? -1 : 0;
+}
+
+int cpuidle_scan(const char *root, unsigned ncpus, struct cpuidle_table *t)
+{
+    char path[FILENAME_SIZE];
+    unsigned c, k;
+
+    memset(t, 0, sizeof(*t));
+    t->ncpus = ncpus;
+    t->nstates = (unsigned *) calloc(ncpus, sizeof(unsigned));
+    t->latency = (unsigned *) calloc(ncpus * CPUIDLE_STATE_MAX, sizeof(unsigned));
+
+    for (c = 0; c < ncpus; c++)
+    {
+        for (k = 0; k < CPUIDLE_STATE_MAX; k++)
+        {
+            snprintf(path, sizeof(path), "%s/cpu%u/cpuidle/state%u/latency", root, c,
+                     k);
+            if (cpuidle_read(path, &t->latency[c * CPUIDLE_STATE_MAX + k]))
+            {
+                break;
+            }
+        }
+        t->nstates[c] = k;
+    }
+    return t->nstates[0] > 0 ? 0 : -1;
+}
+
+int cpuidle_limit_latency(const char *root, const struct cpuidle_table *t,
+                          unsigned cpu, int max_latency_us)
+{
+    unsigned k;
+    int err = 0;
+
+    // State 0 is polling and must stay available so the CPU can idle at all.
+    for (k = 1; k < t->nstates[cpu]; k++)
+    {
+        int disable = max_latency_us >= 0 &&
+                      t->latency[cpu * CPUIDLE_STATE_MAX + k] > (unsigned)max_latency_us;
+
+        err |= cpuidle_set_disable(root, cpu, k, disable);
+    }
+    return err;
+}
+
+int cpuidle_save(const char *root, const struct cpuidle_table *t, FILE *fp)
+{
+    char path[FILENAME_SIZE];
+    unsigned c, k, val;
+
+    for (c = 0; c < t->ncpus; c++)
+    {
+        for (k = 0; k < t->nstates[c]; k++)
+        {
+            snprintf(path, sizeof(path), "%s/cpu%u/cpuidle/state%u/disable", root, c,
+                     k);
+            if (cpuidle_read(path, &val) ||
+                fprintf(fp, "cpuidle %u %u %d\n", c, k, val != 0) < 0)
+            {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int cpuidle_restore(const char *root, FILE *fp)
+{
+    char line[128];
+    unsigned c, k;
+    int disable;
+    int err = 0;
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (sscanf(line, "cpuidle %u %u %d", &c, &k, &disable) != 3)
+        {
+            continue;
+        }
+        err |= cpuidle_set_disable(root, c, k, disable);
+    }
+    return err;
+}
+
+void cpuidle_free(struct cpuidle_table *t)
+{
+    free(t->nstates);
+    free(t->latency);
+    memset(t, 0, sizeof(*t));
+}
+
+/// @brief Get the cpuidle states of this node, scanned on first use.
+static struct cpuidle_table *cpuidle_storage(void)
+{
+    static struct cpuidle_table t;
+    static int init = 0;
+    unsigned nthreads = 0;
+
+    if (!init)
+    {
+#ifdef VARIORUM_WITH_INTEL_CPU
+        variorum_get_topology(NULL, NULL, &nthreads, P_INTEL_CPU_IDX);
+#endif
+        if (cpuidle_scan(CPUIDLE_SYSFS_ROOT, nthreads, &t))
+        {
+            cpuidle_free(&t);
+            return NULL;
+        }
+        init = 1;
+    }
+    return &t;
+}
+
+int cap_cstate_latency(enum ctl_domains_e domain, unsigned id,
+                       int max_latency_us)
+{
+    struct cpuidle_table *t = cpuidle_storage();
+    unsigned nsockets = 0, ncores = 0, nthreads = 0;
+    unsigned c, core;
+    int err = 0;
+
+    if (t == NULL)
+    {
+        variorum_error_handler("No cpuidle states in " CPUIDLE_SYSFS_ROOT,
+                               VARIORUM_ERROR_FEATURE_NOT_AVAILABLE, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(&nsockets, &ncores, &nthreads, P_INTEL_CPU_IDX);
+#endif
+    if ((domain == CORE && id >= ncores) || (domain == SOCKET && id >= nsockets) ||
+        (domain != CORE && domain != SOCKET))
+    {
+        variorum_error_handler("Invalid core or socket",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+
+    for (c = 0; c < nthreads; c++)
+    {
+        core = c % ncores;
+        if ((domain == CORE && core != id) ||
+            (domain == SOCKET && core / (ncores / nsockets) != id))
+        {
+            continue;
+        }
+        err |= cpuidle_limit_latency(CPUIDLE_SYSFS_ROOT, t, c, max_latency_us);
+    }
+    if (err)
+    {
+        variorum_error_handler("Could not write cpuidle disable knobs",
+                               VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    return 0;
+}
+
+static int pm_qos_fd = -1;
+
+int cap_node_cstate_latency(int max_latency_us)
+{
+    int32_t val = max_latency_us;
+
+    if (max_latency_us < 0)
+    {
+        if (pm_qos_fd >= 0)
+        {
+            close(pm_qos_fd);
+            pm_qos_fd = -1;
+        }
+        return 0;
+    }
+    // The kernel holds the request for as long as the file stays open, and a
+    // new value written to the same file replaces it.
+    if (pm_qos_fd < 0)
+    {
+        pm_qos_fd = open(PM_QOS_CPU_DMA_LATENCY, O_WRONLY);
+        if (pm_qos_fd < 0)
+        {
+            variorum_error_handler("Could not open " PM_QOS_CPU_DMA_LATENCY,
+                                   VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"),
+                                   __FILE__, __FUNCTION__, __LINE__);
+            return -1;
+        }
+    }
+    if (write(pm_qos_fd, &val, sizeof(val)) != sizeof(val))
+    {
+        variorum_error_handler("Could not write " PM_QOS_CPU_DMA_LATENCY,
+                               VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    return 0;
+}
+
+/// @brief Storage for MSR_PKG_CST_CONFIG_CONTROL of every core.
+struct cst_config_data
+{
+    /// @brief Values filled in by the PKG_CST_CONFIG batch.
+    uint64_t **bits;
+};
+
+/// @brief Set up the PKG_CST_CONFIG batch, one operation per core.
+static struct cst_config_data *cst_config_storage(off_t msr)
+{
+    static struct cst_config_data *cc = NULL;
+    unsigned ncores = 0;
+    unsigned i;
+
+    if (cc != NULL || msr == 0)
+    {
+        return cc;
+    }
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(NULL, &ncores, NULL, P_INTEL_CPU_IDX);
+#endif
+    cc = (struct cst_config_data *) calloc(1, sizeof(struct cst_config_data));
+    cc->bits = (uint64_t **) calloc(ncores, sizeof(uint64_t *));
+    allocate_batch(PKG_CST_CONFIG, ncores);
+    for (i = 0; i < ncores; i++)
+    {
+        create_batch_op(msr, i, &cc->bits[i], PKG_CST_CONFIG);
+    }
+    return cc;
+}
+
+int cap_pkg_cstate_limit(const struct cstate_msrs *msrs, unsigned socket,
+                         unsigned limit)
+{
+    struct cst_config_data *cc = cst_config_storage(msrs->cst_config);
+    unsigned nsockets = 0, ncores = 0;
+    unsigned cores_per_socket, i;
+
+    if (cc == NULL)
+    {
+        variorum_error_handler("No package C-state limit register",
+                               VARIORUM_ERROR_FEATURE_NOT_AVAILABLE, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(&nsockets, &ncores, NULL, P_INTEL_CPU_IDX);
+#endif
+    if (socket >= nsockets || (limit & ~msrs->cst_limit_mask) != 0)
+    {
+        variorum_error_handler("Invalid socket or package C-state limit",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    cores_per_socket = ncores / nsockets;
+
+    if (read_batch(PKG_CST_CONFIG))
+    {
+        variorum_error_handler("Could not read MSR_PKG_CST_CONFIG_CONTROL",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    // The batch writes back every core, so none of them may be locked. Bit
+    // 15 (CFG Lock) freezes bits 15:0 until the next reset.
+    for (i = 0; i < ncores; i++)
+    {
+        if (*cc->bits[i] & (1ULL << 15))
+        {
+            variorum_error_handler("MSR_PKG_CST_CONFIG_CONTROL is locked by the BIOS",
+                                   VARIORUM_ERROR_MSR_WRITE, getenv("HOSTNAME"),
+                                   __FILE__, __FUNCTION__, __LINE__);
+            return -1;
+        }
+    }
+    for (i = socket * cores_per_socket; i < (socket + 1) * cores_per_socket; i++)
+    {
+        *cc->bits[i] = (*cc->bits[i] & ~msrs->cst_limit_mask) | limit;
+    }
+    return write_batch(PKG_CST_CONFIG) ? -1 : 0;
+}
+
+/// @brief Path of the file holding the limits recorded by
+/// save_cstate_limits(), so that another process on the node, e.g., a job
+/// epilog, can restore them.
+static void cstate_save_path(char *path, size_t len)
+{
+    char host[256] = "";
+
+    gethostname(host, sizeof(host) - 1);
+    snprintf(path, len, "%s.%s", CSTATE_SAVE_PATH, host);
+}
+
+int save_cstate_limits(const struct cstate_msrs *msrs)
+{
+    struct cpuidle_table *t = cpuidle_storage();
+    struct cst_config_data *cc = cst_config_storage(msrs->cst_config);
+    char path[FILENAME_SIZE];
+    char tmp[FILENAME_SIZE + 8];
+    unsigned ncores = 0;
+    unsigned i;
+    int saved = 0;
+    int err = 0;
+    FILE *fp;
+
+    cstate_save_path(path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    fp = fopen(tmp, "w");
+    if (fp == NULL)
+    {
+        variorum_error_handler("Could not create the C-state limits file",
+                               VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    if (t != NULL)
+    {
+        err |= cpuidle_save(CPUIDLE_SYSFS_ROOT, t, fp);
+        saved = 1;
+    }
+    if (cc != NULL && read_batch(PKG_CST_CONFIG) == 0)
+    {
+#ifdef VARIORUM_WITH_INTEL_CPU
+        variorum_get_topology(NULL, &ncores, NULL, P_INTEL_CPU_IDX);
+#endif
+        for (i = 0; i < ncores; i++)
+        {
+            err |= fprintf(fp, "cst_config %u 0x%" PRIx64 "\n", i,
+                           *cc->bits[i]) < 0;
+        }
+        saved = 1;
+    }
+    err |= fclose(fp) != 0;
+    if (!saved)
+    {
+        unlink(tmp);
+        variorum_error_handler("No C-state controls to save",
+                               VARIORUM_ERROR_FEATURE_NOT_AVAILABLE, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    // Replace a previous save at once, so a concurrent restore never sees
+    // half a file.
+    if (err || rename(tmp, path) != 0)
+    {
+        unlink(tmp);
+        variorum_error_handler("Could not write the C-state limits file",
+                               VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    return 0;
+}
+
+int restore_cstate_limits(const struct cstate_msrs *msrs)
+{
+    struct cst_config_data *cc;
+    char path[FILENAME_SIZE];
+    char line[128];
+    unsigned ncores = 0;
+    unsigned core;
+    uint64_t val;
+    int changed = 0;
+    int err = 0;
+    FILE *fp;
+
+    cap_node_cstate_latency(-1);
+    cstate_save_path(path, sizeof(path));
+    fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        variorum_error_handler("No C-state limits were saved on this node",
+                               VARIORUM_ERROR_FEATURE_NOT_AVAILABLE, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    err |= cpuidle_restore(CPUIDLE_SYSFS_ROOT, fp);
+
+    rewind(fp);
+    cc = cst_config_storage(msrs->cst_config);
+    if (cc != NULL)
+    {
+#ifdef VARIORUM_WITH_INTEL_CPU
+        variorum_get_topology(NULL, &ncores, NULL, P_INTEL_CPU_IDX);
+#endif
+        err |= read_batch(PKG_CST_CONFIG) != 0;
+        while (!err && fgets(line, sizeof(line), fp) != NULL)
+        {
+            if (sscanf(line, "cst_config %u %" SCNx64, &core, &val) != 2 ||
+                core >= ncores)
+            {
+                continue;
+            }
+            changed |= *cc->bits[core] != val;
+            *cc->bits[core] = val;
+        }
+        if (!err && changed)
+        {
+            err |= write_batch(PKG_CST_CONFIG) != 0;
+        }
+    }
+    fclose(fp);
+    if (err)
+    {
+        variorum_error_handler("Could not restore C-state limits",
+                               VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"),
+                               __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+    unlink(path);
+    return 0;
+}
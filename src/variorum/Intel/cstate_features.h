@@ -0,0 +1,321 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef CSTATE_FEATURES_H_INCLUDE
+#define CSTATE_FEATURES_H_INCLUDE
+
+#include <jansson.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include <config_architecture.h>
+#include <variorum_metrics.h>
+
+/// @brief Location of the per-CPU cpuidle directories in sysfs.
+#define CPUIDLE_SYSFS_ROOT "/sys/devices/system/cpu"
+
+/// @brief PM QoS interface holding a wakeup latency limit for the whole node
+/// while it is open.
+#define PM_QOS_CPU_DMA_LATENCY "/dev/cpu_dma_latency"
+
+/// @brief Prefix of the file, followed by the hostname, holding the limits
+/// recorded by save_cstate_limits().
+#define CSTATE_SAVE_PATH "/dev/shm/variorum.cstate_limits"
+
+/// @brief Maximum number of cpuidle states tracked per CPU.
+#define CPUIDLE_STATE_MAX 16
+
+/// @brief Package C-states with a residency counter, in the order of
+/// struct cstate_msrs pkg (C2, C3, C6, C7, C8, C9, C10).
+#define CSTATE_PKG_MAX 7
+
+/// @brief Core C-states with a residency counter, in the order of
+/// struct cstate_msrs core (C3, C6, C7).
+#define CSTATE_CORE_MAX 3
+
+/// @brief Structure listing the C-state residency counters of a model.
+///
+/// An address of 0 means the model does not implement the counter. All
+/// counters tick at the TSC frequency while the package or core is in the
+/// C-state.
+struct cstate_msrs
+{
+    /// @brief Addresses of MSR_PKG_C2_RESIDENCY, MSR_PKG_C3_RESIDENCY,
+    /// MSR_PKG_C6_RESIDENCY, MSR_PKG_C7_RESIDENCY, MSR_PKG_C8_RESIDENCY,
+    /// MSR_PKG_C9_RESIDENCY and MSR_PKG_C10_RESIDENCY.
+    off_t pkg[CSTATE_PKG_MAX];
+    /// @brief Addresses of MSR_CORE_C3_RESIDENCY, MSR_CORE_C6_RESIDENCY and
+    /// MSR_CORE_C7_RESIDENCY.
+    off_t core[CSTATE_CORE_MAX];
+    /// @brief Address of IA32_TIME_STAMP_COUNTER.
+    off_t tsc;
+    /// @brief Address of MSR_PKG_CST_CONFIG_CONTROL, 0 if the package
+    /// C-state limit cannot be set through an MSR.
+    off_t cst_config;
+    /// @brief Package C-state limit field of MSR_PKG_CST_CONFIG_CONTROL,
+    /// bits 2:0 or 3:0 depending on the model.
+    uint64_t cst_limit_mask;
+};
+
+/// @brief Structure containing the C-state residency of all sockets and
+/// cores.
+///
+/// Counters are stored one row per implemented C-state followed by a row
+/// for the TSC, and one column per socket (package) or core, so the
+/// residency of state s in socket i is pkg_percent[s * nsockets + i].
+struct cstate_data
+{
+    /// @brief Number of sockets.
+    unsigned nsockets;
+    /// @brief Number of cores.
+    unsigned ncores;
+    /// @brief Number of implemented package C-states.
+    unsigned npkg;
+    /// @brief Number of implemented core C-states.
+    unsigned ncore;
+    /// @brief Name of each implemented package C-state, e.g., c6.
+    const char *pkg_name[CSTATE_PKG_MAX];
+    /// @brief Name of each implemented core C-state.
+    const char *core_name[CSTATE_CORE_MAX];
+    /// @brief Raw values filled in by the PKG_CRESIDENCY batch.
+    uint64_t **pkg_bits;
+    /// @brief Raw values filled in by the CORE_CRESIDENCY batch.
+    uint64_t **core_bits;
+    /// @brief Current and previous package counters.
+    uint64_t *pkg_now;
+    uint64_t *pkg_old;
+    /// @brief Current and previous core counters.
+    uint64_t *core_now;
+    uint64_t *core_old;
+    /// @brief Percent of the last interval each socket spent in each package
+    /// C-state.
+    double *pkg_percent;
+    /// @brief Percent of the last interval each core spent in each core
+    /// C-state.
+    double *core_percent;
+    /// @brief Time of the current sample in microseconds.
+    uint64_t time_us;
+    /// @brief Number of samples taken.
+    unsigned nsamples;
+};
+
+/// @brief Structure holding the cpuidle states of all logical CPUs.
+///
+/// State k of CPU c is at index c * CPUIDLE_STATE_MAX + k.
+struct cpuidle_table
+{
+    /// @brief Number of logical CPUs.
+    unsigned ncpus;
+    /// @brief Number of cpuidle states of each CPU.
+    unsigned *nstates;
+    /// @brief Exit latency of each state in microseconds.
+    unsigned *latency;
+};
+
+/// @brief Read the cpuidle states of all CPUs.
+///
+/// @param [in] root Sysfs directory of the CPUs, usually CPUIDLE_SYSFS_ROOT.
+/// @param [in] ncpus Number of logical CPUs.
+/// @param [out] t Table of states, released with cpuidle_free().
+///
+/// @return 0 if successful, else -1 if CPU 0 has no cpuidle states.
+int cpuidle_scan(
+    const char *root,
+    unsigned ncpus,
+    struct cpuidle_table *t
+);
+
+/// @brief Allow only the idle states of a CPU with an exit latency up to a
+/// limit.
+///
+/// State 0 (polling) is never disabled. Every knob is read first and only
+/// written if its value changes.
+///
+/// @param [in] root Sysfs directory of the CPUs.
+/// @param [in] t Table from cpuidle_scan().
+/// @param [in] cpu Logical CPU.
+/// @param [in] max_latency_us Largest allowed exit latency in microseconds,
+///        or a negative value to allow all states.
+///
+/// @return 0 if successful, else -1 if a knob cannot be written.
+int cpuidle_limit_latency(
+    const char *root,
+    const struct cpuidle_table *t,
+    unsigned cpu,
+    int max_latency_us
+);
+
+/// @brief Write the current disable knobs of all CPUs to a file, one
+/// "cpuidle <cpu> <state> <disable>" line per knob.
+///
+/// @param [in] root Sysfs directory of the CPUs.
+/// @param [in] t Table from cpuidle_scan().
+/// @param [in] fp File to write to.
+///
+/// @return 0 if successful, else -1 if a knob cannot be read or the file
+/// cannot be written.
+int cpuidle_save(
+    const char *root,
+    const struct cpuidle_table *t,
+    FILE *fp
+);
+
+/// @brief Write back the disable knobs recorded by cpuidle_save().
+///
+/// Lines of other kinds are skipped. Every knob is read first and only
+/// written if its value differs from the recorded one.
+///
+/// @param [in] root Sysfs directory of the CPUs.
+/// @param [in] fp File written by cpuidle_save().
+///
+/// @return 0 if successful, else -1 if a knob cannot be written.
+int cpuidle_restore(
+    const char *root,
+    FILE *fp
+);
+
+/// @brief Release a table filled in by cpuidle_scan().
+///
+/// @param [in,out] t Table to release.
+void cpuidle_free(
+    struct cpuidle_table *t
+);
+
+/// @brief Limit the idle states of the logical CPUs of a core or socket to
+/// those with an exit latency up to a limit, through the cpuidle sysfs knobs.
+///
+/// @param [in] domain CORE or SOCKET.
+/// @param [in] id Index of the core or socket.
+/// @param [in] max_latency_us Largest allowed exit latency in microseconds,
+///        or a negative value to allow all states.
+///
+/// @return 0 if successful, else -1.
+int cap_cstate_latency(
+    enum ctl_domains_e domain,
+    unsigned id,
+    int max_latency_us
+);
+
+/// @brief Hold a node-wide wakeup latency limit through the PM QoS
+/// interface.
+///
+/// The limit is held until it is replaced, released with a negative value,
+/// or restore_cstate_limits() is called.
+///
+/// @param [in] max_latency_us Largest allowed wakeup latency in
+///        microseconds, or a negative value to release the limit.
+///
+/// @return 0 if successful, else -1.
+int cap_node_cstate_latency(
+    int max_latency_us
+);
+
+/// @brief Set the package C-state limit field of MSR_PKG_CST_CONFIG_CONTROL
+/// on all cores of a socket with one batch.
+///
+/// The batch writes every core of the node, so the CFG Lock bit is checked
+/// on all of them first.
+///
+/// @param [in] msrs C-state registers of the model.
+/// @param [in] socket Index of the socket.
+/// @param [in] limit Model-specific encoding of the deepest allowed package
+///        C-state, see the Intel SDM for the model.
+///
+/// @return 0 if successful, else -1 if the field is locked on any core, the
+/// limit does not fit the field or the model has no such register.
+int cap_pkg_cstate_limit(
+    const struct cstate_msrs *msrs,
+    unsigned socket,
+    unsigned limit
+);
+
+/// @brief Record the cpuidle knobs of all CPUs and, if the model has
+/// MSR_PKG_CST_CONFIG_CONTROL, its value on all cores.
+///
+/// The values are written to CSTATE_SAVE_PATH.<hostname>, replacing an
+/// earlier save, so that a later process on the node can restore them.
+///
+/// @param [in] msrs C-state registers of the model.
+///
+/// @return 0 if successful, else -1 if neither can be read or the file
+/// cannot be written.
+int save_cstate_limits(
+    const struct cstate_msrs *msrs
+);
+
+/// @brief Restore the state recorded by save_cstate_limits() and release a
+/// PM QoS limit held by cap_node_cstate_latency().
+///
+/// Only knobs that changed since the save are written. The file written by
+/// save_cstate_limits() is removed once everything has been restored.
+///
+/// @param [in] msrs C-state registers of the model.
+///
+/// @return 0 if successful, else -1 if nothing was saved on this node or a
+/// knob cannot be written.
+int restore_cstate_limits(
+    const struct cstate_msrs *msrs
+);
+
+/// @brief Convert residency counter differences into percent of the
+/// interval.
+///
+/// @param [in] nstates Number of C-state rows; row nstates holds the TSC.
+/// @param [in] n Number of sockets or cores per row.
+/// @param [in] now Current counters, (nstates + 1) * n values.
+/// @param [in] old Previous counters, laid out like now.
+/// @param [out] percent Residency in percent, nstates * n values. Values are
+///        0 where the TSC did not advance.
+void cstate_residency_percent(
+    unsigned nstates,
+    unsigned n,
+    const uint64_t *now,
+    const uint64_t *old,
+    double *percent
+);
+
+/// @brief Read the C-state residency counters of all sockets and cores with
+/// one batch each and compute the residency since the previous call.
+///
+/// The first call sets up the PKG_CRESIDENCY and CORE_CRESIDENCY batches
+/// and computes the residency since the counters were reset.
+///
+/// @param [in] msrs Residency counters of the model.
+/// @param [out] data Pointer to the residency data, may be NULL.
+///
+/// @return 0 if successful, else -1 if the batches cannot be set up or
+/// read.
+int sample_cstate_residency(
+    const struct cstate_msrs *msrs,
+    struct cstate_data **data
+);
+
+/// @brief Append C-state residency to a metric vector.
+///
+/// Appends cstate_pkg_<state>_percent for every socket and
+/// cstate_core_<state>_percent for every core.
+///
+/// @param [out] metrics Metric vector to append to.
+/// @param [in] msrs Residency counters of the model.
+///
+/// @return 0 if successful, else -1.
+int get_cstate_metrics(
+    struct variorum_metric_vector *metrics,
+    const struct cstate_msrs *msrs
+);
+
+/// @brief Add C-state residency since the previous call to a JSON object.
+///
+/// @param [out] get_cstate_obj JSON object of the node.
+/// @param [in] msrs Residency counters of the model.
+///
+/// @return 0 if successful, else -1.
+int json_get_cstate_residency(
+    json_t *get_cstate_obj,
+    const struct cstate_msrs *msrs
+);
+
+#endif
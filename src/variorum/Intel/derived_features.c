@@ -0,0 +1,304 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <derived_features.h>
+#include <clocks_features.h>
+#include <config_architecture.h>
+#include <counters_features.h>
+#include <misc_features.h>
+#include <msr_core.h>
+#include <msr_soa.h>
+#include <variorum_error.h>
+
+/// @brief Element-wise scale * num / den, or 0 where den is 0.
+static void ratio(unsigned n, double scale, const double *restrict num,
+                  const double *restrict den, double *restrict out)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++)
+    {
+        out[i] = den[i] > 0.0 ? scale * num[i] / den[i] : 0.0;
+    }
+}
+
+/// @brief Sum the thread entries of d into its core entries, and the core
+/// entries into its socket entries.
+static void reduce_domains(const struct derived_metrics *dm, double *d,
+                           int per_core)
+{
+    double *core = d + dm->nthreads;
+    double *socket = core + dm->ncores;
+    unsigned cores_per_socket = dm->ncores / dm->nsockets;
+    unsigned threads_per_core = dm->nthreads / dm->ncores;
+    unsigned i;
+
+    memset(core, 0, (dm->ncores + dm->nsockets) * sizeof(double));
+    for (i = 0; i < dm->nthreads; i++)
+    {
+        core[i % dm->ncores] += d[i];
+    }
+    if (per_core && threads_per_core > 1)
+    {
+        for (i = 0; i < dm->ncores; i++)
+        {
+            core[i] /= threads_per_core;
+        }
+    }
+    for (i = 0; i < dm->ncores; i++)
+    {
+        socket[i / cores_per_socket] += core[i];
+    }
+}
+
+int derived_metrics_init(struct derived_metrics *dm, unsigned nsockets,
+                         unsigned ncores, unsigned nthreads, int base_mhz, int fixed_width)
+{
+    unsigned n = nthreads + ncores + nsockets;
+    int s;
+
+    memset(dm, 0, sizeof(struct derived_metrics));
+    if (nsockets == 0 || ncores < nsockets || nthreads < ncores ||
+            ncores % nsockets != 0)
+    {
+        return -1;
+    }
+    dm->nsockets = nsockets;
+    dm->ncores = ncores;
+    dm->nthreads = nthreads;
+    dm->base_ghz = base_mhz / 1000.0;
+    dm->fixed_mask = msr_soa_mask(fixed_width);
+
+    for (s = 0; s < 2; s++)
+    {
+        dm->snap[s].inst = (uint64_t *) msr_soa_alloc(nthreads, sizeof(uint64_t));
+        dm->snap[s].core_cycles = (uint64_t *) msr_soa_alloc(nthreads, sizeof(uint64_t));
+        dm->snap[s].aperf = (uint64_t *) msr_soa_alloc(nthreads, sizeof(uint64_t));
+        dm->snap[s].mperf = (uint64_t *) msr_soa_alloc(nthreads, sizeof(uint64_t));
+        dm->snap[s].tsc = (uint64_t *) msr_soa_alloc(nthreads, sizeof(uint64_t));
+        dm->snap[s].pkg_joules = (double *) msr_soa_alloc(nsockets, sizeof(double));
+    }
+    dm->d_inst = (double *) msr_soa_alloc(n, sizeof(double));
+    dm->d_core_cycles = (double *) msr_soa_alloc(n, sizeof(double));
+    dm->d_aperf = (double *) msr_soa_alloc(n, sizeof(double));
+    dm->d_mperf = (double *) msr_soa_alloc(n, sizeof(double));
+    dm->d_tsc = (double *) msr_soa_alloc(n, sizeof(double));
+    dm->ipc = (double *) msr_soa_alloc(n, sizeof(double));
+    dm->busy_ghz = (double *) msr_soa_alloc(n, sizeof(double));
+    dm->effective_ghz = (double *) msr_soa_alloc(n, sizeof(double));
+    dm->util_percent = (double *) msr_soa_alloc(n, sizeof(double));
+    dm->core_watts = (double *) msr_soa_alloc(ncores, sizeof(double));
+    dm->socket_watts = (double *) msr_soa_alloc(nsockets, sizeof(double));
+    dm->inst_per_joule = (double *) msr_soa_alloc(nsockets, sizeof(double));
+    return 0;
+}
+
+void derived_metrics_free(struct derived_metrics *dm)
+{
+    int s;
+
+    for (s = 0; s < 2; s++)
+    {
+        free(dm->snap[s].inst);
+        free(dm->snap[s].core_cycles);
+        free(dm->snap[s].aperf);
+        free(dm->snap[s].mperf);
+        free(dm->snap[s].tsc);
+        free(dm->snap[s].pkg_joules);
+    }
+    free(dm->d_inst);
+    free(dm->d_core_cycles);
+    free(dm->d_aperf);
+    free(dm->d_mperf);
+    free(dm->d_tsc);
+    free(dm->ipc);
+    free(dm->busy_ghz);
+    free(dm->effective_ghz);
+    free(dm->util_percent);
+    free(dm->core_watts);
+    free(dm->socket_watts);
+    free(dm->inst_per_joule);
+    memset(dm, 0, sizeof(struct derived_metrics));
+}
+
+struct derived_snapshot *derived_metrics_next(struct derived_metrics *dm)
+{
+    return &dm->snap[dm->cur ^ 1];
+}
+
+void derived_metrics_compute(struct derived_metrics *dm)
+{
+    const struct derived_snapshot *now, *old;
+    unsigned n = dm->nthreads + dm->ncores + dm->nsockets;
+    unsigned cores_per_socket = dm->ncores / dm->nsockets;
+    const double *core_mperf, *socket_mperf, *socket_inst;
+    double joules;
+    unsigned i;
+
+    dm->cur ^= 1;
+    dm->nsamples++;
+    if (dm->nsamples < 2)
+    {
+        return;
+    }
+    now = &dm->snap[dm->cur];
+    old = &dm->snap[dm->cur ^ 1];
+    dm->elapsed = (now->time_us - old->time_us) / 1000000.0;
+
+    msr_soa_delta_scale(dm->nthreads, dm->fixed_mask, 1.0, now->inst, old->inst,
+                        dm->d_inst);
+    msr_soa_delta_scale(dm->nthreads, dm->fixed_mask, 1.0, now->core_cycles,
+                        old->core_cycles, dm->d_core_cycles);
+    msr_soa_delta_scale(dm->nthreads, ~0ULL, 1.0, now->aperf, old->aperf,
+                        dm->d_aperf);
+    msr_soa_delta_scale(dm->nthreads, ~0ULL, 1.0, now->mperf, old->mperf,
+                        dm->d_mperf);
+    msr_soa_delta_scale(dm->nthreads, ~0ULL, 1.0, now->tsc, old->tsc, dm->d_tsc);
+
+    reduce_domains(dm, dm->d_inst, dm->any_thread);
+    reduce_domains(dm, dm->d_core_cycles, dm->any_thread);
+    reduce_domains(dm, dm->d_aperf, 0);
+    reduce_domains(dm, dm->d_mperf, 0);
+    reduce_domains(dm, dm->d_tsc, 0);
+
+    // Threads, cores and sockets in one pass each.
+    ratio(n, 1.0, dm->d_inst, dm->d_core_cycles, dm->ipc);
+    ratio(n, dm->base_ghz, dm->d_aperf, dm->d_mperf, dm->busy_ghz);
+    ratio(n, dm->base_ghz, dm->d_aperf, dm->d_tsc, dm->effective_ghz);
+    ratio(n, 100.0, dm->d_mperf, dm->d_tsc, dm->util_percent);
+
+    core_mperf = dm->d_mperf + dm->nthreads;
+    socket_mperf = core_mperf + dm->ncores;
+    socket_inst = dm->d_inst + dm->nthreads + dm->ncores;
+    for (i = 0; i < dm->nsockets; i++)
+    {
+        joules = now->pkg_joules[i] - old->pkg_joules[i];
+        dm->socket_watts[i] = dm->elapsed > 0.0 && joules > 0.0 ?
+                              joules / dm->elapsed : 0.0;
+        dm->inst_per_joule[i] = joules > 0.0 ? socket_inst[i] / joules : 0.0;
+    }
+    for (i = 0; i < dm->ncores; i++)
+    {
+        dm->core_watts[i] = socket_mperf[i / cores_per_socket] > 0.0 ?
+                            dm->socket_watts[i / cores_per_socket] * core_mperf[i] /
+                            socket_mperf[i / cores_per_socket] : 0.0;
+    }
+}
+
+void derived_metrics_append(const struct derived_metrics *dm,
+                            struct variorum_metric_vector *metrics)
+{
+    static const enum variorum_metric_domain_e domain[3] =
+    {
+        VARIORUM_DOMAIN_THREAD, VARIORUM_DOMAIN_CORE, VARIORUM_DOMAIN_SOCKET
+    };
+    unsigned count[3];
+    unsigned d, i, idx;
+    uint64_t ts;
+
+    if (dm->nsamples < 2)
+    {
+        return;
+    }
+    count[0] = dm->nthreads;
+    count[1] = dm->ncores;
+    count[2] = dm->nsockets;
+    ts = dm->snap[dm->cur].time_us;
+
+    for (d = 0, idx = 0; d < 3; d++)
+    {
+        for (i = 0; i < count[d]; i++, idx++)
+        {
+            variorum_metric_vector_append(metrics, "ipc_cpu", domain[d], i,
+                                          dm->ipc[idx], ts);
+            variorum_metric_vector_append(metrics, "freq_cpu_busy_ghz", domain[d], i,
+                                          dm->busy_ghz[idx], ts);
+            variorum_metric_vector_append(metrics, "freq_cpu_effective_ghz", domain[d],
+                                          i, dm->effective_ghz[idx], ts);
+            variorum_metric_vector_append(metrics, "util_cpu_percent", domain[d], i,
+                                          dm->util_percent[idx], ts);
+        }
+    }
+    for (i = 0; i < dm->ncores; i++)
+    {
+        variorum_metric_vector_append(metrics, "power_cpu_watts",
+                                      VARIORUM_DOMAIN_CORE, i, dm->core_watts[i], ts);
+    }
+    for (i = 0; i < dm->nsockets; i++)
+    {
+        variorum_metric_vector_append(metrics, "power_cpu_watts",
+                                      VARIORUM_DOMAIN_SOCKET, i, dm->socket_watts[i], ts);
+        variorum_metric_vector_append(metrics, "inst_cpu_per_joule",
+                                      VARIORUM_DOMAIN_SOCKET, i, dm->inst_per_joule[i], ts);
+    }
+}
+
+void derived_metrics_sample(struct derived_metrics *dm,
+                            const struct fixed_counter *c0, const struct fixed_counter *c1,
+                            const struct clocks_data *cd, const double *pkg_total_joules)
+{
+    struct derived_snapshot *snap = derived_metrics_next(dm);
+    struct timeval now;
+    unsigned i;
+
+    gettimeofday(&now, NULL);
+    snap->time_us = now.tv_sec * (uint64_t)1000000 + now.tv_usec;
+    msr_soa_gather(dm->nthreads, c0->value, snap->inst);
+    msr_soa_gather(dm->nthreads, c1->value, snap->core_cycles);
+    msr_soa_gather(dm->nthreads, cd->aperf, snap->aperf);
+    msr_soa_gather(dm->nthreads, cd->mperf, snap->mperf);
+    msr_soa_gather(dm->nthreads, cd->tsc, snap->tsc);
+    for (i = 0; i < dm->nsockets; i++)
+    {
+        snap->pkg_joules[i] = pkg_total_joules != NULL ? pkg_total_joules[i] : 0.0;
+    }
+    derived_metrics_compute(dm);
+}
+
+int get_derived_metrics(struct variorum_metric_vector *metrics,
+                        off_t *msrs_fixed_ctrs, off_t msr_perf_global_ctrl,
+                        off_t msr_fixed_counter_ctrl, off_t msr_aperf, off_t msr_mperf,
+                        off_t msr_tsc, off_t msr_platform_info, const double *pkg_total_joules)
+{
+    static struct derived_metrics dm;
+    static struct fixed_counter *c0, *c1;
+    static struct clocks_data *cd;
+    static int init = 0;
+    unsigned nsockets = 0;
+    unsigned ncores = 0;
+    unsigned nthreads = 0;
+    int max_non_turbo_ratio;
+
+    if (!init)
+    {
+#ifdef VARIORUM_WITH_INTEL_CPU
+        variorum_get_topology(&nsockets, &ncores, &nthreads, P_INTEL_CPU_IDX);
+#endif
+        if (get_max_non_turbo_ratio(msr_platform_info, &max_non_turbo_ratio) != 0 ||
+                derived_metrics_init(&dm, nsockets, ncores, nthreads,
+                                     max_non_turbo_ratio, cpuid_fixed_width()) != 0)
+        {
+            return -1;
+        }
+        // enable_fixed_counters() sets AnyThread.
+        dm.any_thread = 1;
+        fixed_counter_storage(&c0, &c1, NULL, msrs_fixed_ctrs);
+        enable_fixed_counters(msrs_fixed_ctrs, msr_perf_global_ctrl,
+                              msr_fixed_counter_ctrl);
+        clocks_storage(&cd, msr_aperf, msr_mperf, msr_tsc);
+        init = 1;
+    }
+
+    read_batch(FIXED_COUNTERS_DATA);
+    read_batch(CLOCKS_DATA);
+    derived_metrics_sample(&dm, c0, c1, cd, pkg_total_joules);
+    derived_metrics_append(&dm, metrics);
+    return 0;
+}
@@ -0,0 +1,207 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef DERIVED_FEATURES_H_INCLUDE
+#define DERIVED_FEATURES_H_INCLUDE
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <variorum_metrics.h>
+
+struct fixed_counter;
+struct clocks_data;
+
+/// @brief Structure containing one snapshot of the raw counters used by the
+/// derived metrics, stored contiguously per counter in arrays from
+/// msr_soa_alloc().
+struct derived_snapshot
+{
+    /// @brief Instructions retired (IA32_FIXED_CTR0), per thread.
+    uint64_t *inst;
+    /// @brief Unhalted core cycles (IA32_FIXED_CTR1), per thread.
+    uint64_t *core_cycles;
+    /// @brief IA32_APERF, per thread.
+    uint64_t *aperf;
+    /// @brief IA32_MPERF, per thread.
+    uint64_t *mperf;
+    /// @brief IA32_TIME_STAMP_COUNTER, per thread.
+    uint64_t *tsc;
+    /// @brief Package energy accumulated without wrapping, e.g.,
+    /// rapl_data.pkg_total_joules (in Joules), per socket.
+    double *pkg_joules;
+    /// @brief Time of the snapshot in microseconds.
+    uint64_t time_us;
+};
+
+/// @brief Structure containing the derived metrics computed from the two
+/// most recent snapshots.
+///
+/// Thread t belongs to core t % ncores, and core c to socket
+/// c / (ncores / nsockets). Every array holds one value per thread, core or
+/// socket.
+struct derived_metrics
+{
+    /// @brief Number of sockets.
+    unsigned nsockets;
+    /// @brief Number of cores.
+    unsigned ncores;
+    /// @brief Number of threads.
+    unsigned nthreads;
+    /// @brief Frequency of MPERF and the TSC (in GHz).
+    double base_ghz;
+    /// @brief Mask applied to fixed counter differences.
+    uint64_t fixed_mask;
+    /// @brief Indicator that the fixed counters of each thread count for
+    /// all threads of its core (AnyThread), so core totals are not summed
+    /// over threads.
+    int any_thread;
+    /// @brief Current and previous snapshots.
+    struct derived_snapshot snap[2];
+    /// @brief Index of the current snapshot.
+    unsigned cur;
+    /// @brief Number of snapshots taken.
+    unsigned nsamples;
+    /// @brief Time between the two most recent snapshots (in seconds).
+    double elapsed;
+
+    /// @brief Counter differences per domain, laid out as threads, then
+    /// cores, then sockets.
+    double *d_inst;
+    double *d_core_cycles;
+    double *d_aperf;
+    double *d_mperf;
+    double *d_tsc;
+
+    /// @brief Instructions per unhalted core cycle, laid out like d_inst.
+    double *ipc;
+    /// @brief Average frequency while not halted (in GHz), laid out like
+    /// d_inst.
+    double *busy_ghz;
+    /// @brief Average frequency over the interval including halted time (in
+    /// GHz), laid out like d_inst.
+    double *effective_ghz;
+    /// @brief Percent of the interval spent not halted, laid out like d_inst.
+    double *util_percent;
+    /// @brief Package power attributed to each core by its share of unhalted
+    /// reference cycles (in Watts).
+    double *core_watts;
+    /// @brief Package power (in Watts), per socket.
+    double *socket_watts;
+    /// @brief Instructions retired per Joule of package energy, per socket.
+    double *inst_per_joule;
+};
+
+/// @brief Allocate storage for derived metrics.
+///
+/// @param [out] dm Derived metrics.
+/// @param [in] nsockets Number of sockets.
+/// @param [in] ncores Number of cores.
+/// @param [in] nthreads Number of threads.
+/// @param [in] base_mhz Frequency of MPERF and the TSC (in MHz), as returned
+///        by get_max_non_turbo_ratio().
+/// @param [in] fixed_width Bit width of the fixed-function counters.
+///
+/// @return 0 if successful, else -1 if the topology is invalid.
+int derived_metrics_init(
+    struct derived_metrics *dm,
+    unsigned nsockets,
+    unsigned ncores,
+    unsigned nthreads,
+    int base_mhz,
+    int fixed_width
+);
+
+/// @brief Release the storage of derived metrics.
+///
+/// @param [in,out] dm Derived metrics.
+void derived_metrics_free(
+    struct derived_metrics *dm
+);
+
+/// @brief Get the snapshot to fill in next.
+///
+/// @param [in] dm Derived metrics.
+///
+/// @return Snapshot that becomes current on the next call to
+/// derived_metrics_compute().
+struct derived_snapshot *derived_metrics_next(
+    struct derived_metrics *dm
+);
+
+/// @brief Make the filled-in snapshot current and, from the second snapshot
+/// on, compute all derived metrics in one pass over contiguous arrays.
+///
+/// @param [in,out] dm Derived metrics.
+void derived_metrics_compute(
+    struct derived_metrics *dm
+);
+
+/// @brief Append derived metrics to a metric vector.
+///
+/// Appends ipc_cpu, freq_cpu_busy_ghz, freq_cpu_effective_ghz and
+/// util_cpu_percent for every thread, core and socket, power_cpu_watts for
+/// every core and socket, and inst_cpu_per_joule for every socket. Nothing is
+/// appended before the second snapshot.
+///
+/// @param [in] dm Derived metrics.
+/// @param [out] metrics Metric vector to append to.
+void derived_metrics_append(
+    const struct derived_metrics *dm,
+    struct variorum_metric_vector *metrics
+);
+
+/// @brief Take a snapshot of the fixed counters, APERF, MPERF and TSC that
+/// have already been read, and compute derived metrics.
+///
+/// @param [in,out] dm Derived metrics.
+/// @param [in] c0 Instructions retired.
+/// @param [in] c1 Unhalted core cycles.
+/// @param [in] cd APERF, MPERF and TSC.
+/// @param [in] pkg_total_joules Package energy accumulated without wrapping,
+///        per socket, e.g., rapl_data.pkg_total_joules.
+void derived_metrics_sample(
+    struct derived_metrics *dm,
+    const struct fixed_counter *c0,
+    const struct fixed_counter *c1,
+    const struct clocks_data *cd,
+    const double *pkg_total_joules
+);
+
+/// @brief Sample the fixed counters, APERF, MPERF and TSC and append derived
+/// metrics to a metric vector.
+///
+/// The package energy must have been read just before, e.g., by
+/// get_energy_metrics(). Power is computed from the energy accumulated since
+/// the previous call, so other readers of the energy in between do not
+/// shorten the interval.
+///
+/// @param [out] metrics Metric vector to append to.
+/// @param [in] msrs_fixed_ctrs Array of unique addresses for fixed counters.
+/// @param [in] msr_perf_global_ctrl Unique MSR address for
+///        IA32_PERF_GLOBAL_CTRL.
+/// @param [in] msr_fixed_counter_ctrl Unique MSR address for
+///        IA32_FIXED_CTR_CTRL.
+/// @param [in] msr_aperf Unique MSR address for IA32_APERF.
+/// @param [in] msr_mperf Unique MSR address for IA32_MPERF.
+/// @param [in] msr_tsc Unique MSR address for IA32_TIME_STAMP_COUNTER.
+/// @param [in] msr_platform_info Unique MSR address for MSR_PLATFORM_INFO.
+/// @param [in] pkg_total_joules Package energy accumulated without wrapping,
+///        per socket, e.g., rapl_data.pkg_total_joules.
+///
+/// @return 0 if successful, else -1 if the base frequency cannot be read.
+int get_derived_metrics(
+    struct variorum_metric_vector *metrics,
+    off_t *msrs_fixed_ctrs,
+    off_t msr_perf_global_ctrl,
+    off_t msr_fixed_counter_ctrl,
+    off_t msr_aperf,
+    off_t msr_mperf,
+    off_t msr_tsc,
+    off_t msr_platform_info,
+    const double *pkg_total_joules
+);
+
+#endif
@@ -0,0 +1,254 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+// Generator for the per-model event tables, which are checked in as
+// pmc_events_<uarch>.c next to their definitions so that cross-compiled
+// builds do not need to run it. After editing a definition, regenerate the
+// tables with the pmc_events_tables target of a native build.
+//
+// Usage: gen_pmc_events <uarch> <input.def> <output.c>
+//
+// Each non-comment line of the input holds one event:
+//
+//   NAME  EVENTSEL  UMASK  CMASK  FLAGS  COUNTERS
+//
+// Numbers may be decimal or 0x-prefixed hexadecimal. The output defines
+// pmc_events_<uarch>, a struct pmc_event_table with a perfect hash: keys are
+// split into buckets by pmc_event_hash(name, 0), and each bucket gets the
+// first seed that places all of its keys into free slots.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include <pmc_event_table.h>
+
+#define MAX_LINE 256
+#define MAX_SEED 65535
+
+struct def
+{
+    char name[MAX_LINE];
+    unsigned long eventsel;
+    unsigned long umask;
+    unsigned long cmask;
+    unsigned long flags;
+    unsigned long counters;
+    unsigned bucket;
+};
+
+struct bucket
+{
+    unsigned id;
+    unsigned nkeys;
+};
+
+static int by_size_desc(const void *a, const void *b)
+{
+    const struct bucket *x = (const struct bucket *)a;
+    const struct bucket *y = (const struct bucket *)b;
+
+    if (x->nkeys != y->nkeys)
+    {
+        return x->nkeys < y->nkeys ? 1 : -1;
+    }
+    return x->id < y->id ? -1 : (x->id > y->id);
+}
+
+static int read_defs(const char *path, struct def **defs, unsigned *ndefs)
+{
+    FILE *in;
+    char line[MAX_LINE];
+    unsigned lineno = 0;
+    unsigned i;
+    struct def d;
+
+    in = fopen(path, "r");
+    if (in == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    *defs = NULL;
+    *ndefs = 0;
+    while (fgets(line, sizeof(line), in) != NULL)
+    {
+        char *p = line;
+
+        lineno++;
+        while (*p == ' ' || *p == '\t')
+        {
+            p++;
+        }
+        if (*p == '#' || *p == '\n' || *p == '\0')
+        {
+            continue;
+        }
+        memset(&d, 0, sizeof(d));
+        if (sscanf(p, "%255s %li %li %li %li %li", d.name, (long *)&d.eventsel,
+                   (long *)&d.umask, (long *)&d.cmask, (long *)&d.flags,
+                   (long *)&d.counters) != 6 ||
+                d.eventsel > 0xFF || d.umask > 0xFF || d.cmask > 0xFF ||
+                d.flags > 0xFF || d.counters == 0 || d.counters > 0xFF)
+        {
+            fprintf(stderr, "%s:%u: malformed event definition\n", path, lineno);
+            fclose(in);
+            return -1;
+        }
+        for (i = 0; i < *ndefs; i++)
+        {
+            if (strcasecmp((*defs)[i].name, d.name) == 0)
+            {
+                fprintf(stderr, "%s:%u: duplicate event %s\n", path, lineno, d.name);
+                fclose(in);
+                return -1;
+            }
+        }
+        *defs = (struct def *) realloc(*defs, (*ndefs + 1) * sizeof(struct def));
+        (*defs)[(*ndefs)++] = d;
+    }
+    fclose(in);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct def *defs = NULL;
+    struct bucket *buckets;
+    unsigned ndefs;
+    unsigned nslots, nbuckets;
+    unsigned *seeds;
+    int *slot_of;
+    int *taken;
+    unsigned b, i, k;
+    uint32_t seed;
+    const char *def_name;
+    FILE *out;
+
+    if (argc != 4)
+    {
+        fprintf(stderr, "Usage: %s <uarch> <input.def> <output.c>\n", argv[0]);
+        return 1;
+    }
+    if (read_defs(argv[2], &defs, &ndefs) != 0)
+    {
+        return 1;
+    }
+
+    // At least twice as many slots as keys keeps the seed search short.
+    nslots = 1;
+    while (nslots < 2 * ndefs)
+    {
+        nslots <<= 1;
+    }
+    nbuckets = ndefs / 2 + 1;
+
+    buckets = (struct bucket *) calloc(nbuckets, sizeof(struct bucket));
+    seeds = (unsigned *) calloc(nbuckets, sizeof(unsigned));
+    slot_of = (int *) malloc(ndefs * sizeof(int));
+    taken = (int *) calloc(nslots, sizeof(int));
+    for (b = 0; b < nbuckets; b++)
+    {
+        buckets[b].id = b;
+    }
+    for (i = 0; i < ndefs; i++)
+    {
+        defs[i].bucket = pmc_event_hash(defs[i].name, 0) % nbuckets;
+        buckets[defs[i].bucket].nkeys++;
+    }
+    qsort(buckets, nbuckets, sizeof(struct bucket), by_size_desc);
+
+    // Place the largest buckets first, while most slots are still free.
+    for (b = 0; b < nbuckets && buckets[b].nkeys > 0; b++)
+    {
+        unsigned id = buckets[b].id;
+
+        for (seed = 1; seed <= MAX_SEED; seed++)
+        {
+            int ok = 1;
+
+            for (i = 0; i < ndefs && ok; i++)
+            {
+                if (defs[i].bucket != id)
+                {
+                    continue;
+                }
+                slot_of[i] = pmc_event_hash(defs[i].name, seed) & (nslots - 1);
+                if (taken[slot_of[i]])
+                {
+                    ok = 0;
+                }
+                // Keys of the same bucket must not collide with each other.
+                for (k = 0; k < i && ok; k++)
+                {
+                    if (defs[k].bucket == id && slot_of[k] == slot_of[i])
+                    {
+                        ok = 0;
+                    }
+                }
+            }
+            if (ok)
+            {
+                break;
+            }
+        }
+        if (seed > MAX_SEED)
+        {
+            fprintf(stderr, "%s: no perfect hash found\n", argv[2]);
+            return 1;
+        }
+        seeds[id] = seed;
+        for (i = 0; i < ndefs; i++)
+        {
+            if (defs[i].bucket == id)
+            {
+                taken[slot_of[i]] = 1;
+            }
+        }
+    }
+
+    out = fopen(argv[3], "w");
+    if (out == NULL)
+    {
+        perror(argv[3]);
+        return 1;
+    }
+    def_name = strrchr(argv[2], '/');
+    def_name = def_name != NULL ? def_name + 1 : argv[2];
+    fprintf(out, "// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other\n"
+            "// Variorum Project Developers. See the top-level LICENSE file for details.\n"
+            "//\n"
+            "// SPDX-License-Identifier: MIT\n\n");
+    fprintf(out, "// Generated by gen_pmc_events from %s. Do not edit.\n\n",
+            def_name);
+    fprintf(out, "#include <stddef.h>\n\n#include <pmc_event_table.h>\n\n");
+    fprintf(out, "static const struct pmc_event_def slots[%u] =\n{\n", nslots);
+    for (i = 0; i < ndefs; i++)
+    {
+        fprintf(out, "    [%d] = {\"%s\", 0x%02lX, 0x%02lX, 0x%02lX, 0x%02lX, 0x%02lX},\n",
+                slot_of[i], defs[i].name, defs[i].eventsel, defs[i].umask,
+                defs[i].cmask, defs[i].flags, defs[i].counters);
+    }
+    fprintf(out, "};\n\n");
+    fprintf(out, "static const uint16_t seeds[%u] =\n{\n", nbuckets);
+    for (b = 0; b < nbuckets; b++)
+    {
+        fprintf(out, "%s%u,%s", b % 12 == 0 ? "    " : " ", seeds[b],
+                (b % 12 == 11 || b == nbuckets - 1) ? "\n" : "");
+    }
+    fprintf(out, "};\n\n");
+    fprintf(out, "const struct pmc_event_table pmc_events_%s =\n{\n", argv[1]);
+    fprintf(out, "    \"%s\", slots, %u, seeds, %u, %u\n};\n", argv[1], nslots,
+            nbuckets, ndefs);
+    fclose(out);
+
+    free(defs);
+    free(buckets);
+    free(seeds);
+    free(slot_of);
+    free(taken);
+    return 0;
+}
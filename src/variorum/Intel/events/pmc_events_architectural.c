@@ -0,0 +1,31 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+// Generated by gen_pmc_events from architectural.def. Do not edit.
+
+#include <stddef.h>
+
+#include <pmc_event_table.h>
+
+static const struct pmc_event_def slots[16] =
+{
+    [13] = {"UNHALTED_CORE_CYCLES", 0x3C, 0x00, 0x00, 0x00, 0xFF},
+    [4] = {"INSTRUCTION_RETIRED", 0xC0, 0x00, 0x00, 0x00, 0xFF},
+    [1] = {"UNHALTED_REFERENCE_CYCLES", 0x3C, 0x01, 0x00, 0x00, 0xFF},
+    [10] = {"LLC_REFERENCE", 0x2E, 0x4F, 0x00, 0x00, 0xFF},
+    [5] = {"LLC_MISSES", 0x2E, 0x41, 0x00, 0x00, 0xFF},
+    [12] = {"BRANCH_INSTRUCTION_RETIRED", 0xC4, 0x00, 0x00, 0x00, 0xFF},
+    [0] = {"BRANCH_MISSES_RETIRED", 0xC5, 0x00, 0x00, 0x00, 0xFF},
+};
+
+static const uint16_t seeds[4] =
+{
+    1, 0, 1, 5,
+};
+
+const struct pmc_event_table pmc_events_architectural =
+{
+    "architectural", slots, 16, seeds, 4, 7
+};
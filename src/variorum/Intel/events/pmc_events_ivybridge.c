@@ -0,0 +1,58 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+// Generated by gen_pmc_events from ivybridge.def. Do not edit.
+
+#include <stddef.h>
+
+#include <pmc_event_table.h>
+
+static const struct pmc_event_def slots[128] =
+{
+    [4] = {"INST_RETIRED.ANY_P", 0xC0, 0x00, 0x00, 0x00, 0xFF},
+    [26] = {"CPU_CLK_UNHALTED.THREAD_P", 0x3C, 0x00, 0x00, 0x00, 0xFF},
+    [43] = {"CPU_CLK_THREAD_UNHALTED.REF_XCLK", 0x3C, 0x01, 0x00, 0x00, 0xFF},
+    [97] = {"BR_INST_RETIRED.ALL_BRANCHES", 0xC4, 0x00, 0x00, 0x00, 0xFF},
+    [119] = {"BR_MISP_RETIRED.ALL_BRANCHES", 0xC5, 0x00, 0x00, 0x00, 0xFF},
+    [115] = {"LONGEST_LAT_CACHE.REFERENCE", 0x2E, 0x4F, 0x00, 0x00, 0xFF},
+    [81] = {"LONGEST_LAT_CACHE.MISS", 0x2E, 0x41, 0x00, 0x00, 0xFF},
+    [34] = {"UOPS_ISSUED.ANY", 0x0E, 0x01, 0x00, 0x00, 0xFF},
+    [53] = {"UOPS_RETIRED.RETIRE_SLOTS", 0xC2, 0x02, 0x00, 0x00, 0xFF},
+    [57] = {"IDQ_UOPS_NOT_DELIVERED.CORE", 0x9C, 0x01, 0x00, 0x00, 0xFF},
+    [69] = {"RESOURCE_STALLS.ANY", 0xA2, 0x01, 0x00, 0x00, 0xFF},
+    [39] = {"L1D.REPLACEMENT", 0x51, 0x01, 0x00, 0x00, 0xFF},
+    [54] = {"INT_MISC.RECOVERY_CYCLES", 0x0D, 0x03, 0x01, 0x00, 0xFF},
+    [73] = {"L1D_PEND_MISS.PENDING", 0x48, 0x01, 0x00, 0x00, 0x04},
+    [121] = {"CYCLE_ACTIVITY.CYCLES_NO_EXECUTE", 0xA3, 0x04, 0x04, 0x00, 0x0F},
+    [99] = {"CYCLE_ACTIVITY.CYCLES_L1D_PENDING", 0xA3, 0x08, 0x08, 0x00, 0x04},
+    [14] = {"CYCLE_ACTIVITY.STALLS_L1D_PENDING", 0xA3, 0x0C, 0x0C, 0x00, 0x04},
+    [124] = {"CYCLE_ACTIVITY.STALLS_L2_PENDING", 0xA3, 0x05, 0x05, 0x00, 0x0F},
+    [60] = {"MEM_UOPS_RETIRED.ALL_LOADS", 0xD0, 0x81, 0x00, 0x00, 0x0F},
+    [104] = {"MEM_UOPS_RETIRED.ALL_STORES", 0xD0, 0x82, 0x00, 0x00, 0x0F},
+    [51] = {"MEM_LOAD_UOPS_RETIRED.L1_HIT", 0xD1, 0x01, 0x00, 0x00, 0x0F},
+    [25] = {"MEM_LOAD_UOPS_RETIRED.L2_HIT", 0xD1, 0x02, 0x00, 0x00, 0x0F},
+    [68] = {"MEM_LOAD_UOPS_RETIRED.LLC_HIT", 0xD1, 0x04, 0x00, 0x00, 0x0F},
+    [5] = {"MEM_LOAD_UOPS_RETIRED.L1_MISS", 0xD1, 0x08, 0x00, 0x00, 0x0F},
+    [95] = {"MEM_LOAD_UOPS_RETIRED.L2_MISS", 0xD1, 0x10, 0x00, 0x00, 0x0F},
+    [108] = {"MEM_LOAD_UOPS_RETIRED.LLC_MISS", 0xD1, 0x20, 0x00, 0x00, 0x0F},
+    [10] = {"FP_COMP_OPS_EXE.X87", 0x10, 0x01, 0x00, 0x00, 0xFF},
+    [21] = {"FP_COMP_OPS_EXE.SSE_PACKED_DOUBLE", 0x10, 0x10, 0x00, 0x00, 0xFF},
+    [79] = {"FP_COMP_OPS_EXE.SSE_SCALAR_SINGLE", 0x10, 0x20, 0x00, 0x00, 0xFF},
+    [66] = {"FP_COMP_OPS_EXE.SSE_PACKED_SINGLE", 0x10, 0x40, 0x00, 0x00, 0xFF},
+    [12] = {"FP_COMP_OPS_EXE.SSE_SCALAR_DOUBLE", 0x10, 0x80, 0x00, 0x00, 0xFF},
+    [113] = {"SIMD_FP_256.PACKED_SINGLE", 0x11, 0x01, 0x00, 0x00, 0xFF},
+    [32] = {"SIMD_FP_256.PACKED_DOUBLE", 0x11, 0x02, 0x00, 0x00, 0xFF},
+};
+
+static const uint16_t seeds[17] =
+{
+    2, 0, 1, 3, 1, 1, 0, 1, 1, 1, 1, 1,
+    1, 1, 1, 4, 3,
+};
+
+const struct pmc_event_table pmc_events_ivybridge =
+{
+    "ivybridge", slots, 128, seeds, 17, 33
+};
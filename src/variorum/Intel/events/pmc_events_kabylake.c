@@ -0,0 +1,62 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+// Generated by gen_pmc_events from kabylake.def. Do not edit.
+
+#include <stddef.h>
+
+#include <pmc_event_table.h>
+
+static const struct pmc_event_def slots[128] =
+{
+    [4] = {"INST_RETIRED.ANY_P", 0xC0, 0x00, 0x00, 0x00, 0xFF},
+    [26] = {"CPU_CLK_UNHALTED.THREAD_P", 0x3C, 0x00, 0x00, 0x00, 0xFF},
+    [44] = {"CPU_CLK_UNHALTED.REF_XCLK", 0x3C, 0x01, 0x00, 0x00, 0xFF},
+    [97] = {"BR_INST_RETIRED.ALL_BRANCHES", 0xC4, 0x00, 0x00, 0x00, 0xFF},
+    [43] = {"BR_MISP_RETIRED.ALL_BRANCHES", 0xC5, 0x00, 0x00, 0x00, 0xFF},
+    [115] = {"LONGEST_LAT_CACHE.REFERENCE", 0x2E, 0x4F, 0x00, 0x00, 0xFF},
+    [81] = {"LONGEST_LAT_CACHE.MISS", 0x2E, 0x41, 0x00, 0x00, 0xFF},
+    [99] = {"UOPS_ISSUED.ANY", 0x0E, 0x01, 0x00, 0x00, 0xFF},
+    [53] = {"UOPS_RETIRED.RETIRE_SLOTS", 0xC2, 0x02, 0x00, 0x00, 0xFF},
+    [119] = {"IDQ_UOPS_NOT_DELIVERED.CORE", 0x9C, 0x01, 0x00, 0x00, 0xFF},
+    [69] = {"RESOURCE_STALLS.ANY", 0xA2, 0x01, 0x00, 0x00, 0xFF},
+    [124] = {"L1D.REPLACEMENT", 0x51, 0x01, 0x00, 0x00, 0xFF},
+    [68] = {"MACHINE_CLEARS.COUNT", 0xC3, 0x01, 0x01, 0x04, 0xFF},
+    [54] = {"INT_MISC.RECOVERY_CYCLES", 0x0D, 0x01, 0x00, 0x00, 0xFF},
+    [2] = {"L1D_PEND_MISS.PENDING", 0x48, 0x01, 0x00, 0x00, 0xFF},
+    [45] = {"CYCLE_ACTIVITY.STALLS_TOTAL", 0xA3, 0x04, 0x04, 0x00, 0xFF},
+    [20] = {"CYCLE_ACTIVITY.STALLS_L1D_MISS", 0xA3, 0x0C, 0x0C, 0x00, 0xFF},
+    [34] = {"CYCLE_ACTIVITY.STALLS_L2_MISS", 0xA3, 0x05, 0x05, 0x00, 0xFF},
+    [57] = {"CYCLE_ACTIVITY.STALLS_L3_MISS", 0xA3, 0x06, 0x06, 0x00, 0xFF},
+    [94] = {"CYCLE_ACTIVITY.STALLS_MEM_ANY", 0xA3, 0x14, 0x14, 0x00, 0xFF},
+    [21] = {"L2_RQSTS.REFERENCES", 0x24, 0xFF, 0x00, 0x00, 0xFF},
+    [73] = {"L2_RQSTS.MISS", 0x24, 0x3F, 0x00, 0x00, 0xFF},
+    [109] = {"DTLB_LOAD_MISSES.WALK_COMPLETED", 0x08, 0x0E, 0x00, 0x00, 0xFF},
+    [96] = {"MEM_INST_RETIRED.ALL_LOADS", 0xD0, 0x81, 0x00, 0x00, 0x0F},
+    [28] = {"MEM_INST_RETIRED.ALL_STORES", 0xD0, 0x82, 0x00, 0x00, 0x0F},
+    [95] = {"MEM_LOAD_RETIRED.L1_HIT", 0xD1, 0x01, 0x00, 0x00, 0x0F},
+    [40] = {"MEM_LOAD_RETIRED.L2_HIT", 0xD1, 0x02, 0x00, 0x00, 0x0F},
+    [9] = {"MEM_LOAD_RETIRED.L3_HIT", 0xD1, 0x04, 0x00, 0x00, 0x0F},
+    [49] = {"MEM_LOAD_RETIRED.L1_MISS", 0xD1, 0x08, 0x00, 0x00, 0x0F},
+    [24] = {"MEM_LOAD_RETIRED.L2_MISS", 0xD1, 0x10, 0x00, 0x00, 0x0F},
+    [5] = {"MEM_LOAD_RETIRED.L3_MISS", 0xD1, 0x20, 0x00, 0x00, 0x0F},
+    [18] = {"FP_ARITH_INST_RETIRED.SCALAR_DOUBLE", 0xC7, 0x01, 0x00, 0x00, 0xFF},
+    [14] = {"FP_ARITH_INST_RETIRED.SCALAR_SINGLE", 0xC7, 0x02, 0x00, 0x00, 0xFF},
+    [13] = {"FP_ARITH_INST_RETIRED.128B_PACKED_DOUBLE", 0xC7, 0x04, 0x00, 0x00, 0xFF},
+    [111] = {"FP_ARITH_INST_RETIRED.128B_PACKED_SINGLE", 0xC7, 0x08, 0x00, 0x00, 0xFF},
+    [114] = {"FP_ARITH_INST_RETIRED.256B_PACKED_DOUBLE", 0xC7, 0x10, 0x00, 0x00, 0xFF},
+    [35] = {"FP_ARITH_INST_RETIRED.256B_PACKED_SINGLE", 0xC7, 0x20, 0x00, 0x00, 0xFF},
+};
+
+static const uint16_t seeds[19] =
+{
+    0, 0, 1, 1, 1, 0, 1, 2, 1, 0, 2, 1,
+    1, 1, 1, 2, 1, 1, 2,
+};
+
+const struct pmc_event_table pmc_events_kabylake =
+{
+    "kabylake", slots, 128, seeds, 19, 37
+};
@@ -0,0 +1,52 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+// Generated by gen_pmc_events from sandybridge.def. Do not edit.
+
+#include <stddef.h>
+
+#include <pmc_event_table.h>
+
+static const struct pmc_event_def slots[64] =
+{
+    [10] = {"INST_RETIRED.ANY_P", 0xC0, 0x00, 0x00, 0x00, 0xFF},
+    [26] = {"CPU_CLK_UNHALTED.THREAD_P", 0x3C, 0x00, 0x00, 0x00, 0xFF},
+    [46] = {"CPU_CLK_THREAD_UNHALTED.REF_XCLK", 0x3C, 0x01, 0x00, 0x00, 0xFF},
+    [33] = {"BR_INST_RETIRED.ALL_BRANCHES", 0xC4, 0x00, 0x00, 0x00, 0xFF},
+    [43] = {"BR_MISP_RETIRED.ALL_BRANCHES", 0xC5, 0x00, 0x00, 0x00, 0xFF},
+    [51] = {"LONGEST_LAT_CACHE.REFERENCE", 0x2E, 0x4F, 0x00, 0x00, 0xFF},
+    [17] = {"LONGEST_LAT_CACHE.MISS", 0x2E, 0x41, 0x00, 0x00, 0xFF},
+    [34] = {"UOPS_ISSUED.ANY", 0x0E, 0x01, 0x00, 0x00, 0xFF},
+    [53] = {"UOPS_RETIRED.RETIRE_SLOTS", 0xC2, 0x02, 0x00, 0x00, 0xFF},
+    [55] = {"IDQ_UOPS_NOT_DELIVERED.CORE", 0x9C, 0x01, 0x00, 0x00, 0xFF},
+    [30] = {"RESOURCE_STALLS.ANY", 0xA2, 0x01, 0x00, 0x00, 0xFF},
+    [39] = {"L1D.REPLACEMENT", 0x51, 0x01, 0x00, 0x00, 0xFF},
+    [54] = {"INT_MISC.RECOVERY_CYCLES", 0x0D, 0x03, 0x01, 0x00, 0xFF},
+    [9] = {"L1D_PEND_MISS.PENDING", 0x48, 0x01, 0x00, 0x00, 0x04},
+    [21] = {"MEM_UOPS_RETIRED.ALL_LOADS", 0xD0, 0x81, 0x00, 0x00, 0x0F},
+    [40] = {"MEM_UOPS_RETIRED.ALL_STORES", 0xD0, 0x82, 0x00, 0x00, 0x0F},
+    [24] = {"MEM_LOAD_UOPS_RETIRED.L1_HIT", 0xD1, 0x01, 0x00, 0x00, 0x0F},
+    [62] = {"MEM_LOAD_UOPS_RETIRED.L2_HIT", 0xD1, 0x02, 0x00, 0x00, 0x0F},
+    [4] = {"MEM_LOAD_UOPS_RETIRED.LLC_HIT", 0xD1, 0x04, 0x00, 0x00, 0x0F},
+    [18] = {"MEM_LOAD_UOPS_RETIRED.HIT_LFB", 0xD1, 0x40, 0x00, 0x00, 0x0F},
+    [52] = {"FP_COMP_OPS_EXE.X87", 0x10, 0x01, 0x00, 0x00, 0xFF},
+    [13] = {"FP_COMP_OPS_EXE.SSE_PACKED_DOUBLE", 0x10, 0x10, 0x00, 0x00, 0xFF},
+    [3] = {"FP_COMP_OPS_EXE.SSE_SCALAR_SINGLE", 0x10, 0x20, 0x00, 0x00, 0xFF},
+    [60] = {"FP_COMP_OPS_EXE.SSE_PACKED_SINGLE", 0x10, 0x40, 0x00, 0x00, 0xFF},
+    [12] = {"FP_COMP_OPS_EXE.SSE_SCALAR_DOUBLE", 0x10, 0x80, 0x00, 0x00, 0xFF},
+    [49] = {"SIMD_FP_256.PACKED_SINGLE", 0x11, 0x01, 0x00, 0x00, 0xFF},
+    [32] = {"SIMD_FP_256.PACKED_DOUBLE", 0x11, 0x02, 0x00, 0x00, 0xFF},
+};
+
+static const uint16_t seeds[14] =
+{
+    4, 2, 0, 1, 1, 1, 4, 2, 4, 1, 1, 1,
+    0, 6,
+};
+
+const struct pmc_event_table pmc_events_sandybridge =
+{
+    "sandybridge", slots, 64, seeds, 14, 27
+};
@@ -14,6 +14,7 @@
 #include <intel_power_features.h>
 #include <config_architecture.h>
 #include <msr_core.h>
+#include <perf_rapl_features.h>
 #include <variorum_error.h>
 #include <variorum_timers.h>
 
@@ -325,6 +326,7 @@ static void create_rapl_data_batch(struct rapl_data *rapl,
     rapl->old_pkg_joules = (double *) calloc(nsockets, sizeof(double));
     rapl->pkg_delta_joules = (double *) calloc(nsockets, sizeof(double));
     rapl->pkg_delta_bits = (uint64_t *) calloc(nsockets, sizeof(uint64_t));
+    rapl->pkg_total_joules = (double *) calloc(nsockets, sizeof(double));
     rapl->pkg_watts = (double *) calloc(nsockets, sizeof(double));
     load_socket_batch(msr_pkg_energy_status, rapl->pkg_bits, RAPL_DATA);
 
@@ -334,6 +336,7 @@ static void create_rapl_data_batch(struct rapl_data *rapl,
     rapl->old_dram_joules = (double *) calloc(nsockets, sizeof(double));
     rapl->dram_delta_joules = (double *) calloc(nsockets, sizeof(double));
     rapl->dram_delta_bits = (uint64_t *) calloc(nsockets, sizeof(uint64_t));
+    rapl->dram_total_joules = (double *) calloc(nsockets, sizeof(double));
     rapl->dram_watts = (double *) calloc(nsockets, sizeof(double));
     load_socket_batch(msr_dram_energy_status, rapl->dram_bits, RAPL_DATA);
 
@@ -996,6 +999,8 @@ int delta_rapl_data(off_t msr_rapl_unit)
     static unsigned nsockets = 0;
     static struct rapl_data *rapl;
     unsigned i = 0;
+    /* Perf power PMU counts are 64 bits and never need wraparound handling. */
+    int perf = perf_rapl_enabled(NULL);
 
 #ifdef VARIORUM_DEBUG
     fprintf(stderr, "%s %s::%d DEBUG: (delta_rapl_data)\n", getenv("HOSTNAME"),
@@ -1027,7 +1032,7 @@ int delta_rapl_data(off_t msr_rapl_unit)
     for (i = 0; i < nsockets; i++)
     {
         /* Check to see if there was wraparound and use corresponding translation. */
-        if ((double) * rapl->pkg_bits[i] - (double)rapl->old_pkg_bits[i] < 0)
+        if (!perf && (double) * rapl->pkg_bits[i] - (double)rapl->old_pkg_bits[i] < 0)
         {
             rapl->pkg_delta_bits[i] = (uint64_t)((*rapl->pkg_bits[i] +
                                                   (uint64_t)max_joules) - rapl->old_pkg_bits[i]);
@@ -1058,7 +1063,7 @@ int delta_rapl_data(off_t msr_rapl_unit)
         }
 
         /* Check to see if there was wraparound and use corresponding translation. */
-        if ((double)*rapl->dram_bits[i] - (double)rapl->old_dram_bits[i] < 0)
+        if (!perf && (double)*rapl->dram_bits[i] - (double)rapl->old_dram_bits[i] < 0)
         {
             rapl->dram_delta_bits[i] = (uint64_t)((*rapl->dram_bits[i] +
                                                    (uint64_t)max_joules) - rapl->old_dram_bits[i]);
@@ -1082,6 +1087,8 @@ int delta_rapl_data(off_t msr_rapl_unit)
             variorum_error_handler("DRAM energy used since last same is negative",
                                    VARIORUM_ERROR_INVAL, getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
         }
+        rapl->pkg_total_joules[i] += rapl->pkg_delta_joules[i];
+        rapl->dram_total_joules[i] += rapl->dram_delta_joules[i];
 
         /* Get watts. */
         if (rapl->elapsed > 0.0L)
@@ -1394,6 +1401,7 @@ int read_rapl_data(off_t msr_rapl_unit, off_t msr_pkg_energy_status,
     static struct rapl_data *rapl = NULL;
     static int init = 0;
     static unsigned nsockets = 0;
+    struct perf_rapl_data *perf = NULL;
     unsigned i;
 
     if (!init)
@@ -1463,6 +1471,24 @@ int read_rapl_data(off_t msr_rapl_unit, off_t msr_pkg_energy_status,
             //}
         }
     }
+    if (perf_rapl_enabled(&perf))
+    {
+        /* One group read per socket replaces the RAPL_DATA batch. */
+        if (perf_rapl_read(perf))
+        {
+            variorum_error_handler("Could not read perf power PMU",
+                                   VARIORUM_ERROR_RUNTIME, getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+            return -1;
+        }
+        for (i = 0; i < nsockets && i < perf->nsockets; i++)
+        {
+            rapl->pkg_joules[i] = perf->joules[i * PERF_RAPL_NUM_DOMAINS + PERF_RAPL_PKG];
+            rapl->dram_joules[i] = perf->joules[i * PERF_RAPL_NUM_DOMAINS +
+                                                PERF_RAPL_RAM];
+        }
+        init = 1;
+        return 0;
+    }
     read_batch(RAPL_DATA);
     for (i = 0; i < nsockets; i++)
     {
@@ -1761,3 +1787,61 @@ void json_get_energy_data(json_t *get_energy_obj, off_t msr_rapl_unit,
     json_object_set_new(get_energy_obj, "energy_node_joules",
                         json_real(node_energy));
 }
+
+void get_energy_metrics(struct variorum_metric_vector *metrics,
+                        off_t msr_rapl_unit, off_t msr_pkg_energy_status,
+                        off_t msr_dram_energy_status)
+{
+    static struct rapl_data *rapl = NULL;
+    unsigned nsockets = 0;
+    unsigned i;
+    uint64_t ts;
+
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(&nsockets, NULL, NULL, P_INTEL_CPU_IDX);
+#endif
+
+    get_power(msr_rapl_unit, msr_pkg_energy_status, msr_dram_energy_status);
+    if (rapl == NULL)
+    {
+        rapl_storage(&rapl);
+    }
+
+    ts = rapl->now.tv_sec * (uint64_t)1000000 + rapl->now.tv_usec;
+    for (i = 0; i < nsockets; i++)
+    {
+        variorum_metric_vector_append(metrics, "energy_cpu_joules",
+                                      VARIORUM_DOMAIN_SOCKET, i, rapl->pkg_joules[i], ts);
+        variorum_metric_vector_append(metrics, "energy_mem_joules",
+                                      VARIORUM_DOMAIN_SOCKET, i, rapl->dram_joules[i], ts);
+    }
+}
+
+void get_total_energy_metrics(struct variorum_metric_vector *metrics,
+                              off_t msr_rapl_unit, off_t msr_pkg_energy_status,
+                              off_t msr_dram_energy_status)
+{
+    static struct rapl_data *rapl = NULL;
+    unsigned nsockets = 0;
+    unsigned i;
+    uint64_t ts;
+
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(&nsockets, NULL, NULL, P_INTEL_CPU_IDX);
+#endif
+
+    get_power(msr_rapl_unit, msr_pkg_energy_status, msr_dram_energy_status);
+    if (rapl == NULL)
+    {
+        rapl_storage(&rapl);
+    }
+
+    ts = rapl->now.tv_sec * (uint64_t)1000000 + rapl->now.tv_usec;
+    for (i = 0; i < nsockets; i++)
+    {
+        variorum_metric_vector_append(metrics, "energy_cpu_joules",
+                                      VARIORUM_DOMAIN_SOCKET, i, rapl->pkg_total_joules[i], ts);
+        variorum_metric_vector_append(metrics, "energy_mem_joules",
+                                      VARIORUM_DOMAIN_SOCKET, i, rapl->dram_total_joules[i], ts);
+    }
+}
@@ -11,6 +11,8 @@
 #include <stdio.h>
 #include <sys/types.h>
 
+#include <variorum_metrics.h>
+
 #define UINT_MAX 4294967295U // taken from limits.h
 #define STD_ENERGY_UNIT 65536.0
 
@@ -137,6 +139,10 @@ struct rapl_data
     /// measurements.
     double *pkg_delta_joules;
     uint64_t *pkg_delta_bits;
+    /// @brief Package-level energy usage summed over the differences of all
+    /// data measurements (in Joules), which does not wrap around. Consumers
+    /// sampling at their own interval take differences of this.
+    double *pkg_total_joules;
     /// @brief Package-level power consumption (in Watts) derived by dividing
     /// difference in package-level energy usage by time elapsed between data
     /// measurements.
@@ -160,6 +166,9 @@ struct rapl_data
     /// @brief Difference in DRAM energy usage between two data measurements.
     double *dram_delta_joules;
     uint64_t *dram_delta_bits;
+    /// @brief DRAM energy usage summed over the differences of all data
+    /// measurements (in Joules), which does not wrap around.
+    double *dram_total_joules;
     /// @brief DRAM power consumption (in Watts) derived by dividing difference
     /// in DRAM energy usage by time elapsed between data measurements.
     double *dram_watts;
@@ -379,6 +388,37 @@ void json_get_energy_data(
     off_t msr_dram_energy_status
 );
 
+/// @brief Append package and DRAM energy of each socket accumulated since
+/// the first read to a metric vector.
+///
+/// Only the energy status registers are read. The energy is summed over the
+/// wrap-corrected differences between reads, so it does not wrap around as
+/// long as reads are less than a wrap period of the 32-bit counters apart.
+///
+/// @param [in,out] metrics Metric vector.
+/// @param [in] msr_rapl_unit Unique MSR address for MSR_RAPL_POWER_UNIT.
+/// @param [in] msr_pkg_energy_status Unique MSR address for MSR_PKG_ENERGY_STATUS.
+/// @param [in] msr_dram_energy_status Unique MSR address for MSR_DRAM_ENERGY_STATUS.
+void get_total_energy_metrics(
+    struct variorum_metric_vector *metrics,
+    off_t msr_rapl_unit,
+    off_t msr_pkg_energy_status,
+    off_t msr_dram_energy_status
+);
+
+/// @brief Append package and DRAM energy of each socket to a metric vector.
+///
+/// @param [in,out] metrics Metric vector.
+/// @param [in] msr_rapl_unit Unique MSR address for MSR_RAPL_POWER_UNIT.
+/// @param [in] msr_pkg_energy_status Unique MSR address for MSR_PKG_ENERGY_STATUS.
+/// @param [in] msr_dram_energy_status Unique MSR address for MSR_DRAM_ENERGY_STATUS.
+void get_energy_metrics(
+    struct variorum_metric_vector *metrics,
+    off_t msr_rapl_unit,
+    off_t msr_pkg_energy_status,
+    off_t msr_dram_energy_status
+);
+
 #endif
 
 ///* intel_power_features.h */
@@ -9,6 +9,8 @@
 #include <misc_features.h>
 #include <config_architecture.h>
 #include <msr_core.h>
+#include <msr_soa.h>
+#include <variorum_cpuid.h>
 #include <variorum_error.h>
 
 #ifdef LIBJUSTIFY_FOUND
@@ -150,23 +152,37 @@ int get_min_operating_ratio(off_t msr_platform_info, int *val)
     return 0;
 }
 
+/// @brief Get the per-socket values of one of the TURBO_RATIO_LIMIT,
+/// TURBO_RATIO_LIMIT1 and TURBO_RATIO_LIMIT_CORES batches, set up on first
+/// use so the read and write paths share them.
+static uint64_t **turbo_ratio_storage(off_t msr, int batchnum)
+{
+    static uint64_t **val[3] = {NULL, NULL, NULL};
+    unsigned nsockets = 0;
+    int i = batchnum - TURBO_RATIO_LIMIT;
+
+    if (val[i] == NULL)
+    {
+#ifdef VARIORUM_WITH_INTEL_CPU
+        variorum_get_topology(&nsockets, NULL, NULL, P_INTEL_CPU_IDX);
+#endif
+        val[i] = (uint64_t **) malloc(nsockets * sizeof(uint64_t *));
+        allocate_batch(batchnum, nsockets);
+        load_socket_batch(msr, val[i], batchnum);
+    }
+    return val[i];
+}
+
 int get_turbo_ratio_limit(off_t msr_turbo_ratio_limit)
 {
-    static int init = 0;
-    static unsigned nsockets = 0;
-    static uint64_t **val = NULL;
+    unsigned nsockets = 0;
+    uint64_t **val = turbo_ratio_storage(msr_turbo_ratio_limit,
+                                         TURBO_RATIO_LIMIT);
     unsigned ncores, nbits;
 
 #ifdef VARIORUM_WITH_INTEL_CPU
     variorum_get_topology(&nsockets, &ncores, NULL, P_INTEL_CPU_IDX);
 #endif
-    if (!init)
-    {
-        val = (uint64_t **) malloc(nsockets * sizeof(uint64_t *));
-        allocate_batch(TURBO_RATIO_LIMIT, nsockets);
-        load_socket_batch(msr_turbo_ratio_limit, val, TURBO_RATIO_LIMIT);
-        init = 1;
-    }
 
     read_batch(TURBO_RATIO_LIMIT);
 
@@ -210,28 +226,16 @@ int get_turbo_ratio_limit(off_t msr_turbo_ratio_limit)
 int get_turbo_ratio_limits(off_t msr_turbo_ratio_limit,
                            off_t msr_turbo_ratio_limit1)
 {
-    static int init = 0;
-    static unsigned nsockets = 0;
-    static uint64_t **val = NULL;
-    static uint64_t **val2 = NULL;
+    unsigned nsockets = 0;
+    uint64_t **val = turbo_ratio_storage(msr_turbo_ratio_limit,
+                                         TURBO_RATIO_LIMIT);
+    uint64_t **val2 = turbo_ratio_storage(msr_turbo_ratio_limit1,
+                                          TURBO_RATIO_LIMIT1);
     unsigned ncores, nbits;
 
 #ifdef VARIORUM_WITH_INTEL_CPU
     variorum_get_topology(&nsockets, &ncores, NULL, P_INTEL_CPU_IDX);
 #endif
-    if (!init)
-    {
-        val = (uint64_t **) malloc(nsockets * sizeof(uint64_t *));
-        val2 = (uint64_t **) malloc(nsockets * sizeof(uint64_t *));
-        allocate_batch(TURBO_RATIO_LIMIT, nsockets);
-#ifdef LIBJUSTIFY_FOUND
-        cflush();
-#endif
-        allocate_batch(TURBO_RATIO_LIMIT1, nsockets);
-        load_socket_batch(msr_turbo_ratio_limit, val, TURBO_RATIO_LIMIT);
-        load_socket_batch(msr_turbo_ratio_limit1, val2, TURBO_RATIO_LIMIT1);
-        init = 1;
-    }
 
     read_batch(TURBO_RATIO_LIMIT);
     read_batch(TURBO_RATIO_LIMIT1);
@@ -285,25 +289,16 @@ int get_turbo_ratio_limits(off_t msr_turbo_ratio_limit,
 int get_turbo_ratio_limits_skx(off_t msr_turbo_ratio_limit,
                                off_t msr_turbo_ratio_limit_cores)
 {
-    static int init = 0;
-    static unsigned nsockets = 0;
-    static uint64_t **val = NULL;
-    static uint64_t **val2 = NULL;
+    unsigned nsockets = 0;
+    uint64_t **val = turbo_ratio_storage(msr_turbo_ratio_limit,
+                                         TURBO_RATIO_LIMIT);
+    uint64_t **val2 = turbo_ratio_storage(msr_turbo_ratio_limit_cores,
+                                          TURBO_RATIO_LIMIT_CORES);
     unsigned ncores, nbits;
 
 #ifdef VARIORUM_WITH_INTEL_CPU
     variorum_get_topology(&nsockets, &ncores, NULL, P_INTEL_CPU_IDX);
 #endif
-    if (!init)
-    {
-        val = (uint64_t **) malloc(nsockets * sizeof(uint64_t *));
-        val2 = (uint64_t **) malloc(nsockets * sizeof(uint64_t *));
-        allocate_batch(TURBO_RATIO_LIMIT, nsockets);
-        allocate_batch(TURBO_RATIO_LIMIT_CORES, nsockets);
-        load_socket_batch(msr_turbo_ratio_limit, val, TURBO_RATIO_LIMIT);
-        load_socket_batch(msr_turbo_ratio_limit_cores, val2, TURBO_RATIO_LIMIT_CORES);
-        init = 1;
-    }
 
     read_batch(TURBO_RATIO_LIMIT);
     read_batch(TURBO_RATIO_LIMIT_CORES);
@@ -608,6 +603,667 @@ int print_turbo_status(FILE *writedest, off_t msr_misc_enable,
     return ret;
 }
 
+void prefetch_control_merge(unsigned n, const int *disable_bits,
+                            uint64_t *vals)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++)
+    {
+        vals[i] = (vals[i] & ~(uint64_t)PREFETCH_DISABLE_MASK) |
+                  (uint64_t)(disable_bits[i] & PREFETCH_DISABLE_MASK);
+    }
+}
+
+/// @brief Storage for MSR_MISC_FEATURE_CONTROL of every core.
+struct prefetch_data
+{
+    /// @brief Values filled in by the MISC_FEATURE_CTRL batch.
+    uint64_t **bits;
+    /// @brief Contiguous copy of the values.
+    uint64_t *vals;
+    /// @brief Disable bits recorded by each open scope.
+    int *saved[PREFETCH_SCOPE_MAX];
+    /// @brief Number of open scopes.
+    unsigned depth;
+    /// @brief Number of cores.
+    unsigned ncores;
+};
+
+/// @brief Set up the MISC_FEATURE_CTRL batch, one operation per core.
+///
+/// The prefetcher controls are core scoped, so the register is accessed on
+/// the first thread of each core only.
+static struct prefetch_data *prefetch_storage(off_t msr_misc_feature_control)
+{
+    static struct prefetch_data *pd = NULL;
+    unsigned ncores = 0;
+    unsigned i;
+
+    if (pd != NULL)
+    {
+        return pd;
+    }
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(NULL, &ncores, NULL, P_INTEL_CPU_IDX);
+#endif
+    pd = (struct prefetch_data *) calloc(1, sizeof(struct prefetch_data));
+    pd->ncores = ncores;
+    pd->bits = (uint64_t **) calloc(ncores, sizeof(uint64_t *));
+    pd->vals = (uint64_t *) msr_soa_alloc(ncores, sizeof(uint64_t));
+    allocate_batch(MISC_FEATURE_CTRL, ncores);
+    for (i = 0; i < ncores; i++)
+    {
+        create_batch_op(msr_misc_feature_control, i, &pd->bits[i],
+                        MISC_FEATURE_CTRL);
+    }
+    return pd;
+}
+
+int get_prefetch_control(off_t msr_misc_feature_control, int *disable_bits)
+{
+    struct prefetch_data *pd = prefetch_storage(msr_misc_feature_control);
+    unsigned i;
+
+    if (read_batch(MISC_FEATURE_CTRL))
+    {
+        variorum_error_handler("Could not read MSR_MISC_FEATURE_CONTROL",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    for (i = 0; i < pd->ncores; i++)
+    {
+        disable_bits[i] = (int)(*pd->bits[i] & PREFETCH_DISABLE_MASK);
+    }
+    return 0;
+}
+
+int set_prefetch_control(off_t msr_misc_feature_control,
+                         const int *disable_bits)
+{
+    struct prefetch_data *pd = prefetch_storage(msr_misc_feature_control);
+    unsigned i;
+
+    // Read first so the reserved bits are written back unchanged.
+    if (read_batch(MISC_FEATURE_CTRL))
+    {
+        variorum_error_handler("Could not read MSR_MISC_FEATURE_CONTROL",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    msr_soa_gather(pd->ncores, pd->bits, pd->vals);
+    prefetch_control_merge(pd->ncores, disable_bits, pd->vals);
+    for (i = 0; i < pd->ncores; i++)
+    {
+        *pd->bits[i] = pd->vals[i];
+    }
+    if (write_batch(MISC_FEATURE_CTRL))
+    {
+        variorum_error_handler("Could not write MSR_MISC_FEATURE_CONTROL",
+                               VARIORUM_ERROR_MSR_WRITE, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    return 0;
+}
+
+int push_prefetch_control(off_t msr_misc_feature_control,
+                          const int *disable_bits)
+{
+    struct prefetch_data *pd = prefetch_storage(msr_misc_feature_control);
+    int *saved;
+
+    if (pd->depth == PREFETCH_SCOPE_MAX)
+    {
+        variorum_error_handler("Too many nested prefetcher scopes",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    if (pd->saved[pd->depth] == NULL)
+    {
+        pd->saved[pd->depth] = (int *) malloc(pd->ncores * sizeof(int));
+    }
+    saved = pd->saved[pd->depth];
+    if (get_prefetch_control(msr_misc_feature_control, saved) ||
+        set_prefetch_control(msr_misc_feature_control, disable_bits))
+    {
+        return -1;
+    }
+    pd->depth++;
+    return 0;
+}
+
+int pop_prefetch_control(off_t msr_misc_feature_control)
+{
+    struct prefetch_data *pd = prefetch_storage(msr_misc_feature_control);
+
+    if (pd->depth == 0)
+    {
+        variorum_error_handler("No prefetcher scope to restore",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    pd->depth--;
+    return set_prefetch_control(msr_misc_feature_control,
+                                pd->saved[pd->depth]);
+}
+
+int turbo_ratio_limit_merge(int nbuckets, const int *bucket_cores,
+                            const int *bucket_freq_mhz, uint64_t *limit,
+                            uint64_t *limit1, uint64_t *limit_cores)
+{
+    uint64_t ratio[TURBO_RATIO_BUCKET_MAX];
+    uint64_t cores[TURBO_RATIO_BUCKET_MAX];
+    int max = TURBO_RATIO_BUCKETS;
+    int prev = -1;
+    int i;
+
+    if (limit_cores == NULL && limit1 != NULL)
+    {
+        max = TURBO_RATIO_BUCKET_MAX;
+    }
+    if (nbuckets < 1 || nbuckets > max)
+    {
+        return -1;
+    }
+    for (i = 0; i < max; i++)
+    {
+        uint64_t reg = i < TURBO_RATIO_BUCKETS ? *limit : *limit1;
+        int shift = 8 * (i % TURBO_RATIO_BUCKETS);
+
+        ratio[i] = (reg >> shift) & 0xFF;
+        cores[i] = limit_cores != NULL ? (*limit_cores >> shift) & 0xFF :
+                   (uint64_t)(i + 1);
+    }
+    for (i = 0; i < nbuckets; i++)
+    {
+        if (bucket_freq_mhz[i] < 100 || bucket_freq_mhz[i] > 25500 ||
+            bucket_freq_mhz[i] % 100 != 0)
+        {
+            return -1;
+        }
+        ratio[i] = (uint64_t)(bucket_freq_mhz[i] / 100);
+        if (bucket_cores != NULL)
+        {
+            if (bucket_cores[i] < 1 || bucket_cores[i] > 255 ||
+                (limit_cores == NULL && bucket_cores[i] != i + 1))
+            {
+                return -1;
+            }
+            cores[i] = (uint64_t)bucket_cores[i];
+        }
+    }
+
+    /* Unused buckets read as 0 and are skipped. Among the others, more
+     * active cores may only lower the limit.
+     */
+    for (i = 0; i < max; i++)
+    {
+        if (ratio[i] == 0 || cores[i] == 0)
+        {
+            continue;
+        }
+        if (prev >= 0 && (cores[i] <= cores[prev] || ratio[i] > ratio[prev]))
+        {
+            return -1;
+        }
+        prev = i;
+    }
+
+    *limit = 0;
+    for (i = 0; i < TURBO_RATIO_BUCKETS; i++)
+    {
+        *limit |= ratio[i] << (8 * i);
+    }
+    if (max == TURBO_RATIO_BUCKET_MAX)
+    {
+        *limit1 = 0;
+        for (i = 0; i < TURBO_RATIO_BUCKETS; i++)
+        {
+            *limit1 |= ratio[TURBO_RATIO_BUCKETS + i] << (8 * i);
+        }
+    }
+    if (limit_cores != NULL)
+    {
+        *limit_cores = 0;
+        for (i = 0; i < TURBO_RATIO_BUCKETS; i++)
+        {
+            *limit_cores |= cores[i] << (8 * i);
+        }
+    }
+    return 0;
+}
+
+int set_turbo_ratio_limits(off_t msr_platform_info,
+                           off_t msr_turbo_ratio_limit,
+                           off_t msr_turbo_ratio_limit1,
+                           off_t msr_turbo_ratio_limit_cores, int nbuckets,
+                           const int *bucket_cores, const int *bucket_freq_mhz)
+{
+    unsigned nsockets = 0;
+    unsigned socket;
+    uint64_t platform_info = 0;
+    uint64_t **val = turbo_ratio_storage(msr_turbo_ratio_limit,
+                                         TURBO_RATIO_LIMIT);
+    uint64_t **val2 = NULL;
+    uint64_t *want = NULL;
+    int batch2 = -1;
+    int ret = 0;
+    char msg[128];
+
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(&nsockets, NULL, NULL, P_INTEL_CPU_IDX);
+#endif
+    /* PLATFORM_INFO[28] is set when the turbo ratio limits are writable. */
+    if (read_msr_by_coord(0, 0, 0, msr_platform_info, &platform_info))
+    {
+        variorum_error_handler("Could not read MSR_PLATFORM_INFO",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    if (!MASK_VAL(platform_info, 28, 28))
+    {
+        variorum_error_handler("Turbo ratio limits are not programmable",
+                               VARIORUM_ERROR_FEATURE_NOT_AVAILABLE,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+
+    if (msr_turbo_ratio_limit_cores != 0)
+    {
+        batch2 = TURBO_RATIO_LIMIT_CORES;
+        val2 = turbo_ratio_storage(msr_turbo_ratio_limit_cores, batch2);
+    }
+    else if (msr_turbo_ratio_limit1 != 0)
+    {
+        batch2 = TURBO_RATIO_LIMIT1;
+        val2 = turbo_ratio_storage(msr_turbo_ratio_limit1, batch2);
+    }
+    if (read_batch(TURBO_RATIO_LIMIT) || (batch2 >= 0 && read_batch(batch2)))
+    {
+        variorum_error_handler("Batch read error", VARIORUM_ERROR_MSR_BATCH,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+        return -1;
+    }
+
+    want = (uint64_t *) calloc(2 * nsockets, sizeof(uint64_t));
+    for (socket = 0; socket < nsockets; socket++)
+    {
+        uint64_t *w = &want[2 * socket];
+
+        w[0] = *val[socket];
+        w[1] = val2 != NULL ? *val2[socket] : 0;
+        if (turbo_ratio_limit_merge(nbuckets, bucket_cores, bucket_freq_mhz,
+                                    &w[0],
+                                    batch2 == TURBO_RATIO_LIMIT1 ? &w[1] : NULL,
+                                    batch2 == TURBO_RATIO_LIMIT_CORES ? &w[1] : NULL))
+        {
+            variorum_error_handler("Invalid turbo ratio limit buckets",
+                                   VARIORUM_ERROR_INVAL, getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            free(want);
+            return -1;
+        }
+        *val[socket] = w[0];
+        if (val2 != NULL)
+        {
+            *val2[socket] = w[1];
+        }
+    }
+
+    /* On models with programmable core counts, write the counts first so
+     * the limits never apply to a stale bucket.
+     */
+    if ((batch2 == TURBO_RATIO_LIMIT_CORES && write_batch(batch2)) ||
+        write_batch(TURBO_RATIO_LIMIT) ||
+        (batch2 == TURBO_RATIO_LIMIT1 && write_batch(batch2)))
+    {
+        variorum_error_handler("Could not write turbo ratio limits",
+                               VARIORUM_ERROR_MSR_WRITE, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        free(want);
+        return -1;
+    }
+
+    if (read_batch(TURBO_RATIO_LIMIT) || (batch2 >= 0 && read_batch(batch2)))
+    {
+        variorum_error_handler("Batch read error", VARIORUM_ERROR_MSR_BATCH,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+        free(want);
+        return -1;
+    }
+    for (socket = 0; socket < nsockets; socket++)
+    {
+        if (*val[socket] != want[2 * socket] ||
+            (val2 != NULL && *val2[socket] != want[2 * socket + 1]))
+        {
+            snprintf(msg, sizeof(msg),
+                     "Turbo ratio limits did not take effect on socket %u", socket);
+            variorum_error_handler(msg, VARIORUM_ERROR_MSR_WRITE,
+                                   getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+            ret = -1;
+        }
+    }
+    free(want);
+    return ret;
+}
+
+/// @brief Set up the ENERGY_PERF_BIAS batch, one operation per hardware
+/// thread.
+///
+/// The hint is core scoped, but is written on every thread so that the value
+/// does not depend on which sibling the kernel last wrote.
+static uint64_t **energy_perf_bias_storage(off_t msr_energy_perf_bias)
+{
+    static uint64_t **val = NULL;
+    unsigned nthreads = 0;
+
+    if (val == NULL)
+    {
+#ifdef VARIORUM_WITH_INTEL_CPU
+        variorum_get_topology(NULL, NULL, &nthreads, P_INTEL_CPU_IDX);
+#endif
+        val = (uint64_t **) calloc(nthreads, sizeof(uint64_t *));
+        allocate_batch(ENERGY_PERF_BIAS, nthreads);
+        load_thread_batch(msr_energy_perf_bias, val, ENERGY_PERF_BIAS);
+    }
+    return val;
+}
+
+int get_energy_perf_bias(off_t msr_energy_perf_bias, int *epb)
+{
+    uint64_t **val = energy_perf_bias_storage(msr_energy_perf_bias);
+    unsigned ncores = 0;
+    unsigned i;
+
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(NULL, &ncores, NULL, P_INTEL_CPU_IDX);
+#endif
+    if (read_batch(ENERGY_PERF_BIAS))
+    {
+        variorum_error_handler("Could not read IA32_ENERGY_PERF_BIAS",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    /* Thread i of the batch is the first thread of core i. */
+    for (i = 0; i < ncores; i++)
+    {
+        epb[i] = (int)(*val[i] & ENERGY_PERF_BIAS_MASK);
+    }
+    return 0;
+}
+
+int set_energy_perf_bias(off_t msr_energy_perf_bias, const int *epb)
+{
+    uint64_t **val = energy_perf_bias_storage(msr_energy_perf_bias);
+    unsigned ncores = 0;
+    unsigned nthreads = 0;
+    unsigned i;
+    int ret = 0;
+    char msg[128];
+
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(NULL, &ncores, &nthreads, P_INTEL_CPU_IDX);
+#endif
+    for (i = 0; i < ncores; i++)
+    {
+        if (epb[i] < 0 || epb[i] > ENERGY_PERF_BIAS_MASK)
+        {
+            snprintf(msg, sizeof(msg),
+                     "Energy performance bias %d of core %u is not in 0-15", epb[i], i);
+            variorum_error_handler(msg, VARIORUM_ERROR_INVAL, getenv("HOSTNAME"),
+                                   __FILE__, __FUNCTION__, __LINE__);
+            return -1;
+        }
+    }
+
+    // Read first so the reserved bits are written back unchanged.
+    if (read_batch(ENERGY_PERF_BIAS))
+    {
+        variorum_error_handler("Could not read IA32_ENERGY_PERF_BIAS",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    for (i = 0; i < nthreads; i++)
+    {
+        *val[i] = (*val[i] & ~(uint64_t)ENERGY_PERF_BIAS_MASK) |
+                  (uint64_t)epb[i % ncores];
+    }
+    if (write_batch(ENERGY_PERF_BIAS))
+    {
+        variorum_error_handler("Could not write IA32_ENERGY_PERF_BIAS",
+                               VARIORUM_ERROR_MSR_WRITE, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+
+    if (read_batch(ENERGY_PERF_BIAS))
+    {
+        variorum_error_handler("Could not read IA32_ENERGY_PERF_BIAS",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    for (i = 0; i < nthreads; i++)
+    {
+        if ((int)(*val[i] & ENERGY_PERF_BIAS_MASK) != epb[i % ncores])
+        {
+            snprintf(msg, sizeof(msg),
+                     "Energy performance bias did not take effect on thread %u", i);
+            variorum_error_handler(msg, VARIORUM_ERROR_MSR_WRITE,
+                                   getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+unsigned turbo_core_merge(unsigned nthreads, unsigned ncores,
+                          const int *core_mask, int enable, uint64_t *vals,
+                          unsigned *changed)
+{
+    unsigned n = 0;
+    unsigned t;
+
+    for (t = 0; t < nthreads; t++)
+    {
+        uint64_t want;
+
+        if (!core_mask[t % ncores])
+        {
+            continue;
+        }
+        want = enable ? vals[t] & ~PERF_CTL_TURBO_DISENGAGE :
+               vals[t] | PERF_CTL_TURBO_DISENGAGE;
+        if (want != vals[t])
+        {
+            vals[t] = want;
+            changed[n++] = t;
+        }
+    }
+    return n;
+}
+
+/// @brief Storage for IA32_PERF_CTL of every hardware thread.
+struct turbo_core_data
+{
+    /// @brief Values filled in by the TURBO_CORE_CTL batch.
+    uint64_t **bits;
+    /// @brief Contiguous copy of the values.
+    uint64_t *vals;
+    /// @brief Hardware threads written by the last change.
+    unsigned *changed;
+    /// @brief Number of hardware threads.
+    unsigned nthreads;
+    /// @brief Number of cores.
+    unsigned ncores;
+};
+
+/// @brief Set up the TURBO_CORE_CTL batch, one operation per hardware
+/// thread, and room for the same number of operations in TURBO_CORE_WRITE.
+static struct turbo_core_data *turbo_core_storage(off_t ia32_perf_ctl)
+{
+    static struct turbo_core_data *td = NULL;
+    unsigned ncores = 0;
+    unsigned nthreads = 0;
+
+    if (td != NULL)
+    {
+        return td;
+    }
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(NULL, &ncores, &nthreads, P_INTEL_CPU_IDX);
+#endif
+    td = (struct turbo_core_data *) calloc(1, sizeof(struct turbo_core_data));
+    td->ncores = ncores;
+    td->nthreads = nthreads;
+    td->bits = (uint64_t **) calloc(nthreads, sizeof(uint64_t *));
+    td->vals = (uint64_t *) msr_soa_alloc(nthreads, sizeof(uint64_t));
+    td->changed = (unsigned *) malloc(nthreads * sizeof(unsigned));
+    allocate_batch(TURBO_CORE_CTL, nthreads);
+    load_thread_batch(ia32_perf_ctl, td->bits, TURBO_CORE_CTL);
+    allocate_batch(TURBO_CORE_WRITE, nthreads);
+    return td;
+}
+
+int get_turbo_cores(off_t ia32_perf_ctl, int *enabled)
+{
+    struct turbo_core_data *td = turbo_core_storage(ia32_perf_ctl);
+    unsigned i;
+
+    if (read_batch(TURBO_CORE_CTL))
+    {
+        variorum_error_handler("Could not read IA32_PERF_CTL",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    for (i = 0; i < td->ncores; i++)
+    {
+        enabled[i] = 1;
+    }
+    for (i = 0; i < td->nthreads; i++)
+    {
+        if (*td->bits[i] & PERF_CTL_TURBO_DISENGAGE)
+        {
+            enabled[i % td->ncores] = 0;
+        }
+    }
+    return 0;
+}
+
+int hwp_enabled(off_t ia32_pm_enable)
+{
+    /* See Manual Vol 3B, Section 14.4.1 for details. */
+    uint64_t rax, rbx, rcx, rdx;
+    uint64_t pm_enable = 0;
+    int leaf = 6; // 06
+
+    cpuid(leaf, &rax, &rbx, &rcx, &rdx);
+    // CPUID.06H:rax[7] is set when IA32_PM_ENABLE is implemented.
+    if (!MASK_VAL(rax, 7, 7))
+    {
+        return 0;
+    }
+    if (read_msr_by_coord(0, 0, 0, ia32_pm_enable, &pm_enable))
+    {
+        variorum_error_handler("Could not read IA32_PM_ENABLE",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    // Once set, HWP stays enabled until reset.
+    return (int)MASK_VAL(pm_enable, 0, 0);
+}
+
+int set_turbo_cores(off_t ia32_perf_ctl, off_t ia32_pm_enable,
+                    const int *core_mask, int enable)
+{
+    struct turbo_core_data *td = turbo_core_storage(ia32_perf_ctl);
+    uint64_t *dest;
+    unsigned n;
+    unsigned i;
+    int hwp;
+    int ret = 0;
+    char msg[128];
+
+    /* With HWP, the processor selects its frequency from IA32_HWP_REQUEST
+     * and ignores IA32_PERF_CTL, so the bit would be written without effect.
+     */
+    hwp = hwp_enabled(ia32_pm_enable);
+    if (hwp < 0)
+    {
+        return -1;
+    }
+    if (hwp)
+    {
+        variorum_error_handler("Turbo cannot be disengaged per core with HWP enabled",
+                               VARIORUM_ERROR_FEATURE_NOT_AVAILABLE,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+        return VARIORUM_ERROR_FEATURE_NOT_AVAILABLE;
+    }
+
+    if (read_batch(TURBO_CORE_CTL))
+    {
+        variorum_error_handler("Could not read IA32_PERF_CTL",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    msr_soa_gather(td->nthreads, td->bits, td->vals);
+    n = turbo_core_merge(td->nthreads, td->ncores, core_mask, enable, td->vals,
+                         td->changed);
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    /* Only the threads that change are written, so the requested frequency
+     * of every other thread is not rewritten from a stale read.
+     */
+    reset_batch(TURBO_CORE_WRITE);
+    for (i = 0; i < n; i++)
+    {
+        create_batch_op(ia32_perf_ctl, td->changed[i], &dest, TURBO_CORE_WRITE);
+        *dest = td->vals[td->changed[i]];
+    }
+    if (write_batch(TURBO_CORE_WRITE))
+    {
+        variorum_error_handler("Could not write IA32_PERF_CTL",
+                               VARIORUM_ERROR_MSR_WRITE, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+
+    if (read_batch(TURBO_CORE_CTL))
+    {
+        variorum_error_handler("Could not read IA32_PERF_CTL",
+                               VARIORUM_ERROR_MSR_READ, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        if ((*td->bits[td->changed[i]] & PERF_CTL_TURBO_DISENGAGE) !=
+            (td->vals[td->changed[i]] & PERF_CTL_TURBO_DISENGAGE))
+        {
+            snprintf(msg, sizeof(msg),
+                     "Turbo disengage did not take effect on thread %u", td->changed[i]);
+            variorum_error_handler(msg, VARIORUM_ERROR_MSR_WRITE,
+                                   getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
 ///// For core level
 //int set_turbo_on_core(const unsigned socket, const unsigned core, off_t msr_misc_enable, unsigned int turbo_mode_disable_bit)
 //{
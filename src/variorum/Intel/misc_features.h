@@ -6,7 +6,9 @@
 #ifndef MISC_FEATURES_H_INCLUDE
 #define MISC_FEATURES_H_INCLUDE
 
+#include <stdint.h>
 #include <stdio.h>
+#include <sys/types.h>
 
 /// @brief Read the maximum non-turbo ratio, which is the ratio of the
 /// frequency that invariant TSC runs at.
@@ -75,6 +77,257 @@ int print_turbo_status(FILE *writedest,
                        off_t msr_misc_enable,
                        unsigned int turbo_mode_disable_bit);
 
+/// @brief Bit of MSR_MISC_FEATURE_CONTROL that disables the L2 hardware
+/// prefetcher (streamer).
+#define PREFETCH_L2_STREAMER_DISABLE 0x1
+/// @brief Bit that disables the L2 adjacent cache line prefetcher.
+#define PREFETCH_L2_ADJACENT_DISABLE 0x2
+/// @brief Bit that disables the DCU (L1 data) streaming prefetcher.
+#define PREFETCH_DCU_DISABLE 0x4
+/// @brief Bit that disables the DCU IP (L1 data stride) prefetcher.
+#define PREFETCH_DCU_IP_DISABLE 0x8
+/// @brief All prefetcher disable bits.
+#define PREFETCH_DISABLE_MASK 0xF
+
+/// @brief Maximum nesting depth of push_prefetch_control().
+#define PREFETCH_SCOPE_MAX 8
+
+/// @brief Merge prefetcher disable bits into register values, leaving the
+/// other bits untouched.
+///
+/// @param [in] n Number of cores.
+/// @param [in] disable_bits Disable bits of each core, a combination of the
+///             PREFETCH_*_DISABLE bits.
+/// @param [in,out] vals Register value of each core.
+void prefetch_control_merge(
+    unsigned n,
+    const int *disable_bits,
+    uint64_t *vals
+);
+
+/// @brief Read the prefetcher disable bits of every core with one batch.
+///
+/// @param [in] msr_misc_feature_control Unique MSR address for
+///             MSR_MISC_FEATURE_CONTROL.
+/// @param [out] disable_bits Disable bits of each core, one entry per core.
+///
+/// @return 0 if successful, else -1.
+int get_prefetch_control(
+    off_t msr_misc_feature_control,
+    int *disable_bits
+);
+
+/// @brief Set the prefetcher disable bits of every core with one batch.
+///
+/// @param [in] msr_misc_feature_control Unique MSR address for
+///             MSR_MISC_FEATURE_CONTROL.
+/// @param [in] disable_bits Disable bits of each core, one entry per core.
+///
+/// @return 0 if successful, else -1.
+int set_prefetch_control(
+    off_t msr_misc_feature_control,
+    const int *disable_bits
+);
+
+/// @brief Record the prefetcher disable bits of every core, then set new
+/// ones.
+///
+/// @param [in] msr_misc_feature_control Unique MSR address for
+///             MSR_MISC_FEATURE_CONTROL.
+/// @param [in] disable_bits Disable bits of each core, one entry per core.
+///
+/// @return 0 if successful, else -1 if the values cannot be read or set, or
+/// if PREFETCH_SCOPE_MAX scopes are already open.
+int push_prefetch_control(
+    off_t msr_misc_feature_control,
+    const int *disable_bits
+);
+
+/// @brief Restore the prefetcher disable bits recorded by the matching
+/// push_prefetch_control().
+///
+/// @param [in] msr_misc_feature_control Unique MSR address for
+///             MSR_MISC_FEATURE_CONTROL.
+///
+/// @return 0 if successful, else -1 if no scope is open or the values cannot
+/// be written.
+int pop_prefetch_control(
+    off_t msr_misc_feature_control
+);
+
+/// @brief Number of buckets in MSR_TURBO_RATIO_LIMIT and
+/// MSR_TURBO_RATIO_LIMIT_CORES.
+#define TURBO_RATIO_BUCKETS 8
+
+/// @brief Number of buckets in MSR_TURBO_RATIO_LIMIT and
+/// MSR_TURBO_RATIO_LIMIT1 together.
+#define TURBO_RATIO_BUCKET_MAX 16
+
+/// @brief Merge turbo ratio limit buckets into register values.
+///
+/// Bucket i applies when at most bucket_cores[i] cores are active. On models
+/// with MSR_TURBO_RATIO_LIMIT_CORES the core count of each bucket is
+/// programmable, otherwise bucket i is fixed at i + 1 cores. Buckets past
+/// nbuckets are left unchanged. The merged table must have core counts that
+/// increase and ratios that do not increase from one bucket to the next, or
+/// nothing is changed.
+///
+/// @param [in] nbuckets Number of buckets to set.
+/// @param [in] bucket_cores Active core count of each bucket, may be NULL to
+///             keep the current counts.
+/// @param [in] bucket_freq_mhz Turbo limit of each bucket in MHz, a multiple
+///             of 100.
+/// @param [in,out] limit Value of MSR_TURBO_RATIO_LIMIT.
+/// @param [in,out] limit1 Value of MSR_TURBO_RATIO_LIMIT1, NULL if the model
+///             does not have it.
+/// @param [in,out] limit_cores Value of MSR_TURBO_RATIO_LIMIT_CORES, NULL if
+///             the model does not have it.
+///
+/// @return 0 if successful, else -1 if the buckets are invalid.
+int turbo_ratio_limit_merge(
+    int nbuckets,
+    const int *bucket_cores,
+    const int *bucket_freq_mhz,
+    uint64_t *limit,
+    uint64_t *limit1,
+    uint64_t *limit_cores
+);
+
+/// @brief Set turbo ratio limit buckets on all sockets and verify them.
+///
+/// The registers of all sockets are read and written with one batch each,
+/// then read back to check that the new limits took effect.
+///
+/// @param [in] msr_platform_info Unique MSR address for MSR_PLATFORM_INFO.
+/// @param [in] msr_turbo_ratio_limit Unique MSR address for
+///             MSR_TURBO_RATIO_LIMIT.
+/// @param [in] msr_turbo_ratio_limit1 Unique MSR address for
+///             MSR_TURBO_RATIO_LIMIT1, 0 if the model does not have it.
+/// @param [in] msr_turbo_ratio_limit_cores Unique MSR address for
+///             MSR_TURBO_RATIO_LIMIT_CORES, 0 if the model does not have it.
+/// @param [in] nbuckets Number of buckets to set.
+/// @param [in] bucket_cores Active core count of each bucket, may be NULL.
+/// @param [in] bucket_freq_mhz Turbo limit of each bucket in MHz.
+///
+/// @return 0 if successful, else -1 if the limits are not programmable, the
+/// buckets are invalid, or the values read back differ.
+int set_turbo_ratio_limits(
+    off_t msr_platform_info,
+    off_t msr_turbo_ratio_limit,
+    off_t msr_turbo_ratio_limit1,
+    off_t msr_turbo_ratio_limit_cores,
+    int nbuckets,
+    const int *bucket_cores,
+    const int *bucket_freq_mhz
+);
+
+/// @brief Mask of the energy performance bias hint in IA32_ENERGY_PERF_BIAS.
+#define ENERGY_PERF_BIAS_MASK 0xF
+
+/// @brief Read the energy performance bias hint of every core with one
+/// batch.
+///
+/// @param [in] msr_energy_perf_bias Unique MSR address for
+///             IA32_ENERGY_PERF_BIAS.
+/// @param [out] epb Hint of each core, one entry per core.
+///
+/// @return 0 if successful, else -1.
+int get_energy_perf_bias(
+    off_t msr_energy_perf_bias,
+    int *epb
+);
+
+/// @brief Set the energy performance bias hint of every core and verify it.
+///
+/// The register is written on all hardware threads of a core with one batch,
+/// then read back to check that the new hints took effect.
+///
+/// @param [in] msr_energy_perf_bias Unique MSR address for
+///             IA32_ENERGY_PERF_BIAS.
+/// @param [in] epb Hint of each core from 0 (performance) to 15 (energy
+///             saving), one entry per core.
+///
+/// @return 0 if successful, else -1 if a hint is out of range or the values
+/// read back differ.
+int set_energy_perf_bias(
+    off_t msr_energy_perf_bias,
+    const int *epb
+);
+
+/// @brief IDA/turbo disengage bit of IA32_PERF_CTL.
+#define PERF_CTL_TURBO_DISENGAGE (1ULL << 32)
+
+/// @brief Set or clear the turbo disengage bit of the hardware threads of
+/// selected cores.
+///
+/// Hardware thread t belongs to core t % ncores.
+///
+/// @param [in] nthreads Number of hardware threads.
+/// @param [in] ncores Number of cores.
+/// @param [in] core_mask Non-zero for each core to change, one entry per
+///             core.
+/// @param [in] enable Non-zero to allow turbo, 0 to disengage it.
+/// @param [in,out] vals IA32_PERF_CTL of each hardware thread.
+/// @param [out] changed Indices of the hardware threads whose value changed,
+///              up to nthreads entries.
+///
+/// @return Number of hardware threads whose value changed.
+unsigned turbo_core_merge(
+    unsigned nthreads,
+    unsigned ncores,
+    const int *core_mask,
+    int enable,
+    uint64_t *vals,
+    unsigned *changed
+);
+
+/// @brief Report whether turbo is allowed on every core, with one batch.
+///
+/// @param [in] ia32_perf_ctl Unique MSR address for IA32_PERF_CTL.
+/// @param [out] enabled 1 if no hardware thread of the core has turbo
+///              disengaged, else 0, one entry per core.
+///
+/// @return 0 if successful, else -1.
+int get_turbo_cores(
+    off_t ia32_perf_ctl,
+    int *enabled
+);
+
+/// @brief Report whether hardware-controlled performance states (HWP) are
+/// enabled, in which case IA32_PERF_CTL is ignored.
+///
+/// @param [in] ia32_pm_enable Unique MSR address for IA32_PM_ENABLE, only
+///             read if CPUID reports HWP.
+///
+/// @return 1 if HWP is enabled, 0 if not, else -1 if IA32_PM_ENABLE cannot
+/// be read.
+int hwp_enabled(
+    off_t ia32_pm_enable
+);
+
+/// @brief Allow or disengage turbo on selected cores through the turbo
+/// disengage bit of IA32_PERF_CTL.
+///
+/// The current values are read with one batch, and only hardware threads
+/// whose bit changes are written, with one batch, then read back. The
+/// requested frequency in the register is left unchanged. Nothing is
+/// printed.
+///
+/// @param [in] ia32_perf_ctl Unique MSR address for IA32_PERF_CTL.
+/// @param [in] ia32_pm_enable Unique MSR address for IA32_PM_ENABLE.
+/// @param [in] core_mask Non-zero for each core to change, one entry per
+///             core.
+/// @param [in] enable Non-zero to allow turbo, 0 to disengage it.
+///
+/// @return 0 if successful, VARIORUM_ERROR_FEATURE_NOT_AVAILABLE if HWP is
+/// enabled, else -1, also if a written bit did not stick.
+int set_turbo_cores(
+    off_t ia32_perf_ctl,
+    off_t ia32_pm_enable,
+    const int *core_mask,
+    int enable
+);
+
 ///// These per core functions seemingly only for Intel Signatures 06_57H (KNL) and
 ///// 06_85H (future Xeon Phi), at the moment.
 ///// Intel Vol. 4 2-287 Documentation
@@ -0,0 +1,335 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <perf_rapl_features.h>
+#include <variorum_error.h>
+
+static const char *perf_rapl_event_names[PERF_RAPL_NUM_DOMAINS] =
+{
+    "energy-pkg",
+    "energy-ram",
+    "energy-psys"
+};
+
+int perf_sysfs_read_line(const char *path, char *buf, size_t size)
+{
+    FILE *fp = fopen(path, "r");
+    size_t len;
+
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    if (fgets(buf, size, fp) == NULL)
+    {
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+    len = strlen(buf);
+    if (len > 0 && buf[len - 1] == '\n')
+    {
+        buf[len - 1] = '\0';
+    }
+    return 0;
+}
+
+unsigned perf_sysfs_parse_cpumask(const char *mask, int **cpus)
+{
+    const char *p = mask;
+    unsigned count = 0;
+    unsigned cap = 8;
+    char *end;
+    long first, last, c;
+    int *grown;
+
+    *cpus = (int *) malloc(cap * sizeof(int));
+    if (*cpus == NULL)
+    {
+        return 0;
+    }
+    while (*p != '\0')
+    {
+        first = strtol(p, &end, 10);
+        if (end == p)
+        {
+            break;
+        }
+        last = first;
+        p = end;
+        if (*p == '-')
+        {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (c = first; c <= last; c++)
+        {
+            if (count == cap)
+            {
+                cap *= 2;
+                grown = (int *) realloc(*cpus, cap * sizeof(int));
+                if (grown == NULL)
+                {
+                    free(*cpus);
+                    *cpus = NULL;
+                    return 0;
+                }
+                *cpus = grown;
+            }
+            (*cpus)[count++] = (int)c;
+        }
+        if (*p == ',')
+        {
+            p++;
+        }
+    }
+    return count;
+}
+
+static long perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu,
+                            int group_fd, unsigned long flags)
+{
+    return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+int perf_rapl_parse_pmu(const char *root, struct perf_rapl_data *data)
+{
+    char path[1024];
+    char buf[256];
+    char *term;
+    int d;
+
+    memset(data, 0, sizeof(struct perf_rapl_data));
+
+    snprintf(path, sizeof(path), "%s/type", root);
+    if (perf_sysfs_read_line(path, buf, sizeof(buf)))
+    {
+        return -1;
+    }
+    data->pmu_type = atoi(buf);
+
+    for (d = 0; d < PERF_RAPL_NUM_DOMAINS; d++)
+    {
+        data->events[d].slot = -1;
+        snprintf(path, sizeof(path), "%s/events/%s", root, perf_rapl_event_names[d]);
+        if (perf_sysfs_read_line(path, buf, sizeof(buf)))
+        {
+            continue;
+        }
+        term = strstr(buf, "event=");
+        if (term == NULL)
+        {
+            continue;
+        }
+        data->events[d].config = strtoull(term + strlen("event="), NULL, 0);
+
+        snprintf(path, sizeof(path), "%s/events/%s.scale", root,
+                 perf_rapl_event_names[d]);
+        if (perf_sysfs_read_line(path, buf, sizeof(buf)))
+        {
+            continue;
+        }
+        data->events[d].scale = strtod(buf, NULL);
+
+        snprintf(path, sizeof(path), "%s/events/%s.unit", root,
+                 perf_rapl_event_names[d]);
+        if (perf_sysfs_read_line(path, data->events[d].unit,
+                            sizeof(data->events[d].unit)))
+        {
+            strcpy(data->events[d].unit, "Joules");
+        }
+        data->events[d].present = 1;
+    }
+
+    /* The package domain is the minimum required to replace RAPL_DATA. */
+    if (!data->events[PERF_RAPL_PKG].present)
+    {
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), "%s/cpumask", root);
+    if (perf_sysfs_read_line(path, buf, sizeof(buf)))
+    {
+        return -1;
+    }
+    data->nsockets = perf_sysfs_parse_cpumask(buf, &data->cpu);
+    if (data->nsockets == 0)
+    {
+        free(data->cpu);
+        data->cpu = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int perf_rapl_open(struct perf_rapl_data *data)
+{
+    struct perf_event_attr attr;
+    unsigned i;
+    int d;
+    int slot = 0;
+    int leader;
+    int idx;
+
+    data->fd = (int *) malloc(data->nsockets * PERF_RAPL_NUM_DOMAINS * sizeof(
+                                  int));
+    data->counts = (uint64_t *) calloc(data->nsockets * PERF_RAPL_NUM_DOMAINS,
+                                       sizeof(uint64_t));
+    data->joules = (double *) calloc(data->nsockets * PERF_RAPL_NUM_DOMAINS,
+                                     sizeof(double));
+    if (data->fd == NULL || data->counts == NULL || data->joules == NULL)
+    {
+        free(data->fd);
+        data->fd = NULL;
+        perf_rapl_close(data);
+        return -1;
+    }
+    for (i = 0; i < data->nsockets * PERF_RAPL_NUM_DOMAINS; i++)
+    {
+        data->fd[i] = -1;
+    }
+
+    /* Group slots are identical on every socket. */
+    for (d = 0; d < PERF_RAPL_NUM_DOMAINS; d++)
+    {
+        if (data->events[d].present)
+        {
+            data->events[d].slot = slot++;
+        }
+    }
+
+    for (i = 0; i < data->nsockets; i++)
+    {
+        leader = -1;
+        for (d = 0; d < PERF_RAPL_NUM_DOMAINS; d++)
+        {
+            if (!data->events[d].present)
+            {
+                continue;
+            }
+            idx = i * PERF_RAPL_NUM_DOMAINS + d;
+            memset(&attr, 0, sizeof(struct perf_event_attr));
+            attr.size = sizeof(struct perf_event_attr);
+            attr.type = data->pmu_type;
+            attr.config = data->events[d].config;
+            attr.read_format = PERF_FORMAT_GROUP;
+            data->fd[idx] = perf_event_open(&attr, -1, data->cpu[i], leader, 0);
+            if (data->fd[idx] < 0)
+            {
+                perf_rapl_close(data);
+                return -1;
+            }
+            if (leader == -1)
+            {
+                leader = data->fd[idx];
+            }
+        }
+    }
+    return 0;
+}
+
+int perf_rapl_read(struct perf_rapl_data *data)
+{
+    /* PERF_FORMAT_GROUP layout: nr, then one value per group member. */
+    uint64_t buf[1 + PERF_RAPL_NUM_DOMAINS];
+    unsigned i;
+    int d;
+    int idx;
+    int leader;
+    ssize_t len;
+
+    for (i = 0; i < data->nsockets; i++)
+    {
+        /* The first available domain leads the group. */
+        leader = -1;
+        for (d = 0; d < PERF_RAPL_NUM_DOMAINS && leader < 0; d++)
+        {
+            leader = data->fd[i * PERF_RAPL_NUM_DOMAINS + d];
+        }
+        len = read(leader, buf, sizeof(buf));
+        if (len < (ssize_t) sizeof(uint64_t))
+        {
+            return -1;
+        }
+        for (d = 0; d < PERF_RAPL_NUM_DOMAINS; d++)
+        {
+            if (data->events[d].slot < 0 || (uint64_t)data->events[d].slot >= buf[0])
+            {
+                continue;
+            }
+            idx = i * PERF_RAPL_NUM_DOMAINS + d;
+            data->counts[idx] = buf[1 + data->events[d].slot];
+            data->joules[idx] = (double)data->counts[idx] * data->events[d].scale;
+        }
+    }
+    return 0;
+}
+
+void perf_rapl_close(struct perf_rapl_data *data)
+{
+    unsigned i;
+
+    if (data->fd != NULL)
+    {
+        /* Close members before leaders. */
+        for (i = data->nsockets * PERF_RAPL_NUM_DOMAINS; i > 0; i--)
+        {
+            if (data->fd[i - 1] >= 0)
+            {
+                close(data->fd[i - 1]);
+            }
+        }
+    }
+    free(data->fd);
+    free(data->counts);
+    free(data->joules);
+    free(data->cpu);
+    data->fd = NULL;
+    data->counts = NULL;
+    data->joules = NULL;
+    data->cpu = NULL;
+    data->nsockets = 0;
+}
+
+int perf_rapl_enabled(struct perf_rapl_data **data)
+{
+    static struct perf_rapl_data perf;
+    static int init = 0;
+    static int enabled = 0;
+    char *val;
+
+    if (!init)
+    {
+        init = 1;
+        val = getenv("VARIORUM_RAPL_SOURCE");
+        if (val != NULL && strcmp(val, "perf") == 0)
+        {
+            if (perf_rapl_parse_pmu(PERF_RAPL_SYSFS_ROOT, &perf) ||
+                perf_rapl_open(&perf))
+            {
+                variorum_error_handler("Perf power PMU unavailable, using MSR RAPL data",
+                                       VARIORUM_ERROR_FEATURE_NOT_AVAILABLE, getenv("HOSTNAME"), __FILE__,
+                                       __FUNCTION__, __LINE__);
+            }
+            else
+            {
+                enabled = 1;
+            }
+        }
+    }
+    if (data != NULL)
+    {
+        *data = enabled ? &perf : NULL;
+    }
+    return enabled;
+}
@@ -0,0 +1,149 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PERF_RAPL_FEATURES_H_INCLUDE
+#define PERF_RAPL_FEATURES_H_INCLUDE
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Location of the Linux perf power PMU in sysfs.
+#define PERF_RAPL_SYSFS_ROOT "/sys/bus/event_source/devices/power"
+
+/// @brief Enum encompassing the energy domains exposed by the perf power PMU.
+enum perf_rapl_domain_e
+{
+    /// @brief Package domain (power/energy-pkg/).
+    PERF_RAPL_PKG,
+    /// @brief DRAM domain (power/energy-ram/).
+    PERF_RAPL_RAM,
+    /// @brief Platform domain (power/energy-psys/).
+    PERF_RAPL_PSYS,
+    /// @brief Number of supported domains.
+    PERF_RAPL_NUM_DOMAINS
+};
+
+/// @brief Structure describing a single perf power PMU event as advertised in
+/// sysfs.
+struct perf_rapl_event
+{
+    /// @brief Indicator that the kernel advertises this event.
+    int present;
+    /// @brief Raw event encoding from events/energy-*.
+    uint64_t config;
+    /// @brief Multiplier from events/energy-*.scale converting raw counts into
+    /// the reported unit.
+    double scale;
+    /// @brief Unit reported in events/energy-*.unit (e.g., Joules).
+    char unit[32];
+    /// @brief Position of this event in a group read, or -1 if not opened.
+    int slot;
+};
+
+/// @brief Structure containing the perf power PMU event groups for all
+/// sockets.
+///
+/// Each socket has one event group led by the first available domain and
+/// opened on the CPU listed for that socket in the PMU cpumask, so a complete
+/// sample of a socket is a single read() of the group leader.
+struct perf_rapl_data
+{
+    /// @brief Dynamic PMU type from the type file in sysfs.
+    int pmu_type;
+    /// @brief Event descriptions, indexed by enum perf_rapl_domain_e.
+    struct perf_rapl_event events[PERF_RAPL_NUM_DOMAINS];
+    /// @brief Number of event groups (one per socket).
+    unsigned nsockets;
+    /// @brief CPU each socket's event group is bound to.
+    int *cpu;
+    /// @brief File descriptors indexed by socket * PERF_RAPL_NUM_DOMAINS +
+    /// domain, -1 for domains that are not available.
+    int *fd;
+    /// @brief Raw 64-bit event counts, indexed like fd. The kernel handles
+    /// hardware counter overflow, so these never wrap in practice.
+    uint64_t *counts;
+    /// @brief Event counts converted to Joules, indexed like fd.
+    double *joules;
+};
+
+/// @brief Read the first line of a sysfs file into a buffer, stripping the
+/// trailing newline.
+///
+/// @param [in] path Sysfs file.
+/// @param [out] buf Buffer for the line.
+/// @param [in] size Size of the buffer.
+///
+/// @return 0 if successful, else -1 if the file cannot be read.
+int perf_sysfs_read_line(
+    const char *path,
+    char *buf,
+    size_t size
+);
+
+/// @brief Parse a cpumask list such as "0,28" or "0-1" into CPU ids.
+///
+/// @param [in] mask Contents of a PMU cpumask file.
+/// @param [out] cpus Newly allocated array of CPU ids, or NULL if out of
+///        memory.
+///
+/// @return Number of CPUs parsed, 0 if out of memory.
+unsigned perf_sysfs_parse_cpumask(
+    const char *mask,
+    int **cpus
+);
+
+/// @brief Parse the event type, events, scales, units and cpumask of the perf
+/// power PMU.
+///
+/// @param [in] root Sysfs directory of the PMU, usually PERF_RAPL_SYSFS_ROOT.
+/// @param [out] data Event descriptions and per-socket CPUs.
+///
+/// @return 0 if successful, else -1 if the PMU or its package event are not
+/// available.
+int perf_rapl_parse_pmu(
+    const char *root,
+    struct perf_rapl_data *data
+);
+
+/// @brief Open one event group per socket for all available domains.
+///
+/// @param [in,out] data Event descriptions from perf_rapl_parse_pmu().
+///
+/// @return 0 if successful, else -1 if out of memory or perf_event_open()
+/// fails, with the event groups closed.
+int perf_rapl_open(
+    struct perf_rapl_data *data
+);
+
+/// @brief Read the event group of every socket and convert counts to Joules.
+///
+/// @param [in,out] data Opened event groups.
+///
+/// @return 0 if successful, else -1 if a group read fails.
+int perf_rapl_read(
+    struct perf_rapl_data *data
+);
+
+/// @brief Close all event groups and release their storage.
+///
+/// @param [in,out] data Opened event groups.
+void perf_rapl_close(
+    struct perf_rapl_data *data
+);
+
+/// @brief Determine whether RAPL energy is sourced from the perf power PMU.
+///
+/// The source is selected at runtime by setting VARIORUM_RAPL_SOURCE=perf. On
+/// first use the PMU is parsed and opened; if that fails, an error is reported
+/// once and the MSR RAPL_DATA batch is used instead.
+///
+/// @param [out] data Pointer to the opened event groups, may be NULL.
+///
+/// @return 1 if the perf power PMU is in use, else 0.
+int perf_rapl_enabled(
+    struct perf_rapl_data **data
+);
+
+#endif
@@ -0,0 +1,41 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stddef.h>
+#include <strings.h>
+
+#include <pmc_event_table.h>
+
+static const struct pmc_event_table *selected_table = NULL;
+
+const struct pmc_event_def *pmc_event_lookup(const struct pmc_event_table
+        *table, const char *name)
+{
+    const struct pmc_event_def *def;
+    uint32_t bucket;
+
+    if (table == NULL || name == NULL || table->nbuckets == 0)
+    {
+        return NULL;
+    }
+    bucket = pmc_event_hash(name, 0) % table->nbuckets;
+    def = &table->slots[pmc_event_hash(name, table->seeds[bucket]) &
+                                       (table->nslots - 1)];
+    if (def->name == NULL || strcasecmp(def->name, name) != 0)
+    {
+        return NULL;
+    }
+    return def;
+}
+
+void pmc_event_table_select(const struct pmc_event_table *table)
+{
+    selected_table = table;
+}
+
+const struct pmc_event_table *pmc_event_table_selected(void)
+{
+    return selected_table;
+}
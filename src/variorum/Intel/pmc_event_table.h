@@ -0,0 +1,122 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PMC_EVENT_TABLE_H_INCLUDE
+#define PMC_EVENT_TABLE_H_INCLUDE
+
+#include <ctype.h>
+#include <stdint.h>
+
+/// @brief Structure containing the encoding of one named core event.
+struct pmc_event_def
+{
+    /// @brief Event name, e.g., INST_RETIRED.ANY_P. NULL for an empty slot.
+    const char *name;
+    /// @brief Event select, IA32_PERFEVTSELx bits 7:0.
+    uint8_t eventsel;
+    /// @brief Unit mask, IA32_PERFEVTSELx bits 15:8.
+    uint8_t umask;
+    /// @brief Counter mask, IA32_PERFEVTSELx bits 31:24.
+    uint8_t cmask;
+    /// @brief Flags in addition to user, OS and enable (e.g., edge detect or
+    /// invert), IA32_PERFEVTSELx bits 23:16.
+    uint8_t flags;
+    /// @brief Bit mask of the general-purpose counters that can count the
+    /// event.
+    uint8_t counters;
+};
+
+/// @brief Structure containing a generated event table for one
+/// microarchitecture.
+///
+/// Tables are generated at build time by gen_pmc_events from the definitions
+/// in Intel/events. Lookups hash the name once to pick a bucket, and once more
+/// with that bucket's seed to pick the only slot the name can be in.
+struct pmc_event_table
+{
+    /// @brief Name of the microarchitecture.
+    const char *uarch;
+    /// @brief Hash slots, nslots entries.
+    const struct pmc_event_def *slots;
+    /// @brief Number of slots, a power of two.
+    uint32_t nslots;
+    /// @brief Hash seed of each bucket, nbuckets entries.
+    const uint16_t *seeds;
+    /// @brief Number of buckets.
+    uint32_t nbuckets;
+    /// @brief Number of events in the table.
+    uint32_t nevents;
+};
+
+/// @brief Case-insensitive hash of an event name, shared by the generator
+/// and the lookup.
+///
+/// @param [in] name Event name.
+/// @param [in] seed Hash seed.
+///
+/// @return 32-bit hash value.
+static inline uint32_t pmc_event_hash(const char *name, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B1u);
+
+    for (; *name != '\0'; name++)
+    {
+        h ^= (uint32_t)toupper((unsigned char) * name);
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/// @brief Find a named event in a generated table.
+///
+/// Takes constant time and does not allocate. Names are matched without
+/// regard to case.
+///
+/// @param [in] table Generated event table, may be NULL.
+/// @param [in] name Event name.
+///
+/// @return Pointer to the event, or NULL if the table has no such event.
+const struct pmc_event_def *pmc_event_lookup(
+    const struct pmc_event_table *table,
+    const char *name
+);
+
+/// @brief Select the model-specific event table used to resolve event names.
+///
+/// @param [in] table Generated event table, or NULL for architectural events
+///        only.
+void pmc_event_table_select(
+    const struct pmc_event_table *table
+);
+
+/// @brief Get the model-specific event table selected for this platform.
+///
+/// @return Generated event table, or NULL if none was selected.
+const struct pmc_event_table *pmc_event_table_selected(
+    void
+);
+
+/// @brief Architectural events, available on every processor with
+/// architectural performance monitoring.
+extern const struct pmc_event_table pmc_events_architectural;
+/// @brief Events for Sandy Bridge (06_2A, 06_2D).
+extern const struct pmc_event_table pmc_events_sandybridge;
+/// @brief Events for Ivy Bridge (06_3E).
+extern const struct pmc_event_table pmc_events_ivybridge;
+/// @brief Events for Haswell (06_3F).
+extern const struct pmc_event_table pmc_events_haswell;
+/// @brief Events for Broadwell (06_4F).
+extern const struct pmc_event_table pmc_events_broadwell;
+/// @brief Events for Skylake server, Cascade Lake and Cooper Lake (06_55).
+extern const struct pmc_event_table pmc_events_skylakex;
+/// @brief Events for Kaby Lake (06_9E).
+extern const struct pmc_event_table pmc_events_kabylake;
+
+#endif
@@ -0,0 +1,85 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <config_architecture.h>
+#include <counters_features.h>
+#include <intel_power_features.h>
+#include <msr_core.h>
+#include <msr_snapshot.h>
+#include <snapshot_features.h>
+#include <variorum_error.h>
+
+int arm_snapshot(off_t msr_rapl_unit, off_t msr_pkg_energy_status,
+                 off_t msr_dram_energy_status, int dram_std_unit,
+                 off_t *msrs_fixed_ctrs, off_t msr_perf_global_ctrl,
+                 off_t msr_fixed_ctr_ctrl, off_t msr_aperf, off_t msr_mperf,
+                 off_t msr_pkg_power_limit, off_t msr_pkg_therm_status)
+{
+    struct msr_snapshot_config cfg = {0};
+    struct rapl_units *ru;
+    unsigned nsockets = 0, ncores = 0, nthreads = 0;
+    unsigned i;
+    int rc;
+
+    variorum_get_topology(&nsockets, &ncores, &nthreads, P_INTEL_CPU_IDX);
+    if (nsockets == 0 || nsockets > VARIORUM_SNAPSHOT_MAX_SOCKETS)
+    {
+        variorum_error_handler("Too many sockets for a snapshot",
+                               VARIORUM_ERROR_INVAL, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        return VARIORUM_ERROR_INVAL;
+    }
+
+    ru = (struct rapl_units *) malloc(nsockets * sizeof(struct rapl_units));
+    if (ru == NULL)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    get_rapl_power_unit(ru, msr_rapl_unit);
+    // ru holds 2^ESU, the number of counts per Joule.
+    cfg.energy_unit_joules = 1.0 / ru[0].joules;
+    cfg.dram_energy_unit_joules = dram_std_unit ? 1.0 / STD_ENERGY_UNIT :
+                                  cfg.energy_unit_joules;
+    cfg.power_unit_watts = 1.0 / ru[0].watts;
+    free(ru);
+
+    enable_fixed_counters(msrs_fixed_ctrs, msr_perf_global_ctrl,
+                          msr_fixed_ctr_ctrl);
+
+    cfg.cpu_path_fmt = access(MSR_ALLOWLIST_PATH, F_OK) == 0 ? MSR_SAFE_PATH_FMT :
+                       MSR_STOCK_PATH_FMT;
+#ifdef USE_NO_BATCH
+    cfg.batch_path = NULL;
+#else
+    cfg.batch_path = MSR_BATCH_PATH;
+#endif
+    cfg.ncpus = nthreads;
+    cfg.nsockets = nsockets;
+    for (i = 0; i < nsockets; i++)
+    {
+        cfg.socket_cpu[i] = i * (ncores / nsockets);
+    }
+    cfg.pkg_energy_msr = msr_pkg_energy_status;
+    cfg.dram_energy_msr = msr_dram_energy_status;
+    cfg.pkg_power_limit_msr = msr_pkg_power_limit;
+    cfg.pkg_therm_status_msr = msr_pkg_therm_status;
+    cfg.cpu_msrs[SNAPSHOT_INSTRUCTIONS] = msrs_fixed_ctrs[0];
+    cfg.cpu_msrs[SNAPSHOT_CORE_CYCLES] = msrs_fixed_ctrs[1];
+    cfg.cpu_msrs[SNAPSHOT_REF_CYCLES] = msrs_fixed_ctrs[2];
+    cfg.cpu_msrs[SNAPSHOT_APERF] = msr_aperf;
+    cfg.cpu_msrs[SNAPSHOT_MPERF] = msr_mperf;
+
+    rc = msr_snapshot_arm(&cfg);
+    if (rc)
+    {
+        variorum_error_handler("Cannot open MSR devices for snapshots", rc,
+                               getenv("HOSTNAME"), __FILE__, __FUNCTION__, __LINE__);
+    }
+    return rc;
+}
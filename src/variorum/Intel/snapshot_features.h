@@ -0,0 +1,50 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef SNAPSHOT_FEATURES_H_INCLUDE
+#define SNAPSHOT_FEATURES_H_INCLUDE
+
+#include <sys/types.h>
+
+/// @brief Arm async-signal-safe snapshots of RAPL energy, package power
+/// limits and thermal status, fixed counters and APERF/MPERF.
+///
+/// Enables the fixed counters on every hardware thread, resolves the energy
+/// units, and opens MSR devices that stay open across variorum_exit() for
+/// msr_snapshot_read().
+///
+/// @param [in] msr_rapl_unit Unique MSR address for MSR_RAPL_POWER_UNIT.
+/// @param [in] msr_pkg_energy_status Unique MSR address for
+///        MSR_PKG_ENERGY_STATUS.
+/// @param [in] msr_dram_energy_status Unique MSR address for
+///        MSR_DRAM_ENERGY_STATUS, or 0 if the model has no DRAM domain.
+/// @param [in] dram_std_unit Non-zero if DRAM energy uses the fixed 15.3
+///        microjoule unit instead of MSR_RAPL_POWER_UNIT.
+/// @param [in] msrs_fixed_ctrs Array of unique addresses for fixed counters.
+/// @param [in] msr_perf_global_ctrl Unique MSR address for
+///        IA32_PERF_GLOBAL_CTRL.
+/// @param [in] msr_fixed_ctr_ctrl Unique MSR address for
+///        IA32_FIXED_CTR_CTRL.
+/// @param [in] msr_aperf Unique MSR address for IA32_APERF.
+/// @param [in] msr_mperf Unique MSR address for IA32_MPERF.
+/// @param [in] msr_pkg_power_limit Unique MSR address for
+///        MSR_PKG_POWER_LIMIT.
+/// @param [in] msr_pkg_therm_status Unique MSR address for
+///        IA32_PACKAGE_THERM_STATUS.
+///
+/// @return 0 if successful, else a negative variorum error code.
+int arm_snapshot(off_t msr_rapl_unit,
+                 off_t msr_pkg_energy_status,
+                 off_t msr_dram_energy_status,
+                 int dram_std_unit,
+                 off_t *msrs_fixed_ctrs,
+                 off_t msr_perf_global_ctrl,
+                 off_t msr_fixed_ctr_ctrl,
+                 off_t msr_aperf,
+                 off_t msr_mperf,
+                 off_t msr_pkg_power_limit,
+                 off_t msr_pkg_therm_status);
+
+#endif
@@ -0,0 +1,460 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <uncore_bw_features.h>
+#include <config_architecture.h>
+#include <msr_core.h>
+#include <perf_rapl_features.h>
+#include <variorum_error.h>
+
+/// @brief Unit control value resetting the counter controls and counters.
+#define UNCORE_CHA_BOX_RESET 0x3ULL
+/// @brief Counter control enable bit.
+#define UNCORE_CHA_CTL_EN (1ULL << 22)
+/// @brief Width of the CHA counters.
+#define UNCORE_CHA_CTR_MASK ((1ULL << 48) - 1)
+
+static long perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu,
+                            int group_fd, unsigned long flags)
+{
+    return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+static int by_value(const void *a, const void *b)
+{
+    unsigned x = *(const unsigned *)a;
+    unsigned y = *(const unsigned *)b;
+
+    return x < y ? -1 : (x > y);
+}
+
+/// @brief Parse an event description such as "event=0x04,umask=0x03" into
+/// an IMC event encoding.
+///
+/// @return 0 if successful, else -1 if the event select is missing.
+static int parse_imc_event(const char *desc, uint64_t *config)
+{
+    const char *term;
+
+    term = strstr(desc, "event=");
+    if (term == NULL)
+    {
+        return -1;
+    }
+    *config = strtoull(term + strlen("event="), NULL, 0) & 0xFF;
+    term = strstr(desc, "umask=");
+    if (term != NULL)
+    {
+        *config |= (strtoull(term + strlen("umask="), NULL, 0) & 0xFF) << 8;
+    }
+    return 0;
+}
+
+unsigned uncore_cha_count(const char *root, unsigned cores_per_socket)
+{
+    DIR *dir;
+    struct dirent *ent;
+    unsigned count = 0;
+    unsigned n;
+    char c;
+    char *val;
+
+    val = getenv("VARIORUM_UNCORE_NUM_CHA");
+    if (val != NULL && atoi(val) > 0)
+    {
+        return atoi(val);
+    }
+    dir = opendir(root);
+    if (dir != NULL)
+    {
+        while ((ent = readdir(dir)) != NULL)
+        {
+            if (sscanf(ent->d_name, "uncore_cha_%u%c", &n, &c) == 1)
+            {
+                count++;
+            }
+        }
+        closedir(dir);
+    }
+    return count > 0 ? count : cores_per_socket;
+}
+
+int uncore_bw_parse_imc(const char *root, struct uncore_bw_data *data)
+{
+    DIR *dir;
+    struct dirent *ent;
+    unsigned *ids = NULL;
+    unsigned nids = 0;
+    unsigned n, i;
+    char c;
+    char path[1024];
+    char buf[256];
+
+    dir = opendir(root);
+    if (dir == NULL)
+    {
+        return -1;
+    }
+    // Only the programmable IMC PMUs; uncore_imc_free_running_* does not
+    // match.
+    while ((ent = readdir(dir)) != NULL)
+    {
+        if (sscanf(ent->d_name, "uncore_imc_%u%c", &n, &c) == 1)
+        {
+            ids = (unsigned *) realloc(ids, (nids + 1) * sizeof(unsigned));
+            ids[nids++] = n;
+        }
+    }
+    closedir(dir);
+    if (nids == 0)
+    {
+        return -1;
+    }
+    qsort(ids, nids, sizeof(unsigned), by_value);
+
+    // All IMC PMUs share the same event encodings and cpumask.
+    snprintf(path, sizeof(path), "%s/uncore_imc_%u/events/cas_count_read", root,
+             ids[0]);
+    if (perf_sysfs_read_line(path, buf, sizeof(buf)) ||
+            parse_imc_event(buf, &data->imc_reads))
+    {
+        free(ids);
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/uncore_imc_%u/events/cas_count_write", root,
+             ids[0]);
+    if (perf_sysfs_read_line(path, buf, sizeof(buf)) ||
+            parse_imc_event(buf, &data->imc_writes))
+    {
+        free(ids);
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/uncore_imc_%u/cpumask", root, ids[0]);
+    if (perf_sysfs_read_line(path, buf, sizeof(buf)))
+    {
+        free(ids);
+        return -1;
+    }
+    data->nsockets = perf_sysfs_parse_cpumask(buf, &data->cpu);
+    if (data->nsockets == 0)
+    {
+        free(data->cpu);
+        data->cpu = NULL;
+        free(ids);
+        return -1;
+    }
+
+    data->pmu_type = (int *) malloc(nids * sizeof(int));
+    for (i = 0; i < nids; i++)
+    {
+        snprintf(path, sizeof(path), "%s/uncore_imc_%u/type", root, ids[i]);
+        if (perf_sysfs_read_line(path, buf, sizeof(buf)))
+        {
+            free(data->pmu_type);
+            free(data->cpu);
+            data->pmu_type = NULL;
+            data->cpu = NULL;
+            free(ids);
+            return -1;
+        }
+        data->pmu_type[i] = atoi(buf);
+    }
+    data->nboxes = nids;
+    free(ids);
+    return 0;
+}
+
+/// @brief Open one read and write event group per IMC PMU and socket.
+///
+/// @return 0 if successful, else -1 if perf_event_open() fails.
+static int open_imc(struct uncore_bw_data *data)
+{
+    struct perf_event_attr attr;
+    unsigned nfds = data->nsockets * data->nboxes * 2;
+    unsigned s, b, i;
+    int *fd;
+
+    data->fd = (int *) malloc(nfds * sizeof(int));
+    for (i = 0; i < nfds; i++)
+    {
+        data->fd[i] = -1;
+    }
+    for (s = 0; s < data->nsockets; s++)
+    {
+        for (b = 0; b < data->nboxes; b++)
+        {
+            fd = &data->fd[(s * data->nboxes + b) * 2];
+            memset(&attr, 0, sizeof(struct perf_event_attr));
+            attr.size = sizeof(struct perf_event_attr);
+            attr.type = data->pmu_type[b];
+            attr.config = data->imc_reads;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fd[0] = perf_event_open(&attr, -1, data->cpu[s], -1, 0);
+            if (fd[0] >= 0)
+            {
+                attr.config = data->imc_writes;
+                fd[1] = perf_event_open(&attr, -1, data->cpu[s], fd[0], 0);
+            }
+            if (fd[0] < 0 || fd[1] < 0)
+            {
+                // Close members before leaders.
+                for (i = nfds; i > 0; i--)
+                {
+                    if (data->fd[i - 1] >= 0)
+                    {
+                        close(data->fd[i - 1]);
+                    }
+                }
+                free(data->fd);
+                data->fd = NULL;
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/// @brief Program counter 0 and 1 of every CHA box of every socket to count
+/// cache line reads and writes, and build the batch that reads them.
+///
+/// @return 0 if successful, else -1 if the unit controls cannot be written.
+static int init_cha(const struct uncore_cha_pmon *cha,
+                    struct uncore_bw_data *data)
+{
+    unsigned nsockets = 0;
+    unsigned ncores = 0;
+    unsigned nthreads = 0;
+    unsigned s, b, idx;
+    off_t box;
+    uint64_t *ctl;
+
+#ifdef VARIORUM_WITH_INTEL_CPU
+    variorum_get_topology(&nsockets, &ncores, &nthreads, P_INTEL_CPU_IDX);
+#endif
+    if (nsockets == 0)
+    {
+        return -1;
+    }
+    data->nsockets = nsockets;
+    data->nboxes = uncore_cha_count(UNCORE_BW_SYSFS_ROOT, ncores / nsockets);
+    if (cha->box_offsets != NULL && data->nboxes > cha->nbox_offsets)
+    {
+        data->nboxes = cha->nbox_offsets;
+    }
+
+    allocate_batch(UNCORE_CHA_CTRL, 3 * nsockets * data->nboxes);
+    allocate_batch(UNCORE_CHA_DATA, 2 * nsockets * data->nboxes);
+    data->cha_reads = (uint64_t **) calloc(nsockets * data->nboxes,
+                                           sizeof(uint64_t *));
+    data->cha_writes = (uint64_t **) calloc(nsockets * data->nboxes,
+                                            sizeof(uint64_t *));
+    for (s = 0; s < nsockets; s++)
+    {
+        for (b = 0; b < data->nboxes; b++)
+        {
+            idx = s * data->nboxes + b;
+            box = cha->box_ctl + (cha->box_offsets != NULL ? cha->box_offsets[b] :
+                                  b * cha->stride);
+            // Box registers are per socket, so any core of the socket works.
+            create_batch_op(box, s * (ncores / nsockets), &ctl, UNCORE_CHA_CTRL);
+            *ctl = UNCORE_CHA_BOX_RESET;
+            create_batch_op(box + cha->ctl0, s * (ncores / nsockets), &ctl,
+                            UNCORE_CHA_CTRL);
+            *ctl = cha->reads | UNCORE_CHA_CTL_EN;
+            create_batch_op(box + cha->ctl0 + 1, s * (ncores / nsockets), &ctl,
+                            UNCORE_CHA_CTRL);
+            *ctl = cha->writes | UNCORE_CHA_CTL_EN;
+            create_batch_op(box + cha->ctr0, s * (ncores / nsockets),
+                            &data->cha_reads[idx], UNCORE_CHA_DATA);
+            create_batch_op(box + cha->ctr0 + 1, s * (ncores / nsockets),
+                            &data->cha_writes[idx], UNCORE_CHA_DATA);
+        }
+    }
+    if (write_batch(UNCORE_CHA_CTRL))
+    {
+        free(data->cha_reads);
+        free(data->cha_writes);
+        data->cha_reads = NULL;
+        data->cha_writes = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/// @brief Select and program the source of memory bandwidth counts.
+///
+/// @return 0 if successful, else -1 if no source is available.
+static int init_uncore_bw(const struct uncore_cha_pmon *cha,
+                          struct uncore_bw_data *data)
+{
+    char *val = getenv("VARIORUM_UNCORE_BW_SOURCE");
+    int try_msr = cha != NULL && (val == NULL || strcmp(val, "msr") == 0);
+    int try_perf = val == NULL || strcmp(val, "perf") == 0;
+
+    memset(data, 0, sizeof(struct uncore_bw_data));
+    if (try_msr && init_cha(cha, data) == 0)
+    {
+        data->source = UNCORE_BW_MSR;
+    }
+    else if (try_perf && uncore_bw_parse_imc(UNCORE_BW_SYSFS_ROOT, data) == 0 &&
+             open_imc(data) == 0)
+    {
+        data->source = UNCORE_BW_PERF;
+    }
+    else
+    {
+        variorum_error_handler("No uncore memory bandwidth counters available",
+                               VARIORUM_ERROR_FEATURE_NOT_AVAILABLE, getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+        data->source = UNCORE_BW_NONE;
+        return -1;
+    }
+    data->last = (uint64_t *) calloc(data->nsockets * data->nboxes * 2,
+                                     sizeof(uint64_t));
+    data->read_lines = (uint64_t *) calloc(data->nsockets, sizeof(uint64_t));
+    data->write_lines = (uint64_t *) calloc(data->nsockets, sizeof(uint64_t));
+    data->delta_read_lines = (uint64_t *) calloc(data->nsockets,
+                             sizeof(uint64_t));
+    data->delta_write_lines = (uint64_t *) calloc(data->nsockets,
+                              sizeof(uint64_t));
+    return 0;
+}
+
+int sample_uncore_bw(const struct uncore_cha_pmon *cha,
+                     struct uncore_bw_data **data)
+{
+    static struct uncore_bw_data bw;
+    static int init = 0;
+    // PERF_FORMAT_GROUP layout: nr, then the read and write counts.
+    uint64_t buf[3];
+    uint64_t raw[2];
+    uint64_t mask;
+    unsigned s, b, idx;
+
+    if (!init)
+    {
+        init = 1;
+        init_uncore_bw(cha, &bw);
+    }
+    if (data != NULL)
+    {
+        *data = &bw;
+    }
+    if (bw.source == UNCORE_BW_NONE)
+    {
+        return -1;
+    }
+
+    bw.old_now = bw.now;
+    gettimeofday(&bw.now, NULL);
+    if (bw.source == UNCORE_BW_MSR && read_batch(UNCORE_CHA_DATA))
+    {
+        return -1;
+    }
+    // Kernel counts are already extended to 64 bits.
+    mask = bw.source == UNCORE_BW_MSR ? UNCORE_CHA_CTR_MASK : ~0ULL;
+
+    for (s = 0; s < bw.nsockets; s++)
+    {
+        bw.delta_read_lines[s] = 0;
+        bw.delta_write_lines[s] = 0;
+        for (b = 0; b < bw.nboxes; b++)
+        {
+            idx = s * bw.nboxes + b;
+            if (bw.source == UNCORE_BW_MSR)
+            {
+                raw[0] = *bw.cha_reads[idx];
+                raw[1] = *bw.cha_writes[idx];
+            }
+            else
+            {
+                if (read(bw.fd[idx * 2], buf, sizeof(buf)) != sizeof(buf))
+                {
+                    return -1;
+                }
+                raw[0] = buf[1];
+                raw[1] = buf[2];
+            }
+            if (bw.nsamples > 0)
+            {
+                bw.delta_read_lines[s] += (raw[0] - bw.last[idx * 2]) & mask;
+                bw.delta_write_lines[s] += (raw[1] - bw.last[idx * 2 + 1]) & mask;
+            }
+            bw.last[idx * 2] = raw[0];
+            bw.last[idx * 2 + 1] = raw[1];
+        }
+        bw.read_lines[s] += bw.delta_read_lines[s];
+        bw.write_lines[s] += bw.delta_write_lines[s];
+    }
+    bw.nsamples++;
+    return 0;
+}
+
+int get_uncore_bw_metrics(struct variorum_metric_vector *metrics,
+                          const struct uncore_cha_pmon *cha,
+                          const double *dram_total_joules)
+{
+    static double *old_dram_joules = NULL;
+    struct uncore_bw_data *bw = NULL;
+    double elapsed, rd, wr, joules;
+    uint64_t ts;
+    unsigned s;
+    int have_old;
+
+    if (sample_uncore_bw(cha, &bw))
+    {
+        return -1;
+    }
+    if (old_dram_joules == NULL)
+    {
+        old_dram_joules = (double *) calloc(bw->nsockets, sizeof(double));
+        if (old_dram_joules == NULL)
+        {
+            return -1;
+        }
+    }
+    // The DRAM energy of this interval is taken from the running total, as
+    // the energy may be read more often than the bandwidth.
+    have_old = bw->nsamples >= 2;
+    elapsed = (bw->now.tv_sec - bw->old_now.tv_sec) +
+              (bw->now.tv_usec - bw->old_now.tv_usec) / 1000000.0;
+
+    ts = bw->now.tv_sec * (uint64_t)1000000 + bw->now.tv_usec;
+    for (s = 0; s < bw->nsockets; s++)
+    {
+        joules = 0.0;
+        if (dram_total_joules != NULL)
+        {
+            joules = dram_total_joules[s] - old_dram_joules[s];
+            old_dram_joules[s] = dram_total_joules[s];
+        }
+        if (!have_old || elapsed <= 0.0)
+        {
+            continue;
+        }
+        rd = (double)bw->delta_read_lines[s] * UNCORE_BW_LINE_BYTES;
+        wr = (double)bw->delta_write_lines[s] * UNCORE_BW_LINE_BYTES;
+        variorum_metric_vector_append(metrics, "bw_mem_read_gb_per_sec",
+                                      VARIORUM_DOMAIN_SOCKET, s, rd / elapsed / 1e9, ts);
+        variorum_metric_vector_append(metrics, "bw_mem_write_gb_per_sec",
+                                      VARIORUM_DOMAIN_SOCKET, s, wr / elapsed / 1e9, ts);
+        variorum_metric_vector_append(metrics, "bw_mem_gb_per_sec",
+                                      VARIORUM_DOMAIN_SOCKET, s, (rd + wr) / elapsed / 1e9, ts);
+        if (joules > 0.0)
+        {
+            variorum_metric_vector_append(metrics, "bytes_mem_per_joule",
+                                          VARIORUM_DOMAIN_SOCKET, s, (rd + wr) / joules, ts);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef UNCORE_BW_FEATURES_H_INCLUDE
+#define UNCORE_BW_FEATURES_H_INCLUDE
+
+#include <stdint.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include <variorum_metrics.h>
+
+/// @brief Location of the Linux perf PMUs in sysfs.
+#define UNCORE_BW_SYSFS_ROOT "/sys/bus/event_source/devices"
+
+/// @brief Bytes transferred by one counted cache line read or write.
+#define UNCORE_BW_LINE_BYTES 64
+
+/// @brief Enum encompassing the sources of memory bandwidth counts.
+enum uncore_bw_source_e
+{
+    /// @brief No source is available.
+    UNCORE_BW_NONE,
+    /// @brief CHA PMON boxes programmed through MSRs.
+    UNCORE_BW_MSR,
+    /// @brief Kernel uncore IMC PMUs opened through perf_event_open().
+    UNCORE_BW_PERF,
+};
+
+/// @brief Structure describing the MSR layout of the CHA PMON boxes of a
+/// model.
+///
+/// Box n is at box_ctl + box_offsets[n] if box_offsets is given, else at
+/// box_ctl + n * stride. Counter 0 and 1 of each box count cache line reads
+/// and writes handled by the CHA on behalf of the home agent.
+struct uncore_cha_pmon
+{
+    /// @brief Address of the unit control register of CHA 0.
+    off_t box_ctl;
+    /// @brief Offset of counter control 0 from the unit control register.
+    off_t ctl0;
+    /// @brief Offset of counter 0 from the unit control register.
+    off_t ctr0;
+    /// @brief Distance between consecutive boxes.
+    off_t stride;
+    /// @brief Offset of each box from box_ctl for models with an irregular
+    /// layout, or NULL.
+    const off_t *box_offsets;
+    /// @brief Number of entries in box_offsets.
+    unsigned nbox_offsets;
+    /// @brief Event select and unit mask counting cache line reads.
+    uint64_t reads;
+    /// @brief Event select and unit mask counting cache line writes.
+    uint64_t writes;
+};
+
+/// @brief Structure containing the memory bandwidth counters of all sockets.
+///
+/// With the MSR source there is one box per CHA; with the perf source there is
+/// one box per IMC PMU. Either way a sample is one pass over all boxes.
+struct uncore_bw_data
+{
+    /// @brief Source of the counts, see enum uncore_bw_source_e.
+    int source;
+    /// @brief Number of sockets.
+    unsigned nsockets;
+    /// @brief Number of boxes per socket.
+    unsigned nboxes;
+    /// @brief Raw read counts filled in by the UNCORE_CHA_DATA batch, indexed
+    /// by socket * nboxes + box (MSR source).
+    uint64_t **cha_reads;
+    /// @brief Raw write counts filled in by the UNCORE_CHA_DATA batch, indexed
+    /// like cha_reads (MSR source).
+    uint64_t **cha_writes;
+    /// @brief perf_event_open() type of each IMC PMU (perf source).
+    int *pmu_type;
+    /// @brief Encoding of the IMC read event (perf source).
+    uint64_t imc_reads;
+    /// @brief Encoding of the IMC write event (perf source).
+    uint64_t imc_writes;
+    /// @brief CPU each socket's events are opened on (perf source).
+    int *cpu;
+    /// @brief Group leader of each box, reads first and writes second,
+    /// indexed like cha_reads (perf source).
+    int *fd;
+    /// @brief Raw count at the previous sample, two per box (reads, writes).
+    uint64_t *last;
+    /// @brief Cache lines read since the first sample, per socket.
+    uint64_t *read_lines;
+    /// @brief Cache lines written since the first sample, per socket.
+    uint64_t *write_lines;
+    /// @brief Cache lines read in the last interval, per socket.
+    uint64_t *delta_read_lines;
+    /// @brief Cache lines written in the last interval, per socket.
+    uint64_t *delta_write_lines;
+    /// @brief Timestamp of the current sample.
+    struct timeval now;
+    /// @brief Timestamp of the previous sample.
+    struct timeval old_now;
+    /// @brief Number of samples taken.
+    unsigned nsamples;
+};
+
+/// @brief Count the CHA boxes of one socket.
+///
+/// VARIORUM_UNCORE_NUM_CHA takes precedence. Otherwise the uncore_cha_*
+/// PMUs of the kernel are counted, and if there are none, one CHA per core is
+/// assumed.
+///
+/// @param [in] root Sysfs directory of the perf PMUs, usually
+///        UNCORE_BW_SYSFS_ROOT.
+/// @param [in] cores_per_socket Number of cores per socket.
+///
+/// @return Number of CHA boxes per socket.
+unsigned uncore_cha_count(
+    const char *root,
+    unsigned cores_per_socket
+);
+
+/// @brief Parse the uncore IMC PMUs of the kernel.
+///
+/// Fills in pmu_type, imc_reads, imc_writes, cpu, nsockets and nboxes.
+///
+/// @param [in] root Sysfs directory of the perf PMUs, usually
+///        UNCORE_BW_SYSFS_ROOT.
+/// @param [out] data Memory bandwidth counters.
+///
+/// @return 0 if successful, else -1 if there are no usable IMC PMUs.
+int uncore_bw_parse_imc(
+    const char *root,
+    struct uncore_bw_data *data
+);
+
+/// @brief Read memory bandwidth counts for all sockets in one pass.
+///
+/// The first call selects and programs the source. VARIORUM_UNCORE_BW_SOURCE
+/// may be set to msr or perf; by default the CHA boxes are used when the
+/// model has a layout, and the kernel IMC PMUs otherwise or if programming the
+/// CHA boxes fails.
+///
+/// @param [in] cha CHA layout of the model, or NULL if it has none.
+/// @param [out] data Pointer to the memory bandwidth counters, may be NULL.
+///
+/// @return 0 if successful, else -1 if no source is available or the read
+/// fails.
+int sample_uncore_bw(
+    const struct uncore_cha_pmon *cha,
+    struct uncore_bw_data **data
+);
+
+/// @brief Append per-socket memory bandwidth to a metric vector.
+///
+/// Appends bw_mem_read_gb_per_sec, bw_mem_write_gb_per_sec and
+/// bw_mem_gb_per_sec for each socket, and bytes_mem_per_joule if the DRAM
+/// energy is given. Rates are reported from the second call on, over the
+/// interval since the previous call.
+///
+/// @param [out] metrics Metric vector to append to.
+/// @param [in] cha CHA layout of the model, or NULL if it has none.
+/// @param [in] dram_total_joules DRAM energy of each socket accumulated
+///        without wrapping, e.g., rapl_data.dram_total_joules, or NULL.
+///
+/// @return 0 if successful, else -1 if no source is available.
+int get_uncore_bw_metrics(
+    struct variorum_metric_vector *metrics,
+    const struct uncore_cha_pmon *cha,
+    const double *dram_total_joules
+);
+
+#endif
@@ -218,3 +218,13 @@ int volta_get_power_json(json_t *get_power_obj)
     return 0;
 }
 
+int volta_get_metrics(struct variorum_metric_vector *metrics)
+{
+    char *val = getenv("VARIORUM_LOG");
+    if (val != NULL && atoi(val) == 1)
+    {
+        printf("Running %s\n", __FUNCTION__);
+    }
+
+    return nvidia_gpu_get_metrics(metrics);
+}
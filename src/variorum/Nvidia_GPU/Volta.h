@@ -8,6 +8,8 @@
 
 #include <jansson.h>
 
+#include <variorum_metrics.h>
+
 int volta_get_power(
     int long_ver
 );
@@ -48,4 +50,8 @@ int volta_get_gpu_utilization_json(
     char **get_gpu_util_obj_str
 );
 
+int volta_get_metrics(
+    struct variorum_metric_vector *metrics
+);
+
 #endif
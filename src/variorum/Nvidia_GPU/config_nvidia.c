@@ -38,6 +38,7 @@ int set_nvidia_func_ptrs(int idx)
         g_platform[idx].variorum_cap_each_gpu_power_limit =
             volta_cap_each_gpu_power_limit;
         g_platform[idx].variorum_get_power_json = volta_get_power_json;
+        g_platform[idx].variorum_get_metrics = volta_get_metrics;
     }
     else
     {
@@ -26,7 +26,7 @@ char m_hostname[1024];
 void initNVML(void)
 {
     unsigned int d;
-    unsigned m_num_package;
+    unsigned m_num_package = 1;
     /* Initialize GPU reading */
     m_unit_devices_file_desc = NULL;
     nvmlReturn_t result = nvmlInit();
@@ -71,6 +71,159 @@ void shutdownNVML(void)
     nvmlShutdown();
 }
 
+int nvidia_gpu_sample_all(struct nvidia_gpu_sample **samples)
+{
+    /* Fields that NVML can return in one batched query. Temperature, clocks
+     * and utilization are not exposed as field values. */
+    static const unsigned int field_ids[] =
+    {
+        NVML_FI_DEV_POWER_INSTANT,
+        NVML_FI_DEV_POWER_CURRENT_LIMIT,
+        NVML_FI_DEV_MEMORY_TEMP
+    };
+    enum
+    {
+        F_POWER,
+        F_POWER_LIMIT,
+        F_MEM_TEMP,
+        F_COUNT
+    };
+    static struct nvidia_gpu_sample *s = NULL;
+    static unsigned allocated = 0;
+    nvmlFieldValue_t fv[F_COUNT];
+    nvmlUtilization_t util;
+    nvmlDevice_t dev;
+    unsigned int value;
+    struct timeval tv;
+    unsigned d;
+    int f;
+
+    if (allocated < m_total_unit_devices)
+    {
+        free(s);
+        s = (struct nvidia_gpu_sample *) calloc(m_total_unit_devices,
+                                                sizeof(struct nvidia_gpu_sample));
+        if (s == NULL)
+        {
+            allocated = 0;
+            variorum_error_handler("Could not allocate memory for GPU samples",
+                                   VARIORUM_ERROR_PLATFORM_ENV, getenv("HOSTNAME"), __FILE__, __FUNCTION__,
+                                   __LINE__);
+            return -1;
+        }
+        allocated = m_total_unit_devices;
+    }
+
+    for (d = 0; d < m_total_unit_devices; d++)
+    {
+        dev = m_unit_devices_file_desc[d];
+        gettimeofday(&tv, NULL);
+        s[d].timestamp_us = tv.tv_sec * (uint64_t)1000000 + tv.tv_usec;
+
+        memset(fv, 0, sizeof(fv));
+        for (f = 0; f < F_COUNT; f++)
+        {
+            fv[f].fieldId = field_ids[f];
+        }
+        if (nvmlDeviceGetFieldValues(dev, F_COUNT, fv) != NVML_SUCCESS)
+        {
+            for (f = 0; f < F_COUNT; f++)
+            {
+                fv[f].nvmlReturn = NVML_ERROR_NOT_SUPPORTED;
+            }
+        }
+
+        /* Power fields are only available on newer drivers. */
+        if (fv[F_POWER].nvmlReturn == NVML_SUCCESS)
+        {
+            value = fv[F_POWER].value.uiVal;
+        }
+        else if (nvmlDeviceGetPowerUsage(dev, &value) != NVML_SUCCESS)
+        {
+            value = 0;
+        }
+        s[d].power_watts = (double)value * 0.001;
+
+        if (fv[F_POWER_LIMIT].nvmlReturn == NVML_SUCCESS)
+        {
+            value = fv[F_POWER_LIMIT].value.uiVal;
+        }
+        else if (nvmlDeviceGetEnforcedPowerLimit(dev, &value) != NVML_SUCCESS)
+        {
+            value = 0;
+        }
+        s[d].power_limit_watts = (double)value * 0.001;
+
+        s[d].mem_temp_celsius = (fv[F_MEM_TEMP].nvmlReturn == NVML_SUCCESS) ?
+                                fv[F_MEM_TEMP].value.uiVal : 0;
+
+        if (nvmlDeviceGetTotalEnergyConsumption(dev, &s[d].energy_mj) != NVML_SUCCESS)
+        {
+            s[d].energy_mj = 0;
+        }
+        if (nvmlDeviceGetTemperature(dev, NVML_TEMPERATURE_GPU,
+                                     &s[d].temp_celsius) != NVML_SUCCESS)
+        {
+            s[d].temp_celsius = 0;
+        }
+        if (nvmlDeviceGetClock(dev, NVML_CLOCK_SM, NVML_CLOCK_ID_CURRENT,
+                               &s[d].sm_clock_mhz) != NVML_SUCCESS)
+        {
+            s[d].sm_clock_mhz = 0;
+        }
+        if (nvmlDeviceGetClock(dev, NVML_CLOCK_MEM, NVML_CLOCK_ID_CURRENT,
+                               &s[d].mem_clock_mhz) != NVML_SUCCESS)
+        {
+            s[d].mem_clock_mhz = 0;
+        }
+        if (nvmlDeviceGetUtilizationRates(dev, &util) != NVML_SUCCESS)
+        {
+            util.gpu = 0;
+            util.memory = 0;
+        }
+        s[d].sm_util_percent = util.gpu;
+        s[d].mem_util_percent = util.memory;
+    }
+
+    *samples = s;
+    return 0;
+}
+
+int nvidia_gpu_get_metrics(struct variorum_metric_vector *metrics)
+{
+    struct nvidia_gpu_sample *s = NULL;
+    unsigned d;
+    int err = 0;
+
+    if (nvidia_gpu_sample_all(&s))
+    {
+        return -1;
+    }
+
+    for (d = 0; d < m_total_unit_devices; d++)
+    {
+        err |= variorum_metric_vector_append(metrics, "power_gpu_watts",
+                                             VARIORUM_DOMAIN_GPU, d, s[d].power_watts, s[d].timestamp_us);
+        err |= variorum_metric_vector_append(metrics, "power_limit_gpu_watts",
+                                             VARIORUM_DOMAIN_GPU, d, s[d].power_limit_watts, s[d].timestamp_us);
+        err |= variorum_metric_vector_append(metrics, "energy_gpu_joules",
+                                             VARIORUM_DOMAIN_GPU, d, (double)s[d].energy_mj / 1000, s[d].timestamp_us);
+        err |= variorum_metric_vector_append(metrics, "temp_gpu_celsius",
+                                             VARIORUM_DOMAIN_GPU, d, s[d].temp_celsius, s[d].timestamp_us);
+        err |= variorum_metric_vector_append(metrics, "temp_gpu_mem_celsius",
+                                             VARIORUM_DOMAIN_GPU, d, s[d].mem_temp_celsius, s[d].timestamp_us);
+        err |= variorum_metric_vector_append(metrics, "freq_gpu_mhz",
+                                             VARIORUM_DOMAIN_GPU, d, s[d].sm_clock_mhz, s[d].timestamp_us);
+        err |= variorum_metric_vector_append(metrics, "freq_gpu_mem_mhz",
+                                             VARIORUM_DOMAIN_GPU, d, s[d].mem_clock_mhz, s[d].timestamp_us);
+        err |= variorum_metric_vector_append(metrics, "util_gpu_percent",
+                                             VARIORUM_DOMAIN_GPU, d, s[d].sm_util_percent, s[d].timestamp_us);
+        err |= variorum_metric_vector_append(metrics, "util_gpu_mem_percent",
+                                             VARIORUM_DOMAIN_GPU, d, s[d].mem_util_percent, s[d].timestamp_us);
+    }
+    return err ? -1 : 0;
+}
+
 //TODO REALLY TEST THIS ONE FOR LIBJUSTIFY
 void nvidia_gpu_get_power_data(int chipid, int verbose, FILE *output)
 {
@@ -420,7 +573,7 @@ void nvidia_get_gpu_utilization_json(int chipid, json_t *get_gpu_util_obj)
     nvmlUtilization_t util;
     int d;
     char socket_id[12];
-    char device_id[12];
+    char device_id[24];
     char hostname[1024];
     struct timeval tv;
     uint64_t ts;
@@ -463,7 +616,7 @@ void nvidia_get_gpu_utilization_json(int chipid, json_t *get_gpu_util_obj)
          d < (chipid + 1) * (int)m_gpus_per_socket; ++d)
     {
         nvmlDeviceGetUtilizationRates(m_unit_devices_file_desc[d], &util);
-        snprintf(device_id, 12, "GPU%d_util%%", d);
+        snprintf(device_id, sizeof(device_id), "GPU%d_util%%", d);
         json_object_set_new(socket_obj, device_id, json_integer(util.gpu));
     }
 }
@@ -13,6 +13,8 @@
 #include <string.h>
 #include <sys/time.h>
 
+#include <variorum_metrics.h>
+
 extern unsigned m_total_unit_devices;
 extern nvmlDevice_t *m_unit_devices_file_desc;
 extern unsigned m_gpus_per_socket;
@@ -26,6 +28,55 @@ void shutdownNVML(
     void
 );
 
+/// @brief One sample of every metric of a single GPU.
+struct nvidia_gpu_sample
+{
+    /// @brief Instantaneous power usage (in Watts).
+    double power_watts;
+    /// @brief Currently enforced power limit (in Watts).
+    double power_limit_watts;
+    /// @brief Energy consumed since the driver was loaded (in millijoules).
+    unsigned long long energy_mj;
+    /// @brief GPU die temperature (in degrees Celsius).
+    unsigned int temp_celsius;
+    /// @brief HBM temperature (in degrees Celsius), 0 if not supported.
+    unsigned int mem_temp_celsius;
+    /// @brief Current SM clock (in MHz).
+    unsigned int sm_clock_mhz;
+    /// @brief Current memory clock (in MHz).
+    unsigned int mem_clock_mhz;
+    /// @brief SM utilization (in percent).
+    unsigned int sm_util_percent;
+    /// @brief Memory utilization (in percent).
+    unsigned int mem_util_percent;
+    /// @brief Time the sample was taken (in microseconds since the epoch).
+    uint64_t timestamp_us;
+};
+
+/// @brief Sample all metrics of all GPUs in one pass.
+///
+/// Power, power limit and memory temperature are fetched with a single
+/// nvmlDeviceGetFieldValues() call per device, falling back to the per-metric
+/// queries on drivers that do not expose the power fields. Energy is read
+/// from the hardware counter with nvmlDeviceGetTotalEnergyConsumption().
+///
+/// @param [out] samples Pointer to an internal array of m_total_unit_devices
+///        samples, valid until the next call.
+///
+/// @return 0 if successful, otherwise -1
+int nvidia_gpu_sample_all(
+    struct nvidia_gpu_sample **samples
+);
+
+/// @brief Append the current sample of every GPU to a metric vector.
+///
+/// @param [in,out] metrics Metric vector.
+///
+/// @return 0 if successful, otherwise -1
+int nvidia_gpu_get_metrics(
+    struct variorum_metric_vector *metrics
+);
+
 void nvidia_gpu_get_power_data(
     int chipid,
     int verbose,
@@ -362,6 +362,29 @@ void variorum_init_func_ptrs()
         g_platform[i].variorum_get_thermals_json = NULL;
         g_platform[i].variorum_get_frequency_json = NULL;
         g_platform[i].variorum_get_energy_json = NULL;
+        g_platform[i].variorum_get_cstate_residency_json = NULL;
+        g_platform[i].variorum_cap_core_cstate_latency = NULL;
+        g_platform[i].variorum_cap_socket_cstate_latency = NULL;
+        g_platform[i].variorum_cap_node_cstate_latency = NULL;
+        g_platform[i].variorum_cap_socket_pkg_cstate_limit = NULL;
+        g_platform[i].variorum_save_cstate_limits = NULL;
+        g_platform[i].variorum_restore_cstate_limits = NULL;
+        g_platform[i].variorum_get_prefetch_control = NULL;
+        g_platform[i].variorum_set_prefetch_control = NULL;
+        g_platform[i].variorum_push_prefetch_control = NULL;
+        g_platform[i].variorum_pop_prefetch_control = NULL;
+        g_platform[i].variorum_cap_turbo_ratio_limit = NULL;
+        g_platform[i].variorum_get_energy_perf_bias = NULL;
+        g_platform[i].variorum_set_energy_perf_bias = NULL;
+        g_platform[i].variorum_get_turbo_cores = NULL;
+        g_platform[i].variorum_set_turbo_cores = NULL;
+        g_platform[i].variorum_get_thread_fixed_counters = NULL;
+        g_platform[i].variorum_arm_snapshot = NULL;
+        g_platform[i].variorum_get_metrics = NULL;
+        g_platform[i].variorum_get_energy_metrics = NULL;
+        g_platform[i].variorum_start_pmc_events = NULL;
+        g_platform[i].variorum_read_pmc_events = NULL;
+        g_platform[i].variorum_stop_pmc_events = NULL;
     }
 }
 
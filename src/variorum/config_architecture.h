@@ -9,6 +9,7 @@
 #include <stdint.h>
 
 #include <variorum_config.h>
+#include <variorum_metrics.h>
 
 #include <jansson.h>
 
@@ -283,6 +284,148 @@ struct platform
     /// @return Error code.
     int (*variorum_get_energy_json)(json_t *get_energy_obj);
 
+    /// @brief Function pointer to get JSON object for package and core
+    /// C-state residency since the previous call.
+    ///
+    /// @return Error code.
+    int (*variorum_get_cstate_residency_json)(json_t *get_cstate_obj);
+
+    /// @brief Function pointer to limit the idle states of a core to those
+    /// with an exit latency up to a limit.
+    ///
+    /// @return Error code.
+    int (*variorum_cap_core_cstate_latency)(int core_id, int max_latency_us);
+
+    /// @brief Function pointer to limit the idle states of all cores of a
+    /// socket to those with an exit latency up to a limit.
+    ///
+    /// @return Error code.
+    int (*variorum_cap_socket_cstate_latency)(int socket_id, int max_latency_us);
+
+    /// @brief Function pointer to hold a node-wide wakeup latency limit.
+    ///
+    /// @return Error code.
+    int (*variorum_cap_node_cstate_latency)(int max_latency_us);
+
+    /// @brief Function pointer to set the deepest allowed package C-state
+    /// of a socket in hardware.
+    ///
+    /// @return Error code.
+    int (*variorum_cap_socket_pkg_cstate_limit)(int socket_id, int limit);
+
+    /// @brief Function pointer to record the current C-state limits.
+    ///
+    /// @return Error code.
+    int (*variorum_save_cstate_limits)(void);
+
+    /// @brief Function pointer to restore the recorded C-state limits.
+    ///
+    /// @return Error code.
+    int (*variorum_restore_cstate_limits)(void);
+
+    /// @brief Function pointer to read the prefetcher disable bits of every
+    /// core.
+    ///
+    /// @return Error code.
+    int (*variorum_get_prefetch_control)(int *disable_bits);
+
+    /// @brief Function pointer to set the prefetcher disable bits of every
+    /// core.
+    ///
+    /// @return Error code.
+    int (*variorum_set_prefetch_control)(const int *disable_bits);
+
+    /// @brief Function pointer to record the prefetcher disable bits of every
+    /// core and set new ones.
+    ///
+    /// @return Error code.
+    int (*variorum_push_prefetch_control)(const int *disable_bits);
+
+    /// @brief Function pointer to restore the prefetcher disable bits
+    /// recorded by the matching push.
+    ///
+    /// @return Error code.
+    int (*variorum_pop_prefetch_control)(void);
+
+    /// @brief Function pointer to set turbo ratio limit buckets.
+    ///
+    /// @return Error code.
+    int (*variorum_cap_turbo_ratio_limit)(int nbuckets, const int *bucket_cores,
+                                          const int *bucket_freq_mhz);
+
+    /// @brief Function pointer to read the energy performance bias hint of
+    /// every core.
+    ///
+    /// @return Error code.
+    int (*variorum_get_energy_perf_bias)(int *epb);
+
+    /// @brief Function pointer to set the energy performance bias hint of
+    /// every core.
+    ///
+    /// @return Error code.
+    int (*variorum_set_energy_perf_bias)(const int *epb);
+
+    /// @brief Function pointer to report whether turbo is allowed on every
+    /// core.
+    ///
+    /// @return Error code.
+    int (*variorum_get_turbo_cores)(int *enabled);
+
+    /// @brief Function pointer to allow or disengage turbo on selected cores.
+    ///
+    /// @return Error code.
+    int (*variorum_set_turbo_cores)(const int *core_mask, int enable);
+
+    /// @brief Function pointer to read the fixed counters of the logical
+    /// processor the calling thread runs on.
+    ///
+    /// @return Error code.
+    int (*variorum_get_thread_fixed_counters)(uint64_t *counts);
+
+    /// @brief Function pointer to arm async-signal-safe snapshots of energy
+    /// and per-CPU counters.
+    ///
+    /// @return Error code.
+    int (*variorum_arm_snapshot)(void);
+
+    /// @brief Function pointer to append the current samples of all
+    /// supported metrics to a metric vector.
+    ///
+    /// @param [in,out] metrics Metric vector shared by all platforms.
+    ///
+    /// @return Error code.
+    int (*variorum_get_metrics)(struct variorum_metric_vector *metrics);
+
+    /// @brief Function pointer to append the energy of each domain to a
+    /// metric vector, reading only the energy counters.
+    ///
+    /// @param [in,out] metrics Metric vector shared by all platforms.
+    ///
+    /// @return Error code.
+    int (*variorum_get_energy_metrics)(struct variorum_metric_vector *metrics);
+
+    /// @brief Function pointer to schedule a list of performance events onto
+    /// the general-purpose counters.
+    ///
+    /// @param [in] events Comma-separated list of event names or raw
+    ///        encodings.
+    ///
+    /// @return Error code.
+    int (*variorum_start_pmc_events)(const char *events);
+
+    /// @brief Function pointer to append the scaled counts of the started
+    /// performance events to a metric vector.
+    ///
+    /// @param [in,out] metrics Metric vector shared by all platforms.
+    ///
+    /// @return Error code.
+    int (*variorum_read_pmc_events)(struct variorum_metric_vector *metrics);
+
+    /// @brief Function pointer to stop the started performance events.
+    ///
+    /// @return Error code.
+    int (*variorum_stop_pmc_events)(void);
+
     /// @brief Identifier for architecture.
     uint64_t *arch_id;
     /// @brief Hostname.
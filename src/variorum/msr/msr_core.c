@@ -733,3 +733,15 @@ int create_batch_op(off_t msr, uint64_t cpu, uint64_t **dest,
 #endif
     return 0;
 }
+
+int reset_batch(const int batchnum)
+{
+    struct msr_batch_array *batch = NULL;
+
+    if (batch_storage(&batch, batchnum, NULL))
+    {
+        return -1;
+    }
+    batch->numops = 0;
+    return 0;
+}
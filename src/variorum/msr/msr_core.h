@@ -102,6 +102,24 @@ enum variorum_data_type_e
     TURBO_RATIO_LIMIT_CORES = 34,
     TDP_DEFS = 35,
     TDP_CONFIG = 36,
+    /// @brief Per-core energy status sampled by the AMD per-core power
+    /// sampler.
+    CORE_ENERGY_DATA = 37,
+    /// @brief Unit and counter controls of the uncore CHA PMON boxes.
+    UNCORE_CHA_CTRL = 38,
+    /// @brief Uncore CHA PMON memory read and write counts.
+    UNCORE_CHA_DATA = 39,
+    /// @brief Package C-state limit of each core.
+    PKG_CST_CONFIG = 40,
+    /// @brief Prefetcher controls of each core.
+    MISC_FEATURE_CTRL = 41,
+    /// @brief Energy performance bias hint of each hardware thread.
+    ENERGY_PERF_BIAS = 42,
+    /// @brief Turbo disengage bit of each hardware thread.
+    TURBO_CORE_CTL = 43,
+    /// @brief Hardware threads whose turbo disengage bit changes, rebuilt on
+    /// every write.
+    TURBO_CORE_WRITE = 44,
 };
 
 /// @brief Enum encompassing batch operations.
@@ -434,4 +452,17 @@ int create_batch_op(
     const int batchnum
 );
 
+/// @brief Remove all operations from a batch so that it can be rebuilt with
+/// create_batch_op().
+///
+/// The allocated size is kept, and pointers returned by earlier calls to
+/// create_batch_op() for this batch must no longer be used.
+///
+/// @param [in] batchnum Identify a unique batch.
+///
+/// @return 0 if successful, else -1 if batch handle is NULL.
+int reset_batch(
+    const int batchnum
+);
+
 #endif
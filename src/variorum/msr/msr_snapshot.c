@@ -0,0 +1,233 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+// Necessary for sched_getcpu, pread & pwrite.
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <msr_core.h>
+#include <msr_snapshot.h>
+#include <variorum_error.h>
+
+/// @brief Largest number of registers read by one snapshot.
+#define SNAPSHOT_MAX_OPS (4 * VARIORUM_SNAPSHOT_MAX_SOCKETS + SNAPSHOT_CPU_MSRS)
+
+/// @brief Armed configuration and devices, written only while disarmed.
+static struct msr_snapshot_config snapshot_cfg;
+static int snapshot_batch_fd = -1;
+static int *snapshot_cpu_fd = NULL;
+static volatile sig_atomic_t snapshot_armed = 0;
+
+void msr_snapshot_disarm(void)
+{
+    unsigned i;
+
+    snapshot_armed = 0;
+    if (snapshot_batch_fd >= 0)
+    {
+        close(snapshot_batch_fd);
+        snapshot_batch_fd = -1;
+    }
+    if (snapshot_cpu_fd != NULL)
+    {
+        for (i = 0; i < snapshot_cfg.ncpus; i++)
+        {
+            if (snapshot_cpu_fd[i] >= 0)
+            {
+                close(snapshot_cpu_fd[i]);
+            }
+        }
+        free(snapshot_cpu_fd);
+        snapshot_cpu_fd = NULL;
+    }
+}
+
+int msr_snapshot_arm(const struct msr_snapshot_config *cfg)
+{
+    char filename[FILENAME_SIZE];
+    unsigned i;
+
+    msr_snapshot_disarm();
+    if (cfg->ncpus == 0 || cfg->nsockets == 0 ||
+        cfg->nsockets > VARIORUM_SNAPSHOT_MAX_SOCKETS)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    for (i = 0; i < cfg->nsockets; i++)
+    {
+        if (cfg->socket_cpu[i] >= cfg->ncpus)
+        {
+            return VARIORUM_ERROR_INVAL;
+        }
+    }
+    snapshot_cfg = *cfg;
+
+    if (cfg->batch_path != NULL)
+    {
+        snapshot_batch_fd = open(cfg->batch_path, O_RDWR | O_CLOEXEC);
+    }
+    if (snapshot_batch_fd < 0)
+    {
+        snapshot_cpu_fd = (int *) malloc(cfg->ncpus * sizeof(int));
+        if (snapshot_cpu_fd == NULL)
+        {
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        for (i = 0; i < cfg->ncpus; i++)
+        {
+            snapshot_cpu_fd[i] = -1;
+        }
+        for (i = 0; i < cfg->ncpus; i++)
+        {
+            snprintf(filename, FILENAME_SIZE, cfg->cpu_path_fmt, i);
+            snapshot_cpu_fd[i] = open(filename, O_RDONLY | O_CLOEXEC);
+            if (snapshot_cpu_fd[i] < 0)
+            {
+                msr_snapshot_disarm();
+                return VARIORUM_ERROR_MSR_MODULE;
+            }
+        }
+    }
+    snapshot_armed = 1;
+    return 0;
+}
+
+/// @brief Append a read of msr on cpu, skipping unavailable registers.
+static void snapshot_op(struct msr_batch_op *ops, unsigned *nops,
+                        uint64_t **dest, uint64_t *slot, unsigned cpu, off_t msr)
+{
+    if (msr == 0)
+    {
+        return;
+    }
+    ops[*nops].cpu = (__u16)cpu;
+    ops[*nops].isrdmsr = 1;
+    ops[*nops].err = 0;
+    ops[*nops].msr = (__u32)msr;
+    ops[*nops].msrdata = 0;
+    ops[*nops].wmask = 0;
+    dest[*nops] = slot;
+    (*nops)++;
+}
+
+int msr_snapshot_read(struct variorum_snapshot *snap)
+{
+    struct msr_batch_op ops[SNAPSHOT_MAX_OPS];
+    uint64_t *dest[SNAPSHOT_MAX_OPS];
+    uint64_t pkg[VARIORUM_SNAPSHOT_MAX_SOCKETS];
+    uint64_t dram[VARIORUM_SNAPSHOT_MAX_SOCKETS];
+    uint64_t limit[VARIORUM_SNAPSHOT_MAX_SOCKETS];
+    uint64_t therm[VARIORUM_SNAPSHOT_MAX_SOCKETS];
+    uint64_t cpu_vals[SNAPSHOT_CPU_MSRS];
+    struct msr_batch_array batch;
+    struct timespec ts;
+    int saved_errno = errno;
+    int rc = 0;
+    unsigned nops = 0;
+    unsigned i;
+    int cpu;
+
+    if (!snapshot_armed)
+    {
+        return VARIORUM_ERROR_FEATURE_NOT_AVAILABLE;
+    }
+    cpu = sched_getcpu();
+    if (cpu < 0 || (unsigned)cpu >= snapshot_cfg.ncpus)
+    {
+        errno = saved_errno;
+        return VARIORUM_ERROR_RUNTIME;
+    }
+
+    memset(pkg, 0, sizeof(pkg));
+    memset(dram, 0, sizeof(dram));
+    memset(limit, 0, sizeof(limit));
+    memset(therm, 0, sizeof(therm));
+    memset(cpu_vals, 0, sizeof(cpu_vals));
+    for (i = 0; i < snapshot_cfg.nsockets; i++)
+    {
+        snapshot_op(ops, &nops, dest, &pkg[i], snapshot_cfg.socket_cpu[i],
+                    snapshot_cfg.pkg_energy_msr);
+        snapshot_op(ops, &nops, dest, &dram[i], snapshot_cfg.socket_cpu[i],
+                    snapshot_cfg.dram_energy_msr);
+        snapshot_op(ops, &nops, dest, &limit[i], snapshot_cfg.socket_cpu[i],
+                    snapshot_cfg.pkg_power_limit_msr);
+        snapshot_op(ops, &nops, dest, &therm[i], snapshot_cfg.socket_cpu[i],
+                    snapshot_cfg.pkg_therm_status_msr);
+    }
+    for (i = 0; i < SNAPSHOT_CPU_MSRS; i++)
+    {
+        snapshot_op(ops, &nops, dest, &cpu_vals[i], (unsigned)cpu,
+                    snapshot_cfg.cpu_msrs[i]);
+    }
+
+    if (snapshot_batch_fd >= 0)
+    {
+        batch.numops = nops;
+        batch.ops = ops;
+        if (nops > 0 && ioctl(snapshot_batch_fd, X86_IOC_MSR_BATCH, &batch) < 0)
+        {
+            rc = VARIORUM_ERROR_MSR_BATCH;
+        }
+        for (i = 0; i < nops; i++)
+        {
+            if (ops[i].err)
+            {
+                rc = VARIORUM_ERROR_MSR_BATCH;
+            }
+        }
+    }
+    else
+    {
+        for (i = 0; i < nops; i++)
+        {
+            if (pread(snapshot_cpu_fd[ops[i].cpu], (void *)&ops[i].msrdata,
+                      sizeof(uint64_t), ops[i].msr) != sizeof(uint64_t))
+            {
+                rc = VARIORUM_ERROR_MSR_READ;
+                break;
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    errno = saved_errno;
+    if (rc)
+    {
+        return rc;
+    }
+
+    for (i = 0; i < nops; i++)
+    {
+        *dest[i] = ops[i].msrdata;
+    }
+    snap->timestamp_ns = ts.tv_sec * (uint64_t)1000000000 + ts.tv_nsec;
+    snap->cpu = cpu;
+    snap->nsockets = snapshot_cfg.nsockets;
+    for (i = 0; i < VARIORUM_SNAPSHOT_MAX_SOCKETS; i++)
+    {
+        snap->pkg_energy[i] = (uint32_t)pkg[i];
+        snap->dram_energy[i] = (uint32_t)dram[i];
+        snap->pkg_power_limit[i] = limit[i];
+        snap->pkg_therm_status[i] = therm[i];
+    }
+    snap->energy_unit_joules = snapshot_cfg.energy_unit_joules;
+    snap->dram_energy_unit_joules = snapshot_cfg.dram_energy_unit_joules;
+    snap->power_unit_watts = snapshot_cfg.power_unit_watts;
+    snap->instructions = cpu_vals[SNAPSHOT_INSTRUCTIONS];
+    snap->core_cycles = cpu_vals[SNAPSHOT_CORE_CYCLES];
+    snap->ref_cycles = cpu_vals[SNAPSHOT_REF_CYCLES];
+    snap->aperf = cpu_vals[SNAPSHOT_APERF];
+    snap->mperf = cpu_vals[SNAPSHOT_MPERF];
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MSR_SNAPSHOT_H_INCLUDE
+#define MSR_SNAPSHOT_H_INCLUDE
+
+#include <sys/types.h>
+
+#include <variorum_snapshot.h>
+
+/// @brief List of per-CPU registers read into a snapshot, in the order of
+/// struct variorum_snapshot.
+enum msr_snapshot_cpu_e
+{
+    SNAPSHOT_INSTRUCTIONS,
+    SNAPSHOT_CORE_CYCLES,
+    SNAPSHOT_REF_CYCLES,
+    SNAPSHOT_APERF,
+    SNAPSHOT_MPERF,
+    SNAPSHOT_CPU_MSRS
+};
+
+/// @brief Registers and devices a snapshot is armed with.
+struct msr_snapshot_config
+{
+    /// @brief printf format of the MSR device of a logical CPU, e.g.,
+    /// MSR_SAFE_PATH_FMT.
+    const char *cpu_path_fmt;
+    /// @brief Path of the batch device, or NULL to read with pread().
+    const char *batch_path;
+    /// @brief Number of logical CPUs.
+    unsigned ncpus;
+    /// @brief Number of sockets, up to VARIORUM_SNAPSHOT_MAX_SOCKETS.
+    unsigned nsockets;
+    /// @brief Logical CPU the socket-scope registers of each socket are read
+    /// on.
+    unsigned socket_cpu[VARIORUM_SNAPSHOT_MAX_SOCKETS];
+    /// @brief Package energy status register, or 0 if not available.
+    off_t pkg_energy_msr;
+    /// @brief DRAM energy status register, or 0 if not available.
+    off_t dram_energy_msr;
+    /// @brief Package power limit register, or 0 if not available.
+    off_t pkg_power_limit_msr;
+    /// @brief Package thermal status register, or 0 if not available.
+    off_t pkg_therm_status_msr;
+    /// @brief Per-CPU registers (enum msr_snapshot_cpu_e), 0 if not
+    /// available.
+    off_t cpu_msrs[SNAPSHOT_CPU_MSRS];
+    /// @brief Joules per package energy count.
+    double energy_unit_joules;
+    /// @brief Joules per DRAM energy count.
+    double dram_energy_unit_joules;
+    /// @brief Watts per power limit count.
+    double power_unit_watts;
+};
+
+/// @brief Open the devices of a snapshot and keep them open until
+/// msr_snapshot_disarm().
+///
+/// The batch device is used if it can be opened, else the MSR device of
+/// every logical CPU is opened. Arming again replaces the previous
+/// configuration. Not async-signal-safe.
+///
+/// @param [in] cfg Registers and devices to read.
+///
+/// @return 0 if successful, else VARIORUM_ERROR_INVAL for a bad
+/// configuration, or VARIORUM_ERROR_MSR_MODULE if the devices cannot be
+/// opened.
+int msr_snapshot_arm(
+    const struct msr_snapshot_config *cfg
+);
+
+/// @brief Read the armed registers of the calling CPU and of every socket.
+///
+/// Async-signal-safe: it only uses the descriptors opened when armed and the
+/// stack, takes no locks, does not allocate, does not print, and preserves
+/// errno.
+///
+/// @param [out] snap Snapshot.
+///
+/// @return 0 if successful, VARIORUM_ERROR_FEATURE_NOT_AVAILABLE if not
+/// armed, VARIORUM_ERROR_RUNTIME if the current CPU is unknown, else
+/// VARIORUM_ERROR_MSR_BATCH or VARIORUM_ERROR_MSR_READ if a register cannot
+/// be read.
+int msr_snapshot_read(
+    struct variorum_snapshot *snap
+);
+
+/// @brief Close the devices of a snapshot. Reads must have stopped, e.g.,
+/// the signal that reads snapshots must be blocked or ignored. Not
+/// async-signal-safe.
+void msr_snapshot_disarm(
+    void
+);
+
+#endif
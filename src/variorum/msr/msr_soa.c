@@ -0,0 +1,94 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <msr_soa.h>
+
+// On x86_64 every kernel is built for AVX-512, AVX2 and the baseline ISA,
+// and the loader picks the widest one the processor supports. Elsewhere
+// (e.g., NEON on aarch64) the baseline build is already vectorized.
+#if defined(__x86_64__) && defined(__linux__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define MSR_SOA_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+#ifndef MSR_SOA_KERNEL
+#define MSR_SOA_KERNEL
+#endif
+
+void *msr_soa_alloc(size_t n, size_t size)
+{
+    void *p = NULL;
+    size_t bytes = n * size;
+
+    // Round up so vector loops may touch the whole last cache line.
+    bytes = (bytes + MSR_SOA_ALIGN - 1) & ~((size_t)MSR_SOA_ALIGN - 1);
+    if (bytes == 0)
+    {
+        bytes = MSR_SOA_ALIGN;
+    }
+    if (posix_memalign(&p, MSR_SOA_ALIGN, bytes) != 0)
+    {
+        return NULL;
+    }
+    memset(p, 0, bytes);
+    return p;
+}
+
+uint64_t msr_soa_mask(int width)
+{
+    return (width > 0 && width < 64) ? (1ULL << width) - 1 : ~0ULL;
+}
+
+MSR_SOA_KERNEL
+void msr_soa_gather(unsigned n, uint64_t *const *view, uint64_t *out)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++)
+    {
+        out[i] = *view[i];
+    }
+}
+
+MSR_SOA_KERNEL
+void msr_soa_delta(unsigned n, uint64_t mask, const uint64_t *restrict now,
+                   const uint64_t *restrict old, uint64_t *restrict out)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++)
+    {
+        out[i] = (now[i] - old[i]) & mask;
+    }
+}
+
+MSR_SOA_KERNEL
+void msr_soa_delta_scale(unsigned n, uint64_t mask, double scale,
+                         const uint64_t *restrict now, const uint64_t *restrict old,
+                         double *restrict out)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++)
+    {
+        out[i] = scale * (double)((now[i] - old[i]) & mask);
+    }
+}
+
+MSR_SOA_KERNEL
+void msr_soa_accumulate(unsigned n, uint64_t mask, const uint64_t *restrict now,
+                        uint64_t *restrict last, uint64_t *restrict acc)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++)
+    {
+        acc[i] += (now[i] - last[i]) & mask;
+        last[i] = now[i];
+    }
+}
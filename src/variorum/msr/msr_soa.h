@@ -0,0 +1,107 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MSR_SOA_H_INCLUDE
+#define MSR_SOA_H_INCLUDE
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Alignment of the contiguous counter arrays, one cache line.
+#define MSR_SOA_ALIGN 64
+
+// Batch results land in struct msr_batch_op entries, 32 bytes apart, and the
+// per-thread storage structures only hold pointers to them. The functions
+// below gather those results into contiguous, cache-aligned arrays, one per
+// counter, so that deltas, wraparound correction and unit conversion of all
+// threads run as flat loops the compiler can vectorize. The pointer tables
+// remain the interface of the batch layer.
+
+/// @brief Allocate a zeroed array aligned to MSR_SOA_ALIGN.
+///
+/// @param [in] n Number of elements.
+/// @param [in] size Size of each element.
+///
+/// @return Pointer to the array, to be released with free(), or NULL if the
+/// allocation fails.
+void *msr_soa_alloc(
+    size_t n,
+    size_t size
+);
+
+/// @brief Get the mask applied to differences of a counter.
+///
+/// @param [in] width Bit width of the counter, e.g., 32 for RAPL energy
+///        status or 48 for the performance counters.
+///
+/// @return Mask covering the low width bits, or all bits if width is not in
+/// 1-63.
+uint64_t msr_soa_mask(
+    int width
+);
+
+/// @brief Copy batch results into a contiguous array.
+///
+/// @param [in] n Number of elements.
+/// @param [in] view Pointers to the batch results, e.g., the value array of a
+///        storage structure filled in by load_thread_batch().
+/// @param [out] out Contiguous array of n elements.
+void msr_soa_gather(
+    unsigned n,
+    uint64_t *const *view,
+    uint64_t *out
+);
+
+/// @brief Compute counter differences corrected for wraparound.
+///
+/// @param [in] n Number of elements.
+/// @param [in] mask Mask from msr_soa_mask() for the counter width.
+/// @param [in] now Current counter values.
+/// @param [in] old Previous counter values.
+/// @param [out] out (now - old) & mask for every element.
+void msr_soa_delta(
+    unsigned n,
+    uint64_t mask,
+    const uint64_t *now,
+    const uint64_t *old,
+    uint64_t *out
+);
+
+/// @brief Compute counter differences corrected for wraparound and convert
+/// them to a unit.
+///
+/// @param [in] n Number of elements.
+/// @param [in] mask Mask from msr_soa_mask() for the counter width.
+/// @param [in] scale Unit of one count, e.g., Joules per energy status unit,
+///        or 1.0 for plain counts.
+/// @param [in] now Current counter values.
+/// @param [in] old Previous counter values.
+/// @param [out] out scale * ((now - old) & mask) for every element.
+void msr_soa_delta_scale(
+    unsigned n,
+    uint64_t mask,
+    double scale,
+    const uint64_t *now,
+    const uint64_t *old,
+    double *out
+);
+
+/// @brief Add counter differences corrected for wraparound to 64-bit
+/// accumulators and advance the previous values.
+///
+/// @param [in] n Number of elements.
+/// @param [in] mask Mask from msr_soa_mask() for the counter width.
+/// @param [in] now Current counter values.
+/// @param [in,out] last Previous counter values, set to now on return.
+/// @param [in,out] acc Accumulators.
+void msr_soa_accumulate(
+    unsigned n,
+    uint64_t mask,
+    const uint64_t *now,
+    uint64_t *last,
+    uint64_t *acc
+);
+
+#endif
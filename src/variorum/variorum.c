@@ -16,6 +16,10 @@
 #include <config_architecture.h>
 #include <variorum.h>
 #include <variorum_error.h>
+#include <variorum_self_counters.h>
+#if defined(VARIORUM_WITH_INTEL_CPU) || defined(VARIORUM_WITH_AMD_CPU)
+#include <msr_snapshot.h>
+#endif
 
 #ifdef LIBJUSTIFY_FOUND
 #include <cprintf.h>
@@ -343,13 +347,610 @@ int variorum_cap_best_effort_node_power_limit(int node_power_limit)
                                __FUNCTION__, __LINE__);
         return 0;
     }
-    err = g_platform[i].variorum_cap_best_effort_node_power_limit(
-              node_power_limit);
+    err = g_platform[i].variorum_cap_best_effort_node_power_limit(
+              node_power_limit);
+    if (err)
+    {
+        return -1;
+    }
+
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_cap_gpu_power_ratio(int gpu_power_ratio)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_cap_gpu_power_ratio == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_cap_gpu_power_ratio(gpu_power_ratio);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_cap_each_socket_power_limit(int socket_power_limit)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_cap_each_socket_power_limit == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_cap_each_socket_power_limit(socket_power_limit);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_cap_each_core_frequency_limit(int core_freq_mhz)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_cap_each_core_frequency_limit == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_cap_each_core_frequency_limit(core_freq_mhz);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_cap_socket_frequency_limit(int socketid, int socket_freq_mhz)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_cap_socket_frequency_limit == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_cap_socket_frequency_limit(socketid,
+                socket_freq_mhz);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_cap_core_cstate_latency(int core_id, int max_latency_us)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_cap_core_cstate_latency == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_cap_core_cstate_latency(core_id, max_latency_us);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_cap_socket_cstate_latency(int socket_id, int max_latency_us)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_cap_socket_cstate_latency == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_cap_socket_cstate_latency(socket_id, max_latency_us);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_cap_node_cstate_latency(int max_latency_us)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_cap_node_cstate_latency == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_cap_node_cstate_latency(max_latency_us);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_cap_socket_pkg_cstate_limit(int socket_id, int limit)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_cap_socket_pkg_cstate_limit == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_cap_socket_pkg_cstate_limit(socket_id, limit);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_save_cstate_limits(void)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_save_cstate_limits == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_save_cstate_limits();
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_restore_cstate_limits(void)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_restore_cstate_limits == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_restore_cstate_limits();
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_get_prefetch_control(int *disable_bits)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_get_prefetch_control == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_get_prefetch_control(disable_bits);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_set_prefetch_control(const int *disable_bits)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_set_prefetch_control == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_set_prefetch_control(disable_bits);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_push_prefetch_control(const int *disable_bits)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_push_prefetch_control == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_push_prefetch_control(disable_bits);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_pop_prefetch_control(void)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_pop_prefetch_control == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_pop_prefetch_control();
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_cap_turbo_ratio_limit(int nbuckets, const int *bucket_cores,
+                                  const int *bucket_freq_mhz)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_cap_turbo_ratio_limit == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_cap_turbo_ratio_limit(nbuckets, bucket_cores,
+                bucket_freq_mhz);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_get_energy_perf_bias(int *epb)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_get_energy_perf_bias == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_get_energy_perf_bias(epb);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_set_energy_perf_bias(const int *epb)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_set_energy_perf_bias == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_set_energy_perf_bias(epb);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
     if (err)
     {
         return -1;
     }
+    return err;
+}
 
+int variorum_get_turbo_cores(int *enabled)
+{
+    int err = 0;
+    int i;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_get_turbo_cores == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            return 0;
+        }
+        err = g_platform[i].variorum_get_turbo_cores(enabled);
+        if (err)
+        {
+            return -1;
+        }
+    }
     err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
     if (err)
     {
@@ -358,7 +959,7 @@ int variorum_cap_best_effort_node_power_limit(int node_power_limit)
     return err;
 }
 
-int variorum_cap_gpu_power_ratio(int gpu_power_ratio)
+int variorum_enable_turbo_cores(const int *core_mask)
 {
     int err = 0;
     int i;
@@ -369,7 +970,7 @@ int variorum_cap_gpu_power_ratio(int gpu_power_ratio)
     }
     for (i = 0; i < P_NUM_PLATFORMS; i++)
     {
-        if (g_platform[i].variorum_cap_gpu_power_ratio == NULL)
+        if (g_platform[i].variorum_set_turbo_cores == NULL)
         {
             variorum_error_handler("Feature not yet implemented or is not supported",
                                    VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
@@ -377,7 +978,11 @@ int variorum_cap_gpu_power_ratio(int gpu_power_ratio)
                                    __FUNCTION__, __LINE__);
             return 0;
         }
-        err = g_platform[i].variorum_cap_gpu_power_ratio(gpu_power_ratio);
+        err = g_platform[i].variorum_set_turbo_cores(core_mask, 1);
+        if (err == VARIORUM_ERROR_FEATURE_NOT_AVAILABLE)
+        {
+            return err;
+        }
         if (err)
         {
             return -1;
@@ -391,7 +996,7 @@ int variorum_cap_gpu_power_ratio(int gpu_power_ratio)
     return err;
 }
 
-int variorum_cap_each_socket_power_limit(int socket_power_limit)
+int variorum_disable_turbo_cores(const int *core_mask)
 {
     int err = 0;
     int i;
@@ -402,7 +1007,7 @@ int variorum_cap_each_socket_power_limit(int socket_power_limit)
     }
     for (i = 0; i < P_NUM_PLATFORMS; i++)
     {
-        if (g_platform[i].variorum_cap_each_socket_power_limit == NULL)
+        if (g_platform[i].variorum_set_turbo_cores == NULL)
         {
             variorum_error_handler("Feature not yet implemented or is not supported",
                                    VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
@@ -410,7 +1015,11 @@ int variorum_cap_each_socket_power_limit(int socket_power_limit)
                                    __FUNCTION__, __LINE__);
             return 0;
         }
-        err = g_platform[i].variorum_cap_each_socket_power_limit(socket_power_limit);
+        err = g_platform[i].variorum_set_turbo_cores(core_mask, 0);
+        if (err == VARIORUM_ERROR_FEATURE_NOT_AVAILABLE)
+        {
+            return err;
+        }
         if (err)
         {
             return -1;
@@ -424,10 +1033,19 @@ int variorum_cap_each_socket_power_limit(int socket_power_limit)
     return err;
 }
 
-int variorum_cap_each_core_frequency_limit(int core_freq_mhz)
+int variorum_get_thread_fixed_counters(uint64_t *counts)
 {
     int err = 0;
     int i;
+
+    /* Self-monitoring reads the counters of the calling thread with rdpmc,
+     * without entering the library.
+     */
+    if (self_counters_thread_read(counts) == 0)
+    {
+        return 0;
+    }
+
     err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
     if (err)
     {
@@ -435,7 +1053,7 @@ int variorum_cap_each_core_frequency_limit(int core_freq_mhz)
     }
     for (i = 0; i < P_NUM_PLATFORMS; i++)
     {
-        if (g_platform[i].variorum_cap_each_core_frequency_limit == NULL)
+        if (g_platform[i].variorum_get_thread_fixed_counters == NULL)
         {
             variorum_error_handler("Feature not yet implemented or is not supported",
                                    VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
@@ -443,7 +1061,7 @@ int variorum_cap_each_core_frequency_limit(int core_freq_mhz)
                                    __FUNCTION__, __LINE__);
             return 0;
         }
-        err = g_platform[i].variorum_cap_each_core_frequency_limit(core_freq_mhz);
+        err = g_platform[i].variorum_get_thread_fixed_counters(counts);
         if (err)
         {
             return -1;
@@ -457,7 +1075,7 @@ int variorum_cap_each_core_frequency_limit(int core_freq_mhz)
     return err;
 }
 
-int variorum_cap_socket_frequency_limit(int socketid, int socket_freq_mhz)
+int variorum_arm_snapshot(void)
 {
     int err = 0;
     int i;
@@ -468,7 +1086,7 @@ int variorum_cap_socket_frequency_limit(int socketid, int socket_freq_mhz)
     }
     for (i = 0; i < P_NUM_PLATFORMS; i++)
     {
-        if (g_platform[i].variorum_cap_socket_frequency_limit == NULL)
+        if (g_platform[i].variorum_arm_snapshot == NULL)
         {
             variorum_error_handler("Feature not yet implemented or is not supported",
                                    VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
@@ -476,8 +1094,7 @@ int variorum_cap_socket_frequency_limit(int socketid, int socket_freq_mhz)
                                    __FUNCTION__, __LINE__);
             return 0;
         }
-        err = g_platform[i].variorum_cap_socket_frequency_limit(socketid,
-                socket_freq_mhz);
+        err = g_platform[i].variorum_arm_snapshot();
         if (err)
         {
             return -1;
@@ -491,6 +1108,27 @@ int variorum_cap_socket_frequency_limit(int socketid, int socket_freq_mhz)
     return err;
 }
 
+int variorum_read_snapshot(struct variorum_snapshot *snap)
+{
+    /* Called from signal handlers: no enter/exit, no error reporting, only
+     * the descriptors opened by variorum_arm_snapshot().
+     */
+#if defined(VARIORUM_WITH_INTEL_CPU) || defined(VARIORUM_WITH_AMD_CPU)
+    return msr_snapshot_read(snap);
+#else
+    (void)snap;
+    return VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED;
+#endif
+}
+
+int variorum_disarm_snapshot(void)
+{
+#if defined(VARIORUM_WITH_INTEL_CPU) || defined(VARIORUM_WITH_AMD_CPU)
+    msr_snapshot_disarm();
+#endif
+    return 0;
+}
+
 int variorum_cap_each_gpu_power_limit(int gpu_power_limit)
 {
     int err = 0;
@@ -1491,6 +2129,57 @@ int variorum_get_frequency_json(char **get_frequency_obj_str)
     return err;
 }
 
+int variorum_get_cstate_residency_json(char **get_cstate_obj_str)
+{
+    int err = 0;
+    int i;
+    char hostname[1024];
+    uint64_t ts;
+    struct timeval tv;
+    gethostname(hostname, 1024);
+    gettimeofday(&tv, NULL);
+
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+
+    json_t *get_cstate_obj = json_object();
+    json_t *node_obj = json_object();
+    json_object_set_new(get_cstate_obj, hostname, node_obj);
+
+    ts = tv.tv_sec * (uint64_t)1000000 + tv.tv_usec;
+    json_object_set_new(node_obj, "timestamp", json_integer(ts));
+
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_get_cstate_residency_json == NULL)
+        {
+            variorum_error_handler("Feature not yet implemented or is not supported",
+                                   VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                                   getenv("HOSTNAME"), __FILE__,
+                                   __FUNCTION__, __LINE__);
+            continue;
+        }
+        err = g_platform[i].variorum_get_cstate_residency_json(node_obj);
+        if (err)
+        {
+            printf("Error with variorum get C-state residency json platform %d\n", i);
+        }
+    }
+
+    *get_cstate_obj_str = json_dumps(get_cstate_obj, JSON_INDENT(4));
+    json_decref(get_cstate_obj);
+
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
 /*
 int variorum_get_gpu_power_json(char **get_power_obj_str)
 {
@@ -1768,6 +2457,190 @@ int variorum_get_energy_json(char **get_energy_obj_str)
     return err;
 }
 
+int variorum_get_metrics(struct variorum_metric_vector *metrics)
+{
+    int err = 0;
+    int i;
+    int supported = 0;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    // Skip platforms without metric support so the others still contribute.
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_get_metrics == NULL)
+        {
+            continue;
+        }
+        supported = 1;
+        err = g_platform[i].variorum_get_metrics(metrics);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    if (!supported)
+    {
+        variorum_error_handler("Feature not yet implemented or is not supported",
+                               VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                               getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_get_energy_metrics(struct variorum_metric_vector *metrics)
+{
+    int err = 0;
+    int i;
+    int supported = 0;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_get_energy_metrics == NULL)
+        {
+            continue;
+        }
+        supported = 1;
+        err = g_platform[i].variorum_get_energy_metrics(metrics);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return supported ? 0 : VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED;
+}
+
+int variorum_start_pmc_events(const char *events)
+{
+    int err = 0;
+    int i;
+    int supported = 0;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_start_pmc_events == NULL)
+        {
+            continue;
+        }
+        supported = 1;
+        err = g_platform[i].variorum_start_pmc_events(events);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    if (!supported)
+    {
+        variorum_error_handler("Feature not yet implemented or is not supported",
+                               VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                               getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_read_pmc_events(struct variorum_metric_vector *metrics)
+{
+    int err = 0;
+    int i;
+    int supported = 0;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_read_pmc_events == NULL)
+        {
+            continue;
+        }
+        supported = 1;
+        err = g_platform[i].variorum_read_pmc_events(metrics);
+        if (err)
+        {
+            return -1;
+        }
+    }
+    if (!supported)
+    {
+        variorum_error_handler("Feature not yet implemented or is not supported",
+                               VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                               getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
+int variorum_stop_pmc_events(void)
+{
+    int err = 0;
+    int i;
+    int supported = 0;
+    err = variorum_enter(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    for (i = 0; i < P_NUM_PLATFORMS; i++)
+    {
+        if (g_platform[i].variorum_stop_pmc_events == NULL)
+        {
+            continue;
+        }
+        supported = 1;
+        err = g_platform[i].variorum_stop_pmc_events();
+        if (err)
+        {
+            return -1;
+        }
+    }
+    if (!supported)
+    {
+        variorum_error_handler("Feature not yet implemented or is not supported",
+                               VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED,
+                               getenv("HOSTNAME"), __FILE__,
+                               __FUNCTION__, __LINE__);
+    }
+    err = variorum_exit(__FILE__, __FUNCTION__, __LINE__);
+    if (err)
+    {
+        return -1;
+    }
+    return err;
+}
+
 char *variorum_get_current_version()
 {
     return QuoteMacro(VARIORUM_VERSION);
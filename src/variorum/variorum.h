@@ -8,6 +8,9 @@
 
 #include <stdio.h>
 
+#include <variorum_metrics.h>
+#include <variorum_snapshot.h>
+
 /// @brief Collect power limits and energy usage for both the package and DRAM
 /// domains.
 ///
@@ -143,6 +146,156 @@ int variorum_cap_each_core_frequency_limit(int cpu_freq_mhz);
 /// not supported, otherwise -1
 int variorum_cap_socket_frequency_limit(int socketid, int socket_freq_mhz);
 
+/// @brief Limit the idle states of all logical CPUs of a core to those with
+/// an exit latency up to a limit.
+///
+/// Uses the cpuidle sysfs disable knobs. Polling is always allowed.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [in] core_id Index of the core.
+/// @param [in] max_latency_us Largest allowed exit latency in microseconds,
+/// or -1 to allow all idle states again.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_cap_core_cstate_latency(int core_id, int max_latency_us);
+
+/// @brief Limit the idle states of all cores of a socket to those with an
+/// exit latency up to a limit.
+///
+/// Uses the cpuidle sysfs disable knobs. Polling is always allowed.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [in] socket_id Index of the socket.
+/// @param [in] max_latency_us Largest allowed exit latency in microseconds,
+/// or -1 to allow all idle states again.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_cap_socket_cstate_latency(int socket_id, int max_latency_us);
+
+/// @brief Hold a wakeup latency limit for the whole node.
+///
+/// Uses the PM QoS interface /dev/cpu_dma_latency, which also limits idle
+/// states entered by the kernel on its own. The limit is held by this process
+/// until it is replaced, released with -1, restored with
+/// variorum_restore_cstate_limits(), or the process exits.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [in] max_latency_us Largest allowed wakeup latency in
+/// microseconds, or -1 to release the limit.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_cap_node_cstate_latency(int max_latency_us);
+
+/// @brief Set the deepest package C-state a socket may enter in
+/// MSR_PKG_CST_CONFIG_CONTROL.
+///
+/// The limit is a model-specific encoding of the package C-state limit field
+/// (bits 2:0, or bits 3:0 on Kaby Lake), see the Intel SDM for the model.
+/// Fails if the limit does not fit the field or if the BIOS has locked the
+/// register on any core.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [in] socket_id Index of the socket.
+/// @param [in] limit Encoding of the deepest allowed package C-state.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_cap_socket_pkg_cstate_limit(int socket_id, int limit);
+
+/// @brief Record the current C-state limits of the node.
+///
+/// Records the cpuidle disable knobs of all logical CPUs and
+/// MSR_PKG_CST_CONFIG_CONTROL of all cores in a file in /dev/shm, so that a
+/// job prolog or the start of a latency-sensitive region can change them and
+/// variorum_restore_cstate_limits(), in the same or a later process on the
+/// node, can put them back.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_save_cstate_limits(void);
+
+/// @brief Restore the C-state limits recorded by
+/// variorum_save_cstate_limits() and release a node-wide latency limit.
+///
+/// Only the knobs that changed since the save are written, so a restore
+/// after a short region is cheap. The saved limits are discarded once
+/// restored.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1, including when no limits were saved
+int variorum_restore_cstate_limits(void);
+
 /// @brief Cap the power usage identically of each GPU on the node.
 ///
 /// @supparch
@@ -535,6 +688,386 @@ int variorum_enable_turbo(void);
 /// not supported, otherwise -1
 int variorum_disable_turbo(void);
 
+/// @brief Disable the L2 hardware (streamer) prefetcher of a core.
+#define VARIORUM_PREFETCH_L2_STREAMER_DISABLE 0x1
+/// @brief Disable the L2 adjacent cache line prefetcher of a core.
+#define VARIORUM_PREFETCH_L2_ADJACENT_DISABLE 0x2
+/// @brief Disable the L1 data (DCU) streaming prefetcher of a core.
+#define VARIORUM_PREFETCH_DCU_DISABLE 0x4
+/// @brief Disable the L1 data (DCU IP) stride prefetcher of a core.
+#define VARIORUM_PREFETCH_DCU_IP_DISABLE 0x8
+
+/// @brief Get the hardware prefetcher disable bits of every core.
+///
+/// The bits are read from MSR_MISC_FEATURE_CONTROL of all cores with one
+/// batch.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [out] disable_bits Array with one entry per core (see
+/// variorum_get_num_cores()), set to a combination of the
+/// VARIORUM_PREFETCH_*_DISABLE bits.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_get_prefetch_control(int *disable_bits);
+
+/// @brief Set the hardware prefetcher disable bits of every core.
+///
+/// The bits are written to MSR_MISC_FEATURE_CONTROL of all cores with one
+/// batch. The other bits of the register are left unchanged.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [in] disable_bits Array with one entry per core, each a
+/// combination of the VARIORUM_PREFETCH_*_DISABLE bits, or 0 to enable all
+/// prefetchers of the core.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_set_prefetch_control(const int *disable_bits);
+
+/// @brief Record the hardware prefetcher disable bits of every core and set
+/// new ones until the matching variorum_pop_prefetch_control().
+///
+/// Scopes can be nested up to eight deep.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [in] disable_bits Array with one entry per core, as for
+/// variorum_set_prefetch_control().
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_push_prefetch_control(const int *disable_bits);
+
+/// @brief Restore the hardware prefetcher disable bits recorded by the
+/// matching variorum_push_prefetch_control().
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_pop_prefetch_control(void);
+
+#if defined(__GNUC__)
+/// @brief Cleanup handler of VARIORUM_PREFETCH_SCOPE().
+static inline void variorum_prefetch_scope_end(int *pushed)
+{
+    if (*pushed == 0)
+    {
+        variorum_pop_prefetch_control();
+    }
+}
+
+#define VARIORUM_PREFETCH_SCOPE_NAME2(line) variorum_prefetch_scope_##line
+#define VARIORUM_PREFETCH_SCOPE_NAME(line) VARIORUM_PREFETCH_SCOPE_NAME2(line)
+
+/// @brief Set the hardware prefetcher disable bits of every core until the
+/// end of the enclosing block, where the previous bits are restored.
+///
+/// @param [in] disable_bits Array with one entry per core, as for
+/// variorum_set_prefetch_control().
+#define VARIORUM_PREFETCH_SCOPE(disable_bits) \
+    int VARIORUM_PREFETCH_SCOPE_NAME(__LINE__) \
+        __attribute__((cleanup(variorum_prefetch_scope_end), unused)) = \
+            variorum_push_prefetch_control(disable_bits)
+#endif
+
+/// @brief Set the turbo frequency limits that apply when a given number of
+/// cores is active, on all sockets.
+///
+/// The new limits are written to MSR_TURBO_RATIO_LIMIT, and to
+/// MSR_TURBO_RATIO_LIMIT1 or MSR_TURBO_RATIO_LIMIT_CORES where the model has
+/// them, with one batch per register, then read back to verify them. On
+/// Skylake and later server parts the active core count of each bucket is
+/// programmable; on earlier models bucket i always applies to i + 1 active
+/// cores. Buckets past nbuckets are left unchanged. The registers are only
+/// writable on parts that report programmable ratio limits in
+/// MSR_PLATFORM_INFO.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+///
+/// @param [in] nbuckets Number of buckets to set, up to 8, or up to 16 on
+/// models with MSR_TURBO_RATIO_LIMIT1.
+/// @param [in] bucket_cores Active core count of each bucket in increasing
+/// order, or NULL to keep the current counts.
+/// @param [in] bucket_freq_mhz Turbo limit of each bucket in MHz, a multiple
+/// of 100 that does not increase from one bucket to the next.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_cap_turbo_ratio_limit(int nbuckets, const int *bucket_cores,
+                                   const int *bucket_freq_mhz);
+
+/// @brief Get the energy performance bias hint of every core.
+///
+/// The hint is read from IA32_ENERGY_PERF_BIAS of all cores with one batch.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [out] epb Array with one entry per core, receiving a hint from 0
+/// (highest performance) to 15 (most energy saving).
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_get_energy_perf_bias(int *epb);
+
+/// @brief Set the energy performance bias hint of every core.
+///
+/// The hint is written to IA32_ENERGY_PERF_BIAS of all hardware threads with
+/// one batch, then read back to verify it. The other bits of the register
+/// are left unchanged.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [in] epb Array with one entry per core, each a hint from 0
+/// (highest performance) to 15 (most energy saving).
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_set_energy_perf_bias(const int *epb);
+
+/// @brief Report whether turbo is allowed on every core.
+///
+/// A core reports turbo as disabled if any of its hardware threads has the
+/// turbo disengage bit of IA32_PERF_CTL set. All threads are read with one
+/// batch. This does not reflect the node-wide switch used by
+/// variorum_enable_turbo() and variorum_disable_turbo().
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [out] enabled Array with one entry per core, receiving 1 if turbo
+/// is allowed on the core and 0 otherwise.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_get_turbo_cores(int *enabled);
+
+/// @brief Allow turbo again on selected cores.
+///
+/// Clears the turbo disengage bit of IA32_PERF_CTL on all hardware threads
+/// of the selected cores. The current values are read with one batch, and
+/// only threads whose bit changes are written, with one batch. Cores not
+/// selected are not touched and nothing is printed. The bits are read back
+/// to verify them. Processors with HWP enabled ignore IA32_PERF_CTL, so
+/// nothing is written there.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [in] core_mask Array with one entry per core, non-zero for each
+/// core to change.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, VARIORUM_ERROR_FEATURE_NOT_AVAILABLE if HWP is enabled,
+/// otherwise -1
+int variorum_enable_turbo_cores(const int *core_mask);
+
+/// @brief Disengage turbo on selected cores.
+///
+/// Sets the turbo disengage bit of IA32_PERF_CTL on all hardware threads of
+/// the selected cores, so that they run at most at the base frequency. The
+/// current values are read with one batch, and only threads whose bit
+/// changes are written, with one batch. Cores not selected are not touched
+/// and nothing is printed. A later variorum_cap_each_core_frequency_limit()
+/// rewrites IA32_PERF_CTL and allows turbo again. The bits are read back to
+/// verify them. Processors with HWP enabled ignore IA32_PERF_CTL, so nothing
+/// is written there.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [in] core_mask Array with one entry per core, non-zero for each
+/// core to change.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, VARIORUM_ERROR_FEATURE_NOT_AVAILABLE if HWP is enabled,
+/// otherwise -1
+int variorum_disable_turbo_cores(const int *core_mask);
+
+/// @brief Read the instructions retired, core cycles and reference cycles of
+/// the calling thread.
+///
+/// On first use the calling thread opens perf_event counters on itself and
+/// maps their user pages, and from then on reads them with rdpmc in tens of
+/// nanoseconds, without a system call. These counters count user-level
+/// events of the thread only, are scaled if the kernel multiplexed them, and
+/// are released when the thread exits. If perf_event is not available, the
+/// fixed counters of the logical processor the thread runs on are read
+/// through the MSR batch interface instead.
+///
+/// The values are running totals; take the difference of two calls to
+/// measure a region.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [out] counts Array of three values receiving instructions retired,
+/// core cycles and reference cycles.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_get_thread_fixed_counters(uint64_t *counts);
+
+/// @brief Prepare variorum_read_snapshot() for use from signal handlers.
+///
+/// Enables the fixed counters on every logical processor, resolves the
+/// energy units, and opens MSR devices that stay open until
+/// variorum_disarm_snapshot(). Call it before installing the signal handler
+/// that reads snapshots. Not async-signal-safe.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Sapphire Rapids
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_arm_snapshot(void);
+
+/// @brief Read raw package and DRAM energy, package power limit and package
+/// thermal status of every socket, and the fixed counters and APERF/MPERF of
+/// the calling logical processor.
+///
+/// Async-signal-safe: it takes no locks, does not allocate, does not print,
+/// and preserves errno, so it can be called from a SIGPROF handler. Errors
+/// are returned, not reported. Requires variorum_arm_snapshot().
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [out] snap Snapshot of raw counter values.
+///
+/// @return 0 if successful, VARIORUM_ERROR_FEATURE_NOT_AVAILABLE if not
+/// armed, otherwise a negative variorum error code
+int variorum_read_snapshot(struct variorum_snapshot *snap);
+
+/// @brief Close the devices opened by variorum_arm_snapshot(). The signal
+/// that reads snapshots must be blocked or ignored first. Not
+/// async-signal-safe.
+///
+/// @return 0
+int variorum_disarm_snapshot(void);
+
 /****************/
 /* JSON Support */
 /****************/
@@ -719,6 +1252,151 @@ int variorum_get_frequency_json(char **get_frequency_obj_str);
 /// check for NULL strings.
 int variorum_get_energy_json(char **get_energy_obj_str);
 
+/// @brief Populate a string in JSON format with the package and core C-state
+/// residency of the node since the previous call.
+///
+/// Residency is reported as the percent of the interval each socket spent in
+/// each package C-state, and each core in each core C-state. The first call
+/// starts the interval and reports zero residency.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [out] get_cstate_obj_str String (passed by reference) containing
+/// the node-level C-state residency.
+///
+/// @return 0 if successful, otherwise -1. Note that feature not implemented
+/// returns a -1 for the JSON APIs so that users don't have to explicitly
+/// check for NULL strings.
+int variorum_get_cstate_residency_json(char **get_cstate_obj_str);
+
+/// @brief Sample all supported metrics of every platform into a single
+/// metric vector.
+///
+/// Samples are appended, so CPU and GPU metrics from one call (or from
+/// successive calls) share the same vector. Platforms that do not support the
+/// metric API are skipped.
+///
+/// @supparch
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+/// - AMD EPYC Milan
+/// - NVIDIA Volta
+///
+/// @param [in,out] metrics Metric vector initialized with
+/// variorum_metric_vector_init().
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_get_metrics(struct variorum_metric_vector *metrics);
+
+/// @brief Sample only the energy of every platform into a metric vector.
+///
+/// Only the energy counters are read; no counter is programmed, so this is
+/// safe to call periodically underneath an application's own performance
+/// counters. On Intel, energy_cpu_joules and energy_mem_joules of each socket
+/// are accumulated from the first call and do not wrap around as long as
+/// calls are less than a wrap period of the 32-bit energy counters apart
+/// (minutes at full power).
+///
+/// @supparch
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+/// - Intel Ice Lake
+/// - Intel Sapphire Rapids
+///
+/// @param [in,out] metrics Metric vector initialized with
+/// variorum_metric_vector_init().
+///
+/// @return 0 if successful, VARIORUM_ERROR_FEATURE_NOT_IMPLEMENTED if no
+/// platform supports it, otherwise -1
+int variorum_get_energy_metrics(struct variorum_metric_vector *metrics);
+
+/// @brief Program performance events on the general-purpose counters of all
+/// logical processors.
+///
+/// Events are given by name (events of the detected model such as
+/// INST_RETIRED.ANY_P, or architectural events such as LLC_MISSES) or as a
+/// raw r<hex> encoding of IA32_PERFEVTSELx, e.g., r01c2. Any number of events
+/// can be requested. If the events do not fit on the counters at once, they
+/// are split into groups that take turns on the counters, and counts are
+/// scaled to the full measurement time. Any previously started events are
+/// stopped first.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+///
+/// @param [in] events Comma-separated list of event names or raw encodings.
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_start_pmc_events(const char *events);
+
+/// @brief Append the scaled count of every started event on every logical
+/// processor to a metric vector.
+///
+/// Each read also moves to the next event group once the current group has
+/// been on the counters for VARIORUM_PMC_MUX_INTERVAL_MS milliseconds
+/// (default 10), so reads should be issued periodically when there are more
+/// events than counters. Events whose group has not run yet are omitted.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+///
+/// @param [in,out] metrics Metric vector initialized with
+/// variorum_metric_vector_init().
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_read_pmc_events(struct variorum_metric_vector *metrics);
+
+/// @brief Disable the counters used by the started events.
+///
+/// @supparch
+/// - Intel Sandy Bridge
+/// - Intel Ivy Bridge
+/// - Intel Haswell
+/// - Intel Broadwell
+/// - Intel Skylake
+/// - Intel Kaby Lake
+/// - Intel Cascade Lake
+/// - Intel Cooper Lake
+///
+/// @return 0 if successful or if feature has not been implemented or is
+/// not supported, otherwise -1
+int variorum_stop_pmc_events(void);
+
 /// @brief Returns Variorum version as a constant string.
 ///
 /// @supparch
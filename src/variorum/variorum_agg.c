@@ -0,0 +1,967 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <variorum_agg.h>
+#include <variorum_error.h>
+
+/// @brief "VAG1", first word of every message.
+#define AGG_MAGIC 0x31474156
+#define AGG_MSG_SAMPLE 1
+#define AGG_MSG_SUMMARY 2
+
+/// @brief Number of buckets that can be pending at the same time.
+#define AGG_WINDOW 64
+/// @brief Number of buckets a message may be ahead of the current bucket of
+/// the aggregator before it is dropped.
+#define AGG_MAX_AHEAD (AGG_WINDOW / 2)
+
+#define AGG_ADDR_LEN 256
+/// @brief Length of the port of a TCP address, including the terminator.
+#define AGG_PORT_LEN 16
+/// @brief Length of the host of a TCP address, so tcp:host:port fits in
+/// AGG_ADDR_LEN.
+#define AGG_HOST_LEN (AGG_ADDR_LEN - AGG_PORT_LEN - 8)
+#define AGG_RECV_LEN 8192
+
+/// @brief Bins per power of two, and the power of two of the first bin.
+#define AGG_BINS_PER_OCTAVE 8
+#define AGG_FIRST_OCTAVE -2
+
+struct agg_header
+{
+    uint32_t magic;
+    uint32_t type;
+};
+
+/// @brief Message of a node, 24 bytes.
+struct agg_sample_msg
+{
+    struct agg_header hdr;
+    uint64_t bucket;
+    double value;
+};
+
+/// @brief Message of an inner aggregator.
+struct agg_summary_msg
+{
+    struct agg_header hdr;
+    /// @brief Number of levels of aggregators in the subtree.
+    uint32_t height;
+    uint32_t reserved;
+    struct variorum_agg_summary summary;
+};
+
+struct agg_child
+{
+    int fd;
+    /// @brief Number of nodes below the child, as last reported.
+    uint32_t expected;
+    /// @brief Levels of aggregators of the child, 0 for a node.
+    uint32_t height;
+    /// @brief Last bucket received plus one, or 0 if none.
+    uint64_t watermark;
+    size_t used;
+    unsigned char buf[AGG_RECV_LEN];
+};
+
+struct agg_pending
+{
+    int used;
+    uint32_t contributors;
+    struct variorum_agg_summary summary;
+};
+
+struct variorum_agg
+{
+    int listen_fd;
+    int parent_fd;
+    char address[AGG_ADDR_LEN];
+    char parent_addr[AGG_ADDR_LEN];
+    char unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    unsigned interval_ms;
+    unsigned lateness_ms;
+    uint64_t parent_retry_ms;
+
+    /// @brief Poll entry 0 is the listening socket, entry i + 1 child i.
+    struct pollfd *pfds;
+    struct agg_child **children;
+    uint32_t nchildren;
+    uint32_t capacity;
+
+    /// @brief Lowest bucket not completed yet, or 0 before the first
+    /// message.
+    uint64_t next_bucket;
+    struct agg_pending pending[AGG_WINDOW];
+
+    variorum_agg_emit_fn emit;
+    void *emit_arg;
+    struct variorum_agg_stats stats;
+};
+
+static uint64_t agg_now_ms(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_REALTIME, &t);
+    return t.tv_sec * (uint64_t)1000 + t.tv_nsec / 1000000;
+}
+
+static int agg_bin(double value)
+{
+    int bin;
+
+    if (!(value > ldexp(1.0, AGG_FIRST_OCTAVE)))
+    {
+        return 0;
+    }
+    bin = (int)floor((log2(value) - AGG_FIRST_OCTAVE) * AGG_BINS_PER_OCTAVE);
+    return bin < VARIORUM_AGG_BINS ? bin : VARIORUM_AGG_BINS - 1;
+}
+
+void variorum_agg_summary_init(struct variorum_agg_summary *summary,
+                               uint64_t bucket)
+{
+    memset(summary, 0, sizeof(*summary));
+    summary->bucket = bucket;
+}
+
+void variorum_agg_summary_add(struct variorum_agg_summary *summary,
+                              double value)
+{
+    if (summary->nodes == 0 || value < summary->min)
+    {
+        summary->min = value;
+    }
+    if (summary->nodes == 0 || value > summary->max)
+    {
+        summary->max = value;
+    }
+    summary->nodes++;
+    summary->sum += value;
+    summary->hist[agg_bin(value)]++;
+}
+
+void variorum_agg_summary_merge(struct variorum_agg_summary *dst,
+                                const struct variorum_agg_summary *src)
+{
+    int i;
+
+    if (src->nodes == 0)
+    {
+        dst->expected += src->expected;
+        return;
+    }
+    if (dst->nodes == 0 || src->min < dst->min)
+    {
+        dst->min = src->min;
+    }
+    if (dst->nodes == 0 || src->max > dst->max)
+    {
+        dst->max = src->max;
+    }
+    dst->nodes += src->nodes;
+    dst->expected += src->expected;
+    dst->sum += src->sum;
+    for (i = 0; i < VARIORUM_AGG_BINS; i++)
+    {
+        dst->hist[i] += src->hist[i];
+    }
+}
+
+double variorum_agg_summary_percentile(const struct variorum_agg_summary
+                                       *summary, double percent)
+{
+    uint64_t rank;
+    uint64_t seen = 0;
+    double value;
+    int i;
+
+    if (summary->nodes == 0)
+    {
+        return 0.0;
+    }
+    rank = (uint64_t)ceil(percent / 100.0 * summary->nodes);
+    if (rank <= 1)
+    {
+        return summary->min;
+    }
+    if (rank >= summary->nodes)
+    {
+        return summary->max;
+    }
+    for (i = 0; i < VARIORUM_AGG_BINS - 1; i++)
+    {
+        seen += summary->hist[i];
+        if (seen >= rank)
+        {
+            break;
+        }
+    }
+    // Geometric center of the bin.
+    value = exp2((i + 0.5) / AGG_BINS_PER_OCTAVE + AGG_FIRST_OCTAVE);
+    if (value < summary->min)
+    {
+        value = summary->min;
+    }
+    if (value > summary->max)
+    {
+        value = summary->max;
+    }
+    return value;
+}
+
+uint64_t variorum_agg_bucket(uint64_t time_ms, unsigned interval_ms)
+{
+    return time_ms / (interval_ms != 0 ? interval_ms :
+                      VARIORUM_AGG_DEFAULT_INTERVAL_MS);
+}
+
+/// @brief Resolve unix:path or tcp:host:port.
+///
+/// @return Socket family, or -1 if the address is malformed.
+static int agg_parse(const char *addr, struct sockaddr_un *un, char *host,
+                     char *port)
+{
+    const char *colon;
+
+    if (addr == NULL)
+    {
+        return -1;
+    }
+    if (strncmp(addr, "unix:", 5) == 0)
+    {
+        if (strlen(addr + 5) == 0 || strlen(addr + 5) >= sizeof(un->sun_path))
+        {
+            return -1;
+        }
+        memset(un, 0, sizeof(*un));
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, addr + 5);
+        return AF_UNIX;
+    }
+    if (strncmp(addr, "tcp:", 4) == 0)
+    {
+        colon = strrchr(addr + 4, ':');
+        if (colon == NULL || colon == addr + 4 ||
+            (size_t)(colon - addr - 4) >= AGG_HOST_LEN || strlen(colon + 1) == 0 ||
+            strlen(colon + 1) >= AGG_PORT_LEN)
+        {
+            return -1;
+        }
+        memcpy(host, addr + 4, colon - addr - 4);
+        host[colon - addr - 4] = '\0';
+        strcpy(port, colon + 1);
+        return AF_INET;
+    }
+    return -1;
+}
+
+static void agg_set_tcp_options(int fd)
+{
+    int one = 1;
+
+    // Messages are small and latency matters more than packet count.
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+int variorum_agg_connect(const char *addr)
+{
+    struct sockaddr_un un;
+    struct addrinfo hints;
+    struct addrinfo *res;
+    struct addrinfo *ai;
+    char host[AGG_HOST_LEN];
+    char port[AGG_PORT_LEN];
+    int family;
+    int fd = -1;
+
+    family = agg_parse(addr, &un, host, port);
+    if (family == AF_UNIX)
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        if (connect(fd, (struct sockaddr *)&un, sizeof(un)) != 0)
+        {
+            close(fd);
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        return fd;
+    }
+    if (family != AF_INET)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &res) != 0)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    for (ai = res; ai != NULL; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC,
+                    ai->ai_protocol);
+        if (fd < 0)
+        {
+            continue;
+        }
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+        {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd < 0)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    agg_set_tcp_options(fd);
+    return fd;
+}
+
+static int agg_send(int fd, const void *msg, size_t len)
+{
+    const char *p = (const char *)msg;
+    ssize_t n;
+
+    while (len > 0)
+    {
+        n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int variorum_agg_send_sample(int fd, uint64_t bucket, double value)
+{
+    struct agg_sample_msg msg;
+
+    msg.hdr.magic = AGG_MAGIC;
+    msg.hdr.type = AGG_MSG_SAMPLE;
+    msg.bucket = bucket;
+    msg.value = value;
+    return agg_send(fd, &msg, sizeof(msg));
+}
+
+static int agg_send_summary(int fd, const struct variorum_agg_summary *summary,
+                            uint32_t height)
+{
+    struct agg_summary_msg msg;
+
+    msg.hdr.magic = AGG_MAGIC;
+    msg.hdr.type = AGG_MSG_SUMMARY;
+    msg.height = height;
+    msg.reserved = 0;
+    msg.summary = *summary;
+    return agg_send(fd, &msg, sizeof(msg));
+}
+
+int variorum_agg_send_summary(int fd, const struct variorum_agg_summary *summary)
+{
+    return agg_send_summary(fd, summary, 1);
+}
+
+/// @brief Levels of aggregators from the nodes up to this one.
+static uint32_t agg_height(const struct variorum_agg *agg)
+{
+    uint32_t height = 0;
+    uint32_t i;
+
+    for (i = 0; i < agg->nchildren; i++)
+    {
+        if (agg->children[i]->height > height)
+        {
+            height = agg->children[i]->height;
+        }
+    }
+    return height + 1;
+}
+
+static int agg_listen(struct variorum_agg *agg, const char *addr)
+{
+    struct sockaddr_un un;
+    struct sockaddr_storage bound;
+    socklen_t len = sizeof(bound);
+    struct addrinfo hints;
+    struct addrinfo *res;
+    char host[AGG_HOST_LEN];
+    char port[AGG_PORT_LEN];
+    char service[AGG_PORT_LEN];
+    int family;
+    int fd;
+    int one = 1;
+
+    family = agg_parse(addr, &un, host, port);
+    if (family == AF_UNIX)
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        unlink(un.sun_path);
+        if (bind(fd, (struct sockaddr *)&un, sizeof(un)) != 0 ||
+            listen(fd, SOMAXCONN) != 0)
+        {
+            close(fd);
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        strcpy(agg->unix_path, un.sun_path);
+        snprintf(agg->address, AGG_ADDR_LEN, "%s", addr);
+        agg->listen_fd = fd;
+        return 0;
+    }
+    if (family != AF_INET)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(host, port, &hints, &res) != 0)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    fd = socket(res->ai_family, res->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                res->ai_protocol);
+    if (fd < 0)
+    {
+        freeaddrinfo(res);
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, res->ai_addr, res->ai_addrlen) != 0 ||
+        listen(fd, SOMAXCONN) != 0 ||
+        getsockname(fd, (struct sockaddr *)&bound, &len) != 0 ||
+        getnameinfo((struct sockaddr *)&bound, len, NULL, 0, service,
+                    sizeof(service), NI_NUMERICSERV) != 0)
+    {
+        freeaddrinfo(res);
+        close(fd);
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    freeaddrinfo(res);
+    snprintf(agg->address, AGG_ADDR_LEN, "tcp:%s:%s", host, service);
+    agg->listen_fd = fd;
+    return 0;
+}
+
+int variorum_agg_create(const char *listen_addr, const char *parent_addr,
+                        unsigned interval_ms, unsigned lateness_ms,
+                        struct variorum_agg **agg)
+{
+    struct variorum_agg *a;
+    int rc;
+
+    *agg = NULL;
+    a = (struct variorum_agg *) calloc(1, sizeof(struct variorum_agg));
+    if (a == NULL)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    a->interval_ms = interval_ms != 0 ? interval_ms :
+                     VARIORUM_AGG_DEFAULT_INTERVAL_MS;
+    a->lateness_ms = lateness_ms != 0 ? lateness_ms : 2 * a->interval_ms;
+    a->listen_fd = -1;
+    a->parent_fd = -1;
+    a->capacity = 16;
+    a->pfds = (struct pollfd *) malloc((a->capacity + 1) * sizeof(struct pollfd));
+    a->children = (struct agg_child **) malloc(a->capacity *
+                  sizeof(struct agg_child *));
+    if (a->pfds == NULL || a->children == NULL)
+    {
+        variorum_agg_destroy(a);
+        return VARIORUM_ERROR_RUNTIME;
+    }
+
+    rc = agg_listen(a, listen_addr);
+    if (rc != 0)
+    {
+        variorum_agg_destroy(a);
+        return rc;
+    }
+    a->pfds[0].fd = a->listen_fd;
+    a->pfds[0].events = POLLIN;
+
+    if (parent_addr != NULL)
+    {
+        if (strlen(parent_addr) >= AGG_ADDR_LEN)
+        {
+            variorum_agg_destroy(a);
+            return VARIORUM_ERROR_INVAL;
+        }
+        strcpy(a->parent_addr, parent_addr);
+        a->parent_fd = variorum_agg_connect(parent_addr);
+        if (a->parent_fd < 0)
+        {
+            rc = a->parent_fd;
+            a->parent_fd = -1;
+            variorum_agg_destroy(a);
+            return rc;
+        }
+    }
+    *agg = a;
+    return 0;
+}
+
+void variorum_agg_set_callback(struct variorum_agg *agg,
+                               variorum_agg_emit_fn emit, void *arg)
+{
+    agg->emit = emit;
+    agg->emit_arg = arg;
+}
+
+const char *variorum_agg_address(const struct variorum_agg *agg)
+{
+    return agg->address;
+}
+
+static void agg_emit(struct variorum_agg *agg, struct agg_pending *p)
+{
+    uint64_t now;
+    uint32_t i;
+
+    p->summary.expected = 0;
+    for (i = 0; i < agg->nchildren; i++)
+    {
+        p->summary.expected += agg->children[i]->expected;
+    }
+    agg->stats.buckets++;
+    if (p->contributors < agg->nchildren)
+    {
+        agg->stats.partial++;
+    }
+    if (agg->emit != NULL)
+    {
+        agg->emit(&p->summary, agg->emit_arg);
+    }
+
+    if (agg->parent_addr[0] != '\0' && agg->parent_fd < 0)
+    {
+        // Reconnect to a parent that went away at most once per bucket.
+        now = agg_now_ms();
+        if (now >= agg->parent_retry_ms)
+        {
+            agg->parent_retry_ms = now + agg->interval_ms;
+            agg->parent_fd = variorum_agg_connect(agg->parent_addr);
+            if (agg->parent_fd < 0)
+            {
+                agg->parent_fd = -1;
+            }
+        }
+    }
+    if (agg->parent_fd >= 0 &&
+        agg_send_summary(agg->parent_fd, &p->summary, agg_height(agg)) != 0)
+    {
+        close(agg->parent_fd);
+        agg->parent_fd = -1;
+    }
+}
+
+/// @brief Complete the buckets that every child is past or whose deadline
+/// passed, in order. With force, complete all pending buckets.
+static void agg_complete(struct variorum_agg *agg, int force)
+{
+    struct agg_pending *p;
+    uint64_t now = agg_now_ms();
+    uint64_t lateness;
+    uint64_t b;
+    uint32_t i;
+    int done;
+
+    if (agg->next_bucket == 0)
+    {
+        return;
+    }
+    // Every level waits longer than the one below, so the summaries of
+    // children that completed a bucket on their deadline are not late.
+    lateness = (uint64_t)agg->lateness_ms * agg_height(agg);
+    for (;;)
+    {
+        b = agg->next_bucket;
+        p = &agg->pending[b % AGG_WINDOW];
+        done = agg->nchildren > 0;
+        for (i = 0; i < agg->nchildren && done; i++)
+        {
+            done = agg->children[i]->watermark > b;
+        }
+        if (!done && (b + 1) * agg->interval_ms + lateness <= now)
+        {
+            done = 1;
+        }
+        if (!done && force)
+        {
+            // Stop after the last pending bucket.
+            done = 0;
+            for (i = 0; i < AGG_WINDOW && !done; i++)
+            {
+                done = agg->pending[i].used;
+            }
+        }
+        if (!done)
+        {
+            return;
+        }
+        if (p->used)
+        {
+            agg_emit(agg, p);
+            p->used = 0;
+        }
+        agg->next_bucket++;
+    }
+}
+
+static struct agg_pending *agg_slot(struct variorum_agg *agg, uint64_t bucket)
+{
+    struct agg_pending *p;
+    uint64_t first;
+    uint64_t b;
+
+    if (agg->next_bucket == 0)
+    {
+        agg->next_bucket = bucket;
+    }
+    if (bucket < agg->next_bucket)
+    {
+        agg->stats.late++;
+        return NULL;
+    }
+    // Messages are at most AGG_MAX_AHEAD buckets past the current one, so
+    // this only happens when the lateness exceeds the rest of the window. The
+    // oldest buckets are then completed early, in order.
+    if (bucket >= agg->next_bucket + AGG_WINDOW)
+    {
+        first = bucket - AGG_WINDOW + 1;
+        for (b = agg->next_bucket;
+             b < first && b < agg->next_bucket + AGG_WINDOW; b++)
+        {
+            p = &agg->pending[b % AGG_WINDOW];
+            if (p->used)
+            {
+                agg_emit(agg, p);
+                p->used = 0;
+            }
+        }
+        agg->next_bucket = first;
+    }
+    p = &agg->pending[bucket % AGG_WINDOW];
+    if (!p->used)
+    {
+        variorum_agg_summary_init(&p->summary, bucket);
+        p->contributors = 0;
+        p->used = 1;
+    }
+    p->contributors++;
+    return p;
+}
+
+/// @brief Handle the complete messages in the buffer of a child.
+///
+/// @return 0, or -1 if the child sent a malformed message.
+static int agg_parse_child(struct variorum_agg *agg, struct agg_child *c)
+{
+    struct agg_sample_msg sample;
+    struct agg_summary_msg summary;
+    struct agg_header hdr;
+    struct agg_pending *p;
+    size_t off = 0;
+    uint64_t bucket;
+    size_t len;
+
+    while (c->used - off >= sizeof(hdr))
+    {
+        memcpy(&hdr, c->buf + off, sizeof(hdr));
+        if (hdr.magic != AGG_MAGIC)
+        {
+            return -1;
+        }
+        if (hdr.type == AGG_MSG_SAMPLE)
+        {
+            len = sizeof(sample);
+        }
+        else if (hdr.type == AGG_MSG_SUMMARY)
+        {
+            len = sizeof(summary);
+        }
+        else
+        {
+            return -1;
+        }
+        if (c->used - off < len)
+        {
+            break;
+        }
+
+        agg->stats.messages++;
+        if (hdr.type == AGG_MSG_SAMPLE)
+        {
+            memcpy(&sample, c->buf + off, len);
+            bucket = sample.bucket;
+        }
+        else
+        {
+            memcpy(&summary, c->buf + off, len);
+            bucket = summary.summary.bucket;
+        }
+        // A child with a skewed clock or a corrupt message must not move the
+        // window, or every later message would be late.
+        if (bucket > variorum_agg_bucket(agg_now_ms(), agg->interval_ms) +
+            AGG_MAX_AHEAD)
+        {
+            agg->stats.ahead++;
+            off += len;
+            continue;
+        }
+        if (hdr.type == AGG_MSG_SAMPLE)
+        {
+            p = agg_slot(agg, bucket);
+            if (p != NULL)
+            {
+                variorum_agg_summary_add(&p->summary, sample.value);
+            }
+        }
+        else
+        {
+            c->expected = summary.summary.expected;
+            c->height = summary.height;
+            p = agg_slot(agg, bucket);
+            if (p != NULL)
+            {
+                variorum_agg_summary_merge(&p->summary, &summary.summary);
+            }
+        }
+        if (bucket + 1 > c->watermark)
+        {
+            c->watermark = bucket + 1;
+        }
+        off += len;
+    }
+    memmove(c->buf, c->buf + off, c->used - off);
+    c->used -= off;
+    return 0;
+}
+
+static void agg_remove_child(struct variorum_agg *agg, uint32_t i)
+{
+    close(agg->children[i]->fd);
+    free(agg->children[i]);
+    agg->nchildren--;
+    agg->children[i] = agg->children[agg->nchildren];
+    agg->pfds[i + 1] = agg->pfds[agg->nchildren + 1];
+}
+
+static void agg_accept(struct variorum_agg *agg)
+{
+    struct agg_child *c;
+    struct sockaddr_storage peer;
+    socklen_t len;
+    void *pfds;
+    void *children;
+    int fd;
+
+    for (;;)
+    {
+        len = sizeof(peer);
+        fd = accept(agg->listen_fd, (struct sockaddr *)&peer, &len);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        if (peer.ss_family != AF_UNIX)
+        {
+            agg_set_tcp_options(fd);
+        }
+
+        if (agg->nchildren == agg->capacity)
+        {
+            pfds = realloc(agg->pfds, (2 * agg->capacity + 1) *
+                           sizeof(struct pollfd));
+            if (pfds != NULL)
+            {
+                agg->pfds = (struct pollfd *)pfds;
+            }
+            children = realloc(agg->children, 2 * agg->capacity *
+                               sizeof(struct agg_child *));
+            if (children != NULL)
+            {
+                agg->children = (struct agg_child **)children;
+            }
+            if (pfds == NULL || children == NULL)
+            {
+                close(fd);
+                return;
+            }
+            agg->capacity *= 2;
+        }
+        c = (struct agg_child *) calloc(1, sizeof(struct agg_child));
+        if (c == NULL)
+        {
+            close(fd);
+            return;
+        }
+        c->fd = fd;
+        c->expected = 1;
+        agg->children[agg->nchildren] = c;
+        agg->pfds[agg->nchildren + 1].fd = fd;
+        agg->pfds[agg->nchildren + 1].events = POLLIN;
+        agg->pfds[agg->nchildren + 1].revents = 0;
+        agg->nchildren++;
+    }
+}
+
+static void agg_receive(struct variorum_agg *agg, uint32_t i)
+{
+    struct agg_child *c = agg->children[i];
+    ssize_t n;
+
+    for (;;)
+    {
+        n = recv(c->fd, c->buf + c->used, AGG_RECV_LEN - c->used, 0);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return;
+        }
+        if (n <= 0)
+        {
+            agg_remove_child(agg, i);
+            return;
+        }
+        c->used += n;
+        if (agg_parse_child(agg, c) != 0)
+        {
+            agg_remove_child(agg, i);
+            return;
+        }
+    }
+}
+
+int variorum_agg_run(struct variorum_agg *agg, int timeout_ms)
+{
+    uint64_t deadline = agg_now_ms() + (timeout_ms > 0 ? timeout_ms : 0);
+    uint64_t now;
+    uint32_t i;
+    int wait;
+    int n;
+
+    do
+    {
+        now = agg_now_ms();
+        // Wake up at least every quarter bucket to complete late buckets.
+        wait = now < deadline ? (int)(deadline - now) : 0;
+        if (wait > (int)agg->interval_ms / 4)
+        {
+            wait = agg->interval_ms / 4;
+        }
+        n = poll(agg->pfds, agg->nchildren + 1, wait);
+        if (n < 0 && errno != EINTR)
+        {
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        if (n > 0)
+        {
+            // Walk backwards, as removing a child moves the last one to its
+            // place.
+            for (i = agg->nchildren; i > 0; i--)
+            {
+                if (agg->pfds[i].revents != 0)
+                {
+                    agg_receive(agg, i - 1);
+                }
+            }
+            if (agg->pfds[0].revents & POLLIN)
+            {
+                agg_accept(agg);
+            }
+        }
+        agg_complete(agg, 0);
+    }
+    while (agg_now_ms() < deadline);
+    return 0;
+}
+
+void variorum_agg_flush(struct variorum_agg *agg)
+{
+    agg_complete(agg, 1);
+}
+
+void variorum_agg_get_stats(const struct variorum_agg *agg,
+                            struct variorum_agg_stats *stats)
+{
+    *stats = agg->stats;
+    stats->children = agg->nchildren;
+}
+
+void variorum_agg_destroy(struct variorum_agg *agg)
+{
+    uint32_t i;
+
+    if (agg == NULL)
+    {
+        return;
+    }
+    for (i = 0; i < agg->nchildren; i++)
+    {
+        close(agg->children[i]->fd);
+        free(agg->children[i]);
+    }
+    if (agg->listen_fd >= 0)
+    {
+        close(agg->listen_fd);
+    }
+    if (agg->unix_path[0] != '\0')
+    {
+        unlink(agg->unix_path);
+    }
+    if (agg->parent_fd >= 0)
+    {
+        close(agg->parent_fd);
+    }
+    free(agg->children);
+    free(agg->pfds);
+    free(agg);
+}
@@ -0,0 +1,244 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef VARIORUM_AGG_H_INCLUDE
+#define VARIORUM_AGG_H_INCLUDE
+
+#include <stdint.h>
+
+/// @brief Number of histogram bins of a summary, 8 per power of two from
+/// 0.25 to 16384.
+#define VARIORUM_AGG_BINS 128
+
+/// @brief Bucket length used when none is given, in milliseconds.
+#define VARIORUM_AGG_DEFAULT_INTERVAL_MS 100
+
+/// @brief Values of one metric from any number of nodes in one time bucket,
+/// reduced so that summaries of disjoint sets of nodes merge exactly.
+struct variorum_agg_summary
+{
+    /// @brief Time bucket, i.e., the start of the bucket in milliseconds
+    /// since the epoch divided by the bucket length.
+    uint64_t bucket;
+    /// @brief Number of values reduced.
+    uint32_t nodes;
+    /// @brief Number of nodes connected to the subtree when the bucket was
+    /// completed. Fewer nodes than expected means some missed the bucket.
+    uint32_t expected;
+    /// @brief Sum of the values.
+    double sum;
+    /// @brief Smallest value.
+    double min;
+    /// @brief Largest value.
+    double max;
+    /// @brief Number of values in every logarithmic bin, used to estimate
+    /// percentiles.
+    uint32_t hist[VARIORUM_AGG_BINS];
+};
+
+/// @brief Handle of an aggregator, i.e., an inner node or the root of the
+/// tree.
+struct variorum_agg;
+
+/// @brief Function called with every summary an aggregator completes.
+typedef void (*variorum_agg_emit_fn)(
+    const struct variorum_agg_summary *summary,
+    void *arg
+);
+
+/// @brief Counters of an aggregator.
+struct variorum_agg_stats
+{
+    /// @brief Number of connected children.
+    uint32_t children;
+    /// @brief Number of messages received from children.
+    uint64_t messages;
+    /// @brief Number of messages dropped because their bucket was already
+    /// complete.
+    uint64_t late;
+    /// @brief Number of messages dropped because their bucket was too far
+    /// ahead of the current bucket of the aggregator.
+    uint64_t ahead;
+    /// @brief Number of buckets completed.
+    uint64_t buckets;
+    /// @brief Number of completed buckets to which not every child
+    /// contributed.
+    uint64_t partial;
+};
+
+/// @brief Start an empty summary.
+///
+/// @param [out] summary Summary.
+/// @param [in] bucket Time bucket.
+void variorum_agg_summary_init(
+    struct variorum_agg_summary *summary,
+    uint64_t bucket
+);
+
+/// @brief Add the value of one node to a summary.
+///
+/// @param [in,out] summary Summary.
+/// @param [in] value Value.
+void variorum_agg_summary_add(
+    struct variorum_agg_summary *summary,
+    double value
+);
+
+/// @brief Merge a summary of other nodes into a summary.
+///
+/// @param [in,out] dst Summary.
+/// @param [in] src Summary of the other nodes.
+void variorum_agg_summary_merge(
+    struct variorum_agg_summary *dst,
+    const struct variorum_agg_summary *src
+);
+
+/// @brief Estimate a percentile of the values of a summary from its
+/// histogram. The estimate is within 5% of a value of the bin that holds the
+/// percentile, and between min and max.
+///
+/// @param [in] summary Summary.
+/// @param [in] percent Percentile, from 0 to 100.
+///
+/// @return Estimate, or 0 if the summary is empty.
+double variorum_agg_summary_percentile(
+    const struct variorum_agg_summary *summary,
+    double percent
+);
+
+/// @brief Time bucket of a time.
+///
+/// @param [in] time_ms Time in milliseconds since the epoch.
+/// @param [in] interval_ms Bucket length in milliseconds.
+///
+/// @return Time bucket.
+uint64_t variorum_agg_bucket(
+    uint64_t time_ms,
+    unsigned interval_ms
+);
+
+/// @brief Connect to an aggregator.
+///
+/// @param [in] addr Address of the aggregator, either unix:path for a Unix
+///        domain socket or tcp:host:port.
+///
+/// @return File descriptor of the connection, else a negative variorum
+/// error code.
+int variorum_agg_connect(
+    const char *addr
+);
+
+/// @brief Send the value of the calling node for a time bucket to its
+/// aggregator. A node sends at most one value per bucket, in increasing
+/// order of buckets.
+///
+/// @param [in] fd Connection returned by variorum_agg_connect().
+/// @param [in] bucket Time bucket.
+/// @param [in] value Value.
+///
+/// @return 0 if successful, else VARIORUM_ERROR_RUNTIME.
+int variorum_agg_send_sample(
+    int fd,
+    uint64_t bucket,
+    double value
+);
+
+/// @brief Send a summary to an aggregator, as inner nodes of the tree do.
+///
+/// @param [in] fd Connection returned by variorum_agg_connect().
+/// @param [in] summary Summary.
+///
+/// @return 0 if successful, else VARIORUM_ERROR_RUNTIME.
+int variorum_agg_send_summary(
+    int fd,
+    const struct variorum_agg_summary *summary
+);
+
+/// @brief Create an aggregator, which reduces the samples and summaries of
+/// its children per time bucket, and forwards every completed bucket to its
+/// parent and to a callback.
+///
+/// A bucket is complete once every child sent the bucket or a later one, or
+/// lateness_ms after its end for every level of aggregators from the nodes
+/// up to this one. Later messages for it are dropped and counted, as are
+/// messages for buckets more than 32 buckets ahead of the clock of the
+/// aggregator.
+///
+/// @param [in] listen_addr Address children connect to, either unix:path or
+///        tcp:host:port. tcp:host:0 picks a free port, see
+///        variorum_agg_address().
+/// @param [in] parent_addr Address of the parent, or NULL for the root.
+/// @param [in] interval_ms Bucket length in milliseconds, or 0 for
+///        VARIORUM_AGG_DEFAULT_INTERVAL_MS.
+/// @param [in] lateness_ms Time per level after the end of a bucket after
+///        which it is completed without the missing children, or 0 for twice
+///        the bucket length.
+/// @param [out] agg Handle, released with variorum_agg_destroy().
+///
+/// @return 0 if successful, else a negative variorum error code.
+int variorum_agg_create(
+    const char *listen_addr,
+    const char *parent_addr,
+    unsigned interval_ms,
+    unsigned lateness_ms,
+    struct variorum_agg **agg
+);
+
+/// @brief Set the function called with every completed summary.
+///
+/// @param [in,out] agg Handle.
+/// @param [in] emit Function, or NULL.
+/// @param [in] arg Argument passed to the function.
+void variorum_agg_set_callback(
+    struct variorum_agg *agg,
+    variorum_agg_emit_fn emit,
+    void *arg
+);
+
+/// @brief Address an aggregator listens on, with the port it picked.
+///
+/// @param [in] agg Handle.
+///
+/// @return Address, valid until variorum_agg_destroy().
+const char *variorum_agg_address(
+    const struct variorum_agg *agg
+);
+
+/// @brief Accept children, receive their messages and complete buckets for
+/// up to timeout_ms.
+///
+/// @param [in,out] agg Handle.
+/// @param [in] timeout_ms Time to run in milliseconds.
+///
+/// @return 0 if successful, else a negative variorum error code.
+int variorum_agg_run(
+    struct variorum_agg *agg,
+    int timeout_ms
+);
+
+/// @brief Complete all pending buckets, e.g., before shutting down.
+///
+/// @param [in,out] agg Handle.
+void variorum_agg_flush(
+    struct variorum_agg *agg
+);
+
+/// @brief Counters of an aggregator.
+///
+/// @param [in] agg Handle.
+/// @param [out] stats Counters.
+void variorum_agg_get_stats(
+    const struct variorum_agg *agg,
+    struct variorum_agg_stats *stats
+);
+
+/// @brief Close all connections of an aggregator and release it.
+///
+/// @param [in] agg Handle.
+void variorum_agg_destroy(
+    struct variorum_agg *agg
+);
+
+#endif
@@ -0,0 +1,324 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <variorum_error.h>
+#include <variorum_flight.h>
+
+/// @brief Package power limit #1, bits 14:0 of MSR_PKG_POWER_LIMIT.
+#define PKG_POWER_LIMIT_1_MASK 0x7FFFULL
+
+struct variorum_flight
+{
+    struct variorum_flight_config cfg;
+    /// @brief Ring of recorded samples, sample seq in slot seq % capacity.
+    struct variorum_snapshot *ring;
+    uint64_t capacity;
+    /// @brief Number of samples recorded, published after the slot is
+    /// written so that readers can tell overwritten samples.
+    uint64_t head;
+    /// @brief Window of the trigger whose samples after it are being
+    /// recorded, if open.
+    struct variorum_flight_event event;
+    int open;
+    /// @brief Whether power was above the threshold at the last sample, so
+    /// that power triggers once when it goes above.
+    int power_high;
+    volatile sig_atomic_t user;
+};
+
+/// @brief Package and DRAM power of a socket from the energy read in two
+/// snapshots. Energy counters are 32 bits wide and wrap.
+static void socket_power(const struct variorum_snapshot *from,
+                         const struct variorum_snapshot *to, unsigned socket,
+                         double *pkg_watts, double *dram_watts)
+{
+    double seconds = (to->timestamp_ns - from->timestamp_ns) / 1e9;
+
+    if (seconds <= 0.0)
+    {
+        *pkg_watts = 0.0;
+        *dram_watts = 0.0;
+        return;
+    }
+    *pkg_watts = (uint32_t)(to->pkg_energy[socket] - from->pkg_energy[socket]) *
+                 to->energy_unit_joules / seconds;
+    *dram_watts = (uint32_t)(to->dram_energy[socket] -
+                             from->dram_energy[socket]) *
+                  to->dram_energy_unit_joules / seconds;
+}
+
+/// @brief Causes of triggers at the sample just recorded as seq.
+static uint32_t check_triggers(struct variorum_flight *f, uint64_t seq)
+{
+    const struct variorum_snapshot *snap = &f->ring[seq % f->capacity];
+    const struct variorum_snapshot *prev;
+    uint64_t base;
+    uint32_t reasons = 0;
+    double pkg;
+    double dram;
+    double watts = 0.0;
+    unsigned i;
+
+    if (f->user)
+    {
+        f->user = 0;
+        reasons |= VARIORUM_FLIGHT_USER;
+    }
+    if (seq == 0)
+    {
+        for (i = 0; i < snap->nsockets; i++)
+        {
+            if (snap->pkg_therm_status[i] & f->cfg.therm_mask)
+            {
+                reasons |= VARIORUM_FLIGHT_THERMAL;
+            }
+        }
+        return reasons;
+    }
+
+    prev = &f->ring[(seq - 1) % f->capacity];
+    for (i = 0; i < snap->nsockets; i++)
+    {
+        if (snap->pkg_therm_status[i] & ~prev->pkg_therm_status[i] &
+            f->cfg.therm_mask)
+        {
+            reasons |= VARIORUM_FLIGHT_THERMAL;
+        }
+        if (f->cfg.cap_changes &&
+            snap->pkg_power_limit[i] != prev->pkg_power_limit[i])
+        {
+            reasons |= VARIORUM_FLIGHT_CAP;
+        }
+    }
+
+    if (f->cfg.power_watts > 0.0)
+    {
+        base = seq > f->cfg.power_window ? seq - f->cfg.power_window : 0;
+        for (i = 0; i < snap->nsockets; i++)
+        {
+            socket_power(&f->ring[base % f->capacity], snap, i, &pkg, &dram);
+            watts += pkg;
+        }
+        if (watts > f->cfg.power_watts && !f->power_high)
+        {
+            reasons |= VARIORUM_FLIGHT_POWER;
+        }
+        f->power_high = watts > f->cfg.power_watts;
+    }
+    return reasons;
+}
+
+int variorum_flight_create(const struct variorum_flight_config *cfg,
+                           struct variorum_flight **flight)
+{
+    struct variorum_flight *f;
+    uint64_t window;
+
+    if (cfg == NULL || flight == NULL || cfg->power_window == 0 ||
+        cfg->power_watts < 0.0)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    window = (uint64_t)cfg->before + cfg->after + 1;
+
+    f = (struct variorum_flight *) calloc(1, sizeof(struct variorum_flight));
+    if (f == NULL)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    f->cfg = *cfg;
+    // Room for the window being written, the window being recorded, the
+    // samples the power of its first sample is averaged over, and the slot
+    // being written.
+    f->capacity = 2 * window + cfg->power_window + 1;
+    f->ring = (struct variorum_snapshot *) malloc(f->capacity *
+              sizeof(struct variorum_snapshot));
+    if (f->ring == NULL)
+    {
+        free(f);
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    // Fault the ring in now rather than during the first lap.
+    memset(f->ring, 0, f->capacity * sizeof(struct variorum_snapshot));
+    *flight = f;
+    return 0;
+}
+
+void variorum_flight_destroy(struct variorum_flight *flight)
+{
+    if (flight == NULL)
+    {
+        return;
+    }
+    free(flight->ring);
+    free(flight);
+}
+
+int variorum_flight_record(struct variorum_flight *flight,
+                           const struct variorum_snapshot *snap,
+                           struct variorum_flight_event *event)
+{
+    uint64_t seq = flight->head;
+    uint32_t reasons;
+
+    flight->ring[seq % flight->capacity] = *snap;
+    __atomic_store_n(&flight->head, seq + 1, __ATOMIC_RELEASE);
+
+    reasons = check_triggers(flight, seq);
+    if (reasons != 0)
+    {
+        if (flight->open)
+        {
+            flight->event.reasons |= reasons;
+        }
+        else
+        {
+            flight->open = 1;
+            flight->event.reasons = reasons;
+            flight->event.trigger = seq;
+            flight->event.trigger_ns = snap->timestamp_ns;
+            flight->event.first = seq > flight->cfg.before ? seq -
+                                  flight->cfg.before : 0;
+            flight->event.last = seq + flight->cfg.after;
+        }
+    }
+    if (flight->open && flight->event.last == seq)
+    {
+        flight->open = 0;
+        *event = flight->event;
+        return 1;
+    }
+    return 0;
+}
+
+void variorum_flight_trigger(struct variorum_flight *flight)
+{
+    flight->user = 1;
+}
+
+int variorum_flight_finish(struct variorum_flight *flight,
+                           struct variorum_flight_event *event)
+{
+    if (!flight->open)
+    {
+        return 0;
+    }
+    flight->open = 0;
+    flight->event.last = flight->head - 1;
+    *event = flight->event;
+    return 1;
+}
+
+int variorum_flight_get(const struct variorum_flight *flight, uint64_t seq,
+                        struct variorum_snapshot *snap)
+{
+    uint64_t head = __atomic_load_n(&flight->head, __ATOMIC_ACQUIRE);
+
+    if (seq >= head || head - seq >= flight->capacity)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    *snap = flight->ring[seq % flight->capacity];
+
+    // The slot of seq is rewritten while head is seq + capacity, so the
+    // copy is whole only if head was still below that after it.
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    head = __atomic_load_n(&flight->head, __ATOMIC_RELAXED);
+    if (head - seq >= flight->capacity)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    return 0;
+}
+
+/// @brief Names of the VARIORUM_FLIGHT_* bits, joined with '|'.
+static void reason_names(uint32_t reasons, char *buf, size_t len)
+{
+    static const char *const names[] = {"power", "thermal", "cap", "user"};
+    size_t pos = 0;
+    unsigned i;
+
+    buf[0] = '\0';
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if (reasons & (1u << i))
+        {
+            pos += snprintf(buf + pos, len - pos, "%s%s", pos ? "|" : "",
+                            names[i]);
+            if (pos >= len)
+            {
+                return;
+            }
+        }
+    }
+}
+
+int variorum_flight_dump(const struct variorum_flight *flight,
+                         const struct variorum_flight_event *event, FILE *out)
+{
+    struct variorum_snapshot snap;
+    struct variorum_snapshot base;
+    char reasons[64];
+    uint64_t seq;
+    uint64_t from;
+    unsigned nsockets;
+    unsigned i;
+    double pkg;
+    double dram;
+
+    if (variorum_flight_get(flight, event->first, &snap) != 0)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    nsockets = snap.nsockets;
+    reason_names(event->reasons, reasons, sizeof(reasons));
+
+    fprintf(out, "Timestamp (ns),Offset (us),Trigger");
+    for (i = 0; i < nsockets; i++)
+    {
+        fprintf(out, ",Socket_%u Power (W),Mem_%u Power (W),"
+                "Socket_%u Power Limit (W),Socket_%u Thermal Status", i, i, i, i);
+    }
+    fprintf(out, "\n");
+
+    for (seq = event->first; seq <= event->last; seq++)
+    {
+        // Power over the window before the sample, or over what is left of
+        // it in the ring.
+        from = seq > flight->cfg.power_window ? seq - flight->cfg.power_window :
+               0;
+        if (variorum_flight_get(flight, from, &base) != 0 &&
+            variorum_flight_get(flight, event->first, &base) != 0)
+        {
+            return VARIORUM_ERROR_INVAL;
+        }
+        if (variorum_flight_get(flight, seq, &snap) != 0)
+        {
+            return VARIORUM_ERROR_INVAL;
+        }
+        fprintf(out, "%lu,%ld,%s", (unsigned long)snap.timestamp_ns,
+                (long)((int64_t)(snap.timestamp_ns - event->trigger_ns) / 1000),
+                seq == event->trigger ? reasons : "");
+        for (i = 0; i < nsockets; i++)
+        {
+            socket_power(&base, &snap, i, &pkg, &dram);
+            fprintf(out, ",%0.2lf,%0.2lf,%0.2lf,0x%lx", pkg, dram,
+                    (snap.pkg_power_limit[i] & PKG_POWER_LIMIT_1_MASK) *
+                    snap.power_unit_watts,
+                    (unsigned long)snap.pkg_therm_status[i]);
+        }
+        fprintf(out, "\n");
+    }
+    if (ferror(out))
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef VARIORUM_FLIGHT_H_INCLUDE
+#define VARIORUM_FLIGHT_H_INCLUDE
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <variorum_snapshot.h>
+
+/// @brief The package power of all sockets went above the threshold.
+#define VARIORUM_FLIGHT_POWER 0x1
+/// @brief A bit of the thermal mask became set in the package thermal status
+/// of a socket.
+#define VARIORUM_FLIGHT_THERMAL 0x2
+/// @brief The package power limit of a socket changed.
+#define VARIORUM_FLIGHT_CAP 0x4
+/// @brief variorum_flight_trigger() was called.
+#define VARIORUM_FLIGHT_USER 0x8
+
+/// @brief Bits of IA32_PACKAGE_THERM_STATUS that trigger by default: thermal
+/// status (bit 0), PROCHOT# or FORCEPR# asserted (bit 2) and critical
+/// temperature (bit 4).
+#define VARIORUM_FLIGHT_THERM_MASK 0x15ULL
+
+/// @brief When to trigger, and how many samples to keep around a trigger.
+struct variorum_flight_config
+{
+    /// @brief Samples kept before the sample that triggers.
+    uint32_t before;
+    /// @brief Samples recorded after the sample that triggers.
+    uint32_t after;
+    /// @brief Samples the package power is averaged over, at least 1. RAPL
+    /// energy counters update about every millisecond, so at high rates the
+    /// power between consecutive samples is mostly quantization noise.
+    uint32_t power_window;
+    /// @brief Package power of all sockets above which to trigger, or 0 to
+    /// never trigger on power.
+    double power_watts;
+    /// @brief Bits of the package thermal status that trigger when they
+    /// become set, e.g., VARIORUM_FLIGHT_THERM_MASK, or 0.
+    uint64_t therm_mask;
+    /// @brief Non-zero to trigger when a package power limit changes.
+    int cap_changes;
+};
+
+/// @brief Samples around a trigger, by sequence number: the first sample
+/// recorded is 0.
+struct variorum_flight_event
+{
+    /// @brief Causes of the triggers in the window, VARIORUM_FLIGHT_* bits.
+    uint32_t reasons;
+    /// @brief Sample that triggered first.
+    uint64_t trigger;
+    /// @brief Time of the trigger sample, in nanoseconds of CLOCK_MONOTONIC.
+    uint64_t trigger_ns;
+    /// @brief First sample of the window.
+    uint64_t first;
+    /// @brief Last sample of the window.
+    uint64_t last;
+};
+
+/// @brief Handle of a flight recorder.
+struct variorum_flight;
+
+/// @brief Create a flight recorder, a preallocated ring of snapshots.
+///
+/// Snapshots from variorum_read_snapshot() are passed to
+/// variorum_flight_record(), which keeps them in memory and checks them for
+/// triggers without allocating or doing I/O. Once the samples after a
+/// trigger are recorded, the window around it is returned, and can be
+/// written with variorum_flight_dump(), e.g., from another thread. The ring
+/// holds two windows, so a window can be written while the next one is
+/// recorded. Triggers within a window are merged into it.
+///
+/// @param [in] cfg Triggers and window.
+/// @param [out] flight Handle, released with variorum_flight_destroy().
+///
+/// @return 0 if successful, VARIORUM_ERROR_INVAL for a bad configuration,
+/// else VARIORUM_ERROR_RUNTIME if out of memory.
+int variorum_flight_create(
+    const struct variorum_flight_config *cfg,
+    struct variorum_flight **flight
+);
+
+/// @brief Release a flight recorder.
+///
+/// @param [in] flight Handle.
+void variorum_flight_destroy(
+    struct variorum_flight *flight
+);
+
+/// @brief Record a snapshot and check it for triggers.
+///
+/// Must not be called concurrently with itself.
+///
+/// @param [in,out] flight Handle.
+/// @param [in] snap Snapshot.
+/// @param [out] event Window of a trigger, if completed by this sample.
+///
+/// @return 1 if a window is complete and returned in event, else 0.
+int variorum_flight_record(
+    struct variorum_flight *flight,
+    const struct variorum_snapshot *snap,
+    struct variorum_flight_event *event
+);
+
+/// @brief Trigger on the next recorded sample. Async-signal-safe, e.g., for
+/// a SIGUSR1 handler.
+///
+/// @param [in,out] flight Handle.
+void variorum_flight_trigger(
+    struct variorum_flight *flight
+);
+
+/// @brief End the window of a trigger at the last recorded sample, e.g.,
+/// when sampling stops.
+///
+/// @param [in,out] flight Handle.
+/// @param [out] event Window of a trigger, if any.
+///
+/// @return 1 if a window was open and is returned in event, else 0.
+int variorum_flight_finish(
+    struct variorum_flight *flight,
+    struct variorum_flight_event *event
+);
+
+/// @brief Copy a recorded sample. May be called while another thread records.
+///
+/// @param [in] flight Handle.
+/// @param [in] seq Sequence number of the sample.
+/// @param [out] snap Sample.
+///
+/// @return 0 if successful, else VARIORUM_ERROR_INVAL if the sample is not
+/// recorded yet or was overwritten.
+int variorum_flight_get(
+    const struct variorum_flight *flight,
+    uint64_t seq,
+    struct variorum_snapshot *snap
+);
+
+/// @brief Write the samples of a window as comma-delimited text.
+///
+/// Each row holds the time of a sample, its offset from the trigger, the
+/// triggers of the trigger row, and for every socket the package and DRAM
+/// power over the power window, the package power limit and the raw package
+/// thermal status. May be called while another thread records.
+///
+/// @param [in] flight Handle.
+/// @param [in] event Window.
+/// @param [in] out Output.
+///
+/// @return 0 if successful, VARIORUM_ERROR_INVAL if samples of the window
+/// were overwritten before they were written, else VARIORUM_ERROR_RUNTIME
+/// if out cannot be written.
+int variorum_flight_dump(
+    const struct variorum_flight *flight,
+    const struct variorum_flight_event *event,
+    FILE *out
+);
+
+#endif
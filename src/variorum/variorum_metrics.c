@@ -0,0 +1,73 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <variorum_metrics.h>
+
+void variorum_metric_vector_init(struct variorum_metric_vector *vec)
+{
+    vec->metrics = NULL;
+    vec->count = 0;
+    vec->capacity = 0;
+}
+
+void variorum_metric_vector_clear(struct variorum_metric_vector *vec)
+{
+    vec->count = 0;
+}
+
+void variorum_metric_vector_free(struct variorum_metric_vector *vec)
+{
+    free(vec->metrics);
+    variorum_metric_vector_init(vec);
+}
+
+int variorum_metric_vector_append(struct variorum_metric_vector *vec,
+                                  const char *name, int domain, int index,
+                                  double value, uint64_t timestamp_us)
+{
+    struct variorum_metric *m;
+    size_t capacity;
+
+    if (vec->count == vec->capacity)
+    {
+        capacity = vec->capacity ? 2 * vec->capacity : 64;
+        m = (struct variorum_metric *) realloc(vec->metrics,
+                                               capacity * sizeof(struct variorum_metric));
+        if (m == NULL)
+        {
+            return -1;
+        }
+        vec->metrics = m;
+        vec->capacity = capacity;
+    }
+
+    m = &vec->metrics[vec->count++];
+    strncpy(m->name, name, VARIORUM_METRIC_NAME_LEN - 1);
+    m->name[VARIORUM_METRIC_NAME_LEN - 1] = '\0';
+    m->domain = domain;
+    m->index = index;
+    m->value = value;
+    m->timestamp_us = timestamp_us;
+    return 0;
+}
+
+struct variorum_metric *variorum_metric_vector_find(const struct
+        variorum_metric_vector *vec, const char *name, int domain, int index)
+{
+    size_t i;
+
+    for (i = 0; i < vec->count; i++)
+    {
+        if (vec->metrics[i].domain == domain && vec->metrics[i].index == index &&
+            strcmp(vec->metrics[i].name, name) == 0)
+        {
+            return &vec->metrics[i];
+        }
+    }
+    return NULL;
+}
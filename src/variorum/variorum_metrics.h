@@ -0,0 +1,117 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef VARIORUM_METRICS_H_INCLUDE
+#define VARIORUM_METRICS_H_INCLUDE
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Maximum length of a metric name, including the terminating null.
+#define VARIORUM_METRIC_NAME_LEN 48
+
+/// @brief List of hardware domains a metric can be reported for.
+enum variorum_metric_domain_e
+{
+    /// @brief Whole node.
+    VARIORUM_DOMAIN_NODE,
+    /// @brief CPU socket (package).
+    VARIORUM_DOMAIN_SOCKET,
+    /// @brief Physical CPU core.
+    VARIORUM_DOMAIN_CORE,
+    /// @brief Logical CPU thread.
+    VARIORUM_DOMAIN_THREAD,
+    /// @brief GPU device.
+    VARIORUM_DOMAIN_GPU,
+    /// @brief Core complex die (CCD), a group of cores sharing an L3 cache.
+    VARIORUM_DOMAIN_CCD,
+};
+
+/// @brief A single sampled value.
+///
+/// Names follow the keys used by the JSON APIs and carry their unit as a
+/// suffix, e.g., energy_cpu_joules or power_gpu_watts.
+struct variorum_metric
+{
+    /// @brief Metric name.
+    char name[VARIORUM_METRIC_NAME_LEN];
+    /// @brief Domain the value belongs to (enum variorum_metric_domain_e).
+    int domain;
+    /// @brief Index of the socket, core, thread, GPU or CCD within its domain.
+    int index;
+    /// @brief Sampled value.
+    double value;
+    /// @brief Time the value was sampled, in microseconds since the epoch.
+    uint64_t timestamp_us;
+};
+
+/// @brief Growable array of metrics shared by all platforms, so CPU and GPU
+/// samples from one call land in the same place.
+struct variorum_metric_vector
+{
+    /// @brief Array of metrics.
+    struct variorum_metric *metrics;
+    /// @brief Number of valid entries in metrics.
+    size_t count;
+    /// @brief Number of allocated entries in metrics.
+    size_t capacity;
+};
+
+/// @brief Initialize an empty metric vector.
+///
+/// @param [out] vec Metric vector.
+void variorum_metric_vector_init(
+    struct variorum_metric_vector *vec
+);
+
+/// @brief Remove all metrics, keeping the allocated storage for reuse.
+///
+/// @param [in,out] vec Metric vector.
+void variorum_metric_vector_clear(
+    struct variorum_metric_vector *vec
+);
+
+/// @brief Release the storage of a metric vector.
+///
+/// @param [in,out] vec Metric vector.
+void variorum_metric_vector_free(
+    struct variorum_metric_vector *vec
+);
+
+/// @brief Append a metric, growing the vector as needed.
+///
+/// @param [in,out] vec Metric vector.
+/// @param [in] name Metric name, truncated to VARIORUM_METRIC_NAME_LEN - 1.
+/// @param [in] domain Domain of the metric (enum variorum_metric_domain_e).
+/// @param [in] index Index within the domain.
+/// @param [in] value Sampled value.
+/// @param [in] timestamp_us Sample time in microseconds since the epoch.
+///
+/// @return 0 if successful, otherwise -1
+int variorum_metric_vector_append(
+    struct variorum_metric_vector *vec,
+    const char *name,
+    int domain,
+    int index,
+    double value,
+    uint64_t timestamp_us
+);
+
+/// @brief Find the first metric with the given name, domain and index.
+///
+/// @param [in] vec Metric vector.
+/// @param [in] name Metric name.
+/// @param [in] domain Domain of the metric.
+/// @param [in] index Index within the domain.
+///
+/// @return Pointer to the metric, or NULL if not found.
+struct variorum_metric *variorum_metric_vector_find(
+    const struct variorum_metric_vector *vec,
+    const char *name,
+    int domain,
+    int index
+);
+
+#endif
@@ -0,0 +1,275 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <variorum_self_counters.h>
+
+static const uint64_t self_counters_events[SELF_COUNTERS_NUM] =
+{
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_REF_CPU_CYCLES
+};
+
+static long perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu,
+                            int group_fd, unsigned long flags)
+{
+    return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+uint64_t self_counters_time_delta(uint64_t cyc, uint64_t time_offset,
+                                  uint32_t time_mult, uint16_t time_shift)
+{
+    uint64_t quot = cyc >> time_shift;
+    uint64_t rem = cyc & (((uint64_t)1 << time_shift) - 1);
+
+    return time_offset + quot * time_mult + ((rem * time_mult) >> time_shift);
+}
+
+int64_t self_counters_sign_extend(uint64_t pmc, uint16_t width)
+{
+    if (width == 0 || width >= 64)
+    {
+        return (int64_t)pmc;
+    }
+    return (int64_t)(pmc << (64 - width)) >> (64 - width);
+}
+
+int self_counters_open(struct self_counters *sc)
+{
+    struct perf_event_attr attr;
+    long pagesize = sysconf(_SC_PAGESIZE);
+    int i;
+
+    for (i = 0; i < SELF_COUNTERS_NUM; i++)
+    {
+        sc->fd[i] = -1;
+        sc->page[i] = MAP_FAILED;
+    }
+    for (i = 0; i < SELF_COUNTERS_NUM; i++)
+    {
+        memset(&attr, 0, sizeof(struct perf_event_attr));
+        attr.size = sizeof(struct perf_event_attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = self_counters_events[i];
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        sc->fd[i] = (int)perf_event_open(&attr, 0, -1, i == 0 ? -1 : sc->fd[0], 0);
+        if (sc->fd[i] < 0)
+        {
+            self_counters_close(sc);
+            return -1;
+        }
+        sc->page[i] = mmap(NULL, pagesize, PROT_READ, MAP_SHARED, sc->fd[i], 0);
+        if (sc->page[i] == MAP_FAILED)
+        {
+            self_counters_close(sc);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/// @brief Read one counter with read(), for when rdpmc is not allowed.
+static int self_counter_syscall(int fd, uint64_t *count, uint64_t *enabled,
+                                uint64_t *running)
+{
+    uint64_t buf[3];
+
+    if (read(fd, buf, sizeof(buf)) != (ssize_t)sizeof(buf))
+    {
+        return -1;
+    }
+    *count = buf[0];
+    *enabled = buf[1];
+    *running = buf[2];
+    return 0;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t self_rdpmc(uint32_t idx)
+{
+    uint32_t lo, hi;
+
+    __asm__ volatile("rdpmc" : "=a"(lo), "=d"(hi) : "c"(idx));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline uint64_t self_rdtsc(void)
+{
+    uint32_t lo, hi;
+
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/// @brief Read one counter in user space through its user page.
+///
+/// @return 0 if successful, else -1 if the kernel does not allow rdpmc.
+static int self_counter_rdpmc(const void *page, uint64_t *count,
+                              uint64_t *enabled, uint64_t *running)
+{
+    const volatile struct perf_event_mmap_page *pc = page;
+    uint64_t cyc = 0, time_offset = 0;
+    uint32_t seq, idx, time_mult = 0;
+    uint16_t time_shift = 0;
+
+    if (!pc->cap_user_rdpmc)
+    {
+        return -1;
+    }
+
+    /* The kernel bumps lock while it updates the page, e.g., when the event
+     * is scheduled in or out, so retry until the sequence is the same before
+     * and after the reads.
+     */
+    do
+    {
+        seq = pc->lock;
+        __asm__ volatile("" ::: "memory");
+        *enabled = pc->time_enabled;
+        *running = pc->time_running;
+        if (pc->cap_user_time && *enabled != *running)
+        {
+            cyc = self_rdtsc();
+            time_offset = pc->time_offset;
+            time_mult = pc->time_mult;
+            time_shift = pc->time_shift;
+        }
+        idx = pc->index;
+        *count = pc->offset;
+        if (idx)
+        {
+            *count += self_counters_sign_extend(self_rdpmc(idx - 1),
+                                                pc->pmc_width);
+        }
+        __asm__ volatile("" ::: "memory");
+    }
+    while (pc->lock != seq);
+
+    /* time_enabled and time_running are as of the last update of the page,
+     * so extend them to now. time_running only advances while the event is
+     * on a counter.
+     */
+    if (cyc)
+    {
+        uint64_t delta = self_counters_time_delta(cyc, time_offset, time_mult,
+                         time_shift);
+        *enabled += delta;
+        if (idx)
+        {
+            *running += delta;
+        }
+    }
+    return 0;
+}
+#else
+static int self_counter_rdpmc(const void *page, uint64_t *count,
+                              uint64_t *enabled, uint64_t *running)
+{
+    (void)page;
+    (void)count;
+    (void)enabled;
+    (void)running;
+    return -1;
+}
+#endif
+
+int self_counters_read(const struct self_counters *sc, uint64_t *counts)
+{
+    uint64_t count, enabled, running;
+    int i;
+
+    for (i = 0; i < SELF_COUNTERS_NUM; i++)
+    {
+        if (self_counter_rdpmc(sc->page[i], &count, &enabled, &running) &&
+            self_counter_syscall(sc->fd[i], &count, &enabled, &running))
+        {
+            return -1;
+        }
+        if (running == 0)
+        {
+            counts[i] = 0;
+        }
+        else if (running >= enabled)
+        {
+            counts[i] = count;
+        }
+        else
+        {
+            counts[i] = (uint64_t)((double)count * enabled / running);
+        }
+    }
+    return 0;
+}
+
+void self_counters_close(struct self_counters *sc)
+{
+    long pagesize = sysconf(_SC_PAGESIZE);
+    int i;
+
+    for (i = SELF_COUNTERS_NUM - 1; i >= 0; i--)
+    {
+        if (sc->page[i] != MAP_FAILED)
+        {
+            munmap(sc->page[i], pagesize);
+            sc->page[i] = MAP_FAILED;
+        }
+        if (sc->fd[i] >= 0)
+        {
+            close(sc->fd[i]);
+            sc->fd[i] = -1;
+        }
+    }
+}
+
+static pthread_key_t self_counters_key;
+static pthread_once_t self_counters_once = PTHREAD_ONCE_INIT;
+static __thread struct self_counters *self_counters_tls = NULL;
+static __thread int self_counters_failed = 0;
+
+static void self_counters_destroy(void *arg)
+{
+    self_counters_close((struct self_counters *)arg);
+    free(arg);
+}
+
+static void self_counters_make_key(void)
+{
+    pthread_key_create(&self_counters_key, self_counters_destroy);
+}
+
+int self_counters_thread_read(uint64_t *counts)
+{
+    struct self_counters *sc = self_counters_tls;
+
+    if (sc == NULL)
+    {
+        if (self_counters_failed)
+        {
+            return -1;
+        }
+        sc = (struct self_counters *) malloc(sizeof(struct self_counters));
+        if (sc == NULL || self_counters_open(sc))
+        {
+            free(sc);
+            self_counters_failed = 1;
+            return -1;
+        }
+        pthread_once(&self_counters_once, self_counters_make_key);
+        pthread_setspecific(self_counters_key, sc);
+        self_counters_tls = sc;
+    }
+    return self_counters_read(sc, counts);
+}
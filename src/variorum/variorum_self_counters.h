@@ -0,0 +1,101 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef VARIORUM_SELF_COUNTERS_H_INCLUDE
+#define VARIORUM_SELF_COUNTERS_H_INCLUDE
+
+#include <stdint.h>
+
+/// @brief Number of self-monitoring counters: instructions retired, core
+/// cycles and reference cycles, in the order of the fixed counters.
+#define SELF_COUNTERS_NUM 3
+
+/// @brief perf_event counters of one thread, each with its mmapped user page.
+struct self_counters
+{
+    /// @brief perf_event file descriptors; fd[0] leads the group.
+    int fd[SELF_COUNTERS_NUM];
+    /// @brief User pages of the counters, each a struct perf_event_mmap_page.
+    void *page[SELF_COUNTERS_NUM];
+};
+
+/// @brief Convert a TSC value into perf time with the conversion parameters
+/// of the user page.
+///
+/// @param [in] cyc TSC value.
+/// @param [in] time_offset time_offset of the user page.
+/// @param [in] time_mult time_mult of the user page.
+/// @param [in] time_shift time_shift of the user page.
+///
+/// @return Time in nanoseconds to add to time_enabled and time_running.
+uint64_t self_counters_time_delta(
+    uint64_t cyc,
+    uint64_t time_offset,
+    uint32_t time_mult,
+    uint16_t time_shift
+);
+
+/// @brief Sign-extend a raw rdpmc value to 64 bits.
+///
+/// @param [in] pmc Value returned by rdpmc.
+/// @param [in] width pmc_width of the user page.
+///
+/// @return Counter value relative to the offset of the user page.
+int64_t self_counters_sign_extend(
+    uint64_t pmc,
+    uint16_t width
+);
+
+/// @brief Open instructions, cycles and reference cycles counters on the
+/// calling thread and map their user pages.
+///
+/// Only user-level events are counted, so the counters can be opened without
+/// privileges at the default perf_event_paranoid level.
+///
+/// @param [out] sc Counters, released with self_counters_close().
+///
+/// @return 0 if successful, else -1 if perf_event_open() or mmap() fails.
+int self_counters_open(
+    struct self_counters *sc
+);
+
+/// @brief Read counters opened on the calling thread.
+///
+/// Counters are read with rdpmc under the user page sequence lock when the
+/// kernel allows it, else with read(). Counts are scaled by the ratio of
+/// enabled to running time if the counters were multiplexed.
+///
+/// @param [in] sc Counters opened by the calling thread.
+/// @param [out] counts Instructions retired, core cycles and reference
+///        cycles.
+///
+/// @return 0 if successful, else -1.
+int self_counters_read(
+    const struct self_counters *sc,
+    uint64_t *counts
+);
+
+/// @brief Unmap and close counters opened by self_counters_open().
+///
+/// @param [in,out] sc Counters to release.
+void self_counters_close(
+    struct self_counters *sc
+);
+
+/// @brief Read the counters of the calling thread, opening them on first
+/// use.
+///
+/// The counters of each thread are released when the thread exits. If they
+/// cannot be opened, later calls from the same thread fail immediately.
+///
+/// @param [out] counts Instructions retired, core cycles and reference
+///        cycles.
+///
+/// @return 0 if successful, else -1 if self-monitoring is not available.
+int self_counters_thread_read(
+    uint64_t *counts
+);
+
+#endif
@@ -0,0 +1,1275 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <variorum_error.h>
+#include <variorum_series.h>
+
+/// @brief "VTS1", "VSB1" and "VSI1", first words of the file header, of
+/// every block and of the trailer.
+#define SERIES_MAGIC 0x31535456
+#define BLOCK_MAGIC 0x31425356
+#define INDEX_MAGIC 0x31495356
+#define SERIES_VERSION 1
+
+#define BLOCK_HEADER_LEN 32
+#define INDEX_ENTRY_LEN 32
+#define TRAILER_LEN 24
+#define MAX_NAME_LEN 65535
+#define MAX_META_LEN (1 << 20)
+#define RICE_ESCAPE 24
+
+/// @brief Time range and location of one block.
+struct series_block
+{
+    int64_t first;
+    int64_t last;
+    uint64_t offset;
+    uint32_t samples;
+};
+
+/// @brief Bit stream, written most significant bit first. With buf NULL, it
+/// only counts bits, to compare encodings.
+struct bits
+{
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+    uint64_t acc;
+    unsigned accn;
+    uint64_t count;
+    int error;
+};
+
+struct bit_reader
+{
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    int error;
+};
+
+struct variorum_series_writer
+{
+    int fd;
+    uint32_t ncolumns;
+    int *decimals;
+    uint64_t offset;
+    uint32_t pending;
+    int64_t last_time;
+    int64_t *times;
+    union variorum_series_value *values;
+    struct series_block *blocks;
+    size_t nblocks;
+    size_t cap_blocks;
+    struct bits payload;
+};
+
+struct variorum_series_reader
+{
+    int fd;
+    char *time_name;
+    char *meta;
+    uint32_t ncolumns;
+    struct variorum_series_column *columns;
+    struct series_block *blocks;
+    size_t nblocks;
+    uint64_t samples;
+    uint8_t *buf;
+    size_t cap_buf;
+    int64_t *times;
+    union variorum_series_value *values;
+};
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void put_le64(uint8_t *p, uint64_t v)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+           (uint32_t)p[3] << 24;
+}
+
+static uint64_t get_le64(const uint8_t *p)
+{
+    return get_le32(p) | (uint64_t)get_le32(p + 4) << 32;
+}
+
+/// @brief FNV-1a hash, to detect torn or corrupted blocks.
+static uint32_t checksum(const uint8_t *p, size_t len)
+{
+    uint32_t h = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    ssize_t n;
+
+    while (len > 0)
+    {
+        n = write(fd, p, len);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int read_at(int fd, void *buf, size_t len, uint64_t offset)
+{
+    uint8_t *p = (uint8_t *)buf;
+    ssize_t n;
+
+    while (len > 0)
+    {
+        n = pread(fd, p, len, offset);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        p += n;
+        offset += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static uint64_t zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static unsigned bit_length(uint64_t v)
+{
+    return v == 0 ? 0 : 64 - __builtin_clzll(v);
+}
+
+/// @brief Append the n low bits of v.
+static void bits_put(struct bits *b, uint64_t v, unsigned n)
+{
+    uint8_t *buf;
+
+    if (b->buf == NULL)
+    {
+        b->count += n;
+        return;
+    }
+    if (n > 32)
+    {
+        bits_put(b, v >> 32, n - 32);
+        n = 32;
+    }
+    if (b->len + 8 > b->cap)
+    {
+        buf = (uint8_t *) realloc(b->buf, 2 * b->cap);
+        if (buf == NULL)
+        {
+            b->error = 1;
+            return;
+        }
+        b->buf = buf;
+        b->cap *= 2;
+    }
+    b->acc = (b->acc << n) | (v & ((1ULL << n) - 1));
+    b->accn += n;
+    b->count += n;
+    while (b->accn >= 8)
+    {
+        b->buf[b->len++] = (uint8_t)(b->acc >> (b->accn - 8));
+        b->accn -= 8;
+    }
+}
+
+/// @brief Pad the stream to a whole byte.
+static void bits_finish(struct bits *b)
+{
+    if (b->accn > 0)
+    {
+        bits_put(b, 0, 8 - b->accn);
+    }
+}
+
+static uint64_t bits_get(struct bit_reader *r, unsigned n)
+{
+    uint64_t w = 0;
+    size_t byte;
+    unsigned i;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+    if (n > 56)
+    {
+        w = bits_get(r, n - 32) << 32;
+        return w | bits_get(r, 32);
+    }
+    if (r->pos + n > r->len * 8)
+    {
+        r->error = 1;
+        return 0;
+    }
+    byte = r->pos >> 3;
+    for (i = 0; i < 8; i++)
+    {
+        w = (w << 8) | (byte + i < r->len ? r->buf[byte + i] : 0);
+    }
+    w = (w << (r->pos & 7)) >> (64 - n);
+    r->pos += n;
+    return w;
+}
+
+/// @brief Elias gamma code of v >= 1.
+static void put_gamma(struct bits *b, uint64_t v)
+{
+    unsigned n = bit_length(v);
+
+    bits_put(b, 0, n - 1);
+    bits_put(b, v, n);
+}
+
+static uint64_t get_gamma(struct bit_reader *r)
+{
+    unsigned zeros = 0;
+
+    while (bits_get(r, 1) == 0)
+    {
+        if (r->error || ++zeros > 63)
+        {
+            r->error = 1;
+            return 1;
+        }
+    }
+    return (1ULL << zeros) | bits_get(r, zeros);
+}
+
+/// @brief Rice code of v with parameter k: v >> k in unary, then the k low
+/// bits of v. A value whose quotient would reach RICE_ESCAPE is written as
+/// RICE_ESCAPE ones, its length and its bits instead.
+static void put_rice(struct bits *b, uint64_t v, unsigned k)
+{
+    uint64_t q = v >> k;
+
+    if (q < RICE_ESCAPE)
+    {
+        bits_put(b, (1ULL << (q + 1)) - 2, (unsigned)q + 1);
+        bits_put(b, v, k);
+        return;
+    }
+    bits_put(b, (1ULL << RICE_ESCAPE) - 1, RICE_ESCAPE);
+    bits_put(b, bit_length(v), 7);
+    bits_put(b, v, bit_length(v));
+}
+
+static uint64_t get_rice(struct bit_reader *r, unsigned k)
+{
+    unsigned q = 0;
+    unsigned len;
+
+    while (q < RICE_ESCAPE && bits_get(r, 1) == 1)
+    {
+        q++;
+    }
+    if (q < RICE_ESCAPE)
+    {
+        return ((uint64_t)q << k) | bits_get(r, k);
+    }
+    len = (unsigned)bits_get(r, 7);
+    if (len > 64)
+    {
+        r->error = 1;
+        return 0;
+    }
+    return bits_get(r, len);
+}
+
+/// @brief Write zigzag residuals as Rice codes. With rle, a run of zeros is
+/// a 0 bit and the length of the run, any other residual a 1 bit and its
+/// Rice code.
+static void put_residuals(struct bits *b, const uint64_t *u, size_t n, int rle,
+                          unsigned k)
+{
+    size_t run = 0;
+    size_t i;
+
+    for (i = 1; i < n; i++)
+    {
+        if (!rle)
+        {
+            put_rice(b, u[i], k);
+            continue;
+        }
+        if (u[i] == 0)
+        {
+            run++;
+            continue;
+        }
+        if (run > 0)
+        {
+            bits_put(b, 0, 1);
+            put_gamma(b, run);
+            run = 0;
+        }
+        bits_put(b, 1, 1);
+        put_rice(b, u[i] - 1, k);
+    }
+    if (run > 0)
+    {
+        bits_put(b, 0, 1);
+        put_gamma(b, run);
+    }
+}
+
+/// @brief Encode integers as their first value, then their deltas or deltas
+/// of deltas, whichever is shorter, with or without run-length encoding of
+/// zero residuals, and the Rice parameter that fits them best.
+static void put_ints(struct bits *b, const int64_t *v, size_t n)
+{
+    uint64_t u[2][VARIORUM_SERIES_BLOCK_SAMPLES];
+    uint64_t delta;
+    uint64_t prev_delta = 0;
+    uint64_t best = UINT64_MAX;
+    unsigned best_k = 0;
+    unsigned k;
+    unsigned center;
+    int best_dod = 0;
+    int best_rle = 0;
+    int dod;
+    int rle;
+    double sum[2] = {0.0, 0.0};
+    size_t i;
+
+    for (i = 1; i < n; i++)
+    {
+        // Wrapping arithmetic keeps the codes exact for any int64.
+        delta = (uint64_t)v[i] - (uint64_t)v[i - 1];
+        u[0][i] = zigzag((int64_t)delta);
+        u[1][i] = zigzag((int64_t)(delta - prev_delta));
+        prev_delta = delta;
+        sum[0] += (double)u[0][i];
+        sum[1] += (double)u[1][i];
+    }
+    for (dod = 0; dod < 2 && n > 1; dod++)
+    {
+        // The best parameter is close to the length of the mean residual.
+        center = bit_length((uint64_t)(sum[dod] / (n - 1)));
+        for (rle = 0; rle < 2; rle++)
+        {
+            for (k = center > 3 ? center - 3 : 0; k <= center + 1 && k < 64; k++)
+            {
+                struct bits count = {0};
+
+                put_residuals(&count, u[dod], n, rle, k);
+                if (count.count < best)
+                {
+                    best = count.count;
+                    best_dod = dod;
+                    best_rle = rle;
+                    best_k = k;
+                }
+            }
+        }
+    }
+
+    bits_put(b, best_dod, 1);
+    bits_put(b, best_rle, 1);
+    bits_put(b, best_k, 6);
+    bits_put(b, bit_length(zigzag(v[0])), 7);
+    bits_put(b, zigzag(v[0]), bit_length(zigzag(v[0])));
+    put_residuals(b, u[best_dod], n, best_rle, best_k);
+}
+
+static void get_ints(struct bit_reader *r, int64_t *v, size_t stride, size_t n)
+{
+    uint64_t delta = 0;
+    uint64_t residual;
+    uint64_t run;
+    uint64_t prev;
+    unsigned len;
+    unsigned k;
+    int dod;
+    int rle;
+    size_t i;
+
+    dod = (int)bits_get(r, 1);
+    rle = (int)bits_get(r, 1);
+    k = (unsigned)bits_get(r, 6);
+    len = (unsigned)bits_get(r, 7);
+    if (len > 64)
+    {
+        r->error = 1;
+        return;
+    }
+    prev = unzigzag(bits_get(r, len));
+    v[0] = (int64_t)prev;
+    for (i = 1; i < n && !r->error;)
+    {
+        run = 1;
+        if (!rle)
+        {
+            residual = (uint64_t)unzigzag(get_rice(r, k));
+        }
+        else if (bits_get(r, 1) == 0)
+        {
+            run = get_gamma(r);
+            residual = 0;
+        }
+        else
+        {
+            residual = (uint64_t)unzigzag(get_rice(r, k) + 1);
+        }
+        for (; run > 0 && i < n; run--, i++)
+        {
+            delta = dod ? delta + residual : residual;
+            prev += delta;
+            v[i * stride] = (int64_t)prev;
+            residual = 0;
+        }
+    }
+}
+
+/// @brief Encode doubles as the XOR of each value with the previous one,
+/// storing only the meaningful bits, within the window of the previous XOR
+/// when they fit in it.
+static void put_doubles(struct bits *b, const int64_t *v, size_t n)
+{
+    unsigned lead;
+    unsigned trail;
+    unsigned prev_lead = 65;
+    unsigned prev_trail = 0;
+    uint64_t x;
+    size_t run = 0;
+    size_t i;
+
+    bits_put(b, (uint64_t)v[0], 64);
+    for (i = 1; i < n; i++)
+    {
+        x = (uint64_t)v[i] ^ (uint64_t)v[i - 1];
+        if (x == 0)
+        {
+            run++;
+            continue;
+        }
+        if (run > 0)
+        {
+            bits_put(b, 0, 1);
+            put_gamma(b, run);
+            run = 0;
+        }
+        bits_put(b, 1, 1);
+        lead = __builtin_clzll(x);
+        trail = __builtin_ctzll(x);
+        if (lead >= prev_lead && trail >= prev_trail)
+        {
+            bits_put(b, 0, 1);
+            bits_put(b, x >> prev_trail, 64 - prev_lead - prev_trail);
+        }
+        else
+        {
+            bits_put(b, 1, 1);
+            bits_put(b, lead, 6);
+            bits_put(b, 63 - lead - trail, 6);
+            bits_put(b, x >> trail, 64 - lead - trail);
+            prev_lead = lead;
+            prev_trail = trail;
+        }
+    }
+    if (run > 0)
+    {
+        bits_put(b, 0, 1);
+        put_gamma(b, run);
+    }
+}
+
+static void get_doubles(struct bit_reader *r, int64_t *v, size_t stride,
+                        size_t n)
+{
+    unsigned lead = 0;
+    unsigned trail = 0;
+    unsigned len;
+    uint64_t prev;
+    uint64_t run;
+    size_t i;
+
+    prev = bits_get(r, 64);
+    v[0] = (int64_t)prev;
+    for (i = 1; i < n && !r->error;)
+    {
+        if (bits_get(r, 1) == 0)
+        {
+            for (run = get_gamma(r); run > 0 && i < n; run--, i++)
+            {
+                v[i * stride] = (int64_t)prev;
+            }
+            continue;
+        }
+        if (bits_get(r, 1) == 1)
+        {
+            lead = (unsigned)bits_get(r, 6);
+            len = (unsigned)bits_get(r, 6) + 1;
+            if (lead + len > 64)
+            {
+                r->error = 1;
+                return;
+            }
+            trail = 64 - lead - len;
+        }
+        prev ^= bits_get(r, 64 - lead - trail) << trail;
+        v[i * stride] = (int64_t)prev;
+        i++;
+    }
+}
+
+/// @brief Compress the pending samples into a block and write it.
+static int write_block(struct variorum_series_writer *w)
+{
+    struct bits *b = &w->payload;
+    struct series_block *blocks;
+    uint8_t header[BLOCK_HEADER_LEN];
+    uint32_t n = w->pending;
+    uint32_t c;
+    int64_t *col;
+    int rc;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+    b->len = 0;
+    b->acc = 0;
+    b->accn = 0;
+    put_ints(b, w->times, n);
+    for (c = 0; c < w->ncolumns; c++)
+    {
+        col = &w->values[(size_t)c * VARIORUM_SERIES_BLOCK_SAMPLES].i;
+        if (w->decimals[c] == VARIORUM_SERIES_DOUBLE)
+        {
+            put_doubles(b, col, n);
+        }
+        else
+        {
+            put_ints(b, col, n);
+        }
+    }
+    bits_finish(b);
+    if (b->error)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+
+    if (w->nblocks == w->cap_blocks)
+    {
+        w->cap_blocks = w->cap_blocks ? 2 * w->cap_blocks : 64;
+        blocks = (struct series_block *) realloc(w->blocks,
+                 w->cap_blocks * sizeof(struct series_block));
+        if (blocks == NULL)
+        {
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        w->blocks = blocks;
+    }
+    put_le32(header, BLOCK_MAGIC);
+    put_le32(header + 4, n);
+    put_le64(header + 8, (uint64_t)w->times[0]);
+    put_le64(header + 16, (uint64_t)w->times[n - 1]);
+    put_le32(header + 24, (uint32_t)b->len);
+    put_le32(header + 28, checksum(b->buf, b->len));
+    rc = write_all(w->fd, header, sizeof(header));
+    if (rc == 0)
+    {
+        rc = write_all(w->fd, b->buf, b->len);
+    }
+    if (rc != 0)
+    {
+        return rc;
+    }
+
+    w->blocks[w->nblocks].first = w->times[0];
+    w->blocks[w->nblocks].last = w->times[n - 1];
+    w->blocks[w->nblocks].offset = w->offset;
+    w->blocks[w->nblocks].samples = n;
+    w->nblocks++;
+    w->offset += sizeof(header) + b->len;
+    w->pending = 0;
+    return 0;
+}
+
+static void free_writer(struct variorum_series_writer *w)
+{
+    free(w->decimals);
+    free(w->times);
+    free(w->values);
+    free(w->blocks);
+    free(w->payload.buf);
+    free(w);
+}
+
+int variorum_series_create(int fd, const char *time_name,
+                           const struct variorum_series_column *columns,
+                           uint32_t ncolumns, const char *meta,
+                           struct variorum_series_writer **writer)
+{
+    struct variorum_series_writer *w;
+    uint8_t *header;
+    size_t len;
+    size_t pos;
+    size_t n;
+    uint32_t c;
+    int rc;
+
+    if (fd < 0 || time_name == NULL || (columns == NULL && ncolumns > 0) ||
+        ncolumns > VARIORUM_SERIES_MAX_COLUMNS || writer == NULL)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    if (meta == NULL)
+    {
+        meta = "";
+    }
+    len = 16 + 2 + strlen(time_name) + strlen(meta);
+    if (strlen(time_name) > MAX_NAME_LEN || strlen(meta) > MAX_META_LEN)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    for (c = 0; c < ncolumns; c++)
+    {
+        if (columns[c].name == NULL || strlen(columns[c].name) > MAX_NAME_LEN ||
+            columns[c].decimals < VARIORUM_SERIES_DOUBLE ||
+            columns[c].decimals > 18)
+        {
+            return VARIORUM_ERROR_INVAL;
+        }
+        len += 6 + strlen(columns[c].name);
+    }
+
+    w = (struct variorum_series_writer *) calloc(1,
+            sizeof(struct variorum_series_writer));
+    header = (uint8_t *) malloc(len);
+    if (w == NULL || header == NULL)
+    {
+        free(w);
+        free(header);
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    w->fd = fd;
+    w->ncolumns = ncolumns;
+    w->last_time = INT64_MIN;
+    w->decimals = (int *) malloc((ncolumns + 1) * sizeof(int));
+    w->times = (int64_t *) malloc(VARIORUM_SERIES_BLOCK_SAMPLES *
+                                  sizeof(int64_t));
+    w->values = (union variorum_series_value *) malloc(((size_t)ncolumns + 1) *
+                VARIORUM_SERIES_BLOCK_SAMPLES * sizeof(union variorum_series_value));
+    w->payload.cap = 64 * 1024;
+    w->payload.buf = (uint8_t *) malloc(w->payload.cap);
+    if (w->decimals == NULL || w->times == NULL || w->values == NULL ||
+        w->payload.buf == NULL)
+    {
+        free(header);
+        free_writer(w);
+        return VARIORUM_ERROR_RUNTIME;
+    }
+
+    // Header: magic, version, number of columns, length of the metadata,
+    // then the time name, the decimals and name of every column, and the
+    // metadata.
+    put_le32(header, SERIES_MAGIC);
+    put_le32(header + 4, SERIES_VERSION);
+    put_le32(header + 8, ncolumns);
+    put_le32(header + 12, (uint32_t)strlen(meta));
+    pos = 16;
+    n = strlen(time_name);
+    header[pos++] = (uint8_t)n;
+    header[pos++] = (uint8_t)(n >> 8);
+    memcpy(header + pos, time_name, n);
+    pos += n;
+    for (c = 0; c < ncolumns; c++)
+    {
+        w->decimals[c] = columns[c].decimals;
+        put_le32(header + pos, (uint32_t)columns[c].decimals);
+        pos += 4;
+        n = strlen(columns[c].name);
+        header[pos++] = (uint8_t)n;
+        header[pos++] = (uint8_t)(n >> 8);
+        memcpy(header + pos, columns[c].name, n);
+        pos += n;
+    }
+    memcpy(header + pos, meta, strlen(meta));
+
+    rc = write_all(fd, header, len);
+    free(header);
+    if (rc != 0)
+    {
+        free_writer(w);
+        return rc;
+    }
+    w->offset = len;
+    *writer = w;
+    return 0;
+}
+
+int variorum_series_append(struct variorum_series_writer *writer, int64_t time,
+                           const union variorum_series_value *values)
+{
+    uint32_t c;
+    int rc;
+
+    if (writer == NULL || (values == NULL && writer->ncolumns > 0) ||
+        time < writer->last_time)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    writer->times[writer->pending] = time;
+    for (c = 0; c < writer->ncolumns; c++)
+    {
+        writer->values[(size_t)c * VARIORUM_SERIES_BLOCK_SAMPLES +
+                                  writer->pending] = values[c];
+    }
+    writer->last_time = time;
+    if (++writer->pending == VARIORUM_SERIES_BLOCK_SAMPLES)
+    {
+        rc = write_block(writer);
+        if (rc != 0)
+        {
+            // Drop the block rather than growing without bound.
+            writer->pending = 0;
+            return rc;
+        }
+    }
+    return 0;
+}
+
+int variorum_series_flush(struct variorum_series_writer *writer)
+{
+    if (writer == NULL)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    return write_block(writer);
+}
+
+int variorum_series_close(struct variorum_series_writer *writer)
+{
+    uint8_t *index;
+    uint8_t *p;
+    size_t len;
+    size_t i;
+    int rc;
+
+    if (writer == NULL)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    rc = write_block(writer);
+    len = writer->nblocks * INDEX_ENTRY_LEN + TRAILER_LEN;
+    index = (uint8_t *) calloc(1, len);
+    if (rc == 0 && index == NULL)
+    {
+        rc = VARIORUM_ERROR_RUNTIME;
+    }
+    if (rc == 0)
+    {
+        // Index of the blocks, then the trailer that locates it, so a reader
+        // seeks to the blocks of a time range without scanning the file.
+        for (i = 0, p = index; i < writer->nblocks; i++, p += INDEX_ENTRY_LEN)
+        {
+            put_le64(p, (uint64_t)writer->blocks[i].first);
+            put_le64(p + 8, (uint64_t)writer->blocks[i].last);
+            put_le64(p + 16, writer->blocks[i].offset);
+            put_le32(p + 24, writer->blocks[i].samples);
+        }
+        put_le64(p, writer->offset);
+        put_le64(p + 8, writer->nblocks);
+        put_le32(p + 16, INDEX_MAGIC);
+        put_le32(p + 20, checksum(index, p - index));
+        rc = write_all(writer->fd, index, len);
+    }
+    free(index);
+    if (close(writer->fd) != 0 && rc == 0)
+    {
+        rc = VARIORUM_ERROR_RUNTIME;
+    }
+    free_writer(writer);
+    return rc;
+}
+
+/// @brief Load the index from the trailer of a closed series.
+static int load_index(struct variorum_series_reader *r, uint64_t size,
+                      uint64_t data_start)
+{
+    uint8_t trailer[TRAILER_LEN];
+    uint8_t *index;
+    uint64_t offset;
+    uint64_t n;
+    uint64_t i;
+
+    if (size < data_start + TRAILER_LEN ||
+        read_at(r->fd, trailer, TRAILER_LEN, size - TRAILER_LEN) != 0 ||
+        get_le32(trailer + 16) != INDEX_MAGIC)
+    {
+        return -1;
+    }
+    offset = get_le64(trailer);
+    n = get_le64(trailer + 8);
+    if (offset < data_start || n > (size - offset) / INDEX_ENTRY_LEN ||
+        offset + n * INDEX_ENTRY_LEN + TRAILER_LEN != size)
+    {
+        return -1;
+    }
+    index = (uint8_t *) malloc(n * INDEX_ENTRY_LEN + TRAILER_LEN);
+    r->blocks = (struct series_block *) malloc((n + 1) *
+                sizeof(struct series_block));
+    if (index == NULL || r->blocks == NULL ||
+        read_at(r->fd, index, n * INDEX_ENTRY_LEN + TRAILER_LEN, offset) != 0 ||
+        checksum(index, n * INDEX_ENTRY_LEN) != get_le32(trailer + 20))
+    {
+        free(index);
+        free(r->blocks);
+        r->blocks = NULL;
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        r->blocks[i].first = (int64_t)get_le64(index + i * INDEX_ENTRY_LEN);
+        r->blocks[i].last = (int64_t)get_le64(index + i * INDEX_ENTRY_LEN + 8);
+        r->blocks[i].offset = get_le64(index + i * INDEX_ENTRY_LEN + 16);
+        r->blocks[i].samples = get_le32(index + i * INDEX_ENTRY_LEN + 24);
+        r->samples += r->blocks[i].samples;
+    }
+    r->nblocks = n;
+    free(index);
+    return 0;
+}
+
+/// @brief Rebuild the index of a series whose writer died from the headers
+/// of its complete blocks.
+static int scan_index(struct variorum_series_reader *r, uint64_t size,
+                      uint64_t data_start)
+{
+    uint8_t header[BLOCK_HEADER_LEN];
+    struct series_block *blocks;
+    uint64_t offset = data_start;
+    uint64_t bytes;
+    size_t cap = 0;
+
+    while (offset + BLOCK_HEADER_LEN <= size &&
+           read_at(r->fd, header, BLOCK_HEADER_LEN, offset) == 0 &&
+           get_le32(header) == BLOCK_MAGIC)
+    {
+        bytes = get_le32(header + 24);
+        if (offset + BLOCK_HEADER_LEN + bytes > size || get_le32(header + 4) == 0 ||
+            get_le32(header + 4) > VARIORUM_SERIES_BLOCK_SAMPLES)
+        {
+            break;
+        }
+        if (r->nblocks == cap)
+        {
+            cap = cap ? 2 * cap : 64;
+            blocks = (struct series_block *) realloc(r->blocks,
+                     cap * sizeof(struct series_block));
+            if (blocks == NULL)
+            {
+                return VARIORUM_ERROR_RUNTIME;
+            }
+            r->blocks = blocks;
+        }
+        r->blocks[r->nblocks].first = (int64_t)get_le64(header + 8);
+        r->blocks[r->nblocks].last = (int64_t)get_le64(header + 16);
+        r->blocks[r->nblocks].offset = offset;
+        r->blocks[r->nblocks].samples = get_le32(header + 4);
+        r->samples += r->blocks[r->nblocks].samples;
+        r->nblocks++;
+        offset += BLOCK_HEADER_LEN + bytes;
+    }
+    return 0;
+}
+
+/// @brief Read a length-prefixed name of the header.
+///
+/// @return 0 if successful, 1 if the header is longer than len, else -1.
+static int get_name(const uint8_t *header, size_t len, size_t *pos,
+                    char **name)
+{
+    size_t n;
+
+    if (*pos + 2 > len)
+    {
+        return 1;
+    }
+    n = header[*pos] | (size_t)header[*pos + 1] << 8;
+    if (*pos + 2 + n > len)
+    {
+        return 1;
+    }
+    *name = (char *) malloc(n + 1);
+    if (*name == NULL)
+    {
+        return -1;
+    }
+    memcpy(*name, header + *pos + 2, n);
+    (*name)[n] = '\0';
+    *pos += 2 + n;
+    return 0;
+}
+
+/// @brief Parse the names and metadata of the header.
+///
+/// @return 0 if successful, 1 if the header is longer than len, else -1.
+static int parse_header(struct variorum_series_reader *r, const uint8_t *header,
+                        size_t len, uint32_t ncolumns, uint32_t meta_len,
+                        size_t *pos)
+{
+    uint32_t c;
+    int rc;
+
+    *pos = 16;
+    rc = get_name(header, len, pos, &r->time_name);
+    for (c = 0; rc == 0 && c < ncolumns; c++)
+    {
+        if (*pos + 4 > len)
+        {
+            return 1;
+        }
+        r->columns[c].decimals = (int32_t)get_le32(header + *pos);
+        if (r->columns[c].decimals < VARIORUM_SERIES_DOUBLE ||
+            r->columns[c].decimals > 18)
+        {
+            return -1;
+        }
+        *pos += 4;
+        rc = get_name(header, len, pos, (char **)&r->columns[c].name);
+        r->ncolumns = c + (rc == 0);
+    }
+    if (rc != 0)
+    {
+        return rc;
+    }
+    if (*pos + meta_len > len)
+    {
+        return 1;
+    }
+    r->meta = (char *) malloc(meta_len + 1);
+    if (r->meta == NULL)
+    {
+        return -1;
+    }
+    memcpy(r->meta, header + *pos, meta_len);
+    r->meta[meta_len] = '\0';
+    *pos += meta_len;
+    return 0;
+}
+
+static void free_header(struct variorum_series_reader *r)
+{
+    uint32_t c;
+
+    for (c = 0; c < r->ncolumns; c++)
+    {
+        free((char *)r->columns[c].name);
+    }
+    r->ncolumns = 0;
+    free(r->time_name);
+    r->time_name = NULL;
+    free(r->meta);
+    r->meta = NULL;
+}
+
+int variorum_series_open(const char *path, struct variorum_series_reader **reader)
+{
+    struct variorum_series_reader *r;
+    struct stat st;
+    uint8_t fixed[16];
+    uint8_t *header = NULL;
+    uint32_t ncolumns;
+    uint32_t meta_len;
+    size_t len = 64 * 1024;
+    size_t pos = 0;
+    int rc;
+
+    if (path == NULL || reader == NULL)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    r = (struct variorum_series_reader *) calloc(1,
+            sizeof(struct variorum_series_reader));
+    if (r == NULL)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    r->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (r->fd < 0 || fstat(r->fd, &st) != 0 ||
+        read_at(r->fd, fixed, sizeof(fixed), 0) != 0 ||
+        get_le32(fixed) != SERIES_MAGIC || get_le32(fixed + 4) != SERIES_VERSION)
+    {
+        variorum_series_reader_close(r);
+        return VARIORUM_ERROR_INVAL;
+    }
+    ncolumns = get_le32(fixed + 8);
+    meta_len = get_le32(fixed + 12);
+    r->columns = (struct variorum_series_column *) calloc(ncolumns + 1,
+                 sizeof(struct variorum_series_column));
+    if (ncolumns > VARIORUM_SERIES_MAX_COLUMNS || meta_len > MAX_META_LEN ||
+        r->columns == NULL)
+    {
+        variorum_series_reader_close(r);
+        return VARIORUM_ERROR_INVAL;
+    }
+
+    // Read a larger part of the file until it holds the whole header.
+    do
+    {
+        if (len > (size_t)st.st_size)
+        {
+            len = st.st_size;
+        }
+        free(header);
+        free_header(r);
+        header = (uint8_t *) malloc(len);
+        rc = header == NULL || read_at(r->fd, header, len, 0) != 0 ? -1 :
+             parse_header(r, header, len, ncolumns, meta_len, &pos);
+        len *= 2;
+    }
+    while (rc == 1 && len / 2 < (size_t)st.st_size);
+    free(header);
+    if (rc != 0)
+    {
+        variorum_series_reader_close(r);
+        return VARIORUM_ERROR_INVAL;
+    }
+
+    if (load_index(r, st.st_size, pos) != 0 &&
+        scan_index(r, st.st_size, pos) != 0)
+    {
+        variorum_series_reader_close(r);
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    r->times = (int64_t *) malloc(VARIORUM_SERIES_BLOCK_SAMPLES * sizeof(int64_t));
+    r->values = (union variorum_series_value *) malloc(((size_t)ncolumns + 1) *
+                VARIORUM_SERIES_BLOCK_SAMPLES * sizeof(union variorum_series_value));
+    if (r->times == NULL || r->values == NULL)
+    {
+        variorum_series_reader_close(r);
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    *reader = r;
+    return 0;
+}
+
+const char *variorum_series_time_name(const struct variorum_series_reader
+                                      *reader)
+{
+    return reader->time_name;
+}
+
+const struct variorum_series_column *variorum_series_columns(
+    const struct variorum_series_reader *reader, uint32_t *ncolumns)
+{
+    *ncolumns = reader->ncolumns;
+    return reader->columns;
+}
+
+const char *variorum_series_meta(const struct variorum_series_reader *reader)
+{
+    return reader->meta;
+}
+
+void variorum_series_extent(const struct variorum_series_reader *reader,
+                            uint64_t *samples, uint64_t *blocks, int64_t *first,
+                            int64_t *last)
+{
+    if (samples != NULL)
+    {
+        *samples = reader->samples;
+    }
+    if (blocks != NULL)
+    {
+        *blocks = reader->nblocks;
+    }
+    if (first != NULL)
+    {
+        *first = reader->nblocks ? reader->blocks[0].first : 0;
+    }
+    if (last != NULL)
+    {
+        *last = reader->nblocks ? reader->blocks[reader->nblocks - 1].last : 0;
+    }
+}
+
+/// @brief Read and decode one block into times and values.
+static int decode_block(struct variorum_series_reader *r,
+                        const struct series_block *block)
+{
+    struct bit_reader br;
+    uint8_t header[BLOCK_HEADER_LEN];
+    uint8_t *buf;
+    uint32_t bytes;
+    uint32_t n;
+    uint32_t c;
+
+    if (read_at(r->fd, header, BLOCK_HEADER_LEN, block->offset) != 0 ||
+        get_le32(header) != BLOCK_MAGIC)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    n = get_le32(header + 4);
+    bytes = get_le32(header + 24);
+    if (n != block->samples || n == 0 || n > VARIORUM_SERIES_BLOCK_SAMPLES)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    if (bytes > r->cap_buf)
+    {
+        buf = (uint8_t *) realloc(r->buf, bytes);
+        if (buf == NULL)
+        {
+            return VARIORUM_ERROR_RUNTIME;
+        }
+        r->buf = buf;
+        r->cap_buf = bytes;
+    }
+    if (read_at(r->fd, r->buf, bytes, block->offset + BLOCK_HEADER_LEN) != 0 ||
+        checksum(r->buf, bytes) != get_le32(header + 28))
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+
+    br.buf = r->buf;
+    br.len = bytes;
+    br.pos = 0;
+    br.error = 0;
+    get_ints(&br, r->times, 1, n);
+    for (c = 0; c < r->ncolumns; c++)
+    {
+        // Decoded row by row, so a sample is contiguous.
+        if (r->columns[c].decimals == VARIORUM_SERIES_DOUBLE)
+        {
+            get_doubles(&br, &r->values[c].i, r->ncolumns, n);
+        }
+        else
+        {
+            get_ints(&br, &r->values[c].i, r->ncolumns, n);
+        }
+    }
+    return br.error ? VARIORUM_ERROR_RUNTIME : 0;
+}
+
+int variorum_series_read(struct variorum_series_reader *reader, int64_t from,
+                         int64_t to, variorum_series_sample_fn fn, void *arg)
+{
+    size_t lo = 0;
+    size_t hi;
+    size_t mid;
+    uint32_t i;
+    int rc;
+
+    if (reader == NULL || fn == NULL)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    // First block that ends at or after from.
+    hi = reader->nblocks;
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (reader->blocks[mid].last < from)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    for (; lo < reader->nblocks && reader->blocks[lo].first <= to; lo++)
+    {
+        rc = decode_block(reader, &reader->blocks[lo]);
+        if (rc != 0)
+        {
+            return rc;
+        }
+        for (i = 0; i < reader->blocks[lo].samples; i++)
+        {
+            if (reader->times[i] < from || reader->times[i] > to)
+            {
+                continue;
+            }
+            if (fn(reader->times[i], &reader->values[(size_t)i * reader->ncolumns],
+                   arg) != 0)
+            {
+                return 0;
+            }
+        }
+    }
+    return 0;
+}
+
+void variorum_series_reader_close(struct variorum_series_reader *reader)
+{
+    if (reader == NULL)
+    {
+        return;
+    }
+    if (reader->fd >= 0)
+    {
+        close(reader->fd);
+    }
+    if (reader->columns != NULL)
+    {
+        free_header(reader);
+    }
+    free(reader->columns);
+    free(reader->blocks);
+    free(reader->buf);
+    free(reader->times);
+    free(reader->values);
+    free(reader);
+}
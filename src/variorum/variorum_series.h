@@ -0,0 +1,198 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef VARIORUM_SERIES_H_INCLUDE
+#define VARIORUM_SERIES_H_INCLUDE
+
+#include <stdint.h>
+
+/// @brief Number of samples compressed together in one block. A range is
+/// read by decoding only the blocks that overlap it.
+#define VARIORUM_SERIES_BLOCK_SAMPLES 1024
+
+/// @brief Largest number of value columns of a series.
+#define VARIORUM_SERIES_MAX_COLUMNS 4096
+
+/// @brief Decimals of a column that holds doubles rather than scaled
+/// integers.
+#define VARIORUM_SERIES_DOUBLE -1
+
+/// @brief One value of a sample.
+union variorum_series_value
+{
+    /// @brief Value of a VARIORUM_SERIES_DOUBLE column, stored bit for bit.
+    double f;
+    /// @brief Value of a column with d >= 0 decimals, times 10^d, e.g., 12345
+    /// for 123.45 in a column with 2 decimals.
+    int64_t i;
+};
+
+/// @brief One column of a series.
+struct variorum_series_column
+{
+    /// @brief Name of the column.
+    const char *name;
+    /// @brief Number of decimals of the scaled integers of the column, or
+    /// VARIORUM_SERIES_DOUBLE.
+    int decimals;
+};
+
+/// @brief Handle of a series being written.
+struct variorum_series_writer;
+
+/// @brief Handle of a series being read.
+struct variorum_series_reader;
+
+/// @brief Function called with every sample read.
+///
+/// @return 0 to go on, else stop reading.
+typedef int (*variorum_series_sample_fn)(
+    int64_t time,
+    const union variorum_series_value *values,
+    void *arg
+);
+
+/// @brief Start a compressed series of samples with a fixed set of columns.
+///
+/// Timestamps are encoded as deltas of deltas, integer columns as deltas or
+/// deltas of deltas, and double columns as the XOR with the previous value.
+/// Unchanged values are run-length encoded. The samples are written in
+/// blocks of VARIORUM_SERIES_BLOCK_SAMPLES, followed on close by an index of
+/// the time range of every block. A series whose writer died is still read up
+/// to its last complete block.
+///
+/// @param [in] fd File descriptor open for writing at the start of the file,
+///        which the writer owns from then on.
+/// @param [in] time_name Name of the time column.
+/// @param [in] columns Value columns.
+/// @param [in] ncolumns Number of value columns.
+/// @param [in] meta Application-defined text stored with the series, e.g., a
+///        host name, or NULL.
+/// @param [out] writer Handle, released with variorum_series_close().
+///
+/// @return 0 if successful, else a negative variorum error code.
+int variorum_series_create(
+    int fd,
+    const char *time_name,
+    const struct variorum_series_column *columns,
+    uint32_t ncolumns,
+    const char *meta,
+    struct variorum_series_writer **writer
+);
+
+/// @brief Append a sample. Timestamps must not decrease.
+///
+/// @param [in,out] writer Handle.
+/// @param [in] time Timestamp, in any unit.
+/// @param [in] values One value per column.
+///
+/// @return 0 if successful, else a negative variorum error code.
+int variorum_series_append(
+    struct variorum_series_writer *writer,
+    int64_t time,
+    const union variorum_series_value *values
+);
+
+/// @brief Write the pending samples as a block of their own, so they survive
+/// the death of the writer.
+///
+/// @param [in,out] writer Handle.
+///
+/// @return 0 if successful, else a negative variorum error code.
+int variorum_series_flush(
+    struct variorum_series_writer *writer
+);
+
+/// @brief Write the pending samples and the index, close the file and
+/// release the writer.
+///
+/// @param [in] writer Handle.
+///
+/// @return 0 if successful, else a negative variorum error code.
+int variorum_series_close(
+    struct variorum_series_writer *writer
+);
+
+/// @brief Open a compressed series, reading only its header and index.
+///
+/// @param [in] path Path of the series.
+/// @param [out] reader Handle, released with variorum_series_reader_close().
+///
+/// @return 0 if successful, else a negative variorum error code.
+int variorum_series_open(
+    const char *path,
+    struct variorum_series_reader **reader
+);
+
+/// @brief Name of the time column of a series.
+///
+/// @param [in] reader Handle.
+///
+/// @return Name, valid until variorum_series_reader_close().
+const char *variorum_series_time_name(
+    const struct variorum_series_reader *reader
+);
+
+/// @brief Value columns of a series.
+///
+/// @param [in] reader Handle.
+/// @param [out] ncolumns Number of value columns.
+///
+/// @return Columns, valid until variorum_series_reader_close().
+const struct variorum_series_column *variorum_series_columns(
+    const struct variorum_series_reader *reader,
+    uint32_t *ncolumns
+);
+
+/// @brief Application-defined text stored with a series.
+///
+/// @param [in] reader Handle.
+///
+/// @return Text, empty if none, valid until variorum_series_reader_close().
+const char *variorum_series_meta(
+    const struct variorum_series_reader *reader
+);
+
+/// @brief Extent of a series.
+///
+/// @param [in] reader Handle.
+/// @param [out] samples Number of samples, or NULL.
+/// @param [out] blocks Number of blocks, or NULL.
+/// @param [out] first Timestamp of the first sample, or NULL.
+/// @param [out] last Timestamp of the last sample, or NULL.
+void variorum_series_extent(
+    const struct variorum_series_reader *reader,
+    uint64_t *samples,
+    uint64_t *blocks,
+    int64_t *first,
+    int64_t *last
+);
+
+/// @brief Read the samples with from <= time <= to, in order, decoding only
+/// the blocks that hold them.
+///
+/// @param [in,out] reader Handle.
+/// @param [in] from First timestamp, or INT64_MIN.
+/// @param [in] to Last timestamp, or INT64_MAX.
+/// @param [in] fn Function called with every sample.
+/// @param [in] arg Argument passed to the function.
+///
+/// @return 0 if successful, else a negative variorum error code.
+int variorum_series_read(
+    struct variorum_series_reader *reader,
+    int64_t from,
+    int64_t to,
+    variorum_series_sample_fn fn,
+    void *arg
+);
+
+/// @brief Close a series and release the reader.
+///
+/// @param [in] reader Handle.
+void variorum_series_reader_close(
+    struct variorum_series_reader *reader
+);
+
+#endif
@@ -0,0 +1,486 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <variorum.h>
+#include <variorum_error.h>
+#include <variorum_shm.h>
+
+/// @brief "VARSHM02", written last when a region is initialized.
+#define SHM_MAGIC 0x32304d4853524156ULL
+#define SHM_PATH_FMT "/dev/shm/variorum.%s"
+#define SHM_PATH_LEN 256
+
+/// @brief Number of failed attempts after which a reader gives up on a
+/// sample that stays locked, e.g., because its writer died while writing.
+#define SHM_READ_RETRIES (1 << 20)
+
+/// @brief Start of a region, followed by history slots.
+struct shm_header
+{
+    uint64_t magic;
+    uint32_t history;
+    int32_t writer_pid;
+    uint64_t size;
+    /// @brief Number of samples published; the newest is in slot
+    /// (head - 1) % history.
+    uint64_t head;
+} __attribute__((aligned(64)));
+
+/// @brief One sample guarded by its sequence counter, which is odd while
+/// the writer modifies the sample.
+struct shm_slot
+{
+    uint64_t seq;
+    struct variorum_shm_sample sample;
+} __attribute__((aligned(64)));
+
+struct variorum_shm
+{
+    int fd;
+    int writer;
+    size_t size;
+    char path[SHM_PATH_LEN];
+    struct shm_header *hdr;
+    struct shm_slot *slots;
+};
+
+static size_t shm_size(unsigned history)
+{
+    return sizeof(struct shm_header) + history * sizeof(struct shm_slot);
+}
+
+static void shm_path(const char *name, char *path)
+{
+    snprintf(path, SHM_PATH_LEN, SHM_PATH_FMT,
+             name != NULL ? name : VARIORUM_SHM_DEFAULT_NAME);
+}
+
+static uint64_t shm_now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * (uint64_t)1000000000 + t.tv_nsec;
+}
+
+/// @brief Open and lock the file of a region, making sure the locked file is
+/// the one the path names: a previous writer may have removed it in between.
+///
+/// @return File descriptor, -2 if another process holds the lock, else -1.
+static int shm_lock_file(const char *path, size_t size)
+{
+    struct stat locked;
+    struct stat named;
+    int fd;
+
+    for (;;)
+    {
+        fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            return -1;
+        }
+        if (flock(fd, LOCK_EX | LOCK_NB) != 0)
+        {
+            close(fd);
+            return errno == EWOULDBLOCK ? -2 : -1;
+        }
+        if (fstat(fd, &locked) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        if (stat(path, &named) != 0 || named.st_ino != locked.st_ino)
+        {
+            close(fd);
+            continue;
+        }
+        // A region of another size may still be mapped by readers, so it is
+        // replaced instead of resized.
+        if (locked.st_size != 0 && (size_t)locked.st_size != size)
+        {
+            unlink(path);
+            close(fd);
+            continue;
+        }
+        if (locked.st_size == 0 && ftruncate(fd, size) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+}
+
+int variorum_shm_create(const char *name, unsigned history,
+                        struct variorum_shm **shm)
+{
+    struct variorum_shm *s;
+    void *map;
+    int fd;
+
+    *shm = NULL;
+    if (history == 0)
+    {
+        history = VARIORUM_SHM_DEFAULT_HISTORY;
+    }
+    s = (struct variorum_shm *) calloc(1, sizeof(struct variorum_shm));
+    if (s == NULL)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    shm_path(name, s->path);
+    s->size = shm_size(history);
+    fd = shm_lock_file(s->path, s->size);
+    if (fd < 0)
+    {
+        free(s);
+        return fd == -2 ? 1 : VARIORUM_ERROR_RUNTIME;
+    }
+    map = mmap(NULL, s->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close(fd);
+        free(s);
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    s->fd = fd;
+    s->writer = 1;
+    s->hdr = (struct shm_header *)map;
+    s->slots = (struct shm_slot *)(s->hdr + 1);
+
+    // Readers of a region left behind by a writer that died see it as not
+    // initialized until it is reset.
+    __atomic_store_n(&s->hdr->magic, 0, __ATOMIC_RELEASE);
+    memset((char *)map + sizeof(uint64_t), 0, s->size - sizeof(uint64_t));
+    s->hdr->history = history;
+    s->hdr->writer_pid = getpid();
+    s->hdr->size = s->size;
+    __atomic_store_n(&s->hdr->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+    *shm = s;
+    return 0;
+}
+
+int variorum_shm_write(struct variorum_shm *shm,
+                       const struct variorum_metric *metrics, uint32_t count)
+{
+    struct shm_slot *slot;
+    uint32_t total = count;
+    uint64_t head;
+    uint64_t seq;
+
+    if (shm == NULL || !shm->writer)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    if (count > VARIORUM_SHM_MAX_METRICS)
+    {
+        count = VARIORUM_SHM_MAX_METRICS;
+    }
+    head = shm->hdr->head;
+    slot = &shm->slots[head % shm->hdr->history];
+    seq = slot->seq;
+
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->sample.sequence = head + 1;
+    slot->sample.timestamp_ns = shm_now_ns();
+    slot->sample.count = count;
+    slot->sample.total = total;
+    memcpy(slot->sample.metrics, metrics, count * sizeof(struct variorum_metric));
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&shm->hdr->head, head + 1, __ATOMIC_RELEASE);
+    return total > count;
+}
+
+void variorum_shm_destroy(struct variorum_shm *shm)
+{
+    if (shm == NULL)
+    {
+        return;
+    }
+    if (shm->writer)
+    {
+        unlink(shm->path);
+    }
+    variorum_shm_detach(shm);
+}
+
+int variorum_shm_attach(const char *name, struct variorum_shm **shm)
+{
+    struct variorum_shm *s;
+    struct stat st;
+    void *map;
+    int fd;
+
+    *shm = NULL;
+    s = (struct variorum_shm *) calloc(1, sizeof(struct variorum_shm));
+    if (s == NULL)
+    {
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    shm_path(name, s->path);
+    fd = open(s->path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0 || fstat(fd, &st) != 0 ||
+        (size_t)st.st_size < sizeof(struct shm_header))
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        free(s);
+        return VARIORUM_ERROR_FEATURE_NOT_AVAILABLE;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close(fd);
+        free(s);
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    s->fd = fd;
+    s->size = st.st_size;
+    s->hdr = (struct shm_header *)map;
+    s->slots = (struct shm_slot *)(s->hdr + 1);
+    if (__atomic_load_n(&s->hdr->magic, __ATOMIC_ACQUIRE) != SHM_MAGIC ||
+        s->hdr->history == 0 || s->hdr->size != s->size ||
+        shm_size(s->hdr->history) != s->size)
+    {
+        variorum_shm_detach(s);
+        return VARIORUM_ERROR_FEATURE_NOT_AVAILABLE;
+    }
+    *shm = s;
+    return 0;
+}
+
+/// @brief Copy the sample of a slot if it is not being written and is still
+/// sample number sequence.
+///
+/// @return 0 if the copy is consistent, else -1.
+static int shm_read_slot(const struct shm_slot *slot, uint64_t sequence,
+                         struct variorum_shm_sample *sample)
+{
+    uint64_t seq1;
+    uint64_t seq2;
+    uint32_t count;
+
+    seq1 = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq1 & 1)
+    {
+        return -1;
+    }
+    sample->sequence = slot->sample.sequence;
+    sample->timestamp_ns = slot->sample.timestamp_ns;
+    count = slot->sample.count;
+    if (count > VARIORUM_SHM_MAX_METRICS)
+    {
+        count = VARIORUM_SHM_MAX_METRICS;
+    }
+    sample->count = count;
+    sample->total = slot->sample.total;
+    // Only the valid metrics are copied.
+    memcpy(sample->metrics, slot->sample.metrics,
+           count * sizeof(struct variorum_metric));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    seq2 = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    if (seq1 != seq2 || sample->sequence != sequence)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+int variorum_shm_read(const struct variorum_shm *shm,
+                      struct variorum_shm_sample *sample)
+{
+    const struct shm_header *hdr = shm->hdr;
+    uint64_t head;
+    int retries;
+
+    for (retries = 0; retries < SHM_READ_RETRIES; retries++)
+    {
+        head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+        if (head == 0)
+        {
+            return VARIORUM_ERROR_FEATURE_NOT_AVAILABLE;
+        }
+        if (shm_read_slot(&shm->slots[(head - 1) % hdr->history], head,
+                          sample) == 0)
+        {
+            return 0;
+        }
+    }
+    return VARIORUM_ERROR_RUNTIME;
+}
+
+int variorum_shm_read_history(const struct variorum_shm *shm,
+                              struct variorum_shm_sample *samples, unsigned max)
+{
+    const struct shm_header *hdr = shm->hdr;
+    uint64_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+    uint64_t first;
+    uint64_t i;
+    int n = 0;
+
+    if (max > hdr->history)
+    {
+        max = hdr->history;
+    }
+    first = head > max ? head - max + 1 : 1;
+    for (i = first; i <= head; i++)
+    {
+        if (shm_read_slot(&shm->slots[(i - 1) % hdr->history], i,
+                          &samples[n]) == 0)
+        {
+            n++;
+        }
+    }
+    return n;
+}
+
+int variorum_shm_writer_pid(const struct variorum_shm *shm)
+{
+    return shm->hdr->writer_pid;
+}
+
+void variorum_shm_detach(struct variorum_shm *shm)
+{
+    if (shm == NULL)
+    {
+        return;
+    }
+    munmap(shm->hdr, shm->size);
+    // Closing the descriptor also releases the writer lock.
+    close(shm->fd);
+    free(shm);
+}
+
+/* Publisher thread of variorum_shm_publish(). */
+static struct variorum_shm *shm_publisher = NULL;
+static pthread_t shm_publisher_thread;
+static pthread_mutex_t shm_publisher_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t shm_publisher_cond;
+static int shm_publisher_stop = 0;
+static unsigned shm_publisher_interval_ms = 0;
+
+static void *shm_publisher_main(void *arg)
+{
+    struct variorum_metric_vector metrics;
+    struct timespec next;
+
+    (void)arg;
+    variorum_metric_vector_init(&metrics);
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    pthread_mutex_lock(&shm_publisher_lock);
+    while (!shm_publisher_stop)
+    {
+        pthread_mutex_unlock(&shm_publisher_lock);
+        variorum_metric_vector_clear(&metrics);
+        if (variorum_get_metrics(&metrics) == 0)
+        {
+            variorum_shm_write(shm_publisher, metrics.metrics,
+                               (uint32_t)metrics.count);
+        }
+
+        // Sample on a fixed period rather than a fixed delay.
+        next.tv_sec += shm_publisher_interval_ms / 1000;
+        next.tv_nsec += (shm_publisher_interval_ms % 1000) * 1000000L;
+        if (next.tv_nsec >= 1000000000L)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&shm_publisher_lock);
+        while (!shm_publisher_stop &&
+               pthread_cond_timedwait(&shm_publisher_cond, &shm_publisher_lock,
+                                      &next) != ETIMEDOUT)
+        {
+        }
+    }
+    pthread_mutex_unlock(&shm_publisher_lock);
+    variorum_metric_vector_free(&metrics);
+    return NULL;
+}
+
+int variorum_shm_publish(const char *name, unsigned interval_ms,
+                         unsigned history)
+{
+    struct variorum_metric_vector metrics;
+    pthread_condattr_t attr;
+    int rc;
+
+    if (shm_publisher != NULL || interval_ms == 0)
+    {
+        return VARIORUM_ERROR_INVAL;
+    }
+    rc = variorum_shm_create(name, history, &shm_publisher);
+    if (rc != 0)
+    {
+        return rc;
+    }
+
+    // Publish a first sample, which also checks that there is something to
+    // publish on this platform.
+    variorum_metric_vector_init(&metrics);
+    rc = variorum_get_metrics(&metrics);
+    if (rc == 0 && metrics.count > 0)
+    {
+        variorum_shm_write(shm_publisher, metrics.metrics, (uint32_t)metrics.count);
+    }
+    else
+    {
+        rc = VARIORUM_ERROR_FEATURE_NOT_AVAILABLE;
+    }
+    variorum_metric_vector_free(&metrics);
+    if (rc != 0)
+    {
+        variorum_shm_destroy(shm_publisher);
+        shm_publisher = NULL;
+        return rc;
+    }
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&shm_publisher_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    shm_publisher_stop = 0;
+    shm_publisher_interval_ms = interval_ms;
+    if (pthread_create(&shm_publisher_thread, NULL, shm_publisher_main, NULL))
+    {
+        pthread_cond_destroy(&shm_publisher_cond);
+        variorum_shm_destroy(shm_publisher);
+        shm_publisher = NULL;
+        return VARIORUM_ERROR_RUNTIME;
+    }
+    return 0;
+}
+
+void variorum_shm_unpublish(void)
+{
+    if (shm_publisher == NULL)
+    {
+        return;
+    }
+    pthread_mutex_lock(&shm_publisher_lock);
+    shm_publisher_stop = 1;
+    pthread_cond_signal(&shm_publisher_cond);
+    pthread_mutex_unlock(&shm_publisher_lock);
+    pthread_join(shm_publisher_thread, NULL);
+    pthread_cond_destroy(&shm_publisher_cond);
+    variorum_shm_destroy(shm_publisher);
+    shm_publisher = NULL;
+}
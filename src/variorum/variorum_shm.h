@@ -0,0 +1,174 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef VARIORUM_SHM_H_INCLUDE
+#define VARIORUM_SHM_H_INCLUDE
+
+#include <stdint.h>
+
+#include <variorum_metrics.h>
+
+/// @brief Region name used when none is given.
+#define VARIORUM_SHM_DEFAULT_NAME "variorum"
+
+/// @brief Largest number of metrics in one published sample, enough for
+/// the per-thread metrics of a two-socket node with 512 hardware threads.
+/// Larger samples are truncated and flagged by their total.
+#define VARIORUM_SHM_MAX_METRICS 1024
+
+/// @brief Number of samples kept in a region when none is given.
+#define VARIORUM_SHM_DEFAULT_HISTORY 64
+
+/// @brief One published sample of the node.
+struct variorum_shm_sample
+{
+    /// @brief Number of the sample since the region was created, from 1.
+    uint64_t sequence;
+    /// @brief Time the sample was published, in nanoseconds of
+    /// CLOCK_MONOTONIC.
+    uint64_t timestamp_ns;
+    /// @brief Number of valid entries in metrics.
+    uint32_t count;
+    /// @brief Number of metrics given to variorum_shm_write(), larger than
+    /// count if the sample was truncated.
+    uint32_t total;
+    /// @brief Metrics, as returned by variorum_get_metrics().
+    struct variorum_metric metrics[VARIORUM_SHM_MAX_METRICS];
+};
+
+/// @brief Handle of a mapped telemetry region.
+struct variorum_shm;
+
+/// @brief Create the telemetry region /dev/shm/variorum.name and become its
+/// only writer.
+///
+/// The writer holds an advisory lock on the region for its lifetime, so a
+/// single writer exists per node and name, and a region left behind by a
+/// writer that died is taken over by the next one.
+///
+/// @param [in] name Region name, or NULL for VARIORUM_SHM_DEFAULT_NAME.
+/// @param [in] history Number of samples kept, or 0 for
+///        VARIORUM_SHM_DEFAULT_HISTORY.
+/// @param [out] shm Handle, released with variorum_shm_destroy().
+///
+/// @return 0 if successful, 1 if another live process writes the region,
+/// else a negative variorum error code.
+int variorum_shm_create(
+    const char *name,
+    unsigned history,
+    struct variorum_shm **shm
+);
+
+/// @brief Publish a sample as the newest of the region. Readers never block
+/// the writer.
+///
+/// @param [in,out] shm Handle returned by variorum_shm_create().
+/// @param [in] metrics Metrics of the sample, truncated to
+///        VARIORUM_SHM_MAX_METRICS.
+/// @param [in] count Number of metrics.
+///
+/// @return 0 if successful, 1 if the sample was truncated, else
+/// VARIORUM_ERROR_INVAL if shm is not a writer.
+int variorum_shm_write(
+    struct variorum_shm *shm,
+    const struct variorum_metric *metrics,
+    uint32_t count
+);
+
+/// @brief Unmap and remove a region created with variorum_shm_create().
+///
+/// @param [in] shm Handle.
+void variorum_shm_destroy(
+    struct variorum_shm *shm
+);
+
+/// @brief Start a thread in the calling process that samples
+/// variorum_get_metrics() and publishes every sample in a telemetry region.
+///
+/// Only one process per node publishes a region: if another live process
+/// already does, this call returns 1 and the caller can read that region
+/// with variorum_shm_attach() instead. The thread calls into variorum, so
+/// other threads of the process must not call variorum while it runs.
+///
+/// @param [in] name Region name, or NULL for VARIORUM_SHM_DEFAULT_NAME.
+/// @param [in] interval_ms Sampling interval in milliseconds.
+/// @param [in] history Number of samples kept, or 0 for
+///        VARIORUM_SHM_DEFAULT_HISTORY.
+///
+/// @return 0 if this process publishes, 1 if another process does, else a
+/// negative variorum error code.
+int variorum_shm_publish(
+    const char *name,
+    unsigned interval_ms,
+    unsigned history
+);
+
+/// @brief Stop the thread started by variorum_shm_publish() and remove its
+/// region.
+void variorum_shm_unpublish(
+    void
+);
+
+/// @brief Map a telemetry region for reading.
+///
+/// @param [in] name Region name, or NULL for VARIORUM_SHM_DEFAULT_NAME.
+/// @param [out] shm Handle, released with variorum_shm_detach().
+///
+/// @return 0 if successful, VARIORUM_ERROR_FEATURE_NOT_AVAILABLE if the
+/// region does not exist or is not initialized, else a negative variorum
+/// error code.
+int variorum_shm_attach(
+    const char *name,
+    struct variorum_shm **shm
+);
+
+/// @brief Copy the newest sample of a region.
+///
+/// Lock-free and without system calls: the copy is retried until the writer
+/// did not modify the sample while it was read.
+///
+/// @param [in] shm Handle returned by variorum_shm_attach().
+/// @param [out] sample Newest sample.
+///
+/// @return 0 if successful, VARIORUM_ERROR_FEATURE_NOT_AVAILABLE if nothing
+/// was published yet, or VARIORUM_ERROR_RUNTIME if the sample stays locked,
+/// e.g., because the writer died while writing it.
+int variorum_shm_read(
+    const struct variorum_shm *shm,
+    struct variorum_shm_sample *sample
+);
+
+/// @brief Copy up to max of the newest samples of a region, oldest first.
+/// Samples overwritten by the writer while they are copied are skipped.
+///
+/// @param [in] shm Handle returned by variorum_shm_attach().
+/// @param [out] samples Array of at least max samples.
+/// @param [in] max Largest number of samples to copy.
+///
+/// @return Number of samples copied.
+int variorum_shm_read_history(
+    const struct variorum_shm *shm,
+    struct variorum_shm_sample *samples,
+    unsigned max
+);
+
+/// @brief Process ID of the writer of a region. Readers can use it with
+/// kill(pid, 0) to detect a region whose writer died.
+///
+/// @param [in] shm Handle returned by variorum_shm_attach().
+///
+/// @return Process ID of the last writer.
+int variorum_shm_writer_pid(
+    const struct variorum_shm *shm
+);
+
+/// @brief Unmap a region mapped with variorum_shm_attach().
+///
+/// @param [in] shm Handle.
+void variorum_shm_detach(
+    struct variorum_shm *shm
+);
+
+#endif
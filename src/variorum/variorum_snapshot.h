@@ -0,0 +1,56 @@
+// Copyright 2019-2023 Lawrence Livermore National Security, LLC and other
+// Variorum Project Developers. See the top-level LICENSE file for details.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef VARIORUM_SNAPSHOT_H_INCLUDE
+#define VARIORUM_SNAPSHOT_H_INCLUDE
+
+#include <stdint.h>
+
+/// @brief Largest number of sockets a snapshot reports energy for.
+#define VARIORUM_SNAPSHOT_MAX_SOCKETS 16
+
+/// @brief Raw counters read by variorum_snapshot_read().
+///
+/// Values are raw so that reading them needs no conversion state; consumers
+/// subtract two snapshots. Energy counters are 32 bits wide and wrap, so
+/// deltas are taken modulo 2^32 before multiplying by the energy unit.
+/// Counters that the platform does not provide read as 0.
+struct variorum_snapshot
+{
+    /// @brief Time of the snapshot, in nanoseconds of CLOCK_MONOTONIC.
+    uint64_t timestamp_ns;
+    /// @brief Logical CPU the caller ran on, whose counters were read.
+    int cpu;
+    /// @brief Number of valid entries in pkg_energy and dram_energy.
+    unsigned nsockets;
+    /// @brief Raw package energy counter of each socket.
+    uint32_t pkg_energy[VARIORUM_SNAPSHOT_MAX_SOCKETS];
+    /// @brief Raw DRAM energy counter of each socket.
+    uint32_t dram_energy[VARIORUM_SNAPSHOT_MAX_SOCKETS];
+    /// @brief Raw package power limit register (MSR_PKG_POWER_LIMIT) of each
+    /// socket.
+    uint64_t pkg_power_limit[VARIORUM_SNAPSHOT_MAX_SOCKETS];
+    /// @brief Raw package thermal status register
+    /// (IA32_PACKAGE_THERM_STATUS) of each socket.
+    uint64_t pkg_therm_status[VARIORUM_SNAPSHOT_MAX_SOCKETS];
+    /// @brief Joules per package energy count.
+    double energy_unit_joules;
+    /// @brief Joules per DRAM energy count.
+    double dram_energy_unit_joules;
+    /// @brief Watts per power limit count.
+    double power_unit_watts;
+    /// @brief Instructions retired on cpu.
+    uint64_t instructions;
+    /// @brief Unhalted core cycles on cpu.
+    uint64_t core_cycles;
+    /// @brief Unhalted reference cycles on cpu.
+    uint64_t ref_cycles;
+    /// @brief Actual performance frequency clock count (APERF) on cpu.
+    uint64_t aperf;
+    /// @brief Maximum performance frequency clock count (MPERF) on cpu.
+    uint64_t mperf;
+};
+
+#endif
@@ -3,7 +3,7 @@
 #
 # SPDX-License-Identifier: MIT
 
-from ctypes import c_int, c_char_p, CDLL, POINTER
+from ctypes import c_int, c_char_p, c_uint64, CDLL, POINTER
 
 
 class variorum:
@@ -146,6 +146,53 @@ class variorum:
         self.variorum_cap_gpu_power_ratio.argtypes = [c_int]
         self.variorum_cap_gpu_power_ratio.restype = c_int
 
+        # Cap Core C-State Exit Latency
+        self.variorum_cap_core_cstate_latency = (
+            self.variorum_c.variorum_cap_core_cstate_latency
+        )
+        self.variorum_cap_core_cstate_latency.argtypes = [c_int, c_int]
+        self.variorum_cap_core_cstate_latency.restype = c_int
+
+        # Cap Socket C-State Exit Latency
+        self.variorum_cap_socket_cstate_latency = (
+            self.variorum_c.variorum_cap_socket_cstate_latency
+        )
+        self.variorum_cap_socket_cstate_latency.argtypes = [c_int, c_int]
+        self.variorum_cap_socket_cstate_latency.restype = c_int
+
+        # Cap Node Wakeup Latency
+        self.variorum_cap_node_cstate_latency = (
+            self.variorum_c.variorum_cap_node_cstate_latency
+        )
+        self.variorum_cap_node_cstate_latency.argtypes = [c_int]
+        self.variorum_cap_node_cstate_latency.restype = c_int
+
+        # Cap Socket Package C-State
+        self.variorum_cap_socket_pkg_cstate_limit = (
+            self.variorum_c.variorum_cap_socket_pkg_cstate_limit
+        )
+        self.variorum_cap_socket_pkg_cstate_limit.argtypes = [c_int, c_int]
+        self.variorum_cap_socket_pkg_cstate_limit.restype = c_int
+
+        # Save and Restore C-State Limits
+        self.variorum_save_cstate_limits = self.variorum_c.variorum_save_cstate_limits
+        self.variorum_save_cstate_limits.restype = c_int
+        self.variorum_restore_cstate_limits = (
+            self.variorum_c.variorum_restore_cstate_limits
+        )
+        self.variorum_restore_cstate_limits.restype = c_int
+
+        # Cap Turbo Ratio Limits
+        self.variorum_cap_turbo_ratio_limit = (
+            self.variorum_c.variorum_cap_turbo_ratio_limit
+        )
+        self.variorum_cap_turbo_ratio_limit.argtypes = [
+            c_int,
+            POINTER(c_int),
+            POINTER(c_int),
+        ]
+        self.variorum_cap_turbo_ratio_limit.restype = c_int
+
         """
         Variorum JSON Functions
         """
@@ -174,6 +221,65 @@ class variorum:
         self.variorum_disable_turbo = self.variorum_c.variorum_disable_turbo
         self.variorum_disable_turbo.restype = c_int
 
+        # Get and Set Hardware Prefetcher Disable Bits
+        self.variorum_get_prefetch_control = (
+            self.variorum_c.variorum_get_prefetch_control
+        )
+        self.variorum_get_prefetch_control.argtypes = [POINTER(c_int)]
+        self.variorum_get_prefetch_control.restype = c_int
+        self.variorum_set_prefetch_control = (
+            self.variorum_c.variorum_set_prefetch_control
+        )
+        self.variorum_set_prefetch_control.argtypes = [POINTER(c_int)]
+        self.variorum_set_prefetch_control.restype = c_int
+        self.variorum_push_prefetch_control = (
+            self.variorum_c.variorum_push_prefetch_control
+        )
+        self.variorum_push_prefetch_control.argtypes = [POINTER(c_int)]
+        self.variorum_push_prefetch_control.restype = c_int
+        self.variorum_pop_prefetch_control = (
+            self.variorum_c.variorum_pop_prefetch_control
+        )
+        self.variorum_pop_prefetch_control.restype = c_int
+
+        # Get and Set Energy Performance Bias
+        self.variorum_get_energy_perf_bias = (
+            self.variorum_c.variorum_get_energy_perf_bias
+        )
+        self.variorum_get_energy_perf_bias.argtypes = [POINTER(c_int)]
+        self.variorum_get_energy_perf_bias.restype = c_int
+        self.variorum_set_energy_perf_bias = (
+            self.variorum_c.variorum_set_energy_perf_bias
+        )
+        self.variorum_set_energy_perf_bias.argtypes = [POINTER(c_int)]
+        self.variorum_set_energy_perf_bias.restype = c_int
+
+        # Per-Core Turbo
+        self.variorum_get_turbo_cores = self.variorum_c.variorum_get_turbo_cores
+        self.variorum_get_turbo_cores.argtypes = [POINTER(c_int)]
+        self.variorum_get_turbo_cores.restype = c_int
+        self.variorum_enable_turbo_cores = self.variorum_c.variorum_enable_turbo_cores
+        self.variorum_enable_turbo_cores.argtypes = [POINTER(c_int)]
+        self.variorum_enable_turbo_cores.restype = c_int
+        self.variorum_disable_turbo_cores = (
+            self.variorum_c.variorum_disable_turbo_cores
+        )
+        self.variorum_disable_turbo_cores.argtypes = [POINTER(c_int)]
+        self.variorum_disable_turbo_cores.restype = c_int
+
+        # Per-Thread Fixed Counters
+        self.variorum_get_thread_fixed_counters = (
+            self.variorum_c.variorum_get_thread_fixed_counters
+        )
+        self.variorum_get_thread_fixed_counters.argtypes = [POINTER(c_uint64)]
+        self.variorum_get_thread_fixed_counters.restype = c_int
+
+        # Signal-Safe Snapshots
+        self.variorum_arm_snapshot = self.variorum_c.variorum_arm_snapshot
+        self.variorum_arm_snapshot.restype = c_int
+        self.variorum_disarm_snapshot = self.variorum_c.variorum_disarm_snapshot
+        self.variorum_disarm_snapshot.restype = c_int
+
         """
         Variorum Topology Functions
         """